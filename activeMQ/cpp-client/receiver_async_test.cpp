@@ -9,7 +9,11 @@
 #include <signal.h>
 #include <atomic>
 #include <thread>
+#include <vector>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
 
 using namespace activemq::core;
 using namespace cms;
@@ -28,40 +32,43 @@ private:
     Session* session;
     MessageProducer* producer;
     int receiver_id;
+    messaging::utils::LogSummary& progress;
+    messaging::utils::AckEncoder acks;  // the listener runs on its session's one thread
+    vector<unsigned char> buffer;  // request body, reused across deliveries on this session
 public:
     AsyncRequestListener(Session* s, MessageProducer* p, int id) 
-        : session(s), producer(p), receiver_id(id) {}
+        : session(s), producer(p), receiver_id(id),
+          progress(messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Receiver " + to_string(id), {"received"})),
+          acks(to_string(id), true) {}
     
     virtual void onMessage(const Message* message) {
         try {
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
             const BytesMessage* bytesMsg = dynamic_cast<const BytesMessage*>(message);
             if (bytesMsg) {
                 // Read message
-                unsigned char* buffer = new unsigned char[bytesMsg->getBodyLength()];
-                bytesMsg->readBytes(buffer, bytesMsg->getBodyLength());
-                string request_str((char*)buffer, bytesMsg->getBodyLength());
-                delete[] buffer;
+                int len = bytesMsg->getBodyLength();
+                if (buffer.size() < static_cast<size_t>(len)) {
+                    buffer.resize(len);
+                }
+                bytesMsg->readBytes(buffer.data(), len);
                 
                 // Parse message
                 MessageEnvelope msg_envelope;
-                if (message_helpers::parse_envelope(request_str, msg_envelope)) {
+                if (message_helpers::parse_envelope(buffer.data(), len, msg_envelope)) {
                     string message_id = msg_envelope.message_id();
-                    cout << " [x] [ASYNC] Received message " << message_id << endl;
+                    messaging::utils::log_debug() << " [x] [ASYNC] Received message " << message_id;
+                    progress.add(0);
                     
-                    // Create ACK
-                    MessageEnvelope response = message_helpers::create_ack_from_envelope(
-                        msg_envelope,
-                        to_string(receiver_id)
-                    );
-                    response.set_async(true);
-                    string response_str = message_helpers::serialize_envelope(response);
+                    // Create ACK (a PONG for readiness PINGs)
+                    std::string_view response = acks.encode_response(msg_envelope, timing);
                     
                     // Send ACK
                     auto_ptr<BytesMessage> reply(session->createBytesMessage(
-                        (unsigned char*)response_str.data(), response_str.size()));
+                        (unsigned char*)response.data(), response.size()));
                     reply->setCMSCorrelationID(message->getCMSCorrelationID());
                     
-                    producer->send(message->getCMSReplyTo(), reply.get());
+                    TRACED("reply", producer->send(message->getCMSReplyTo(), reply.get()));
                 }
             }
         } catch (CMSException& e) {
@@ -71,6 +78,7 @@ public:
 };
 
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
     
     for (int i = 1; i < argc; i++) {
@@ -80,6 +88,8 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
@@ -107,6 +117,7 @@ int main(int argc, char* argv[]) {
             this_thread::sleep_for(chrono::milliseconds(100));
         }
 
+        messaging::utils::flush_log();
         cout << " [x] [ASYNC] Receiver " << receiver_id << " shutting down" << endl;
 
     } catch (CMSException& e) {
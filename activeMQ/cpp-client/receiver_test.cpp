@@ -11,6 +11,9 @@
 #include <thread>
 #include <chrono>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
 
 using namespace activemq::core;
 using namespace cms;
@@ -29,12 +32,17 @@ private:
     Session* session;
     MessageProducer* producer;
     int receiver_id;
+    messaging::utils::LogSummary& progress;
+    messaging::utils::AckEncoder acks;  // the listener runs on its session's one thread
 public:
     RequestListener(Session* s, MessageProducer* p, int id) 
-        : session(s), producer(p), receiver_id(id) {}
+        : session(s), producer(p), receiver_id(id),
+          progress(messaging::utils::AsyncLogger::global().summary(" [*] Receiver " + to_string(id), {"received"})),
+          acks(to_string(id)) {}
     
     virtual void onMessage(const Message* message) {
         try {
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
             const BytesMessage* bytesMsg = dynamic_cast<const BytesMessage*>(message);
             if (bytesMsg) {
                 // Read message
@@ -47,21 +55,18 @@ public:
                 MessageEnvelope msg_envelope;
                 if (message_helpers::parse_envelope(request_str, msg_envelope)) {
                     string message_id = msg_envelope.message_id();
-                    cout << " [x] Received message " << message_id << endl;
+                    messaging::utils::log_debug() << " [x] Received message " << message_id;
+                    progress.add(0);
                     
-                    // Create ACK
-                    MessageEnvelope response = message_helpers::create_ack_from_envelope(
-                        msg_envelope,
-                        to_string(receiver_id)
-                    );
-                    string response_str = message_helpers::serialize_envelope(response);
+                    // Create ACK (a PONG for readiness PINGs)
+                    std::string_view response = acks.encode_response(msg_envelope, timing);
                     
                     // Send ACK
                     auto_ptr<BytesMessage> reply(session->createBytesMessage(
-                        (unsigned char*)response_str.data(), response_str.size()));
+                        (unsigned char*)response.data(), response.size()));
                     reply->setCMSCorrelationID(message->getCMSCorrelationID());
                     
-                    producer->send(message->getCMSReplyTo(), reply.get());
+                    TRACED("reply", producer->send(message->getCMSReplyTo(), reply.get()));
                 }
             }
         } catch (CMSException& e) {
@@ -71,6 +76,7 @@ public:
 };
 
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
     
     for (int i = 1; i < argc; i++) {
@@ -80,6 +86,8 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
@@ -107,6 +115,7 @@ int main(int argc, char* argv[]) {
             this_thread::sleep_for(chrono::milliseconds(100));
         }
 
+        messaging::utils::flush_log();
         cout << " [x] Receiver " << receiver_id << " shutting down" << endl;
 
     } catch (CMSException& e) {
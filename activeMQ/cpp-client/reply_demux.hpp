@@ -0,0 +1,69 @@
+#ifndef ACTIVEMQ_REPLY_DEMUX_HPP
+#define ACTIVEMQ_REPLY_DEMUX_HPP
+
+#include <cms/Session.h>
+#include <cms/BytesMessage.h>
+#include <cms/MessageListener.h>
+#include <string>
+#include <vector>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/pending_replies.hpp"
+
+/**
+ * Many outstanding requests sharing one temporary reply queue.
+ *
+ * The ReplyListener in sender_test tracks a single correlation id and waits
+ * on a latch per message. Here every request's CMSCorrelationID is its
+ * message id, and the listener matches replies against a table of outstanding
+ * requests, reading each body into one reused buffer instead of a fresh
+ * allocation. PendingReplies times requests out and hands completions back
+ * on the caller's thread from poll().
+ */
+class ReplyDemux : public cms::MessageListener {
+public:
+    using ResultFn = messaging::utils::PendingReplies::ResultFn;
+
+    explicit ReplyDemux(int timeout_ms = 1000) : replies_(timeout_ms) {}
+
+    ReplyDemux(const ReplyDemux&) = delete;
+    ReplyDemux& operator=(const ReplyDemux&) = delete;
+
+    // Track message_id from now; call before its request is sent
+    void expect(const std::string& message_id) { replies_.expect(message_id); }
+
+    // Report message_id as failed, e.g. because its send threw
+    void fail(const std::string& message_id, const std::string& error) { replies_.fail(message_id, error); }
+
+    // Requests sent but not yet reported by poll()
+    size_t in_flight() const { return replies_.in_flight(); }
+
+    // Wait up to wait_ms for completions and report them on this thread; returns how many
+    size_t poll(int wait_ms, const ResultFn& on_result) { return replies_.poll(wait_ms, on_result); }
+
+    // Poll until nothing is in flight
+    void drain_all(const ResultFn& on_result) { replies_.drain_all(on_result); }
+
+    // Runs on the reply session's dispatch thread
+    void onMessage(const cms::Message* message) override {
+        const cms::BytesMessage* bytesMsg = dynamic_cast<const cms::BytesMessage*>(message);
+        if (!bytesMsg) {
+            return;
+        }
+        int len = bytesMsg->getBodyLength();
+        if (buffer_.size() < static_cast<size_t>(len)) {
+            buffer_.resize(len);
+        }
+        bytesMsg->readBytes(buffer_.data(), len);
+        std::string message_id = message->getCMSCorrelationID();
+        bool parsed = message_helpers::parse_envelope(buffer_.data(), len, envelope_);
+        replies_.complete(message_id, parsed && message_helpers::is_valid_ack(envelope_, message_id),
+                          messaging::utils::AckTiming::of(envelope_));
+    }
+
+private:
+    std::vector<unsigned char> buffer_;  // reply body, reused; only touched by the dispatch thread
+    MessageEnvelope envelope_;           // only touched by the dispatch thread
+    messaging::utils::PendingReplies replies_;
+};
+
+#endif // ACTIVEMQ_REPLY_DEMUX_HPP
@@ -5,56 +5,101 @@
 #include <cms/BytesMessage.h>
 #include <iostream>
 #include <fstream>
-#include <future>
 #include <vector>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <algorithm>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/connection_pool.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "reply_demux.hpp"
 
 using namespace activemq::core;
 using namespace cms;
 using namespace std;
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ConnectionPool;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
+using message_helpers::elapsed_ms_since;
 
-struct TaskResult {
-    bool success;
-    string message_id;
-    long long duration;
-    string error;
+// Pooled session with its own temporary reply queue, producer and consumer
+struct SessionContext {
+    auto_ptr<Session> session;
+    auto_ptr<Destination> replyDest;
+    auto_ptr<MessageProducer> producer;
+    auto_ptr<MessageConsumer> consumer;
+
+    explicit SessionContext(Connection* connection)
+        : session(connection->createSession(Session::AUTO_ACKNOWLEDGE)),
+          replyDest(session->createTemporaryQueue()),
+          producer(session->createProducer(NULL)),
+          consumer(session->createConsumer(replyDest.get())) {
+        producer->setDeliveryMode(DeliveryMode::NON_PERSISTENT);
+    }
 };
 
-TaskResult send_message_task(Connection* connection, const json& item) {
+// First attempts stamp the corpus in place, others encode a copy (see Attempt)
+TaskResult send_message_task(ConnectionPool<SessionContext>& pool, test_data_loader::EncodedCorpus& corpus, size_t i,
+                             const Attempt& attempt) {
     TaskResult res;
     res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
+    res.message_id = std::string(corpus.message_id(i));
+    res.duration_ns = 0;
+    
+    auto ctx = pool.checkout(0);
+    if (!ctx) {
+        res.error = "Session creation failed";
+        return res;
+    }
     
     try {
-        auto_ptr<Session> session(connection->createSession(Session::AUTO_ACKNOWLEDGE));
-        auto_ptr<Destination> replyDest(session->createTemporaryQueue());
-        auto_ptr<MessageProducer> producer(session->createProducer(NULL));
-        auto_ptr<MessageConsumer> consumer(session->createConsumer(replyDest.get()));
-
-        int target = item.value("target", 0);
-        long long msg_start = get_current_time_ms();
+        int target = corpus.target(i);
+        long long msg_start = get_steady_time_ns();
         
-        // Create and send message
-        MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-        string body = message_helpers::serialize_envelope(envelope);
+        // Stamp the pre-encoded envelope and send it
+        thread_local std::string copy;
+        int64_t now_us = message_helpers::get_current_time_us();
+        std::string_view body = attempt.number == 0 ? corpus.stamp(i, now_us) : corpus.encode(i, now_us, {}, copy);
+        res.bytes = body.size();
         
-        auto_ptr<BytesMessage> message(session->createBytesMessage((unsigned char*)body.data(), body.size()));
-        message->setCMSReplyTo(replyDest.get());
+        auto_ptr<BytesMessage> message(ctx->session->createBytesMessage((unsigned char*)body.data(), body.size()));
+        message->setCMSReplyTo(ctx->replyDest.get());
         message->setCMSCorrelationID("corr-cpp-async-" + res.message_id);
         
-        string destName = "test_queue_" + to_string(target);
-        auto_ptr<Destination> destination(session->createQueue(destName));
-        producer->send(destination.get(), message.get());
+        static const messaging::utils::TopicTable queue_names("test_queue_");
+        auto_ptr<Destination> destination(ctx->session->createQueue(queue_names[target]));
+        TRACED("send", ctx->producer->send(destination.get(), message.get()));
         
-        // Wait for reply
-        auto_ptr<Message> reply(consumer->receive(100));  // 100ms timeout
-        if (reply.get()) {
+        // Wait for reply, skipping late replies to earlier messages on this pooled session
+        long long timeout_ms = attempt.timeout_ms(100);
+        while (!res.success && res.error.empty()) {
+            long long remaining_ms = timeout_ms - static_cast<long long>(elapsed_ms_since(msg_start));
+            if (remaining_ms <= 0) {
+                res.error = "Timeout";
+                break;
+            }
+            auto_ptr<Message> reply(ctx->consumer->receive((int)remaining_ms));
+            if (!reply.get()) {
+                res.error = "Timeout";
+                break;
+            }
             const BytesMessage* bytesReply = dynamic_cast<const BytesMessage*>(reply.get());
             if (bytesReply && bytesReply->getCMSCorrelationID() == message->getCMSCorrelationID()) {
                 unsigned char* buffer = new unsigned char[bytesReply->getBodyLength()];
@@ -65,65 +110,240 @@ TaskResult send_message_task(Connection* connection, const json& item) {
                 MessageEnvelope resp_envelope;
                 if (message_helpers::parse_envelope(response, resp_envelope) && 
                     message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
-                    res.duration = get_current_time_ms() - msg_start;
+                    res.duration_ns = get_steady_time_ns() - msg_start;
+                    res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
                     res.success = true;
                 } else {
                     res.error = "Invalid ACK";
                 }
             }
-        } else {
-            res.error = "Timeout";
         }
     } catch (CMSException& e) {
         res.error = e.getMessage();
+        ctx.discard();
     }
     
     return res;
 }
 
-int main() {
+// One producer session of the pipelined mode, with its target queues created once
+struct ProducerSession {
+    auto_ptr<Session> session;
+    auto_ptr<MessageProducer> producer;
+    map<int, unique_ptr<Destination>> queues;
+
+    explicit ProducerSession(Connection* connection)
+        : session(connection->createSession(Session::AUTO_ACKNOWLEDGE)),
+          producer(session->createProducer(NULL)) {
+        producer->setDeliveryMode(DeliveryMode::NON_PERSISTENT);
+        producer->setDisableMessageTimeStamp(true);
+    }
+
+    Destination* queue_for(int target) {
+        auto& queue = queues[target];
+        if (!queue) {
+            queue.reset(session->createQueue("test_queue_" + to_string(target)));
+        }
+        return queue.get();
+    }
+};
+
+/**
+ * Send every message from this thread, round-robin over the producer sessions,
+ * keeping up to max_in_flight outstanding; returns the peak in flight.
+ */
+int run_reply_pipeline(vector<unique_ptr<ProducerSession>>& producers, const Destination* replyDest,
+                       ReplyDemux& demux, test_data_loader::EncodedCorpus& corpus, int max_in_flight,
+                       const ReplyDemux::ResultFn& on_result, MessageStats& stats) {
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t peak = 0;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        // Wait for room in the window, picking up whatever replies have arrived meanwhile
+        while (demux.in_flight() >= window) {
+            demux.poll(10, on_result);
+        }
+        ProducerSession& ps = *producers[i % producers.size()];
+        string message_id(corpus.message_id(i));
+        demux.expect(message_id);
+        try {
+            std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
+            auto_ptr<BytesMessage> message(ps.session->createBytesMessage((unsigned char*)body.data(), body.size()));
+            message->setCMSReplyTo(replyDest);
+            message->setCMSCorrelationID(message_id);
+            TRACED("send", ps.producer->send(ps.queue_for(corpus.target(i)), message.get()));
+        } catch (CMSException& e) {
+            demux.fail(message_id, e.getMessage());
+        }
+        stats.record_dispatch();
+        peak = std::max(peak, demux.in_flight());
+        demux.poll(0, on_result);
+    }
+    demux.drain_all(on_result);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     activemq::library::ActiveMQCPP::initializeLibrary();
 
     try {
-        auto test_data = test_data_loader::loadTestData();
+        auto corpus = test_data_loader::preEncodeTestFile();
+        corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+        EngineOptions options = EngineOptions::from_args(argc, argv);
+        corpus.attach_qos(options.qos);
+        messaging::utils::configure_logging(argc, argv);
+        messaging::utils::configure_tracing(argc, argv);
+        messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+        bool use_pipeline = false;
+        int num_sessions = 4;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--pipeline") == 0) {
+                use_pipeline = true;
+            } else if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+                num_sessions = std::max(1, std::stoi(argv[++i]));
+            }
+        }
+        if (use_pipeline) {
+            options.warn_ignored_by("--pipeline");
+        }
 
         MessageStats stats;
         stats.set_metadata({
             {"service", "ActiveMQ"},
             {"language", "C++"},
-            {"async", true}
+            {"async", true},
+            {"transport", use_pipeline ? "pipeline" : "session_pool"},
+            {"workers", use_pipeline ? 1 : options.workers},
+            {"max_in_flight", options.max_in_flight}
         });
-        long long start_time = get_current_time_ms();
-
-        cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << endl;
+        stats.add_metadata("payload", corpus.payloads().spec().describe());
+        stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+        stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
-        auto_ptr<ConnectionFactory> factory(ConnectionFactory::createCMSConnectionFactory("tcp://localhost:61616"));
-        auto_ptr<Connection> connection(factory->createConnection());
+        // Async sends return without waiting for the broker's receipt
+        ActiveMQConnectionFactory factory("tcp://localhost:61616");
+        factory.setUseAsyncSend(use_pipeline);
+        auto_ptr<Connection> connection(factory.createConnection());
         connection->start();
 
-        vector<future<TaskResult>> futures;
-        for (auto& item : test_data) {
-            futures.push_back(async(launch::async, send_message_task, connection.get(), item));
+        // --wait-ready: PING every receiver's queue before the clock starts, skipping
+        // answers to stale PINGs that were queued before the receiver came up
+        ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "activemq-async-sender");
+        if (ready.options().enabled()) {
+            SessionContext ctx(connection.get());
+            MessageEnvelope pong;
+            ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id,
+                                                            std::string_view ping) -> const MessageEnvelope* {
+                auto_ptr<BytesMessage> message(ctx.session->createBytesMessage((unsigned char*)ping.data(), ping.size()));
+                message->setCMSReplyTo(ctx.replyDest.get());
+                message->setCMSCorrelationID(ping_id);
+                auto_ptr<Destination> destination(ctx.session->createQueue("test_queue_" + to_string(target)));
+                ctx.producer->send(destination.get(), message.get());
+
+                long long sent_ns = get_steady_time_ns();
+                for (long long remaining_ms = 100; remaining_ms > 0;
+                     remaining_ms = 100 - static_cast<long long>(elapsed_ms_since(sent_ns))) {
+                    auto_ptr<Message> reply(ctx.consumer->receive((int)remaining_ms));
+                    if (!reply.get()) {
+                        break;
+                    }
+                    const BytesMessage* bytesReply = dynamic_cast<const BytesMessage*>(reply.get());
+                    if (bytesReply && bytesReply->getCMSCorrelationID() == ping_id) {
+                        vector<unsigned char> buffer(bytesReply->getBodyLength());
+                        bytesReply->readBytes(buffer.data(), (int)buffer.size());
+                        return message_helpers::parse_envelope(buffer.data(), buffer.size(), pong) ? &pong : nullptr;
+                    }
+                }
+                return nullptr;
+            });
         }
+        stats.add_metadata("ready", ready.report());
+        messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+        stats.attach_live(live.recorder());
+        live.start("ActiveMQ");
+        perf.start();
+        long long start_ns = get_steady_time_ns();
+
+        cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << endl;
+        messaging::utils::LogSummary& progress =
+            messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
 
-        for (auto& fut : futures) {
-            TaskResult res = fut.get();
+        auto on_result = [&](const TaskResult& res) {
             if (res.success) {
-                stats.record_message(true, res.duration);
-                cout << " [OK] Message " << res.message_id << " acknowledged" << endl;
+                stats.record_message_ns(true, res.duration_ns);
+                stats.record_breakdown(res.ack_timing, res.duration_ns);
+                stats.record_bytes(res.bytes);
+                progress.add(0);
+                log_debug() << " [OK] Message " << res.message_id << " acknowledged";
             } else {
                 stats.record_message(false);
-                cout << " [FAILED] Message " << res.message_id << ": " << res.error << endl;
+                progress.add(1);
+                log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
             }
-        }
+        };
+
+        if (use_pipeline) {
+            // Replies for every producer session arrive on one temporary queue
+            ReplyDemux demux(1000);  // 1s timeout
+            auto_ptr<Session> replySession(connection->createSession(Session::AUTO_ACKNOWLEDGE));
+            auto_ptr<Destination> replyDest(replySession->createTemporaryQueue());
+            auto_ptr<MessageConsumer> replyConsumer(replySession->createConsumer(replyDest.get()));
+            replyConsumer->setMessageListener(&demux);
 
+            vector<unique_ptr<ProducerSession>> producers;
+            for (int s = 0; s < num_sessions; ++s) {
+                producers.emplace_back(new ProducerSession(connection.get()));
+            }
+            int peak = run_reply_pipeline(producers, replyDest.get(), demux, corpus, options.max_in_flight, on_result, stats);
+            stats.add_metadata("peak_in_flight", peak);
+            stats.add_metadata("sessions", num_sessions);
+
+            replyConsumer->close();
+            producers.clear();
+        } else {
+            ConnectionPool<SessionContext> pool([&](int) -> unique_ptr<SessionContext> {
+                try {
+                    return unique_ptr<SessionContext>(new SessionContext(connection.get()));
+                } catch (CMSException& e) {
+                    return nullptr;
+                }
+            });
+
+            AsyncSendEngine engine(options);
+            engine.run(corpus.size(),
+                [&](size_t i, const Attempt& attempt) {
+                    if (attempt.number == 0) {
+                        stats.record_dispatch();
+                    }
+                    return send_message_task(pool, corpus, i, attempt);
+                },
+                on_result);
+            stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+            if (options.open_loop()) {
+                stats.add_metadata("open_loop", engine.open_loop_report());
+            }
+            if (options.policy.enabled()) {
+                stats.add_metadata("request_policy", engine.policy_report());
+            }
+            if (options.qos.enabled()) {
+                stats.add_metadata("qos", options.qos.report(engine.retransmits()));
+            }
+            stats.add_metadata("connections_created", pool.created_count());
+
+            pool.clear();
+        }
         connection->close();
 
-        long long end_time = get_current_time_ms();
-        stats.set_duration(start_time, end_time);
+        long long end_ns = get_steady_time_ns();
+        stats.set_duration_ns(start_ns, end_ns);
+        live.stop();
+        perf.stop();
         
         json report = stats.get_stats();
+        perf.add_to(report, stats.processed_count);
 
+        messaging::utils::flush_log();
         cout << "\nTest Results (ASYNC):" << endl;
         cout << "total_sent: " << stats.sent_count << endl;
         cout << "total_received: " << stats.received_count << endl;
@@ -10,9 +10,16 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <memory>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
 
 using namespace activemq::core;
 using namespace decaf::util::concurrent;
@@ -20,7 +27,15 @@ using namespace cms;
 using namespace std;
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::TaskResult;
 
 class ReplyListener : public MessageListener {
 private:
@@ -50,83 +65,159 @@ public:
     }
 };
 
-int main() {
+// One sending thread's session and temporary reply queue; CMS sessions are single-threaded
+struct ReplySession {
+    ReplyListener listener;   // outlives the consumer that calls it
+    auto_ptr<Session> session;
+    auto_ptr<Destination> replyDest;
+    auto_ptr<MessageProducer> producer;
+    auto_ptr<MessageConsumer> consumer;
+    int corrCounter = 0;
+
+    explicit ReplySession(Connection* connection)
+        : session(connection->createSession(Session::AUTO_ACKNOWLEDGE)),
+          replyDest(session->createTemporaryQueue()),
+          producer(session->createProducer(NULL)),
+          consumer(session->createConsumer(replyDest.get())) {
+        producer->setDeliveryMode(DeliveryMode::NON_PERSISTENT);
+        consumer->setMessageListener(&listener);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
     activemq::library::ActiveMQCPP::initializeLibrary();
 
     try {
-        auto test_data = test_data_loader::loadTestData();
+        auto corpus = test_data_loader::preEncodeTestFile();
+        corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+        QoSOptions qos = QoSOptions::from_args(argc, argv);
+        corpus.attach_qos(qos);
         
         MessageStats stats;
         stats.set_metadata({
             {"service", "ActiveMQ"},
             {"language", "C++"},
-            {"async", false}
+            {"async", false},
+            {"partitions", partition_options.partitions}
         });
-        long long start_time = get_current_time_ms();
+        stats.add_metadata("payload", corpus.payloads().spec().describe());
+        stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+        stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
         auto_ptr<ConnectionFactory> factory(ConnectionFactory::createCMSConnectionFactory("tcp://localhost:61616"));
         auto_ptr<Connection> connection(factory->createConnection());
         connection->start();
 
-        auto_ptr<Session> session(connection->createSession(Session::AUTO_ACKNOWLEDGE));
-        auto_ptr<Destination> replyDest(session->createTemporaryQueue());
-        auto_ptr<MessageProducer> producer(session->createProducer(NULL));
-        producer->setDeliveryMode(DeliveryMode::NON_PERSISTENT);
+        // --wait-ready: PING every receiver's queue before the clock starts; replies are
+        // matched on the PING's correlation id, so answers to stale queued PINGs are ignored
+        ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "activemq-sender");
+        if (ready.options().enabled()) {
+            ReplySession rs(connection.get());
+            MessageEnvelope pong;
+            ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+                auto_ptr<BytesMessage> message(rs.session->createBytesMessage((unsigned char*)ping.data(), ping.size()));
+                message->setCMSReplyTo(rs.replyDest.get());
+                message->setCMSCorrelationID(ping_id);
+                auto_ptr<Destination> destination(rs.session->createQueue("test_queue_" + to_string(target)));
 
-        ReplyListener listener;
-        auto_ptr<MessageConsumer> consumer(session->createConsumer(replyDest.get()));
-        consumer->setMessageListener(&listener);
+                CountDownLatch latch(1);
+                rs.listener.setLatch(&latch, ping_id);
+                rs.producer->send(destination.get(), message.get());
+                bool replied = latch.await(100) && message_helpers::parse_envelope(rs.listener.getResponse(), pong);
+                return replied ? &pong : nullptr;
+            });
+        }
+        stats.add_metadata("ready", ready.report());
+        messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+        stats.attach_live(live.recorder());
+        live.start("ActiveMQ");
+        perf.start();
+        long long start_ns = get_steady_time_ns();
 
-        cout << " [x] Starting transfer of " << test_data.size() << " messages..." << endl;
+        cout << " [x] Starting transfer of " << corpus.size() << " messages..." << endl;
+        messaging::utils::LogSummary& progress =
+            messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
 
-        int corrCounter = 0;
-        for (auto& item : test_data) {
-            string message_id = message_helpers::extract_message_id(item);
-            int target = item.value("target", 0);
-            cout << " [x] Sending message " << message_id << " to target " << target << "..." << flush;
-            
-            long long msg_start = get_current_time_ms();
+        messaging::utils::TopicTable queue_names("test_queue_");
+        auto send_one = [&](ReplySession& rs, size_t i) {
+            TaskResult res;
+            res.message_id.assign(corpus.message_id(i));
+            int target = corpus.target(i);
+            long long msg_start = get_steady_time_ns();
             
-            // Create protobuf envelope
-            MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-            string body = message_helpers::serialize_envelope(envelope);
+            // Stamp the pre-encoded envelope
+            std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
             
             // Send as BytesMessage
-            auto_ptr<BytesMessage> message(session->createBytesMessage((unsigned char*)body.data(), body.size()));
-            message->setCMSReplyTo(replyDest.get());
-            message->setCMSCorrelationID("corr-cpp-" + to_string(++corrCounter));
+            auto_ptr<BytesMessage> message(rs.session->createBytesMessage((unsigned char*)body.data(), body.size()));
+            message->setCMSReplyTo(rs.replyDest.get());
+            message->setCMSCorrelationID("corr-cpp-" + to_string(++rs.corrCounter));
             
-            string destName = "test_queue_" + to_string(target);
-            auto_ptr<Destination> destination(session->createQueue(destName));
+            auto_ptr<Destination> destination(rs.session->createQueue(queue_names[target]));
             
             CountDownLatch latch(1);
-            listener.setLatch(&latch, message->getCMSCorrelationID());
+            rs.listener.setLatch(&latch, message->getCMSCorrelationID());
             
-            producer->send(destination.get(), message.get());
+            TRACED("send", rs.producer->send(destination.get(), message.get()));
             
-            if (latch.await(40)) {  // 40ms timeout
-                string response = listener.getResponse();
+            if (TRACED("wait", latch.await(40))) {  // 40ms timeout
+                string response = rs.listener.getResponse();
                 MessageEnvelope resp_envelope;
                 if (message_helpers::parse_envelope(response, resp_envelope) && 
-                    message_helpers::is_valid_ack(resp_envelope, message_id)) {
-                    long long msg_duration = get_current_time_ms() - msg_start;
-                    stats.record_message(true, msg_duration);
-                    cout << " [OK]" << endl;
+                    message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
+                    res.success = true;
+                    res.duration_ns = get_steady_time_ns() - msg_start;
+                    res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
+                    res.bytes = body.size();
+                    log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
                 } else {
-                    stats.record_message(false);
-                    cout << " [FAILED] Invalid ACK" << endl;
+                    res.error = "Invalid ACK";
+                    log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] Invalid ACK";
                 }
             } else {
-                stats.record_message(false);
-                cout << " [FAILED] Timeout" << endl;
+                res.error = "Timeout";
+                log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] Timeout";
             }
+            return res;
+        };
+        // Sessions share the connection; each partition creates its own on its thread
+        PartitionedSender sender(partition_options, qos);
+        sender.run(corpus.size(),
+            [&](size_t i) { return corpus.target(i); },
+            [&](size_t) { return std::make_unique<ReplySession>(connection.get()); },
+            [&](std::unique_ptr<ReplySession>& rs, size_t i) { return send_one(*rs, i); },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
+                } else {
+                    stats.record_message(false);
+                    progress.add(1);
+                }
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
 
-        long long end_time = get_current_time_ms();
-        stats.set_duration(start_time, end_time);
+        long long end_ns = get_steady_time_ns();
+        stats.set_duration_ns(start_ns, end_ns);
+        live.stop();
+        perf.stop();
         
         json report = stats.get_stats();
+        perf.add_to(report, stats.processed_count);
 
+        messaging::utils::flush_log();
         cout << "\nTest Results:" << endl;
         cout << "service: ActiveMQ" << endl;
         cout << "language: C++" << endl;
@@ -0,0 +1,38 @@
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> g_allocations{0};
+    std::atomic<size_t> g_bytes{0};
+
+    void* counted_alloc(size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+namespace alloc_counter {
+
+    size_t allocations() {
+        return g_allocations.load(std::memory_order_relaxed);
+    }
+
+    size_t allocated_bytes() {
+        return g_bytes.load(std::memory_order_relaxed);
+    }
+
+} // namespace alloc_counter
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,23 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef>
+
+/**
+ * Process-wide heap allocation counter for benchmarks.
+ *
+ * alloc_counter.cpp replaces the global operator new/delete, so linking it
+ * into a benchmark counts every allocation made through them (including
+ * protobuf and std::string internals).
+ */
+namespace alloc_counter {
+
+    // Number of operator new calls since program start
+    size_t allocations();
+
+    // Number of bytes requested through operator new since program start
+    size_t allocated_bytes();
+
+} // namespace alloc_counter
+
+#endif // ALLOC_COUNTER_HPP
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "alloc_counter.hpp"
+#include "../utils/cpp/test_data_loader.hpp"
+#include "../utils/cpp/message_helpers.hpp"
+
+/**
+ * Heap allocations per message for the sender/receiver envelope helpers.
+ *
+ * Compares the value-returning helpers (fresh MessageEnvelope, DataMessage and
+ * output string per message) with the arena-backed variants and with refilling
+ * one reused envelope. Run from the repo root or pass a test_data.json path.
+ */
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Result {
+    double allocs_per_msg;
+    double ns_per_msg;
+};
+
+Result measure(size_t rounds, size_t per_round, const std::function<void()>& round) {
+    round();  // warm up, so reused buffers reach their steady-state capacity
+
+    size_t allocs_before = alloc_counter::allocations();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        round();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    size_t allocs = alloc_counter::allocations() - allocs_before;
+
+    double messages = static_cast<double>(rounds * per_round);
+    return {allocs / messages,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / messages};
+}
+
+void print(const std::string& name, const Result& r) {
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << r.allocs_per_msg << " allocs/msg"
+              << std::setw(12) << r.ns_per_msg << " ns/msg" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<json> test_data = test_data_loader::loadTestData(argc > 1 ? argv[1] : "");
+    size_t rounds = 20;
+    size_t n = test_data.size();
+
+    // Wire bytes a receiver would see, built once up front
+    std::vector<std::string> wire;
+    wire.reserve(n);
+    for (const auto& item : test_data) {
+        wire.push_back(message_helpers::serialize_envelope(message_helpers::create_data_envelope(item)));
+    }
+    const std::string receiver_id = "0";
+
+    std::cout << "Envelope helper allocations over " << n << " messages x " << rounds << " rounds" << std::endl;
+
+    std::cout << "sender (create + serialize):" << std::endl;
+    print("value helpers", measure(rounds, n, [&]() {
+        for (const auto& item : test_data) {
+            MessageEnvelope envelope = message_helpers::create_data_envelope(item);
+            std::string body = message_helpers::serialize_envelope(envelope);
+        }
+    }));
+
+    message_helpers::MessageArena arena;
+    std::string out;
+    print("arena + reused buffer", measure(rounds, n, [&]() {
+        for (const auto& item : test_data) {
+            arena.reset();
+            MessageEnvelope* envelope = message_helpers::create_data_envelope(arena.get(), item);
+            message_helpers::serialize_envelope(*envelope, out);
+        }
+    }));
+
+    MessageEnvelope reused;
+    DataMessage reused_data;
+    print("reused envelope + buffer", measure(rounds, n, [&]() {
+        for (const auto& item : test_data) {
+            message_helpers::fill_data_envelope(&reused, &reused_data, item);
+            message_helpers::serialize_envelope(reused, out);
+        }
+    }));
+
+    std::cout << "receiver (parse + ack + serialize):" << std::endl;
+    print("value helpers", measure(rounds, n, [&]() {
+        for (const auto& body : wire) {
+            MessageEnvelope request;
+            message_helpers::parse_envelope(body, request);
+            MessageEnvelope ack = message_helpers::create_ack_from_envelope(request, receiver_id);
+            std::string reply = message_helpers::serialize_envelope(ack);
+        }
+    }));
+
+    print("arena + reused buffer", measure(rounds, n, [&]() {
+        for (const auto& body : wire) {
+            arena.reset();
+            auto* request = google::protobuf::Arena::CreateMessage<MessageEnvelope>(arena.get());
+            message_helpers::parse_envelope(body.data(), body.size(), *request);
+            MessageEnvelope* ack = message_helpers::create_ack_from_envelope(arena.get(), *request, receiver_id);
+            message_helpers::serialize_envelope(*ack, out);
+        }
+    }));
+
+    MessageEnvelope reused_ack;
+    print("reused envelope + buffer", measure(rounds, n, [&]() {
+        for (const auto& body : wire) {
+            message_helpers::parse_envelope(body.data(), body.size(), reused);
+            message_helpers::fill_ack_for(&reused_ack, reused, receiver_id);
+            message_helpers::serialize_envelope(reused_ack, out);
+        }
+    }));
+
+    return 0;
+}
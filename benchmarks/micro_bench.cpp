@@ -0,0 +1,310 @@
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "alloc_counter.hpp"
+#include "../utils/cpp/test_data_loader.hpp"
+#include "../utils/cpp/message_helpers.hpp"
+#include "../utils/cpp/ack_encoder.hpp"
+#include "../utils/cpp/messaging_utils.hpp"
+#include "../utils/cpp/stats_collector.hpp"
+#include "../utils/cpp/dedup_window.hpp"
+#include "../utils/cpp/shm_ring.hpp"
+
+/**
+ * Google Benchmark cases for the shared C++ hot paths.
+ *
+ * Every case reports allocs_per_iter and alloc_bytes_per_iter next to its
+ * time, so an allocation added to a helper shows up here before a broker run.
+ * Message cases cycle through test_data.json (set TEST_DATA_PATH or run from
+ * the repo root); standard Google Benchmark flags such as --benchmark_filter
+ * and --benchmark_format=json apply.
+ */
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::vector<json>& corpus() {
+    static const std::vector<json> items = [] {
+        std::vector<json> loaded = test_data_loader::loadTestData("");
+        if (loaded.empty()) {
+            loaded.push_back({{"message_id", 1}, {"message_name", "test_1"},
+                              {"message_value", {"BE97", "8C68", "0A49", "717D"}}, {"target", 0}});
+        }
+        return loaded;
+    }();
+    return items;
+}
+
+const std::vector<MessageEnvelope>& envelopes() {
+    static const std::vector<MessageEnvelope> built = [] {
+        std::vector<MessageEnvelope> out;
+        for (const auto& item : corpus()) {
+            out.push_back(message_helpers::create_data_envelope(item));
+        }
+        return out;
+    }();
+    return built;
+}
+
+const std::vector<std::string>& wire() {
+    static const std::vector<std::string> encoded = [] {
+        std::vector<std::string> out;
+        for (const auto& envelope : envelopes()) {
+            out.push_back(message_helpers::serialize_envelope(envelope));
+        }
+        return out;
+    }();
+    return encoded;
+}
+
+// Heap allocations made between construction and destruction, as per-iteration counters
+class AllocScope {
+public:
+    explicit AllocScope(benchmark::State& state)
+        : state_(state), allocs_(alloc_counter::allocations()), bytes_(alloc_counter::allocated_bytes()) {}
+
+    ~AllocScope() {
+        state_.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(alloc_counter::allocations() - allocs_), benchmark::Counter::kAvgIterations);
+        state_.counters["alloc_bytes_per_iter"] = benchmark::Counter(
+            static_cast<double>(alloc_counter::allocated_bytes() - bytes_), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    size_t allocs_;
+    size_t bytes_;
+};
+
+const std::string kReceiverId = "0";
+
+} // namespace
+
+static void BM_CreateDataEnvelope(benchmark::State& state) {
+    const auto& items = corpus();
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        MessageEnvelope envelope = message_helpers::create_data_envelope(items[i++ % items.size()]);
+        benchmark::DoNotOptimize(envelope);
+    }
+}
+BENCHMARK(BM_CreateDataEnvelope);
+
+static void BM_FillDataEnvelope(benchmark::State& state) {
+    const auto& items = corpus();
+    MessageEnvelope envelope;
+    DataMessage data;
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        message_helpers::fill_data_envelope(&envelope, &data, items[i++ % items.size()]);
+        benchmark::DoNotOptimize(envelope);
+    }
+}
+BENCHMARK(BM_FillDataEnvelope);
+
+static void BM_SerializeEnvelope(benchmark::State& state) {
+    const auto& all = envelopes();
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        std::string body = message_helpers::serialize_envelope(all[i++ % all.size()]);
+        benchmark::DoNotOptimize(body);
+    }
+}
+BENCHMARK(BM_SerializeEnvelope);
+
+static void BM_SerializeEnvelopeReusedBuffer(benchmark::State& state) {
+    const auto& all = envelopes();
+    std::string buffer;
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(message_helpers::serialize_envelope(all[i++ % all.size()], buffer));
+    }
+}
+BENCHMARK(BM_SerializeEnvelopeReusedBuffer);
+
+static void BM_ParseEnvelope(benchmark::State& state) {
+    const auto& bodies = wire();
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        MessageEnvelope envelope;
+        benchmark::DoNotOptimize(message_helpers::parse_envelope(bodies[i++ % bodies.size()], envelope));
+    }
+}
+BENCHMARK(BM_ParseEnvelope);
+
+static void BM_ParseEnvelopeReused(benchmark::State& state) {
+    const auto& bodies = wire();
+    MessageEnvelope envelope;
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        const std::string& body = bodies[i++ % bodies.size()];
+        benchmark::DoNotOptimize(message_helpers::parse_envelope(body.data(), body.size(), envelope));
+    }
+}
+BENCHMARK(BM_ParseEnvelopeReused);
+
+static void BM_CreateAckFromEnvelope(benchmark::State& state) {
+    const auto& all = envelopes();
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        MessageEnvelope ack = message_helpers::create_ack_from_envelope(all[i++ % all.size()], kReceiverId);
+        benchmark::DoNotOptimize(ack);
+    }
+}
+BENCHMARK(BM_CreateAckFromEnvelope);
+
+// The receiver path: ACK built and serialized, against the pre-encoded template
+static void BM_CreateAndSerializeAck(benchmark::State& state) {
+    const auto& all = envelopes();
+    message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+    std::string buffer;
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        MessageEnvelope ack = message_helpers::create_ack_from_envelope(all[i++ % all.size()], kReceiverId, timing);
+        benchmark::DoNotOptimize(message_helpers::serialize_envelope(ack, buffer));
+    }
+}
+BENCHMARK(BM_CreateAndSerializeAck);
+
+static void BM_EncodeAckTemplate(benchmark::State& state) {
+    const auto& all = envelopes();
+    message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+    messaging::utils::AckEncoder acks(kReceiverId);
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(acks.encode(all[i++ % all.size()], timing));
+    }
+}
+BENCHMARK(BM_EncodeAckTemplate);
+
+static void BM_IsValidAck(benchmark::State& state) {
+    const auto& all = envelopes();
+    std::vector<MessageEnvelope> acks;
+    for (const auto& envelope : all) {
+        acks.push_back(message_helpers::create_ack_from_envelope(envelope, kReceiverId));
+    }
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        size_t k = i++ % acks.size();
+        benchmark::DoNotOptimize(message_helpers::is_valid_ack(acks[k], all[k].message_id()));
+    }
+}
+BENCHMARK(BM_IsValidAck);
+
+static void BM_UtilsToProto(benchmark::State& state) {
+    messaging::utils::MessageEnvelope envelope =
+        messaging::utils::MessageEnvelope::from_proto(envelopes()[0]);
+    envelope.metadata["reply_to"] = "reply_channel";
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        ::messaging::MessageEnvelope proto = envelope.to_proto();
+        benchmark::DoNotOptimize(proto);
+    }
+}
+BENCHMARK(BM_UtilsToProto);
+
+static void BM_UtilsFromProto(benchmark::State& state) {
+    MessageEnvelope proto = envelopes()[0];
+    (*proto.mutable_metadata())["reply_to"] = "reply_channel";
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        messaging::utils::MessageEnvelope envelope = messaging::utils::MessageEnvelope::from_proto(proto);
+        benchmark::DoNotOptimize(envelope);
+    }
+}
+BENCHMARK(BM_UtilsFromProto);
+
+static void BM_UtilsToJson(benchmark::State& state) {
+    messaging::utils::MessageEnvelope envelope =
+        messaging::utils::MessageEnvelope::from_proto(envelopes()[0]);
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        std::string text = envelope.to_json();
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_UtilsToJson);
+
+static void BM_GenerateMessageId(benchmark::State& state) {
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        std::string id = messaging::utils::MessageEnvelope::generate_message_id();
+        benchmark::DoNotOptimize(id);
+    }
+}
+BENCHMARK(BM_GenerateMessageId);
+
+// Arg: latency samples recorded before the report is built
+static void BM_MessageStatsGetStats(benchmark::State& state) {
+    MessageStats stats;
+    stats.set_metadata({{"service", "bench"}, {"language", "C++"}});
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        stats.record_message_ns(true, 100000 + (i * 7919) % 5000000);
+    }
+    stats.set_duration_ns(1, 1000000001);
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        json report = stats.get_stats();
+        benchmark::DoNotOptimize(report);
+    }
+}
+BENCHMARK(BM_MessageStatsGetStats)->Arg(1000)->Arg(1000000);
+
+// Receiver-side EXACTLY_ONCE check per message; Arg: senders interleaved, each in sequence order
+static void BM_DedupBySequence(benchmark::State& state) {
+    messaging::utils::DedupFilter filter;
+    ::messaging::MessageEnvelope message;
+    uint64_t senders = static_cast<uint64_t>(state.range(0));
+    uint64_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        uint64_t sender = i % senders;
+        message.set_message_seq(messaging::utils::compose_message_seq(static_cast<uint32_t>(sender), i / senders + 1));
+        benchmark::DoNotOptimize(filter.check_and_mark(message));
+        ++i;
+    }
+}
+BENCHMARK(BM_DedupBySequence)->Arg(1)->Arg(64);
+
+// The same for peers that only set the string message_id
+static void BM_DedupByMessageId(benchmark::State& state) {
+    messaging::utils::DedupFilter filter;
+    std::vector<::messaging::MessageEnvelope> messages(envelopes().size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        messages[i].set_message_id(envelopes()[i].message_id());
+    }
+    size_t i = 0;
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.check_and_mark(messages[i++ % messages.size()]));
+    }
+}
+BENCHMARK(BM_DedupByMessageId);
+
+// One push and one read through a shared-memory ring on one thread, the copy and atomics
+// without any wakeup; Arg: message bytes (over 496 spans slots)
+static void BM_ShmRingPushRead(benchmark::State& state) {
+    auto ring = messaging::utils::ShmRing::create("/messaging_shm_bench_" + std::to_string(getpid()),
+                                                  messaging::utils::ShmRingOptions());
+    std::string message(static_cast<size_t>(state.range(0)), 'm');
+    AllocScope allocs(state);
+    for (auto _ : state) {
+        ring->try_push(message.data(), message.size());
+        benchmark::DoNotOptimize(ring->read(0));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShmRingPushRead)->Arg(256)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -1,14 +1,42 @@
 import json
+import os
 import random
+import struct
 import argparse
 
 def generate_random_hex_16bit():
     return f"{random.randint(0, 0xFFFF):04X}"
 
+def write_binary_corpus(data, path):
+    """Write the compact corpus read by test_data_loader.cpp (little-endian):
+
+    header: b"PSCORPUS", u32 version=1, u32 reserved, u64 count
+    record: u32 body_size, then i32 target, u8 id_kind (0=int, 1=str),
+            i64 id | u16 len + bytes, u16 len + message_name,
+            u16 value_count, value_count x (u16 len + bytes)
+    """
+    def short_string(value):
+        encoded = str(value).encode("utf-8")
+        return struct.pack("<H", len(encoded)) + encoded
+
+    with open(path, "wb") as f:
+        f.write(b"PSCORPUS" + struct.pack("<IIQ", 1, 0, len(data)))
+        for item in data:
+            body = struct.pack("<i", item["target"])
+            if isinstance(item["message_id"], int):
+                body += struct.pack("<Bq", 0, item["message_id"])
+            else:
+                body += struct.pack("<B", 1) + short_string(item["message_id"])
+            body += short_string(item["message_name"])
+            body += struct.pack("<H", len(item["message_value"]))
+            body += b"".join(short_string(v) for v in item["message_value"])
+            f.write(struct.pack("<I", len(body)) + body)
+
 def main():
     parser = argparse.ArgumentParser(description="Generate test data for messaging service evaluation")
     parser.add_argument("--messages", type=int, default=35, help="Number of messages to generate (default: 35)")
     parser.add_argument("--receivers", type=int, default=32, help="Number of receivers to distribute messages across (default: 32)")
+    parser.add_argument("--binary", action="store_true", help="Also write test_data.bin, the compact corpus C++ senders prefer over JSON")
     args = parser.parse_args()
 
     messages = args.messages
@@ -28,5 +56,12 @@ def main():
 
     print(f"Generated {messages} messages in test_data.json (distributed across {receivers} receivers)")
 
+    if args.binary:
+        write_binary_corpus(data, 'test_data.bin')
+        print(f"Wrote binary corpus test_data.bin ({os.path.getsize('test_data.bin')} bytes)")
+    elif os.path.exists('test_data.bin'):
+        # A stale corpus would shadow the new JSON for C++ senders
+        os.remove('test_data.bin')
+
 if __name__ == "__main__":
     main()
@@ -65,8 +65,8 @@ def main():
         "32 Py / 0 C++", "31 Py / 1 C++", "24 Py / 8 C++", "20 Py / 12 C++", "16 Py / 16 C++", "8 Py / 24 C++", "0 Py / 32 C++"
     ]
     
-    print("| Service | Sender | Receiver Split | Throughput (msgs/ms) | Success Rate |")
-    print("|---|---|---|---|---|")
+    print("| Service | Sender | Receiver Split | Payload | Throughput (msgs/ms) | Throughput (MB/s) | Out / Proc / Return p50 (ms) | Success Rate |")
+    print("|---|---|---|---|---|---|---|---|")
     
     for svc_norm in sorted_services:
          # Find original display name from data
@@ -99,8 +99,20 @@ def main():
                  tput_str = f"{tput:.2f}"
                  if tput > 2.0:
                      tput_str = f"**{tput_str}**"
+                 
+                 # Older reports and the Python senders carry no byte counts
+                 payload = run.get('payload', 'none')
+                 mbps = run.get('megabytes_per_sec')
+                 mbps_str = f"{mbps:.2f}" if mbps is not None else "-"
+                 
+                 # Only ACKs that carry receiver timing are broken down
+                 breakdown = run.get('latency_breakdown')
+                 if breakdown:
+                     legs_str = " / ".join(f"{breakdown[leg]['p50_ms']:.3f}" for leg in ('outbound', 'processing', 'return'))
+                 else:
+                     legs_str = "-"
                      
-                 print(f"| {display_name} | {sender} | {split_name} | {tput_str} | {success_rate:.1f}% |")
+                 print(f"| {display_name} | {sender} | {split_name} | {payload} | {tput_str} | {mbps_str} | {legs_str} | {success_rate:.1f}% |")
 
 if __name__ == '__main__':
     main()
@@ -0,0 +1,117 @@
+#ifndef BROKER_PUBSUB_HPP
+#define BROKER_PUBSUB_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <chrono>
+#include <grpcpp/grpcpp.h>
+#include "messaging.grpc.pb.h"
+#include "../../utils/cpp/pubsub.hpp"
+
+/**
+ * UnifiedPublisher/UnifiedSubscriber over the server.cpp broker: one
+ * StreamMessages stream each. The broker subscribes a stream to a topic
+ * when it sends an empty envelope on it and broadcasts every envelope with a
+ * payload; a subscriber whose queue passes the broker's --queue-depth has
+ * the excess dropped (or is disconnected, with --slow-policy disconnect).
+ *
+ * The stream carries MessageEnvelope objects rather than bytes, so the
+ * publisher parses each body once and the subscriber re-serializes what it
+ * reads for FanoutBench; both copies are part of what a gRPC client pays.
+ */
+
+class GrpcBrokerPublisher : public messaging::utils::UnifiedPublisher {
+private:
+    std::string _address;
+    std::unique_ptr<messaging::MessagingService::Stub> _stub;
+    std::unique_ptr<grpc::ClientContext> _context;
+    std::unique_ptr<grpc::ClientReaderWriter<messaging::MessageEnvelope, messaging::MessageEnvelope>> _stream;
+    messaging::MessageEnvelope _envelope;
+
+public:
+    explicit GrpcBrokerPublisher(const std::string& address = "localhost:50051")
+        : UnifiedPublisher("gRPC"), _address(address) {}
+    ~GrpcBrokerPublisher() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _stub = messaging::MessagingService::NewStub(
+            grpc::CreateChannel(_address, grpc::InsecureChannelCredentials()));
+        _context = std::make_unique<grpc::ClientContext>();
+        _stream = _stub->StreamMessages(_context.get());
+        return _stream != nullptr;
+    }
+
+    void disconnect() override {
+        if (_stream) {
+            _stream->WritesDone();
+            _stream->Finish();
+            _stream.reset();
+        }
+        _context.reset();
+        _stub.reset();
+    }
+
+    bool publish(std::string_view body) override {
+        return _stream && _envelope.ParseFromArray(body.data(), static_cast<int>(body.size())) &&
+               _stream->Write(_envelope);
+    }
+};
+
+// Subscribed by an empty envelope on the topic; Read has no timeout, so the run ends it with interrupt()
+class GrpcBrokerSubscriber : public messaging::utils::UnifiedSubscriber {
+private:
+    std::string _topic;
+    std::string _address;
+    std::unique_ptr<messaging::MessagingService::Stub> _stub;
+    std::unique_ptr<grpc::ClientContext> _context;
+    std::unique_ptr<grpc::ClientReaderWriter<messaging::MessageEnvelope, messaging::MessageEnvelope>> _stream;
+    messaging::MessageEnvelope _envelope;
+    std::string _body;
+    bool _closed = false;  // the stream ended: cancelled, or dropped by the broker
+
+public:
+    GrpcBrokerSubscriber(const std::string& topic, const std::string& address = "localhost:50051")
+        : UnifiedSubscriber("gRPC"), _topic(topic), _address(address),
+          _context(std::make_unique<grpc::ClientContext>()) {}
+    ~GrpcBrokerSubscriber() override { disconnect(); }
+
+    bool connect() override {
+        _stub = messaging::MessagingService::NewStub(
+            grpc::CreateChannel(_address, grpc::InsecureChannelCredentials()));
+        _stream = _stub->StreamMessages(_context.get());
+        messaging::MessageEnvelope subscription;
+        subscription.set_topic(_topic);
+        return _stream && _stream->Write(subscription);
+    }
+
+    void disconnect() override {
+        if (_stream) {
+            _context->TryCancel();
+            _stream->Finish();
+            _stream.reset();
+        }
+        _stub.reset();
+    }
+
+    std::optional<std::string_view> receive(int timeout_ms) override {
+        if (!_stream || _closed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return std::nullopt;
+        }
+        if (!_stream->Read(&_envelope)) {
+            _closed = true;
+            return std::nullopt;
+        }
+        _envelope.SerializeToString(&_body);
+        return std::string_view(_body);
+    }
+
+    // The context outlives the stream, so cancelling from the run's thread is always safe
+    void interrupt() override { _context->TryCancel(); }
+};
+
+#endif // BROKER_PUBSUB_HPP
@@ -28,7 +28,7 @@ int main(int argc, char** argv) {
     std::unique_ptr<MessagingService::Stub> stub = MessagingService::NewStub(channel);
 
     ClientContext context;
-    std::shared_ptr<ClientReaderWriter<MessageEnvelope, MessageEnvelope>> stream(stub->SubscribeAndPublish(&context));
+    std::shared_ptr<ClientReaderWriter<MessageEnvelope, MessageEnvelope>> stream(stub->StreamMessages(&context));
 
     // Thread to handle incoming messages (optional for publisher)
     std::thread reader_thread([stream]() {
@@ -1,20 +1,27 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
+#include <mutex>
 #include <signal.h>
 #include <atomic>
 #include <thread>
+#include <chrono>
+#include <algorithm>
 #include <grpcpp/grpcpp.h>
 #include "messaging.grpc.pb.h"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
 
 using grpc::Server;
 using grpc::ServerBuilder;
 using grpc::ServerContext;
+using grpc::ServerCompletionQueue;
+using grpc::ServerAsyncResponseWriter;
+using grpc::ServerAsyncReaderWriter;
 using grpc::Status;
 using messaging::MessageEnvelope;
 using messaging::MessagingService;
-using message_helpers::get_current_time_ms;
 
 std::atomic<bool> running(true);
 
@@ -22,56 +29,242 @@ void signal_handler(int sig) {
     running = false;
 }
 
-class AsyncMessagingServiceImpl final : public MessagingService::Service {
+/**
+ * Completion-queue driven receiver.
+ *
+ * Each completion queue owns a fixed pool of call objects, every one waiting
+ * on an incoming SendMessage or StreamMessages call. A finished call resets
+ * its context and re-arms itself instead of being freed, so steady-state
+ * serving allocates no call state. Calls log nothing; the per-message
+ * std::cout line of the sync service was a large share of its cost.
+ */
+struct QueueState {
+    MessagingService::AsyncService* service;
+    std::unique_ptr<ServerCompletionQueue> cq;
+    std::string receiver_id;
+    std::mutex mu;          // orders re-arming against shutdown
+    bool accepting = true;
+};
+
+class CallData {
+public:
+    explicit CallData(QueueState& queue) : queue_(queue) {}
+    virtual ~CallData() = default;
+
+    // Handle the completion of this call's last operation
+    virtual void proceed(bool ok) = 0;
+
+protected:
+    // Answer request into reply, reusing reply's storage
+    void respond(const MessageEnvelope& request, MessageEnvelope& reply) {
+        if (message_helpers::is_batch(request)) {
+            reply = message_helpers::create_batch_response(request, queue_.receiver_id);
+        } else if (message_helpers::is_control(request)) {
+            reply = message_helpers::create_control_response(request, queue_.receiver_id);
+        } else {
+            message_helpers::fill_ack_for(&reply, request, queue_.receiver_id);
+        }
+        reply.set_async(true);
+    }
+
+    // Run request_fn under the queue lock unless the server is shutting down
+    template <typename Fn>
+    void rearm(Fn request_fn) {
+        std::lock_guard<std::mutex> lock(queue_.mu);
+        if (queue_.accepting) {
+            request_fn();
+        }
+    }
+
+    QueueState& queue_;
+};
+
+class UnaryCall final : public CallData {
+public:
+    explicit UnaryCall(QueueState& queue) : CallData(queue) { request(); }
+
+    void proceed(bool ok) override {
+        if (state_ == State::kRequested && ok) {
+            respond(request_, reply_);
+            state_ = State::kFinishing;
+            TRACED("reply", responder_->Finish(reply_, Status::OK, this));
+        } else if (state_ == State::kFinishing) {
+            request();
+        }
+        // A failed request means the server is shutting down; stay idle
+    }
+
 private:
-    int receiver_id;
-    
+    enum class State { kRequested, kFinishing };
+
+    void request() {
+        rearm([this]() {
+            ctx_ = std::make_unique<ServerContext>();
+            responder_ = std::make_unique<ServerAsyncResponseWriter<MessageEnvelope>>(ctx_.get());
+            state_ = State::kRequested;
+            queue_.service->RequestSendMessage(ctx_.get(), &request_, responder_.get(),
+                                               queue_.cq.get(), queue_.cq.get(), this);
+        });
+    }
+
+    State state_ = State::kRequested;
+    std::unique_ptr<ServerContext> ctx_;
+    std::unique_ptr<ServerAsyncResponseWriter<MessageEnvelope>> responder_;
+    MessageEnvelope request_;
+    MessageEnvelope reply_;
+};
+
+// One bidi stream: read an envelope, write its ACK, repeat until the sender half-closes
+class StreamCall final : public CallData {
 public:
-    AsyncMessagingServiceImpl(int id) : receiver_id(id) {}
-    
-    Status SendMessage(ServerContext* context, const MessageEnvelope* request, MessageEnvelope* reply) override {
-        std::string message_id = request->message_id();
-        std::cout << " [x] [ASYNC] Received message " << message_id << std::endl;
-        
-        // Create ACK using helper
-        *reply = message_helpers::create_ack_from_envelope(*request, std::to_string(receiver_id));
-        reply->set_async(true);
-        
-        return Status::OK;
+    explicit StreamCall(QueueState& queue) : CallData(queue) { request(); }
+
+    void proceed(bool ok) override {
+        switch (state_) {
+            case State::kRequested:
+                if (ok) {
+                    read();
+                }
+                break;
+            case State::kReading:
+                if (ok) {
+                    respond(request_, reply_);
+                    state_ = State::kWriting;
+                    TRACED("reply", stream_->Write(reply_, this));
+                } else {
+                    finish();
+                }
+                break;
+            case State::kWriting:
+                if (ok) {
+                    read();
+                } else {
+                    finish();
+                }
+                break;
+            case State::kFinishing:
+                request();
+                break;
+        }
     }
+
+private:
+    enum class State { kRequested, kReading, kWriting, kFinishing };
+
+    void request() {
+        rearm([this]() {
+            ctx_ = std::make_unique<ServerContext>();
+            stream_ = std::make_unique<ServerAsyncReaderWriter<MessageEnvelope, MessageEnvelope>>(ctx_.get());
+            state_ = State::kRequested;
+            queue_.service->RequestStreamMessages(ctx_.get(), stream_.get(),
+                                                  queue_.cq.get(), queue_.cq.get(), this);
+        });
+    }
+
+    void read() {
+        state_ = State::kReading;
+        stream_->Read(&request_, this);
+    }
+
+    void finish() {
+        state_ = State::kFinishing;
+        stream_->Finish(Status::OK, this);
+    }
+
+    State state_ = State::kRequested;
+    std::unique_ptr<ServerContext> ctx_;
+    std::unique_ptr<ServerAsyncReaderWriter<MessageEnvelope, MessageEnvelope>> stream_;
+    MessageEnvelope request_;
+    MessageEnvelope reply_;
 };
 
 int main(int argc, char** argv) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
-    
+    int num_cqs = 2;
+    int num_threads = 0;        // 0: one per completion queue
+    int calls_per_cq = 64;      // outstanding calls of each kind per completion queue
+
     for (int i = 1; i < argc; i++) {
-        if (std::string(argv[i]) == "--id" && i + 1 < argc) {
-            receiver_id = std::stoi(argv[i + 1]);
-            break;
+        std::string arg = argv[i];
+        if (arg == "--id" && i + 1 < argc) {
+            receiver_id = std::stoi(argv[++i]);
+        } else if (arg == "--cqs" && i + 1 < argc) {
+            num_cqs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--calls" && i + 1 < argc) {
+            calls_per_cq = std::max(1, std::stoi(argv[++i]));
         }
     }
-    
+    num_threads = std::max(num_threads, num_cqs);
+
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
+
     int port = 50051 + receiver_id;
     std::string server_address = "0.0.0.0:" + std::to_string(port);
-    
-    AsyncMessagingServiceImpl service(receiver_id);
-    
+
+    MessagingService::AsyncService service;
+
     ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
     builder.RegisterService(&service);
+    std::vector<std::unique_ptr<QueueState>> queues;
+    for (int q = 0; q < num_cqs; ++q) {
+        auto queue = std::make_unique<QueueState>();
+        queue->service = &service;
+        queue->cq = builder.AddCompletionQueue();
+        queue->receiver_id = std::to_string(receiver_id);
+        queues.push_back(std::move(queue));
+    }
     std::unique_ptr<Server> server(builder.BuildAndStart());
-    
-    std::cout << " [*] [ASYNC] Receiver " << receiver_id << " listening on port " << port << std::endl;
-    
+    if (!server) {
+        std::cerr << " [!] [ASYNC] Could not listen on port " << port << std::endl;
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<CallData>> calls;
+    for (auto& queue : queues) {
+        for (int c = 0; c < calls_per_cq; ++c) {
+            calls.push_back(std::make_unique<UnaryCall>(*queue));
+            calls.push_back(std::make_unique<StreamCall>(*queue));
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        ServerCompletionQueue* cq = queues[t % num_cqs]->cq.get();
+        threads.emplace_back([cq]() {
+            messaging::utils::CpuAffinity::global().pin_this_thread();
+            void* tag = nullptr;
+            bool ok = false;
+            while (cq->Next(&tag, &ok)) {
+                static_cast<CallData*>(tag)->proceed(ok);
+            }
+        });
+    }
+
+    std::cout << " [*] [ASYNC] Receiver " << receiver_id << " listening on port " << port
+              << " (" << num_cqs << " completion queues, " << num_threads << " threads)" << std::endl;
+
     while (running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-    
+
     std::cout << " [x] [ASYNC] Receiver " << receiver_id << " shutting down" << std::endl;
-    server->Shutdown();
-    
+    for (auto& queue : queues) {
+        std::lock_guard<std::mutex> lock(queue->mu);
+        queue->accepting = false;
+    }
+    // Cancel streams still open after a short grace period
+    server->Shutdown(std::chrono::system_clock::now() + std::chrono::milliseconds(200));
+    for (auto& queue : queues) {
+        queue->cq->Shutdown();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
     return 0;
 }
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <signal.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <grpcpp/grpcpp.h>
+#include "messaging.grpc.pb.h"
+#include "../../utils/cpp/receiver_host.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "receiver_service.hpp"
+
+/**
+ * Runs receivers --ids LIST in one process, in place of one receiver_test per
+ * id. Each id keeps its own server on 50051 + id so senders are unchanged.
+ * The servers share the process's gRPC runtime; --threads caps how many
+ * threads they may run between them, with every server keeping one poller.
+ */
+
+using grpc::Server;
+using grpc::ServerBuilder;
+
+std::atomic<bool> running(true);
+
+void signal_handler(int sig) {
+    running = false;
+}
+
+int main(int argc, char** argv) {
+    messaging::utils::configure_affinity(argc, argv);
+    std::vector<int> ids;
+    int threads = 0;
+    if (!messaging::utils::parse_host_args(argc, argv, ids, threads)) {
+        return 1;
+    }
+
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    // Sync servers need a poller each, so the quota never goes below one thread per server
+    grpc::ResourceQuota quota("receiver_host");
+    quota.SetMaxThreads(std::max<int>(threads, 2 * static_cast<int>(ids.size())));
+
+    std::vector<std::unique_ptr<MessagingServiceImpl>> services;
+    std::vector<std::unique_ptr<Server>> servers;
+    for (int id : ids) {
+        services.push_back(std::make_unique<MessagingServiceImpl>(id));
+        ServerBuilder builder;
+        builder.AddListeningPort("0.0.0.0:" + std::to_string(50051 + id), grpc::InsecureServerCredentials());
+        builder.RegisterService(services.back().get());
+        builder.SetResourceQuota(quota);
+        builder.SetSyncServerOption(ServerBuilder::SyncServerOption::NUM_CQS, 1);
+        builder.SetSyncServerOption(ServerBuilder::SyncServerOption::MIN_POLLERS, 1);
+        std::unique_ptr<Server> server(builder.BuildAndStart());
+        if (!server) {
+            std::cerr << " [!] Receiver " << id << " failed to listen on port " << 50051 + id << std::endl;
+            return 1;
+        }
+        servers.push_back(std::move(server));
+    }
+
+    perf.start();
+    std::cout << " [*] Hosting " << ids.size() << " receivers (" << ids.front() << "-" << ids.back()
+              << ") on ports " << 50051 + ids.front() << "-" << 50051 + ids.back() << std::endl;
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    for (auto& server : servers) {
+        server->Shutdown();
+    }
+    perf.stop();
+    messaging::utils::flush_log();
+    long long received = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        std::cout << " [x] Receiver " << ids[i] << " shutting down (received "
+                  << services[i]->received() << " messages)" << std::endl;
+        received += services[i]->received();
+    }
+    if (perf.enabled()) {
+        std::cout << " [*] Host hw_counters=" << perf.to_json(received).dump() << std::endl;
+    }
+
+    return 0;
+}
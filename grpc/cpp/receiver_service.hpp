@@ -0,0 +1,118 @@
+#ifndef GRPC_RECEIVER_SERVICE_HPP
+#define GRPC_RECEIVER_SERVICE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <future>
+#include "messaging.grpc.pb.h"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/work_queue.hpp"
+
+/**
+ * The synchronous receiver's MessagingService: ACKs each unary request, and
+ * each envelope of a StreamMessages stream on the same stream. Shared by
+ * receiver_test (one per process) and receiver_host (one per hosted id).
+ *
+ * With a work queue (receiver_test --work-queue N), unary requests are
+ * handed from gRPC's handler threads to the queue's workers, and the handler
+ * returns the ACK its worker built. This caps processing at the queue's
+ * workers however many handler threads gRPC runs. A full queue blocks the
+ * handler or, with --overload shed, fails the call at once with
+ * RESOURCE_EXHAUSTED instead of letting it run into the sender's deadline.
+ * Readiness PINGs and streams are still answered inline.
+ */
+class MessagingServiceImpl final : public messaging::MessagingService::Service {
+private:
+    int receiver_id;
+    std::string receiver_name;
+    messaging::utils::LogSummary& progress;
+    std::atomic<long long> received_count{0};
+    
+    // A unary call waiting for a worker; lives on the handler thread's stack
+    struct Job {
+        const messaging::MessageEnvelope* request = nullptr;
+        messaging::MessageEnvelope* reply = nullptr;
+        message_helpers::ReceiveTiming timing;
+        std::promise<void>* done = nullptr;
+    };
+    std::unique_ptr<messaging::utils::WorkQueue<Job>> work_queue;
+    
+public:
+    MessagingServiceImpl(int id, const messaging::utils::WorkQueueOptions& work = {})
+        : receiver_id(id),
+          receiver_name(std::to_string(id)),
+          progress(messaging::utils::AsyncLogger::global().summary(" [*] Receiver " + std::to_string(id), {"received"})) {
+        if (work.enabled()) {
+            work_queue = std::make_unique<messaging::utils::WorkQueue<Job>>(work, [this](Job& job, int) {
+                *job.reply = message_helpers::create_response_for(*job.request, receiver_name, job.timing);
+                job.done->set_value();
+            });
+        }
+    }
+    
+    long long received() const { return received_count.load(std::memory_order_relaxed); }
+    
+    // Work queue counters, finished once the queue is closed; null without --work-queue
+    nlohmann::json close_work_queue() {
+        if (!work_queue) {
+            return nullptr;
+        }
+        work_queue->close();
+        return work_queue->report();
+    }
+    
+    grpc::Status SendMessage(grpc::ServerContext* context, const messaging::MessageEnvelope* request,
+                             messaging::MessageEnvelope* reply) override {
+        // gRPC has already read and parsed the request, so processing starts here
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+        messaging::utils::log_debug() << " [x] Received message " << request->message_id();
+        progress.add(0);
+        if (!message_helpers::is_control(*request)) {
+            received_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        if (work_queue && !message_helpers::is_control(*request)) {
+            std::promise<void> done;
+            Job job{request, reply, timing, &done};
+            if (!work_queue->submit(job)) {
+                if (work_queue->warn_due()) {
+                    std::cerr << " [!] Receiver " << receiver_name << ": work queue full, " << work_queue->shed()
+                              << " requests shed so far" << std::endl;
+                }
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "receiver work queue full");
+            }
+            done.get_future().wait();
+            return grpc::Status::OK;
+        }
+        
+        // Create ACK (a BatchResponse for batches, a PONG for readiness PINGs) using helper
+        *reply = message_helpers::create_response_for(*request, receiver_name, timing);
+        
+        return grpc::Status::OK;
+    }
+    
+    // One long-lived stream per sender: ACK each envelope on the same stream as it arrives
+    grpc::Status StreamMessages(grpc::ServerContext* context,
+                                grpc::ServerReaderWriter<messaging::MessageEnvelope, messaging::MessageEnvelope>* stream) override {
+        messaging::MessageEnvelope request;
+        messaging::MessageEnvelope reply;
+        while (stream->Read(&request)) {
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+            messaging::utils::log_debug() << " [x] Received streamed message " << request.message_id();
+            progress.add(0);
+            received_count.fetch_add(1, std::memory_order_relaxed);
+            
+            reply = message_helpers::create_response_for(request, receiver_name, timing);
+            if (!TRACED("reply", stream->Write(reply))) {
+                break;
+            }
+        }
+        return grpc::Status::OK;
+    }
+};
+
+#endif // GRPC_RECEIVER_SERVICE_HPP
@@ -8,13 +8,13 @@
 #include <grpcpp/grpcpp.h>
 #include "messaging.grpc.pb.h"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "receiver_service.hpp"
 
 using grpc::Server;
 using grpc::ServerBuilder;
-using grpc::ServerContext;
-using grpc::Status;
 using messaging::MessageEnvelope;
-using messaging::MessagingService;
 using message_helpers::get_current_time_ms;
 
 std::atomic<bool> running(true);
@@ -23,25 +23,8 @@ void signal_handler(int sig) {
     running = false;
 }
 
-class MessagingServiceImpl final : public MessagingService::Service {
-private:
-    int receiver_id;
-    
-public:
-    MessagingServiceImpl(int id) : receiver_id(id) {}
-    
-    Status SendMessage(ServerContext* context, const MessageEnvelope* request, MessageEnvelope* reply) override {
-        std::string message_id = request->message_id();
-        std::cout << " [x] Received message " << message_id << std::endl;
-        
-        // Create ACK using helper
-        *reply = message_helpers::create_ack_from_envelope(*request, std::to_string(receiver_id));
-        
-        return Status::OK;
-    }
-};
-
 int main(int argc, char** argv) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
     
     for (int i = 1; i < argc; i++) {
@@ -51,13 +34,16 @@ int main(int argc, char** argv) {
         }
     }
     
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
     int port = 50051 + receiver_id;
     std::string server_address = "0.0.0.0:" + std::to_string(port);
     
-    MessagingServiceImpl service(receiver_id);
+    messaging::utils::WorkQueueOptions work = messaging::utils::WorkQueueOptions::from_args(argc, argv);
+    MessagingServiceImpl service(receiver_id, work);
     
     ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
@@ -65,13 +51,22 @@ int main(int argc, char** argv) {
     std::unique_ptr<Server> server(builder.BuildAndStart());
     
     std::cout << " [*] Receiver " << receiver_id << " listening on port " << port << std::endl;
+    if (work.enabled()) {
+        std::cout << " [*] Queueing up to " << work.capacity << " requests for " << work.workers
+                  << " worker threads (" << work.policy() << " when full)" << std::endl;
+    }
     
     while (running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
+    messaging::utils::flush_log();
     std::cout << " [x] Receiver " << receiver_id << " shutting down" << std::endl;
     server->Shutdown();
+    // Handlers still waiting on workers have returned by now, so the queue can stop
+    if (work.enabled()) {
+        std::cout << " [x] Receiver " << receiver_id << " work_queue=" << service.close_work_queue().dump() << std::endl;
+    }
     
     return 0;
 }
@@ -3,12 +3,23 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <future>
+#include <map>
+#include <cstring>
+#include <algorithm>
 #include <grpcpp/grpcpp.h>
 #include "messaging.grpc.pb.h"
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/payload_pool.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/connection_pool.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "stream_pipeline.hpp"
+#include "unary_pipeline.hpp"
 
 using grpc::Channel;
 using grpc::ClientContext;
@@ -16,42 +27,72 @@ using grpc::Status;
 using messaging::MessageEnvelope;
 using messaging::MessagingService;
 using json = nlohmann::json;
-using message_helpers::get_current_time_ms;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ConnectionPool;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
 
-struct TaskResult {
-    bool success;
-    std::string message_id;
-    long long duration;
-    std::string error;
+// Pooled channel and stub for one receiver port
+struct GrpcConnection {
+    std::shared_ptr<Channel> channel;
+    std::unique_ptr<MessagingService::Stub> stub;
+
+    explicit GrpcConnection(int port)
+        : channel(grpc::CreateChannel("localhost:" + std::to_string(port), grpc::InsecureChannelCredentials())),
+          stub(MessagingService::NewStub(channel)) {}
 };
 
-TaskResult send_message_task(const json& item, int receiver_count) {
+using Payloads = messaging::utils::EnvelopePayloads<MessageEnvelope>;
+
+// The first attempt sends the envelope pre-built before the timed region,
+// others send a copy (see Attempt)
+TaskResult send_message_task(ConnectionPool<GrpcConnection>& pool, Payloads& payloads,
+                             std::vector<MessageEnvelope>& envelopes, size_t i, const Attempt& attempt) {
+    thread_local MessageEnvelope copy;
+    if (attempt.number == 0) {
+        payloads.apply(i);
+    } else {
+        copy = envelopes[i];
+    }
+    MessageEnvelope& request = attempt.number == 0 ? envelopes[i] : copy;
     TaskResult res;
     res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
+    res.message_id = request.message_id();
+    res.duration_ns = 0;
     
     try {
-        int target = item.value("target", 0);
+        int target = request.target();
         int port = 50051 + target;
         
-        auto channel = grpc::CreateChannel("localhost:" + std::to_string(port), grpc::InsecureChannelCredentials());
-        auto stub = MessagingService::NewStub(channel);
+        auto conn = pool.checkout(port);
+        if (!conn) {
+            res.error = "Connection failed";
+            return res;
+        }
         
-        long long msg_start = get_current_time_ms();
+        long long msg_start = get_steady_time_ns();
         
-        // Create protobuf message with DataMessage payload
-        MessageEnvelope request = message_helpers::create_data_envelope(item);
+        long long now_us = message_helpers::get_current_time_us();
+        request.set_timestamp(now_us / 1000);
+        request.set_timestamp_us(now_us);
+        res.bytes = request.ByteSizeLong();
         
         MessageEnvelope reply;
         ClientContext context;
-        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(attempt.timeout_ms(100)));
         
-        Status status = stub->SendMessage(&context, request, &reply);
+        Status status = conn->stub->SendMessage(&context, request, &reply);
         
         if (status.ok()) {
             if (message_helpers::is_valid_ack(reply, res.message_id)) {
-                res.duration = get_current_time_ms() - msg_start;
+                res.duration_ns = get_steady_time_ns() - msg_start;
+                res.ack_timing = messaging::utils::AckTiming::of(reply);
                 res.success = true;
             } else {
                 res.error = "Invalid ACK";
@@ -66,48 +107,179 @@ TaskResult send_message_task(const json& item, int receiver_count) {
     return res;
 }
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+/**
+ * Send every envelope from this thread through a StreamPipeline or
+ * UnaryPipeline, keeping up to max_in_flight awaiting ACKs; returns the peak in flight.
+ */
+template <typename Pipeline>
+int run_pipeline(Pipeline& pipeline, Payloads& payloads, std::vector<MessageEnvelope>& envelopes,
+                 int max_in_flight, const AsyncSendEngine::ResultFn& on_result, MessageStats& stats) {
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t peak = 0;
+    for (size_t i = 0; i < envelopes.size(); ++i) {
+        MessageEnvelope& request = envelopes[i];
+        // Wait for room in the window, picking up whatever ACKs have arrived meanwhile
+        while (pipeline.in_flight() >= window) {
+            pipeline.poll(10, on_result);
+        }
+        payloads.apply(i);
+        long long now_us = message_helpers::get_current_time_us();
+        request.set_timestamp(now_us / 1000);
+        request.set_timestamp_us(now_us);
+        TRACED("send", pipeline.send(request));
+        stats.record_dispatch();
+        peak = std::max(peak, pipeline.in_flight());
+        pipeline.poll(0, on_result);
+    }
+    pipeline.drain_all(on_result);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    // Build every envelope up front, streaming the corpus, so JSON conversion stays out of the timed region
+    std::vector<MessageEnvelope> envelopes;
+    envelopes.reserve(test_data_loader::getTestDataCount());
+    test_data_loader::forEachTestItem("", [&](const json& item) {
+        envelopes.push_back(message_helpers::create_data_envelope(item));
+    });
+    Payloads payloads(messaging::utils::PayloadSpec::from_args(argc, argv), envelopes);
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    if (options.qos.enabled()) {
+        for (auto& envelope : envelopes) {
+            envelope.set_qos(static_cast<messaging::QoSLevel>(options.qos.level));
+        }
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
     
-    // Find max target
-    int max_target = 0;
-    for (const auto& item : test_data) {
-        if (item.contains("target")) {
-            max_target = std::max(max_target, item["target"].get<int>());
+    bool use_stream = false;
+    bool use_cq = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--stream") == 0) {
+            use_stream = true;
+        } else if (std::strcmp(argv[i], "--cq") == 0) {
+            use_cq = true;
         }
     }
+    use_cq = use_cq && !use_stream;
+    if (use_stream || use_cq) {
+        options.warn_ignored_by(use_stream ? "--stream" : "--cq");
+    }
     
     MessageStats stats;
     stats.set_metadata({
         {"service", "gRPC"},
         {"language", "C++"},
-        {"async", true}
+        {"async", true},
+        {"transport", use_stream ? "stream" : use_cq ? "unary_cq" : "unary"},
+        {"workers", use_stream || use_cq ? 1 : options.workers},
+        {"max_in_flight", options.max_in_flight}
     });
-    long long start_time = get_current_time_ms();
-    
-    std::cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << std::endl;
-    
-    std::vector<std::future<TaskResult>> futures;
-    for (auto& item : test_data) {
-        futures.push_back(std::async(std::launch::async, send_message_task, item, max_target + 1));
+    stats.add_metadata("payload", payloads.pool().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(payloads.mean_wire_bytes());
+
+    // --wait-ready: unary PING to every receiver before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "grpc-async-sender");
+    if (ready.options().enabled()) {
+        std::map<int, std::unique_ptr<GrpcConnection>> channels;
+        for (const auto& envelope : envelopes) {
+            channels.emplace(envelope.target(), nullptr);
+        }
+        std::vector<int> targets;
+        for (auto& [target, conn] : channels) {
+            conn = std::make_unique<GrpcConnection>(50051 + target);
+            targets.push_back(target);
+        }
+        MessageEnvelope ping_request;
+        MessageEnvelope pong;
+        ready.wait(targets, [&](int target, const std::string&, std::string_view ping) -> const MessageEnvelope* {
+            if (!ping_request.ParseFromArray(ping.data(), static_cast<int>(ping.size()))) {
+                return nullptr;
+            }
+            ClientContext context;
+            context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+            return channels[target]->stub->SendMessage(&context, ping_request, &pong).ok() ? &pong : nullptr;
+        });
     }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("gRPC");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
     
-    for (auto& fut : futures) {
-        TaskResult res = fut.get();
+    std::cout << " [x] Starting ASYNC transfer of " << envelopes.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
+    
+    auto on_result = [&](const TaskResult& res) {
         if (res.success) {
-            stats.record_message(true, res.duration);
-            std::cout << " [OK] Message " << res.message_id << " acknowledged" << std::endl;
+            stats.record_message_ns(true, res.duration_ns);
+            stats.record_breakdown(res.ack_timing, res.duration_ns);
+            stats.record_bytes(res.bytes);
+            progress.add(0);
+            log_debug() << " [OK] Message " << res.message_id << " acknowledged";
         } else {
             stats.record_message(false);
-            std::cout << " [FAILED] Message " << res.message_id << ": " << res.error << std::endl;
+            progress.add(1);
+            log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+        }
+    };
+    
+    if (use_stream) {
+        // One thread and one bidi stream per receiver; the window is the only concurrency
+        StreamPipeline pipeline(1000);  // 1s ACK timeout
+        int peak = run_pipeline(pipeline, payloads, envelopes, options.max_in_flight, on_result, stats);
+        pipeline.close();
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", pipeline.stream_count());
+    } else if (use_cq) {
+        // Unary calls from one thread onto a CompletionQueue; the window bounds what is outstanding
+        UnaryPipeline pipeline(UnaryOptions::from_args(argc, argv), 1000);  // 1s ACK timeout
+        int peak = run_pipeline(pipeline, payloads, envelopes, options.max_in_flight, on_result, stats);
+        pipeline.close();
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", pipeline.channel_count());
+        stats.add_metadata("unary_cq", pipeline.report());
+    } else {
+        ConnectionPool<GrpcConnection> pool([](int port) {
+            return std::make_unique<GrpcConnection>(port);
+        });
+        
+        AsyncSendEngine engine(options);
+        engine.run(envelopes.size(),
+            [&](size_t i, const Attempt& attempt) {
+                if (attempt.number == 0) {
+                    stats.record_dispatch();
+                }
+                return send_message_task(pool, payloads, envelopes, i, attempt);
+            },
+            on_result);
+        stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+        if (options.open_loop()) {
+            stats.add_metadata("open_loop", engine.open_loop_report());
+        }
+        if (options.policy.enabled()) {
+            stats.add_metadata("request_policy", engine.policy_report());
+        }
+        if (options.qos.enabled()) {
+            stats.add_metadata("qos", options.qos.report(engine.retransmits()));
         }
+        stats.add_metadata("connections_created", pool.created_count());
     }
     
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
     
+    messaging::utils::flush_log();
     std::cout << "\nTest Results (ASYNC):" << std::endl;
     std::cout << "total_sent: " << stats.sent_count << std::endl;
     std::cout << "total_received: " << stats.received_count << std::endl;
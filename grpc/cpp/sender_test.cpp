@@ -3,11 +3,19 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <set>
 #include <grpcpp/grpcpp.h>
 #include "messaging.grpc.pb.h"
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/payload_pool.hpp"
+#include "../../utils/cpp/batch_builder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
 
 using grpc::Channel;
 using grpc::ClientContext;
@@ -15,7 +23,18 @@ using grpc::Status;
 using messaging::MessageEnvelope;
 using messaging::MessagingService;
 using json = nlohmann::json;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
+using messaging::utils::BatchOptions;
+using messaging::utils::BatchAccumulator;
+using messaging::utils::BatchBuilder;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::TaskResult;
 
 class MessageClient {
 private:
@@ -23,44 +42,81 @@ private:
     
 public:
     MessageClient(int num_receivers) {
+        // A private subchannel pool gives each client its own connections, even to a port another client uses
+        grpc::ChannelArguments args;
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
         for (int i = 0; i < num_receivers; i++) {
             int port = 50051 + i;
-            auto channel = grpc::CreateChannel("localhost:" + std::to_string(port), grpc::InsecureChannelCredentials());
+            auto channel = grpc::CreateCustomChannel("localhost:" + std::to_string(port),
+                                                     grpc::InsecureChannelCredentials(), args);
             stubs_.push_back(MessagingService::NewStub(channel));
         }
     }
     
-    bool SendMessage(const json& item) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
+    // request is pre-built before the timed loop; only its timestamps are set per send.
+    // reply holds the ACK afterwards, for its receiver timing.
+    bool SendMessage(MessageEnvelope& request, MessageEnvelope& reply) {
+        const std::string& message_id = request.message_id();
+        int target = request.target();
         
-        // Create protobuf message with DataMessage payload
-        MessageEnvelope request = message_helpers::create_data_envelope(item);
+        long long now_us = message_helpers::get_current_time_us();
+        request.set_timestamp(now_us / 1000);
+        request.set_timestamp_us(now_us);
 
-        MessageEnvelope reply;
+        return Call(target, request, reply) && message_helpers::is_valid_ack(reply, message_id);
+    }
+    
+    // Unary round trip to target with a 40ms deadline
+    bool Call(int target, const MessageEnvelope& request, MessageEnvelope& reply) {
         ClientContext context;
         context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(40));
 
-        Status status = stubs_[target]->SendMessage(&context, request, &reply);
+        Status status = TRACED("request", stubs_[target]->SendMessage(&context, request, &reply));
 
-        if (status.ok()) {
-            return message_helpers::is_valid_ack(reply, message_id);
-        } else {
-            std::cout << " [FAILED] gRPC error: " << status.error_message() << std::endl;
-            return false;
+        if (!status.ok()) {
+            log_info() << " [x] Message " << request.message_id() << " to target " << target
+                       << " [FAILED] gRPC error: " << status.error_message();
         }
+        return status.ok();
+    }
+
+    // Readiness PING to target; failures are expected while the receiver starts, so not logged
+    bool Ping(int target, const MessageEnvelope& ping, MessageEnvelope& reply) {
+        ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+        return stubs_[target]->SendMessage(&context, ping, &reply).ok();
     }
 };
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    BatchOptions batch_options = BatchOptions::from_args(argc, argv);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    if (batch_options.enabled()) {
+        partition_options.warn_ignored_by("--batch");
+        qos.warn_ignored_by("--batch");
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+    
+    // Build every envelope up front, streaming the corpus, so JSON conversion stays out of the timed loop
+    std::vector<MessageEnvelope> envelopes;
+    envelopes.reserve(test_data_loader::getTestDataCount());
+    test_data_loader::forEachTestItem("", [&](const json& item) {
+        envelopes.push_back(message_helpers::create_data_envelope(item));
+        if (qos.enabled()) {
+            envelopes.back().set_qos(static_cast<messaging::QoSLevel>(qos.level));
+        }
+    });
+    messaging::utils::EnvelopePayloads<MessageEnvelope> payloads(
+        messaging::utils::PayloadSpec::from_args(argc, argv), envelopes);
     
     // Find max target to create all necessary stubs
     int max_target = 0;
-    for (const auto& item : test_data) {
-        if (item.contains("target")) {
-            max_target = std::max(max_target, item["target"].get<int>());
-        }
+    for (const auto& envelope : envelopes) {
+        max_target = std::max(max_target, envelope.target());
     }
     
     MessageClient client(max_target + 1);
@@ -68,33 +124,128 @@ int main() {
     stats.set_metadata({
         {"service", "gRPC"},
         {"language", "C++"},
-        {"async", false}
+        {"async", false},
+        {"batch_size", batch_options.max_messages},
+        {"batch_linger_ms", batch_options.linger_ms},
+        {"partitions", batch_options.enabled() ? 1 : partition_options.partitions}
     });
-    long long start_time = get_current_time_ms();
+    stats.add_metadata("payload", payloads.pool().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(payloads.mean_wire_bytes());
+
+    // --wait-ready: PING every receiver before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "grpc-sender");
+    std::set<int> targets;
+    for (const auto& envelope : envelopes) {
+        targets.insert(envelope.target());
+    }
+    MessageEnvelope ping_request;
+    MessageEnvelope pong;
+    ready.wait(std::vector<int>(targets.begin(), targets.end()),
+        [&](int target, const std::string&, std::string_view ping) -> const MessageEnvelope* {
+            if (!ping_request.ParseFromArray(ping.data(), static_cast<int>(ping.size()))) {
+                return nullptr;
+            }
+            return client.Ping(target, ping_request, pong) ? &pong : nullptr;
+        });
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("gRPC");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
     
-    std::cout << " [x] Starting transfer of " << test_data.size() << " messages..." << std::endl;
+    std::cout << " [x] Starting transfer of " << envelopes.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
     
-    for (auto& item : test_data) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
-        std::cout << " [x] Sending message " << message_id << " to target " << target << "..." << std::flush;
-        
-        long long msg_start = get_current_time_ms();
-        if (client.SendMessage(item)) {
-            long long msg_duration = get_current_time_ms() - msg_start;
-            stats.record_message(true, msg_duration);
-            std::cout << " [OK]" << std::endl;
-        } else {
-            stats.record_message(false);
-            std::cout << " [FAILED]" << std::endl;
+    if (batch_options.enabled()) {
+        std::string scratch;  // reused per-message encode buffer
+        MessageEnvelope reply;
+        BatchAccumulator batches(batch_options);
+        auto flush = [&](BatchBuilder& batch) {
+            bool replied = client.Call(batch.target(), batch.finish(), reply);
+            size_t acked = messaging::utils::record_batch(stats, batch, replied ? &reply : nullptr,
+                                                          get_steady_time_ns());
+            if (replied) {
+                log_debug() << " [x] Batch " << batch.batch_id() << " (" << batch.size() << " messages) to target "
+                            << batch.target() << " [OK] " << acked << "/" << batch.size() << " acknowledged";
+            }
+            progress.add(0, acked);
+            progress.add(1, batch.size() - acked);
+        };
+        for (size_t i = 0; i < envelopes.size(); ++i) {
+            MessageEnvelope& envelope = envelopes[i];
+            payloads.apply(i);
+            long long now_us = message_helpers::get_current_time_us();
+            envelope.set_timestamp(now_us / 1000);
+            envelope.set_timestamp_us(now_us);
+            message_helpers::serialize_envelope(envelope, scratch);
+            batches.add(envelope.target(), scratch, envelope.message_id(), get_steady_time_ns(), flush);
+            batches.flush_expired(get_steady_time_ns(), flush);
+        }
+        batches.flush_all(flush);
+    } else {
+        // One client (channels and reply) per partition; the first reuses the main client
+        struct Partition {
+            std::unique_ptr<MessageClient> own;
+            MessageEnvelope reply;
+        };
+        PartitionedSender sender(partition_options, qos);
+        sender.run(envelopes.size(),
+            [&](size_t i) { return envelopes[i].target(); },
+            [&](size_t partition) {
+                auto state = std::make_unique<Partition>();
+                if (partition > 0) {
+                    state->own = std::make_unique<MessageClient>(max_target + 1);
+                }
+                return state;
+            },
+            [&](std::unique_ptr<Partition>& state, size_t i) {
+                MessageClient& partition_client = state->own ? *state->own : client;
+                MessageEnvelope& envelope = envelopes[i];
+                TaskResult res;
+                res.message_id = envelope.message_id();
+                int target = envelope.target();
+                long long msg_start = get_steady_time_ns();
+                payloads.apply(i);
+                if (partition_client.SendMessage(envelope, state->reply)) {
+                    res.success = true;
+                    res.duration_ns = get_steady_time_ns() - msg_start;
+                    res.ack_timing = messaging::utils::AckTiming::of(state->reply);
+                    res.bytes = envelope.ByteSizeLong();
+                    log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
+                }
+                return res;
+            },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
+                } else {
+                    stats.record_message(false);
+                    progress.add(1);
+                }
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
     }
     
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
     
+    messaging::utils::flush_log();
     std::cout << "\nTest Results:" << std::endl;
     std::cout << "service: gRPC" << std::endl;
     std::cout << "language: C++" << std::endl;
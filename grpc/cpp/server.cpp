@@ -1,11 +1,15 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <cstring>
 #include <thread>
 #include <vector>
+#include <deque>
 #include <mutex>
+#include <condition_variable>
 #include <set>
-#include <map>
+#include <unordered_map>
+#include <functional>
 #include <algorithm>
 
 #include <grpcpp/grpcpp.h>
@@ -19,90 +23,242 @@ using grpc::Status;
 using messaging::MessageEnvelope;
 using messaging::MessagingService;
 
-struct Subscriber {
-    ServerReaderWriter<MessageEnvelope, MessageEnvelope>* stream;
-    std::mutex mu;
-    bool active;
-    
-    Subscriber(ServerReaderWriter<MessageEnvelope, MessageEnvelope>* s) : stream(s), active(true) {}
+// What to do with a subscriber whose outbound queue is full
+enum class SlowPolicy {
+    kDrop,        // drop the new message for that subscriber only
+    kDisconnect   // cancel the subscriber's call
+};
+
+/**
+ * One connected client. Broadcasts are queued (bounded) and written by the
+ * subscriber's own writer thread, so publishers never wait on a slow stream.
+ */
+class Subscriber {
+public:
+    Subscriber(ServerContext* context, ServerReaderWriter<MessageEnvelope, MessageEnvelope>* stream,
+               size_t capacity, SlowPolicy policy)
+        : context_(context), stream_(stream), capacity_(capacity), policy_(policy),
+          writer_([this]() { write_loop(); }) {}
+
+    ~Subscriber() { close(); }
+
+    // Queue msg without blocking; false if it was not accepted
+    bool enqueue(const std::shared_ptr<const MessageEnvelope>& msg) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!active_) {
+            return false;
+        }
+        if (queue_.size() >= capacity_) {
+            dropped_++;
+            if (policy_ == SlowPolicy::kDisconnect) {
+                active_ = false;
+                context_->TryCancel();
+                cv_.notify_one();
+            }
+            return false;
+        }
+        queue_.push_back(msg);
+        cv_.notify_one();
+        return true;
+    }
+
+    // Stop the writer; must run before the call's stream goes away
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            active_ = false;
+        }
+        cv_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+    }
+
+    size_t dropped() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return dropped_;
+    }
+
+private:
+    void write_loop() {
+        std::deque<std::shared_ptr<const MessageEnvelope>> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_.wait(lock, [this]() { return !queue_.empty() || !active_; });
+                if (!active_) {
+                    return;
+                }
+                batch.swap(queue_);
+            }
+            for (const auto& msg : batch) {
+                if (!stream_->Write(*msg)) {
+                    std::lock_guard<std::mutex> lock(mu_);
+                    active_ = false;
+                    return;
+                }
+            }
+            batch.clear();
+        }
+    }
+
+    ServerContext* context_;
+    ServerReaderWriter<MessageEnvelope, MessageEnvelope>* stream_;
+    size_t capacity_;
+    SlowPolicy policy_;
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<const MessageEnvelope>> queue_;
+    bool active_ = true;
+    size_t dropped_ = 0;
+    std::thread writer_;  // last, so it starts after the state above
+};
+
+/**
+ * Topic -> subscribers, sharded by topic hash. Each shard stores an immutable
+ * subscriber list per topic that (un)subscribe replace copy-on-write, so a
+ * publisher only holds a shard lock long enough to copy one shared_ptr.
+ */
+class TopicTable {
+public:
+    using SubscriberList = std::vector<std::shared_ptr<Subscriber>>;
+
+    explicit TopicTable(size_t shard_count) : shards_(std::max<size_t>(1, shard_count)) {}
+
+    void subscribe(const std::string& topic, const std::shared_ptr<Subscriber>& sub) {
+        Shard& shard = shard_for(topic);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto& list = shard.topics[topic];
+        auto updated = list ? std::make_shared<SubscriberList>(*list) : std::make_shared<SubscriberList>();
+        updated->push_back(sub);
+        list = std::move(updated);
+    }
+
+    void unsubscribe(const std::string& topic, const std::shared_ptr<Subscriber>& sub) {
+        Shard& shard = shard_for(topic);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.topics.find(topic);
+        if (it == shard.topics.end()) {
+            return;
+        }
+        auto updated = std::make_shared<SubscriberList>(*it->second);
+        updated->erase(std::remove(updated->begin(), updated->end(), sub), updated->end());
+        if (updated->empty()) {
+            shard.topics.erase(it);
+        } else {
+            it->second = std::move(updated);
+        }
+    }
+
+    // Snapshot of topic's subscribers; never null
+    std::shared_ptr<const SubscriberList> subscribers(const std::string& topic) const {
+        static const auto kNone = std::make_shared<const SubscriberList>();
+        const Shard& shard = shard_for(topic);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.topics.find(topic);
+        return it == shard.topics.end() ? kNone : it->second;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mu;
+        std::unordered_map<std::string, std::shared_ptr<const SubscriberList>> topics;
+    };
+
+    Shard& shard_for(const std::string& topic) {
+        return shards_[std::hash<std::string>{}(topic) % shards_.size()];
+    }
+    const Shard& shard_for(const std::string& topic) const {
+        return shards_[std::hash<std::string>{}(topic) % shards_.size()];
+    }
+
+    std::vector<Shard> shards_;
+};
+
+struct ServerOptions {
+    size_t shards = 16;
+    size_t queue_depth = 1024;   // per-subscriber outbound messages
+    SlowPolicy slow_policy = SlowPolicy::kDrop;
+
+    // Parse --shards N, --queue-depth N and --slow-policy drop|disconnect
+    static ServerOptions from_args(int argc, char* argv[]) {
+        ServerOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+                options.shards = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+            } else if (std::strcmp(argv[i], "--queue-depth") == 0 && i + 1 < argc) {
+                options.queue_depth = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+            } else if (std::strcmp(argv[i], "--slow-policy") == 0 && i + 1 < argc) {
+                options.slow_policy = std::strcmp(argv[++i], "disconnect") == 0 ? SlowPolicy::kDisconnect
+                                                                                 : SlowPolicy::kDrop;
+            }
+        }
+        return options;
+    }
 };
 
 class MessagingServiceImpl final : public MessagingService::Service {
-    std::mutex global_mu_;
-    std::map<std::string, std::set<std::shared_ptr<Subscriber>>> topic_subscribers_;
+    ServerOptions options_;
+    TopicTable topics_;
 
 public:
-    Status SubscribeAndPublish(ServerContext* context, ServerReaderWriter<MessageEnvelope, MessageEnvelope>* stream) override {
+    explicit MessagingServiceImpl(const ServerOptions& options)
+        : options_(options), topics_(options.shards) {}
+
+    Status StreamMessages(ServerContext* context, ServerReaderWriter<MessageEnvelope, MessageEnvelope>* stream) override {
         // Create a subscriber state for this connection
-        auto sub = std::make_shared<Subscriber>(stream);
+        auto sub = std::make_shared<Subscriber>(context, stream, options_.queue_depth, options_.slow_policy);
         std::set<std::string> my_topics;
 
         MessageEnvelope msg;
         while (stream->Read(&msg)) {
-            std::string topic = msg.topic();
-            
-            // Register subscription if new topic
-            {
-                std::lock_guard<std::mutex> lock(global_mu_);
-                if (my_topics.find(topic) == my_topics.end()) {
-                    my_topics.insert(topic);
-                    topic_subscribers_[topic].insert(sub);
+            const std::string& topic = msg.topic();
+
+            // An empty message subscribes the stream; publishing alone does not, so publishers get no echo
+            if (msg.payload().empty()) {
+                if (my_topics.insert(topic).second) {
+                    topics_.subscribe(topic, sub);
                     std::cout << "Client subscribed to: " << topic << std::endl;
                 }
+                continue;
             }
-
-            // If message has content, broadcast it
-            if (msg.payload().size() > 0) {
-                 Broadcast(msg, sub);
-            }
+            Broadcast(msg);
         }
 
-        // Cleanup on disconnect
-        {
-            std::lock_guard<std::mutex> lock(global_mu_);
-            for (const auto& topic : my_topics) {
-                topic_subscribers_[topic].erase(sub);
-            }
+        // Cleanup on disconnect; stop the writer before the stream goes away
+        for (const auto& topic : my_topics) {
+            topics_.unsubscribe(topic, sub);
         }
-
-        // Mark as inactive to prevent further writes
-        {
-            std::lock_guard<std::mutex> lock(sub->mu);
-            sub->active = false;
+        sub->close();
+        if (sub->dropped() > 0) {
+            std::cout << "Client dropped " << sub->dropped() << " messages (slow consumer)" << std::endl;
         }
 
         return Status::OK;
     }
 
 private:
-    void Broadcast(const MessageEnvelope& msg, std::shared_ptr<Subscriber> sender) {
-        std::vector<std::shared_ptr<Subscriber>> targets;
-        
-        {
-            std::lock_guard<std::mutex> lock(global_mu_);
-            if (topic_subscribers_.count(msg.topic())) {
-                for (const auto& s : topic_subscribers_[msg.topic()]) {
-                     targets.push_back(s);
-                }
-            }
+    // One shared copy of msg is queued to every subscriber; nothing here blocks on a stream
+    void Broadcast(const MessageEnvelope& msg) {
+        auto targets = topics_.subscribers(msg.topic());
+        if (targets->empty()) {
+            return;
         }
-
-        for (auto& s : targets) {
-            std::lock_guard<std::mutex> lock(s->mu);
-            if (s->active) {
-                s->stream->Write(msg);
-            }
+        auto shared = std::make_shared<const MessageEnvelope>(msg);
+        for (const auto& s : *targets) {
+            s->enqueue(shared);
         }
     }
 };
 
-void RunServer() {
+void RunServer(const ServerOptions& options) {
     std::string server_address("0.0.0.0:50051");
-    MessagingServiceImpl service;
+    MessagingServiceImpl service(options);
 
     ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-    builder.SetMaxConcurrentStreams(1000);
+    builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS, 1000);
     builder.SetMaxMessageSize(1024 * 1024 * 10); // 10MB
     builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS, 4);
     builder.RegisterService(&service);
@@ -112,6 +268,6 @@ void RunServer() {
 }
 
 int main(int argc, char** argv) {
-    RunServer();
+    RunServer(ServerOptions::from_args(argc, argv));
     return 0;
 }
@@ -0,0 +1,130 @@
+#ifndef GRPC_STREAM_PIPELINE_HPP
+#define GRPC_STREAM_PIPELINE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <string>
+#include <map>
+#include <memory>
+#include <thread>
+#include "messaging.grpc.pb.h"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/pending_replies.hpp"
+
+/**
+ * Pipelined request/ACK over one long-lived StreamMessages call per receiver.
+ *
+ * The bidi stream is opened on first use and kept for the whole run, so
+ * channel and per-RPC setup are paid once per target rather than per message.
+ * Requests are written from the caller's thread; a reader thread per stream
+ * matches ACKs to outstanding requests by original message id, and
+ * PendingReplies hands completions back on the caller's thread. Flow control is
+ * the caller's in-flight window on top of HTTP/2's, which blocks Write() while
+ * the receiver falls behind.
+ *
+ * send(), poll() and close() must be called from the same thread.
+ */
+class StreamPipeline {
+public:
+    using ResultFn = messaging::utils::PendingReplies::ResultFn;
+
+    explicit StreamPipeline(int timeout_ms = 1000) : replies_(timeout_ms) {}
+
+    ~StreamPipeline() { close(); }
+
+    StreamPipeline(const StreamPipeline&) = delete;
+    StreamPipeline& operator=(const StreamPipeline&) = delete;
+
+    /**
+     * @brief Write request on its target's stream; its ACK is reported by a later poll().
+     * @return false if the stream is closed, in which case the request is reported as failed
+     */
+    bool send(const messaging::MessageEnvelope& request) {
+        TargetStream& target = stream_for(request.target());
+        replies_.expect(request.message_id());
+        if (target.closed || !target.stream->Write(request)) {
+            target.closed = true;
+            replies_.fail(request.message_id(), "Stream closed");
+            return false;
+        }
+        return true;
+    }
+
+    // Requests written but not yet reported by poll()
+    size_t in_flight() const { return replies_.in_flight(); }
+
+    size_t stream_count() const { return streams_.size(); }
+
+    // Wait up to wait_ms for completions and report them on this thread; returns how many
+    size_t poll(int wait_ms, const ResultFn& on_result) { return replies_.poll(wait_ms, on_result); }
+
+    // Poll until nothing is in flight
+    void drain_all(const ResultFn& on_result) { replies_.drain_all(on_result); }
+
+    // Half-close every stream and wait for the receivers to finish them
+    void close() {
+        for (auto& entry : streams_) {
+            TargetStream& target = *entry.second;
+            if (!target.stream) {
+                continue;
+            }
+            target.stream->WritesDone();
+            if (target.reader.joinable()) {
+                target.reader.join();
+            }
+            target.stream->Finish();
+            target.stream.reset();
+        }
+    }
+
+private:
+    struct TargetStream {
+        std::shared_ptr<grpc::Channel> channel;
+        std::unique_ptr<messaging::MessagingService::Stub> stub;
+        grpc::ClientContext context;
+        std::unique_ptr<grpc::ClientReaderWriter<messaging::MessageEnvelope, messaging::MessageEnvelope>> stream;
+        std::thread reader;
+        bool closed = false;  // only touched by the writing thread
+    };
+
+    TargetStream& stream_for(int target) {
+        auto it = streams_.find(target);
+        if (it != streams_.end()) {
+            return *it->second;
+        }
+        auto stream = std::make_unique<TargetStream>();
+        stream->channel = grpc::CreateChannel("localhost:" + std::to_string(50051 + target),
+                                              grpc::InsecureChannelCredentials());
+        stream->stub = messaging::MessagingService::NewStub(stream->channel);
+        stream->stream = stream->stub->StreamMessages(&stream->context);
+        TargetStream* raw = stream.get();
+        stream->reader = std::thread([this, raw]() {
+            messaging::utils::CpuAffinity::global().pin_this_thread();
+            read_loop(*raw);
+        });
+        return *streams_.emplace(target, std::move(stream)).first->second;
+    }
+
+    void read_loop(TargetStream& target) {
+        messaging::MessageEnvelope reply;
+        while (target.stream->Read(&reply)) {
+            std::string message_id = correlation_id(reply);
+            replies_.complete(message_id,
+                              message_helpers::is_batch(reply) || message_helpers::is_valid_ack(reply, message_id),
+                              messaging::utils::AckTiming::of(reply));
+        }
+    }
+
+    // ACKs name the original message; batch responses are "ack_<batch id>"
+    static std::string correlation_id(const messaging::MessageEnvelope& reply) {
+        if (reply.has_ack()) {
+            return reply.ack().original_message_id();
+        }
+        const std::string& id = reply.message_id();
+        return id.compare(0, 4, "ack_") == 0 ? id.substr(4) : id;
+    }
+
+    messaging::utils::PendingReplies replies_;
+    std::map<int, std::unique_ptr<TargetStream>> streams_;
+};
+
+#endif // GRPC_STREAM_PIPELINE_HPP
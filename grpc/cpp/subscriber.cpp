@@ -26,7 +26,7 @@ int main(int argc, char** argv) {
     std::unique_ptr<MessagingService::Stub> stub = MessagingService::NewStub(channel);
 
     ClientContext context;
-    std::shared_ptr<ClientReaderWriter<MessageEnvelope, MessageEnvelope>> stream(stub->SubscribeAndPublish(&context));
+    std::shared_ptr<ClientReaderWriter<MessageEnvelope, MessageEnvelope>> stream(stub->StreamMessages(&context));
 
     // Thread to handle incoming messages
     std::thread reader_thread([stream]() {
@@ -0,0 +1,229 @@
+#ifndef GRPC_UNARY_PIPELINE_HPP
+#define GRPC_UNARY_PIPELINE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include "messaging.grpc.pb.h"
+#include "../../utils/cpp/json.hpp"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+
+/**
+ * Settings for --cq.
+ *
+ * channels   - channels per receiver, each its own HTTP/2 connection; one is
+ *              usually enough, more spread a hot receiver over several sockets
+ * cq_threads - threads draining the completion queue
+ */
+struct UnaryOptions {
+    int channels = 1;
+    int cq_threads = 2;
+
+    // Parse --channels N and --cq-threads N
+    static UnaryOptions from_args(int argc, char* argv[]) {
+        UnaryOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+                options.channels = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--cq-threads") == 0 && i + 1 < argc) {
+                options.cq_threads = std::max(1, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Unary SendMessage calls issued without blocking onto one CompletionQueue.
+ *
+ * Channels are opened per receiver on first use and reused for the whole
+ * run; with several per receiver, calls go round-robin and each channel keeps
+ * its own connection (a local subchannel pool). send() starts the call and
+ * returns at once, so the caller's in-flight window, not a thread per call,
+ * bounds what is outstanding. The cq_threads threads turn each finished call
+ * into a TaskResult and poll() hands them back on the caller's thread. The
+ * per-call deadline is the ACK timeout, so gRPC reports timeouts itself.
+ *
+ * send(), poll() and close() must be called from the same thread.
+ */
+class UnaryPipeline {
+public:
+    using ResultFn = std::function<void(const messaging::utils::TaskResult& result)>;
+
+    explicit UnaryPipeline(const UnaryOptions& options, int timeout_ms = 1000)
+        : options_(options), timeout_ms_(timeout_ms) {
+        for (int t = 0; t < options_.cq_threads; ++t) {
+            threads_.emplace_back([this]() {
+                messaging::utils::CpuAffinity::global().pin_this_thread();
+                drain_queue();
+            });
+        }
+    }
+
+    ~UnaryPipeline() { close(); }
+
+    UnaryPipeline(const UnaryPipeline&) = delete;
+    UnaryPipeline& operator=(const UnaryPipeline&) = delete;
+
+    // Start request's call; its ACK or error is reported by a later poll(). The request is serialized here.
+    void send(const messaging::MessageEnvelope& request) {
+        Target& target = target_for(request.target());
+        Call* call = new Call;
+        call->message_id = request.message_id();
+        call->bytes = request.ByteSizeLong();
+        call->context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(timeout_ms_));
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            outstanding_++;
+        }
+        call->start_ns = message_helpers::get_steady_time_ns();
+        auto& stub = target.stubs[target.next++ % target.stubs.size()];
+        call->rpc = stub->PrepareAsyncSendMessage(&call->context, request, &cq_);
+        call->rpc->StartCall();
+        call->rpc->Finish(&call->reply, &call->status, call);
+    }
+
+    // Calls started but not yet reported by poll()
+    size_t in_flight() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return outstanding_;
+    }
+
+    size_t channel_count() const {
+        size_t count = 0;
+        for (const auto& entry : targets_) {
+            count += entry.second->channels.size();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Wait up to wait_ms for finished calls and report them on this thread.
+     * @return Number of calls completed (acked, failed or timed out)
+     */
+    size_t poll(int wait_ms, const ResultFn& on_result) {
+        std::vector<messaging::utils::TaskResult> ready;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            if (done_.empty() && wait_ms > 0) {
+                cv_.wait_for(lock, std::chrono::milliseconds(wait_ms), [this]() { return !done_.empty(); });
+            }
+            ready.swap(done_);
+            outstanding_ -= ready.size();
+        }
+        for (const auto& res : ready) {
+            on_result(res);
+        }
+        return ready.size();
+    }
+
+    // Poll until every started call has finished and been reported
+    void drain_all(const ResultFn& on_result) {
+        while (in_flight() > 0) {
+            poll(10, on_result);
+        }
+    }
+
+    // Stop the queue; calls still running finish (at the latest by their deadline) before the threads exit
+    void close() {
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+        cq_.Shutdown();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    nlohmann::json report() const {
+        return {
+            {"channels_per_target", options_.channels},
+            {"cq_threads", options_.cq_threads},
+            {"timeout_ms", timeout_ms_}
+        };
+    }
+
+private:
+    struct Call {
+        grpc::ClientContext context;
+        messaging::MessageEnvelope reply;
+        grpc::Status status;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<messaging::MessageEnvelope>> rpc;
+        std::string message_id;
+        size_t bytes = 0;
+        long long start_ns = 0;
+    };
+
+    struct Target {
+        std::vector<std::shared_ptr<grpc::Channel>> channels;
+        std::vector<std::unique_ptr<messaging::MessagingService::Stub>> stubs;
+        size_t next = 0;
+    };
+
+    Target& target_for(int target) {
+        auto it = targets_.find(target);
+        if (it != targets_.end()) {
+            return *it->second;
+        }
+        auto entry = std::make_unique<Target>();
+        std::string address = "localhost:" + std::to_string(50051 + target);
+        for (int c = 0; c < options_.channels; ++c) {
+            // Without a local pool, channels with equal arguments share one connection
+            grpc::ChannelArguments args;
+            args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+            entry->channels.push_back(grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args));
+            entry->stubs.push_back(messaging::MessagingService::NewStub(entry->channels.back()));
+        }
+        return *targets_.emplace(target, std::move(entry)).first->second;
+    }
+
+    void drain_queue() {
+        void* tag = nullptr;
+        bool ok = false;
+        while (cq_.Next(&tag, &ok)) {
+            std::unique_ptr<Call> call(static_cast<Call*>(tag));
+            messaging::utils::TaskResult res;
+            res.message_id = call->message_id;
+            res.bytes = call->bytes;
+            if (!ok || !call->status.ok()) {
+                res.error = call->status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED
+                    ? "Timeout" : call->status.error_message();
+            } else if (message_helpers::is_valid_ack(call->reply, res.message_id)) {
+                res.duration_ns = message_helpers::get_steady_time_ns() - call->start_ns;
+                res.ack_timing = messaging::utils::AckTiming::of(call->reply);
+                res.success = true;
+            } else {
+                res.error = "Invalid ACK";
+            }
+            std::lock_guard<std::mutex> lock(mu_);
+            done_.push_back(std::move(res));
+            cv_.notify_one();
+        }
+    }
+
+    UnaryOptions options_;
+    int timeout_ms_;
+    std::map<int, std::unique_ptr<Target>> targets_;
+    grpc::CompletionQueue cq_;
+    std::vector<std::thread> threads_;
+    bool closed_ = false;
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    size_t outstanding_ = 0;   // started and not yet reported
+    std::vector<messaging::utils::TaskResult> done_;
+};
+
+#endif // GRPC_UNARY_PIPELINE_HPP
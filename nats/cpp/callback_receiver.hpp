@@ -0,0 +1,267 @@
+#ifndef NATS_CALLBACK_RECEIVER_HPP
+#define NATS_CALLBACK_RECEIVER_HPP
+
+#include <nats/nats.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include "../../utils/cpp/json.hpp"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+#include "inbox_replies.hpp"
+
+/**
+ * How requests reach the async receiver's callbacks.
+ *
+ * workers       - subscriptions to the receiver's subject; above 1 they join one
+ *                 queue group, so the server spreads requests across them and
+ *                 their callbacks run concurrently
+ * delivery_pool - threads in the library's shared delivery pool
+ *                 (natsOptions_UseGlobalMessageDelivery), to which subscriptions
+ *                 are assigned round-robin; 0 = one thread per subscription
+ * pending_msgs  - per-subscription pending limits (natsSubscription_SetPendingLimits);
+ * pending_bytes   past either, the library drops messages and reports
+ *                 NATS_SLOW_CONSUMER. 0 = library default (65536 msgs, 64 MB), -1 = none
+ */
+struct DeliveryOptions {
+    int workers = 1;
+    int delivery_pool = 0;
+    int pending_msgs = 0;
+    int pending_bytes = 0;
+
+    // Parse --workers N, --delivery-pool N, --pending-msgs N and --pending-bytes N
+    static DeliveryOptions from_args(int argc, char* argv[]) {
+        DeliveryOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+                options.workers = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--delivery-pool") == 0 && i + 1 < argc) {
+                options.delivery_pool = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--pending-msgs") == 0 && i + 1 < argc) {
+                options.pending_msgs = std::max(-1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--pending-bytes") == 0 && i + 1 < argc) {
+                options.pending_bytes = std::max(-1, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Async-subscription receiver: requests on "test.subject.<id>" are answered
+ * from library callbacks, on the delivery threads DeliveryOptions describes.
+ * Each worker subscription has its own InboxReplies, so callbacks never
+ * share an ACK encoder; the main loop only flushes coalesced ACKs.
+ *
+ * Messages that overflow a subscription's pending limits are dropped by the
+ * library, not the server, and would otherwise only show up as sender
+ * timeouts. The connection's error handler counts each slow-consumer
+ * episode and warns on stderr, and shutdown prints a "delivery={...}" line
+ * with the totals, which test_harness.py adds to the receiver's stats.
+ */
+class CallbackReceiver {
+public:
+    CallbackReceiver(int receiver_id, const messaging::utils::CoalesceOptions& coalesce,
+                     const DeliveryOptions& delivery, const std::string& url = "nats://localhost:4222")
+        : id_(std::to_string(receiver_id)), subject_("test.subject." + id_), url_(url), delivery_(delivery),
+          progress_(messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Receiver " + id_, {"received"})) {
+        for (int w = 0; w < delivery_.workers; ++w) {
+            workers_.push_back(std::make_unique<Worker>(this, id_, coalesce));
+        }
+    }
+
+    ~CallbackReceiver() {
+        for (auto& worker : workers_) {
+            if (worker->sub) {
+                natsSubscription_Destroy(worker->sub);
+            }
+        }
+        if (conn_) {
+            natsConnection_Destroy(conn_);
+        }
+    }
+
+    CallbackReceiver(const CallbackReceiver&) = delete;
+    CallbackReceiver& operator=(const CallbackReceiver&) = delete;
+
+    // Subscribe and serve until running turns false; returns non-zero if NATS is unreachable
+    int run(std::atomic<bool>& running) {
+        if (!connect() || !subscribe()) {
+            return 1;
+        }
+        std::cout << " [*] [ASYNC] Receiver " << id_ << " subscribed to " << subject_;
+        if (delivery_.workers > 1 || delivery_.delivery_pool > 0) {
+            std::cout << " (" << delivery_.workers << " subscriptions, "
+                      << (delivery_.delivery_pool > 0 ? std::to_string(delivery_.delivery_pool) + " pooled"
+                                                      : std::string("dedicated"))
+                      << " delivery threads)";
+        }
+        std::cout << std::endl;
+
+        int idle_ms = workers_.front()->replies.idle_ms();
+        while (running) {
+            nats_Sleep(idle_ms);
+            for (auto& worker : workers_) {
+                worker->replies.flush(conn_);
+            }
+        }
+        // The library's counters go with the subscriptions, so read them first
+        nlohmann::json delivery = report();
+        // Stop new deliveries, then send whatever coalesced ACKs are still queued
+        for (auto& worker : workers_) {
+            natsSubscription_Unsubscribe(worker->sub);
+        }
+        for (auto& worker : workers_) {
+            worker->replies.flush(conn_, true);
+        }
+        natsConnection_FlushTimeout(conn_, 1000);
+
+        messaging::utils::flush_log();
+        std::cout << " [x] [ASYNC] Receiver " << id_ << " shutting down (received " << received() << " messages)"
+                  << std::endl;
+        std::cout << " [x] [ASYNC] Receiver " << id_ << " delivery=" << delivery.dump() << std::endl;
+        return 0;
+    }
+
+    uint64_t received() const {
+        uint64_t total = 0;
+        for (const auto& worker : workers_) {
+            total += worker->received.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Delivery settings, slow-consumer episodes and the library's per-subscription counters, summed
+    nlohmann::json report() const {
+        int64_t delivered = 0;
+        int64_t dropped = 0;
+        int max_pending = 0;
+        int limit_msgs = 0;
+        int limit_bytes = 0;
+        for (const auto& worker : workers_) {
+            int pending_msgs = 0, pending_bytes = 0, max_msgs = 0, max_bytes = 0;
+            int64_t worker_delivered = 0, worker_dropped = 0;
+            if (worker->sub &&
+                natsSubscription_GetStats(worker->sub, &pending_msgs, &pending_bytes, &max_msgs, &max_bytes,
+                                          &worker_delivered, &worker_dropped) == NATS_OK) {
+                delivered += worker_delivered;
+                dropped += worker_dropped;
+                max_pending = std::max(max_pending, max_msgs);
+            }
+        }
+        if (!workers_.empty() && workers_.front()->sub) {
+            natsSubscription_GetPendingLimits(workers_.front()->sub, &limit_msgs, &limit_bytes);
+        }
+        return {
+            {"workers", delivery_.workers},
+            {"delivery_pool", delivery_.delivery_pool},
+            {"pending_limit_msgs", limit_msgs},
+            {"pending_limit_bytes", limit_bytes},
+            {"max_pending_msgs", max_pending},
+            {"delivered", delivered},
+            {"dropped", dropped},
+            {"slow_consumer_events", slow_consumer_events_.load()}
+        };
+    }
+
+private:
+    struct Worker {
+        CallbackReceiver* owner;
+        InboxReplies replies;
+        natsSubscription* sub = nullptr;
+        std::atomic<uint64_t> received{0};
+
+        Worker(CallbackReceiver* owner, const std::string& receiver_id, const messaging::utils::CoalesceOptions& coalesce)
+            : owner(owner), replies(receiver_id, coalesce, true) {}
+    };
+
+    static void on_msg(natsConnection *nc, natsSubscription *sub, natsMsg *msg, void *closure) {
+        Worker* worker = static_cast<Worker*>(closure);
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+        MessageEnvelope request;
+        if (message_helpers::parse_envelope(natsMsg_GetData(msg), natsMsg_GetDataLength(msg), request)) {
+            messaging::utils::log_debug() << " [x] [ASYNC] Received message " << request.message_id();
+            worker->received.fetch_add(1, std::memory_order_relaxed);
+            worker->owner->progress_.add(0);
+            // ACK (a BatchResponse for batches) on the reply subject, or coalesced per inbox
+            worker->replies.reply(nc, msg, request, timing);
+        }
+        natsMsg_Destroy(msg);
+    }
+
+    // The library reports a subscription once each time it starts dropping, not per message
+    static void on_error(natsConnection *nc, natsSubscription *sub, natsStatus err, void *closure) {
+        CallbackReceiver* self = static_cast<CallbackReceiver*>(closure);
+        if (err == NATS_SLOW_CONSUMER) {
+            self->slow_consumer_events_++;
+            int64_t dropped = 0;
+            if (sub) {
+                natsSubscription_GetDropped(sub, &dropped);
+            }
+            std::cerr << " [!] Receiver " << self->id_ << ": slow consumer, " << dropped
+                      << " messages dropped so far" << std::endl;
+        } else {
+            std::cerr << " [!] Receiver " << self->id_ << ": " << natsStatus_GetText(err) << std::endl;
+        }
+    }
+
+    bool connect() {
+        // The pool size is process-wide and only takes effect before the first pooled connection
+        if (delivery_.delivery_pool > 0) {
+            nats_SetMessageDeliveryPoolSize(delivery_.delivery_pool);
+        }
+        natsOptions* opts = nullptr;
+        natsStatus s = natsOptions_Create(&opts);
+        if (s == NATS_OK) s = natsOptions_SetURL(opts, url_.c_str());
+        if (s == NATS_OK) s = natsOptions_SetErrorHandler(opts, &CallbackReceiver::on_error, this);
+        if (s == NATS_OK && delivery_.delivery_pool > 0) s = natsOptions_UseGlobalMessageDelivery(opts, true);
+        if (s == NATS_OK) s = natsConnection_Connect(&conn_, opts);
+        natsOptions_Destroy(opts);
+        if (s != NATS_OK) {
+            std::cerr << "Failed to connect: " << natsStatus_GetText(s) << std::endl;
+            conn_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool subscribe() {
+        std::string group = "receiver_" + id_;
+        for (auto& worker : workers_) {
+            natsStatus s = workers_.size() > 1
+                ? natsConnection_QueueSubscribe(&worker->sub, conn_, subject_.c_str(), group.c_str(),
+                                                &CallbackReceiver::on_msg, worker.get())
+                : natsConnection_Subscribe(&worker->sub, conn_, subject_.c_str(), &CallbackReceiver::on_msg,
+                                           worker.get());
+            if (s == NATS_OK && (delivery_.pending_msgs != 0 || delivery_.pending_bytes != 0)) {
+                int msgs = 0, bytes = 0;
+                natsSubscription_GetPendingLimits(worker->sub, &msgs, &bytes);
+                s = natsSubscription_SetPendingLimits(worker->sub,
+                                                      delivery_.pending_msgs != 0 ? delivery_.pending_msgs : msgs,
+                                                      delivery_.pending_bytes != 0 ? delivery_.pending_bytes : bytes);
+            }
+            if (s != NATS_OK) {
+                std::cerr << "Failed to subscribe: " << natsStatus_GetText(s) << std::endl;
+                return false;
+            }
+        }
+        // Make sure the server has every subscription before senders are told we are up
+        return natsConnection_Flush(conn_) == NATS_OK;
+    }
+
+    std::string id_;
+    std::string subject_;
+    std::string url_;
+    DeliveryOptions delivery_;
+    messaging::utils::LogSummary& progress_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    natsConnection* conn_ = nullptr;
+    std::atomic<uint64_t> slow_consumer_events_{0};
+};
+
+#endif // NATS_CALLBACK_RECEIVER_HPP
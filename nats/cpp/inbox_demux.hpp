@@ -0,0 +1,118 @@
+#ifndef NATS_INBOX_DEMUX_HPP
+#define NATS_INBOX_DEMUX_HPP
+
+#include <nats/nats.h>
+#include <string>
+#include <string_view>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/pending_replies.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+
+/**
+ * Asynchronous request/ACK over one wildcard reply subscription.
+ *
+ * natsConnection_Request creates an inbox per call and blocks its thread
+ * until the reply arrives. Here every request is published with
+ * natsConnection_PublishRequest and a reply subject under one inbox prefix
+ * (_INBOX.<id>.<seq>), and a single "_INBOX.<id>.*" subscription's callback
+ * matches ACKs to outstanding requests by Acknowledgment.original_message_id.
+ * A receiver coalescing ACKs answers several requests at once on any subject
+ * under the prefix, and that reply completes every request it lists.
+ * PendingReplies times requests out and hands completions back on the
+ * caller's thread from poll().
+ */
+class InboxDemux {
+public:
+    using ResultFn = messaging::utils::PendingReplies::ResultFn;
+
+    InboxDemux(natsConnection *conn, int timeout_ms = 1000)
+        : conn_(conn), replies_(timeout_ms) {}
+
+    ~InboxDemux() {
+        if (sub_) {
+            natsSubscription_Unsubscribe(sub_);
+            natsSubscription_Destroy(sub_);
+        }
+    }
+
+    InboxDemux(const InboxDemux&) = delete;
+    InboxDemux& operator=(const InboxDemux&) = delete;
+
+    // Subscribe to the inbox wildcard; returns the NATS status
+    natsStatus start() {
+        char *inbox = nullptr;
+        natsStatus s = natsInbox_Create(&inbox);
+        if (s != NATS_OK) {
+            return s;
+        }
+        prefix_ = std::string(inbox) + ".";
+        natsInbox_Destroy(inbox);
+
+        s = natsConnection_Subscribe(&sub_, conn_, (prefix_ + "*").c_str(), &InboxDemux::on_message, this);
+        if (s == NATS_OK) {
+            // Never drop ACKs as a slow consumer; the in-flight window bounds the backlog
+            s = natsSubscription_SetPendingLimits(sub_, -1, -1);
+        }
+        if (s == NATS_OK) {
+            // Make sure the server has the subscription before the first request goes out
+            s = natsConnection_Flush(conn_);
+        }
+        return s;
+    }
+
+    // Publish body to subject; its ACK is reported by a later poll()
+    void send(const std::string& subject, const std::string& message_id, std::string_view body) {
+        reply_.assign(prefix_).append(std::to_string(++seq_));
+        replies_.expect(message_id);
+        natsStatus s = natsConnection_PublishRequest(conn_, subject.c_str(), reply_.c_str(),
+                                                     body.data(), static_cast<int>(body.size()));
+        if (s != NATS_OK) {
+            replies_.fail(message_id, natsStatus_GetText(s));
+        }
+    }
+
+    // Requests published but not yet reported by poll()
+    size_t in_flight() const { return replies_.in_flight(); }
+
+    // Wait up to wait_ms for completions and report them on this thread; returns how many
+    size_t poll(int wait_ms, const ResultFn& on_result) { return replies_.poll(wait_ms, on_result); }
+
+    // Poll until nothing is in flight
+    void drain_all(const ResultFn& on_result) { replies_.drain_all(on_result); }
+
+private:
+    // Runs on the subscription's delivery thread
+    static void on_message(natsConnection *, natsSubscription *, natsMsg *msg, void *closure) {
+        InboxDemux *self = static_cast<InboxDemux*>(closure);
+        if (message_helpers::parse_envelope(natsMsg_GetData(msg), natsMsg_GetDataLength(msg), self->envelope_) &&
+            (self->envelope_.has_ack() || messaging::utils::is_coalesced_ack(self->envelope_))) {
+            self->complete(self->envelope_);
+        }
+        natsMsg_Destroy(msg);
+    }
+
+    // A plain ACK, or a receiver's coalesced reply completing several requests at once
+    void complete(const MessageEnvelope& envelope) {
+        if (messaging::utils::coalesced_acks(envelope, coalesced_)) {
+            for (const Acknowledgment& ack : coalesced_.acknowledgments()) {
+                replies_.complete(ack.original_message_id(), ack.received() && message_helpers::is_ack_ok(ack),
+                                  messaging::utils::AckTiming::of(ack));
+            }
+        } else {
+            const std::string& message_id = envelope.ack().original_message_id();
+            replies_.complete(message_id, message_helpers::is_valid_ack(envelope, message_id),
+                              messaging::utils::AckTiming::of(envelope.ack()));
+        }
+    }
+
+    natsConnection *conn_;
+    natsSubscription *sub_ = nullptr;
+    std::string prefix_;                // "_INBOX.<id>."
+    std::string reply_;                 // reused reply subject buffer
+    unsigned long long seq_ = 0;
+    MessageEnvelope envelope_;          // only touched by the delivery thread
+    messaging::BatchResponse coalesced_; // likewise
+    messaging::utils::PendingReplies replies_;
+};
+
+#endif // NATS_INBOX_DEMUX_HPP
@@ -0,0 +1,78 @@
+#ifndef NATS_INBOX_REPLIES_HPP
+#define NATS_INBOX_REPLIES_HPP
+
+#include <nats/nats.h>
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <algorithm>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+
+/**
+ * Receiver-side ACK replies to NATS requests, optionally coalesced.
+ *
+ * Without coalescing every request is answered on its own reply subject. With
+ * it, ACKs are grouped by the reply subject's inbox prefix ("_INBOX.<id>."),
+ * which InboxDemux shares across all of one sender's requests, and each group
+ * is published once to "<prefix>acks"; the sender's "<prefix>*" subscription
+ * takes it like any other reply. The subscription callback and the receiver's
+ * main loop (which flushes groups that have waited too long) share this, so
+ * the coalescer is guarded by a mutex.
+ */
+class InboxReplies {
+public:
+    InboxReplies(const std::string& receiver_id, const messaging::utils::CoalesceOptions& coalesce, bool async = false)
+        : acks_(receiver_id, async), coalescer_(receiver_id, coalesce, async) {}
+
+    // Answer request, which arrived in msg, from the subscription callback
+    void reply(natsConnection *nc, natsMsg *msg, const MessageEnvelope& request,
+               const message_helpers::ReceiveTiming& timing) {
+        const char* reply_subject = natsMsg_GetReply(msg);
+        if (!reply_subject) {
+            return;
+        }
+        std::string_view subject(reply_subject);
+        size_t dot = subject.rfind('.');
+        if (!coalescer_.options().enabled() || dot == std::string_view::npos || message_helpers::is_batch(request) ||
+            message_helpers::is_control(request)) {
+            std::string_view response = acks_.encode_response(request, timing);
+            TRACED("reply", natsConnection_Publish(nc, reply_subject, response.data(), static_cast<int>(response.size())));
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        inbox_.assign(subject.substr(0, dot + 1));
+        if (coalescer_.add(inbox_, request, timing)) {
+            publish(nc, inbox_, coalescer_.take(inbox_));
+        }
+    }
+
+    // Publish groups past their delay (all of them if all is set); call from the main loop
+    void flush(natsConnection *nc, bool all = false) {
+        std::lock_guard<std::mutex> lock(mu_);
+        coalescer_.flush([&](const std::string& inbox, std::string_view response) { publish(nc, inbox, response); },
+                         all);
+    }
+
+    // How long the main loop may sleep between flushes
+    int idle_ms() const {
+        const auto& options = coalescer_.options();
+        return options.enabled() ? std::max(1, options.max_delay_us / 1000) : 100;
+    }
+
+private:
+    void publish(natsConnection *nc, const std::string& inbox, std::string_view response) {
+        subject_.assign(inbox).append("acks");
+        TRACED("reply", natsConnection_Publish(nc, subject_.c_str(), response.data(), static_cast<int>(response.size())));
+    }
+
+    messaging::utils::AckEncoder acks_;        // only used by the callback thread
+    std::mutex mu_;
+    messaging::utils::AckCoalescer coalescer_;
+    std::string inbox_;
+    std::string subject_;
+};
+
+#endif // NATS_INBOX_REPLIES_HPP
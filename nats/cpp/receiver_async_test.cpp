@@ -2,12 +2,11 @@
 #include <iostream>
 #include <string>
 #include <signal.h>
-#include <thread>
 #include <atomic>
 #include "../../utils/cpp/message_helpers.hpp"
-
-using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "callback_receiver.hpp"
 
 std::atomic<bool> running(true);
 
@@ -15,34 +14,8 @@ void signal_handler(int sig) {
     running = false;
 }
 
-void onMsg(natsConnection *nc, natsSubscription *sub, natsMsg *msg, void *closure) {
-    int *receiver_id = (int*)closure;
-
-    std::string request_str(natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
-    
-    MessageEnvelope request_envelope;
-    if (message_helpers::parse_envelope(request_str, request_envelope)) {
-        std::string message_id = request_envelope.message_id();
-        std::cout << " [x] [ASYNC] Received message " << message_id << std::endl;
-
-        // Create ACK
-        MessageEnvelope response = message_helpers::create_ack_from_envelope(
-            request_envelope,
-            std::to_string(*receiver_id)
-        );
-        response.set_async(true);
-        std::string resp_str = message_helpers::serialize_envelope(response);
-        
-        // Send reply
-        if (natsMsg_GetReply(msg)) {
-            natsConnection_Publish(nc, natsMsg_GetReply(msg), resp_str.c_str(), (int)resp_str.size());
-        }
-    }
-
-    natsMsg_Destroy(msg);
-}
-
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
     
     for (int i = 1; i < argc; ++i) {
@@ -54,31 +27,11 @@ int main(int argc, char* argv[]) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
-    natsConnection *conn = NULL;
-    natsStatus s = natsConnection_ConnectTo(&conn, "nats://localhost:4222");
-    if (s != NATS_OK) {
-        std::cerr << "Failed to connect: " << natsStatus_GetText(s) << std::endl;
-        return 1;
-    }
-
-    std::string subject = "test.subject." + std::to_string(receiver_id);
-    natsSubscription *sub = NULL;
-    s = natsConnection_Subscribe(&sub, conn, subject.c_str(), onMsg, &receiver_id);
-    if (s != NATS_OK) {
-        std::cerr << "Failed to subscribe: " << natsStatus_GetText(s) << std::endl;
-        natsConnection_Destroy(conn);
-        return 1;
-    }
-
-    std::cout << " [*] [ASYNC] Receiver " << receiver_id << " subscribed to " << subject << std::endl;
-
-    while (running) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-
-    std::cout << " [x] [ASYNC] Receiver " << receiver_id << " shutting down" << std::endl;
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
 
-    natsSubscription_Destroy(sub);
-    natsConnection_Destroy(conn);
-    return 0;
+    // --workers, --delivery-pool and --pending-msgs/--pending-bytes shape the callback delivery
+    CallbackReceiver receiver(receiver_id, messaging::utils::CoalesceOptions::from_args(argc, argv),
+                              DeliveryOptions::from_args(argc, argv));
+    return receiver.run(running);
 }
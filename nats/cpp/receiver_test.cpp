@@ -2,37 +2,36 @@
 #include <iostream>
 #include <string>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "inbox_replies.hpp"
 
 using messaging::MessageEnvelope;
 using message_helpers::get_current_time_ms;
 
+messaging::utils::LogSummary* progress = nullptr;
+
 void onMsg(natsConnection *nc, natsSubscription *sub, natsMsg *msg, void *closure) {
-    int *receiver_id = (int*)closure;
+    auto *replies = (InboxReplies*)closure;
 
+    message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
     std::string request_str(natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
     
     MessageEnvelope request_envelope;
     if (message_helpers::parse_envelope(request_str, request_envelope)) {
         std::string message_id = request_envelope.message_id();
-        std::cout << " [x] Received message " << message_id << std::endl;
+        messaging::utils::log_debug() << " [x] Received message " << message_id;
+        progress->add(0);
 
-        // Create ACK
-        MessageEnvelope response = message_helpers::create_ack_from_envelope(
-            request_envelope,
-            std::to_string(*receiver_id)
-        );
-        std::string resp_str = message_helpers::serialize_envelope(response);
-        
-        // Send reply
-        if (natsMsg_GetReply(msg)) {
-            natsConnection_Publish(nc, natsMsg_GetReply(msg), resp_str.c_str(), (int)resp_str.size());
-        }
+        // ACK (a BatchResponse for batches) on the reply subject, or coalesced per inbox
+        replies->reply(nc, msg, request_envelope, timing);
     }
 
     natsMsg_Destroy(msg);
 }
 
 int main(int argc, char** argv) {
+    messaging::utils::configure_affinity(argc, argv);
     int id = 0;
     
     for (int i = 1; i < argc; ++i) {
@@ -41,6 +40,12 @@ int main(int argc, char** argv) {
         }
     }
 
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    progress = &messaging::utils::AsyncLogger::global().summary(
+        " [*] Receiver " + std::to_string(id), {"received"});
+    InboxReplies replies(std::to_string(id), messaging::utils::CoalesceOptions::from_args(argc, argv));
+
     natsConnection *conn = NULL;
     natsStatus s = natsConnection_ConnectTo(&conn, "nats://localhost:4222");
     if (s != NATS_OK) {
@@ -50,7 +55,7 @@ int main(int argc, char** argv) {
 
     std::string subject = "test.subject." + std::to_string(id);
     natsSubscription *sub = NULL;
-    s = natsConnection_Subscribe(&sub, conn, subject.c_str(), onMsg, &id);
+    s = natsConnection_Subscribe(&sub, conn, subject.c_str(), onMsg, &replies);
     if (s != NATS_OK) {
         std::cerr << "Failed to subscribe: " << natsStatus_GetText(s) << std::endl;
         natsConnection_Destroy(conn);
@@ -60,7 +65,8 @@ int main(int argc, char** argv) {
     std::cout << " [*] Receiver " << id << " awaiting NATS requests on " << subject << std::endl;
 
     while (true) {
-        nats_Sleep(100);
+        nats_Sleep(replies.idle_ms());
+        replies.flush(conn);
     }
 
     natsSubscription_Destroy(sub);
@@ -2,40 +2,55 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <future>
 #include <vector>
+#include <cstring>
+#include <algorithm>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "inbox_demux.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
-
-struct TaskResult {
-    bool success;
-    std::string message_id;
-    long long duration;
-    std::string error;
-};
-
-TaskResult send_message_task(natsConnection *conn, const json& item) {
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
+
+// First attempts stamp the corpus in place, others encode a copy (see Attempt)
+TaskResult send_message_task(natsConnection *conn, test_data_loader::EncodedCorpus& corpus, size_t i,
+                             const Attempt& attempt) {
     TaskResult res;
     res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
+    res.message_id = std::string(corpus.message_id(i));
+    res.duration_ns = 0;
 
-    int target = item.value("target", 0);
-    std::string subject = "test.subject." + std::to_string(target);
+    int target = corpus.target(i);
+    static const messaging::utils::TopicTable subjects("test.subject.");
+    const std::string& subject = subjects[target];
 
-    long long msg_start = get_current_time_ms();
+    long long msg_start = get_steady_time_ns();
 
-    // Create and send message
-    MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-    std::string body = message_helpers::serialize_envelope(envelope);
+    // Stamp the pre-encoded envelope and send it
+    thread_local std::string copy;
+    int64_t now_us = message_helpers::get_current_time_us();
+    std::string_view body = attempt.number == 0 ? corpus.stamp(i, now_us) : corpus.encode(i, now_us, {}, copy);
+    res.bytes = body.size();
 
     natsMsg *reply = NULL;
-    natsStatus s = natsConnection_Request(&reply, conn, subject.c_str(), body.data(), (int)body.size(), 100);
+    natsStatus s = natsConnection_Request(&reply, conn, subject.c_str(), body.data(), (int)body.size(),
+                                          attempt.timeout_ms(100));
 
     if (s == NATS_OK) {
         std::string reply_str(natsMsg_GetData(reply), natsMsg_GetDataLength(reply));
@@ -43,7 +58,8 @@ TaskResult send_message_task(natsConnection *conn, const json& item) {
         MessageEnvelope resp_envelope;
         if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
             message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
-            res.duration = get_current_time_ms() - msg_start;
+            res.duration_ns = get_steady_time_ns() - msg_start;
+            res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
             res.success = true;
         } else {
             res.error = "Invalid ACK";
@@ -56,16 +72,65 @@ TaskResult send_message_task(natsConnection *conn, const json& item) {
     return res;
 }
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+/**
+ * Publish every message from this thread with natsConnection_PublishRequest,
+ * keeping up to max_in_flight awaiting ACKs on the demux's inbox; returns the
+ * peak in flight.
+ */
+int run_inbox_pipeline(InboxDemux& demux, test_data_loader::EncodedCorpus& corpus, int max_in_flight,
+                       const AsyncSendEngine::ResultFn& on_result, MessageStats& stats) {
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t peak = 0;
+    std::string subject;
+    std::string message_id;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        // Wait for room in the window, picking up whatever ACKs have arrived meanwhile
+        while (demux.in_flight() >= window) {
+            demux.poll(10, on_result);
+        }
+        subject.assign("test.subject.").append(std::to_string(corpus.target(i)));
+        message_id.assign(corpus.message_id(i));
+        TRACED("send", demux.send(subject, message_id, corpus.stamp(i, message_helpers::get_current_time_us())));
+        stats.record_dispatch();
+        peak = std::max(peak, demux.in_flight());
+        demux.poll(0, on_result);
+    }
+    demux.drain_all(on_result);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    corpus.attach_qos(options.qos);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    bool use_inbox = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--inbox") == 0) {
+            use_inbox = true;
+        }
+    }
+    if (use_inbox) {
+        options.warn_ignored_by("--inbox");
+    }
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "NATS"},
         {"language", "C++"},
-        {"async", true}
+        {"async", true},
+        {"transport", use_inbox ? "inbox" : "request"},
+        {"workers", use_inbox ? 1 : options.workers},
+        {"max_in_flight", options.max_in_flight}
     });
-    long long start_time = get_current_time_ms();
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
     natsConnection *conn = NULL;
     natsStatus s = natsConnection_ConnectTo(&conn, "nats://localhost:4222");
@@ -74,29 +139,84 @@ int main() {
         return 1;
     }
 
-    std::cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << std::endl;
-
-    std::vector<std::future<TaskResult>> futures;
-    for (auto& item : test_data) {
-        futures.push_back(std::async(std::launch::async, send_message_task, conn, item));
-    }
-
-    for (auto& fut : futures) {
-        TaskResult res = fut.get();
+    // --wait-ready: PING every receiver's subject before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "nats-async-sender");
+    MessageEnvelope pong;
+    ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string&, std::string_view ping) {
+        std::string subject = "test.subject." + std::to_string(target);
+        natsMsg *reply = NULL;
+        bool replied = natsConnection_Request(&reply, conn, subject.c_str(), ping.data(), (int)ping.size(), 100) == NATS_OK &&
+            message_helpers::parse_envelope(natsMsg_GetData(reply), natsMsg_GetDataLength(reply), pong);
+        if (reply) natsMsg_Destroy(reply);
+        return replied ? &pong : nullptr;
+    });
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("NATS");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
+
+    auto on_result = [&](const TaskResult& res) {
         if (res.success) {
-            stats.record_message(true, res.duration);
-            std::cout << " [OK] Message " << res.message_id << " acknowledged" << std::endl;
+            stats.record_message_ns(true, res.duration_ns);
+            stats.record_breakdown(res.ack_timing, res.duration_ns);
+            stats.record_bytes(res.bytes);
+            progress.add(0);
+            log_debug() << " [OK] Message " << res.message_id << " acknowledged";
         } else {
             stats.record_message(false);
-            std::cout << " [FAILED] Message " << res.message_id << ": " << res.error << std::endl;
+            progress.add(1);
+            log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+        }
+    };
+
+    if (use_inbox) {
+        // One thread and one reply subscription; the window is the only concurrency
+        InboxDemux demux(conn, 1000);  // 1s ACK timeout
+        s = demux.start();
+        if (s != NATS_OK) {
+            std::cerr << "Reply subscription failed: " << natsStatus_GetText(s) << std::endl;
+            natsConnection_Destroy(conn);
+            return 1;
+        }
+        int peak = run_inbox_pipeline(demux, corpus, options.max_in_flight, on_result, stats);
+        stats.add_metadata("peak_in_flight", peak);
+    } else {
+        AsyncSendEngine engine(options);
+        engine.run(corpus.size(),
+            [&](size_t i, const Attempt& attempt) {
+                if (attempt.number == 0) {
+                    stats.record_dispatch();
+                }
+                return send_message_task(conn, corpus, i, attempt);
+            },
+            on_result);
+        stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+        if (options.open_loop()) {
+            stats.add_metadata("open_loop", engine.open_loop_report());
+        }
+        if (options.policy.enabled()) {
+            stats.add_metadata("request_policy", engine.policy_report());
+        }
+        if (options.qos.enabled()) {
+            stats.add_metadata("qos", options.qos.report(engine.retransmits()));
         }
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results (ASYNC):" << std::endl;
     std::cout << "total_sent: " << stats.sent_count << std::endl;
     std::cout << "total_received: " << stats.received_count << std::endl;
@@ -2,26 +2,71 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <memory>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/batch_builder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
+using messaging::utils::BatchOptions;
+using messaging::utils::BatchAccumulator;
+using messaging::utils::BatchBuilder;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::TaskResult;
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+// One sending thread's connection, so partitions don't share a socket or its reply inbox
+struct Connection {
+    ~Connection() {
+        if (conn) natsConnection_Destroy(conn);
+    }
+
+    natsConnection *conn = NULL;
+    natsStatus status = NATS_OK;
+};
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    corpus.attach_qos(qos);
+    BatchOptions batch_options = BatchOptions::from_args(argc, argv);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    if (batch_options.enabled()) {
+        partition_options.warn_ignored_by("--batch");
+        qos.warn_ignored_by("--batch");
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "NATS"},
         {"language", "C++"},
-        {"async", false}
+        {"async", false},
+        {"batch_size", batch_options.max_messages},
+        {"batch_linger_ms", batch_options.linger_ms},
+        {"partitions", batch_options.enabled() ? 1 : partition_options.partitions}
     });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting transfer of " << test_data.size() << " messages..." << std::endl;
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
     natsConnection *conn = NULL;
     natsStatus s = natsConnection_ConnectTo(&conn, "nats://localhost:4222");
@@ -30,46 +75,144 @@ int main() {
         return 1;
     }
 
-    for (auto& item : test_data) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
-        std::cout << " [x] Sending message " << message_id << " to target " << target << "..." << std::flush;
-
+    // --wait-ready: PING every receiver's subject before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "nats-sender");
+    MessageEnvelope pong;
+    ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string&, std::string_view ping) {
         std::string subject = "test.subject." + std::to_string(target);
-        long long msg_start = get_current_time_ms();
+        natsMsg *reply = NULL;
+        bool replied = natsConnection_Request(&reply, conn, subject.c_str(), ping.data(), (int)ping.size(), 100) == NATS_OK &&
+            message_helpers::parse_envelope(natsMsg_GetData(reply), natsMsg_GetDataLength(reply), pong);
+        if (reply) natsMsg_Destroy(reply);
+        return replied ? &pong : nullptr;
+    });
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("NATS");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
 
-        // Create and send protobuf message
-        MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-        std::string body = message_helpers::serialize_envelope(envelope);
+    std::cout << " [x] Starting transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
 
-        natsMsg *reply = NULL;
-        s = natsConnection_Request(&reply, conn, subject.c_str(), body.data(), body.size(), 40);
+    if (batch_options.enabled()) {
+        std::string body;  // reused batch encode buffer
+        BatchAccumulator batches(batch_options);
+        auto flush = [&](BatchBuilder& batch) {
+            std::string subject = "test.subject." + std::to_string(batch.target());
+            batch.finish({}, body);
 
-        if (s == NATS_OK) {
-            std::string reply_str(natsMsg_GetData(reply), natsMsg_GetDataLength(reply));
+            natsMsg *reply = NULL;
+            natsStatus status = TRACED("request", natsConnection_Request(&reply, conn, subject.c_str(), body.data(), (int)body.size(), 40));
             
             MessageEnvelope resp_envelope;
-            if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-                message_helpers::is_valid_ack(resp_envelope, message_id)) {
-                long long msg_duration = get_current_time_ms() - msg_start;
-                stats.record_message(true, msg_duration);
-                std::cout << " [OK]" << std::endl;
+            bool replied = status == NATS_OK &&
+                message_helpers::parse_envelope(natsMsg_GetData(reply), natsMsg_GetDataLength(reply), resp_envelope);
+            size_t acked = messaging::utils::record_batch(stats, batch, replied ? &resp_envelope : nullptr,
+                                                          get_steady_time_ns());
+            if (replied) {
+                log_debug() << " [x] Batch " << batch.batch_id() << " (" << batch.size() << " messages) to target "
+                            << batch.target() << " [OK] " << acked << "/" << batch.size() << " acknowledged";
             } else {
-                stats.record_message(false);
-                std::cout << " [FAILED] Invalid ACK" << std::endl;
+                log_info() << " [x] Batch " << batch.batch_id() << " to target " << batch.target() << " [FAILED] "
+                           << (status == NATS_OK ? "Invalid ACK" : natsStatus_GetText(status));
             }
-            natsMsg_Destroy(reply);
-        } else {
-            stats.record_message(false);
-            std::cout << " [FAILED] " << natsStatus_GetText(s) << std::endl;
+            progress.add(0, acked);
+            progress.add(1, batch.size() - acked);
+            if (reply) natsMsg_Destroy(reply);
+        };
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            std::string_view envelope = corpus.stamp(i, message_helpers::get_current_time_us());
+            batches.add(corpus.target(i), envelope, corpus.message_id(i), get_steady_time_ns(), flush);
+            batches.flush_expired(get_steady_time_ns(), flush);
+        }
+        batches.flush_all(flush);
+    } else {
+        messaging::utils::TopicTable subjects("test.subject.");
+        auto send_one = [&](natsConnection *nc, size_t i) {
+            TaskResult res;
+            res.message_id.assign(corpus.message_id(i));
+            int target = corpus.target(i);
+            const std::string& subject = subjects[target];
+            long long msg_start = get_steady_time_ns();
+            
+            // Create and send protobuf message
+            std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
+            
+            natsMsg *reply = NULL;
+            natsStatus status = TRACED("request", natsConnection_Request(&reply, nc, subject.c_str(), body.data(), body.size(), 40));
+            
+            if (status == NATS_OK) {
+                MessageEnvelope resp_envelope;
+                if (message_helpers::parse_envelope(natsMsg_GetData(reply), natsMsg_GetDataLength(reply), resp_envelope) && 
+                    message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
+                    res.success = true;
+                    res.duration_ns = get_steady_time_ns() - msg_start;
+                    res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
+                    res.bytes = body.size();
+                    log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
+                } else {
+                    res.error = "Invalid ACK";
+                    log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] Invalid ACK";
+                }
+                natsMsg_Destroy(reply);
+            } else {
+                res.error = natsStatus_GetText(status);
+                log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] "
+                           << res.error;
+            }
+            return res;
+        };
+        // The first partition reuses the main connection; the others open their own
+        PartitionedSender sender(partition_options, qos);
+        sender.run(corpus.size(),
+            [&](size_t i) { return corpus.target(i); },
+            [&](size_t partition) {
+                auto own = std::make_unique<Connection>();
+                if (partition > 0) {
+                    own->status = natsConnection_ConnectTo(&own->conn, "nats://localhost:4222");
+                }
+                return own;
+            },
+            [&](std::unique_ptr<Connection>& own, size_t i) {
+                if (own->status != NATS_OK) {
+                    TaskResult res;
+                    res.message_id.assign(corpus.message_id(i));
+                    res.error = natsStatus_GetText(own->status);
+                    return res;
+                }
+                return send_one(own->conn ? own->conn : conn, i);
+            },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
+                } else {
+                    stats.record_message(false);
+                    progress.add(1);
+                }
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
-    
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
+
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results:" << std::endl;
     std::cout << "service: NATS" << std::endl;
     std::cout << "language: C++" << std::endl;
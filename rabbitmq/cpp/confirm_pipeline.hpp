@@ -0,0 +1,251 @@
+#ifndef RABBITMQ_CONFIRM_PIPELINE_HPP
+#define RABBITMQ_CONFIRM_PIPELINE_HPP
+
+#include <rabbitmq-c/amqp.h>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+
+/**
+ * Many outstanding requests on one channel, with publisher confirms.
+ *
+ * After confirm.select the broker numbers every publish on the channel
+ * (delivery tags 1, 2, ...) and answers each with basic.ack, or basic.nack if
+ * it could not take responsibility for the message; "multiple" covers every
+ * tag up to the one given. A request completes once it is both confirmed and
+ * acknowledged by its receiver over direct reply-to (matched by
+ * correlation_id); a nack fails it at once.
+ *
+ * rabbitmq-c connections aren't thread-safe: send() and poll() must be called
+ * from the thread that owns the connection.
+ */
+class ConfirmPipeline {
+public:
+    using ResultFn = std::function<void(const messaging::utils::TaskResult& result)>;
+
+    // conn has channel 1 open and consuming amq.rabbitmq.reply-to with no_ack
+    ConfirmPipeline(amqp_connection_state_t conn, int timeout_ms = 1000)
+        : conn_(conn), timeout_ns_(timeout_ms * 1000000LL) {}
+
+    ConfirmPipeline(const ConfirmPipeline&) = delete;
+    ConfirmPipeline& operator=(const ConfirmPipeline&) = delete;
+
+    // Put channel 1 into confirm mode
+    bool start() {
+        amqp_confirm_select(conn_, 1);
+        return amqp_get_rpc_reply(conn_).reply_type == AMQP_RESPONSE_NORMAL;
+    }
+
+    /**
+     * @brief Publish body to queue; the outcome is reported by a later poll().
+     * @return false if the publish failed, in which case the request is reported as failed
+     */
+    bool send(const std::string& queue, const std::string& message_id, std::string_view body,
+              const ResultFn& on_result) {
+        amqp_basic_properties_t props;
+        props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG | AMQP_BASIC_REPLY_TO_FLAG | AMQP_BASIC_CORRELATION_ID_FLAG;
+        props.content_type = amqp_cstring_bytes("application/octet-stream");
+        props.reply_to = amqp_cstring_bytes("amq.rabbitmq.reply-to");
+        props.correlation_id = amqp_cstring_bytes(message_id.c_str());
+
+        amqp_bytes_t message_bytes;
+        message_bytes.len = body.size();
+        message_bytes.bytes = (void*)body.data();
+
+        if (broken_ || amqp_basic_publish(conn_, 1, amqp_empty_bytes, amqp_cstring_bytes(queue.c_str()),
+                                          0, 0, &props, message_bytes) != AMQP_STATUS_OK) {
+            broken_ = true;
+            report_failure(message_id, "Publish failed", on_result);
+            return false;
+        }
+
+        long long now_ns = message_helpers::get_steady_time_ns();
+        pending_[message_id] = Pending{now_ns, false, false, {}};
+        unconfirmed_[next_tag_++] = message_id;
+        deadlines_.push_back({now_ns + timeout_ns_, message_id});
+        return true;
+    }
+
+    size_t in_flight() const { return pending_.size(); }
+    unsigned long long confirmed_count() const { return confirmed_; }
+    unsigned long long nacked_count() const { return nacked_; }
+
+    /**
+     * @brief Wait up to wait_ms for replies and confirms, then fail requests past their timeout.
+     * @return Number of requests completed (acked, nacked or timed out)
+     */
+    size_t poll(int wait_ms, const ResultFn& on_result) {
+        size_t completed = 0;
+        struct timeval timeout = {wait_ms / 1000, (wait_ms % 1000) * 1000};
+        while (!broken_ && !pending_.empty()) {
+            amqp_maybe_release_buffers(conn_);
+            amqp_envelope_t envelope;
+            amqp_rpc_reply_t res = amqp_consume_message(conn_, &envelope, &timeout, 0);
+            timeout = {0, 0};  // only the first read waits
+
+            if (res.reply_type == AMQP_RESPONSE_NORMAL) {
+                completed += on_reply(envelope, on_result);
+                amqp_destroy_envelope(&envelope);
+            } else if (res.reply_type == AMQP_RESPONSE_LIBRARY_EXCEPTION &&
+                       res.library_error == AMQP_STATUS_UNEXPECTED_STATE) {
+                // Not a delivery: a confirm (or other method) is waiting to be read as a frame
+                amqp_frame_t frame;
+                if (amqp_simple_wait_frame_noblock(conn_, &frame, &timeout) != AMQP_STATUS_OK) {
+                    break;
+                }
+                if (frame.frame_type == AMQP_FRAME_METHOD) {
+                    completed += on_method(frame.payload.method, on_result);
+                }
+            } else {
+                if (!(res.reply_type == AMQP_RESPONSE_LIBRARY_EXCEPTION &&
+                      res.library_error == AMQP_STATUS_TIMEOUT)) {
+                    broken_ = true;
+                }
+                break;
+            }
+        }
+        if (broken_) {
+            // Nothing more will arrive on this connection
+            for (const auto& entry : pending_) {
+                report_failure(entry.first, "Connection lost", on_result);
+            }
+            completed += pending_.size();
+            pending_.clear();
+        }
+        return completed + expire(on_result);
+    }
+
+    // Poll until every outstanding request has completed or timed out
+    void drain_all(const ResultFn& on_result) {
+        while (!pending_.empty()) {
+            poll(10, on_result);
+        }
+    }
+
+private:
+    struct Pending {
+        long long sent_ns;
+        bool confirmed;
+        bool replied;
+        messaging::utils::AckTiming ack_timing;  // from the reply, which may beat the confirm
+    };
+
+    size_t on_reply(const amqp_envelope_t& envelope, const ResultFn& on_result) {
+        std::string corr_id((char*)envelope.message.properties.correlation_id.bytes,
+                            envelope.message.properties.correlation_id.len);
+        auto it = pending_.find(corr_id);
+        if (it == pending_.end()) {
+            return 0;  // late reply for a request that already timed out
+        }
+        if (!message_helpers::parse_envelope(envelope.message.body.bytes, envelope.message.body.len, reply_) ||
+            !message_helpers::is_valid_ack(reply_, corr_id)) {
+            pending_.erase(it);
+            report_failure(corr_id, "Invalid ACK", on_result);
+            return 1;
+        }
+        it->second.replied = true;
+        it->second.ack_timing = messaging::utils::AckTiming::of(reply_);
+        return finish_if_done(it, on_result);
+    }
+
+    size_t on_method(const amqp_method_t& method, const ResultFn& on_result) {
+        uint64_t tag = 0;
+        bool multiple = false;
+        bool ack = method.id == AMQP_BASIC_ACK_METHOD;
+        if (ack) {
+            auto *m = static_cast<amqp_basic_ack_t*>(method.decoded);
+            tag = m->delivery_tag;
+            multiple = m->multiple;
+        } else if (method.id == AMQP_BASIC_NACK_METHOD) {
+            auto *m = static_cast<amqp_basic_nack_t*>(method.decoded);
+            tag = m->delivery_tag;
+            multiple = m->multiple;
+        } else {
+            return 0;
+        }
+
+        size_t completed = 0;
+        auto first = multiple ? unconfirmed_.begin() : unconfirmed_.find(tag);
+        auto last = unconfirmed_.upper_bound(tag);
+        for (auto t = first; t != unconfirmed_.end() && t != last; ++t) {
+            auto it = pending_.find(t->second);
+            if (ack) {
+                confirmed_++;
+            } else {
+                nacked_++;
+            }
+            if (it == pending_.end()) {
+                continue;  // already timed out
+            }
+            if (ack) {
+                it->second.confirmed = true;
+                completed += finish_if_done(it, on_result);
+            } else {
+                pending_.erase(it);
+                report_failure(t->second, "Nacked by broker", on_result);
+                completed++;
+            }
+        }
+        if (first != unconfirmed_.end()) {
+            unconfirmed_.erase(first, last);
+        }
+        return completed;
+    }
+
+    size_t finish_if_done(std::unordered_map<std::string, Pending>::iterator it, const ResultFn& on_result) {
+        if (!it->second.confirmed || !it->second.replied) {
+            return 0;
+        }
+        messaging::utils::TaskResult res;
+        res.message_id = it->first;
+        res.duration_ns = message_helpers::get_steady_time_ns() - it->second.sent_ns;
+        res.success = true;
+        res.ack_timing = it->second.ack_timing;
+        pending_.erase(it);
+        on_result(res);
+        return 1;
+    }
+
+    size_t expire(const ResultFn& on_result) {
+        size_t completed = 0;
+        long long now_ns = message_helpers::get_steady_time_ns();
+        while (!deadlines_.empty() && deadlines_.front().first <= now_ns) {
+            const std::string& message_id = deadlines_.front().second;
+            auto it = pending_.find(message_id);
+            // Skip entries whose request completed, or was re-sent with a later deadline
+            if (it != pending_.end() && it->second.sent_ns + timeout_ns_ <= now_ns) {
+                const char* error = it->second.confirmed ? "Timeout" : "Timeout (unconfirmed)";
+                pending_.erase(it);
+                report_failure(message_id, error, on_result);
+                completed++;
+            }
+            deadlines_.pop_front();
+        }
+        return completed;
+    }
+
+    static void report_failure(const std::string& message_id, const char* error, const ResultFn& on_result) {
+        messaging::utils::TaskResult res;
+        res.message_id = message_id;
+        res.error = error;
+        on_result(res);
+    }
+
+    amqp_connection_state_t conn_;
+    long long timeout_ns_;
+    bool broken_ = false;
+    uint64_t next_tag_ = 1;
+    unsigned long long confirmed_ = 0;
+    unsigned long long nacked_ = 0;
+    std::unordered_map<std::string, Pending> pending_;
+    std::map<uint64_t, std::string> unconfirmed_;   // delivery tag -> message_id
+    std::deque<std::pair<long long, std::string>> deadlines_;
+    MessageEnvelope reply_;
+};
+
+#endif // RABBITMQ_CONFIRM_PIPELINE_HPP
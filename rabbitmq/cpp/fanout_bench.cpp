@@ -0,0 +1,70 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/fanout_bench.hpp"
+
+using json = nlohmann::json;
+using messaging::utils::FanoutBench;
+using messaging::utils::FanoutOptions;
+using messaging::utils::RabbitMQPublisher;
+using messaging::utils::RabbitMQSubscriber;
+
+/**
+ * One-to-many run over a RabbitMQ fanout exchange named after the topic:
+ * one publishing connection and --subscribers K connections, each consuming
+ * an exclusive queue bound to the exchange, all in this process. --hwm caps
+ * every queue with x-max-length, past which the broker drops its oldest.
+ */
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    FanoutOptions options = FanoutOptions::from_args(argc, argv);
+    RabbitMQPublisher publisher(options.topic);
+    auto corpus = test_data_loader::preEncodeTestFile("", publisher.routing());
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+
+    MessageStats stats;
+    stats.set_metadata({
+        {"service", "RabbitMQ"},
+        {"language", "C++"},
+        {"async", false},
+        {"mode", "fanout"},
+        {"subscribers", options.subscribers}
+    });
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+
+    FanoutBench bench(options);
+    std::cout << " [x] Publishing " << corpus.size() << " messages to " << options.subscribers
+              << " subscribers on '" << options.topic << "'..." << std::endl;
+    bool ok = bench.run(publisher, [&](int) {
+        return std::make_unique<RabbitMQSubscriber>(options.topic, "localhost", 5672, options.hwm);
+    }, corpus, stats);
+    if (!ok) {
+        return 1;
+    }
+    json fanout = bench.report();
+    stats.add_metadata("fanout", fanout);
+    json report = stats.get_stats();
+
+    std::cout << "\nTest Results (FANOUT):" << std::endl;
+    std::cout << "service: RabbitMQ" << std::endl;
+    std::cout << "subscribers: " << fanout["subscribers"] << " (joined " << fanout["joined"] << ")" << std::endl;
+    std::cout << "published: " << fanout["published"] << std::endl;
+    std::cout << "deliveries: " << fanout["deliveries"] << " of " << fanout["expected_deliveries"] << std::endl;
+    std::cout << "dropped: " << fanout["dropped"]["total"] << std::endl;
+    std::cout << "delivery_rate: " << fanout["delivery_rate"] << " msgs/s" << std::endl;
+    std::cout << "duration_ms: " << stats.get_duration_ms() << std::endl;
+
+    std::ofstream rf("logs/report.txt", std::ios::app);
+    if (rf.good()) {
+        rf << report.dump() << std::endl;
+        rf.close();
+    }
+
+    return 0;
+}
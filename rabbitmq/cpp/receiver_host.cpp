@@ -0,0 +1,46 @@
+#include <rabbitmq-c/amqp.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <signal.h>
+#include "../../utils/cpp/receiver_host.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/payload_codec.hpp"
+
+/**
+ * Runs receivers --ids LIST in one process on --threads N threads, in place of
+ * one receiver_test per id. Each receiver consumes test_queue_<id> on its own
+ * connection, since rabbitmq-c connections must not be shared across threads.
+ */
+
+using messaging::utils::ReceiverHost;
+
+std::atomic<bool> running(true);
+
+void signal_handler(int sig) {
+    running = false;
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    std::vector<int> ids;
+    int threads = 0;
+    if (!messaging::utils::parse_host_args(argc, argv, ids, threads)) {
+        return 1;
+    }
+
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::configure_compression(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    ReceiverHost host(ids, threads, [&](int id) -> std::unique_ptr<messaging::utils::UnifiedReceiver> {
+        return std::make_unique<messaging::utils::RabbitMQReceiver>(id);
+    });
+    host.set_perf_counters(&perf);
+    host.set_dedup_options(messaging::utils::DedupOptions::from_args(argc, argv));
+    return host.run(running);
+}
@@ -4,7 +4,12 @@
 #include <string>
 #include <signal.h>
 #include <atomic>
+#include <algorithm>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/payload_codec.hpp"
 
 using messaging::MessageEnvelope;
 using message_helpers::get_current_time_ms;
@@ -16,15 +21,28 @@ void signal_handler(int sig) {
 }
 
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
+    int prefetch = 0;     // 0: auto-ack deliveries (no_ack), no prefetch limit
+    int ack_every = 0;    // with --prefetch, basic.ack (multiple) every N deliveries
     
     for (int i = 1; i < argc; i++) {
-        if (std::string(argv[i]) == "--id" && i + 1 < argc) {
-            receiver_id = std::stoi(argv[i + 1]);
-            break;
+        std::string arg = argv[i];
+        if (arg == "--id" && i + 1 < argc) {
+            receiver_id = std::stoi(argv[++i]);
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            prefetch = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--ack-every" && i + 1 < argc) {
+            ack_every = std::max(1, std::stoi(argv[++i]));
         }
     }
+    // Acking less often than the prefetch window would stall the consumer
+    bool manual_ack = prefetch > 0;
+    ack_every = manual_ack ? std::min(std::max(ack_every, 1), prefetch) : 0;
     
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::configure_compression(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
@@ -36,29 +54,41 @@ int main(int argc, char* argv[]) {
 
     std::string queue_name = "test_queue_" + std::to_string(receiver_id);
     amqp_queue_declare(conn, 1, amqp_cstring_bytes(queue_name.c_str()), 0, 0, 0, 0, amqp_empty_table);
-    amqp_basic_consume(conn, 1, amqp_cstring_bytes(queue_name.c_str()), amqp_empty_bytes, 0, 1, 0, amqp_empty_table);
+    if (manual_ack) {
+        amqp_basic_qos(conn, 1, 0, static_cast<uint16_t>(std::min(prefetch, 65535)), 0);
+    }
+    amqp_basic_consume(conn, 1, amqp_cstring_bytes(queue_name.c_str()), amqp_empty_bytes, 0,
+                       manual_ack ? 0 : 1, 0, amqp_empty_table);
 
     std::cout << " [*] Receiver " << receiver_id << " waiting for messages on " << queue_name << std::endl;
+    messaging::utils::LogSummary& progress = messaging::utils::AsyncLogger::global().summary(
+        " [*] Receiver " + std::to_string(receiver_id), {"received"});
+    messaging::utils::AckEncoder acks(std::to_string(receiver_id));
 
+    uint64_t last_tag = 0;   // newest delivery not yet acked
+    int unacked = 0;
     while (running) {
-        struct timeval timeout = {1, 0};
+        // Poll briefly while deliveries are unacked, so the tail of a burst is acked promptly
+        struct timeval timeout = unacked > 0 ? timeval{0, 10000} : timeval{1, 0};
         amqp_envelope_t envelope;
         amqp_rpc_reply_t res = amqp_consume_message(conn, &envelope, &timeout, 0);
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
 
+        if (res.reply_type != AMQP_RESPONSE_NORMAL && unacked > 0) {
+            amqp_basic_ack(conn, 1, last_tag, 1);
+            unacked = 0;
+        }
         if (res.reply_type == AMQP_RESPONSE_NORMAL) {
             std::string message_str((char*)envelope.message.body.bytes, envelope.message.body.len);
             
             MessageEnvelope msg_envelope;
             if (message_helpers::parse_envelope(message_str, msg_envelope)) {
                 std::string message_id = msg_envelope.message_id();
-                std::cout << " [x] Received message " << message_id << std::endl;
+                messaging::utils::log_debug() << " [x] Received message " << message_id;
+                progress.add(0);
 
-                // Create ACK
-                MessageEnvelope response = message_helpers::create_ack_from_envelope(
-                    msg_envelope,
-                    std::to_string(receiver_id)
-                );
-                std::string response_str = message_helpers::serialize_envelope(response);
+                // Create ACK (a BatchResponse for batches)
+                std::string_view response = acks.encode_response(msg_envelope, timing);
 
                 // Send ACK with proper binary handling
                 amqp_basic_properties_t props;
@@ -68,16 +98,25 @@ int main(int argc, char* argv[]) {
 
                 // Use amqp_bytes_t to properly handle binary data (not null-terminated)
                 amqp_bytes_t body;
-                body.len = response_str.size();
-                body.bytes = (void*)response_str.data();
+                body.len = response.size();
+                body.bytes = (void*)response.data();
 
-                amqp_basic_publish(conn, 1, amqp_empty_bytes, envelope.message.properties.reply_to,
-                                  0, 0, &props, body);
+                TRACED("reply", amqp_basic_publish(conn, 1, amqp_empty_bytes, envelope.message.properties.reply_to,
+                                                   0, 0, &props, body));
+            }
+            if (manual_ack) {
+                // Ack after replying; "multiple" covers every delivery up to this one
+                last_tag = envelope.delivery_tag;
+                if (++unacked >= ack_every) {
+                    amqp_basic_ack(conn, 1, last_tag, 1);
+                    unacked = 0;
+                }
             }
             amqp_destroy_envelope(&envelope);
         }
     }
 
+    messaging::utils::flush_log();
     std::cout << " [x] Receiver " << receiver_id << " shutting down" << std::endl;
     amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
     amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
@@ -3,125 +3,327 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <future>
 #include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/connection_pool.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "confirm_pipeline.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ConnectionPool;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
+using message_helpers::elapsed_ms_since;
 
-struct TaskResult {
-    bool success;
-    std::string message_id;
-    long long duration;
-    std::string error;
-};
+// Pooled connection with channel 1 open and consuming the direct reply-to queue
+struct RabbitConnection {
+    amqp_connection_state_t conn = nullptr;
 
-TaskResult send_message_task(const json& item) {
-    TaskResult res;
-    res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
+    ~RabbitConnection() {
+        if (conn) {
+            amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
+            amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+            amqp_destroy_connection(conn);
+        }
+    }
+};
 
-    amqp_connection_state_t conn = amqp_new_connection();
-    amqp_socket_t *socket = amqp_tcp_socket_new(conn);
+std::unique_ptr<RabbitConnection> connect_rabbitmq() {
+    auto rc = std::make_unique<RabbitConnection>();
+    rc->conn = amqp_new_connection();
+    amqp_socket_t *socket = amqp_tcp_socket_new(rc->conn);
     
     if (amqp_socket_open(socket, "localhost", 5672) != 0) {
-        res.error = "Connection failed";
-        amqp_destroy_connection(conn);
-        return res;
+        amqp_destroy_connection(rc->conn);
+        rc->conn = nullptr;
+        return nullptr;
     }
 
-    amqp_login(conn, "/", 0, 131072, 0, AMQP_SASL_METHOD_PLAIN, "guest", "guest");
-    amqp_channel_open(conn, 1);
+    amqp_login(rc->conn, "/", 0, 131072, 0, AMQP_SASL_METHOD_PLAIN, "guest", "guest");
+    amqp_channel_open(rc->conn, 1);
     
     // Subscribe to direct reply queue
-    amqp_basic_consume(conn, 1, amqp_cstring_bytes("amq.rabbitmq.reply-to"), amqp_empty_bytes, 0, 1, 0, amqp_empty_table);
+    amqp_basic_consume(rc->conn, 1, amqp_cstring_bytes("amq.rabbitmq.reply-to"), amqp_empty_bytes, 0, 1, 0, amqp_empty_table);
+    return rc;
+}
 
-    int target = item.value("target", 0);
-    std::string queue_name = "test_queue_" + std::to_string(target);
+/**
+ * Publish body to queue_name with correlation_id and wait up to timeout_ms for
+ * its direct reply-to response, skipping late replies to earlier requests on
+ * this connection; the reply is left in resp_envelope. On failure error says
+ * why, and broken is set when the connection should not be reused.
+ */
+bool request_reply(amqp_connection_state_t conn, const std::string& queue_name, const std::string& correlation_id,
+                   std::string_view body, long long timeout_ms, MessageEnvelope& resp_envelope,
+                   std::string& error, bool& broken) {
+    long long start_ns = get_steady_time_ns();
     std::string reply_queue = "amq.rabbitmq.reply-to";
 
-    long long msg_start = get_current_time_ms();
-
-    // Create and send message
-    MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-    std::string body = message_helpers::serialize_envelope(envelope);
-
     amqp_basic_properties_t props;
     props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG | AMQP_BASIC_REPLY_TO_FLAG | AMQP_BASIC_CORRELATION_ID_FLAG;
     props.content_type = amqp_cstring_bytes("application/octet-stream");
     props.reply_to = amqp_cstring_bytes(reply_queue.c_str());
-    props.correlation_id = amqp_cstring_bytes(res.message_id.c_str());
-
-    amqp_basic_publish(conn, 1, amqp_empty_bytes, amqp_cstring_bytes(queue_name.c_str()),
-                      0, 0, &props, amqp_cstring_bytes(body.c_str()));
-
-    // Wait for reply
-    struct timeval timeout = {0, 100000};  // 100ms
-    amqp_envelope_t reply_envelope;
-    amqp_rpc_reply_t rpc_res = amqp_consume_message(conn, &reply_envelope, &timeout, 0);
-
-    if (rpc_res.reply_type == AMQP_RESPONSE_NORMAL) {
-        std::string reply_str((char*)reply_envelope.message.body.bytes, reply_envelope.message.body.len);
-        
-        MessageEnvelope resp_envelope;
-        if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-            message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
-            res.duration = get_current_time_ms() - msg_start;
-            res.success = true;
-        } else {
-            res.error = "Invalid ACK";
+    props.correlation_id = amqp_cstring_bytes(correlation_id.c_str());
+
+    amqp_bytes_t message_bytes;
+    message_bytes.len = body.size();
+    message_bytes.bytes = (void*)body.data();
+
+    if (TRACED("send", amqp_basic_publish(conn, 1, amqp_empty_bytes, amqp_cstring_bytes(queue_name.c_str()),
+                                          0, 0, &props, message_bytes)) != AMQP_STATUS_OK) {
+        error = "Publish failed";
+        broken = true;
+        return false;
+    }
+
+    while (true) {
+        long long remaining_ms = timeout_ms - static_cast<long long>(elapsed_ms_since(start_ns));
+        if (remaining_ms <= 0) {
+            error = "Timeout";
+            return false;
         }
+        struct timeval timeout = {(time_t)(remaining_ms / 1000), (suseconds_t)(remaining_ms % 1000 * 1000)};
+        amqp_envelope_t reply_envelope;
+        amqp_rpc_reply_t rpc_res = amqp_consume_message(conn, &reply_envelope, &timeout, 0);
+
+        if (rpc_res.reply_type != AMQP_RESPONSE_NORMAL) {
+            broken = !(rpc_res.reply_type == AMQP_RESPONSE_LIBRARY_EXCEPTION &&
+                       rpc_res.library_error == AMQP_STATUS_TIMEOUT);
+            error = "Timeout";
+            return false;
+        }
+
+        std::string corr_id((char*)reply_envelope.message.properties.correlation_id.bytes,
+                            reply_envelope.message.properties.correlation_id.len);
+        bool matched = corr_id == correlation_id;
+        bool parsed = matched && message_helpers::parse_envelope(reply_envelope.message.body.bytes,
+                                                                 reply_envelope.message.body.len, resp_envelope);
         amqp_destroy_envelope(&reply_envelope);
-    } else {
-        res.error = "Timeout";
+        if (matched) {
+            if (!parsed) {
+                error = "Invalid ACK";
+            }
+            return parsed;
+        }
     }
+}
 
-    amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
-    amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
-    amqp_destroy_connection(conn);
+// First attempts stamp the corpus in place, others encode a copy (see Attempt)
+TaskResult send_message_task(ConnectionPool<RabbitConnection>& pool, test_data_loader::EncodedCorpus& corpus, size_t i,
+                             const Attempt& attempt) {
+    TaskResult res;
+    res.success = false;
+    res.message_id = std::string(corpus.message_id(i));
+    res.duration_ns = 0;
+
+    auto rc = pool.checkout(0);
+    if (!rc) {
+        res.error = "Connection failed";
+        return res;
+    }
+    amqp_connection_state_t conn = rc->conn;
+
+    int target = corpus.target(i);
+    static const messaging::utils::TopicTable queue_names("test_queue_");
+    const std::string& queue_name = queue_names[target];
+
+    long long msg_start = get_steady_time_ns();
+
+    // Stamp the pre-encoded envelope and send it
+    thread_local std::string copy;
+    int64_t now_us = message_helpers::get_current_time_us();
+    std::string_view body = attempt.number == 0 ? corpus.stamp(i, now_us) : corpus.encode(i, now_us, {}, copy);
+    res.bytes = body.size();
+
+    MessageEnvelope resp_envelope;
+    bool broken = false;
+    if (!request_reply(conn, queue_name, res.message_id, body, attempt.timeout_ms(100), resp_envelope, res.error, broken)) {
+        if (broken) {
+            rc.discard();
+        }
+    } else if (message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
+        res.duration_ns = get_steady_time_ns() - msg_start;
+        res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
+        res.success = true;
+    } else {
+        res.error = "Invalid ACK";
+    }
 
     return res;
 }
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+/**
+ * Publish every message from this thread on one confirm-mode channel, keeping
+ * up to max_in_flight unconfirmed or unacknowledged; returns the peak in flight.
+ */
+int run_confirm_pipeline(ConfirmPipeline& pipeline, test_data_loader::EncodedCorpus& corpus, int max_in_flight,
+                         const AsyncSendEngine::ResultFn& on_result, MessageStats& stats) {
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t peak = 0;
+    std::string queue_name;
+    std::string message_id;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        // Wait for room in the window, picking up whatever confirms and ACKs have arrived meanwhile
+        while (pipeline.in_flight() >= window) {
+            pipeline.poll(10, on_result);
+        }
+        queue_name.assign("test_queue_").append(std::to_string(corpus.target(i)));
+        message_id.assign(corpus.message_id(i));
+        TRACED("send", pipeline.send(queue_name, message_id, corpus.stamp(i, message_helpers::get_current_time_us()), on_result));
+        stats.record_dispatch();
+        peak = std::max(peak, pipeline.in_flight());
+        pipeline.poll(0, on_result);
+    }
+    pipeline.drain_all(on_result);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    corpus.attach_compression(messaging::utils::CompressionOptions::from_args(argc, argv));
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    corpus.attach_qos(options.qos);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    bool use_confirms = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--confirms") == 0) {
+            use_confirms = true;
+        }
+    }
+    if (use_confirms) {
+        options.warn_ignored_by("--confirms");
+    }
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "RabbitMQ"},
         {"language", "C++"},
-        {"async", true}
+        {"async", true},
+        {"transport", use_confirms ? "confirms" : "direct_reply"},
+        {"workers", use_confirms ? 1 : options.workers},
+        {"max_in_flight", options.max_in_flight}
     });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << std::endl;
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
-    std::vector<std::future<TaskResult>> futures;
-    for (auto& item : test_data) {
-        futures.push_back(std::async(std::launch::async, send_message_task, item));
+    // --wait-ready: PING every receiver's queue before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "rabbitmq-async-sender");
+    if (ready.options().enabled()) {
+        auto rc = connect_rabbitmq();
+        MessageEnvelope pong;
+        ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+            if (!rc) {
+                rc = connect_rabbitmq();   // RabbitMQ itself may still be starting
+            }
+            std::string error;
+            bool broken = false;
+            bool replied = rc && request_reply(rc->conn, "test_queue_" + std::to_string(target), ping_id, ping, 100,
+                                               pong, error, broken);
+            if (broken) {
+                rc.reset();
+            }
+            return replied ? &pong : nullptr;
+        });
     }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("RabbitMQ");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
 
-    for (auto& fut : futures) {
-        TaskResult res = fut.get();
+    std::cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
+
+    auto on_result = [&](const TaskResult& res) {
         if (res.success) {
-            stats.record_message(true, res.duration);
-            std::cout << " [OK] Message " << res.message_id << " acknowledged" << std::endl;
+            stats.record_message_ns(true, res.duration_ns);
+            stats.record_breakdown(res.ack_timing, res.duration_ns);
+            stats.record_bytes(res.bytes);
+            progress.add(0);
+            log_debug() << " [OK] Message " << res.message_id << " acknowledged";
         } else {
             stats.record_message(false);
-            std::cout << " [FAILED] Message " << res.message_id << ": " << res.error << std::endl;
+            progress.add(1);
+            log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+        }
+    };
+
+    if (use_confirms) {
+        // One connection and channel; the window is the only concurrency
+        auto rc = connect_rabbitmq();
+        ConfirmPipeline pipeline(rc ? rc->conn : nullptr, 1000);  // 1s timeout
+        if (!rc || !pipeline.start()) {
+            std::cerr << " [!] Could not open a confirm-mode channel" << std::endl;
+            return 1;
         }
+        int peak = run_confirm_pipeline(pipeline, corpus, options.max_in_flight, on_result, stats);
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", 1);
+        stats.add_metadata("confirmed", pipeline.confirmed_count());
+        stats.add_metadata("nacked", pipeline.nacked_count());
+    } else {
+        ConnectionPool<RabbitConnection> pool([](int) { return connect_rabbitmq(); });
+
+        AsyncSendEngine engine(options);
+        engine.run(corpus.size(),
+            [&](size_t i, const Attempt& attempt) {
+                if (attempt.number == 0) {
+                    stats.record_dispatch();
+                }
+                return send_message_task(pool, corpus, i, attempt);
+            },
+            on_result);
+        stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+        if (options.open_loop()) {
+            stats.add_metadata("open_loop", engine.open_loop_report());
+        }
+        if (options.policy.enabled()) {
+            stats.add_metadata("request_policy", engine.policy_report());
+        }
+        if (options.qos.enabled()) {
+            stats.add_metadata("qos", options.qos.report(engine.retransmits()));
+        }
+        stats.add_metadata("connections_created", pool.created_count());
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    if (corpus.compressor()) {
+        stats.add_metadata("compression", corpus.compressor()->report());
+    }
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results (ASYNC):" << std::endl;
     std::cout << "total_sent: " << stats.sent_count << std::endl;
     std::cout << "total_received: " << stats.received_count << std::endl;
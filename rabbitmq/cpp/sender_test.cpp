@@ -3,28 +3,38 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <memory>
 #include <chrono>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/batch_builder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
+using message_helpers::elapsed_ms_since;
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
-
-    MessageStats stats;
-    stats.set_metadata({
-        {"service", "RabbitMQ"},
-        {"language", "C++"},
-        {"async", false}
-    });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting transfer of " << test_data.size() << " messages..." << std::endl;
+using messaging::utils::BatchOptions;
+using messaging::utils::BatchAccumulator;
+using messaging::utils::BatchBuilder;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::TaskResult;
 
+// Connect, open channel 1 and consume its direct reply-to queue
+amqp_connection_state_t open_connection() {
     amqp_connection_state_t conn = amqp_new_connection();
     amqp_socket_t *socket = amqp_tcp_socket_new(conn);
     amqp_socket_open(socket, "localhost", 5672);
@@ -33,60 +43,218 @@ int main() {
     
     // Subscribe to direct reply queue
     amqp_basic_consume(conn, 1, amqp_cstring_bytes("amq.rabbitmq.reply-to"), amqp_empty_bytes, 0, 1, 0, amqp_empty_table);
+    return conn;
+}
 
-    for (auto& item : test_data) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
-        std::cout << " [x] Sending message " << message_id << " to target " << target << "..." << std::flush;
+void close_connection(amqp_connection_state_t conn) {
+    amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
+    amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+    amqp_destroy_connection(conn);
+}
+
+// A partition's own connection; amqp connections must not be shared between threads
+struct Connection {
+    ~Connection() {
+        if (conn) close_connection(conn);
+    }
 
-        std::string queue_name = "test_queue_" + std::to_string(target);
-        std::string reply_queue = "amq.rabbitmq.reply-to";
+    amqp_connection_state_t conn = nullptr;
+    MessageEnvelope resp_envelope;
+};
 
-        long long msg_start = get_current_time_ms();
+// Publish body to queue_name and wait up to 40ms for the direct reply-to response,
+// skipping late replies to earlier requests (a timed-out message, or PINGs queued
+// before the receiver started)
+bool request_reply(amqp_connection_state_t conn, const std::string& queue_name, const std::string& correlation_id,
+                   std::string_view body, MessageEnvelope& resp_envelope) {
+    std::string reply_queue = "amq.rabbitmq.reply-to";
 
-        // Create and send protobuf message
-        MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-        std::string body = message_helpers::serialize_envelope(envelope);
+    amqp_bytes_t body_bytes;
+    body_bytes.len = body.size();
+    body_bytes.bytes = const_cast<char*>(body.data());
 
-        amqp_basic_properties_t props;
-        props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG | AMQP_BASIC_REPLY_TO_FLAG | AMQP_BASIC_CORRELATION_ID_FLAG;
-        props.content_type = amqp_cstring_bytes("application/octet-stream");
-        props.reply_to = amqp_cstring_bytes(reply_queue.c_str());
-        props.correlation_id = amqp_cstring_bytes(message_id.c_str());
+    amqp_basic_properties_t props;
+    props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG | AMQP_BASIC_REPLY_TO_FLAG | AMQP_BASIC_CORRELATION_ID_FLAG;
+    props.content_type = amqp_cstring_bytes("application/octet-stream");
+    props.reply_to = amqp_cstring_bytes(reply_queue.c_str());
+    props.correlation_id = amqp_cstring_bytes(correlation_id.c_str());
 
-        amqp_basic_publish(conn, 1, amqp_empty_bytes, amqp_cstring_bytes(queue_name.c_str()),
-                          0, 0, &props, amqp_cstring_bytes(body.c_str()));
+    long long start_ns = get_steady_time_ns();
+    TRACED("send", amqp_basic_publish(conn, 1, amqp_empty_bytes, amqp_cstring_bytes(queue_name.c_str()),
+                                      0, 0, &props, body_bytes));
 
-        // Wait for reply (40ms timeout)
-        struct timeval timeout = {0, 40000};  // 40ms
+    // Wait for reply (40ms timeout)
+    TRACE_SCOPE("wait");
+    while (true) {
+        long long remaining_ms = 40 - static_cast<long long>(elapsed_ms_since(start_ns));
+        if (remaining_ms <= 0) {
+            return false;
+        }
+        struct timeval timeout = {0, (suseconds_t)(remaining_ms * 1000)};
         amqp_envelope_t reply_envelope;
         amqp_rpc_reply_t res = amqp_consume_message(conn, &reply_envelope, &timeout, 0);
+        if (res.reply_type != AMQP_RESPONSE_NORMAL) {
+            return false;
+        }
 
-        if (res.reply_type == AMQP_RESPONSE_NORMAL) {
-            std::string reply_str((char*)reply_envelope.message.body.bytes, reply_envelope.message.body.len);
+        const amqp_bytes_t& reply_id = reply_envelope.message.properties.correlation_id;
+        bool matched = !(reply_envelope.message.properties._flags & AMQP_BASIC_CORRELATION_ID_FLAG) ||
+                       std::string_view((const char*)reply_id.bytes, reply_id.len) == correlation_id;
+        bool parsed = matched && message_helpers::parse_envelope(reply_envelope.message.body.bytes,
+                                                                 reply_envelope.message.body.len, resp_envelope);
+        amqp_destroy_envelope(&reply_envelope);
+        if (matched) {
+            return parsed;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    corpus.attach_qos(qos);
+    corpus.attach_compression(messaging::utils::CompressionOptions::from_args(argc, argv));
+    BatchOptions batch_options = BatchOptions::from_args(argc, argv);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    if (batch_options.enabled()) {
+        partition_options.warn_ignored_by("--batch");
+        qos.warn_ignored_by("--batch");
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    MessageStats stats;
+    stats.set_metadata({
+        {"service", "RabbitMQ"},
+        {"language", "C++"},
+        {"async", false},
+        {"batch_size", batch_options.max_messages},
+        {"batch_linger_ms", batch_options.linger_ms},
+        {"partitions", batch_options.enabled() ? 1 : partition_options.partitions}
+    });
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
+
+    amqp_connection_state_t conn = open_connection();
+
+    // --wait-ready: PING every receiver's queue before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "rabbitmq-sender");
+    MessageEnvelope pong;
+    ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+        return request_reply(conn, "test_queue_" + std::to_string(target), ping_id, ping, pong) ? &pong : nullptr;
+    });
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("RabbitMQ");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
+
+    if (batch_options.enabled()) {
+        MessageEnvelope resp_envelope;
+        std::string body;  // reused batch encode buffer
+        BatchAccumulator batches(batch_options);
+        auto flush = [&](BatchBuilder& batch) {
+            std::string queue_name = "test_queue_" + std::to_string(batch.target());
+            std::string correlation_id = "batch_" + std::to_string(batch.batch_id());
             
-            MessageEnvelope resp_envelope;
-            if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-                message_helpers::is_valid_ack(resp_envelope, message_id)) {
-                long long msg_duration = get_current_time_ms() - msg_start;
-                stats.record_message(true, msg_duration);
-                std::cout << " [OK]" << std::endl;
+            bool replied = request_reply(conn, queue_name, correlation_id, batch.finish({}, body), resp_envelope);
+            size_t acked = messaging::utils::record_batch(stats, batch, replied ? &resp_envelope : nullptr,
+                                                          get_steady_time_ns());
+            if (replied) {
+                log_debug() << " [x] Batch " << batch.batch_id() << " (" << batch.size() << " messages) to target "
+                            << batch.target() << " [OK] " << acked << "/" << batch.size() << " acknowledged";
+            } else {
+                log_info() << " [x] Batch " << batch.batch_id() << " to target " << batch.target() << " [FAILED] Timeout";
+            }
+            progress.add(0, acked);
+            progress.add(1, batch.size() - acked);
+        };
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            std::string_view envelope = corpus.stamp(i, message_helpers::get_current_time_us());
+            batches.add(corpus.target(i), envelope, corpus.message_id(i), get_steady_time_ns(), flush);
+            batches.flush_expired(get_steady_time_ns(), flush);
+        }
+        batches.flush_all(flush);
+    } else {
+        messaging::utils::TopicTable queue_names("test_queue_");
+        auto send_one = [&](amqp_connection_state_t c, MessageEnvelope& resp_envelope, size_t i) {
+            TaskResult res;
+            res.message_id.assign(corpus.message_id(i));
+            int target = corpus.target(i);
+            const std::string& queue_name = queue_names[target];
+            long long msg_start = get_steady_time_ns();
+
+            // Stamp the pre-encoded envelope and send it
+            std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
+            if (!request_reply(c, queue_name, res.message_id, body, resp_envelope)) {
+                res.error = "Timeout";
+                log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] Timeout";
+            } else if (message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
+                res.success = true;
+                res.duration_ns = get_steady_time_ns() - msg_start;
+                res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
+                res.bytes = body.size();
+                log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
             } else {
-                stats.record_message(false);
-                std::cout << " [FAILED] Invalid ACK" << std::endl;
+                res.error = "Invalid ACK";
+                log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] Invalid ACK";
             }
-            amqp_destroy_envelope(&reply_envelope);
-        } else {
-            stats.record_message(false);
-            std::cout << " [FAILED] Timeout" << std::endl;
+            return res;
+        };
+        // The first partition reuses the main connection; the others open their own
+        PartitionedSender sender(partition_options, qos);
+        sender.run(corpus.size(),
+            [&](size_t i) { return corpus.target(i); },
+            [&](size_t partition) {
+                auto own = std::make_unique<Connection>();
+                if (partition > 0) {
+                    own->conn = open_connection();
+                }
+                return own;
+            },
+            [&](std::unique_ptr<Connection>& own, size_t i) {
+                return send_one(own->conn ? own->conn : conn, own->resp_envelope, i);
+            },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
+                } else {
+                    stats.record_message(false);
+                    progress.add(1);
+                }
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    if (corpus.compressor()) {
+        stats.add_metadata("compression", corpus.compressor()->report());
+    }
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results:" << std::endl;
     std::cout << "service: RabbitMQ" << std::endl;
     std::cout << "language: C++" << std::endl;
@@ -100,8 +268,6 @@ int main() {
         rf.close();
     }
 
-    amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
-    amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
-    amqp_destroy_connection(conn);
+    close_connection(conn);
     return 0;
 }
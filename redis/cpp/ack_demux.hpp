@@ -0,0 +1,143 @@
+#ifndef REDIS_ACK_DEMUX_HPP
+#define REDIS_ACK_DEMUX_HPP
+
+#include <hiredis/hiredis.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/pending_replies.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+
+/**
+ * One long-lived reply subscription shared by every in-flight message.
+ *
+ * Instead of SUBSCRIBE/UNSUBSCRIBE per message, the sender subscribes once to
+ * its own reply channel (sent to receivers as reply_to metadata) before
+ * publishing anything, and a single subscriber thread matches incoming ACKs to
+ * outstanding messages by Acknowledgment.original_message_id; a coalesced
+ * reply (see AckCoalescer) completes every message it lists. PendingReplies
+ * times messages out and hands completions back on the caller's thread from
+ * poll().
+ */
+class AckDemux {
+public:
+    using ResultFn = messaging::utils::PendingReplies::ResultFn;
+
+    explicit AckDemux(int timeout_ms = 1000)
+        : channel_("reply_sender_" + std::to_string(::getpid()) + "_" +
+                   std::to_string(message_helpers::get_steady_time_ns())),
+          replies_(timeout_ms) {}
+
+    ~AckDemux() {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (sub_) {
+            redisFree(sub_);
+        }
+    }
+
+    AckDemux(const AckDemux&) = delete;
+    AckDemux& operator=(const AckDemux&) = delete;
+
+    // Reply channel to send as reply_to metadata
+    const std::string& channel() const { return channel_; }
+
+    /**
+     * @brief Connect, subscribe and wait for Redis to confirm, then start the subscriber thread.
+     * @return false if Redis is unreachable or the subscription failed
+     */
+    bool start() {
+        sub_ = redisConnect("127.0.0.1", 6379);
+        if (!sub_ || sub_->err) {
+            return false;
+        }
+        redisReply *sub = (redisReply*)redisCommand(sub_, "SUBSCRIBE %s", channel_.c_str());
+        if (!sub) {
+            return false;
+        }
+        freeReplyObject(sub);
+
+        // Short read timeout so the thread notices shutdown
+        redisSetTimeout(sub_, {0, 100000});
+        running_ = true;
+        thread_ = std::thread([this]() {
+            messaging::utils::CpuAffinity::global().pin_this_thread();
+            run();
+        });
+        return true;
+    }
+
+    // Register a message before it is published, so its ACK can't race ahead of it
+    void expect(const std::string& message_id) { replies_.expect(message_id); }
+
+    // Complete an expected message as failed (e.g. the publish itself failed)
+    void fail(const std::string& message_id, const std::string& error) { replies_.fail(message_id, error); }
+
+    // Messages expected but not yet reported by poll()
+    size_t in_flight() const { return replies_.in_flight(); }
+
+    // Wait up to wait_ms for completions and report them on this thread; returns how many
+    size_t poll(int wait_ms, const ResultFn& on_result) { return replies_.poll(wait_ms, on_result); }
+
+    // Poll until nothing is in flight
+    void drain_all(const ResultFn& on_result) { replies_.drain_all(on_result); }
+
+private:
+    void run() {
+        MessageEnvelope envelope;
+        while (running_) {
+            redisReply *reply = nullptr;
+            int status = redisGetReply(sub_, (void**)&reply);
+
+            if (status == REDIS_OK && reply) {
+                if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3 &&
+                    reply->element[0]->type == REDIS_REPLY_STRING &&
+                    strcmp(reply->element[0]->str, "message") == 0 &&
+                    message_helpers::parse_envelope(reply->element[2]->str, reply->element[2]->len, envelope) &&
+                    (envelope.has_ack() || messaging::utils::is_coalesced_ack(envelope))) {
+                    complete(envelope);
+                }
+                freeReplyObject(reply);
+            } else if (status == REDIS_ERR) {
+                if (sub_->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
+                    // Read timeout; clear it so the context stays usable
+                    sub_->err = 0;
+                    memset(sub_->errstr, 0, sizeof(sub_->errstr));
+                } else {
+                    std::cerr << " [!] Reply subscription error: " << sub_->errstr << std::endl;
+                    running_ = false;
+                }
+            }
+        }
+    }
+
+    // A plain ACK, or a receiver's coalesced reply completing several messages at once
+    void complete(const MessageEnvelope& envelope) {
+        if (messaging::utils::coalesced_acks(envelope, coalesced_)) {
+            for (const Acknowledgment& ack : coalesced_.acknowledgments()) {
+                replies_.complete(ack.original_message_id(), ack.received() && message_helpers::is_ack_ok(ack),
+                                  messaging::utils::AckTiming::of(ack));
+            }
+        } else {
+            const std::string& message_id = envelope.ack().original_message_id();
+            replies_.complete(message_id, message_helpers::is_valid_ack(envelope, message_id),
+                              messaging::utils::AckTiming::of(envelope.ack()));
+        }
+    }
+
+    std::string channel_;
+    redisContext *sub_ = nullptr;
+    messaging::BatchResponse coalesced_;  // only touched by the subscriber thread
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    messaging::utils::PendingReplies replies_;
+};
+
+#endif // REDIS_ACK_DEMUX_HPP
@@ -0,0 +1,641 @@
+#ifndef REDIS_EVENT_LOOP_HPP
+#define REDIS_EVENT_LOOP_HPP
+
+#include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "../../utils/cpp/json.hpp"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/message_ids.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
+#include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/trace.hpp"
+
+/**
+ * Event-driven Redis Pub/Sub on redisAsyncContext, for --event-loop.
+ *
+ * hiredis ships adapters for libevent, libuv and ae but not for a bare epoll
+ * set, so EventLoop is that adapter: hiredis asks it to watch a context's fd
+ * for reads and writes, and run_once() calls redisAsyncHandleRead/Write for
+ * whatever is ready. No read timeouts are set on the sockets; the only timed
+ * waits are for the next ACK deadline or coalesced-ACK flush, plus a 1 s idle
+ * wakeup so a loop notices shutdown. One thread can then serve a subscription
+ * to many channels and the ACK PUBLISHes for all of them, and commands issued
+ * in one pass go out in one write.
+ */
+namespace redis_events {
+
+using json = nlohmann::json;
+
+constexpr int kIdleWakeMs = 1000;   // longest wait with nothing due, so running is re-checked
+constexpr int kCloseWaitMs = 1000;  // longest wait for queued commands to be answered on shutdown
+
+class EventLoop {
+public:
+    EventLoop() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {}
+    ~EventLoop() {
+        sweep();
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Install the event hooks on ac; false if it already has an adapter or epoll is unavailable
+    bool attach(redisAsyncContext* ac) {
+        if (epoll_fd_ < 0 || ac->ev.data) {
+            return false;
+        }
+        ac->ev.data = new Watch{this, ac};
+        ac->ev.addRead = &EventLoop::add_read;
+        ac->ev.delRead = &EventLoop::del_read;
+        ac->ev.addWrite = &EventLoop::add_write;
+        ac->ev.delWrite = &EventLoop::del_write;
+        ac->ev.cleanup = &EventLoop::cleanup;
+        attached_++;
+        return true;
+    }
+
+    // Contexts attached and not yet freed by hiredis
+    size_t attached() const { return attached_; }
+
+    /**
+     * @brief Wait up to timeout_ms (-1 = forever) for socket events and dispatch them.
+     * @return Number of ready sockets, 0 on timeout or signal, -1 if epoll failed
+     */
+    int run_once(int timeout_ms) {
+        epoll_event events[kMaxEvents];
+        int ready = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+        wakeups_++;
+        if (ready <= 0) {
+            if (ready == 0) {
+                idle_wakeups_++;
+            }
+            return ready < 0 && errno != EINTR ? -1 : 0;
+        }
+        ready_events_ += ready;
+        for (int i = 0; i < ready; ++i) {
+            // A callback may free any context, this one included; cleanup() clears w->ac
+            Watch* w = static_cast<Watch*>(events[i].data.ptr);
+            if (w->ac && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                redisAsyncHandleRead(w->ac);
+            }
+            if (w->ac && (events[i].events & EPOLLOUT)) {
+                redisAsyncHandleWrite(w->ac);
+            }
+        }
+        sweep();
+        return ready;
+    }
+
+    // Wakeups split into those with ready sockets and idle ones; a busy loop has few idle ones
+    json report() const {
+        return {
+            {"wakeups", wakeups_},
+            {"ready_events", ready_events_},
+            {"idle_wakeups", idle_wakeups_}
+        };
+    }
+
+private:
+    static constexpr int kMaxEvents = 64;
+
+    struct Watch {
+        EventLoop* loop;
+        redisAsyncContext* ac;    // null once hiredis has cleaned the context up
+        uint32_t events = 0;
+        bool added = false;
+    };
+
+    static void add_read(void* data) { watch(data)->loop->update(watch(data), watch(data)->events | EPOLLIN); }
+    static void del_read(void* data) { watch(data)->loop->update(watch(data), watch(data)->events & ~EPOLLIN); }
+    static void add_write(void* data) { watch(data)->loop->update(watch(data), watch(data)->events | EPOLLOUT); }
+    static void del_write(void* data) { watch(data)->loop->update(watch(data), watch(data)->events & ~EPOLLOUT); }
+
+    // Called while the fd is still open; the Watch itself is freed after the current dispatch
+    static void cleanup(void* data) {
+        Watch* w = watch(data);
+        EventLoop* loop = w->loop;
+        if (w->added) {
+            epoll_ctl(loop->epoll_fd_, EPOLL_CTL_DEL, w->ac->c.fd, nullptr);
+        }
+        w->ac->ev = {};
+        w->ac = nullptr;
+        loop->dead_.push_back(w);
+        loop->attached_--;
+    }
+
+    static Watch* watch(void* data) { return static_cast<Watch*>(data); }
+
+    void update(Watch* w, uint32_t events) {
+        if (!w->ac || (w->added && events == w->events)) {
+            return;
+        }
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = w;
+        epoll_ctl(epoll_fd_, w->added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, w->ac->c.fd, &event);
+        w->added = true;
+        w->events = events;
+    }
+
+    void sweep() {
+        for (Watch* w : dead_) {
+            delete w;
+        }
+        dead_.clear();
+    }
+
+    int epoll_fd_;
+    size_t attached_ = 0;
+    std::vector<Watch*> dead_;
+    uint64_t wakeups_ = 0;
+    uint64_t ready_events_ = 0;
+    uint64_t idle_wakeups_ = 0;
+};
+
+/**
+ * One redisAsyncContext on an EventLoop. hiredis frees the context itself
+ * after a failed connect or a disconnect, and both clear get(), so a non-null
+ * get() is always safe to issue commands on. Commands issued while the
+ * connect is still in progress are sent once it completes.
+ */
+class AsyncConnection {
+public:
+    AsyncConnection() = default;
+    ~AsyncConnection() {
+        if (ctx_) {
+            redisAsyncFree(ctx_);
+        }
+    }
+
+    AsyncConnection(const AsyncConnection&) = delete;
+    AsyncConnection& operator=(const AsyncConnection&) = delete;
+
+    // Start a non-blocking connect; owner is handed back to command callbacks by owner_of()
+    bool open(EventLoop& loop, const std::string& host, int port, void* owner) {
+        redisAsyncContext* ac = redisAsyncConnect(host.c_str(), port);
+        if (!ac) {
+            return false;
+        }
+        if (ac->err || !loop.attach(ac)) {
+            std::cerr << " [!] Redis connect failed: " << (ac->errstr ? ac->errstr : "no event loop") << std::endl;
+            redisAsyncFree(ac);
+            return false;
+        }
+        ac->data = this;
+        owner_ = owner;
+        redisAsyncSetConnectCallback(ac, &AsyncConnection::on_connect);
+        redisAsyncSetDisconnectCallback(ac, &AsyncConnection::on_disconnect);
+        ctx_ = ac;
+        return true;
+    }
+
+    // Disconnect once every command issued so far has been answered
+    void close() {
+        if (ctx_) {
+            redisAsyncDisconnect(ctx_);
+        }
+    }
+
+    redisAsyncContext* get() const { return ctx_; }
+    bool connected() const { return connected_; }
+    // The connect failed or the connection dropped, rather than being closed
+    bool failed() const { return failed_; }
+
+    template <typename T>
+    static T* owner_of(redisAsyncContext* ac) {
+        return static_cast<T*>(static_cast<AsyncConnection*>(ac->data)->owner_);
+    }
+
+private:
+    static void on_connect(const redisAsyncContext* ac, int status) {
+        AsyncConnection* self = static_cast<AsyncConnection*>(ac->data);
+        if (status == REDIS_OK) {
+            self->connected_ = true;
+            return;
+        }
+        std::cerr << " [!] Redis connect failed: " << ac->errstr << std::endl;
+        self->failed_ = true;
+        self->ctx_ = nullptr;
+    }
+
+    static void on_disconnect(const redisAsyncContext* ac, int status) {
+        AsyncConnection* self = static_cast<AsyncConnection*>(ac->data);
+        if (status != REDIS_OK) {
+            std::cerr << " [!] Redis connection lost: " << ac->errstr << std::endl;
+            self->failed_ = true;
+        }
+        self->connected_ = false;
+        self->ctx_ = nullptr;
+    }
+
+    redisAsyncContext* ctx_ = nullptr;
+    void* owner_ = nullptr;
+    bool connected_ = false;
+    bool failed_ = false;
+};
+
+// The [type, channel, payload] array of a Pub/Sub delivery, or null for anything else
+inline const redisReply* pubsub_message(const void* r) {
+    const redisReply* reply = static_cast<const redisReply*>(r);
+    if (!reply || reply->type != REDIS_REPLY_ARRAY || reply->elements < 3 ||
+        reply->element[0]->type != REDIS_REPLY_STRING || std::strcmp(reply->element[0]->str, "message") != 0) {
+        return nullptr;
+    }
+    return reply->element[2];
+}
+
+/**
+ * Receiver side: one subscribed connection for every channel test_channel_<id>
+ * of ids and one connection publishing all of their ACKs, both on one
+ * thread. Each id keeps its own ACK encoder, coalescer and progress counter,
+ * so to a sender it looks like that many receive_async_test processes.
+ */
+class EventReceiver {
+public:
+    EventReceiver(const std::vector<int>& ids, const messaging::utils::CoalesceOptions& coalesce,
+                  const std::string& host = "127.0.0.1", int port = 6379)
+        : coalesce_(coalesce), host_(host), port_(port) {
+        for (int id : ids) {
+            channels_.push_back(std::make_unique<Channel>(this, id, coalesce));
+        }
+    }
+
+    EventReceiver(const EventReceiver&) = delete;
+    EventReceiver& operator=(const EventReceiver&) = delete;
+
+    // Serve every channel until running turns false; returns non-zero if Redis is unreachable or lost
+    int run(std::atomic<bool>& running) {
+        if (!sub_.open(loop_, host_, port_, this) || !pub_.open(loop_, host_, port_, this)) {
+            std::cerr << "Redis connection failed" << std::endl;
+            return 1;
+        }
+        for (auto& channel : channels_) {
+            // hiredis calls on_message for the subscribe confirmation and then every delivery
+            redisAsyncCommand(sub_.get(), &EventReceiver::on_message, channel.get(), "SUBSCRIBE %s",
+                              channel->name.c_str());
+            std::cout << " [*] [ASYNC] Receiver " << channel->id << " waiting for messages on "
+                      << channel->name << " (event loop)" << std::endl;
+        }
+
+        auto send_reply = [this](const std::string& reply_channel, std::string_view response) {
+            publish(reply_channel, response);
+        };
+        while (running && !sub_.failed() && !pub_.failed()) {
+            loop_.run_once(wait_ms());
+            if (coalesce_.enabled()) {
+                for (auto& channel : channels_) {
+                    channel->coalescer.flush(send_reply);
+                }
+            }
+        }
+        for (auto& channel : channels_) {
+            channel->coalescer.flush(send_reply, true);
+        }
+
+        // A graceful disconnect waits for the replies to every queued PUBLISH, so no ACK is cut off
+        pub_.close();
+        sub_.close();
+        long long close_by_ns = message_helpers::get_steady_time_ns() + kCloseWaitMs * 1000000LL;
+        while (loop_.attached() > 0 && message_helpers::get_steady_time_ns() < close_by_ns) {
+            loop_.run_once(10);
+        }
+
+        messaging::utils::flush_log();
+        for (const auto& channel : channels_) {
+            std::cout << " [x] [ASYNC] Receiver " << channel->id << " shutting down (received "
+                      << channel->received << " messages)" << std::endl;
+        }
+        std::cout << " [x] [ASYNC] Event loop: " << loop_.report().dump() << std::endl;
+        return sub_.failed() || pub_.failed() ? 1 : 0;
+    }
+
+private:
+    struct Channel {
+        EventReceiver* owner;
+        std::string id;
+        std::string name;
+        messaging::utils::AckEncoder acks;
+        messaging::utils::AckCoalescer coalescer;
+        messaging::utils::LogSummary& progress;
+        uint64_t received = 0;
+
+        Channel(EventReceiver* owner, int receiver_id, const messaging::utils::CoalesceOptions& coalesce)
+            : owner(owner), id(std::to_string(receiver_id)), name("test_channel_" + id),
+              acks(id, true), coalescer(id, coalesce, true),
+              progress(messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Receiver " + id, {"received"})) {}
+    };
+
+    static void on_message(redisAsyncContext*, void* r, void* privdata) {
+        const redisReply* body = pubsub_message(r);
+        if (body) {
+            Channel* channel = static_cast<Channel*>(privdata);
+            channel->owner->handle(*channel, body);
+        }
+    }
+
+    void handle(Channel& channel, const redisReply* body) {
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+        if (!message_helpers::parse_envelope(body->str, body->len, request_)) {
+            return;
+        }
+        messaging::utils::log_debug() << " [x] [ASYNC] Received message " << request_.message_id()
+                                      << " (" << body->len << " bytes)";
+        channel.received++;
+        channel.progress.add(0);
+
+        // Same replies as receiver_async_test: a coalesced ACK per shared reply_to channel, else one each
+        auto reply_to = request_.metadata().find("reply_to");
+        if (coalesce_.enabled() && reply_to != request_.metadata().end() &&
+            !message_helpers::is_batch(request_) && !message_helpers::is_control(request_)) {
+            if (channel.coalescer.add(reply_to->second, request_, timing)) {
+                publish(reply_to->second, channel.coalescer.take(reply_to->second));
+            }
+        } else {
+            publish(reply_to != request_.metadata().end() ? reply_to->second : "reply_" + request_.message_id(),
+                    channel.acks.encode_response(request_, timing));
+        }
+    }
+
+    // Queued on the publishing connection; the loop writes everything queued in one pass together
+    void publish(const std::string& reply_channel, std::string_view response) {
+        TRACE_SCOPE("reply");
+        if (pub_.get()) {
+            redisAsyncCommand(pub_.get(), nullptr, nullptr, "PUBLISH %s %b", reply_channel.c_str(),
+                              response.data(), response.size());
+        }
+    }
+
+    // Until the earliest coalesced flush is due, or the idle wakeup
+    int wait_ms() const {
+        int wait = kIdleWakeMs;
+        if (coalesce_.enabled()) {
+            for (const auto& channel : channels_) {
+                int due = channel->coalescer.next_due_ms();
+                if (due >= 0) {
+                    wait = std::min(wait, due);
+                }
+            }
+        }
+        return wait;
+    }
+
+    messaging::utils::CoalesceOptions coalesce_;
+    std::string host_;
+    int port_;
+    std::vector<std::unique_ptr<Channel>> channels_;
+    messaging::MessageEnvelope request_;
+    // Declared last: freeing a connection runs callbacks that may still touch the members above
+    EventLoop loop_;
+    AsyncConnection sub_;
+    AsyncConnection pub_;
+};
+
+/**
+ * Sender side: every PUBLISH and every ACK on one thread. Requests go out on
+ * one connection, up to max_in_flight unanswered, and ACKs arrive on a
+ * second one subscribed to this sender's reply channel, matched by
+ * original_message_id like AckDemux but without its subscriber thread or
+ * locks. A PUBLISH answered with 0 subscribers fails its message at once.
+ */
+class EventSender {
+public:
+    using ResultFn = std::function<void(const messaging::utils::TaskResult& result)>;
+
+    explicit EventSender(int timeout_ms = 1000, const std::string& host = "127.0.0.1", int port = 6379)
+        : channel_("reply_sender_" + std::to_string(::getpid()) + "_" +
+                   std::to_string(message_helpers::get_steady_time_ns())),
+          timeout_ns_(timeout_ms * 1000000LL), host_(host), port_(port) {}
+
+    EventSender(const EventSender&) = delete;
+    EventSender& operator=(const EventSender&) = delete;
+
+    // Reply channel sent as reply_to metadata
+    const std::string& channel() const { return channel_; }
+
+    /**
+     * @brief Connect both connections and wait for Redis to confirm the reply subscription.
+     * @return false if Redis is unreachable or did not confirm within wait_ms
+     */
+    bool start(int wait_ms = 2000) {
+        if (!sub_.open(loop_, host_, port_, this) || !pub_.open(loop_, host_, port_, this)) {
+            return false;
+        }
+        redisAsyncCommand(sub_.get(), &EventSender::on_reply, nullptr, "SUBSCRIBE %s", channel_.c_str());
+        long long give_up_ns = message_helpers::get_steady_time_ns() + wait_ms * 1000000LL;
+        while (!subscribed_ && !sub_.failed() && !pub_.failed() &&
+               message_helpers::get_steady_time_ns() < give_up_ns) {
+            loop_.run_once(10);
+        }
+        return subscribed_ && pub_.get();
+    }
+
+    /**
+     * Publish the corpus and report every message (acked, failed or timed
+     * out) to on_result on this thread; returns the peak in flight.
+     */
+    int run(const test_data_loader::EncodedCorpus& corpus, int max_in_flight, const ResultFn& on_result,
+            MessageStats& stats) {
+        on_result_ = &on_result;
+        corpus_ = &corpus;
+        size_t window = static_cast<size_t>(std::max(1, max_in_flight));
+        size_t peak = 0;
+        std::string body;
+
+        size_t i = 0;
+        while (i < corpus.size() && pub_.get() && !sub_.failed()) {
+            // Queue a burst; nothing is written until the loop sees the socket writable
+            for (size_t burst = 0; burst < kBurst && i < corpus.size() && pending_.size() < window; ++burst, ++i) {
+                std::string message_id(corpus.message_id(i));
+                corpus.encode(i, message_helpers::get_current_time_us(), channel_, body);
+                // Expect the ACK before publishing, so it can't arrive unmatched
+                expect(message_id);
+                const std::string& target = targets_[corpus.target(i)];
+                TRACED("send", redisAsyncCommand(pub_.get(), &EventSender::on_published, index_data(i),
+                                                 "PUBLISH %s %b", target.c_str(), body.data(), body.size()));
+                stats.record_dispatch();
+                peak = std::max(peak, pending_.size());
+            }
+            // Only wait when the window is full; otherwise just flush writes and pick up ACKs
+            loop_.run_once(pending_.size() < window && i < corpus.size() ? 0 : wait_ms());
+            expire();
+        }
+
+        // Messages never published once a connection broke
+        for (; i < corpus.size(); ++i) {
+            messaging::utils::TaskResult res;
+            res.message_id = std::string(corpus.message_id(i));
+            res.error = "Connection failed";
+            on_result(res);
+        }
+        while (!pending_.empty()) {
+            if (sub_.failed() || pub_.failed()) {
+                fail_all("Connection failed");
+                break;
+            }
+            loop_.run_once(wait_ms());
+            expire();
+        }
+
+        pub_.close();
+        sub_.close();
+        long long close_by_ns = message_helpers::get_steady_time_ns() + kCloseWaitMs * 1000000LL;
+        while (loop_.attached() > 0 && message_helpers::get_steady_time_ns() < close_by_ns) {
+            loop_.run_once(10);
+        }
+        on_result_ = nullptr;
+        corpus_ = nullptr;
+        return static_cast<int>(peak);
+    }
+
+    json report() const { return loop_.report(); }
+
+private:
+    static constexpr size_t kBurst = 64;  // PUBLISHes queued between loop passes
+
+    static void* index_data(size_t i) { return reinterpret_cast<void*>(static_cast<uintptr_t>(i)); }
+
+    // PUBLISH reply: the number of subscribers reached, 0 meaning no ACK is coming
+    static void on_published(redisAsyncContext* ac, void* r, void* privdata) {
+        EventSender* self = AsyncConnection::owner_of<EventSender>(ac);
+        const redisReply* reply = static_cast<const redisReply*>(r);
+        if (!self->corpus_ || (reply && reply->type == REDIS_REPLY_INTEGER && reply->integer > 0)) {
+            return;
+        }
+        std::string message_id(self->corpus_->message_id(reinterpret_cast<uintptr_t>(privdata)));
+        self->fail(message_id, !reply || reply->type != REDIS_REPLY_INTEGER ? "Publish failed" : "No subscriber");
+    }
+
+    static void on_reply(redisAsyncContext* ac, void* r, void*) {
+        EventSender* self = AsyncConnection::owner_of<EventSender>(ac);
+        const redisReply* reply = static_cast<const redisReply*>(r);
+        if (reply && reply->type == REDIS_REPLY_ARRAY && reply->elements >= 1 &&
+            reply->element[0]->type == REDIS_REPLY_STRING && std::strcmp(reply->element[0]->str, "subscribe") == 0) {
+            self->subscribed_ = true;
+            return;
+        }
+        const redisReply* body = pubsub_message(r);
+        if (body && self->on_result_ &&
+            message_helpers::parse_envelope(body->str, body->len, self->envelope_) &&
+            (self->envelope_.has_ack() || messaging::utils::is_coalesced_ack(self->envelope_))) {
+            self->complete(self->envelope_);
+        }
+    }
+
+    void expect(const std::string& message_id) {
+        long long now_ns = message_helpers::get_steady_time_ns();
+        pending_[message_id] = now_ns;
+        deadlines_.push_back({now_ns + timeout_ns_, message_id});
+    }
+
+    void fail(const std::string& message_id, const std::string& error) {
+        if (pending_.erase(message_id)) {
+            messaging::utils::TaskResult res;
+            res.message_id = message_id;
+            res.error = error;
+            (*on_result_)(res);
+        }
+    }
+
+    void fail_all(const std::string& error) {
+        for (const auto& [message_id, sent_ns] : pending_) {
+            messaging::utils::TaskResult res;
+            res.message_id = message_id;
+            res.error = error;
+            (*on_result_)(res);
+        }
+        pending_.clear();
+        deadlines_.clear();
+    }
+
+    // A plain ACK, or a receiver's coalesced reply completing several messages at once
+    void complete(const messaging::MessageEnvelope& envelope) {
+        if (messaging::utils::coalesced_acks(envelope, coalesced_)) {
+            for (const messaging::Acknowledgment& ack : coalesced_.acknowledgments()) {
+                complete(ack, ack.received() && message_helpers::is_ack_ok(ack));
+            }
+        } else {
+            complete(envelope.ack(), message_helpers::is_valid_ack(envelope, envelope.ack().original_message_id()));
+        }
+    }
+
+    void complete(const messaging::Acknowledgment& ack, bool valid) {
+        auto it = pending_.find(ack.original_message_id());
+        if (it == pending_.end()) {
+            return;  // late ACK for a message that already timed out
+        }
+        messaging::utils::TaskResult res;
+        res.message_id = it->first;
+        res.duration_ns = message_helpers::get_steady_time_ns() - it->second;
+        res.success = valid;
+        if (!res.success) {
+            res.error = "Invalid ACK";
+        }
+        res.ack_timing = messaging::utils::AckTiming::of(ack);
+        pending_.erase(it);
+        (*on_result_)(res);
+    }
+
+    void expire() {
+        long long now_ns = message_helpers::get_steady_time_ns();
+        while (!deadlines_.empty() && deadlines_.front().first <= now_ns) {
+            auto it = pending_.find(deadlines_.front().second);
+            // Skip entries whose message was acked or already failed
+            if (it != pending_.end() && it->second + timeout_ns_ <= now_ns) {
+                fail(it->first, "Timeout");
+            }
+            deadlines_.pop_front();
+        }
+    }
+
+    // Until the oldest outstanding message times out, or the idle wakeup
+    int wait_ms() const {
+        if (deadlines_.empty()) {
+            return kIdleWakeMs;
+        }
+        long long left_ns = deadlines_.front().first - message_helpers::get_steady_time_ns();
+        return left_ns <= 0 ? 0 : static_cast<int>(std::min<long long>(kIdleWakeMs, (left_ns + 999999) / 1000000));
+    }
+
+    std::string channel_;
+    long long timeout_ns_;
+    std::string host_;
+    int port_;
+    messaging::utils::TopicTable targets_{"test_channel_"};
+    const ResultFn* on_result_ = nullptr;
+    const test_data_loader::EncodedCorpus* corpus_ = nullptr;
+    bool subscribed_ = false;
+    messaging::MessageEnvelope envelope_;
+    messaging::BatchResponse coalesced_;
+    std::unordered_map<std::string, long long> pending_;   // message_id -> publish time
+    std::deque<std::pair<long long, std::string>> deadlines_;
+    // Declared last: freeing a connection runs callbacks that may still touch the members above
+    EventLoop loop_;
+    AsyncConnection sub_;
+    AsyncConnection pub_;
+};
+
+} // namespace redis_events
+
+#endif // REDIS_EVENT_LOOP_HPP
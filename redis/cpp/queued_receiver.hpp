@@ -0,0 +1,224 @@
+#ifndef REDIS_QUEUED_RECEIVER_HPP
+#define REDIS_QUEUED_RECEIVER_HPP
+
+#include <hiredis/hiredis.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/work_queue.hpp"
+
+/**
+ * Pub/Sub receiver split into stages (--work-queue N): the calling thread
+ * reads "test_channel_<id>" and submits each message reply to a WorkQueue,
+ * workers parse it and encode its ACK, and an ACK writer thread owns the
+ * publishing connection, pipelining every PUBLISH it finds waiting in one
+ * write. Reading, processing and replying overlap instead of taking turns.
+ *
+ * With --coalesce-acks the writer does the coalescing, since it alone sees
+ * which ACKs share a reply_to channel; workers then only parse. A full queue
+ * either stops the reader (block: Redis buffers the subscription, up to its
+ * client-output-buffer-limit) or drops the message (shed). Shutdown prints
+ * "work_queue={...}".
+ */
+namespace redis_pubsub {
+
+class QueuedReceiver {
+public:
+    QueuedReceiver(int receiver_id, const messaging::utils::WorkQueueOptions& options,
+                   const messaging::utils::CoalesceOptions& coalesce = {})
+        : receiver_id_(std::to_string(receiver_id)), channel_("test_channel_" + receiver_id_),
+          options_(options), coalesce_(coalesce),
+          progress_(messaging::utils::AsyncLogger::global().summary(" [*] Receiver " + receiver_id_, {"received"})) {
+        for (int w = 0; w < options_.workers; ++w) {
+            workers_.push_back(std::make_unique<Worker>(receiver_id_));
+        }
+    }
+
+    // Serve the channel until running turns false; returns non-zero if Redis is unreachable
+    int run(std::atomic<bool>& running) {
+        redisContext *c_sub = redisConnect("127.0.0.1", 6379);
+        redisContext *c_pub = redisConnect("127.0.0.1", 6379);
+        if (!c_sub || c_sub->err || !c_pub || c_pub->err) {
+            std::cerr << "Redis connection failed" << std::endl;
+            if (c_sub) redisFree(c_sub);
+            if (c_pub) redisFree(c_pub);
+            return 1;
+        }
+        std::cout << " [+] Connected to Redis" << std::endl;
+        std::cout << " [*] Receiver " << receiver_id_ << " waiting for messages on " << channel_
+                  << " (queue " << options_.capacity << ", " << options_.workers << " workers, "
+                  << options_.policy() << " when full)" << std::endl;
+
+        redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", channel_.c_str());
+        if (sub) freeReplyObject(sub);
+        redisSetTimeout(c_sub, {1, 0});  // 1s timeout for graceful shutdown
+
+        messaging::utils::WorkQueue<Job> queue(options_, [this](Job& job, int worker) { process(job, worker); });
+        replies_ = std::make_unique<messaging::utils::ReplyQueue<Reply>>(queue.max_outstanding());
+        std::atomic<bool> writing(true);
+        std::thread writer([&]() { write_replies(c_pub, writing); });
+
+        while (running) {
+            redisReply *reply = nullptr;
+            int status = redisGetReply(c_sub, (void**)&reply);
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+            if (status == REDIS_OK && reply) {
+                if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3 &&
+                    reply->element[0]->type == REDIS_REPLY_STRING &&
+                    std::strcmp(reply->element[0]->str, "message") == 0) {
+                    // The worker frees what it is handed
+                    Job job{reply, timing};
+                    if (queue.submit(job)) {
+                        continue;
+                    }
+                    if (queue.warn_due()) {
+                        std::cerr << " [!] Receiver " << receiver_id_ << ": work queue full, " << queue.shed()
+                                  << " messages shed so far" << std::endl;
+                    }
+                }
+                freeReplyObject(reply);
+            } else if (status == REDIS_ERR) {
+                if (c_sub->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
+                    c_sub->err = 0;
+                    memset(c_sub->errstr, 0, sizeof(c_sub->errstr));
+                } else if (running) {
+                    std::cerr << " [!] Redis error: " << c_sub->errstr << " (code: " << c_sub->err << ")" << std::endl;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            }
+        }
+        // Workers finish what is queued, then the writer sends the last of their ACKs
+        queue.close();
+        writing = false;
+        writer.join();
+
+        messaging::utils::flush_log();
+        std::cout << " [x] Receiver " << receiver_id_ << " work_queue=" << queue.report().dump() << std::endl;
+        redisFree(c_sub);
+        redisFree(c_pub);
+        return 0;
+    }
+
+private:
+    struct Job {
+        redisReply* reply = nullptr;
+        message_helpers::ReceiveTiming timing;
+    };
+
+    // Encoded ACK bytes, or with coalescing the parsed request for the writer's coalescer
+    struct Reply {
+        std::string channel;
+        std::string response;
+        bool coalesce = false;
+        MessageEnvelope request;
+        message_helpers::ReceiveTiming timing;
+    };
+
+    struct Worker {
+        Reply reply;
+        messaging::utils::AckEncoder acks;
+
+        explicit Worker(const std::string& receiver_id) : acks(receiver_id) {}
+    };
+
+    void process(Job& job, int worker_id) {
+        Worker& worker = *workers_[worker_id];
+        Reply& reply = worker.reply;
+        redisReply* body = job.reply->element[2];
+        bool parsed = message_helpers::parse_envelope(body->str, body->len, reply.request);
+        freeReplyObject(job.reply);
+        if (!parsed) {
+            std::cerr << " [!] Failed to parse message" << std::endl;
+            return;
+        }
+        messaging::utils::log_debug() << " [x] Worker " << worker_id << " received message "
+                                      << reply.request.message_id();
+        progress_.add(0);
+
+        const MessageEnvelope& request = reply.request;
+        auto reply_to = request.metadata().find("reply_to");
+        if (reply_to != request.metadata().end()) {
+            reply.channel = reply_to->second;
+        } else {
+            reply.channel.assign("reply_").append(request.message_id());
+        }
+        reply.timing = job.timing;
+        reply.coalesce = coalesce_.enabled() && reply_to != request.metadata().end() &&
+                         !message_helpers::is_batch(request) && !message_helpers::is_control(request);
+        if (!reply.coalesce) {
+            std::string_view response = worker.acks.encode_response(request, job.timing);
+            reply.response.assign(response.data(), response.size());
+        }
+        replies_->push(reply);
+    }
+
+    /**
+     * ACK writer thread: pipeline every waiting PUBLISH, then read their
+     * replies. After a write error it keeps draining, so workers never wait
+     * on a full ReplyQueue, but sends nothing more.
+     */
+    void write_replies(redisContext *c_pub, std::atomic<bool>& writing) {
+        messaging::utils::AckCoalescer coalescer(receiver_id_, coalesce_);
+        size_t pipelined = 0;
+        bool failed = false;
+        auto publish = [&](const std::string& channel, std::string_view response) {
+            if (failed) {
+                return;
+            }
+            TRACE_SCOPE("reply");
+            redisAppendCommand(c_pub, "PUBLISH %s %b", channel.c_str(), response.data(), response.size());
+            pipelined++;
+        };
+        pollfd waiting = {replies_->fd(), POLLIN, 0};
+        while (true) {
+            bool last = !writing.load();
+            int due_ms = coalescer.next_due_ms();
+            ::poll(&waiting, 1, last ? 0 : (due_ms >= 0 ? due_ms : 100));
+            replies_->drain([&](Reply& reply) {
+                if (!reply.coalesce) {
+                    publish(reply.channel, reply.response);
+                } else if (coalescer.add(reply.channel, reply.request, reply.timing)) {
+                    publish(reply.channel, coalescer.take(reply.channel));
+                }
+            });
+            coalescer.flush(publish, last);
+            for (; pipelined > 0; --pipelined) {
+                redisReply *reply = nullptr;
+                if (redisGetReply(c_pub, (void**)&reply) != REDIS_OK || !reply) {
+                    std::cerr << " [!] Redis error: " << c_pub->errstr << std::endl;
+                    failed = true;
+                    pipelined = 0;
+                    break;
+                }
+                freeReplyObject(reply);
+            }
+            if (last) {
+                return;
+            }
+        }
+    }
+
+    std::string receiver_id_;
+    std::string channel_;
+    messaging::utils::WorkQueueOptions options_;
+    messaging::utils::CoalesceOptions coalesce_;
+    messaging::utils::LogSummary& progress_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<messaging::utils::ReplyQueue<Reply>> replies_;
+};
+
+} // namespace redis_pubsub
+
+#endif // REDIS_QUEUED_RECEIVER_HPP
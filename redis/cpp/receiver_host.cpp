@@ -0,0 +1,47 @@
+#include <hiredis/hiredis.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <signal.h>
+#include "../../utils/cpp/receiver_host.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/payload_codec.hpp"
+
+/**
+ * Runs receivers --ids LIST in one process on --threads N threads, in place of
+ * one receiver_test per id. Each receiver subscribes to test_channel_<id> on
+ * its own pair of connections: a hiredis context is not thread-safe, and a
+ * subscribed connection cannot publish ACKs.
+ */
+
+using messaging::utils::ReceiverHost;
+
+std::atomic<bool> running(true);
+
+void signal_handler(int sig) {
+    running = false;
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    std::vector<int> ids;
+    int threads = 0;
+    if (!messaging::utils::parse_host_args(argc, argv, ids, threads)) {
+        return 1;
+    }
+
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::configure_compression(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    ReceiverHost host(ids, threads, [&](int id) -> std::unique_ptr<messaging::utils::UnifiedReceiver> {
+        return std::make_unique<messaging::utils::RedisReceiver>(id);
+    });
+    host.set_perf_counters(&perf);
+    host.set_dedup_options(messaging::utils::DedupOptions::from_args(argc, argv));
+    return host.run(running);
+}
@@ -6,6 +6,13 @@
 #include <atomic>
 #include <thread>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/payload_codec.hpp"
+#include "stream_transport.hpp"
+#include "queued_receiver.hpp"
 
 using messaging::MessageEnvelope;
 using message_helpers::get_current_time_ms;
@@ -17,18 +24,35 @@ void signal_handler(int sig) {
 }
 
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
+    bool use_streams = false;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--id") == 0 && i + 1 < argc) {
-            receiver_id = std::stoi(argv[i + 1]);
-            break;
+            receiver_id = std::stoi(argv[++i]);
+        } else if (strcmp(argv[i], "--streams") == 0) {
+            use_streams = true;
         }
     }
     
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::configure_compression(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
+    if (use_streams) {
+        redis_streams::StreamReceiver receiver(receiver_id, false,
+                                               messaging::utils::CoalesceOptions::from_args(argc, argv));
+        return receiver.run(running);
+    }
+    messaging::utils::WorkQueueOptions work = messaging::utils::WorkQueueOptions::from_args(argc, argv);
+    if (work.enabled()) {
+        redis_pubsub::QueuedReceiver receiver(receiver_id, work, messaging::utils::CoalesceOptions::from_args(argc, argv));
+        return receiver.run(running);
+    }
+    
     redisContext *c_sub = redisConnect("127.0.0.1", 6379);
     redisContext *c_pub = redisConnect("127.0.0.1", 6379);
     
@@ -42,18 +66,32 @@ int main(int argc, char* argv[]) {
 
     std::string channel = "test_channel_" + std::to_string(receiver_id);
     std::cout << " [*] Receiver " << receiver_id << " waiting for messages on " << channel << std::endl;
+    messaging::utils::LogSummary& progress = messaging::utils::AsyncLogger::global().summary(
+        " [*] Receiver " + std::to_string(receiver_id), {"received"});
+    messaging::utils::AckEncoder acks(std::to_string(receiver_id));
+    messaging::utils::AckCoalescer coalescer(std::to_string(receiver_id),
+                                             messaging::utils::CoalesceOptions::from_args(argc, argv));
+    auto publish = [&](const std::string& reply_channel, std::string_view response) {
+        TRACE_SCOPE("reply");
+        redisReply *pub = (redisReply*)redisCommand(c_pub, "PUBLISH %s %b",
+            reply_channel.c_str(), response.data(), response.size());
+        if (pub) freeReplyObject(pub);
+    };
 
     // Subscribe to channel
     redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", channel.c_str());
     if (sub) freeReplyObject(sub);
 
-    // Set timeout for graceful shutdown
-    struct timeval tv = {1, 0};
+    // Set timeout for graceful shutdown; queued coalesced ACKs are also flushed on it
+    int timeout_us = coalescer.options().enabled()
+        ? std::min(1000000, std::max(1000, coalescer.options().max_delay_us)) : 1000000;
+    struct timeval tv = {timeout_us / 1000000, timeout_us % 1000000};
     redisSetTimeout(c_sub, tv);
 
     while (running) {
         redisReply *reply = nullptr;
         int status = redisGetReply(c_sub, (void**)&reply);
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
         
         if (status == REDIS_OK && reply) {
             if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3) {
@@ -61,30 +99,26 @@ int main(int argc, char* argv[]) {
                     strcmp(reply->element[0]->str, "message") == 0) {
                     
                     std::string message_str(reply->element[2]->str, reply->element[2]->len);
-                    std::cout << " [x] Raw message received (" << message_str.length() << " bytes)" << std::endl;
-                    
                     // Parse message
                     MessageEnvelope msg_envelope;
                     if (message_helpers::parse_envelope(message_str, msg_envelope)) {
                         std::string message_id = msg_envelope.message_id();
-                        std::cout << " [x] Received message " << message_id << std::endl;
-                        
-                        // Create ACK
-                        MessageEnvelope response = message_helpers::create_ack_from_envelope(
-                            msg_envelope,
-                            std::to_string(receiver_id)
-                        );
-                        std::string response_str = message_helpers::serialize_envelope(response);
+                        messaging::utils::log_debug() << " [x] Received message " << message_id
+                                                      << " (" << message_str.length() << " bytes)";
+                        progress.add(0);
                         
-                        // Send ACK to reply channel
-                        std::string reply_channel = "reply_" + message_id;
-                        if (msg_envelope.metadata().count("reply_to")) {
-                            reply_channel = msg_envelope.metadata().at("reply_to");
+                        // Send the ACK (a BatchResponse for batches) to the reply channel; with
+                        // --coalesce-acks, ACKs for a shared reply_to channel go out together
+                        auto reply_to = msg_envelope.metadata().find("reply_to");
+                        if (coalescer.options().enabled() && reply_to != msg_envelope.metadata().end() &&
+                            !message_helpers::is_batch(msg_envelope) && !message_helpers::is_control(msg_envelope)) {
+                            if (coalescer.add(reply_to->second, msg_envelope, timing)) {
+                                publish(reply_to->second, coalescer.take(reply_to->second));
+                            }
+                        } else {
+                            publish(reply_to != msg_envelope.metadata().end() ? reply_to->second : "reply_" + message_id,
+                                    acks.encode_response(msg_envelope, timing));
                         }
-                        
-                        redisReply *pub = (redisReply*)redisCommand(c_pub, "PUBLISH %s %b", 
-                            reply_channel.c_str(), response_str.data(), response_str.size());
-                        if (pub) freeReplyObject(pub);
                     } else {
                         std::cerr << " [!] Failed to parse message" << std::endl;
                     }
@@ -103,8 +137,11 @@ int main(int argc, char* argv[]) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
             }
         }
+        coalescer.flush(publish);
     }
+    coalescer.flush(publish, true);
 
+    messaging::utils::flush_log();
     std::cout << " [x] Receiver " << receiver_id << " shutting down" << std::endl;
     redisFree(c_sub);
     redisFree(c_pub);
@@ -2,96 +2,129 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <future>
 #include <vector>
 #include <thread>
 #include <cstring>
+#include <memory>
+#include <algorithm>
+#include <functional>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/connection_pool.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "ack_demux.hpp"
+#include "stream_transport.hpp"
+#include "event_loop.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ConnectionPool;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
+using message_helpers::elapsed_ms_since;
 
-struct TaskResult {
-    bool success;
-    std::string message_id;
-    long long duration;
-    std::string error;
+// Pooled publisher/subscriber context pair
+struct RedisConnection {
+    redisContext *pub = nullptr;
+    redisContext *sub = nullptr;
+
+    ~RedisConnection() {
+        if (pub) redisFree(pub);
+        if (sub) redisFree(sub);
+    }
 };
 
-TaskResult send_message_task(const json& item) {
-    TaskResult res;
-    res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
-    
-    redisContext *c_pub = redisConnect("127.0.0.1", 6379);
-    redisContext *c_sub = redisConnect("127.0.0.1", 6379);
-    
-    if (!c_pub || c_pub->err || !c_sub || c_sub->err) {
-        res.error = "Connection failed";
-        if (c_pub) redisFree(c_pub);
-        if (c_sub) redisFree(c_sub);
-        return res;
+std::unique_ptr<RedisConnection> connect_redis() {
+    auto conn = std::make_unique<RedisConnection>();
+    conn->pub = redisConnect("127.0.0.1", 6379);
+    conn->sub = redisConnect("127.0.0.1", 6379);
+    if (!conn->pub || conn->pub->err || !conn->sub || conn->sub->err) {
+        return nullptr;
     }
-    
-    int target = item.value("target", 0);
-    std::string channel = "test_channel_" + std::to_string(target);
-    std::string reply_channel = "reply_" + res.message_id;
-    
-    // Subscribe to reply channel
-    redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", reply_channel.c_str());
-    if (sub) freeReplyObject(sub);
-    
-    // Send message
-    long long msg_start = get_current_time_ms();
-    MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-    (*envelope.mutable_metadata())["reply_to"] = reply_channel;
-    std::string body = message_helpers::serialize_envelope(envelope);
-    
-    // Publish with retry to handle race condition where subscriber isn't ready
-    int published_to = 0;
-    for (int retry = 0; retry < 5 && published_to == 0; ++retry) {
-        redisReply *pub = (redisReply*)redisCommand(c_pub, "PUBLISH %s %b", channel.c_str(), body.data(), body.size());
+    return conn;
+}
+
+// Leave the reply channel and drain anything still queued on the subscriber
+// (e.g. a late ACK) up to the unsubscribe confirmation, so the context can be reused
+bool unsubscribe_and_drain(redisContext *c_sub, const std::string& reply_channel) {
+    redisSetTimeout(c_sub, {1, 0});
+    if (redisAppendCommand(c_sub, "UNSUBSCRIBE %s", reply_channel.c_str()) != REDIS_OK) {
+        return false;
+    }
+    while (true) {
+        redisReply *reply = nullptr;
+        if (redisGetReply(c_sub, (void**)&reply) != REDIS_OK || !reply) {
+            return false;
+        }
+        bool confirmed = reply->type == REDIS_REPLY_ARRAY && reply->elements >= 1 &&
+                         reply->element[0]->type == REDIS_REPLY_STRING &&
+                         strcmp(reply->element[0]->str, "unsubscribe") == 0;
+        freeReplyObject(reply);
+        if (confirmed) {
+            return true;
+        }
+    }
+}
+
+/**
+ * Publish body for target (XADD it to the target's stream with streams) and
+ * wait up to timeout_ms on conn's subscriber, already on the reply channel,
+ * for a reply that satisfies accept; it is left in resp_envelope.
+ * publish_attempts > 1 re-publishes while no subscriber is listening yet.
+ */
+bool publish_and_wait(RedisConnection& conn, redis_streams::StreamPublisher* streams, int target,
+                      std::string_view body, int publish_attempts, long long timeout_ms,
+                      const std::function<bool(const MessageEnvelope&)>& accept, MessageEnvelope& resp_envelope) {
+    redisContext *c_pub = conn.pub;
+    redisContext *c_sub = conn.sub;
+    long long start_ns = get_steady_time_ns();
+
+    static const messaging::utils::TopicTable channels("test_channel_");
+    const std::string& channel = channels[target];
+    int published_to = streams && streams->send(c_pub, target, body) ? 1 : 0;
+    for (int retry = 0; !streams && retry < publish_attempts && published_to == 0; ++retry) {
+        redisReply *pub = (redisReply*)TRACED("send", redisCommand(c_pub, "PUBLISH %s %b", channel.c_str(), body.data(), body.size()));
         if (pub) {
             if (pub->type == REDIS_REPLY_INTEGER) {
                 published_to = (int)pub->integer;
             }
             freeReplyObject(pub);
         }
-        if (published_to == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        if (published_to == 0 && retry + 1 < publish_attempts) std::this_thread::sleep_for(std::chrono::milliseconds(2));
     }
-    
-    // Wait for ACK
-    long long timeout_ms = 80;
+
     struct timeval tv;
-    tv.tv_sec = 0;
-    tv.tv_usec = timeout_ms * 1000;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = timeout_ms % 1000 * 1000;
     redisSetTimeout(c_sub, tv);
-    
-    while ((get_current_time_ms() - msg_start) < timeout_ms) {
+
+    while (elapsed_ms_since(start_ns) < timeout_ms) {
         redisReply *reply = nullptr;
         int status = redisGetReply(c_sub, (void**)&reply);
-        
+
         if (status == REDIS_OK && reply) {
-            if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3) {
-                if (reply->element[0]->type == REDIS_REPLY_STRING && 
-                    strcmp(reply->element[0]->str, "message") == 0) {
-                    std::string reply_str(reply->element[2]->str, reply->element[2]->len);
-                    
-                    MessageEnvelope resp_envelope;
-                    if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-                        message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
-                        res.duration = get_current_time_ms() - msg_start;
-                        res.success = true;
-                        freeReplyObject(reply);
-                        break;
-                    }
-                }
-            }
+            bool matched = reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3 &&
+                           reply->element[0]->type == REDIS_REPLY_STRING &&
+                           strcmp(reply->element[0]->str, "message") == 0 &&
+                           message_helpers::parse_envelope(reply->element[2]->str, reply->element[2]->len, resp_envelope) &&
+                           accept(resp_envelope);
             freeReplyObject(reply);
+            if (matched) {
+                return true;
+            }
         } else if (status == REDIS_ERR) {
             if (c_sub->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
                 c_sub->err = 0;
@@ -100,14 +133,56 @@ TaskResult send_message_task(const json& item) {
             break;
         }
     }
+    return false;
+}
+
+TaskResult send_message_task(ConnectionPool<RedisConnection>& pool, const test_data_loader::EncodedCorpus& corpus, size_t i,
+                             int publish_attempts, const Attempt& attempt) {
+    TaskResult res;
+    res.success = false;
+    res.message_id = std::string(corpus.message_id(i));
+    res.duration_ns = 0;
+    
+    auto conn = pool.checkout(0);
+    if (!conn) {
+        res.error = "Connection failed";
+        return res;
+    }
+    redisContext *c_pub = conn->pub;
+    redisContext *c_sub = conn->sub;
     
-    // Unsubscribe
-    redisSetTimeout(c_sub, {1, 0});
-    redisReply *unsub = (redisReply*)redisCommand(c_sub, "UNSUBSCRIBE %s", reply_channel.c_str());
-    if (unsub) freeReplyObject(unsub);
+    int target = corpus.target(i);
+    std::string reply_channel = "reply_" + res.message_id;
     
-    redisFree(c_pub);
-    redisFree(c_sub);
+    // Subscribe to reply channel
+    redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", reply_channel.c_str());
+    if (!sub) {
+        res.error = "Subscribe failed";
+        conn.discard();
+        return res;
+    }
+    freeReplyObject(sub);
+    
+    // Send message
+    long long msg_start = get_steady_time_ns();
+    thread_local std::string body;  // per-worker encode buffer, reused across messages
+    corpus.encode(i, message_helpers::get_current_time_us(), reply_channel, body);
+    res.bytes = body.size();
+    
+    // Publish, retrying while the subscriber may not be ready, and wait 80ms (or the policy's timeout) for the ACK
+    MessageEnvelope resp_envelope;
+    if (publish_and_wait(*conn, nullptr, target, body, publish_attempts, attempt.timeout_ms(80),
+            [&](const MessageEnvelope& resp) { return message_helpers::is_valid_ack(resp, res.message_id); },
+            resp_envelope)) {
+        res.duration_ns = get_steady_time_ns() - msg_start;
+        res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
+        res.success = true;
+    }
+    
+    // Unsubscribe; a context left in an error state is closed rather than reused
+    if (c_sub->err || c_pub->err || !unsubscribe_and_drain(c_sub, reply_channel)) {
+        conn.discard();
+    }
     
     if (!res.success && res.error.empty()) {
         res.error = "Timeout";
@@ -116,40 +191,255 @@ TaskResult send_message_task(const json& item) {
     return res;
 }
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+/**
+ * Publish every message from this thread over one connection, pipelining
+ * PUBLISH commands with redisAppendCommand and keeping up to max_in_flight
+ * awaiting ACKs on the demux's shared reply channel; returns the peak in flight.
+ * With streams, messages are pipelined XADDs to each target's stream instead.
+ */
+int run_publish_pipeline(redisContext *c_pub, AckDemux& demux, redis_streams::StreamPublisher* streams,
+                         const test_data_loader::EncodedCorpus& corpus, int max_in_flight,
+                         const AsyncSendEngine::ResultFn& on_result, MessageStats& stats) {
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t burst = std::min<size_t>(window, 64);  // PUBLISHes written per round trip
+    size_t peak = 0;
+    std::vector<std::string> queued;  // ids whose PUBLISH reply hasn't been read yet
+    std::string body;
+    std::string channel;
+
+    // Read the PUBLISH/XADD replies for everything queued; no subscriber means no ACK is coming
+    auto read_publish_replies = [&]() {
+        bool ok = true;
+        for (const std::string& message_id : queued) {
+            redisReply *reply = nullptr;
+            if (!ok || redisGetReply(c_pub, (void**)&reply) != REDIS_OK || !reply) {
+                ok = false;
+                demux.fail(message_id, "Publish failed");
+                continue;
+            }
+            if (streams ? reply->type != REDIS_REPLY_STRING
+                        : reply->type != REDIS_REPLY_INTEGER || reply->integer == 0) {
+                demux.fail(message_id, streams ? "XADD failed" : "No subscriber");
+            }
+            freeReplyObject(reply);
+        }
+        queued.clear();
+        return ok;
+    };
+
+    size_t i = 0;
+    for (; i < corpus.size(); ++i) {
+        // Wait for room in the window, picking up whatever ACKs have arrived meanwhile
+        while (demux.in_flight() >= window) {
+            if (!queued.empty() && !read_publish_replies()) {
+                break;
+            }
+            demux.poll(10, on_result);
+        }
+        if (c_pub->err) {
+            break;
+        }
+
+        std::string message_id(corpus.message_id(i));
+        corpus.encode(i, message_helpers::get_current_time_us(), demux.channel(), body);
+
+        // Expect the ACK before publishing, so it can't arrive unmatched
+        demux.expect(message_id);
+        if (streams) {
+            // Creating a target's group is a blocking command, so collect queued replies first
+            if (!streams->prepared(corpus.target(i)) &&
+                ((!queued.empty() && !read_publish_replies()) || !streams->prepare(c_pub, corpus.target(i)))) {
+                demux.fail(message_id, "Connection failed");
+                ++i;
+                break;
+            }
+            TRACED("send", streams->append(c_pub, corpus.target(i), body));
+        } else {
+            channel.assign("test_channel_").append(std::to_string(corpus.target(i)));
+            TRACED("send", redisAppendCommand(c_pub, "PUBLISH %s %b", channel.c_str(), body.data(), body.size()));
+        }
+        queued.push_back(std::move(message_id));
+        stats.record_dispatch();
+        peak = std::max(peak, demux.in_flight());
+
+        if (queued.size() >= burst && !read_publish_replies()) {
+            ++i;
+            break;
+        }
+        demux.poll(0, on_result);
+    }
+    read_publish_replies();
+
+    // Messages never published once the connection broke
+    for (; i < corpus.size(); ++i) {
+        TaskResult res;
+        res.message_id = std::string(corpus.message_id(i));
+        res.error = "Connection failed";
+        on_result(res);
+    }
+    demux.drain_all(on_result);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    corpus.attach_compression(messaging::utils::CompressionOptions::from_args(argc, argv));
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    corpus.attach_qos(options.qos);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    bool use_pipeline = false;
+    bool use_streams = false;
+    bool use_event_loop = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--pipeline") == 0) {
+            use_pipeline = true;
+        } else if (std::strcmp(argv[i], "--streams") == 0) {
+            use_streams = true;  // always pipelined
+            use_pipeline = true;
+        } else if (std::strcmp(argv[i], "--event-loop") == 0) {
+            use_event_loop = true;  // Pub/Sub only; --streams takes precedence
+        }
+    }
+    use_event_loop = use_event_loop && !use_streams;
+    if (use_pipeline || use_event_loop) {
+        options.warn_ignored_by(use_streams ? "--streams" : use_event_loop ? "--event-loop" : "--pipeline");
+    }
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "Redis"},
         {"language", "C++"},
-        {"async", true}
+        {"async", true},
+        {"transport", use_streams ? "streams" : use_event_loop ? "event_loop" : use_pipeline ? "pipeline" : "pubsub"},
+        {"workers", use_pipeline || use_event_loop ? 1 : options.workers},
+        {"max_in_flight", options.max_in_flight}
     });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << std::endl;
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
-    std::vector<std::future<TaskResult>> futures;
-    for (auto& item : test_data) {
-        futures.push_back(std::async(std::launch::async, send_message_task, item));
+    // --wait-ready: PING every receiver before the clock starts; once all have answered,
+    // a PUBLISH that reaches no subscriber is a real failure and is not retried
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "redis-async-sender");
+    int publish_attempts = 5;
+    if (ready.options().enabled()) {
+        auto conn = connect_redis();
+        if (!conn) {
+            std::cerr << " [!] Could not connect to Redis" << std::endl;
+            return 1;
+        }
+        redis_streams::StreamPublisher stream_publisher;
+        MessageEnvelope pong;
+        bool all_ready = ready.wait(ReadyBarrier::targets_of(corpus),
+            [&](int target, const std::string& ping_id, std::string_view ping) -> const MessageEnvelope* {
+                std::string reply_channel = "reply_" + ping_id;
+                redisReply *sub = (redisReply*)redisCommand(conn->sub, "SUBSCRIBE %s", reply_channel.c_str());
+                if (!sub) {
+                    return nullptr;
+                }
+                freeReplyObject(sub);
+                bool replied = publish_and_wait(*conn, use_streams ? &stream_publisher : nullptr, target, ping, 1, 80,
+                    [&](const MessageEnvelope& resp) { return message_helpers::is_ready_reply(resp, ping_id); }, pong);
+                unsubscribe_and_drain(conn->sub, reply_channel);
+                return replied ? &pong : nullptr;
+            });
+        if (all_ready) {
+            publish_attempts = 1;
+        }
     }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("Redis");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
 
-    for (auto& fut : futures) {
-        TaskResult res = fut.get();
+    auto on_result = [&](const TaskResult& res) {
         if (res.success) {
-            stats.record_message(true, res.duration);
-            std::cout << " [OK] Message " << res.message_id << " acknowledged" << std::endl;
+            stats.record_message_ns(true, res.duration_ns);
+            stats.record_breakdown(res.ack_timing, res.duration_ns);
+            stats.record_bytes(res.bytes);
+            progress.add(0);
+            log_debug() << " [OK] Message " << res.message_id << " acknowledged";
         } else {
             stats.record_message(false);
-            std::cout << " [FAILED] Message " << res.message_id << ": " << res.error << std::endl;
+            progress.add(1);
+            log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+        }
+    };
+
+    if (use_event_loop) {
+        // Publishing and ACK matching on this thread, over two non-blocking connections
+        redis_events::EventSender sender(1000);  // 1s ACK timeout
+        if (!sender.start()) {
+            std::cerr << " [!] Could not connect to Redis" << std::endl;
+            return 1;
+        }
+        int peak = sender.run(corpus, options.max_in_flight, on_result, stats);
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", 2);
+        stats.add_metadata("event_loop", sender.report());
+    } else if (use_pipeline) {
+        // One publisher connection and one reply subscription for the whole run
+        AckDemux demux(1000);  // 1s ACK timeout
+        redisContext *c_pub = redisConnect("127.0.0.1", 6379);
+        if (!c_pub || c_pub->err || !demux.start()) {
+            std::cerr << " [!] Could not connect to Redis" << std::endl;
+            if (c_pub) redisFree(c_pub);
+            return 1;
         }
+        redis_streams::StreamPublisher stream_publisher;
+        int peak = run_publish_pipeline(c_pub, demux, use_streams ? &stream_publisher : nullptr,
+                                        corpus, options.max_in_flight, on_result, stats);
+        redisFree(c_pub);
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", 2);
+    } else {
+        ConnectionPool<RedisConnection> pool([](int) { return connect_redis(); });
+
+        AsyncSendEngine engine(options);
+        engine.run(corpus.size(),
+            [&](size_t i, const Attempt& attempt) {
+                if (attempt.number == 0) {
+                    stats.record_dispatch();
+                }
+                return send_message_task(pool, corpus, i, publish_attempts, attempt);
+            },
+            on_result);
+        stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+        if (options.open_loop()) {
+            stats.add_metadata("open_loop", engine.open_loop_report());
+        }
+        if (options.policy.enabled()) {
+            stats.add_metadata("request_policy", engine.policy_report());
+        }
+        if (options.qos.enabled()) {
+            stats.add_metadata("qos", options.qos.report(engine.retransmits()));
+        }
+        stats.add_metadata("connections_created", pool.created_count());
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    if (corpus.compressor()) {
+        stats.add_metadata("compression", corpus.compressor()->report());
+    }
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results (ASYNC):" << std::endl;
     std::cout << "total_sent: " << stats.sent_count << std::endl;
     std::cout << "total_received: " << stats.received_count << std::endl;
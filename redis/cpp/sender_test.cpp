@@ -4,62 +4,63 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <functional>
+#include <memory>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/batch_builder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "stream_transport.hpp"
 
 using json = nlohmann::json;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
+using message_helpers::elapsed_ms_since;
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+using messaging::utils::BatchOptions;
+using messaging::utils::BatchAccumulator;
+using messaging::utils::BatchBuilder;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::TaskResult;
 
-    MessageStats stats;
-    stats.set_metadata({
-        {"service", "Redis"},
-        {"language", "C++"},
-        {"async", false}
-    });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting transfer of " << test_data.size() << " messages..." << std::endl;
-
-    redisContext *c_pub = redisConnect("127.0.0.1", 6379);
-    redisContext *c_sub = redisConnect("127.0.0.1", 6379);
-
-    if (c_pub == NULL || c_pub->err || c_sub == NULL || c_sub->err) {
-        std::cerr << "Redis connection failed" << std::endl;
-        if (c_pub) redisFree(c_pub);
-        if (c_sub) redisFree(c_sub);
-        return 1;
-    }
-
-    // Set a moderate timeout for connecting and other ops
-    struct timeval tv_default = {1, 0};
-    redisSetTimeout(c_pub, tv_default);
-    redisSetTimeout(c_sub, tv_default);
+/**
+ * Publish body for target and wait up to 80ms for a reply on reply_channel that
+ * satisfies accept; the matching reply is left in resp_envelope. With streams,
+ * body is XADDed to the target's stream instead of published on its channel.
+ * retry_publish re-publishes while no subscriber is listening yet; it is off
+ * once the ready barrier has seen every receiver.
+ */
+bool request_reply(redisContext* c_pub, redisContext* c_sub, const struct timeval& tv_default,
+                   redis_streams::StreamPublisher* streams, int target,
+                   const std::string& reply_channel, std::string_view body,
+                   const std::function<bool(const MessageEnvelope&)>& accept, MessageEnvelope& resp_envelope,
+                   bool retry_publish = true) {
+    // Subscribe to reply channel
+    redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", reply_channel.c_str());
+    if (sub) freeReplyObject(sub);
+    
+    long long msg_start = get_steady_time_ns();
+    
+    // Streams retain the message until a receiver reads it, so there is no race to retry
+    static const messaging::utils::TopicTable channels("test_channel_");
+    const std::string& channel = channels[target];
+    {
+        TRACE_SCOPE("send");
+        int published_to = streams && streams->send(c_pub, target, body) ? 1 : 0;
 
-    for (auto& item : test_data) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
-        std::cout << " [x] Sending message " << message_id << "... " << std::flush;
-        
-        std::string channel = "test_channel_" + std::to_string(target);
-        std::string reply_channel = "reply_" + message_id;
-        
-        // Subscribe to reply channel
-        redisReply *sub = (redisReply*)redisCommand(c_sub, "SUBSCRIBE %s", reply_channel.c_str());
-        if (sub) freeReplyObject(sub);
-        
-        // Create and send message
-        long long msg_start = get_current_time_ms();
-        MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-        (*envelope.mutable_metadata())["reply_to"] = reply_channel;
-        std::string body = message_helpers::serialize_envelope(envelope);
-        
         // Publish with retry to handle race condition where subscriber isn't ready
-        int published_to = 0;
-        for (int retry = 0; retry < 5 && published_to == 0; ++retry) {
+        for (int retry = 0; !streams && retry < (retry_publish ? 5 : 1) && published_to == 0; ++retry) {
             redisReply *pub = (redisReply*)redisCommand(c_pub, "PUBLISH %s %b", channel.c_str(), body.data(), body.size());
             if (pub) {
                 if (pub->type == REDIS_REPLY_INTEGER) {
@@ -67,35 +68,32 @@ int main() {
                 }
                 freeReplyObject(pub);
             }
-            if (published_to == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (published_to == 0 && retry_publish) std::this_thread::sleep_for(std::chrono::milliseconds(2));
         }
-        
-        // Wait for ACK (with 40ms timeout)
-        bool got_ack = false;
-        long long timeout_ms = 80;
-        
-        // Set a timeout on the context for redisGetReply
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = timeout_ms * 1000;
-        redisSetTimeout(c_sub, tv);
-        
-        while (!got_ack && (get_current_time_ms() - msg_start) < timeout_ms) {
+    }
+    
+    // Wait for ACK (with 80ms timeout)
+    bool got_ack = false;
+    long long timeout_ms = 80;
+    
+    // Set a timeout on the context for redisGetReply
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = timeout_ms * 1000;
+    redisSetTimeout(c_sub, tv);
+    
+    {
+        TRACE_SCOPE("wait");
+        while (!got_ack && elapsed_ms_since(msg_start) < timeout_ms) {
             redisReply *reply = nullptr;
             int status = redisGetReply(c_sub, (void**)&reply);
-            
+
             if (status == REDIS_OK && reply) {
                 if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3) {
                     if (reply->element[0]->type == REDIS_REPLY_STRING && 
                         strcmp(reply->element[0]->str, "message") == 0) {
-                        std::string reply_str(reply->element[2]->str, reply->element[2]->len);
-                        
-                        MessageEnvelope resp_envelope;
-                        if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-                            message_helpers::is_valid_ack(resp_envelope, message_id)) {
-                            long long msg_duration = get_current_time_ms() - msg_start;
-                            stats.record_message(true, msg_duration);
-                            std::cout << " [OK]" << std::endl;
+                        if (message_helpers::parse_envelope(reply->element[2]->str, reply->element[2]->len, resp_envelope) && 
+                            accept(resp_envelope)) {
                             got_ack = true;
                         }
                     }
@@ -111,24 +109,219 @@ int main() {
                 break; // Exit waiting loop on error/timeout
             }
         }
-        
-        if (!got_ack) {
-            stats.record_message(false);
-            std::cout << " [FAILED]" << std::endl;
+    }
+    
+    // Unsubscribe from reply channel
+    // Reset timeout to something reasonable for unsubscribe
+    redisSetTimeout(c_sub, tv_default);
+    redisReply *unsub = (redisReply*)redisCommand(c_sub, "UNSUBSCRIBE %s", reply_channel.c_str());
+    if (unsub) freeReplyObject(unsub);
+    return got_ack;
+}
+
+// One sending thread's publish and subscribe connections; hiredis contexts are single-threaded
+struct Connections {
+    ~Connections() {
+        if (pub) redisFree(pub);
+        if (sub) redisFree(sub);
+    }
+
+    bool connect(const struct timeval& tv) {
+        pub = redisConnect("127.0.0.1", 6379);
+        sub = redisConnect("127.0.0.1", 6379);
+        if (pub == NULL || pub->err || sub == NULL || sub->err) {
+            return false;
+        }
+        redisSetTimeout(pub, tv);
+        redisSetTimeout(sub, tv);
+        connected = true;
+        return true;
+    }
+
+    redisContext *pub = nullptr;
+    redisContext *sub = nullptr;
+    redis_streams::StreamPublisher streams;
+    std::string body;  // reused per-message encode buffer
+    MessageEnvelope resp_envelope;
+    bool connected = false;
+};
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    corpus.attach_qos(qos);
+    corpus.attach_compression(messaging::utils::CompressionOptions::from_args(argc, argv));
+    BatchOptions batch_options = BatchOptions::from_args(argc, argv);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    if (batch_options.enabled()) {
+        partition_options.warn_ignored_by("--batch");
+        qos.warn_ignored_by("--batch");
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    bool use_streams = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--streams") == 0) {
+            use_streams = true;
+        }
+    }
+
+    MessageStats stats;
+    stats.set_metadata({
+        {"service", "Redis"},
+        {"language", "C++"},
+        {"async", false},
+        {"transport", use_streams ? "streams" : "pubsub"},
+        {"batch_size", batch_options.max_messages},
+        {"batch_linger_ms", batch_options.linger_ms},
+        {"partitions", batch_options.enabled() ? 1 : partition_options.partitions}
+    });
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
+
+    // Set a moderate timeout for connecting and other ops
+    struct timeval tv_default = {1, 0};
+    Connections main_conn;
+    if (!main_conn.connect(tv_default)) {
+        std::cerr << "Redis connection failed" << std::endl;
+        return 1;
+    }
+    redisContext *c_pub = main_conn.pub;
+    redisContext *c_sub = main_conn.sub;
+    redis_streams::StreamPublisher* streams = use_streams ? &main_conn.streams : nullptr;
+
+    // --wait-ready: PING every receiver before the clock starts; once all have answered,
+    // a PUBLISH that reaches no subscriber is a real failure and is not retried
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "redis-sender");
+    bool retry_publish = !(ready.options().enabled() &&
+        ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+            bool replied = request_reply(c_pub, c_sub, tv_default, streams, target, "reply_" + ping_id, ping,
+                [&](const MessageEnvelope& resp) { return message_helpers::is_ready_reply(resp, ping_id); },
+                main_conn.resp_envelope, false);
+            return replied ? &main_conn.resp_envelope : nullptr;
+        }));
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("Redis");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
+
+    MessageEnvelope& resp_envelope = main_conn.resp_envelope;
+    std::string& body = main_conn.body;
+    if (batch_options.enabled()) {
+        BatchAccumulator batches(batch_options);
+        auto flush = [&](BatchBuilder& batch) {
+            std::string reply_channel = "reply_batch_" + std::to_string(batch.batch_id());
+            std::string expected_id = "ack_batch_" + std::to_string(batch.batch_id());
+            
+            bool replied = request_reply(c_pub, c_sub, tv_default, streams, batch.target(), reply_channel,
+                batch.finish(reply_channel, body),
+                [&](const MessageEnvelope& resp) { return message_helpers::is_batch(resp) && resp.message_id() == expected_id; },
+                resp_envelope, retry_publish);
+            size_t acked = messaging::utils::record_batch(stats, batch, replied ? &resp_envelope : nullptr,
+                                                          get_steady_time_ns());
+            if (replied) {
+                log_debug() << " [x] Batch " << batch.batch_id() << " (" << batch.size() << " messages) to target "
+                            << batch.target() << " [OK] " << acked << "/" << batch.size() << " acknowledged";
+            } else {
+                log_info() << " [x] Batch " << batch.batch_id() << " to target " << batch.target() << " [FAILED]";
+            }
+            progress.add(0, acked);
+            progress.add(1, batch.size() - acked);
+        };
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            std::string_view envelope = corpus.stamp(i, message_helpers::get_current_time_us());
+            batches.add(corpus.target(i), envelope, corpus.message_id(i), get_steady_time_ns(), flush);
+            batches.flush_expired(get_steady_time_ns(), flush);
+        }
+        batches.flush_all(flush);
+    } else {
+        auto send_one = [&](Connections& conn, size_t i) {
+            TaskResult res;
+            res.message_id.assign(corpus.message_id(i));
+            int target = corpus.target(i);
+            std::string reply_channel = "reply_" + res.message_id;
+            
+            // Create and send message
+            long long msg_start = get_steady_time_ns();
+            corpus.encode(i, message_helpers::get_current_time_us(), reply_channel, conn.body);
+            
+            if (request_reply(conn.pub, conn.sub, tv_default, use_streams ? &conn.streams : nullptr, target,
+                    reply_channel, conn.body,
+                    [&](const MessageEnvelope& resp) { return message_helpers::is_valid_ack(resp, res.message_id); },
+                    conn.resp_envelope, retry_publish)) {
+                res.success = true;
+                res.duration_ns = get_steady_time_ns() - msg_start;
+                res.ack_timing = messaging::utils::AckTiming::of(conn.resp_envelope);
+                res.bytes = conn.body.size();
+                log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
+            } else {
+                log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED]";
+            }
+            return res;
+        };
+        // The first partition reuses the main connections; the others open their own
+        PartitionedSender sender(partition_options, qos);
+        sender.run(corpus.size(),
+            [&](size_t i) { return corpus.target(i); },
+            [&](size_t partition) {
+                std::unique_ptr<Connections> own;
+                if (partition > 0) {
+                    own = std::make_unique<Connections>();
+                    own->connect(tv_default);
+                }
+                return own;
+            },
+            [&](std::unique_ptr<Connections>& own, size_t i) {
+                if (own && !own->connected) {
+                    TaskResult res;
+                    res.message_id.assign(corpus.message_id(i));
+                    res.error = "Redis connection failed";
+                    return res;
+                }
+                return send_one(own ? *own : main_conn, i);
+            },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
+                } else {
+                    stats.record_message(false);
+                    progress.add(1);
+                }
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
-        
-        // Unsubscribe from reply channel
-        // Reset timeout to something reasonable for unsubscribe
-        redisSetTimeout(c_sub, tv_default);
-        redisReply *unsub = (redisReply*)redisCommand(c_sub, "UNSUBSCRIBE %s", reply_channel.c_str());
-        if (unsub) freeReplyObject(unsub);
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    if (corpus.compressor()) {
+        stats.add_metadata("compression", corpus.compressor()->report());
+    }
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results:" << std::endl;
     std::cout << "service: Redis" << std::endl;
     std::cout << "language: C++" << std::endl;
@@ -142,7 +335,5 @@ int main() {
         rf.close();
     }
 
-    redisFree(c_pub);
-    redisFree(c_sub);
     return 0;
 }
@@ -0,0 +1,268 @@
+#ifndef REDIS_STREAM_TRANSPORT_HPP
+#define REDIS_STREAM_TRANSPORT_HPP
+
+#include <hiredis/hiredis.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/ack_coalescer.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+
+/**
+ * Redis Streams transport: requests go to the stream "test_stream_<target>"
+ * instead of the Pub/Sub channel "test_channel_<target>".
+ *
+ * Unlike PUBLISH, XADD retains the message until a consumer group reads it,
+ * so nothing is lost if the receiver isn't reading yet; both ends create the
+ * group before using the stream. Receivers sharing a target join one consumer
+ * group and Redis load-balances entries across them. ACKs still go to the
+ * sender over Pub/Sub on the reply_to channel.
+ */
+namespace redis_streams {
+
+constexpr const char* kGroup = "receivers";
+constexpr const char* kBodyField = "body";
+constexpr int kMaxLen = 1000000;  // approximate per-stream cap, so old runs don't grow it forever
+
+inline std::string stream_key(int target) {
+    return "test_stream_" + std::to_string(target);
+}
+
+// Create the consumer group (and the stream) unless it already exists
+inline bool ensure_group(redisContext *c, const std::string& key) {
+    redisReply *reply = (redisReply*)redisCommand(c, "XGROUP CREATE %s %s $ MKSTREAM", key.c_str(), kGroup);
+    if (!reply) {
+        return false;
+    }
+    bool ok = reply->type != REDIS_REPLY_ERROR || std::strncmp(reply->str, "BUSYGROUP", 9) == 0;
+    freeReplyObject(reply);
+    return ok;
+}
+
+// Queue an XADD of body to key; the reply is read with redisGetReply like any pipelined command
+inline int append_xadd(redisContext *c, const std::string& key, std::string_view body) {
+    return redisAppendCommand(c, "XADD %s MAXLEN ~ %d * %s %b", key.c_str(), kMaxLen, kBodyField,
+                              body.data(), body.size());
+}
+
+/**
+ * XADD for a sender, creating each target's consumer group the first time it
+ * is used so entries are retained for receivers that haven't joined yet.
+ */
+class StreamPublisher {
+public:
+    bool prepared(int target) const { return groups_.count(target) > 0; }
+
+    // Create target's group once; blocking, so call it with no pipelined replies outstanding
+    bool prepare(redisContext *c, int target) {
+        if (!prepared(target)) {
+            if (!ensure_group(c, stream_key(target))) {
+                return false;
+            }
+            groups_.insert(target);
+        }
+        return true;
+    }
+
+    // Queue an XADD for a prepared target
+    bool append(redisContext *c, int target, std::string_view body) {
+        return append_xadd(c, keys_[target], body) == REDIS_OK;
+    }
+
+    // Blocking XADD; true when Redis returned an entry id
+    bool send(redisContext *c, int target, std::string_view body) {
+        if (!prepare(c, target) || !append(c, target, body)) {
+            return false;
+        }
+        redisReply *reply = nullptr;
+        if (redisGetReply(c, (void**)&reply) != REDIS_OK || !reply) {
+            return false;
+        }
+        bool ok = reply->type == REDIS_REPLY_STRING;
+        freeReplyObject(reply);
+        return ok;
+    }
+
+private:
+    std::set<int> groups_;
+    messaging::utils::TopicTable keys_{"test_stream_"};
+};
+
+/**
+ * Receiver side: reads up to count entries per XREADGROUP (blocking up to
+ * block_ms), then pipelines every ACK PUBLISH and one XACK for the whole read,
+ * so a busy receiver pays one round trip per batch rather than per message.
+ * Consumers are named per process, so several receivers can share one target.
+ * With coalescing enabled, the ACKs of one read that share a reply_to channel
+ * go out as one PUBLISH (up to max_acks each) instead of one per entry.
+ */
+class StreamReceiver {
+public:
+    StreamReceiver(int receiver_id, bool async, const messaging::utils::CoalesceOptions& coalesce = {},
+                   int count = 128, int block_ms = 1000)
+        : receiver_id_(std::to_string(receiver_id)), async_(async), coalesce_(coalesce), count_(count),
+          block_ms_(block_ms),
+          key_(stream_key(receiver_id)),
+          consumer_("receiver_" + receiver_id_ + "_" + std::to_string(::getpid())) {}
+
+    // Serve the stream until running turns false; returns non-zero if Redis is unreachable
+    int run(std::atomic<bool>& running) {
+        const char* tag = async_ ? " [x] [ASYNC] " : " [x] ";
+        redisContext *c_read = redisConnect("127.0.0.1", 6379);
+        redisContext *c_write = redisConnect("127.0.0.1", 6379);
+        if (!c_read || c_read->err || !c_write || c_write->err || !ensure_group(c_read, key_)) {
+            std::cerr << "Redis connection failed" << std::endl;
+            if (c_read) redisFree(c_read);
+            if (c_write) redisFree(c_write);
+            return 1;
+        }
+        std::cout << tag << "Receiver " << receiver_id_ << " reading stream " << key_
+                  << " as " << consumer_ << std::endl;
+        messaging::utils::LogSummary& progress = messaging::utils::AsyncLogger::global().summary(
+            std::string(async_ ? " [*] [ASYNC] " : " [*] ") + "Receiver " + receiver_id_, {"received"});
+
+        // BLOCK keeps the server from answering before block_ms; leave room on the socket
+        redisSetTimeout(c_read, {block_ms_ / 1000 + 1, 0});
+
+        MessageEnvelope request;
+        messaging::utils::AckEncoder acks(receiver_id_, async_);
+        messaging::utils::AckCoalescer coalescer(receiver_id_, coalesce_, async_);
+        std::string reply_channel;
+        std::vector<std::string> entry_ids;
+        size_t pipelined = 0;
+        auto publish = [&](const std::string& channel, std::string_view response) {
+            TRACE_SCOPE("reply");
+            append_publish(c_write, channel, response);
+            pipelined++;
+        };
+
+        while (running) {
+            redisReply *reply = (redisReply*)redisCommand(c_read,
+                "XREADGROUP GROUP %s %s COUNT %d BLOCK %d STREAMS %s >",
+                kGroup, consumer_.c_str(), count_, block_ms_, key_.c_str());
+            if (!reply) {
+                if (c_read->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
+                    c_read->err = 0;
+                    memset(c_read->errstr, 0, sizeof(c_read->errstr));
+                    continue;
+                }
+                std::cerr << " [!] Redis error: " << c_read->errstr << std::endl;
+                break;
+            }
+
+            // [[key, [[entry id, [field, value, ...]], ...]]], or nil when BLOCK timed out
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+            entry_ids.clear();
+            if (reply->type == REDIS_REPLY_ARRAY && reply->elements > 0 && reply->element[0]->elements >= 2) {
+                redisReply *entries = reply->element[0]->element[1];
+                for (size_t e = 0; e < entries->elements; ++e) {
+                    redisReply *entry = entries->element[e];
+                    if (entry->elements < 2) {
+                        continue;
+                    }
+                    entry_ids.emplace_back(entry->element[0]->str, entry->element[0]->len);
+                    redisReply *fields = entry->element[1];
+                    for (size_t f = 0; f + 1 < fields->elements; f += 2) {
+                        if (std::strcmp(fields->element[f]->str, kBodyField) == 0 &&
+                            message_helpers::parse_envelope(fields->element[f + 1]->str,
+                                                            fields->element[f + 1]->len, request)) {
+                            messaging::utils::log_debug() << tag << "Received message " << request.message_id();
+                            progress.add(0);
+                            auto reply_to = request.metadata().find("reply_to");
+                            if (coalesce_.enabled() && reply_to != request.metadata().end() &&
+                                !message_helpers::is_batch(request) && !message_helpers::is_control(request)) {
+                                if (coalescer.add(reply_to->second, request, timing)) {
+                                    publish(reply_to->second, coalescer.take(reply_to->second));
+                                }
+                            } else {
+                                append_response(c_write, request, timing, reply_channel, acks);
+                                pipelined++;
+                            }
+                        }
+                    }
+                }
+            }
+            freeReplyObject(reply);
+            // A read is already a batch, so nothing waits past it for more ACKs
+            coalescer.flush(publish, true);
+
+            if (!entry_ids.empty()) {
+                append_xack(c_write, entry_ids);
+                pipelined++;
+            }
+            if (!read_replies(c_write, pipelined)) {
+                std::cerr << " [!] Redis error: " << c_write->errstr << std::endl;
+                break;
+            }
+            pipelined = 0;
+        }
+
+        redisFree(c_read);
+        redisFree(c_write);
+        return 0;
+    }
+
+private:
+    // Queue the ACK PUBLISH for request on its reply_to channel; hiredis copies the bytes
+    void append_response(redisContext *c, const MessageEnvelope& request,
+                         const message_helpers::ReceiveTiming& timing, std::string& reply_channel,
+                         messaging::utils::AckEncoder& acks) {
+        std::string_view response = acks.encode_response(request, timing);
+
+        auto it = request.metadata().find("reply_to");
+        if (it != request.metadata().end()) {
+            reply_channel = it->second;
+        } else {
+            reply_channel.assign("reply_").append(request.message_id());
+        }
+        append_publish(c, reply_channel, response);
+    }
+
+    static void append_publish(redisContext *c, const std::string& channel, std::string_view response) {
+        redisAppendCommand(c, "PUBLISH %s %b", channel.c_str(), response.data(), response.size());
+    }
+
+    // Queue one XACK for every entry of a read
+    void append_xack(redisContext *c, const std::vector<std::string>& entry_ids) {
+        std::vector<const char*> argv = {"XACK", key_.c_str(), kGroup};
+        std::vector<size_t> argvlen = {4, key_.size(), std::strlen(kGroup)};
+        for (const auto& id : entry_ids) {
+            argv.push_back(id.data());
+            argvlen.push_back(id.size());
+        }
+        redisAppendCommandArgv(c, static_cast<int>(argv.size()), argv.data(), argvlen.data());
+    }
+
+    static bool read_replies(redisContext *c, size_t count) {
+        for (size_t k = 0; k < count; ++k) {
+            redisReply *reply = nullptr;
+            if (redisGetReply(c, (void**)&reply) != REDIS_OK || !reply) {
+                return false;
+            }
+            freeReplyObject(reply);
+        }
+        return true;
+    }
+
+    std::string receiver_id_;
+    bool async_;
+    messaging::utils::CoalesceOptions coalesce_;
+    int count_;
+    int block_ms_;
+    std::string key_;
+    std::string consumer_;
+};
+
+} // namespace redis_streams
+
+#endif // REDIS_STREAM_TRANSPORT_HPP
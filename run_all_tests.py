@@ -18,9 +18,10 @@ class Logger:
         self.terminal.flush()
         self.log.flush()
 
-def run_test(service, sender, py_receivers, cpp_receivers, report_file, logger, async_sender=False, async_receiver=False, num_messages=1000):
+def run_test(service, sender, py_receivers, cpp_receivers, report_file, logger, async_sender=False, async_receiver=False, num_messages=1000, payload=None):
     mode_str = f"S:{'A' if async_sender else 'N'}/R:{'A' if async_receiver else 'N'}"
-    print(f"[-] Running {service} {sender} ({mode_str}) -> {py_receivers} Py / {cpp_receivers} C++...")
+    payload_str = f" payload {payload}" if payload else ""
+    print(f"[-] Running {service} {sender} ({mode_str}){payload_str} -> {py_receivers} Py / {cpp_receivers} C++...")
     cmd = [
         "python3", "-u", "test_harness.py",
         "--service", service,
@@ -34,6 +35,8 @@ def run_test(service, sender, py_receivers, cpp_receivers, report_file, logger,
         cmd.append("--async-sender")
     if async_receiver:
         cmd.append("--async-receiver")
+    if payload:
+        cmd.extend(["--payload", payload])
     
     try:
         # Capture stdout/stderr and print/log in real-time if possible, 
@@ -59,14 +62,16 @@ def run_test(service, sender, py_receivers, cpp_receivers, report_file, logger,
 
 def main():
     parser = argparse.ArgumentParser(description="Run messaging service tests")
-    parser.add_argument("--service", type=str, help="Run tests for a specific service (e.g., zeromq, grpc, redis, rabbitmq, nats, activemq)")
+    parser.add_argument("--service", type=str, help="Run tests for a specific service (e.g., zeromq, grpc, redis, rabbitmq, nats, activemq, shm)")
     parser.add_argument("--all", action="store_true", help="Run all services (default behavior)")
     parser.add_argument("--messages", type=int, default=35, help="Number of messages to generate")
     parser.add_argument("--receivers", type=int, default=32, help="Number of receivers to generate data for")
+    parser.add_argument("--payloads", nargs="+", default=[None], metavar="SPEC",
+                        help="Payload-size sweep for the C++ sender, e.g. fixed:1k fixed:64k lognormal:16k:1.5")
     args = parser.parse_args()
     
-    all_services = ['grpc', 'zeromq', 'redis', 'rabbitmq', 'nats', 'activemq']
-    default_services = ['grpc', 'zeromq', 'redis', 'rabbitmq', 'nats']  # ActiveMQ excluded due to C++ async freeze issue
+    all_services = ['grpc', 'zeromq', 'redis', 'rabbitmq', 'nats', 'activemq', 'shm']
+    default_services = ['grpc', 'zeromq', 'redis', 'rabbitmq', 'nats', 'shm']  # ActiveMQ excluded due to C++ async freeze issue
     
     # Determine which services to run
     if args.service:
@@ -103,17 +108,22 @@ def main():
     for service in services:
         for sender in ['python', 'cpp']:
             for py, cpp in spreads:
+                # The shared-memory baseline has C++ senders and sync receivers only
+                if service == 'shm' and (sender != 'cpp' or py > 0):
+                    continue
                 for async_s in [False, True]:
-                    for async_r in [False, True]:
-                        scenarios.append((service, sender, py, cpp, async_s, async_r))
+                    for async_r in [False, True] if service != 'shm' else [False]:
+                        # The Python sender only sends the corpus as generated
+                        for payload in (args.payloads if sender == 'cpp' else [None]):
+                            scenarios.append((service, sender, py, cpp, async_s, async_r, payload))
 
     count = len(scenarios)
     print(f"Starting execution of {count} test scenarios...")
     start_time = time.time()
 
-    for i, (service, sender, py, cpp, async_s, async_r) in enumerate(scenarios):
+    for i, (service, sender, py, cpp, async_s, async_r, payload) in enumerate(scenarios):
         print(f"Scenario {i+1}/{count}")
-        run_test(service, sender, py, cpp, report_file, sys.stdout, async_s, async_r, args.messages)
+        run_test(service, sender, py, cpp, report_file, sys.stdout, async_s, async_r, args.messages, payload)
         # Small cooldown to ensure ports allow release if needed
         time.sleep(1) 
 
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <string>
+#include <signal.h>
+#include "../../utils/cpp/receiver.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+
+/**
+ * Receiver --id N on the shared-memory transport: creates the request ring
+ * shm_request_ring_name(N) and ACKs into each sender's reply ring. Ring
+ * geometry and waiting follow --ring-slots, --slot-bytes and --busy-poll-us.
+ */
+
+using messaging::utils::ShmReceiver;
+using messaging::utils::ShmRingOptions;
+
+ShmReceiver* receiver = nullptr;
+
+void signal_handler(int sig) {
+    if (receiver) {
+        receiver->stop();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    int id = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--id" && i + 1 < argc) {
+            id = std::stoi(argv[++i]);
+        }
+    }
+
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+
+    ShmReceiver shm_receiver(id, ShmRingOptions::from_args(argc, argv));
+    shm_receiver.configure_dedup(messaging::utils::DedupOptions::from_args(argc, argv));
+    receiver = &shm_receiver;
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    shm_receiver.run();
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
+#include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "shm_endpoint.hpp"
+
+using json = nlohmann::json;
+using messaging::MessageEnvelope;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::ShmRingOptions;
+using message_helpers::get_steady_time_ns;
+
+/**
+ * One blocking exchange on the calling worker's own endpoint, created on its
+ * first message. Every attempt, first or not, encodes a private copy: the
+ * request has to name this worker's reply ring anyway.
+ */
+TaskResult send_message_task(const ShmRingOptions& ring_options, test_data_loader::EncodedCorpus& corpus, size_t i,
+                             const Attempt& attempt) {
+    TaskResult res;
+    res.message_id = std::string(corpus.message_id(i));
+    int target = corpus.target(i);
+
+    thread_local std::unique_ptr<ShmEndpoint> endpoint;
+    thread_local std::string body;
+    try {
+        if (!endpoint) {
+            endpoint = std::make_unique<ShmEndpoint>(ring_options);
+        }
+    } catch (const std::exception& e) {
+        res.error = e.what();
+        return res;
+    }
+
+    long long msg_start = get_steady_time_ns();
+    corpus.encode(i, message_helpers::get_current_time_us(), endpoint->reply_to(), body);
+    res.bytes = body.size();
+    const MessageEnvelope* reply = TRACED("request", endpoint->exchange(target, body, attempt.timeout_ms(100),
+        [&](const MessageEnvelope& r) { return message_helpers::is_valid_ack(r, res.message_id); }));
+    if (reply) {
+        res.duration_ns = get_steady_time_ns() - msg_start;
+        res.ack_timing = messaging::utils::AckTiming::of(*reply);
+        res.success = true;
+    } else {
+        res.error = endpoint->error();
+    }
+    return res;
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    corpus.attach_qos(options.qos);
+    ShmRingOptions ring_options = ShmRingOptions::from_args(argc, argv);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    MessageStats stats;
+    stats.set_metadata({
+        {"service", "SharedMemory"},
+        {"language", "C++"},
+        {"async", true},
+        {"workers", options.workers},
+        {"max_in_flight", options.max_in_flight},
+        {"busy_poll_us", ring_options.busy_poll_us}
+    });
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
+
+    // --wait-ready: PING every receiver's ring before the clock starts, from a throwaway endpoint
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "shm-async-sender");
+    if (ready.options().enabled()) {
+        try {
+            ShmEndpoint endpoint(ring_options);
+            ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+                return endpoint.exchange(target, endpoint.with_reply_to(ping), 100, [&](const MessageEnvelope& reply) {
+                    return message_helpers::is_ready_reply(reply, ping_id);
+                });
+            });
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to create reply ring: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("SharedMemory");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
+
+    AsyncSendEngine engine(options);
+    engine.run(corpus.size(),
+        [&](size_t i, const Attempt& attempt) {
+            if (attempt.number == 0) {
+                stats.record_dispatch();
+            }
+            return send_message_task(ring_options, corpus, i, attempt);
+        },
+        [&](const TaskResult& res) {
+            if (res.success) {
+                stats.record_message_ns(true, res.duration_ns);
+                stats.record_breakdown(res.ack_timing, res.duration_ns);
+                stats.record_bytes(res.bytes);
+                progress.add(0);
+                log_debug() << " [OK] Message " << res.message_id << " acknowledged";
+            } else {
+                stats.record_message(false);
+                progress.add(1);
+                log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+            }
+        });
+    stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+    if (options.open_loop()) {
+        stats.add_metadata("open_loop", engine.open_loop_report());
+    }
+    if (options.policy.enabled()) {
+        stats.add_metadata("request_policy", engine.policy_report());
+    }
+    if (options.qos.enabled()) {
+        stats.add_metadata("qos", options.qos.report(engine.retransmits()));
+    }
+
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
+
+    json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
+
+    messaging::utils::flush_log();
+    std::cout << "\nTest Results (ASYNC):" << std::endl;
+    std::cout << "total_sent: " << stats.sent_count << std::endl;
+    std::cout << "total_received: " << stats.received_count << std::endl;
+    std::cout << "duration_ms: " << stats.get_duration_ms() << std::endl;
+
+    std::ofstream rf("logs/report.txt", std::ios::app);
+    if (rf.good()) {
+        rf << report.dump() << std::endl;
+        rf.close();
+    }
+
+    return 0;
+}
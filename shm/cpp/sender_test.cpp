@@ -0,0 +1,157 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
+#include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "shm_endpoint.hpp"
+
+using json = nlohmann::json;
+using messaging::MessageEnvelope;
+using message_helpers::get_steady_time_ns;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using messaging::utils::ShmRingOptions;
+using messaging::utils::TaskResult;
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    corpus.attach_qos(qos);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    ShmRingOptions ring_options = ShmRingOptions::from_args(argc, argv);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    MessageStats stats;
+    stats.set_metadata({
+        {"service", "SharedMemory"},
+        {"language", "C++"},
+        {"async", false},
+        {"partitions", partition_options.partitions},
+        {"busy_poll_us", ring_options.busy_poll_us}
+    });
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
+
+    std::unique_ptr<ShmEndpoint> endpoint;
+    try {
+        endpoint = std::make_unique<ShmEndpoint>(ring_options);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create reply ring: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // --wait-ready: PING every receiver's ring before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "shm-sender");
+    ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view ping) {
+        return endpoint->exchange(target, endpoint->with_reply_to(ping), 100, [&](const MessageEnvelope& reply) {
+            return message_helpers::is_ready_reply(reply, ping_id);
+        });
+    });
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("SharedMemory");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
+
+    auto send_one = [&](ShmEndpoint& ep, size_t i) {
+        TaskResult res;
+        res.message_id.assign(corpus.message_id(i));
+        int target = corpus.target(i);
+        long long msg_start = get_steady_time_ns();
+
+        // Each request names this thread's reply ring, so it is encoded into a per-thread copy
+        thread_local std::string body;
+        corpus.encode(i, message_helpers::get_current_time_us(), ep.reply_to(), body);
+
+        const MessageEnvelope* reply = TRACED("request", ep.exchange(target, body, 100, [&](const MessageEnvelope& r) {
+            return message_helpers::is_valid_ack(r, res.message_id);
+        }));
+        if (reply) {
+            res.success = true;
+            res.duration_ns = get_steady_time_ns() - msg_start;
+            res.ack_timing = messaging::utils::AckTiming::of(*reply);
+            res.bytes = body.size();
+            log_debug() << " [x] Message " << res.message_id << " to target " << target << " [OK]";
+        } else {
+            res.error = ep.error();
+            log_info() << " [x] Message " << res.message_id << " to target " << target << " [FAILED] "
+                       << res.error;
+        }
+        return res;
+    };
+
+    // The first partition reuses the main endpoint; the others create their own reply rings
+    PartitionedSender sender(partition_options, qos);
+    sender.run(corpus.size(),
+        [&](size_t i) { return corpus.target(i); },
+        [&](size_t partition) -> std::unique_ptr<ShmEndpoint> {
+            return partition > 0 ? std::make_unique<ShmEndpoint>(ring_options) : nullptr;
+        },
+        [&](std::unique_ptr<ShmEndpoint>& own, size_t i) {
+            return send_one(own ? *own : *endpoint, i);
+        },
+        [&](const TaskResult& res) {
+            if (res.success) {
+                stats.record_message_ns(true, res.duration_ns);
+                stats.record_breakdown(res.ack_timing, res.duration_ns);
+                stats.record_bytes(res.bytes);
+                progress.add(0);
+            } else {
+                stats.record_message(false);
+                progress.add(1);
+            }
+        });
+    if (partition_options.enabled()) {
+        stats.add_metadata("partitioning", sender.report());
+    }
+    if (qos.enabled()) {
+        stats.add_metadata("qos", qos.report(sender.retransmits()));
+    }
+
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
+
+    json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
+
+    messaging::utils::flush_log();
+    std::cout << "\nTest Results:" << std::endl;
+    std::cout << "service: SharedMemory" << std::endl;
+    std::cout << "language: C++" << std::endl;
+    std::cout << "total_sent: " << stats.sent_count << std::endl;
+    std::cout << "total_received: " << stats.received_count << std::endl;
+    std::cout << "duration_ms: " << stats.get_duration_ms() << std::endl;
+
+    std::ofstream rf("logs/report.txt", std::ios::app);
+    if (rf.good()) {
+        rf << report.dump() << std::endl;
+        rf.close();
+    }
+
+    return 0;
+}
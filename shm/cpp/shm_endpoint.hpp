@@ -0,0 +1,105 @@
+#ifndef SHM_ENDPOINT_HPP
+#define SHM_ENDPOINT_HPP
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory>
+#include <exception>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/shm_ring.hpp"
+
+/**
+ * One sending thread's end of the shared-memory transport: a reply ring of
+ * its own and the request ring of every receiver it has sent to, mapped on
+ * first use. Requests must carry reply_to() in their metadata; exchange()
+ * pushes one and waits for the reply that accept() recognises, skipping late
+ * replies to earlier requests that already timed out.
+ *
+ * Single-threaded, like the ring's reader side: one endpoint per thread.
+ */
+class ShmEndpoint {
+public:
+    // How long a request may wait for room in a full request ring
+    static constexpr int kPushTimeoutMs = 100;
+
+    explicit ShmEndpoint(const messaging::utils::ShmRingOptions& options)
+        : replies_(messaging::utils::ShmRing::create(messaging::utils::shm_reply_ring_name(),
+                                                     options.for_replies())) {}
+
+    ShmEndpoint(const ShmEndpoint&) = delete;
+    ShmEndpoint& operator=(const ShmEndpoint&) = delete;
+
+    // Name of the reply ring, for the requests' reply_to metadata
+    const std::string& reply_to() const { return replies_->name(); }
+
+    // Why the last exchange() returned nullptr
+    const std::string& error() const { return error_; }
+
+    /**
+     * Push body into target's request ring and wait up to timeout_ms for a
+     * reply accepted by accept(const MessageEnvelope&). Returns that reply,
+     * valid until the next exchange, or nullptr with error() set.
+     */
+    template <typename Accept>
+    const MessageEnvelope* exchange(int target, std::string_view body, int timeout_ms, Accept accept) {
+        messaging::utils::ShmRing* ring = ring_for(target);
+        if (!ring) {
+            return nullptr;
+        }
+        if (!ring->push(body.data(), body.size(), kPushTimeoutMs)) {
+            error_ = body.size() > ring->max_message_bytes() ? "Message larger than the receiver's ring"
+                                                             : "Receiver ring full";
+            return nullptr;
+        }
+        long long deadline_ns = message_helpers::get_steady_time_ns() + timeout_ms * 1000000LL;
+        while (true) {
+            long long remaining_ns = deadline_ns - message_helpers::get_steady_time_ns();
+            auto reply = remaining_ns > 0 ? replies_->read(static_cast<int>((remaining_ns + 999999) / 1000000))
+                                          : std::nullopt;
+            if (!reply) {
+                error_ = "Timeout";
+                return nullptr;
+            }
+            if (message_helpers::parse_envelope(reply->data(), reply->size(), reply_) && accept(reply_)) {
+                return &reply_;
+            }
+        }
+    }
+
+    /**
+     * A copy of body with reply_to() added to its metadata, for envelopes
+     * built elsewhere (the readiness PING); valid until the next call.
+     */
+    std::string_view with_reply_to(std::string_view body) {
+        MessageEnvelope envelope;
+        envelope.ParseFromArray(body.data(), static_cast<int>(body.size()));
+        (*envelope.mutable_metadata())["reply_to"] = reply_to();
+        envelope.SerializeToString(&rewritten_);
+        return rewritten_;
+    }
+
+private:
+    messaging::utils::ShmRing* ring_for(int target) {
+        auto it = rings_.find(target);
+        if (it == rings_.end()) {
+            try {
+                it = rings_.emplace(target, messaging::utils::ShmRing::open(
+                                                messaging::utils::shm_request_ring_name(target))).first;
+            } catch (const std::exception& e) {
+                // The receiver has not created its ring (yet); try again on the next send
+                error_ = e.what();
+                return nullptr;
+            }
+        }
+        return it->second.get();
+    }
+
+    std::unique_ptr<messaging::utils::ShmRing> replies_;
+    std::map<int, std::unique_ptr<messaging::utils::ShmRing>> rings_;
+    MessageEnvelope reply_;
+    std::string rewritten_;
+    std::string error_;
+};
+
+#endif // SHM_ENDPOINT_HPP
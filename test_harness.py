@@ -8,13 +8,26 @@ import subprocess
 import sys
 import os
 import json
+import re
 import time
 import argparse
 import signal
 from pathlib import Path
 
+
+def parse_cpu_list(text: str) -> list:
+    """CPUs from a list like '0-3,8' (argparse type for the placement flags)."""
+    cpus = []
+    try:
+        for part in text.split(','):
+            first, _, last = part.partition('-')
+            cpus.extend(range(int(first), int(last or first) + 1))
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"invalid CPU list '{text}'")
+    return cpus
+
 class TestHarness:
-    def __init__(self, service: str, sender_lang: str, py_receivers: int, cpp_receivers: int, async_sender: bool = False, async_receiver: bool = False, base_port: int = 50051):
+    def __init__(self, service: str, sender_lang: str, py_receivers: int, cpp_receivers: int, async_sender: bool = False, async_receiver: bool = False, base_port: int = 50051, receiver_workers: int = 1, payload: str = None, receiver_host: bool = False, host_threads: int = 0, coalesce_acks: int = 1, coalesce_us: int = 1000, stats_window_ms: int = 0, trace: bool = False, perf_counters: bool = False, sender_cpus: list = None, receiver_cpus: list = None, broker_cpus: list = None, pin_threads: bool = False, partitions: int = 1, adaptive_timeout: float = 0, retries: int = 0, hedge_after: float = 0, busy_poll_us: int = 0, compress: str = None, compress_threshold: int = 1024, compress_level: int = 0, compress_dict: bool = False, fanout: int = 0, hwm: int = 0, publish_rate: int = 0, work_queue: int = 0, work_threads: int = 2, overload: str = 'block', qos: str = 'at_most_once', max_retransmits: int = 3):
         self.service = service
         self.sender_lang = sender_lang
         self.py_receivers = py_receivers
@@ -22,6 +35,36 @@ class TestHarness:
         self.async_sender = async_sender
         self.async_receiver = async_receiver
         self.base_port = base_port
+        self.receiver_workers = receiver_workers
+        self.payload = payload
+        self.receiver_host = receiver_host
+        self.host_threads = host_threads
+        self.coalesce_acks = coalesce_acks
+        self.coalesce_us = coalesce_us
+        self.work_queue = work_queue
+        self.work_threads = work_threads
+        self.overload = overload
+        self.stats_window_ms = stats_window_ms
+        self.trace = trace
+        self.perf_counters = perf_counters
+        self.sender_cpus = sender_cpus or []
+        self.receiver_cpus = receiver_cpus or []
+        self.broker_cpus = broker_cpus or []
+        self.pin_threads = pin_threads
+        self.partitions = partitions
+        self.adaptive_timeout = adaptive_timeout
+        self.retries = retries
+        self.hedge_after = hedge_after
+        self.qos = qos
+        self.max_retransmits = max_retransmits
+        self.busy_poll_us = busy_poll_us
+        self.compress = compress
+        self.compress_threshold = compress_threshold
+        self.compress_level = compress_level
+        self.compress_dict = compress_dict
+        self.fanout = fanout
+        self.hwm = hwm
+        self.publish_rate = publish_rate
         self.receiver_procs = []
         self.sender_proc = None
         # Use resolve() to get absolute path, then get parent
@@ -35,7 +78,8 @@ class TestHarness:
             'zeromq': 'zeroMQ',
             'nats': 'nats',
             'grpc': 'grpc',
-            'activemq': 'activeMQ'
+            'activemq': 'activeMQ',
+            'shm': 'shm'
         }
         
         # Language subdirectory mapping for each service
@@ -45,7 +89,8 @@ class TestHarness:
             'zeromq': {'python': 'python', 'cpp': 'cpp'},
             'nats': {'python': 'python', 'cpp': 'cpp'},
             'grpc': {'python': 'python', 'cpp': 'cpp'},
-            'activemq': {'python': 'python-client', 'cpp': 'cpp-client'}
+            'activemq': {'python': 'python-client', 'cpp': 'cpp-client'},
+            'shm': {'cpp': 'cpp'}
         }
         
         # Consistent display names for reporting
@@ -55,7 +100,8 @@ class TestHarness:
             'zeromq': 'ZeroMQ',
             'nats': 'NATS',
             'grpc': 'gRPC',
-            'activemq': 'ActiveMQ'
+            'activemq': 'ActiveMQ',
+            'shm': 'SharedMemory'
         }
     
     @property
@@ -64,6 +110,28 @@ class TestHarness:
         
     def get_service_path(self) -> Path:
         return self.base_dir / self.service_dirs[self.service]
+
+    def receiver_cpu_list(self, receiver_id: int) -> list:
+        """One CPU per standalone receiver, round-robin over --receiver-cpus."""
+        if not self.receiver_cpus:
+            return []
+        return [self.receiver_cpus[receiver_id % len(self.receiver_cpus)]]
+
+    def cpu_args(self, cpus: list) -> list:
+        """--cpus for a C++ program, which also prefers its NUMA node and records the placement."""
+        if not cpus:
+            return []
+        args = ['--cpus', ','.join(str(cpu) for cpu in cpus)]
+        if self.pin_threads:
+            args.append('--pin-threads')
+        return args
+
+    @staticmethod
+    def pin_to(cpus: list):
+        """preexec_fn restricting a child (broker, Python program or C++ program) to cpus."""
+        if not cpus:
+            return None
+        return lambda: os.sched_setaffinity(0, cpus)
     
     def get_receiver_cmd(self, lang: str, receiver_id: int) -> list:
         service_path = self.get_service_path()
@@ -91,9 +159,23 @@ class TestHarness:
                 raise FileNotFoundError(f"Receiver C++ executable not found: {exe_path}")
             
             cmd = [str(exe_path), '--id', str(receiver_id)]
+            cmd.extend(self.cpu_args(self.receiver_cpu_list(receiver_id)))
             # Add base_port for gRPC
             if self.service == 'grpc':
                 cmd.extend(['--server-port', str(self.base_port)])
+            # C++ ZeroMQ receivers can fan out to worker threads, NATS async receivers to queue subscriptions
+            if self.service in ('zeromq', 'nats') and self.receiver_workers > 1:
+                cmd.extend(['--workers', str(self.receiver_workers)])
+            # C++ Redis and NATS receivers can answer many requests with one coalesced ACK
+            if self.service in ('redis', 'nats') and self.coalesce_acks > 1:
+                cmd.extend(['--coalesce-acks', str(self.coalesce_acks), '--coalesce-us', str(self.coalesce_us)])
+            # C++ ZeroMQ, Redis and gRPC receivers can queue requests for worker threads
+            if self.work_queue > 0:
+                cmd.extend(['--work-queue', str(self.work_queue), '--work-threads', str(self.work_threads),
+                            '--overload', self.overload])
+            cmd.extend(self.busy_poll_args())
+            cmd.extend(self.compression_args(sender=False))
+            cmd.extend(self.trace_args(f'receiver_{receiver_id}'))
             return cmd
     
     def get_sender_cmd(self) -> list:
@@ -115,6 +197,8 @@ class TestHarness:
             if self.service == 'grpc':
                 cmd.extend(['--base-port', str(self.base_port), '--num-receivers', str(self.total_receivers)])
             return cmd
+        elif self.fanout > 0:
+            return self.get_fanout_cmd(service_path / lang_dir)
         else:  # cpp
             exe_path = service_path / lang_dir / 'build' / 'bin' / script_name
             # Validate that the executable exists
@@ -125,8 +209,118 @@ class TestHarness:
             # Add base_port and num_receivers for gRPC
             if self.service == 'grpc':
                 cmd.extend(['--base-port', str(self.base_port), '--num-receivers', str(self.total_receivers)])
+            # Synthetic payload sizes are generated by the C++ senders only
+            if self.payload:
+                cmd.extend(['--payload', self.payload])
+            # Live stats: one StatsMessage per window, as JSON lines
+            if self.stats_window_ms > 0:
+                os.makedirs('logs/stats', exist_ok=True)
+                cmd.extend(['--stats-file', f'logs/stats/{self.service}_sender.jsonl',
+                            '--stats-window-ms', str(self.stats_window_ms)])
+            cmd.extend(self.trace_args('sender'))
+            cmd.extend(self.cpu_args(self.sender_cpus))
+            # Hardware counters around the timed region, reported as hw_counters in logs/report.txt
+            if self.perf_counters:
+                cmd.append('--perf-counters')
+            # Sync senders only: targets split across threads, each target still in order
+            if self.partitions > 1 and not self.async_sender:
+                cmd.extend(['--partitions', str(self.partitions)])
+            # Async senders only: request policy of the send engine
+            if self.async_sender:
+                if self.adaptive_timeout > 0:
+                    cmd.extend(['--adaptive-timeout', str(self.adaptive_timeout)])
+                if self.retries > 0:
+                    cmd.extend(['--retries', str(self.retries)])
+                if self.hedge_after > 0:
+                    cmd.extend(['--hedge-after', str(self.hedge_after)])
+            # Delivery guarantee: stamped into every envelope, with resends of unACKed messages
+            if self.qos != 'at_most_once':
+                cmd.extend(['--qos', self.qos, '--max-retransmits', str(self.max_retransmits)])
+            cmd.extend(self.busy_poll_args())
+            cmd.extend(self.compression_args(sender=True))
+            # Start the clock only once every receiver has answered a CONTROL PING
+            cmd.append('--wait-ready')
             return cmd
     
+    def get_fanout_cmd(self, cpp_dir: Path) -> list:
+        # One publisher and all K subscribers run inside fanout_bench; no receivers are spawned
+        exe_path = cpp_dir / 'build' / 'bin' / 'fanout_bench'
+        if not exe_path.exists():
+            raise FileNotFoundError(f"Fan-out C++ executable not found: {exe_path}")
+        cmd = [str(exe_path), '--subscribers', str(self.fanout)]
+        if self.hwm > 0:
+            cmd.extend(['--hwm', str(self.hwm)])
+        if self.publish_rate > 0:
+            cmd.extend(['--publish-rate', str(self.publish_rate)])
+        if self.payload:
+            cmd.extend(['--payload', self.payload])
+        cmd.extend(self.cpu_args(self.sender_cpus))
+        return cmd
+
+    def get_receiver_host_cmd(self, first_id: int, last_id: int) -> list:
+        service_path = self.get_service_path()
+        lang_dir = self.lang_dirs.get(self.service, {}).get('cpp', 'cpp')
+        exe_path = service_path / lang_dir / 'build' / 'bin' / 'receiver_host'
+        if not exe_path.exists():
+            raise FileNotFoundError(f"Receiver host executable not found: {exe_path}")
+        
+        cmd = [str(exe_path), '--ids', f'{first_id}-{last_id}']
+        if self.host_threads > 0:
+            cmd.extend(['--threads', str(self.host_threads)])
+        cmd.extend(self.busy_poll_args())
+        cmd.extend(self.compression_args(sender=False))
+        cmd.extend(self.trace_args(f'receivers_{first_id}-{last_id}'))
+        cmd.extend(self.cpu_args(self.receiver_cpus))
+        if self.perf_counters:
+            cmd.append('--perf-counters')
+        return cmd
+
+    def busy_poll_args(self) -> list:
+        """--busy-poll-us for the shared-memory programs: spin on an empty ring before sleeping on its futex."""
+        if self.service != 'shm' or self.busy_poll_us <= 0:
+            return []
+        return ['--busy-poll-us', str(self.busy_poll_us)]
+
+    def compression_args(self, sender: bool) -> list:
+        """--compress* for the C++ Redis/RabbitMQ programs; receivers need only the dictionary's path."""
+        if not self.compress:
+            return []
+        args = []
+        if self.compress_dict:
+            os.makedirs('logs/compression', exist_ok=True)
+            args = ['--compress-dict', os.path.abspath(f'logs/compression/{self.service}.dict')]
+        if sender:
+            args = ['--compress', self.compress, '--compress-threshold', str(self.compress_threshold),
+                    '--compress-level', str(self.compress_level)] + args
+        return args
+
+    def trace_args(self, role: str) -> list:
+        """--trace-file for a C++ program; needs binaries built with -DMESSAGING_TRACE."""
+        if not self.trace:
+            return []
+        os.makedirs('logs/trace', exist_ok=True)
+        return ['--trace-file', f'logs/trace/{self.service}_{role}.json']
+
+    def merge_traces(self):
+        """Combine the sender's and receivers' traces into one file for chrome://tracing or Perfetto."""
+        if not self.trace:
+            return
+        events = []
+        parts = sorted(Path('logs/trace').glob(f'{self.service}_*.json'))
+        merged_path = Path('logs/trace') / f'{self.service}_merged.json'
+        for part in parts:
+            if part == merged_path:
+                continue
+            try:
+                with open(part) as f:
+                    events.extend(json.load(f).get('traceEvents', []))
+            except (OSError, ValueError) as e:
+                print(f"  [!] Skipping trace {part}: {e}", flush=True)
+        if events:
+            with open(merged_path, 'w') as f:
+                json.dump({'displayTimeUnit': 'ns', 'traceEvents': events}, f)
+            print(f"[Harness] Trace with {len(events)} events written to {merged_path}", flush=True)
+    
     def spawn_receivers(self):
         mode_str = "ASYNC" if self.async_receiver else "SYNC"
         print(f"[Harness] Spawning {self.total_receivers} {mode_str} receivers ({self.py_receivers} Python, {self.cpp_receivers} C++)...", flush=True)
@@ -144,7 +338,8 @@ class TestHarness:
             log_suffix = "async" if self.async_receiver else "sync"
             log_filename = f'logs/receiver/{self.service}_python_{log_suffix}_receiver_{receiver_id}.log'
             log_file = open(log_filename, 'w')
-            proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT)
+            proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT,
+                                    preexec_fn=self.pin_to(self.receiver_cpu_list(receiver_id)))
             self.receiver_procs.append({
                 'proc': proc, 
                 'log_file': log_file, 
@@ -155,8 +350,27 @@ class TestHarness:
             print(f"  [+] Receiver {receiver_id} (Python) started, PID={proc.pid}", flush=True)
             receiver_id += 1
         
+        # Or run every C++ receiver in one receiver_host process
+        if self.receiver_host and self.cpp_receivers > 0:
+            first_id, last_id = receiver_id, receiver_id + self.cpp_receivers - 1
+            cmd = self.get_receiver_host_cmd(first_id, last_id)
+            log_filename = f'logs/receiver/{self.service}_cpp_host_receivers_{first_id}-{last_id}.log'
+            log_file = open(log_filename, 'w')
+            proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT,
+                                    preexec_fn=self.pin_to(self.receiver_cpus))
+            self.receiver_procs.append({
+                'proc': proc,
+                'log_file': log_file,
+                'log_path': log_filename,
+                'id': f'{first_id}-{last_id}',
+                'ids': list(range(first_id, last_id + 1)),
+                'lang': 'cpp'
+            })
+            print(f"  [+] Receivers {first_id}-{last_id} (C++ host) started, PID={proc.pid}", flush=True)
+            receiver_id = last_id + 1
+        
         # Spawn C++ receivers
-        for i in range(self.cpp_receivers):
+        for i in range(0 if self.receiver_host else self.cpp_receivers):
             try:
                 cmd = self.get_receiver_cmd('cpp', receiver_id)
             except FileNotFoundError as e:
@@ -166,7 +380,8 @@ class TestHarness:
             log_suffix = "async" if self.async_receiver else "sync"
             log_filename = f'logs/receiver/{self.service}_cpp_{log_suffix}_receiver_{receiver_id}.log'
             log_file = open(log_filename, 'w')
-            proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT)
+            proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT,
+                                    preexec_fn=self.pin_to(self.receiver_cpu_list(receiver_id)))
             self.receiver_procs.append({
                 'proc': proc, 
                 'log_file': log_file, 
@@ -177,8 +392,10 @@ class TestHarness:
             print(f"  [+] Receiver {receiver_id} (C++) started, PID={proc.pid}", flush=True)
             receiver_id += 1
         
-        # Give receivers time to start
-        time.sleep(4)
+        # C++ senders PING every receiver until it answers (--wait-ready), so only
+        # Python senders need a fixed head start for the receivers
+        if self.sender_lang != 'cpp':
+            time.sleep(4)
     
     def run_sender(self):
         mode_str = "ASYNC" if self.async_sender else "SYNC"
@@ -190,7 +407,8 @@ class TestHarness:
             print(f"[!] ERROR: {e}", flush=True)
             raise
         
-        self.sender_proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        self.sender_proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True,
+                                            preexec_fn=self.pin_to(self.sender_cpus))
         
         # Stream sender output
         for line in self.sender_proc.stdout:
@@ -234,6 +452,13 @@ class TestHarness:
             'cpp_receivers': self.cpp_receivers,
             'receiver_stats': []
         }
+        if self.sender_cpus or self.receiver_cpus or self.broker_cpus:
+            results['harness_placement'] = {
+                'sender_cpus': self.sender_cpus,
+                'receiver_cpus': self.receiver_cpus,
+                'broker_cpus': self.broker_cpus,
+                'pin_threads': self.pin_threads
+            }
         
         for rec in self.receiver_procs:
             receiver_id = rec['id']
@@ -242,11 +467,35 @@ class TestHarness:
             if os.path.exists(log_path):
                 with open(log_path, 'r') as f:
                     content = f.read()
-                    results['receiver_stats'].append({
+                if 'ids' in rec:
+                    # A receiver_host reports each of its receivers on its own shutdown line
+                    received = {int(m.group(1)): int(m.group(2))
+                                for m in re.finditer(r'Receiver (\d+) shutting down \(received (\d+) messages\)', content)}
+                    for hosted_id in rec['ids']:
+                        results['receiver_stats'].append({
+                            'id': hosted_id,
+                            'lang': lang,
+                            'host': receiver_id,
+                            'received': received.get(hosted_id)
+                        })
+                    counters = re.search(r'hw_counters=(\{.*\})', content)
+                    if counters:
+                        results['receiver_hw_counters'] = json.loads(counters.group(1))
+                else:
+                    entry = {
                         'id': receiver_id,
                         'lang': lang,
                         'log_size': len(content)
-                    })
+                    }
+                    # NATS async receivers: pending limits and slow-consumer drops
+                    delivery = re.search(r'delivery=(\{.*\})', content)
+                    if delivery:
+                        entry['delivery'] = json.loads(delivery.group(1))
+                    # --work-queue receivers: queue depth, blocked time and shed requests
+                    work_queue = re.search(r'work_queue=(\{.*\})', content)
+                    if work_queue:
+                        entry['work_queue'] = json.loads(work_queue.group(1))
+                    results['receiver_stats'].append(entry)
         
         return results
     
@@ -282,6 +531,15 @@ class TestHarness:
             # ZeroMQ uses P2P: receivers bind to ports directly, sender connects
             print(f"[Harness] ZeroMQ uses P2P - no central backend needed")
             return
+        elif self.service == 'shm':
+            # Shared memory: each receiver creates its own ring in /dev/shm
+            print(f"[Harness] Shared memory - no backend needed, receivers create their rings")
+            return
+        elif self.service == 'grpc' and self.fanout > 0:
+            # Fan-out goes through the server.cpp broker; its per-subscriber queue is the HWM
+            cmd = [str(service_path / 'cpp' / 'build' / 'bin' / 'server')]
+            if self.hwm > 0:
+                cmd.extend(['--queue-depth', str(self.hwm)])
         elif self.service == 'grpc':
             # gRPC uses P2P: receivers act as gRPC servers
             # Start receivers first (they bind to ports), then sender connects to them
@@ -292,7 +550,8 @@ class TestHarness:
 
         if cmd:
             log_file = open(f'logs/{self.service}_server.log', 'w')
-            self.server_proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT)
+            self.server_proc = subprocess.Popen(cmd, stdout=log_file, stderr=subprocess.STDOUT,
+                                                preexec_fn=self.pin_to(self.broker_cpus))
             print(f"  [+] Server started, PID={self.server_proc.pid}")
             time.sleep(5) # Wait for startup
 
@@ -320,9 +579,14 @@ class TestHarness:
             print(f"  [-] Server stopped")
 
     def run(self):
+        # Traces left by an earlier run would otherwise be merged into this one
+        if self.trace:
+            for stale in Path('logs/trace').glob(f'{self.service}_*.json'):
+                stale.unlink()
         try:
             self.start_server()
-            self.spawn_receivers()
+            if self.fanout == 0:
+                self.spawn_receivers()
             self.run_sender()
             results = self.aggregate_results()
             # Inject receiver metadata for generate_table.py
@@ -332,21 +596,79 @@ class TestHarness:
         finally:
             self.stop_receivers()
             self.stop_server()
+            self.merge_traces()
 
 
 def main():
     parser = argparse.ArgumentParser(description='Multi-Receiver Test Harness')
-    parser.add_argument('--service', required=True, choices=['redis', 'rabbitmq', 'zeromq', 'nats', 'grpc', 'activemq'])
+    parser.add_argument('--service', required=True, choices=['redis', 'rabbitmq', 'zeromq', 'nats', 'grpc', 'activemq', 'shm'])
     parser.add_argument('--sender', required=True, choices=['python', 'cpp'])
-    parser.add_argument('--py-receivers', type=int, default=16)
+    parser.add_argument('--py-receivers', type=int, help='Python receivers (default: 16, or 0 for shm, which has none)')
     parser.add_argument('--cpp-receivers', type=int, default=16)
     parser.add_argument('--async-sender', action='store_true', help='Use asynchronous sender')
     parser.add_argument('--async-receiver', action='store_true', help='Use asynchronous receiver')
     parser.add_argument('--report', help='File to append results to')
     parser.add_argument('--base-port', type=int, default=50051, help='Base port for services like gRPC')
     parser.add_argument('--messages', type=int, help='Number of messages to generate (optional)')
+    parser.add_argument('--receiver-workers', type=int, default=1, help='Worker threads per C++ ZeroMQ receiver, or queue subscriptions per C++ NATS async receiver')
+    parser.add_argument('--receiver-host', action='store_true', help='Run all C++ receivers in one receiver_host process')
+    parser.add_argument('--host-threads', type=int, default=0, help='Threads for --receiver-host (default: one per core)')
+    parser.add_argument('--coalesce-acks', type=int, default=1, help='ACKs per coalesced reply from C++ Redis/NATS receivers (needs --async-sender)')
+    parser.add_argument('--coalesce-us', type=int, default=1000, help='Longest a coalesced ACK waits for company, in microseconds')
+    parser.add_argument('--work-queue', type=int, default=0, help='C++ ZeroMQ, Redis and gRPC sync receivers: queue up to N requests for worker threads')
+    parser.add_argument('--work-threads', type=int, default=2, help='Worker threads behind each --work-queue')
+    parser.add_argument('--overload', choices=['block', 'shed'], default='block', help='What a full --work-queue does: stop reading, or drop the request')
+    parser.add_argument('--partitions', type=int, default=1, help='Threads for the C++ sync sender, each owning a share of the receivers and sending to them in order')
+    parser.add_argument('--adaptive-timeout', type=float, default=0, help='C++ async sender: reply timeout = K x observed p99 instead of the fixed one')
+    parser.add_argument('--retries', type=int, default=0, help='C++ async sender: retry failed requests up to N times, within a retry budget')
+    parser.add_argument('--hedge-after', type=float, default=0, help='C++ async sender: send a duplicate of requests unanswered after the observed pN latency')
+    parser.add_argument('--qos', choices=['at_most_once', 'at_least_once', 'exactly_once'], default='at_most_once', help='C++ sender: resend messages whose ACK times out; exactly_once receivers drop the redeliveries')
+    parser.add_argument('--max-retransmits', type=int, default=3, help='--qos: resends per message before it counts as failed')
+    parser.add_argument('--busy-poll-us', type=int, default=0, help='shm: spin N us on an empty ring before sleeping on its futex (sender and receivers)')
+    parser.add_argument('--perf-counters', action='store_true', help='Count cycles, instructions, LLC misses and context switches per message (C++ sender and --receiver-host)')
+    parser.add_argument('--sender-cpus', type=parse_cpu_list, help='CPUs for the sender, e.g. 0-3')
+    parser.add_argument('--receiver-cpus', type=parse_cpu_list, help='CPUs for receivers: one each round-robin, or all of them for --receiver-host')
+    parser.add_argument('--broker-cpus', type=parse_cpu_list, help='CPUs for the broker process the harness starts')
+    parser.add_argument('--pin-threads', action='store_true', help='Also pin each C++ worker/I-O thread to one CPU of its list')
+    parser.add_argument('--trace', action='store_true', help='Write per-stage C++ traces to logs/trace/ (build with CXXFLAGS=-DMESSAGING_TRACE)')
+    parser.add_argument('--stats-window-ms', type=int, default=0, help='Write live C++ sender stats every N ms to logs/stats/<service>_sender.jsonl')
+    parser.add_argument('--payload', help='Synthetic payload sizes for the C++ sender, e.g. fixed:1k, lognormal:16k:1.5, bimodal:1k:1m:0.05')
+    parser.add_argument('--compress', choices=['lz4', 'zstd'], help='Redis/RabbitMQ C++ sender: compress payloads; C++ receivers decompress them')
+    parser.add_argument('--compress-threshold', type=int, default=1024, help='Only compress payloads of at least N bytes')
+    parser.add_argument('--compress-level', type=int, default=0, help='zstd level or lz4 acceleration (default: the codec default)')
+    parser.add_argument('--compress-dict', action='store_true', help='zstd: train a dictionary on the corpus and share it with the receivers (small messages)')
+    parser.add_argument('--fanout', type=int, default=0, help='One-to-many run: publish to a topic with N C++ subscribers (fanout_bench) instead of request/reply')
+    parser.add_argument('--hwm', type=int, default=0, help='--fanout: per-subscriber queue limit (ZMQ HWM, NATS pending, RabbitMQ x-max-length, gRPC broker queue)')
+    parser.add_argument('--publish-rate', type=int, default=0, help='--fanout: publish at most N messages/s (default: as fast as possible)')
     
     args = parser.parse_args()
+    if args.py_receivers is None:
+        args.py_receivers = 0 if args.service == 'shm' else 16
+    if args.service == 'shm' and (args.sender != 'cpp' or args.py_receivers > 0 or args.async_receiver):
+        parser.error('--service shm has C++ programs only: use --sender cpp --py-receivers 0, without --async-receiver')
+    if args.busy_poll_us > 0 and args.service != 'shm':
+        parser.error('--busy-poll-us applies to --service shm only')
+    if args.compress and (args.service not in ('redis', 'rabbitmq') or args.sender != 'cpp'):
+        parser.error('--compress applies to --service redis or rabbitmq with --sender cpp')
+    if args.compress_dict and args.compress != 'zstd':
+        parser.error('--compress-dict needs --compress zstd')
+    if args.fanout > 0 and (args.service not in ('zeromq', 'nats', 'redis', 'rabbitmq', 'grpc') or args.sender != 'cpp'):
+        parser.error('--fanout applies to --service zeromq, nats, redis, rabbitmq or grpc with --sender cpp')
+    if (args.hwm > 0 or args.publish_rate > 0) and args.fanout == 0:
+        parser.error('--hwm and --publish-rate need --fanout')
+    if args.coalesce_acks > 1 and (args.sender != 'cpp' or not args.async_sender):
+        parser.error('--coalesce-acks needs --sender cpp --async-sender; other senders wait for, or only parse, one ACK per message')
+    if args.work_queue > 0 and (args.service not in ('zeromq', 'redis', 'grpc') or args.receiver_host or
+                                (args.async_receiver and args.service != 'zeromq')):
+        parser.error('--work-queue needs C++ ZeroMQ receivers, or sync C++ Redis/gRPC receivers, without --receiver-host')
+    if args.partitions > 1 and (args.sender != 'cpp' or args.async_sender):
+        parser.error('--partitions needs --sender cpp without --async-sender')
+    if (args.adaptive_timeout > 0 or args.retries > 0 or args.hedge_after > 0) and (args.sender != 'cpp' or not args.async_sender):
+        parser.error('--adaptive-timeout, --retries and --hedge-after need --sender cpp --async-sender')
+    if args.qos != 'at_most_once' and args.sender != 'cpp':
+        parser.error('--qos needs --sender cpp')
+    if args.qos == 'exactly_once' and (args.py_receivers > 0 or not (args.receiver_host or args.service == 'shm')):
+        parser.error('--qos exactly_once needs --py-receivers 0 and --receiver-host (or --service shm): only those receivers drop redeliveries')
     
     # Removed hardcoded receiver count check to allow dynamic sizing
     
@@ -366,7 +688,37 @@ def main():
         cpp_receivers=args.cpp_receivers,
         async_sender=args.async_sender,
         async_receiver=args.async_receiver,
-        base_port=args.base_port
+        base_port=args.base_port,
+        receiver_workers=args.receiver_workers,
+        payload=args.payload,
+        receiver_host=args.receiver_host,
+        host_threads=args.host_threads,
+        coalesce_acks=args.coalesce_acks,
+        coalesce_us=args.coalesce_us,
+        stats_window_ms=args.stats_window_ms,
+        trace=args.trace,
+        perf_counters=args.perf_counters,
+        sender_cpus=args.sender_cpus,
+        receiver_cpus=args.receiver_cpus,
+        broker_cpus=args.broker_cpus,
+        pin_threads=args.pin_threads,
+        partitions=args.partitions,
+        adaptive_timeout=args.adaptive_timeout,
+        retries=args.retries,
+        hedge_after=args.hedge_after,
+        busy_poll_us=args.busy_poll_us,
+        compress=args.compress,
+        compress_threshold=args.compress_threshold,
+        compress_level=args.compress_level,
+        compress_dict=args.compress_dict,
+        fanout=args.fanout,
+        hwm=args.hwm,
+        publish_rate=args.publish_rate,
+        work_queue=args.work_queue,
+        work_threads=args.work_threads,
+        overload=args.overload,
+        qos=args.qos,
+        max_retransmits=args.max_retransmits
     )
     
     results = harness.run()
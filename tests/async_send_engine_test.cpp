@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async_send_engine.hpp"
+
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::TaskResult;
+
+namespace {
+
+constexpr size_t kCorpus = 4;
+
+// A ramp over a corpus far smaller than what is in flight at its rates
+EngineOptions ramp_options() {
+    EngineOptions options;
+    options.workers = 16;
+    options.rate = 5000;
+    options.rate_step = 5000;
+    options.rate_max = 10000;
+    options.step_ms = 100;
+    return options;
+}
+
+/**
+ * Send function standing in for a broker sender: each index's message_id is
+ * fixed, as in the corpus, and the ids with an attempt out are tracked so an
+ * overlapping second attempt at the same index is caught.
+ */
+struct Tracker {
+    std::mutex mu;
+    std::set<std::string> in_flight;
+    int duplicates = 0;
+    std::vector<std::atomic<int>> per_index = std::vector<std::atomic<int>>(kCorpus);
+    std::atomic<int> max_per_index{0};
+    std::atomic<int> started_over_busy{0};   // a new message's first attempt while its index was out
+
+    TaskResult send(size_t index, const Attempt& attempt) {
+        std::string id = "msg-" + std::to_string(index);
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (!in_flight.insert(id).second) {
+                duplicates++;
+            }
+        }
+        int before = per_index[index]++;
+        if (attempt.number == 0 && before > 0) {
+            started_over_busy++;
+        }
+        int now = before + 1;
+        int seen = max_per_index.load();
+        while (now > seen && !max_per_index.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        per_index[index]--;
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            // Checked before erasing, so a duplicate's exit does not hide the first attempt's
+            in_flight.erase(id);
+        }
+        TaskResult result;
+        result.success = true;
+        result.message_id = id;
+        result.duration_ns = 1000000;
+        return result;
+    }
+};
+
+int64_t total_sent(const AsyncSendEngine& engine) {
+    int64_t sent = 0;
+    for (const auto& step : engine.steps()) {
+        sent += step.sent;
+    }
+    return sent;
+}
+
+} // namespace
+
+TEST(AsyncSendEngine, RampNeverHasAnIndexInFlightTwice) {
+    AsyncSendEngine engine(ramp_options());
+    Tracker tracker;
+    int64_t results = 0;
+    engine.run(kCorpus, [&](size_t i, const Attempt& attempt) { return tracker.send(i, attempt); },
+               [&](const TaskResult&) { results++; });
+
+    EXPECT_EQ(tracker.duplicates, 0);
+    EXPECT_EQ(tracker.max_per_index.load(), 1);
+    EXPECT_EQ(tracker.started_over_busy.load(), 0);
+    EXPECT_GT(engine.index_waits(), 0);
+    // Every scheduled message completes, including those that waited for an index
+    EXPECT_EQ(results, total_sent(engine));
+    EXPECT_GT(results, static_cast<int64_t>(kCorpus));
+}
+
+TEST(AsyncSendEngine, RampHedgesKeepIndicesExclusive) {
+    EngineOptions options = ramp_options();
+    options.policy.hedge_percentile = 10;
+    options.policy.retry_budget = 1;
+    AsyncSendEngine engine(options);
+    Tracker tracker;
+    int64_t results = 0;
+    engine.run(kCorpus, [&](size_t i, const Attempt& attempt) { return tracker.send(i, attempt); },
+               [&](const TaskResult&) { results++; });
+
+    // A hedge overlaps its own message's first attempt, never the next message on that index
+    EXPECT_GT(engine.policy_report()["hedges_sent"].get<int64_t>(), 0);
+    EXPECT_EQ(tracker.started_over_busy.load(), 0);
+    EXPECT_LE(tracker.max_per_index.load(), 2);
+    EXPECT_EQ(results, total_sent(engine));
+}
+
+TEST(EngineOptions, WarnsOnlyWhenEngineFlagsAreGiven) {
+    EngineOptions options;
+    EXPECT_FALSE(options.warn_ignored_by("--dealer"));
+    options.rate = 1000;
+    EXPECT_TRUE(options.warn_ignored_by("--dealer"));
+    options.rate = 0;
+    options.policy.retries = 2;
+    EXPECT_TRUE(options.warn_ignored_by("--dealer"));
+    options.policy.retries = 0;
+    options.qos.level = messaging::utils::QoSOptions::ExactlyOnce;
+    EXPECT_TRUE(options.warn_ignored_by("--dealer"));
+}
+
+TEST(AsyncSendEngine, QosRetransmitsFailuresOutsideTheRetryBudget) {
+    EngineOptions options;
+    options.workers = 2;
+    options.policy.retry_budget = 0;   // no tokens beyond the reserve for --retries
+    options.qos.level = messaging::utils::QoSOptions::AtLeastOnce;
+    options.qos.max_retransmits = 3;
+    AsyncSendEngine engine(options);
+    std::vector<std::atomic<int>> attempts(kCorpus);
+    int64_t acked = 0;
+    int64_t failed = 0;
+    // Index 0 never succeeds; every other index succeeds on its third attempt
+    engine.run(kCorpus,
+               [&](size_t i, const Attempt& attempt) {
+                   int n = attempts[i]++;
+                   EXPECT_EQ(attempt.number, n);
+                   TaskResult result;
+                   result.success = i != 0 && n == 2;
+                   result.error = result.success ? "" : "Timeout";
+                   return result;
+               },
+               [&](const TaskResult& result) { (result.success ? acked : failed)++; });
+
+    EXPECT_EQ(acked, static_cast<int64_t>(kCorpus - 1));
+    EXPECT_EQ(failed, 1);
+    EXPECT_EQ(attempts[0].load(), 1 + options.qos.max_retransmits);
+    EXPECT_EQ(attempts[1].load(), 3);
+    EXPECT_EQ(engine.retransmits(), options.qos.max_retransmits + 2 * static_cast<int64_t>(kCorpus - 1));
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "coroutine_loop.hpp"
+
+using messaging::utils::CoroSender;
+using messaging::utils::EventLoop;
+using messaging::utils::SendResult;
+using messaging::utils::Task;
+using messaging::utils::UnifiedSender;
+
+namespace {
+
+/**
+ * In-process backend for send_async: requests are recorded, and each poll
+ * ACKs them (or, with answering off, leaves them waiting) the way a broker
+ * reply read by _poll_replies would.
+ */
+class LoopbackSender : public UnifiedSender {
+public:
+    using Envelope = messaging::utils::MessageEnvelope;
+
+    bool answering = true;
+
+    LoopbackSender() : UnifiedSender("loopback") {}
+
+    bool connect() override { return true; }
+    void disconnect() override {}
+    bool _send_raw(const Envelope&) override { return true; }
+    std::optional<Envelope> _send_with_ack(const Envelope&, int) override { return std::nullopt; }
+
+    bool supports_async() const override { return true; }
+
+    bool _send_request(const Envelope& envelope) override {
+        sent_.emplace_back(envelope.message_seq, envelope.message_id);
+        return true;
+    }
+
+    void _poll_replies(int) override {
+        if (!answering) {
+            return;
+        }
+        std::vector<std::pair<uint64_t, std::string>> sent;
+        sent.swap(sent_);
+        for (const auto& request : sent) {
+            ::messaging::MessageEnvelope reply;
+            auto* ack = reply.mutable_ack();
+            ack->set_original_message_seq(request.first);
+            ack->set_original_message_id(request.second);
+            ack->set_received(true);
+            ack->set_receiver_id("loopback");
+            std::string wire = reply.SerializeAsString();
+            _deliver_reply(wire.data(), wire.size());
+        }
+    }
+
+private:
+    std::vector<std::pair<uint64_t, std::string>> sent_;
+};
+
+Task<> send_loop(CoroSender& sender, int count, std::vector<SendResult>& results) {
+    for (int i = 0; i < count; ++i) {
+        results.push_back(co_await sender.send(0, "payload " + std::to_string(i)));
+    }
+}
+
+Task<> stop_loop(EventLoop& loop) {
+    loop.stop();
+    co_return;
+}
+
+} // namespace
+
+TEST(CoroSender, SendLoopsCompleteOnOneThread) {
+    LoopbackSender backend;
+    EventLoop loop;
+    CoroSender sender(loop, backend);
+    std::vector<SendResult> results;
+    for (int t = 0; t < 4; ++t) {
+        loop.spawn(send_loop(sender, 25, results));
+    }
+    loop.run();
+
+    ASSERT_EQ(results.size(), 100u);
+    for (const SendResult& result : results) {
+        EXPECT_TRUE(result.success) << result.error;
+        EXPECT_EQ(result.receiver_id, "loopback");
+    }
+    EXPECT_EQ(loop.task_count(), 0u);
+    EXPECT_EQ(backend.pending_async(), 0u);
+}
+
+TEST(CoroSender, StopFailsOutstandingSendsAndDropsLateAcks) {
+    LoopbackSender backend;
+    backend.answering = false;
+    std::vector<SendResult> results;
+    {
+        EventLoop loop;
+        CoroSender sender(loop, backend);
+        loop.spawn(send_loop(sender, 1, results));
+        loop.spawn(send_loop(sender, 1, results));
+        loop.spawn(stop_loop(loop));
+        loop.run();
+
+        EXPECT_EQ(sender.pending(), 0u);
+        EXPECT_EQ(loop.task_count(), 0u);
+    }
+    ASSERT_EQ(results.size(), 2u);
+    for (const SendResult& result : results) {
+        EXPECT_FALSE(result.success);
+        EXPECT_NE(result.error.find("Cancelled"), std::string::npos) << result.error;
+    }
+
+    // The ACKs turn up after every frame and the CoroSender are gone; their callbacks must do nothing
+    ASSERT_EQ(backend.pending_async(), 2u);
+    backend.answering = true;
+    backend.poll_async(0);
+    EXPECT_EQ(backend.pending_async(), 0u);
+}
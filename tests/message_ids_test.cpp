@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "message_ids.hpp"
+#include "dedup_window.hpp"
+
+using namespace messaging::utils;
+
+namespace {
+
+::messaging::MessageEnvelope with_seq(uint64_t message_seq) {
+    ::messaging::MessageEnvelope message;
+    message.set_message_seq(message_seq);
+    message.set_message_id(format_message_id(message_seq));
+    return message;
+}
+
+} // namespace
+
+TEST(MessageIds, ComposeRoundTrips) {
+    uint64_t seq = compose_message_seq(0xdeadbeef, 42);
+    EXPECT_EQ(sender_of(seq), 0xdeadbeefu);
+    EXPECT_EQ(sequence_of(seq), 42u);
+    EXPECT_EQ(parse_message_id(format_message_id(seq)), seq);
+}
+
+TEST(MessageIds, SequenceOverflowCarriesIntoSenderId) {
+    uint64_t last = compose_message_seq(7, (1ULL << kSequenceBits) - 1);
+    uint64_t next = compose_message_seq(7, 1ULL << kSequenceBits);
+    EXPECT_EQ(sender_of(last), 7u);
+    EXPECT_EQ(sender_of(next), 8u);
+    EXPECT_EQ(sequence_of(next), 0u);
+    EXPECT_GT(next, last);
+}
+
+TEST(MessageIds, GeneratorsUseDistinctSenderIds) {
+    MessageIdGenerator a;
+    MessageIdGenerator b;
+    EXPECT_NE(a.sender_id(), b.sender_id());
+    EXPECT_NE(sender_of(a.next()), sender_of(b.next()));
+}
+
+// Senders that agree in their low 16 bits used to share one window and see each other's messages as duplicates
+TEST(DedupFilter, SendersSharingLowBitsKeepSeparateWindows) {
+    DedupFilter filter;
+    uint32_t first = 0x00011234;
+    uint32_t second = 0x00021234;
+    for (uint64_t i = 1; i <= 100; ++i) {
+        EXPECT_EQ(filter.check_and_mark(with_seq(compose_message_seq(first, i))), Seen::New);
+        EXPECT_EQ(filter.check_and_mark(with_seq(compose_message_seq(second, i))), Seen::New);
+    }
+    EXPECT_EQ(filter.check_and_mark(with_seq(compose_message_seq(first, 50))), Seen::Duplicate);
+    EXPECT_EQ(filter.report()["senders"], 2);
+}
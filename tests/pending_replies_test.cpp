@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pending_replies.hpp"
+
+using messaging::utils::AckTiming;
+using messaging::utils::PendingReplies;
+using messaging::utils::TaskResult;
+
+namespace {
+
+std::vector<TaskResult> drain(PendingReplies& replies) {
+    std::vector<TaskResult> results;
+    replies.drain_all([&](const TaskResult& res) { results.push_back(res); });
+    return results;
+}
+
+} // namespace
+
+TEST(PendingReplies, ReplyFromAnotherThreadCompletesOnThePollingThread) {
+    PendingReplies replies(1000);
+    replies.expect("m1");
+    std::thread reader([&]() { EXPECT_TRUE(replies.complete("m1", true, AckTiming())); });
+
+    std::vector<TaskResult> results = drain(replies);
+    reader.join();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(results[0].message_id, "m1");
+    EXPECT_GE(results[0].duration_ns, 0);
+    EXPECT_EQ(replies.in_flight(), 0u);
+}
+
+TEST(PendingReplies, InvalidReplyAndFailedSendAreReported) {
+    PendingReplies replies(1000);
+    replies.expect("bad");
+    replies.expect("unsent");
+    replies.complete("bad", false, AckTiming());
+    replies.fail("unsent", "Publish failed");
+
+    std::vector<TaskResult> results = drain(replies);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_FALSE(results[0].success);
+    EXPECT_EQ(results[0].error, "Invalid ACK");
+    EXPECT_EQ(results[1].error, "Publish failed");
+}
+
+TEST(PendingReplies, LateReplyAfterTimeoutIsDropped) {
+    PendingReplies replies(5);
+    replies.expect("slow");
+
+    std::vector<TaskResult> results = drain(replies);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].error, "Timeout");
+    EXPECT_FALSE(replies.complete("slow", true, AckTiming()));
+    EXPECT_FALSE(replies.take("slow").has_value());
+    EXPECT_EQ(replies.in_flight(), 0u);
+}
+
+TEST(PendingReplies, ResentRequestKeepsItsLaterDeadline) {
+    PendingReplies replies(40);
+    replies.expect("m1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    replies.expect("m1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // The first deadline has passed, but the re-send's has not
+    EXPECT_EQ(replies.poll(0, [](const TaskResult&) {}), 0u);
+    std::optional<TaskResult> res = replies.take("m1");
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res->message_id, "m1");
+    EXPECT_EQ(replies.in_flight(), 0u);
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+#include "request_policy.hpp"
+
+using messaging::utils::RequestPolicy;
+using messaging::utils::RequestPolicyOptions;
+
+namespace {
+
+RequestPolicyOptions adaptive_hedging() {
+    RequestPolicyOptions options;
+    options.timeout_k = 3;
+    options.hedge_percentile = 95;
+    return options;
+}
+
+} // namespace
+
+TEST(RequestPolicy, ReportOmitsDerivedValuesBeforeWarmUp) {
+    RequestPolicy policy(adaptive_hedging());
+    nlohmann::json report = policy.report();
+    EXPECT_EQ(report["samples"], 0);
+    EXPECT_FALSE(report.contains("final_hedge_delay_ms"));
+    EXPECT_FALSE(report.contains("observed_p99_ms"));
+    EXPECT_FALSE(report.contains("final_timeout_ms"));
+    EXPECT_EQ(policy.hedge_delay_ns(), -1);
+}
+
+TEST(RequestPolicy, ReportsDerivedValuesOnceWarmedUp) {
+    RequestPolicy policy(adaptive_hedging());
+    for (int i = 0; i < 256; ++i) {
+        policy.observe(2000000);   // 2 ms
+    }
+    nlohmann::json report = policy.report();
+    EXPECT_EQ(report["samples"], 256);
+    ASSERT_TRUE(report.contains("final_hedge_delay_ms"));
+    EXPECT_NEAR(report["final_hedge_delay_ms"].get<double>(), 2.0, 0.1);
+    EXPECT_NEAR(report["observed_p99_ms"].get<double>(), 2.0, 0.1);
+    EXPECT_EQ(report["final_timeout_ms"], 6);
+}
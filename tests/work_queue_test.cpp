@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "work_queue.hpp"
+
+using messaging::utils::ReplyQueue;
+using messaging::utils::WorkQueue;
+using messaging::utils::WorkQueueOptions;
+
+namespace {
+
+struct Job {
+    int id = -1;
+};
+
+/**
+ * A receiver's I/O thread in miniature: one thread submits a burst and is the
+ * only one draining replies, the way zeroMQ's QueuedReceiver owns its socket.
+ * Workers are slow, so the queue and the ReplyQueue both fill.
+ */
+struct Burst {
+    WorkQueue<Job> queue;
+    ReplyQueue<int> replies;
+    size_t written = 0;
+
+    explicit Burst(const WorkQueueOptions& options)
+        : queue(options, [this](Job& job, int) {
+              std::this_thread::sleep_for(std::chrono::microseconds(200));
+              replies.push(job.id);
+          }),
+          replies(queue.max_outstanding()) {}
+
+    void flush() {
+        if (replies.pending()) {
+            written += replies.drain([](int&) {});
+        }
+    }
+
+    // Submit count jobs, writing replies as the I/O loop does; returns how many were accepted
+    size_t run(int count) {
+        size_t accepted = 0;
+        for (int i = 0; i < count; ++i) {
+            Job job{i};
+            if (queue.submit(job, [this]() { flush(); })) {
+                accepted++;
+            }
+            flush();
+        }
+        queue.close();
+        flush();
+        return accepted;
+    }
+};
+
+WorkQueueOptions options(bool shed) {
+    WorkQueueOptions options;
+    options.capacity = 8;
+    options.workers = 2;
+    options.shed = shed;
+    return options;
+}
+
+} // namespace
+
+TEST(WorkQueue, BlockRepliesToEveryRequestInABurst) {
+    Burst burst(options(false));
+    const int count = 8 * static_cast<int>(burst.queue.max_outstanding());
+    EXPECT_EQ(burst.run(count), static_cast<size_t>(count));
+    EXPECT_EQ(burst.written, static_cast<size_t>(count));
+    EXPECT_EQ(burst.queue.report()["processed"], count);
+}
+
+TEST(WorkQueue, ShedRepliesToEveryAcceptedRequest) {
+    Burst burst(options(true));
+    const int count = 8 * static_cast<int>(burst.queue.max_outstanding());
+    size_t accepted = burst.run(count);
+    EXPECT_EQ(burst.written, accepted);
+    EXPECT_EQ(accepted + burst.queue.shed(), static_cast<size_t>(count));
+}
+
+TEST(BoundedQueue, RoundsUpAndRejectsWhenFull) {
+    messaging::utils::BoundedQueue<int> queue(5);
+    ASSERT_EQ(queue.capacity(), 8u);
+    for (int i = 0; i < 8; ++i) {
+        int value = i;
+        ASSERT_TRUE(queue.try_push(value));
+    }
+    int extra = 8;
+    EXPECT_FALSE(queue.try_push(extra));
+    int out = -1;
+    ASSERT_TRUE(queue.try_pop(out));
+    EXPECT_EQ(out, 0);
+    EXPECT_EQ(queue.size(), 7u);
+}
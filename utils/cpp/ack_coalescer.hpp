@@ -0,0 +1,182 @@
+#ifndef ACK_COALESCER_HPP
+#define ACK_COALESCER_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include "message_helpers.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * When a receiver coalesces ACKs bound for the same reply destination.
+ *
+ * max_acks     - ACKs per reply; 1 sends one ACK per message (the default)
+ * max_delay_us - send a partial reply once its oldest ACK has waited this long
+ *
+ * Coalesced ACKs only help senders with many requests in flight (the async
+ * senders); a sync sender waiting on each reply would wait max_delay_us per
+ * message, and reads the coalesced reply as a failed ACK.
+ */
+struct CoalesceOptions {
+    int max_acks = 1;
+    int max_delay_us = 1000;
+
+    bool enabled() const { return max_acks > 1; }
+
+    // Parse --coalesce-acks N and --coalesce-us N from the command line
+    static CoalesceOptions from_args(int argc, char* argv[]) {
+        CoalesceOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--coalesce-acks") == 0 && i + 1 < argc) {
+                options.max_acks = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--coalesce-us") == 0 && i + 1 < argc) {
+                options.max_delay_us = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Cumulative ACKs: many requests answered by one BatchResponse per reply destination.
+ *
+ * add() builds each request's Acknowledgment as usual (with its own timing)
+ * and queues it under its reply destination, such as a Redis reply_to channel
+ * or a NATS inbox prefix. A destination's ACKs go out together, in a BATCH
+ * envelope with message_id "acks_<receiver>_<n>", once max_acks are queued or
+ * the oldest has waited max_delay_us; the time spent waiting shows up in the
+ * sender's return leg. The sender resolves every listed request from the one
+ * reply (see coalesced_acks). Not thread-safe; owned by the receive loop.
+ *
+ *   AckCoalescer acks(std::to_string(receiver_id), options);
+ *   if (acks.add(reply_channel, request, timing)) publish(reply_channel, acks.take(reply_channel));
+ *   acks.flush([&](const std::string& channel, std::string_view reply) { publish(channel, reply); });
+ */
+class AckCoalescer {
+public:
+    AckCoalescer(const std::string& receiver_id, const CoalesceOptions& options, bool async = false)
+        : receiver_id_(receiver_id), options_(options), async_(async) {}
+
+    AckCoalescer(const AckCoalescer&) = delete;
+    AckCoalescer& operator=(const AckCoalescer&) = delete;
+
+    const CoalesceOptions& options() const { return options_; }
+
+    // Queue request's ACK for destination; true once destination has max_acks waiting
+    bool add(const std::string& destination, const MessageEnvelope& request,
+             const message_helpers::ReceiveTiming& timing) {
+        Group& group = groups_[destination];
+        if (group.response.acknowledgments_size() == 0) {
+            group.first_ns = message_helpers::get_steady_time_ns();
+            pending_groups_++;
+        }
+        message_helpers::fill_batch_ack(group.response.add_acknowledgments(), request, receiver_id_, timing);
+        pending_acks_++;
+        return group.response.acknowledgments_size() >= options_.max_acks;
+    }
+
+    /**
+     * Wire bytes of destination's queued ACKs as one reply, which are then
+     * forgotten. Valid until the next take() or flush().
+     */
+    std::string_view take(const std::string& destination) {
+        auto it = groups_.find(destination);
+        if (it == groups_.end() || it->second.response.acknowledgments_size() == 0) {
+            return {};
+        }
+        Group& group = it->second;
+        envelope_.Clear();
+        envelope_.set_message_id("acks_" + receiver_id_ + "_" + std::to_string(++replies_));
+        envelope_.set_type(messaging::MessageType::BATCH);
+        envelope_.set_async(async_);
+        long long now_us = message_helpers::get_current_time_us();
+        envelope_.set_timestamp(now_us / 1000);
+        envelope_.set_timestamp_us(now_us);
+        group.response.SerializeToString(envelope_.mutable_payload());
+
+        pending_acks_ -= group.response.acknowledgments_size();
+        pending_groups_--;
+        // Clear() keeps the Acknowledgment objects for the next round
+        group.response.Clear();
+        return message_helpers::serialize_envelope(envelope_, buffer_);
+    }
+
+    /**
+     * @brief Send every destination whose oldest ACK has waited max_delay_us.
+     * @param send Called as send(destination, bytes)
+     * @param all  Send every queued ACK regardless of age (shutdown, idle socket)
+     * @return Number of replies sent
+     */
+    template <typename Fn>
+    size_t flush(Fn send, bool all = false) {
+        if (pending_groups_ == 0) {
+            return 0;
+        }
+        long long due_ns = message_helpers::get_steady_time_ns() - options_.max_delay_us * 1000LL;
+        size_t sent = 0;
+        for (auto& [destination, group] : groups_) {
+            if (group.response.acknowledgments_size() > 0 && (all || group.first_ns <= due_ns)) {
+                send(destination, take(destination));
+                sent++;
+            }
+        }
+        return sent;
+    }
+
+    // Milliseconds until the oldest queued ACK is due, rounded up; -1 when none are queued
+    int next_due_ms() const {
+        if (pending_groups_ == 0) {
+            return -1;
+        }
+        long long oldest = message_helpers::get_steady_time_ns();
+        for (const auto& [destination, group] : groups_) {
+            if (group.response.acknowledgments_size() > 0) {
+                oldest = std::min(oldest, group.first_ns);
+            }
+        }
+        long long left_ns = oldest + options_.max_delay_us * 1000LL - message_helpers::get_steady_time_ns();
+        return left_ns <= 0 ? 0 : static_cast<int>((left_ns + 999999) / 1000000);
+    }
+
+    size_t pending() const { return pending_acks_; }
+    bool empty() const { return pending_acks_ == 0; }
+
+private:
+    struct Group {
+        messaging::BatchResponse response;
+        long long first_ns = 0;   // steady-clock time the oldest queued ACK was added
+    };
+
+    std::string receiver_id_;
+    CoalesceOptions options_;
+    bool async_;
+    std::unordered_map<std::string, Group> groups_;   // by reply destination
+    size_t pending_groups_ = 0;
+    size_t pending_acks_ = 0;
+    unsigned long long replies_ = 0;
+    MessageEnvelope envelope_;
+    std::string buffer_;
+};
+
+// True for a reply carrying coalesced ACKs from an AckCoalescer
+inline bool is_coalesced_ack(const MessageEnvelope& reply) {
+    return reply.type() == messaging::MessageType::BATCH && reply.message_id().compare(0, 5, "acks_") == 0;
+}
+
+/**
+ * Parse a coalesced reply into response; false if reply is not one. Each of
+ * response.acknowledgments() then resolves one outstanding request by
+ * original_message_id.
+ */
+inline bool coalesced_acks(const MessageEnvelope& reply, messaging::BatchResponse& response) {
+    return is_coalesced_ack(reply) && response.ParseFromString(reply.payload());
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // ACK_COALESCER_HPP
@@ -0,0 +1,225 @@
+#ifndef ACK_ENCODER_HPP
+#define ACK_ENCODER_HPP
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include "message_helpers.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Receiver-side ACK encoder: the parts of an ACK that never change are
+ * serialized once per receiver, and each reply is a copy of them plus the
+ * per-message fields written into a reused buffer.
+ *
+ * An ACK differs between messages only in its ids, target and timing, so
+ * everything else (type, async, received, receiver_id, status, status_code)
+ * is kept pre-encoded. The timing fields and original_message_seq sit in
+ * fixed-width slots after the constant bytes: fixed64 for the sequence and
+ * latency_ms, padded 10-byte varints for the timestamps, as in EncodedCorpus.
+ * Protobuf parsers accept fields in any order and padded varints, so the
+ * result parses to the same envelope fill_ack_for builds, a few dozen bytes
+ * larger. decompress_ns is only written for requests that were compressed
+ * (see payload_codec.hpp). encode_response() answers BATCH requests through
+ * create_batch_response and readiness PINGs through create_control_response
+ * instead.
+ *
+ *   AckEncoder acks(std::to_string(receiver_id));
+ *   std::string_view reply = acks.encode_response(request, timing);
+ */
+class AckEncoder {
+public:
+    explicit AckEncoder(const std::string& receiver_id, bool async = false)
+        : receiver_id_(receiver_id), async_(async) {
+        envelope_tail_.push_back(kTypeTag);
+        envelope_tail_.push_back(static_cast<char>(messaging::MessageType::ACK));
+        if (async) {
+            envelope_tail_.push_back(kAsyncTag);
+            envelope_tail_.push_back(1);
+        }
+
+        ack_tail_.push_back(kReceivedTag);
+        ack_tail_.push_back(1);
+        append_string(ack_tail_, kReceiverIdTag, receiver_id);
+        append_string(ack_tail_, kStatusTag, message_helpers::ack_status_name(messaging::ACK_STATUS_OK));
+        ack_tail_.push_back(kStatusCodeTag);
+        ack_tail_.push_back(static_cast<char>(messaging::ACK_STATUS_OK));
+        seq_slot_ = append_fixed64_slot(ack_tail_, kSeqTag);
+        latency_slot_ = append_fixed64_slot(ack_tail_, kLatencyTag);
+        received_at_slot_ = append_varint_slot(ack_tail_, kReceivedAtTag);
+        processing_slot_ = append_varint_slot(ack_tail_, kProcessingTag);
+        acked_at_slot_ = append_varint_slot(ack_tail_, kAckedAtTag);
+
+        append_varint_slot(timestamp_slots_, kTimestampTag);
+        append_varint_slot(timestamp_slots_, kTimestampUsTag);
+    }
+
+    AckEncoder(const AckEncoder&) = delete;
+    AckEncoder& operator=(const AckEncoder&) = delete;
+
+    /**
+     * Wire bytes of the ACK for request, with the receiver timing as
+     * fill_ack_for records it. Valid until the next encode().
+     */
+    std::string_view encode(const MessageEnvelope& request, const message_helpers::ReceiveTiming& timing) {
+        TRACE_SCOPE("encode_ack");
+        const std::string& id = request.message_id();
+        long long decompress_ns = message_helpers::take_decompress_ns();
+        size_t ack_size = (id.empty() ? 0 : 1 + varint_size(id.size()) + id.size()) + ack_tail_.size() +
+                          (decompress_ns > 0 ? 1 + varint_size(static_cast<uint64_t>(decompress_ns)) : 0);
+
+        // clear() keeps the capacity, so a steady-state encode does not allocate
+        buffer_.clear();
+        buffer_.push_back(kMessageIdTag);
+        append_varint(buffer_, id.size() + 4);
+        buffer_.append("ack_", 4).append(id);
+        if (request.target() != 0) {
+            buffer_.push_back(kTargetTag);
+            append_varint(buffer_, static_cast<uint64_t>(static_cast<int64_t>(request.target())));
+        }
+        buffer_.append(envelope_tail_);
+        buffer_.push_back(kAckTag);
+        append_varint(buffer_, ack_size);
+        if (!id.empty()) {
+            append_string(buffer_, kOriginalIdTag, id);
+        }
+        size_t tail = buffer_.size();
+        buffer_.append(ack_tail_);
+        if (decompress_ns > 0) {
+            buffer_.push_back(kDecompressTag);
+            append_varint(buffer_, static_cast<uint64_t>(decompress_ns));
+        }
+        size_t stamps = buffer_.size();
+        buffer_.append(timestamp_slots_);
+
+        long long sent_us = message_helpers::sent_at_us(request);
+        double latency_ms = sent_us > 0 ? (timing.received_at_us - sent_us) / 1000.0 : 0.0;
+        long long now_ns = message_helpers::get_steady_time_ns();
+        long long processing_ns = timing.received_ns > 0 ? now_ns - timing.received_ns : 0;
+        long long acked_at_us = timing.received_at_us + processing_ns / 1000;
+
+        uint64_t latency_bits;
+        std::memcpy(&latency_bits, &latency_ms, sizeof(latency_bits));
+        char* p = &buffer_[tail];
+        write_fixed64(p + seq_slot_, request.message_seq());
+        write_fixed64(p + latency_slot_, latency_bits);
+        write_padded_varint(p + received_at_slot_, static_cast<uint64_t>(timing.received_at_us));
+        write_padded_varint(p + processing_slot_, static_cast<uint64_t>(processing_ns));
+        write_padded_varint(p + acked_at_slot_, static_cast<uint64_t>(acked_at_us));
+        write_padded_varint(&buffer_[stamps] + 1, static_cast<uint64_t>(acked_at_us / 1000));
+        write_padded_varint(&buffer_[stamps] + kSlotSize + 1, static_cast<uint64_t>(acked_at_us));
+        return buffer_;
+    }
+
+    // As encode(), but a BATCH request gets its BatchResponse and a PING its PONG, serialized into the same buffer
+    std::string_view encode_response(const MessageEnvelope& request, const message_helpers::ReceiveTiming& timing) {
+        if (message_helpers::is_batch(request) || message_helpers::is_control(request)) {
+            MessageEnvelope response = message_helpers::create_response_for(request, receiver_id_, timing);
+            response.set_async(async_);
+            return message_helpers::serialize_envelope(response, buffer_);
+        }
+        return encode(request, timing);
+    }
+
+    // The last encode()'s bytes, for transports that take a std::string
+    const std::string& buffer() const { return buffer_; }
+
+private:
+    // Field number << 3 | wire type (0 = varint, 1 = fixed64, 2 = length-delimited)
+    static constexpr char kMessageIdTag = (1 << 3) | 2;
+    static constexpr char kTargetTag = (2 << 3) | 0;
+    static constexpr char kTypeTag = (4 << 3) | 0;
+    static constexpr char kAsyncTag = (6 << 3) | 0;
+    static constexpr char kTimestampTag = (7 << 3) | 0;
+    static constexpr char kAckTag = (11 << 3) | 2;
+    static constexpr char kTimestampUsTag = (12 << 3) | 0;
+
+    static constexpr char kOriginalIdTag = (1 << 3) | 2;
+    static constexpr char kReceivedTag = (2 << 3) | 0;
+    static constexpr char kLatencyTag = (3 << 3) | 1;
+    static constexpr char kReceiverIdTag = (4 << 3) | 2;
+    static constexpr char kStatusTag = (5 << 3) | 2;
+    static constexpr char kSeqTag = (6 << 3) | 1;
+    static constexpr char kStatusCodeTag = (7 << 3) | 0;
+    static constexpr char kReceivedAtTag = (8 << 3) | 0;
+    static constexpr char kProcessingTag = (9 << 3) | 0;
+    static constexpr char kAckedAtTag = (10 << 3) | 0;
+    static constexpr char kDecompressTag = (11 << 3) | 0;
+
+    static constexpr size_t kVarintSlot = 10;
+    static constexpr size_t kSlotSize = 1 + kVarintSlot;
+
+    static size_t varint_size(uint64_t value) {
+        size_t n = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            n++;
+        }
+        return n;
+    }
+
+    static void append_varint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static void append_string(std::string& out, char tag, std::string_view value) {
+        out.push_back(tag);
+        append_varint(out, value.size());
+        out.append(value.data(), value.size());
+    }
+
+    // Each returns the offset of the slot's value within out
+    static size_t append_fixed64_slot(std::string& out, char tag) {
+        out.push_back(tag);
+        size_t at = out.size();
+        out.append(8, '\0');
+        return at;
+    }
+
+    static size_t append_varint_slot(std::string& out, char tag) {
+        out.push_back(tag);
+        size_t at = out.size();
+        out.append(kVarintSlot - 1, static_cast<char>(0x80));
+        out.push_back(0);
+        return at;
+    }
+
+    static void write_fixed64(char* p, uint64_t value) {
+        for (int k = 0; k < 8; ++k) {
+            p[k] = static_cast<char>(value >> (8 * k));
+        }
+    }
+
+    // Padded to the full 10 bytes, so every value fits the reserved slot
+    static void write_padded_varint(char* p, uint64_t value) {
+        for (size_t k = 0; k < kVarintSlot - 1; ++k) {
+            p[k] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        p[kVarintSlot - 1] = static_cast<char>(value & 0x01);
+    }
+
+    std::string receiver_id_;
+    bool async_;
+    std::string envelope_tail_;     // type and async, between target and the ack
+    std::string ack_tail_;          // constant ack fields, then the timing slots
+    std::string timestamp_slots_;   // envelope timestamp and timestamp_us
+    size_t seq_slot_ = 0;
+    size_t latency_slot_ = 0;
+    size_t received_at_slot_ = 0;
+    size_t processing_slot_ = 0;
+    size_t acked_at_slot_ = 0;
+    std::string buffer_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // ACK_ENCODER_HPP
@@ -0,0 +1,441 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <initializer_list>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <charconv>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Per-run verbosity. Info (the default) keeps startup/shutdown lines,
+ * failures and the periodic summaries; Debug adds one line per message.
+ */
+enum class LogLevel : int {
+    Quiet = 0,
+    Error = 1,
+    Info = 2,
+    Debug = 3,
+};
+
+inline bool parse_log_level(const char* name, LogLevel& level) {
+    if (strcmp(name, "quiet") == 0) {
+        level = LogLevel::Quiet;
+    } else if (strcmp(name, "error") == 0) {
+        level = LogLevel::Error;
+    } else if (strcmp(name, "info") == 0) {
+        level = LogLevel::Info;
+    } else if (strcmp(name, "debug") == 0) {
+        level = LogLevel::Debug;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Named counters the logger's writer thread turns into one summary line per
+ * interval ("label: received=12000 (+3000/s)"), in place of a line per message.
+ * add() is a relaxed fetch_add, safe from any thread.
+ */
+class LogSummary {
+public:
+    static constexpr size_t kMaxFields = 4;
+
+    void add(size_t field, uint64_t n = 1) {
+        counts_[field].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t total(size_t field) const {
+        return counts_[field].load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class AsyncLogger;
+
+    LogSummary(std::string label, std::initializer_list<const char*> fields) : label_(std::move(label)) {
+        for (const char* field : fields) {
+            if (names_.size() < kMaxFields) {
+                names_.push_back(field);
+            }
+        }
+    }
+
+    // Writer thread only; false if nothing moved since the last line
+    bool format(std::string& out, double seconds, bool force) {
+        uint64_t now[kMaxFields];
+        bool changed = false;
+        for (size_t i = 0; i < names_.size(); ++i) {
+            now[i] = total(i);
+            changed = changed || now[i] != last_[i];
+        }
+        if (!changed && !force) {
+            return false;
+        }
+        out.append(label_).append(":");
+        char buf[32];
+        for (size_t i = 0; i < names_.size(); ++i) {
+            double rate = seconds > 0 ? static_cast<double>(now[i] - last_[i]) / seconds : 0.0;
+            int len = snprintf(buf, sizeof(buf), "%.0f", rate);
+            out.append(" ").append(names_[i]).append("=").append(std::to_string(now[i]))
+               .append(" (+").append(buf, len > 0 ? len : 0).append("/s)");
+            last_[i] = now[i];
+        }
+        out.append("\n");
+        return true;
+    }
+
+    std::string label_;
+    std::vector<std::string> names_;
+    std::atomic<uint64_t> counts_[kMaxFields] = {};
+    uint64_t last_[kMaxFields] = {};
+};
+
+/**
+ * Process-wide logger for the test programs.
+ *
+ * Callers format a line into a fixed-size slot of a bounded lock-free ring
+ * (Vyukov's MPMC scheme, used here with many producers and one consumer) and
+ * return; a background thread drains the ring into one fwrite/fflush per batch,
+ * so the send and receive paths never block on the log file. When the ring is
+ * full, or more than the rate limit arrive in one second, lines other than
+ * errors are dropped and counted instead; the count shows up with the next
+ * summary.
+ *
+ *   configure_logging(argc, argv);       // --log-level, --verbose, --quiet, ...
+ *   log_info() << " [*] Receiver " << id << " ready";
+ *   log_debug() << " [x] Received message " << envelope.message_id();
+ */
+class AsyncLogger {
+public:
+    static constexpr size_t kLineBytes = 240;
+    static constexpr size_t kRingSlots = 4096;
+    static constexpr int kDefaultRateLimit = 1000;     // lines/s; 0 disables
+    static constexpr int kDefaultIntervalMs = 1000;
+
+    AsyncLogger() {
+        for (size_t i = 0; i < kRingSlots; ++i) {
+            ring_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        if (const char* env = getenv("MESSAGING_LOG_LEVEL")) {
+            LogLevel level;
+            if (parse_log_level(env, level)) {
+                set_level(level);
+            }
+        }
+        writer_ = std::thread([this]() { writer_loop(); });
+    }
+
+    ~AsyncLogger() {
+        stopping_.store(true, std::memory_order_release);
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    static AsyncLogger& global() {
+        static AsyncLogger logger;
+        return logger;
+    }
+
+    void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+    bool enabled(LogLevel level) const {
+        return level != LogLevel::Quiet && static_cast<int>(level) <= level_.load(std::memory_order_relaxed);
+    }
+
+    void set_rate_limit(int lines_per_sec) { rate_limit_.store(lines_per_sec, std::memory_order_relaxed); }
+    void set_summary_interval_ms(int interval_ms) { interval_ms_.store(interval_ms, std::memory_order_relaxed); }
+
+    /**
+     * Counters reported every summary interval at Info level. The reference
+     * stays valid for the logger's lifetime; register once, not per message.
+     */
+    LogSummary& summary(std::string label, std::initializer_list<const char*> fields) {
+        std::lock_guard<std::mutex> lock(summaries_mu_);
+        summaries_.emplace_back(new LogSummary(std::move(label), fields));
+        return *summaries_.back();
+    }
+
+    // Queue one line (without its newline); false if it was dropped
+    bool submit(LogLevel level, const char* text, size_t len) {
+        if (level != LogLevel::Error && !admit()) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &ring_[pos % kRingSlots];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Ring full: the writer is behind, drop rather than wait
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        len = len < kLineBytes ? len : kLineBytes;
+        memcpy(slot->text, text, len);
+        slot->len = static_cast<uint16_t>(len);
+        slot->level = static_cast<uint8_t>(level);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Block until every line queued so far is written, e.g. before printing
+     * results on std::cout so they come after the per-message lines.
+     */
+    void flush() {
+        size_t target = head_.load(std::memory_order_acquire);
+        while (written_.load(std::memory_order_acquire) < target && writer_.joinable()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        fflush(stdout);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        uint16_t len;
+        uint8_t level;
+        char text[kLineBytes];
+    };
+
+    // Fixed one-second window; approximate under contention, which is all a log cap needs
+    bool admit() {
+        int limit = rate_limit_.load(std::memory_order_relaxed);
+        if (limit <= 0) {
+            return true;
+        }
+        int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t window = window_.load(std::memory_order_relaxed);
+        if (window != second && window_.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+            window_count_.store(0, std::memory_order_relaxed);
+        }
+        return window_count_.fetch_add(1, std::memory_order_relaxed) < limit;
+    }
+
+    void writer_loop() {
+        std::string out;
+        auto last_summary = std::chrono::steady_clock::now();
+        while (true) {
+            bool stopping = stopping_.load(std::memory_order_acquire);
+            size_t drained = drain(out);
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - last_summary).count();
+            if (stopping || elapsed * 1000 >= interval_ms_.load(std::memory_order_relaxed)) {
+                summarize(out, elapsed, stopping);
+                last_summary = now;
+            }
+            write_out(out);
+            if (stopping) {
+                return;
+            }
+            if (drained == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    }
+
+    size_t drain(std::string& out) {
+        size_t count = 0;
+        while (true) {
+            Slot& slot = ring_[tail_ % kRingSlots];
+            if (slot.seq.load(std::memory_order_acquire) != tail_ + 1) {
+                break;
+            }
+            if (static_cast<LogLevel>(slot.level) == LogLevel::Error) {
+                // Errors keep their stream; flush what precedes them so the order holds
+                write_out(out);
+                fwrite(slot.text, 1, slot.len, stderr);
+                fputc('\n', stderr);
+            } else {
+                out.append(slot.text, slot.len).append("\n");
+            }
+            slot.seq.store(tail_ + kRingSlots, std::memory_order_release);
+            ++tail_;
+            ++count;
+        }
+        written_.store(tail_, std::memory_order_release);
+        return count;
+    }
+
+    void summarize(std::string& out, double seconds, bool final_summary) {
+        if (!enabled(LogLevel::Info)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(summaries_mu_);
+            for (auto& summary : summaries_) {
+                summary->format(out, seconds, false);
+            }
+        }
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped_ || (final_summary && dropped > 0)) {
+            out.append(" [log] ").append(std::to_string(dropped - reported_dropped_))
+               .append(" lines dropped (ring full or over --log-rate)\n");
+            reported_dropped_ = dropped;
+        }
+    }
+
+    void write_out(std::string& out) {
+        if (out.empty()) {
+            return;
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        fflush(stdout);
+        out.clear();
+    }
+
+    Slot ring_[kRingSlots];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) size_t tail_ = 0;            // writer only
+    std::atomic<size_t> written_{0};
+    alignas(64) std::atomic<int64_t> window_{0};
+    std::atomic<int> window_count_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_ = 0;          // writer only
+
+    std::atomic<int> level_{static_cast<int>(LogLevel::Info)};
+    std::atomic<int> rate_limit_{kDefaultRateLimit};
+    std::atomic<int> interval_ms_{kDefaultIntervalMs};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex summaries_mu_;
+    std::deque<std::unique_ptr<LogSummary>> summaries_;
+    std::thread writer_;
+};
+
+/**
+ * One line being formatted on the caller's stack; queued when it goes out of
+ * scope. Disabled lines (level below the run's verbosity) skip all formatting,
+ * though the << operands are still evaluated, so keep them cheap.
+ */
+class LogLine {
+public:
+    LogLine(AsyncLogger& logger, LogLevel level)
+        : logger_(logger.enabled(level) ? &logger : nullptr), level_(level) {}
+
+    ~LogLine() {
+        if (logger_) {
+            logger_->submit(level_, buf_, len_);
+        }
+    }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view text) {
+        if (logger_) {
+            size_t n = text.size() < sizeof(buf_) - len_ ? text.size() : sizeof(buf_) - len_;
+            memcpy(buf_ + len_, text.data(), n);
+            len_ += n;
+        }
+        return *this;
+    }
+    LogLine& operator<<(const char* text) { return *this << std::string_view(text); }
+    LogLine& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    LogLine& operator<<(char c) { return *this << std::string_view(&c, 1); }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value &&
+                                                  !std::is_same<T, bool>::value, int>::type = 0>
+    LogLine& operator<<(T value) {
+        if (logger_) {
+            auto res = std::to_chars(buf_ + len_, buf_ + sizeof(buf_), value);
+            if (res.ec == std::errc()) {
+                len_ = static_cast<size_t>(res.ptr - buf_);
+            }
+        }
+        return *this;
+    }
+
+    LogLine& operator<<(double value) {
+        if (logger_) {
+            char num[32];
+            int n = snprintf(num, sizeof(num), "%g", value);
+            *this << std::string_view(num, n > 0 ? static_cast<size_t>(n) : 0);
+        }
+        return *this;
+    }
+
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+
+    bool enabled() const { return logger_ != nullptr; }
+
+private:
+    AsyncLogger* logger_;
+    LogLevel level_;
+    size_t len_ = 0;
+    char buf_[AsyncLogger::kLineBytes];
+};
+
+inline LogLine log_error() { return LogLine(AsyncLogger::global(), LogLevel::Error); }
+inline LogLine log_info() { return LogLine(AsyncLogger::global(), LogLevel::Info); }
+inline LogLine log_debug() { return LogLine(AsyncLogger::global(), LogLevel::Debug); }
+
+inline bool log_enabled(LogLevel level) { return AsyncLogger::global().enabled(level); }
+inline void flush_log() { AsyncLogger::global().flush(); }
+
+/**
+ * Apply the logging flags shared by every test program; other arguments are
+ * left for the program's own parser, which ignores these.
+ *
+ *   --log-level quiet|error|info|debug
+ *   --verbose / -v               same as --log-level debug (a line per message)
+ *   --quiet / -q                 same as --log-level error
+ *   --log-rate N                 at most N queued lines per second, 0 for no cap
+ *   --log-interval-ms N          summary period
+ */
+inline void configure_logging(int argc, char* argv[]) {
+    AsyncLogger& logger = AsyncLogger::global();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            LogLevel level;
+            if (parse_log_level(argv[++i], level)) {
+                logger.set_level(level);
+            } else {
+                fprintf(stderr, " [!] Unknown log level '%s'\n", argv[i]);
+            }
+        } else if (strcmp(argv[i], "--verbose") == 0 || strcmp(argv[i], "-v") == 0) {
+            logger.set_level(LogLevel::Debug);
+        } else if (strcmp(argv[i], "--quiet") == 0 || strcmp(argv[i], "-q") == 0) {
+            logger.set_level(LogLevel::Error);
+        } else if (strcmp(argv[i], "--log-rate") == 0 && i + 1 < argc) {
+            logger.set_rate_limit(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--log-interval-ms") == 0 && i + 1 < argc) {
+            logger.set_summary_interval_ms(atoi(argv[++i]));
+        }
+    }
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // ASYNC_LOGGER_HPP
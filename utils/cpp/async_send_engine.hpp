@@ -0,0 +1,688 @@
+#ifndef ASYNC_SEND_ENGINE_HPP
+#define ASYNC_SEND_ENGINE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <exception>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "latency_histogram.hpp"
+#include "latency_breakdown.hpp"
+#include "cpu_affinity.hpp"
+#include "request_policy.hpp"
+#include "qos_options.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Outcome of a single send/ack round trip, produced by a broker's send function.
+ */
+struct TaskResult {
+    bool success = false;
+    std::string message_id;
+    long long duration_ns = 0;   // steady-clock time from send to ack
+    size_t bytes = 0;            // request bytes on the wire, for megabytes_per_sec
+    AckTiming ack_timing;        // receiver-side legs from the ACK, for the latency breakdown
+    std::string error;
+
+    double duration_ms() const { return duration_ns / 1e6; }
+};
+
+/**
+ * Which try of a message a send function is making, and the timeout to use.
+ *
+ * The engine never has two messages on one corpus index out at once, even
+ * when a ramp cycles the corpus, so a first attempt (number 0) may write that
+ * message's shared state in place, such as stamping the corpus buffer or a
+ * pre-built envelope. Retries and hedges may overlap another attempt at the
+ * same message, so they must work on a private copy.
+ */
+struct Attempt {
+    int number = 0;                          // 0 for the first try, counting retries and hedges
+    bool hedge = false;
+    const RequestPolicy* policy = nullptr;
+
+    // Reply timeout for this attempt; default_ms is the sender's fixed timeout
+    int timeout_ms(int default_ms) const {
+        return policy ? policy->timeout_ms(default_ms) : default_ms;
+    }
+};
+
+// Inter-arrival times of the open-loop schedule
+enum class Arrival {
+    Uniform,   // exactly 1/rate apart
+    Poisson,   // exponentially distributed with mean 1/rate
+};
+
+/**
+ * Tuning knobs for the async send engine.
+ *
+ * workers       - fixed number of OS threads executing send functions
+ * max_in_flight - upper bound on messages dispatched but not yet completed;
+ *                 the producer blocks once the window is full (backpressure)
+ *
+ * Open loop (rate > 0): messages are released on a fixed schedule instead,
+ * whether or not earlier ones have completed, and latency runs from each
+ * message's scheduled send time, so time spent queued behind a slow broker
+ * is counted rather than omitted. With rate_max above rate the run is a
+ * ramp: step_ms at rate, then rate + rate_step, ... up to rate_max, cycling
+ * through the corpus as needed. Without one, the corpus is sent once.
+ * Cycling never puts an index in flight twice: a message scheduled while
+ * every index is still out waits for one (its latency still runs from its
+ * scheduled time), and the report counts these as index_waits.
+ *
+ * policy - adaptive timeouts, retries and hedging (see RequestPolicyOptions)
+ * qos    - --qos retransmits of a failed message, tried before any policy
+ *          retry (see QoSOptions)
+ */
+struct EngineOptions {
+    int workers = 32;
+    int max_in_flight = 64;
+
+    double rate = 0;          // msgs/s; 0 keeps the closed-loop window
+    double rate_step = 0;
+    double rate_max = 0;
+    int step_ms = 10000;
+    Arrival arrival = Arrival::Uniform;
+    uint64_t seed = 1;
+
+    RequestPolicyOptions policy;
+    QoSOptions qos;
+
+    bool open_loop() const { return rate > 0; }
+    bool ramp() const { return open_loop() && rate_max > rate && rate_step > 0; }
+
+    // Target rate of each step, in order
+    std::vector<double> step_rates() const {
+        std::vector<double> rates;
+        if (!open_loop()) {
+            return rates;
+        }
+        rates.push_back(rate);
+        // Half-step tolerance so 1000:1000:5000 ends on 5000 despite rounding
+        for (double r = rate + rate_step; ramp() && r <= rate_max + rate_step / 2; r += rate_step) {
+            rates.push_back(r);
+        }
+        return rates;
+    }
+
+    /**
+     * Warn on stderr that mode, which drives its own single-threaded window
+     * instead of the engine, ignores the open-loop and request policy flags.
+     * @return true if any of them were given
+     */
+    bool warn_ignored_by(const char* mode) const {
+        std::string ignored;
+        if (open_loop()) {
+            ignored = ramp() ? "--rate/--rate-step/--rate-max" : "--rate";
+        }
+        if (policy.enabled()) {
+            ignored += ignored.empty() ? "" : " and ";
+            ignored += "--adaptive-timeout/--retries/--hedge-after";
+        }
+        if (qos.enabled()) {
+            ignored += ignored.empty() ? "" : " and ";
+            ignored += "--qos retransmits";
+        }
+        if (ignored.empty()) {
+            return false;
+        }
+        std::cerr << " [!] " << mode << " does not use the send engine; ignoring " << ignored
+                  << " (closed loop, no retries)" << std::endl;
+        return true;
+    }
+
+    /**
+     * Parse --workers N, --max-in-flight N and the open-loop flags:
+     * --rate R, --rate-step S, --rate-max M, --step-ms T,
+     * --arrival uniform|poisson and --seed N, plus the request policy and
+     * --qos flags.
+     */
+    static EngineOptions from_args(int argc, char* argv[]) {
+        EngineOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+                options.workers = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--max-in-flight") == 0 && i + 1 < argc) {
+                options.max_in_flight = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+                options.rate = std::max(0.0, std::stod(argv[++i]));
+            } else if (std::strcmp(argv[i], "--rate-step") == 0 && i + 1 < argc) {
+                options.rate_step = std::max(0.0, std::stod(argv[++i]));
+            } else if (std::strcmp(argv[i], "--rate-max") == 0 && i + 1 < argc) {
+                options.rate_max = std::max(0.0, std::stod(argv[++i]));
+            } else if (std::strcmp(argv[i], "--step-ms") == 0 && i + 1 < argc) {
+                options.step_ms = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--arrival") == 0 && i + 1 < argc) {
+                options.arrival = std::strcmp(argv[++i], "poisson") == 0 ? Arrival::Poisson : Arrival::Uniform;
+            } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i]);
+            }
+        }
+        options.policy = RequestPolicyOptions::from_args(argc, argv);
+        options.policy.seed = options.seed;
+        options.qos = QoSOptions::from_args(argc, argv);
+        return options;
+    }
+};
+
+/**
+ * Results of one open-loop rate step. Messages belong to the step they were
+ * scheduled in, even if they complete after it ends.
+ */
+struct RateStep {
+    double target_rate = 0;
+    int64_t start_ns = 0;            // first scheduled send
+    int64_t last_completion_ns = 0;
+    int64_t sent = 0;
+    int64_t acked = 0;
+    int64_t failed = 0;
+    LatencyHistogram latencies;      // from scheduled send to ACK
+
+    // ACKs per second over the step, stretched by completions that ran late
+    double achieved_rate() const {
+        int64_t span_ns = last_completion_ns - start_ns;
+        return span_ns > 0 ? acked * 1e9 / span_ns : 0.0;
+    }
+};
+
+/**
+ * Bounded in-flight pipeline shared by all C++ async senders.
+ *
+ * Replaces the thread-per-message std::async fan-out: a fixed pool of workers
+ * pulls message indices from a queue that never holds more than max_in_flight
+ * entries (queued + executing). Results are delivered to on_result one at a
+ * time, so callers can record into non-thread-safe stats without locking.
+ *
+ * With --qos at_least_once or exactly_once, a failed attempt is first resent
+ * at once on the same worker, up to max_retransmits times. With a request
+ * policy, it is then retried after a jittered backoff while the retry budget
+ * lasts, and a message still unanswered after the hedge delay gets a
+ * duplicate attempt queued ahead of new messages. Either way a message
+ * occupies one window slot and produces one result: the first successful
+ * attempt, or the last failure. Its latency runs from its first attempt (or
+ * its scheduled time in open loop).
+ */
+class AsyncSendEngine {
+public:
+    using SendFn = std::function<TaskResult(size_t index, const Attempt& attempt)>;
+    using ResultFn = std::function<void(const TaskResult& result)>;
+
+    explicit AsyncSendEngine(const EngineOptions& options = EngineOptions())
+        : options_(options), policy_(options.policy) {}
+
+    const EngineOptions& options() const { return options_; }
+
+    const RequestPolicy& policy() const { return policy_; }
+
+    // Request policy settings and counters for the report
+    nlohmann::json policy_report() const { return policy_.report(); }
+
+    // Highest number of messages in flight observed during the last run()
+    int peak_in_flight() const { return peak_in_flight_; }
+
+    // Per-step results of the last open-loop run()
+    const std::vector<RateStep>& steps() const { return steps_; }
+
+    // Scheduled messages of the last open-loop run() that waited for their corpus index to come free
+    int64_t index_waits() const { return index_waits_; }
+
+    // --qos resends of failed attempts during the last run()
+    int64_t retransmits() const { return retransmits_; }
+
+    /**
+     * Highest step rate the broker sustained: the step before the first one
+     * that fell 5% short of its target, failed over 1% of its messages, or
+     * had a p99 ten times the first step's. 0 if even the first step did.
+     */
+    double knee_rate() const {
+        double knee = 0;
+        for (const RateStep& step : steps_) {
+            bool short_of_target = step.achieved_rate() < 0.95 * step.target_rate;
+            bool failing = step.failed > step.sent / 100;
+            bool slow = !steps_.empty() && steps_.front().latencies.count() > 0 &&
+                        step.latencies.percentile_ms(99) > 10 * steps_.front().latencies.percentile_ms(99);
+            if (step.sent == 0 || short_of_target || failing || slow) {
+                break;
+            }
+            knee = step.target_rate;
+        }
+        return knee;
+    }
+
+    // Open-loop settings and per-step results for the report
+    nlohmann::json open_loop_report() const {
+        nlohmann::json steps = nlohmann::json::array();
+        for (const RateStep& step : steps_) {
+            steps.push_back({
+                {"target_rate", step.target_rate},
+                {"achieved_rate", step.achieved_rate()},
+                {"sent", step.sent},
+                {"acked", step.acked},
+                {"failed", step.failed},
+                {"p50_ms", step.latencies.percentile_ms(50)},
+                {"p99_ms", step.latencies.percentile_ms(99)},
+                {"p99_9_ms", step.latencies.percentile_ms(99.9)},
+                {"max_ms", step.latencies.max_ns() / 1e6}
+            });
+        }
+        return {
+            {"arrival", options_.arrival == Arrival::Poisson ? "poisson" : "uniform"},
+            {"step_ms", options_.step_ms},
+            {"steps", steps},
+            {"index_waits", index_waits_},
+            {"knee_rate", knee_rate()}
+        };
+    }
+
+    /**
+     * Send messages [0, count) through send and report each completion.
+     * Blocks until every message has completed.
+     */
+    void run(size_t count, const SendFn& send, const ResultFn& on_result) {
+        if (count == 0) {
+            return;
+        }
+
+        queue_.clear();
+        free_.clear();
+        waiting_.clear();
+        index_waits_ = 0;
+        retransmits_ = 0;
+        hedges_ = {};
+        hedger_done_ = false;
+        in_flight_ = 0;
+        peak_in_flight_ = 0;
+        done_ = false;
+        steps_.clear();
+
+        size_t num_workers = std::min<size_t>(
+            {static_cast<size_t>(options_.workers), static_cast<size_t>(options_.max_in_flight), count});
+
+        std::vector<std::thread> workers;
+        workers.reserve(num_workers);
+        for (size_t w = 0; w < num_workers; ++w) {
+            workers.emplace_back([&]() {
+                CpuAffinity::global().pin_this_thread();
+                worker_loop(send, on_result);
+            });
+        }
+        std::thread hedger;
+        if (options_.policy.hedging()) {
+            hedger = std::thread([&]() { hedge_loop(); });
+        }
+
+        if (options_.open_loop()) {
+            produce_scheduled(count);
+        } else {
+            // Producer: admit messages into the window, blocking while it is full
+            for (size_t i = 0; i < count; ++i) {
+                std::unique_lock<std::mutex> lock(mu_);
+                space_cv_.wait(lock, [&]() { return in_flight_ < options_.max_in_flight; });
+                admit(i, 0, 0);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            done_ = true;
+        }
+        work_cv_.notify_all();
+
+        for (auto& t : workers) {
+            t.join();
+        }
+        if (hedger.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                hedger_done_ = true;
+            }
+            hedge_cv_.notify_all();
+            hedger.join();
+        }
+    }
+
+    // Convenience overload for a vector of items
+    template <typename Item, typename Fn>
+    void run(const std::vector<Item>& items, Fn send_item, const ResultFn& on_result) {
+        run(items.size(), [&](size_t i, const Attempt& attempt) { return send_item(items[i], attempt); }, on_result);
+    }
+
+private:
+    // One message, shared by its attempts; everything but the constants is guarded by mu_
+    struct Flight {
+        size_t index;
+        int64_t scheduled_ns;   // 0 in closed loop
+        size_t step;
+        int64_t start_ns = 0;   // first attempt began
+        int attempts = 0;       // started so far
+        int retransmits = 0;    // --qos resends among them
+        int running = 0;
+        bool hedged = false;
+        bool done = false;      // result delivered; later completions are dropped
+    };
+
+    struct Ticket {
+        std::shared_ptr<Flight> flight;
+        bool hedge = false;
+    };
+
+    // An open-loop message scheduled while every corpus index was in flight
+    struct Waiting {
+        int64_t scheduled_ns;
+        size_t step;
+    };
+
+    struct PendingHedge {
+        int64_t due_ns;
+        std::shared_ptr<Flight> flight;
+        bool operator>(const PendingHedge& other) const { return due_ns > other.due_ns; }
+    };
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Caller holds mu_
+    void admit(size_t index, int64_t scheduled_ns, size_t step) {
+        in_flight_++;
+        peak_in_flight_ = std::max(peak_in_flight_, in_flight_);
+        dispatch(index, scheduled_ns, step);
+    }
+
+    // Caller holds mu_
+    void dispatch(size_t index, int64_t scheduled_ns, size_t step) {
+        queue_.push_back({std::make_shared<Flight>(Flight{index, scheduled_ns, step}), false});
+        work_cv_.notify_one();
+    }
+
+    /**
+     * Caller holds mu_. Admit an open-loop message on the next free index.
+     * Senders keep per-index state (an encoded payload, a stamped corpus
+     * entry, an ACK expectation keyed by message_id), so an index goes out
+     * again only once its last attempt has returned; until then the message
+     * waits, counted in the window like any other late message.
+     */
+    void admit_scheduled(int64_t scheduled_ns, size_t step) {
+        if (free_.empty()) {
+            in_flight_++;
+            peak_in_flight_ = std::max(peak_in_flight_, in_flight_);
+            waiting_.push_back({scheduled_ns, step});
+            index_waits_++;
+            return;
+        }
+        size_t index = free_.front();
+        free_.pop_front();
+        admit(index, scheduled_ns, step);
+    }
+
+    // Caller holds mu_; hand a finished open-loop flight's index to the oldest waiting message, or free it
+    void release_index(const Flight& flight) {
+        if (flight.scheduled_ns == 0 || flight.running > 0) {
+            return;   // closed loop never reuses an index; or an attempt still holds it
+        }
+        if (waiting_.empty()) {
+            free_.push_back(flight.index);
+            return;
+        }
+        Waiting next = waiting_.front();
+        waiting_.pop_front();
+        dispatch(flight.index, next.scheduled_ns, next.step);
+        if (waiting_.empty() && done_) {
+            work_cv_.notify_all();   // idle workers may exit now
+        }
+    }
+
+    /**
+     * Release messages at their scheduled times without waiting for the
+     * window; a backlog shows up as queueing latency and peak_in_flight.
+     */
+    void produce_scheduled(size_t count) {
+        std::vector<double> rates = options_.step_rates();
+        steps_.resize(rates.size());
+        std::mt19937_64 rng(options_.seed);
+        std::exponential_distribution<double> exponential(1.0);
+
+        int64_t step_ns = static_cast<int64_t>(options_.step_ms) * 1000000;
+        int64_t next_ns = now_ns();
+        size_t sent = 0;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            for (size_t i = 0; i < count; ++i) {
+                free_.push_back(i);
+            }
+        }
+        for (size_t s = 0; s < rates.size(); ++s) {
+            steps_[s].target_rate = rates[s];
+            steps_[s].start_ns = next_ns;
+            int64_t step_end_ns = next_ns + step_ns;
+            double mean_gap_ns = 1e9 / rates[s];
+            // A ramp runs each step for step_ms; a single rate sends the corpus once
+            while (options_.ramp() ? next_ns < step_end_ns : sent < count) {
+                wait_until(next_ns);
+                {
+                    std::lock_guard<std::mutex> lock(mu_);
+                    admit_scheduled(next_ns, s);
+                }
+                sent++;
+                double gap = options_.arrival == Arrival::Poisson ? exponential(rng) * mean_gap_ns : mean_gap_ns;
+                next_ns += static_cast<int64_t>(gap);
+            }
+        }
+    }
+
+    // Sleep most of the way, then spin: sleep_for alone overshoots by 50us or more
+    static void wait_until(int64_t deadline_ns) {
+        constexpr int64_t kSpinNs = 100000;
+        int64_t remaining = deadline_ns - now_ns();
+        if (remaining > kSpinNs) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - kSpinNs));
+        }
+        while (now_ns() < deadline_ns) {
+        }
+    }
+
+    void worker_loop(const SendFn& send, const ResultFn& on_result) {
+        while (true) {
+            Ticket ticket;
+            Attempt attempt;
+            attempt.policy = &policy_;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                // Messages waiting for an index are dispatched by the worker that frees it
+                work_cv_.wait(lock, [&]() { return !queue_.empty() || (done_ && waiting_.empty()); });
+                if (queue_.empty()) {
+                    return;
+                }
+                ticket = std::move(queue_.front());
+                queue_.pop_front();
+                if (ticket.hedge && (ticket.flight->done || !policy_.allow_hedge())) {
+                    continue;   // its message already completed, or the budget is spent
+                }
+                attempt.number = ticket.flight->attempts++;
+                attempt.hedge = ticket.hedge;
+                ticket.flight->running++;
+                if (attempt.number == 0) {
+                    ticket.flight->start_ns = now_ns();
+                    schedule_hedge(ticket.flight);
+                }
+            }
+            if (attempt.number == 0) {
+                policy_.on_first_attempt();
+            }
+            run_attempts(*ticket.flight, attempt, send, on_result);
+        }
+    }
+
+    // Run attempt, then its retries, until the flight completes or another attempt owns it
+    void run_attempts(Flight& flight, Attempt attempt, const SendFn& send, const ResultFn& on_result) {
+        while (true) {
+            int64_t attempt_start_ns = now_ns();
+            TaskResult result;
+            try {
+                result = send(flight.index, attempt);
+            } catch (const std::exception& e) {
+                result.success = false;
+                result.error = e.what();
+            }
+            int64_t elapsed_ns = now_ns() - attempt_start_ns;
+            if (result.success) {
+                policy_.observe(result.duration_ns);
+            } else if (elapsed_ns >= static_cast<int64_t>(options_.policy.timeout_min_ms) * 1000000) {
+                policy_.observe(elapsed_ns);   // a timeout: the reply took at least this long
+            }
+
+            bool won_by_hedge = attempt.hedge;
+            bool retry = false;
+            bool retransmit = false;
+            int backoff_number = 0;
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                flight.running--;
+                if (flight.done) {
+                    release_index(flight);
+                    return;   // the other attempt won
+                }
+                if (!result.success) {
+                    if (flight.running > 0) {
+                        return;   // a hedge is still out; let it decide
+                    }
+                    retransmit = flight.retransmits < options_.qos.retransmits();
+                    if (retransmit) {
+                        flight.retransmits++;
+                        retransmits_++;
+                    }
+                    // Policy retries are numbered after the retransmits
+                    retry = retransmit || policy_.allow_retry(flight.attempts - flight.retransmits);
+                }
+                if (retry) {
+                    attempt.number = flight.attempts++;
+                    attempt.hedge = false;
+                    backoff_number = attempt.number - flight.retransmits;
+                    flight.running++;
+                } else {
+                    flight.done = true;
+                    release_index(flight);
+                }
+            }
+            if (retry) {
+                if (!retransmit) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(policy_.backoff_ns(backoff_number)));
+                }
+                continue;
+            }
+            if (result.success && won_by_hedge) {
+                policy_.record_hedge_win();
+            }
+            // Latency of the message, not of the attempt that completed it
+            result.duration_ns += attempt_start_ns - flight.start_ns;
+            deliver(flight, result, on_result);
+            return;
+        }
+    }
+
+    void deliver(const Flight& flight, TaskResult& result, const ResultFn& on_result) {
+        {
+            std::lock_guard<std::mutex> lock(result_mu_);
+            if (flight.scheduled_ns != 0) {
+                // Coordinated-omission-free latency: from when the message should have gone out
+                int64_t completed_ns = now_ns();
+                result.duration_ns = completed_ns - flight.scheduled_ns;
+                RateStep& step = steps_[flight.step];
+                step.sent++;
+                step.last_completion_ns = std::max(step.last_completion_ns, completed_ns);
+                if (result.success) {
+                    step.acked++;
+                    step.latencies.record_ns(result.duration_ns);
+                } else {
+                    step.failed++;
+                }
+            }
+            on_result(result);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            in_flight_--;
+        }
+        space_cv_.notify_one();
+    }
+
+    // Caller holds mu_; arm a hedge for a flight whose first attempt just started
+    void schedule_hedge(const std::shared_ptr<Flight>& flight) {
+        int64_t delay_ns = policy_.hedge_delay_ns();
+        if (delay_ns <= 0) {
+            return;
+        }
+        bool earliest = hedges_.empty() || flight->start_ns + delay_ns < hedges_.top().due_ns;
+        hedges_.push({flight->start_ns + delay_ns, flight});
+        if (earliest) {
+            hedge_cv_.notify_one();
+        }
+    }
+
+    // Queue a duplicate of each flight still unanswered when its hedge falls due
+    void hedge_loop() {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (!hedger_done_) {
+            if (hedges_.empty()) {
+                hedge_cv_.wait(lock);
+                continue;
+            }
+            int64_t due_ns = hedges_.top().due_ns;
+            if (now_ns() < due_ns) {
+                hedge_cv_.wait_for(lock, std::chrono::nanoseconds(due_ns - now_ns()));
+                continue;
+            }
+            std::shared_ptr<Flight> flight = hedges_.top().flight;
+            hedges_.pop();
+            if (flight->done || flight->hedged || flight->running == 0) {
+                continue;
+            }
+            flight->hedged = true;
+            queue_.push_front({flight, true});
+            work_cv_.notify_one();
+        }
+    }
+
+    EngineOptions options_;
+    RequestPolicy policy_;
+
+    std::mutex mu_;
+    std::condition_variable work_cv_;
+    std::condition_variable space_cv_;
+    std::deque<Ticket> queue_;
+    std::deque<size_t> free_;       // open loop: corpus indices with no attempt in flight
+    std::deque<Waiting> waiting_;   // open loop: messages due while no index was free
+    int64_t index_waits_ = 0;
+    int64_t retransmits_ = 0;
+    std::priority_queue<PendingHedge, std::vector<PendingHedge>, std::greater<PendingHedge>> hedges_;
+    std::condition_variable hedge_cv_;
+    bool hedger_done_ = false;
+    int in_flight_ = 0;
+    int peak_in_flight_ = 0;
+    bool done_ = false;
+
+    std::mutex result_mu_;
+    std::vector<RateStep> steps_;   // sized before the workers see a ticket
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // ASYNC_SEND_ENGINE_HPP
@@ -0,0 +1,270 @@
+#ifndef BATCH_BUILDER_HPP
+#define BATCH_BUILDER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "message_helpers.hpp"
+#include "latency_breakdown.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * When a sender flushes a batch.
+ *
+ * max_messages - envelopes per batch; 1 disables batching
+ * max_bytes    - flush once the encoded envelopes reach this size
+ * linger_ms    - flush a partial batch once its oldest message has waited this long
+ */
+struct BatchOptions {
+    int max_messages = 1;
+    size_t max_bytes = 64 * 1024;
+    int linger_ms = 5;
+
+    bool enabled() const { return max_messages > 1; }
+
+    // Parse --batch N, --batch-bytes N and --batch-linger-ms N from the command line
+    static BatchOptions from_args(int argc, char* argv[]) {
+        BatchOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+                options.max_messages = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--batch-bytes") == 0 && i + 1 < argc) {
+                options.max_bytes = static_cast<size_t>(std::max(1LL, std::stoll(argv[++i])));
+            } else if (std::strcmp(argv[i], "--batch-linger-ms") == 0 && i + 1 < argc) {
+                options.linger_ms = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Envelopes queued for one target, encoded incrementally as a BatchMessage.
+ *
+ * add() appends already-serialized envelopes as BatchMessage.messages entries,
+ * so pre-encoded corpus bytes are copied once and never re-parsed. finish()
+ * wraps them in a BATCH envelope; the receiver answers with one BatchResponse
+ * carrying an Acknowledgment per message (see message_helpers::create_batch_response).
+ */
+class BatchBuilder {
+public:
+    BatchBuilder(int target, const BatchOptions& options) : target_(target), options_(options) {}
+
+    void add(std::string_view envelope_bytes, std::string_view message_id, long long now_ns) {
+        if (ids_.empty()) {
+            first_ns_ = now_ns;
+        }
+        messages_.push_back(kMessagesTag);
+        append_varint(messages_, envelope_bytes.size());
+        messages_.append(envelope_bytes);
+        ids_.emplace_back(message_id);
+        added_ns_.push_back(now_ns);
+    }
+
+    int target() const { return target_; }
+
+    int32_t batch_id() const { return batch_id_; }
+    void set_batch_id(int32_t batch_id) { batch_id_ = batch_id; }
+
+    size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+
+    bool full() const {
+        return ids_.size() >= static_cast<size_t>(options_.max_messages) || messages_.size() >= options_.max_bytes;
+    }
+
+    // True once the oldest queued message has lingered for linger_ms
+    bool expired(long long now_ns) const {
+        return !ids_.empty() && now_ns - first_ns_ >= options_.linger_ms * 1000000LL;
+    }
+
+    const std::string& message_id(size_t i) const { return ids_[i]; }
+
+    // Steady-clock time message i was queued; its latency includes time spent lingering
+    long long added_ns(size_t i) const { return added_ns_[i]; }
+
+    /**
+     * @brief Wrap the queued envelopes in a BATCH envelope with message_id "batch_<batch_id>".
+     * @param reply_to Stored as reply_to metadata when non-empty (brokers that reply on a channel)
+     * @return The envelope, valid until the next finish() or clear()
+     */
+    const MessageEnvelope& finish(std::string_view reply_to = {}) {
+        envelope_.Clear();
+        envelope_.set_message_id("batch_" + std::to_string(batch_id_));
+        envelope_.set_target(target_);
+        envelope_.set_type(messaging::MessageType::BATCH);
+        envelope_.set_routing(messaging::RoutingMode::REQUEST_REPLY);
+        long long now_us = message_helpers::get_current_time_us();
+        envelope_.set_timestamp(now_us / 1000);
+        envelope_.set_timestamp_us(now_us);
+        if (!reply_to.empty()) {
+            (*envelope_.mutable_metadata())["reply_to"] = std::string(reply_to);
+        }
+
+        std::string* payload = envelope_.mutable_payload();
+        payload->reserve(messages_.size() + 12);
+        payload->assign(messages_);
+        payload->push_back(kBatchIdTag);
+        append_varint(*payload, static_cast<uint32_t>(batch_id_));
+        return envelope_;
+    }
+
+    // finish() and serialize into out, which keeps its capacity across batches
+    const std::string& finish(std::string_view reply_to, std::string& out) {
+        return message_helpers::serialize_envelope(finish(reply_to), out);
+    }
+
+    /**
+     * @brief Match a reply against the queued messages.
+     *
+     * Calls on_result(i, ack) once for every queued message, with ack null for
+     * messages that were not acknowledged; a missing or malformed reply
+     * (nullptr included) fails the whole batch.
+     */
+    template <typename Fn>
+    void complete(const MessageEnvelope* reply, Fn on_result) const {
+        std::vector<const Acknowledgment*> acked(ids_.size(), nullptr);
+        messaging::BatchResponse response;
+        if (reply && reply->type() == messaging::MessageType::BATCH &&
+            response.ParseFromString(reply->payload())) {
+            // Receivers acknowledge in batch order; fall back to a search if they don't
+            for (int k = 0; k < response.acknowledgments_size(); ++k) {
+                const Acknowledgment& ack = response.acknowledgments(k);
+                if (!ack.received() || !message_helpers::is_ack_ok(ack)) {
+                    continue;
+                }
+                size_t i = static_cast<size_t>(k);
+                if (i >= ids_.size() || ids_[i] != ack.original_message_id()) {
+                    i = std::find(ids_.begin(), ids_.end(), ack.original_message_id()) - ids_.begin();
+                }
+                if (i < ids_.size()) {
+                    acked[i] = &ack;
+                }
+            }
+        }
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            on_result(i, acked[i]);
+        }
+    }
+
+    void clear() {
+        messages_.clear();
+        ids_.clear();
+        added_ns_.clear();
+    }
+
+private:
+    // Field number << 3 | wire type (0 = varint, 2 = length-delimited)
+    static constexpr char kMessagesTag = (1 << 3) | 2;
+    static constexpr char kBatchIdTag = (2 << 3) | 0;
+
+    static void append_varint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    int target_;
+    BatchOptions options_;
+    int32_t batch_id_ = 0;
+    long long first_ns_ = 0;
+    std::string messages_;              // encoded BatchMessage.messages entries
+    std::vector<std::string> ids_;
+    std::vector<long long> added_ns_;
+    MessageEnvelope envelope_;
+};
+
+/**
+ * One BatchBuilder per target, flushed when full, when lingering too long, or at the end.
+ *
+ * flush is called as flush(BatchBuilder&) with a fresh batch_id and should
+ * send the batch, wait for its reply and report results via
+ * BatchBuilder::complete(); the builder is cleared afterwards.
+ * Single-threaded, like the sync senders that use it.
+ */
+class BatchAccumulator {
+public:
+    explicit BatchAccumulator(const BatchOptions& options) : options_(options) {}
+
+    const BatchOptions& options() const { return options_; }
+
+    // Queue a message for target, flushing that target's batch if it becomes full
+    template <typename Fn>
+    void add(int target, std::string_view envelope_bytes, std::string_view message_id, long long now_ns, Fn flush) {
+        auto it = batches_.find(target);
+        if (it == batches_.end()) {
+            it = batches_.emplace(target, BatchBuilder(target, options_)).first;
+        }
+        it->second.add(envelope_bytes, message_id, now_ns);
+        if (it->second.full()) {
+            run(it->second, flush);
+        }
+    }
+
+    // Flush every batch whose oldest message has passed linger_ms
+    template <typename Fn>
+    void flush_expired(long long now_ns, Fn flush) {
+        for (auto& entry : batches_) {
+            if (entry.second.expired(now_ns)) {
+                run(entry.second, flush);
+            }
+        }
+    }
+
+    // Flush every partial batch; call once all messages have been queued
+    template <typename Fn>
+    void flush_all(Fn flush) {
+        for (auto& entry : batches_) {
+            if (!entry.second.empty()) {
+                run(entry.second, flush);
+            }
+        }
+    }
+
+private:
+    template <typename Fn>
+    void run(BatchBuilder& batch, Fn& flush) {
+        batch.set_batch_id(++last_batch_id_);
+        flush(batch);
+        batch.clear();
+    }
+
+    BatchOptions options_;
+    int32_t last_batch_id_ = 0;
+    std::map<int, BatchBuilder> batches_;
+};
+
+/**
+ * Record a completed batch into stats (MessageStats or anything with the same
+ * record_message_ns/record_breakdown/record_message API). Each acked message's
+ * latency runs from when it was queued to done_ns; returns how many were acked.
+ */
+template <typename Stats>
+size_t record_batch(Stats& stats, const BatchBuilder& batch, const MessageEnvelope* reply, long long done_ns) {
+    size_t acked_count = 0;
+    batch.complete(reply, [&](size_t i, const Acknowledgment* ack) {
+        if (ack) {
+            long long latency_ns = done_ns - batch.added_ns(i);
+            stats.record_message_ns(true, latency_ns);
+            stats.record_breakdown(AckTiming::of(*ack), latency_ns);
+            acked_count++;
+        } else {
+            stats.record_message(false);
+        }
+    });
+    return acked_count;
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // BATCH_BUILDER_HPP
@@ -0,0 +1,134 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Thread-safe pool of reusable broker connections, keyed by target.
+ *
+ * The key is whatever identifies an endpoint for the broker: the receiver
+ * port for peer-to-peer transports (see ZeroMQSender::get_port), or a single
+ * shared key for brokered ones. A checkout hands out an idle connection for
+ * the key if there is one, otherwise asks the factory for a new one. The
+ * connection is used exclusively by the holder of the Lease and goes back to
+ * the pool when the Lease is destroyed, unless it was discarded.
+ */
+template <typename Conn>
+class ConnectionPool {
+public:
+    // Returns nullptr if the connection could not be established
+    using Factory = std::function<std::unique_ptr<Conn>(int key)>;
+
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(ConnectionPool* pool, int key, std::unique_ptr<Conn> conn)
+            : pool_(pool), key_(key), conn_(std::move(conn)) {}
+
+        Lease(Lease&& other) noexcept
+            : pool_(other.pool_), key_(other.key_), conn_(std::move(other.conn_)) {
+            other.pool_ = nullptr;
+        }
+
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                give_back();
+                pool_ = other.pool_;
+                key_ = other.key_;
+                conn_ = std::move(other.conn_);
+                other.pool_ = nullptr;
+            }
+            return *this;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease() { give_back(); }
+
+        Conn* get() const { return conn_.get(); }
+        Conn* operator->() const { return conn_.get(); }
+        Conn& operator*() const { return *conn_; }
+        explicit operator bool() const { return conn_ != nullptr; }
+
+        // Close the connection instead of returning it (e.g. a poisoned REQ socket)
+        void discard() { conn_.reset(); }
+
+    private:
+        void give_back() {
+            if (pool_ && conn_) {
+                pool_->release(key_, std::move(conn_));
+            }
+            pool_ = nullptr;
+        }
+
+        ConnectionPool* pool_ = nullptr;
+        int key_ = 0;
+        std::unique_ptr<Conn> conn_;
+    };
+
+    explicit ConnectionPool(Factory factory) : factory_(std::move(factory)) {}
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * Check out a connection for key. The returned Lease is empty if no idle
+     * connection was available and the factory failed to create one.
+     */
+    Lease checkout(int key) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = idle_.find(key);
+            if (it != idle_.end() && !it->second.empty()) {
+                std::unique_ptr<Conn> conn = std::move(it->second.back());
+                it->second.pop_back();
+                reused_++;
+                return Lease(this, key, std::move(conn));
+            }
+        }
+
+        // Connect outside the lock so slow handshakes don't serialize workers
+        std::unique_ptr<Conn> conn = factory_(key);
+        if (!conn) {
+            return Lease();
+        }
+        created_++;
+        return Lease(this, key, std::move(conn));
+    }
+
+    // Close every idle connection
+    void clear() {
+        std::lock_guard<std::mutex> lock(mu_);
+        idle_.clear();
+    }
+
+    size_t created_count() const { return created_; }
+    size_t reused_count() const { return reused_; }
+
+private:
+    void release(int key, std::unique_ptr<Conn> conn) {
+        std::lock_guard<std::mutex> lock(mu_);
+        idle_[key].push_back(std::move(conn));
+    }
+
+    Factory factory_;
+    std::mutex mu_;
+    std::unordered_map<int, std::vector<std::unique_ptr<Conn>>> idle_;
+    std::atomic<size_t> created_{0};
+    std::atomic<size_t> reused_{0};
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // CONNECTION_POOL_HPP
@@ -0,0 +1,487 @@
+#ifndef COROUTINE_LOOP_HPP
+#define COROUTINE_LOOP_HPP
+
+/**
+ * Optional C++20 coroutine front-end for UnifiedSender / UnifiedReceiver.
+ *
+ *   EventLoop loop;
+ *   CoroSender sender(loop, redis_sender);
+ *   loop.spawn([&]() -> Task<> {
+ *       SendResult result = co_await sender.send(target, payload);
+ *   }());
+ *   loop.run();
+ *
+ * One EventLoop runs on one thread and resumes every coroutine on it, so a
+ * few threads (one loop per core) can keep tens of thousands of logical
+ * requests in flight. Senders are driven through send_async/poll_async; their
+ * sockets (poll_fds) are waited on with epoll, and backends that expose none
+ * are polled every millisecond. The header is empty below C++20.
+ */
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <deque>
+#include <set>
+#include <iostream>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "sender.hpp"
+#include "receiver.hpp"
+
+namespace messaging {
+namespace utils {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// Resumes whoever awaited the task when it finishes; detached tasks just stop
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T v) { value = std::move(v); }
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * Lazy coroutine: starts when awaited (or spawned on an EventLoop) and
+ * resumes its awaiter by symmetric transfer when it returns.
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::Promise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+    // Hand the coroutine over to an owner that resumes and destroys it
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle_, {}); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * Single-threaded scheduler for spawned tasks and the transports they wait on.
+ *
+ * A Source is anything that completes awaits by being pumped: a sender with
+ * requests outstanding, or a receiver with coroutines waiting in next().
+ */
+class EventLoop {
+public:
+    class Source {
+    public:
+        virtual ~Source() = default;
+        // True while some coroutine is waiting on this source
+        virtual bool busy() const = 0;
+        virtual std::vector<int> fds() const = 0;
+        // Complete whatever is ready without blocking for long
+        virtual void pump() = 0;
+        // The loop is stopping; wake every waiter
+        virtual void cancel() {}
+    };
+
+    EventLoop() : epoll_fd_(epoll_create1(0)) {}
+    ~EventLoop() {
+        for (auto handle : tasks_) {
+            handle.destroy();
+        }
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Start task on the next run(); the loop owns it from now on
+    void spawn(Task<void> task) {
+        auto handle = task.release();
+        if (handle) {
+            tasks_.push_back(handle);
+            ready_.push_back(handle);
+        }
+    }
+
+    // Resume handle from the loop rather than the current call stack
+    void schedule(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+    void add_source(Source* source) { sources_.push_back(source); }
+
+    // Run until every spawned task has finished, or stop() is called
+    void run() {
+        stopping_ = false;
+        while (true) {
+            while (!ready_.empty()) {
+                auto handle = ready_.front();
+                ready_.pop_front();
+                handle.resume();
+            }
+            reap();
+            if (tasks_.empty()) {
+                return;
+            }
+            if (stopping_) {
+                for (Source* source : sources_) {
+                    source->cancel();
+                }
+                if (ready_.empty()) {
+                    return;
+                }
+                continue;
+            }
+            wait_and_pump();
+        }
+    }
+
+    // Make run() return once waiters have been woken with nothing
+    void stop() { stopping_ = true; }
+
+    size_t task_count() const { return tasks_.size(); }
+
+private:
+    void reap() {
+        for (size_t i = 0; i < tasks_.size();) {
+            if (tasks_[i].done()) {
+                tasks_[i].destroy();
+                tasks_[i] = tasks_.back();
+                tasks_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void wait_and_pump() {
+        // Sources without sockets are polled every millisecond; timeouts still need a periodic pump
+        int wait_ms = 10;
+        bool any_busy = false;
+        for (Source* source : sources_) {
+            if (!source->busy()) {
+                continue;
+            }
+            any_busy = true;
+            std::vector<int> fds = source->fds();
+            if (fds.empty()) {
+                wait_ms = 1;
+            }
+            for (int fd : fds) {
+                watch(fd);
+            }
+        }
+        if (!any_busy) {
+            // Tasks are alive but nothing can wake them
+            std::cerr << " [!] EventLoop: " << tasks_.size() << " tasks blocked with no pending I/O" << std::endl;
+            stopping_ = true;
+            return;
+        }
+        epoll_event events[64];
+        epoll_wait(epoll_fd_, events, 64, wait_ms);
+        for (Source* source : sources_) {
+            if (source->busy()) {
+                source->pump();
+            }
+        }
+    }
+
+    void watch(int fd) {
+        if (fd < 0 || !watched_.insert(fd).second) {
+            return;
+        }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0 && errno == EEXIST) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    int epoll_fd_;
+    bool stopping_ = false;
+    std::vector<std::coroutine_handle<>> tasks_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::vector<Source*> sources_;
+    std::set<int> watched_;
+};
+
+/**
+ * co_await-able requests over a UnifiedSender on one EventLoop. The sender
+ * must support send_async; it is only touched from the loop's thread.
+ *
+ * When the loop stops, every send still waiting for its ACK resumes with a
+ * failed result (error "Cancelled"), so no coroutine frame is destroyed while
+ * the sender still holds a callback into it. The callback itself stays with
+ * the sender until the ACK or timeout arrives, and then does nothing.
+ */
+class CoroSender : public EventLoop::Source {
+    struct Pending;
+
+public:
+    CoroSender(EventLoop& loop, UnifiedSender& sender) : loop_(loop), sender_(sender) {
+        loop_.add_source(this);
+    }
+
+    // Sends still pending outlive this object in the sender's callbacks; detach them from it
+    ~CoroSender() {
+        for (const auto& pending : pending_) {
+            pending->owner = nullptr;
+        }
+    }
+
+    CoroSender(const CoroSender&) = delete;
+    CoroSender& operator=(const CoroSender&) = delete;
+
+    class SendAwaiter {
+    public:
+        SendAwaiter(CoroSender& owner, int target, std::string payload, int timeout_ms)
+            : owner_(owner), target_(target), payload_(std::move(payload)), timeout_ms_(timeout_ms) {}
+
+        // A frame destroyed while suspended here must not be resumed by a late ACK
+        ~SendAwaiter() {
+            if (pending_) {
+                pending_->awaiter = nullptr;
+                if (pending_->owner) {
+                    pending_->owner->forget(pending_);
+                }
+            }
+        }
+
+        SendAwaiter(const SendAwaiter&) = delete;
+        SendAwaiter& operator=(const SendAwaiter&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            pending_ = std::make_shared<Pending>(Pending{&owner_, this, awaiter});
+            owner_.pending_.push_back(pending_);
+            // The callback may run inside send_async when the request fails at once
+            std::shared_ptr<Pending> pending = pending_;
+            owner_.sender_.send_async(target_, payload_, [pending](const SendResult& result) {
+                if (pending->awaiter && pending->owner) {
+                    pending->owner->complete(pending, result);
+                }
+            }, timeout_ms_);
+        }
+        SendResult await_resume() { return std::move(result_); }
+
+    private:
+        friend class CoroSender;
+        CoroSender& owner_;
+        int target_;
+        std::string payload_;
+        int timeout_ms_;
+        SendResult result_;
+        std::shared_ptr<Pending> pending_;
+    };
+
+    // Completes with the ACK, or a failed result once timeout_ms passes
+    SendAwaiter send(int target, std::string payload, int timeout_ms = 5000) {
+        return SendAwaiter(*this, target, std::move(payload), timeout_ms);
+    }
+
+    bool busy() const override { return sender_.pending_async() > 0; }
+    std::vector<int> fds() const override { return sender_.poll_fds(); }
+    void pump() override { sender_.poll_async(0); }
+
+    // Fail every send still waiting; their ACKs, if they come, are dropped
+    void cancel() override {
+        std::vector<std::shared_ptr<Pending>> pending;
+        pending.swap(pending_);
+        for (const auto& entry : pending) {
+            SendResult result;
+            result.error = "Cancelled: event loop stopped";
+            complete(entry, result);
+        }
+    }
+
+    // Sends waiting for their ACK
+    size_t pending() const { return pending_.size(); }
+
+private:
+    // One suspended send; shared with the sender's callback, which may outlive both ends
+    struct Pending {
+        CoroSender* owner;
+        SendAwaiter* awaiter;
+        std::coroutine_handle<> handle;
+    };
+
+    void complete(const std::shared_ptr<Pending>& pending, const SendResult& result) {
+        SendAwaiter* awaiter = pending->awaiter;
+        if (!awaiter) {
+            return;
+        }
+        pending->awaiter = nullptr;
+        awaiter->pending_.reset();
+        forget(pending);
+        awaiter->result_ = result;
+        loop_.schedule(pending->handle);
+    }
+
+    void forget(const std::shared_ptr<Pending>& pending) {
+        auto it = std::find(pending_.begin(), pending_.end(), pending);
+        if (it != pending_.end()) {
+            *it = pending_.back();
+            pending_.pop_back();
+        }
+    }
+
+    EventLoop& loop_;
+    UnifiedSender& sender_;
+    std::vector<std::shared_ptr<Pending>> pending_;
+};
+
+/**
+ * co_await-able receives over a connected UnifiedReceiver on one EventLoop.
+ * Each request is ACKed before the awaiting coroutine resumes; the envelope
+ * is valid until that coroutine next suspends.
+ */
+class CoroReceiver : public EventLoop::Source {
+public:
+    // Requests handled per pump, so one busy receiver can't starve the loop
+    static constexpr int kPumpBudget = 64;
+
+    CoroReceiver(EventLoop& loop, UnifiedReceiver& receiver) : loop_(loop), receiver_(receiver) {
+        loop_.add_source(this);
+    }
+
+    class NextAwaiter {
+    public:
+        explicit NextAwaiter(CoroReceiver& owner) : owner_(owner) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            handle_ = awaiter;
+            owner_.waiters_.push_back(this);
+        }
+        // nullptr if the loop stopped first
+        const ::messaging::MessageEnvelope* await_resume() const { return envelope_; }
+
+    private:
+        friend class CoroReceiver;
+        CoroReceiver& owner_;
+        std::coroutine_handle<> handle_;
+        const ::messaging::MessageEnvelope* envelope_ = nullptr;
+    };
+
+    NextAwaiter next() { return NextAwaiter(*this); }
+
+    bool busy() const override { return !waiters_.empty(); }
+    std::vector<int> fds() const override { return receiver_.poll_fds(); }
+
+    void pump() override {
+        for (int i = 0; i < kPumpBudget && !waiters_.empty(); ++i) {
+            const ::messaging::MessageEnvelope* envelope = receiver_.receive_and_ack_proto(1);
+            if (!envelope) {
+                return;
+            }
+            NextAwaiter* waiter = waiters_.front();
+            waiters_.pop_front();
+            waiter->envelope_ = envelope;
+            // Resume now: the envelope is overwritten by the next receive
+            waiter->handle_.resume();
+        }
+    }
+
+    void cancel() override {
+        while (!waiters_.empty()) {
+            loop_.schedule(waiters_.front()->handle_);
+            waiters_.pop_front();
+        }
+    }
+
+private:
+    EventLoop& loop_;
+    UnifiedReceiver& receiver_;
+    std::deque<NextAwaiter*> waiters_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // __cpp_impl_coroutine
+
+#endif // COROUTINE_LOOP_HPP
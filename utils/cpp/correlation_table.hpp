@@ -0,0 +1,155 @@
+#ifndef CORRELATION_TABLE_HPP
+#define CORRELATION_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Outstanding requests keyed by message id (string or message_seq), safe to use from any thread.
+ *
+ * Keys are spread over mutex-guarded shards by hash, so a thread delivering
+ * replies and one issuing requests rarely contend on the same lock. take()
+ * removes and returns an entry, which makes completion and timeout race-free:
+ * whichever takes the entry first reports it.
+ */
+template <typename Value, typename Key = std::string>
+class CorrelationTable {
+public:
+    static constexpr size_t kShards = 16;
+
+    // false if key is already outstanding
+    bool insert(const Key& key, Value value) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        if (!shard.entries.emplace(key, std::move(value)).second) {
+            return false;
+        }
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Remove key and return its value, or nullopt if it was not outstanding
+    std::optional<Value> take(const Key& key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return std::nullopt;
+        }
+        std::optional<Value> value(std::move(it->second));
+        shard.entries.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return value;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Shard {
+        std::mutex mu;
+        std::unordered_map<Key, Value> entries;
+    };
+
+    Shard& shard_for(const Key& key) {
+        return shards_[std::hash<Key>{}(key) % kShards];
+    }
+
+    Shard shards_[kShards];
+    std::atomic<size_t> size_{0};
+};
+
+/**
+ * Hashed timing wheel for request timeouts.
+ *
+ * A timer lands in the slot for its deadline tick, so scheduling is O(1) and
+ * advance() only looks at the slots for the ticks that have passed, instead of
+ * a sleep or a sorted queue per request. Deadlines more than one revolution
+ * out stay in their slot until a later lap reaches them. Timers are never
+ * cancelled: a completed request's timer fires into a CorrelationTable::take
+ * that finds nothing. Not thread-safe; owned by the polling thread.
+ */
+template <typename Key = std::string>
+class TimerWheel {
+public:
+    explicit TimerWheel(int64_t tick_ns = 1000000, size_t slot_count = 1024)
+        : tick_ns_(tick_ns), slots_(slot_count ? slot_count : 1),
+          current_tick_(now_ns() / tick_ns) {}
+
+    void schedule(int64_t deadline_ns, Key key) {
+        int64_t tick = std::max(deadline_ns / tick_ns_, current_tick_);
+        slots_[tick % slots_.size()].push_back({deadline_ns, std::move(key)});
+        size_++;
+    }
+
+    // Fire every timer due by now_ns, in no particular order; returns how many fired
+    size_t advance(int64_t now_ns, const std::function<void(const Key& key)>& on_expired) {
+        int64_t target = now_ns / tick_ns_;
+        if (target < current_tick_) {
+            return 0;
+        }
+        // One full lap visits every slot; more ticks than that would only revisit them
+        int64_t last = std::min<int64_t>(target, current_tick_ + static_cast<int64_t>(slots_.size()) - 1);
+        size_t fired = 0;
+        for (int64_t tick = current_tick_; tick <= last; ++tick) {
+            auto& slot = slots_[tick % slots_.size()];
+            for (size_t i = 0; i < slot.size();) {
+                if (slot[i].deadline_ns <= now_ns) {
+                    expired_.push_back(std::move(slot[i].key));
+                    if (i + 1 != slot.size()) {
+                        slot[i] = std::move(slot.back());
+                    }
+                    slot.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+        current_tick_ = target;
+        size_ -= expired_.size();
+        for (const auto& key : expired_) {
+            on_expired(key);
+            fired++;
+        }
+        expired_.clear();
+        return fired;
+    }
+
+    // Timers scheduled and not yet fired, including those of completed requests
+    size_t size() const { return size_; }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct Timer {
+        int64_t deadline_ns;
+        Key key;
+    };
+
+    int64_t tick_ns_;
+    std::vector<std::vector<Timer>> slots_;
+    int64_t current_tick_;
+    size_t size_ = 0;
+    std::vector<Key> expired_;  // reused between advances
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // CORRELATION_TABLE_HPP
@@ -0,0 +1,242 @@
+#ifndef CPU_AFFINITY_HPP
+#define CPU_AFFINITY_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "json.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * CPUs from a list like "0-3,8,10-11" (the format of /sys cpulist files);
+ * empty if text is malformed.
+ */
+inline std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        std::string part = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        char* rest = nullptr;
+        long first = std::strtol(part.c_str(), &rest, 10);
+        if (rest == part.c_str() || first < 0) {
+            return {};
+        }
+        long last = first;
+        if (*rest == '-') {
+            const char* second = rest + 1;
+            last = std::strtol(second, &rest, 10);
+            if (rest == second || last < first) {
+                return {};
+            }
+        }
+        if (*rest != '\0' && *rest != '\n') {
+            return {};
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return cpus;
+}
+
+/**
+ * Where a program's threads may run.
+ *
+ * cpus        - the process's CPU mask; empty leaves placement to the scheduler
+ * pin_threads - also pin each thread that asks (engine workers, I/O threads,
+ *               receiver host threads) to one CPU of the list, round-robin;
+ *               the main thread takes the first
+ */
+struct AffinityOptions {
+    std::vector<int> cpus;
+    bool pin_threads = false;
+
+    bool enabled() const { return !cpus.empty(); }
+
+    // Parse --cpus LIST and --pin-threads from the command line
+    static AffinityOptions from_args(int argc, char* argv[]) {
+        AffinityOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+                options.cpus = parse_cpu_list(argv[++i]);
+                if (options.cpus.empty()) {
+                    fprintf(stderr, " [!] Ignoring malformed --cpus '%s'\n", argv[i]);
+                }
+            } else if (std::strcmp(argv[i], "--pin-threads") == 0) {
+                options.pin_threads = true;
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Process-wide thread placement, and the host topology for reports.
+ *
+ * apply() restricts the process to options.cpus; threads created afterwards
+ * inherit the mask, so call it first thing in main. When every listed CPU is
+ * on one NUMA node, memory is preferred from that node too, so buffers the
+ * program touches later (the encoded corpus, connection buffers) are
+ * allocated locally rather than wherever the first page fault happened to
+ * run. With pin_threads, pin_this_thread() then gives each calling thread its
+ * own CPU in list order.
+ *
+ *   configure_affinity(argc, argv);                 // --cpus 0-7 [--pin-threads]
+ *   workers.emplace_back([&]() { CpuAffinity::global().pin_this_thread(); ... });
+ *   stats.add_metadata("placement", CpuAffinity::global().describe());
+ */
+class CpuAffinity {
+public:
+    static CpuAffinity& global() {
+        static CpuAffinity affinity;
+        return affinity;
+    }
+
+    bool apply(const AffinityOptions& options) {
+        options_ = options;
+        if (!options_.enabled()) {
+            return false;
+        }
+        cpu_set_t mask = mask_of(options_.cpus);
+        if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+            fprintf(stderr, " [!] sched_setaffinity failed: %s\n", std::strerror(errno));
+            options_ = {};
+            return false;
+        }
+        std::set<int> nodes = nodes_of(options_.cpus);
+        if (nodes.size() == 1) {
+            prefer_node(*nodes.begin());
+        }
+        if (options_.pin_threads) {
+            pin_this_thread();
+        }
+        return true;
+    }
+
+    /**
+     * Pin the calling thread to the next listed CPU when pin_threads is set;
+     * otherwise it keeps the process mask. Returns the CPU, or -1.
+     */
+    int pin_this_thread() {
+        if (!options_.pin_threads || options_.cpus.empty()) {
+            return -1;
+        }
+        size_t slot = next_.fetch_add(1, std::memory_order_relaxed);
+        int cpu = options_.cpus[slot % options_.cpus.size()];
+        cpu_set_t mask = mask_of({cpu});
+        if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0) {
+            return -1;
+        }
+        return cpu;
+    }
+
+    /**
+     * The placement in effect and the host's NUMA layout:
+     * {"cpus": [...], "pin_threads": bool, "preferred_node": n, "online_cpus": n,
+     *  "numa_nodes": {"0": "0-15,32-47", ...}}; cpus is empty when unpinned.
+     */
+    nlohmann::json describe() const {
+        nlohmann::json placement;
+        placement["cpus"] = options_.cpus;
+        placement["pin_threads"] = options_.pin_threads;
+        if (preferred_node_ >= 0) {
+            placement["preferred_node"] = preferred_node_;
+        }
+        placement["online_cpus"] = sysconf(_SC_NPROCESSORS_ONLN);
+        nlohmann::json nodes = nlohmann::json::object();
+        for (const auto& [node, cpulist] : node_cpulists()) {
+            nodes[std::to_string(node)] = cpulist;
+        }
+        placement["numa_nodes"] = nodes;
+        return placement;
+    }
+
+private:
+    static cpu_set_t mask_of(const std::vector<int>& cpus) {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (int cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &mask);
+            }
+        }
+        return mask;
+    }
+
+    // Node number to its cpulist text, from /sys; empty on hosts without NUMA sysfs
+    static std::map<int, std::string> node_cpulists() {
+        std::map<int, std::string> nodes;
+        for (int node = 0; node < 1024; ++node) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!in.good()) {
+                if (node > 0) {
+                    break;
+                }
+                continue;
+            }
+            std::string cpulist;
+            std::getline(in, cpulist);
+            nodes[node] = cpulist;
+        }
+        return nodes;
+    }
+
+    static std::set<int> nodes_of(const std::vector<int>& cpus) {
+        std::set<int> wanted(cpus.begin(), cpus.end());
+        std::set<int> nodes;
+        for (const auto& [node, cpulist] : node_cpulists()) {
+            for (int cpu : parse_cpu_list(cpulist)) {
+                if (wanted.count(cpu)) {
+                    nodes.insert(node);
+                    break;
+                }
+            }
+        }
+        return nodes;
+    }
+
+    // MPOL_PREFERRED: allocate from node while it has memory, without failing when it runs out
+    void prefer_node(int node) {
+        unsigned long nodemask[16] = {};
+        if (node >= static_cast<int>(sizeof(nodemask) * 8)) {
+            return;
+        }
+        nodemask[node / (sizeof(unsigned long) * 8)] |= 1UL << (node % (sizeof(unsigned long) * 8));
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask, sizeof(nodemask) * 8) == 0) {
+            preferred_node_ = node;
+        }
+    }
+
+    AffinityOptions options_;
+    std::atomic<size_t> next_{0};
+    int preferred_node_ = -1;
+};
+
+// Apply --cpus / --pin-threads for this process; call before loading data or starting threads
+inline void configure_affinity(int argc, char* argv[]) {
+    CpuAffinity::global().apply(AffinityOptions::from_args(argc, argv));
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // CPU_AFFINITY_HPP
@@ -0,0 +1,267 @@
+#ifndef DEDUP_WINDOW_HPP
+#define DEDUP_WINDOW_HPP
+
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "messaging.pb.h"
+#include "message_ids.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * How much state a receiver keeps to drop redelivered EXACTLY_ONCE messages.
+ *
+ * window      - sequences remembered per sender, rounded up to a multiple of 64;
+ *               a message this far behind its sender's newest is treated as a
+ *               duplicate, since it can no longer be told apart from one
+ * max_senders - sender windows kept; the least recently active is dropped
+ * id_capacity - string ids (peers without message_seq) remembered, at two
+ *               hash tables of twice this many 8-byte fingerprints
+ */
+struct DedupOptions {
+    int window = 4096;
+    int max_senders = 256;
+    int id_capacity = 16384;
+
+    // Parse --dedup-window N, --dedup-senders N and --dedup-ids N from the command line
+    static DedupOptions from_args(int argc, char* argv[]) {
+        DedupOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--dedup-window") == 0 && i + 1 < argc) {
+                options.window = std::max(64, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--dedup-senders") == 0 && i + 1 < argc) {
+                options.max_senders = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--dedup-ids") == 0 && i + 1 < argc) {
+                options.id_capacity = std::max(64, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+// What a dedup structure made of a message
+enum class Seen {
+    New,
+    Duplicate,
+    Expired,   // older than the window; cannot be told apart from a duplicate
+};
+
+/**
+ * Sliding bitmap of one sender's recent sequence numbers, as in IPsec
+ * anti-replay: bit s % window records sequence s for the window sequences up
+ * to the newest seen. Reordering within the window is fine; advancing clears
+ * only the bits being reused. window / 8 bytes, no allocation after
+ * construction.
+ */
+class SequenceWindow {
+public:
+    explicit SequenceWindow(size_t window = 4096)
+        : words_((std::max<size_t>(window, 64) + 63) / 64, 0), window_(words_.size() * 64) {}
+
+    size_t window() const { return window_; }
+    uint64_t newest() const { return newest_; }
+
+    // Record seq (> 0) and say whether it was seen before
+    Seen check_and_mark(uint64_t seq) {
+        if (seq > newest_) {
+            uint64_t advance = seq - newest_;
+            if (advance >= window_) {
+                std::fill(words_.begin(), words_.end(), 0);
+            } else {
+                for (uint64_t s = newest_ + 1; s < seq; ++s) {
+                    clear(s);
+                }
+            }
+            newest_ = seq;
+            set(seq);
+            return Seen::New;
+        }
+        if (newest_ - seq >= window_) {
+            return Seen::Expired;
+        }
+        if (test(seq)) {
+            return Seen::Duplicate;
+        }
+        set(seq);
+        return Seen::New;
+    }
+
+private:
+    bool test(uint64_t s) const { return words_[(s % window_) / 64] >> (s % 64) & 1; }
+    void set(uint64_t s) { words_[(s % window_) / 64] |= 1ULL << (s % 64); }
+    void clear(uint64_t s) { words_[(s % window_) / 64] &= ~(1ULL << (s % 64)); }
+
+    std::vector<uint64_t> words_;
+    size_t window_;
+    uint64_t newest_ = 0;
+};
+
+/**
+ * Recently seen string ids, as 64-bit fingerprints in two fixed open-addressed
+ * tables: inserts go to the current table, and once it holds capacity ids it
+ * becomes the previous one and the old previous is cleared. Between capacity
+ * and twice that many of the latest ids are remembered in fixed memory. Two
+ * distinct ids collide with probability about capacity / 2^64. The tables
+ * are allocated on first use, so receivers that never see such ids pay nothing.
+ */
+class FingerprintWindow {
+public:
+    explicit FingerprintWindow(size_t capacity = 16384)
+        : capacity_(std::max<size_t>(capacity, 64)) {}
+
+    Seen check_and_mark(std::string_view id) {
+        if (current_.empty()) {
+            size_t slots = 1;
+            while (slots < 2 * capacity_) {
+                slots <<= 1;
+            }
+            current_.assign(slots, 0);
+            previous_.assign(slots, 0);
+        }
+        uint64_t fp = fingerprint(id);
+        if (contains(previous_, fp) || contains(current_, fp)) {
+            return Seen::Duplicate;
+        }
+        if (count_ >= capacity_) {
+            std::swap(previous_, current_);
+            std::fill(current_.begin(), current_.end(), 0);
+            count_ = 0;
+        }
+        insert(current_, fp);
+        count_++;
+        return Seen::New;
+    }
+
+    size_t bytes() const { return (current_.size() + previous_.size()) * sizeof(uint64_t); }
+
+private:
+    // FNV-1a with a splitmix64 finish; 0 marks an empty slot, so it is never a fingerprint
+    static uint64_t fingerprint(std::string_view id) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (char c : id) {
+            h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+        }
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h ? h : 1;
+    }
+
+    static bool contains(const std::vector<uint64_t>& table, uint64_t fp) {
+        size_t mask = table.size() - 1;
+        for (size_t i = fp & mask; table[i] != 0; i = (i + 1) & mask) {
+            if (table[i] == fp) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void insert(std::vector<uint64_t>& table, uint64_t fp) {
+        size_t mask = table.size() - 1;
+        size_t i = fp & mask;
+        while (table[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        table[i] = fp;
+    }
+
+    size_t capacity_;
+    size_t count_ = 0;
+    std::vector<uint64_t> current_;
+    std::vector<uint64_t> previous_;
+};
+
+/**
+ * Receiver-side duplicate filter for EXACTLY_ONCE delivery, in bounded memory.
+ *
+ * Messages with a message_seq are checked against their sender's
+ * SequenceWindow; the rest (peers that only set the string message_id) go to
+ * one FingerprintWindow. Unlike a set of id strings this stops growing: at
+ * most max_senders windows of window bits, plus the fingerprint tables. A
+ * duplicate should still be ACKed, so the sender stops retransmitting, but
+ * not processed or counted again. Not thread-safe; one per receiver.
+ */
+class DedupFilter {
+public:
+    explicit DedupFilter(const DedupOptions& options = DedupOptions())
+        : options_(options), ids_(static_cast<size_t>(options.id_capacity)) {}
+
+    Seen check_and_mark(const ::messaging::MessageEnvelope& message) {
+        Seen seen = message.message_seq() ? window_for(sender_of(message.message_seq()))
+                                                .check_and_mark(sequence_of(message.message_seq()))
+                                          : ids_.check_and_mark(message.message_id());
+        if (seen == Seen::Duplicate) {
+            duplicates_++;
+        } else if (seen == Seen::Expired) {
+            expired_++;
+        }
+        return seen;
+    }
+
+    int64_t duplicates() const { return duplicates_; }
+    int64_t expired() const { return expired_; }
+
+    // Counters and memory held, for the receiver's stats
+    nlohmann::json report() const {
+        size_t bytes = ids_.bytes();
+        for (const auto& [sender, entry] : senders_) {
+            bytes += entry.window.window() / 8;
+        }
+        return {
+            {"duplicates", duplicates_},
+            {"expired", expired_},
+            {"senders", senders_.size()},
+            {"evicted_senders", evicted_},
+            {"window", options_.window},
+            {"bytes", bytes}
+        };
+    }
+
+private:
+    struct Sender {
+        SequenceWindow window;
+        uint64_t last_used = 0;
+    };
+
+    SequenceWindow& window_for(uint32_t sender) {
+        auto it = senders_.find(sender);
+        if (it == senders_.end()) {
+            if (senders_.size() >= static_cast<size_t>(options_.max_senders)) {
+                evict_oldest();
+            }
+            it = senders_.emplace(sender, Sender{SequenceWindow(options_.window)}).first;
+        }
+        it->second.last_used = ++clock_;
+        return it->second.window;
+    }
+
+    // Rare: only when more senders than max_senders have been seen
+    void evict_oldest() {
+        auto oldest = std::min_element(senders_.begin(), senders_.end(), [](const auto& a, const auto& b) {
+            return a.second.last_used < b.second.last_used;
+        });
+        senders_.erase(oldest);
+        evicted_++;
+    }
+
+    DedupOptions options_;
+    std::unordered_map<uint32_t, Sender> senders_;
+    FingerprintWindow ids_;
+    uint64_t clock_ = 0;
+    int64_t duplicates_ = 0;
+    int64_t expired_ = 0;
+    int64_t evicted_ = 0;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // DEDUP_WINDOW_HPP
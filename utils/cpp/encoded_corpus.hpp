@@ -0,0 +1,491 @@
+#ifndef ENCODED_CORPUS_HPP
+#define ENCODED_CORPUS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include "json.hpp"
+#include "message_helpers.hpp"
+#include "test_data_loader.hpp"
+#include "envelope_view.hpp"
+#include "payload_pool.hpp"
+#include "payload_codec.hpp"
+#include "qos_options.hpp"
+
+/**
+ * @brief Pre-encoded message corpus - test data serialized once, before the clock starts.
+ *
+ * Senders used to convert each nlohmann::json item to a MessageEnvelope and
+ * serialize it inside the timed loop, so throughput numbers included JSON and
+ * protobuf encoding cost. EncodedCorpus does that conversion up front and keeps
+ * every envelope's wire bytes in one contiguous buffer, indexed by offset.
+ *
+ * Per-send fields are left as fixed-width slots at the end of each record:
+ * timestamp (field 7) and timestamp_us (field 12) are encoded as padded
+ * 10-byte varints, which protobuf parsers accept, so they can be overwritten in
+ * place with any value. reply_to differs per connection and is appended as a
+ * metadata map entry by encode().
+ *
+ * With attach_payloads(), each message also carries a synthetic payload of a
+ * drawn size (see payload_pool.hpp). encode() then appends a second payload
+ * field: the item's DataMessage followed by one more message_value holding
+ * the filler bytes. Parsers keep the last occurrence of a bytes field, so
+ * the receiver sees the item plus the filler, and the filler is copied once
+ * per send instead of being stored per message.
+ *
+ * With attach_compression(), encode() compresses every payload at or above
+ * the threshold as it sends it, so the cost is paid per send as it would be
+ * by an application. The compressed bytes replace the record's own payload
+ * field, so only they go on the wire, and content-encoding and content-length
+ * metadata entries tell the receiver how to restore them (see payload_codec.hpp).
+ *
+ * Usage:
+ *   auto corpus = test_data_loader::preEncodeTestFile();  // streams test_data.bin/.json
+ *   // or: auto corpus = test_data_loader::preEncodeTestData(test_data);
+ *   // ... start clock ...
+ *   std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
+ */
+namespace test_data_loader {
+
+    class EncodedCorpus {
+    public:
+        explicit EncodedCorpus(messaging::RoutingMode routing = messaging::RoutingMode::REQUEST_REPLY)
+            : routing_(routing) {}
+
+        /**
+         * @brief Encode every item as a DATA_MESSAGE envelope with the given routing.
+         * @throws std::runtime_error If an item cannot be converted.
+         */
+        explicit EncodedCorpus(const std::vector<nlohmann::json>& items,
+                               messaging::RoutingMode routing = messaging::RoutingMode::REQUEST_REPLY)
+            : routing_(routing) {
+            reserve(items.size());
+            for (const auto& item : items) {
+                append(item);
+            }
+        }
+
+        void reserve(size_t count) { records_.reserve(count); }
+
+        /**
+         * @brief Encode one more item; lets a corpus be built while streaming the test file.
+         * @throws std::runtime_error If the item cannot be converted.
+         */
+        void append(const nlohmann::json& item) {
+            try {
+                message_helpers::fill_data_envelope(&envelope_, &data_msg_, item, routing_);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("Failed to encode message " + std::to_string(records_.size()) + ": " + e.what());
+            }
+            // Timestamps live in the trailing slots instead
+            envelope_.clear_timestamp();
+            envelope_.clear_timestamp_us();
+            message_helpers::serialize_envelope(envelope_, scratch_);
+
+            Record record;
+            record.offset = buffer_.size();
+            record.target = envelope_.target();
+            record.id_offset = ids_.size();
+            record.id_size = envelope_.message_id().size();
+            ids_ += envelope_.message_id();
+
+            buffer_ += scratch_;
+            record.stamp_offset = buffer_.size();
+            append_slot(kTimestampTag);
+            append_slot(kTimestampUsTag);
+            record.size = buffer_.size() - record.offset;
+
+            records_.push_back(record);
+        }
+
+        size_t size() const { return records_.size(); }
+        bool empty() const { return records_.empty(); }
+
+        // Total bytes of encoded envelopes, without synthetic payloads
+        size_t encoded_bytes() const { return buffer_.size(); }
+
+        /**
+         * @brief Give every message a synthetic payload drawn from spec.
+         *
+         * Call after the corpus is built and before the clock starts; a
+         * disabled spec leaves messages as they are.
+         * @throws std::runtime_error If a record cannot be re-parsed.
+         */
+        void attach_payloads(const messaging::utils::PayloadSpec& spec) {
+            payloads_ = messaging::utils::PayloadPool(spec, records_.size());
+            if (payloads_.enabled()) {
+                locate_payloads();
+            }
+        }
+
+        const messaging::utils::PayloadPool& payloads() const { return payloads_; }
+
+        /**
+         * @brief Stamp the --qos level into every message's qos field.
+         *
+         * Call before the clock starts; at most once leaves messages as they
+         * are, since receivers treat an unset qos the same way.
+         */
+        void attach_qos(const messaging::utils::QoSOptions& qos) {
+            if (!qos.enabled()) {
+                return;
+            }
+            std::string rebuilt;
+            rebuilt.reserve(buffer_.size() + 2 * records_.size());
+            for (Record& r : records_) {
+                // Ahead of the timestamp slots, which stay at the end of the record
+                size_t offset = rebuilt.size();
+                size_t head = r.stamp_offset - r.offset;
+                rebuilt.append(buffer_, r.offset, head);
+                rebuilt.push_back(kQosTag);
+                rebuilt.push_back(static_cast<char>(qos.level));
+                rebuilt.append(buffer_, r.stamp_offset, r.size - head);
+                r.offset = offset;
+                r.stamp_offset = offset + head + 2;
+                r.size += 2;
+            }
+            buffer_.swap(rebuilt);
+        }
+
+        /**
+         * @brief Compress payloads per send as options say.
+         *
+         * Call after attach_payloads() and before the clock starts: with a
+         * dictionary path, this trains the zstd dictionary on the payloads,
+         * one sample per message up to kDictSamplesPerByte times its size.
+         * A disabled option leaves messages as they are.
+         * @throws std::runtime_error If a record cannot be re-parsed.
+         */
+        void attach_compression(const messaging::utils::CompressionOptions& options) {
+            if (!options.enabled()) {
+                compressor_.reset();
+                return;
+            }
+            locate_payloads();
+            compressor_ = std::make_shared<messaging::utils::PayloadCompressor>(options);
+            if (options.dict_path.empty()) {
+                return;
+            }
+            std::string samples;
+            std::vector<size_t> sizes;
+            std::string payload;
+            size_t budget = options.dict_bytes * kDictSamplesPerByte;
+            for (size_t i = 0; i < records_.size() && samples.size() < budget; ++i) {
+                payload.clear();
+                append_raw_payload(payload, records_[i], i);
+                size_t size = std::min({payload.size(), kMaxDictSample, budget - samples.size()});
+                samples.append(payload, 0, size);
+                sizes.push_back(size);
+            }
+            compressor_->train(samples, sizes);
+        }
+
+        // Counts, ratio and timing of the run's compression; null without attach_compression
+        const messaging::utils::PayloadCompressor* compressor() const { return compressor_.get(); }
+
+        // Synthetic payload bytes of message i (0 without attach_payloads)
+        size_t payload_size(size_t i) const { return payloads_.enabled() ? payloads_.size(i) : 0; }
+
+        // Bytes encode() sends for message i, before reply_to and compression
+        size_t wire_size(size_t i) const {
+            const Record& r = records_[i];
+            if (!payloads_.enabled()) {
+                return r.size;
+            }
+            size_t data_size = r.data_size + payloads_.value_field_size(i);
+            return r.size + 1 + varint_size(data_size) + data_size;
+        }
+
+        // Mean of wire_size() over the corpus
+        double mean_wire_bytes() const {
+            if (records_.empty()) {
+                return 0.0;
+            }
+            double total = 0;
+            for (size_t i = 0; i < records_.size(); ++i) {
+                total += static_cast<double>(wire_size(i));
+            }
+            return total / records_.size();
+        }
+
+        std::string_view message_id(size_t i) const {
+            const Record& r = records_[i];
+            return std::string_view(ids_.data() + r.id_offset, r.id_size);
+        }
+
+        int target(size_t i) const { return records_[i].target; }
+
+        // Wire bytes of message i as last stamped
+        std::string_view bytes(size_t i) const {
+            const Record& r = records_[i];
+            return std::string_view(buffer_.data() + r.offset, r.size);
+        }
+
+        /**
+         * @brief Patch message i's timestamps in place and return its wire bytes.
+         *
+         * Writes into the shared buffer, so concurrent senders must not stamp the
+         * same index at once; use encode() when messages are sent from several threads.
+         * With synthetic payloads the message is built in a per-thread buffer
+         * instead, and the view is valid until this thread's next stamp().
+         */
+        std::string_view stamp(size_t i, int64_t now_us) {
+            if (payloads_.enabled() || compressor_) {
+                thread_local std::string out;
+                return encode(i, now_us, {}, out);
+            }
+            TRACE_SCOPE("encode");
+            write_timestamps(&buffer_[records_[i].stamp_offset], now_us);
+            return bytes(i);
+        }
+
+        /**
+         * @brief Copy message i into out with fresh timestamps and optional reply_to metadata.
+         *
+         * out keeps its capacity across calls, so reusing one buffer per thread
+         * makes this allocation-free once it has grown to the largest message.
+         */
+        const std::string& encode(size_t i, int64_t now_us, std::string_view reply_to, std::string& out) const {
+            TRACE_SCOPE("encode");
+            const Record& r = records_[i];
+            if (compressor_ && compressor_->wants(raw_payload_size(r, i))) {
+                // Copy the record around its payload field, which the packed one replaces
+                const char* record = buffer_.data() + r.offset;
+                size_t tail = r.field_offset + r.field_size;
+                out.assign(record, r.field_offset);
+                out.append(record + tail, r.size - tail);
+                write_timestamps(&out[r.stamp_offset - r.offset - r.field_size], now_us);
+                append_compressed_payload(out, r, i);
+            } else {
+                out.assign(buffer_.data() + r.offset, r.size);
+                write_timestamps(&out[r.stamp_offset - r.offset], now_us);
+                if (payloads_.enabled()) {
+                    append_payload(out, r, i);
+                }
+            }
+            if (!reply_to.empty()) {
+                append_reply_to(out, reply_to);
+            }
+            return out;
+        }
+
+        /**
+         * @brief encode() for a PUBLISH_SUBSCRIBE or FANOUT send: message i on topic, numbered seq.
+         *
+         * The topic and message_seq fields are appended after the record's
+         * own, so every subscriber can tell from seq which publications it
+         * missed; build the corpus with the publisher's routing.
+         */
+        const std::string& encode_publication(size_t i, int64_t now_us, std::string_view topic, uint64_t seq,
+                                              std::string& out) const {
+            encode(i, now_us, {}, out);
+            out.push_back(kTopicTag);
+            append_varint(out, topic.size());
+            out.append(topic);
+            out.push_back(kMessageSeqTag);
+            for (int k = 0; k < 8; ++k) {
+                out.push_back(static_cast<char>(seq >> (8 * k)));
+            }
+            return out;
+        }
+
+    private:
+        struct Record {
+            size_t offset = 0;
+            size_t size = 0;
+            size_t stamp_offset = 0;
+            size_t id_offset = 0;
+            size_t id_size = 0;
+            int target = 0;
+            // The item's DataMessage within the record and the whole payload
+            // field holding it (0 bytes if absent), set by locate_payloads()
+            size_t data_offset = 0;
+            size_t data_size = 0;
+            size_t field_offset = 0;
+            size_t field_size = 0;
+        };
+
+        // Field number << 3 | wire type (0 = varint, 1 = 64-bit, 2 = length-delimited)
+        static constexpr char kTimestampTag = (7 << 3) | 0;
+        static constexpr char kTimestampUsTag = (12 << 3) | 0;
+        static constexpr char kMetadataTag = (10 << 3) | 2;
+        static constexpr char kPayloadTag = (5 << 3) | 2;
+        static constexpr char kTopicTag = (3 << 3) | 2;
+        static constexpr char kMessageSeqTag = (13 << 3) | 1;  // fixed64
+        static constexpr char kQosTag = (9 << 3) | 0;
+        static constexpr size_t kVarintSlot = 10;
+        static constexpr size_t kSlotSize = 1 + kVarintSlot;
+        // Dictionary training input: zstd suggests about 100x the dictionary, and long samples add little
+        static constexpr size_t kDictSamplesPerByte = 100;
+        static constexpr size_t kMaxDictSample = 16 * 1024;
+
+        // Find each record's DataMessage, once, for the payload and compression paths
+        void locate_payloads() {
+            if (payloads_located_) {
+                return;
+            }
+            messaging::utils::EnvelopeView view;
+            for (size_t i = 0; i < records_.size(); ++i) {
+                Record& r = records_[i];
+                std::string_view record = bytes(i);
+                if (!view.parse(record.data(), record.size())) {
+                    throw std::runtime_error("Failed to re-parse message " + std::to_string(i));
+                }
+                if (view.payload.empty()) {
+                    r.data_offset = r.data_size = r.field_offset = r.field_size = 0;
+                    continue;
+                }
+                r.data_offset = static_cast<size_t>(view.payload.data() - record.data());
+                r.data_size = view.payload.size();
+                size_t header = 1 + varint_size(r.data_size);
+                if (r.data_offset < header || record[r.data_offset - header] != kPayloadTag) {
+                    throw std::runtime_error("Unexpected payload field in message " + std::to_string(i));
+                }
+                r.field_offset = r.data_offset - header;
+                r.field_size = header + r.data_size;
+            }
+            payloads_located_ = true;
+        }
+
+        void append_slot(char tag) {
+            buffer_.push_back(tag);
+            buffer_.append(kVarintSlot - 1, static_cast<char>(0x80));
+            buffer_.push_back(0);
+        }
+
+        // Padded to the full 10 bytes, so every value fits the reserved slot
+        static void write_padded_varint(char* p, uint64_t value) {
+            for (size_t k = 0; k < kVarintSlot - 1; ++k) {
+                p[k] = static_cast<char>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            p[kVarintSlot - 1] = static_cast<char>(value & 0x01);
+        }
+
+        static void write_timestamps(char* slots, int64_t now_us) {
+            write_padded_varint(slots + 1, static_cast<uint64_t>(now_us / 1000));
+            write_padded_varint(slots + kSlotSize + 1, static_cast<uint64_t>(now_us));
+        }
+
+        static void append_varint(std::string& out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        // Size of message i's payload as sent uncompressed: the DataMessage and any filler
+        size_t raw_payload_size(const Record& r, size_t i) const {
+            return r.data_size + (payloads_.enabled() ? payloads_.value_field_size(i) : 0);
+        }
+
+        void append_raw_payload(std::string& out, const Record& r, size_t i) const {
+            out.append(buffer_, r.offset + r.data_offset, r.data_size);
+            if (payloads_.enabled()) {
+                payloads_.append_value(out, i);
+            }
+        }
+
+        // A second payload field: the item's DataMessage plus one message_value of filler
+        void append_payload(std::string& out, const Record& r, size_t i) const {
+            out.reserve(out.size() + wire_size(i) - r.size + 64);
+            out.push_back(kPayloadTag);
+            append_varint(out, raw_payload_size(r, i));
+            append_raw_payload(out, r, i);
+        }
+
+        // The payload field, compressed, or raw if it does not shrink; out holds the record without its own
+        void append_compressed_payload(std::string& out, const Record& r, size_t i) const {
+            TRACE_SCOPE("compress");
+            thread_local std::string raw;
+            thread_local std::string packed;
+            raw.clear();
+            append_raw_payload(raw, r, i);
+            if (!compressor_->compress(raw, packed)) {
+                out.push_back(kPayloadTag);
+                append_varint(out, raw.size());
+                out.append(raw);
+                return;
+            }
+            out.push_back(kPayloadTag);
+            append_varint(out, packed.size());
+            out.append(packed);
+            append_metadata(out, messaging::utils::kContentEncodingKey, compressor_->codec_name());
+            char length[24];
+            int n = snprintf(length, sizeof(length), "%zu", raw.size());
+            append_metadata(out, messaging::utils::kContentLengthKey, std::string_view(length, n));
+        }
+
+        static void append_reply_to(std::string& out, std::string_view reply_to) {
+            append_metadata(out, "reply_to", reply_to);
+        }
+
+        // Map entries are messages {1: key, 2: value}; a later entry for a key wins
+        static void append_metadata(std::string& out, std::string_view key, std::string_view value) {
+            size_t entry_size = 1 + varint_size(key.size()) + key.size() + 1 + varint_size(value.size()) + value.size();
+            out.push_back(kMetadataTag);
+            append_varint(out, entry_size);
+            out.push_back((1 << 3) | 2);
+            append_varint(out, key.size());
+            out.append(key);
+            out.push_back((2 << 3) | 2);
+            append_varint(out, value.size());
+            out.append(value);
+        }
+
+        static size_t varint_size(uint64_t value) {
+            size_t n = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                n++;
+            }
+            return n;
+        }
+
+        messaging::RoutingMode routing_;
+        std::string buffer_;
+        std::string ids_;
+        std::vector<Record> records_;
+        messaging::utils::PayloadPool payloads_;
+        bool payloads_located_ = false;
+        std::shared_ptr<messaging::utils::PayloadCompressor> compressor_;
+
+        // Build-time scratch reused by append()
+        messaging::MessageEnvelope envelope_;
+        messaging::DataMessage data_msg_;
+        std::string scratch_;
+    };
+
+    /**
+     * @brief Encode test data into a corpus of ready-to-send envelopes.
+     *
+     * Call before starting the timed region; only stamp()/encode() run per send.
+     */
+    inline EncodedCorpus preEncodeTestData(const std::vector<nlohmann::json>& test_data,
+                                           messaging::RoutingMode routing = messaging::RoutingMode::REQUEST_REPLY) {
+        return EncodedCorpus(test_data, routing);
+    }
+
+    /**
+     * @brief Stream the test corpus file straight into an encoded corpus.
+     *
+     * Never materializes the json items, so memory is just the encoded bytes;
+     * reads test_data.bin when present (see resolveCorpusPath()).
+     * @throws std::runtime_error If the file cannot be read or an item cannot be converted.
+     */
+    inline EncodedCorpus preEncodeTestFile(const std::string& data_path = "",
+                                           messaging::RoutingMode routing = messaging::RoutingMode::REQUEST_REPLY) {
+        EncodedCorpus corpus(routing);
+        corpus.reserve(getTestDataCount(data_path));
+        forEachTestItem(data_path, [&](const nlohmann::json& item) { corpus.append(item); });
+        return corpus;
+    }
+
+} // namespace test_data_loader
+
+#endif // ENCODED_CORPUS_HPP
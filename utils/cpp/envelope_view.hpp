@@ -0,0 +1,516 @@
+#ifndef ENVELOPE_VIEW_HPP
+#define ENVELOPE_VIEW_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "messaging.pb.h"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Vector that keeps its first N elements inline and only touches the heap
+ * past that. Envelopes carry zero to a handful of metadata entries, so the
+ * common case never allocates.
+ */
+template <typename T, size_t N>
+class SmallVector {
+public:
+    SmallVector() = default;
+
+    void push_back(const T& value) {
+        if (heap_.empty() && size_ < N) {
+            inline_[size_++] = value;
+            return;
+        }
+        if (heap_.empty()) {
+            heap_.assign(inline_, inline_ + size_);
+        }
+        heap_.push_back(value);
+        size_++;
+    }
+
+    void clear() {
+        size_ = 0;
+        heap_.clear();
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T* begin() const { return heap_.empty() ? inline_ : heap_.data(); }
+    const T* end() const { return begin() + size_; }
+    const T& operator[](size_t i) const { return begin()[i]; }
+
+private:
+    T inline_[N] = {};
+    size_t size_ = 0;
+    std::vector<T> heap_;
+};
+
+/**
+ * Non-owning view of an Acknowledgment: every string points into the buffer
+ * (or proto) it was read from.
+ */
+struct AckView {
+    std::string_view original_message_id;
+    uint64_t original_message_seq = 0;
+    bool received = false;
+    double latency_ms = 0.0;
+    std::string_view receiver_id;
+    std::string_view status;
+    ::messaging::AckStatus status_code = ::messaging::ACK_STATUS_UNSPECIFIED;
+    int64_t received_at_us = 0;
+    int64_t processing_ns = 0;
+    int64_t acked_at_us = 0;
+    int64_t decompress_ns = 0;
+};
+
+/**
+ * Flat, non-owning MessageEnvelope.
+ *
+ * Strings and the payload are views and metadata is a SmallVector of view
+ * pairs, so building one from a received buffer, a proto or caller data
+ * copies nothing. encode() writes the protobuf wire format straight into a
+ * caller buffer, and parse() reads it back without an intermediate
+ * ::messaging::MessageEnvelope; both are wire-compatible with the generated
+ * code. A view is valid only while whatever it points into is.
+ */
+class EnvelopeView {
+public:
+    using MetadataEntry = std::pair<std::string_view, std::string_view>;
+
+    std::string_view message_id;
+    uint64_t message_seq = 0;
+    int32_t target = 0;
+    std::string_view topic;
+    ::messaging::MessageType type = ::messaging::MESSAGE_TYPE_UNSPECIFIED;
+    std::string_view payload;
+    bool async = false;
+    int64_t timestamp = 0;
+    int64_t timestamp_us = 0;
+    ::messaging::RoutingMode routing = ::messaging::ROUTING_UNSPECIFIED;
+    ::messaging::QoSLevel qos = ::messaging::QOS_UNSPECIFIED;
+    SmallVector<MetadataEntry, 4> metadata;
+    bool has_ack = false;
+    AckView ack;
+
+    void clear() { *this = EnvelopeView(); }
+
+    void add_metadata(std::string_view key, std::string_view value) { metadata.push_back({key, value}); }
+
+    // Value for key (the last entry wins, as in a proto map), or nullptr
+    const std::string_view* find_metadata(std::string_view key) const {
+        for (size_t i = metadata.size(); i-- > 0;) {
+            if (metadata[i].first == key) {
+                return &metadata[i].second;
+            }
+        }
+        return nullptr;
+    }
+
+    // ------------------------------------------------------------------
+    // Encoding
+    // ------------------------------------------------------------------
+
+    // Exact size of encode()'s output
+    size_t encoded_size() const {
+        size_t n = 0;
+        n += string_field_size(message_id);
+        n += varint_field_size(static_cast<int64_t>(target));
+        n += string_field_size(topic);
+        n += varint_field_size(type);
+        n += string_field_size(payload);
+        n += varint_field_size(async);
+        n += varint_field_size(timestamp);
+        n += varint_field_size(routing);
+        n += varint_field_size(qos);
+        for (const auto& entry : metadata) {
+            size_t entry_size = map_entry_size(entry);
+            n += 1 + varint_size(entry_size) + entry_size;
+        }
+        if (has_ack) {
+            size_t ack_size = ack_encoded_size();
+            n += 1 + varint_size(ack_size) + ack_size;
+        }
+        n += varint_field_size(timestamp_us);
+        n += message_seq ? 1 + 8 : 0;
+        return n;
+    }
+
+    // Write the wire format to out, which must hold encoded_size() bytes; returns the end
+    uint8_t* encode_to(uint8_t* out) const {
+        out = put_string(out, 1, message_id);
+        out = put_varint_field(out, 2, static_cast<int64_t>(target));
+        out = put_string(out, 3, topic);
+        out = put_varint_field(out, 4, type);
+        out = put_string(out, 5, payload);
+        out = put_varint_field(out, 6, async);
+        out = put_varint_field(out, 7, timestamp);
+        out = put_varint_field(out, 8, routing);
+        out = put_varint_field(out, 9, qos);
+        for (const auto& entry : metadata) {
+            out = put_tag(out, 10, kLengthDelimited);
+            out = put_varint(out, map_entry_size(entry));
+            // Map entries always carry both fields, as the generated code writes them
+            out = put_string(out, 1, entry.first, true);
+            out = put_string(out, 2, entry.second, true);
+        }
+        if (has_ack) {
+            out = put_tag(out, 11, kLengthDelimited);
+            out = put_varint(out, ack_encoded_size());
+            out = put_string(out, 1, ack.original_message_id);
+            out = put_varint_field(out, 2, ack.received);
+            if (ack.latency_ms != 0.0) {
+                uint64_t bits;
+                std::memcpy(&bits, &ack.latency_ms, sizeof(bits));
+                out = put_fixed64(put_tag(out, 3, kFixed64), bits);
+            }
+            out = put_string(out, 4, ack.receiver_id);
+            out = put_string(out, 5, ack.status);
+            if (ack.original_message_seq) {
+                out = put_fixed64(put_tag(out, 6, kFixed64), ack.original_message_seq);
+            }
+            out = put_varint_field(out, 7, ack.status_code);
+            out = put_varint_field(out, 8, ack.received_at_us);
+            out = put_varint_field(out, 9, ack.processing_ns);
+            out = put_varint_field(out, 10, ack.acked_at_us);
+            out = put_varint_field(out, 11, ack.decompress_ns);
+        }
+        out = put_varint_field(out, 12, timestamp_us);
+        if (message_seq) {
+            out = put_fixed64(put_tag(out, 13, kFixed64), message_seq);
+        }
+        return out;
+    }
+
+    // Encode into a reused buffer; only grows it past the largest message so far
+    const std::string& encode(std::string& buffer) const {
+        buffer.resize(encoded_size());
+        if (!buffer.empty()) {
+            encode_to(reinterpret_cast<uint8_t*>(&buffer[0]));
+        }
+        return buffer;
+    }
+
+    // ------------------------------------------------------------------
+    // Parsing
+    // ------------------------------------------------------------------
+
+    /**
+     * @brief Read a wire-format MessageEnvelope, pointing every field into data.
+     *
+     * Unknown fields are skipped, so newer peers can add fields freely.
+     * @return false if the bytes are not a well-formed envelope
+     */
+    bool parse(const void* data, size_t size) {
+        clear();
+        Reader in{static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size};
+        while (in.p < in.end) {
+            uint64_t key;
+            if (!in.varint(key)) {
+                return false;
+            }
+            uint32_t field = static_cast<uint32_t>(key >> 3);
+            int wire = static_cast<int>(key & 7);
+            uint64_t v = 0;
+            std::string_view s;
+            switch (field) {
+                case 1: if (!in.string(wire, message_id)) return false; break;
+                case 2: if (!in.varint(wire, v)) return false; target = static_cast<int32_t>(v); break;
+                case 3: if (!in.string(wire, topic)) return false; break;
+                case 4: if (!in.varint(wire, v)) return false; type = static_cast<::messaging::MessageType>(v); break;
+                case 5: if (!in.string(wire, payload)) return false; break;
+                case 6: if (!in.varint(wire, v)) return false; async = v != 0; break;
+                case 7: if (!in.varint(wire, v)) return false; timestamp = static_cast<int64_t>(v); break;
+                case 8: if (!in.varint(wire, v)) return false; routing = static_cast<::messaging::RoutingMode>(v); break;
+                case 9: if (!in.varint(wire, v)) return false; qos = static_cast<::messaging::QoSLevel>(v); break;
+                case 10:
+                    if (!in.string(wire, s) || !parse_map_entry(s)) return false;
+                    break;
+                case 11:
+                    if (!in.string(wire, s) || !parse_ack(s)) return false;
+                    has_ack = true;
+                    break;
+                case 12: if (!in.varint(wire, v)) return false; timestamp_us = static_cast<int64_t>(v); break;
+                case 13: if (!in.fixed64(wire, message_seq)) return false; break;
+                default:
+                    if (!in.skip(wire)) return false;
+            }
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------
+    // Generated-code interop
+    // ------------------------------------------------------------------
+
+    // View env's fields in place; valid while env is alive and unmodified
+    static EnvelopeView of(const ::messaging::MessageEnvelope& env) {
+        EnvelopeView view;
+        view.message_id = env.message_id();
+        view.message_seq = env.message_seq();
+        view.target = env.target();
+        view.topic = env.topic();
+        view.type = env.type();
+        view.payload = env.payload();
+        view.async = env.async();
+        view.timestamp = env.timestamp();
+        view.timestamp_us = env.timestamp_us();
+        view.routing = env.routing();
+        view.qos = env.qos();
+        for (const auto& kv : env.metadata()) {
+            view.add_metadata(kv.first, kv.second);
+        }
+        if (env.has_ack()) {
+            const ::messaging::Acknowledgment& a = env.ack();
+            view.has_ack = true;
+            view.ack.original_message_id = a.original_message_id();
+            view.ack.original_message_seq = a.original_message_seq();
+            view.ack.received = a.received();
+            view.ack.latency_ms = a.latency_ms();
+            view.ack.receiver_id = a.receiver_id();
+            view.ack.status = a.status();
+            view.ack.status_code = a.status_code();
+            view.ack.received_at_us = a.received_at_us();
+            view.ack.processing_ns = a.processing_ns();
+            view.ack.acked_at_us = a.acked_at_us();
+            view.ack.decompress_ns = a.decompress_ns();
+        }
+        return view;
+    }
+
+    // Copy into env, reusing its storage
+    void to_proto(::messaging::MessageEnvelope* env) const {
+        env->Clear();
+        env->mutable_message_id()->assign(message_id.data(), message_id.size());
+        env->set_message_seq(message_seq);
+        env->set_target(target);
+        env->mutable_topic()->assign(topic.data(), topic.size());
+        env->set_type(type);
+        env->mutable_payload()->assign(payload.data(), payload.size());
+        env->set_async(async);
+        env->set_timestamp(timestamp);
+        env->set_timestamp_us(timestamp_us);
+        env->set_routing(routing);
+        env->set_qos(qos);
+        auto& meta = *env->mutable_metadata();
+        for (const auto& entry : metadata) {
+            meta[std::string(entry.first)] = std::string(entry.second);
+        }
+        if (has_ack) {
+            ::messaging::Acknowledgment* a = env->mutable_ack();
+            a->mutable_original_message_id()->assign(ack.original_message_id.data(), ack.original_message_id.size());
+            a->set_original_message_seq(ack.original_message_seq);
+            a->set_received(ack.received);
+            a->set_latency_ms(ack.latency_ms);
+            a->mutable_receiver_id()->assign(ack.receiver_id.data(), ack.receiver_id.size());
+            a->mutable_status()->assign(ack.status.data(), ack.status.size());
+            a->set_status_code(ack.status_code);
+            a->set_received_at_us(ack.received_at_us);
+            a->set_processing_ns(ack.processing_ns);
+            a->set_acked_at_us(ack.acked_at_us);
+            a->set_decompress_ns(ack.decompress_ns);
+        }
+    }
+
+private:
+    static constexpr int kVarint = 0;
+    static constexpr int kFixed64 = 1;
+    static constexpr int kLengthDelimited = 2;
+    static constexpr int kFixed32 = 5;
+
+    // Bounds-checked cursor over wire bytes
+    struct Reader {
+        const uint8_t* p;
+        const uint8_t* end;
+
+        bool varint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && p < end; shift += 7) {
+                uint8_t byte = *p++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool varint(int wire, uint64_t& value) { return wire == kVarint && varint(value); }
+
+        bool fixed64(int wire, uint64_t& value) {
+            if (wire != kFixed64 || end - p < 8) {
+                return false;
+            }
+            value = 0;
+            for (int i = 7; i >= 0; --i) {
+                value = (value << 8) | p[i];
+            }
+            p += 8;
+            return true;
+        }
+
+        bool string(int wire, std::string_view& value) {
+            uint64_t len;
+            if (wire != kLengthDelimited || !varint(len) || len > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            value = std::string_view(reinterpret_cast<const char*>(p), static_cast<size_t>(len));
+            p += len;
+            return true;
+        }
+
+        bool skip(int wire) {
+            uint64_t v;
+            std::string_view s;
+            switch (wire) {
+                case kVarint: return varint(v);
+                case kFixed64: return fixed64(wire, v);
+                case kLengthDelimited: return string(wire, s);
+                case kFixed32:
+                    if (end - p < 4) return false;
+                    p += 4;
+                    return true;
+                default: return false;  // groups are not used by proto3
+            }
+        }
+    };
+
+    bool parse_map_entry(std::string_view bytes) {
+        Reader in{reinterpret_cast<const uint8_t*>(bytes.data()),
+                  reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size()};
+        MetadataEntry entry;
+        while (in.p < in.end) {
+            uint64_t key;
+            if (!in.varint(key)) {
+                return false;
+            }
+            int wire = static_cast<int>(key & 7);
+            bool ok = (key >> 3) == 1 ? in.string(wire, entry.first)
+                    : (key >> 3) == 2 ? in.string(wire, entry.second)
+                    : in.skip(wire);
+            if (!ok) {
+                return false;
+            }
+        }
+        metadata.push_back(entry);
+        return true;
+    }
+
+    bool parse_ack(std::string_view bytes) {
+        Reader in{reinterpret_cast<const uint8_t*>(bytes.data()),
+                  reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size()};
+        while (in.p < in.end) {
+            uint64_t key;
+            if (!in.varint(key)) {
+                return false;
+            }
+            int wire = static_cast<int>(key & 7);
+            uint64_t v = 0;
+            switch (key >> 3) {
+                case 1: if (!in.string(wire, ack.original_message_id)) return false; break;
+                case 2: if (!in.varint(wire, v)) return false; ack.received = v != 0; break;
+                case 3:
+                    if (!in.fixed64(wire, v)) return false;
+                    std::memcpy(&ack.latency_ms, &v, sizeof(v));
+                    break;
+                case 4: if (!in.string(wire, ack.receiver_id)) return false; break;
+                case 5: if (!in.string(wire, ack.status)) return false; break;
+                case 6: if (!in.fixed64(wire, ack.original_message_seq)) return false; break;
+                case 7: if (!in.varint(wire, v)) return false; ack.status_code = static_cast<::messaging::AckStatus>(v); break;
+                case 8: if (!in.varint(wire, v)) return false; ack.received_at_us = static_cast<int64_t>(v); break;
+                case 9: if (!in.varint(wire, v)) return false; ack.processing_ns = static_cast<int64_t>(v); break;
+                case 10: if (!in.varint(wire, v)) return false; ack.acked_at_us = static_cast<int64_t>(v); break;
+                case 11: if (!in.varint(wire, v)) return false; ack.decompress_ns = static_cast<int64_t>(v); break;
+                default:
+                    if (!in.skip(wire)) return false;
+            }
+        }
+        return true;
+    }
+
+    size_t ack_encoded_size() const {
+        return string_field_size(ack.original_message_id) +
+               varint_field_size(ack.received) +
+               (ack.latency_ms != 0.0 ? 1 + 8 : 0) +
+               string_field_size(ack.receiver_id) +
+               string_field_size(ack.status) +
+               (ack.original_message_seq ? 1 + 8 : 0) +
+               varint_field_size(ack.status_code) +
+               varint_field_size(ack.received_at_us) +
+               varint_field_size(ack.processing_ns) +
+               varint_field_size(ack.acked_at_us) +
+               varint_field_size(ack.decompress_ns);
+    }
+
+    static size_t map_entry_size(const MetadataEntry& entry) {
+        return 2 + varint_size(entry.first.size()) + entry.first.size() +
+               varint_size(entry.second.size()) + entry.second.size();
+    }
+
+    static size_t varint_size(uint64_t value) {
+        size_t n = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            n++;
+        }
+        return n;
+    }
+
+    // proto3 omits fields at their default value; negative ints take 10 bytes
+    static size_t varint_field_size(int64_t value) {
+        return value ? 1 + varint_size(static_cast<uint64_t>(value)) : 0;
+    }
+
+    static size_t string_field_size(std::string_view value) {
+        return value.empty() ? 0 : 1 + varint_size(value.size()) + value.size();
+    }
+
+    static uint8_t* put_varint(uint8_t* out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = static_cast<uint8_t>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    // Every field number here is below 16, so a tag is one byte
+    static uint8_t* put_tag(uint8_t* out, int field, int wire) {
+        *out++ = static_cast<uint8_t>((field << 3) | wire);
+        return out;
+    }
+
+    static uint8_t* put_varint_field(uint8_t* out, int field, int64_t value) {
+        return value ? put_varint(put_tag(out, field, kVarint), static_cast<uint64_t>(value)) : out;
+    }
+
+    static uint8_t* put_fixed64(uint8_t* out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            *out++ = static_cast<uint8_t>(value >> (8 * i));
+        }
+        return out;
+    }
+
+    static uint8_t* put_string(uint8_t* out, int field, std::string_view value, bool always = false) {
+        if (value.empty() && !always) {
+            return out;
+        }
+        out = put_varint(put_tag(out, field, kLengthDelimited), value.size());
+        if (!value.empty()) {
+            std::memcpy(out, value.data(), value.size());
+        }
+        return out + value.size();
+    }
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // ENVELOPE_VIEW_HPP
@@ -0,0 +1,445 @@
+#ifndef FANOUT_BENCH_HPP
+#define FANOUT_BENCH_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "message_helpers.hpp"
+#include "envelope_view.hpp"
+#include "encoded_corpus.hpp"
+#include "stats_collector.hpp"
+#include "pubsub.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * One-to-many run settings.
+ *
+ * subscribers     - K subscribers of the one topic, each on its own connection and thread
+ * topic           - topic, subject, channel or exchange name
+ * hwm             - per-subscriber queue limit handed to the transport (0 = its default)
+ * publish_rate    - publications per second, 0 = as fast as publish() returns
+ * drain_ms        - after the last publication, give up once no subscriber has made progress for this long
+ * join_timeout_ms - longest to wait for every subscriber to connect and see a hello
+ */
+struct FanoutOptions {
+    int subscribers = 1;
+    std::string topic = "fanout";
+    int hwm = 0;
+    int publish_rate = 0;
+    int drain_ms = 2000;
+    int join_timeout_ms = 10000;
+
+    // Parse --subscribers N, --topic T, --hwm N, --publish-rate N, --drain-ms N and --join-timeout-ms N
+    static FanoutOptions from_args(int argc, char* argv[]) {
+        FanoutOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--subscribers") == 0 && i + 1 < argc) {
+                options.subscribers = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--topic") == 0 && i + 1 < argc) {
+                options.topic = argv[++i];
+            } else if (std::strcmp(argv[i], "--hwm") == 0 && i + 1 < argc) {
+                options.hwm = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--publish-rate") == 0 && i + 1 < argc) {
+                options.publish_rate = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--drain-ms") == 0 && i + 1 < argc) {
+                options.drain_ms = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--join-timeout-ms") == 0 && i + 1 < argc) {
+                options.join_timeout_ms = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * What one subscriber saw, written only by its own thread. Publications are
+ * numbered 1..expected in message_seq, so a bitmap of the ones seen gives
+ * exact drop and duplicate counts whatever order they arrive in; lag is
+ * receive time minus the publication's timestamp_us, both on this host's
+ * clock. The counts live in a StatsShard of the tally's own, so hundreds of
+ * subscribers never share a cache line or a lock; joined() and received()
+ * may be read from other threads meanwhile.
+ */
+class SubscriberTally {
+public:
+    explicit SubscriberTally(uint64_t expected) : expected_(expected), seen_((expected + 63) / 64, 0) {}
+
+    void record(std::string_view body, int64_t now_us) {
+        if (!view_.parse(body.data(), body.size())) {
+            malformed_++;
+            return;
+        }
+        if (view_.type == ::messaging::CONTROL) {
+            joined_.store(true, std::memory_order_release);
+            return;
+        }
+        uint64_t seq = view_.message_seq;
+        if (seq == 0 || seq > expected_) {
+            malformed_++;
+            return;
+        }
+        uint64_t& word = seen_[(seq - 1) / 64];
+        uint64_t bit = 1ULL << ((seq - 1) % 64);
+        if (word & bit) {
+            duplicates_++;
+            return;
+        }
+        word |= bit;
+        if (seq < highest_seq_) {
+            reordered_++;
+        } else {
+            if (seq > highest_seq_ + 1) {
+                gaps_++;
+            }
+            highest_seq_ = seq;
+        }
+        shard_.record(true, std::max<int64_t>(0, now_us - view_.timestamp_us) * 1000);
+        bytes_ += body.size();
+        last_us_ = now_us;
+    }
+
+    // Count the publications that never arrived as failures; call once the subscriber's thread is done
+    void settle(uint64_t published) {
+        uint64_t missing = dropped(published);
+        shard_.sent.store(shard_.sent.load(std::memory_order_relaxed) + missing, std::memory_order_relaxed);
+        shard_.failed.store(static_cast<int64_t>(missing), std::memory_order_relaxed);
+    }
+
+    bool joined() const { return joined_.load(std::memory_order_acquire); }
+    uint64_t received() const { return static_cast<uint64_t>(shard_.acked.load(std::memory_order_relaxed)); }
+
+    // Publications out of published that never arrived
+    uint64_t dropped(uint64_t published) const {
+        uint64_t got = received();
+        return published > got ? published - got : 0;
+    }
+
+    uint64_t gaps() const { return gaps_; }
+    uint64_t reordered() const { return reordered_; }
+    uint64_t duplicates() const { return duplicates_; }
+    uint64_t malformed() const { return malformed_; }
+    int64_t last_us() const { return last_us_; }
+    uint64_t bytes() const { return bytes_; }
+
+    // One success per distinct publication received, with its lag; failures once settled
+    const StatsShard& shard() const { return shard_; }
+    const LatencyHistogram& lag() const { return shard_.latencies; }
+
+private:
+    uint64_t expected_;
+    std::vector<uint64_t> seen_;
+    EnvelopeView view_;
+    StatsShard shard_;
+    std::atomic<bool> joined_{false};
+    uint64_t bytes_ = 0;
+    uint64_t highest_seq_ = 0;
+    uint64_t gaps_ = 0;        // runs of missing seqs, as first seen; later arrivals may fill them
+    uint64_t reordered_ = 0;
+    uint64_t duplicates_ = 0;
+    uint64_t malformed_ = 0;
+    int64_t last_us_ = 0;
+};
+
+/**
+ * One publisher, K subscribers: publish the corpus once to a topic and
+ * count what reaches each subscriber.
+ *
+ * Every subscriber gets a thread that connects it and then receives until
+ * the run ends. Before the clock starts the publisher repeats a CONTROL
+ * hello until each subscriber has seen one, which covers ZeroMQ's slow
+ * joiner and the brokers' subscription propagation alike. Publication i
+ * then goes out as seq i + 1 (optionally paced), and the run ends when every
+ * subscriber has everything or none has made progress for drain_ms.
+ *
+ *   FanoutBench bench(FanoutOptions::from_args(argc, argv));
+ *   bench.run(publisher, [&](int) { return std::make_unique<NatsSubscriber>(topic); }, corpus, stats);
+ *   stats.add_metadata("fanout", bench.report());
+ *
+ * stats ends up with one success per delivery (its timing is the lag) and
+ * one failure per missed delivery, so its totals are over K x published.
+ */
+class FanoutBench {
+public:
+    using SubscriberFactory = std::function<std::unique_ptr<UnifiedSubscriber>(int index)>;
+
+    // Pause between hellos while subscribers join
+    static constexpr int kHelloIntervalMs = 20;
+    // receive() timeout, which bounds how long a subscriber thread takes to notice the end of the run
+    static constexpr int kReceiveTimeoutMs = 100;
+
+    explicit FanoutBench(const FanoutOptions& options) : options_(options) {}
+
+    const FanoutOptions& options() const { return options_; }
+
+    /**
+     * Run corpus through publisher to options().subscribers subscribers from
+     * make_subscriber, recording into stats. False if the publisher could
+     * not connect; subscribers that fail to connect just receive nothing.
+     */
+    bool run(UnifiedPublisher& publisher, const SubscriberFactory& make_subscriber,
+             const test_data_loader::EncodedCorpus& corpus, MessageStats& stats) {
+        transport_ = publisher.service_name;
+        if (!publisher.connect()) {
+            fprintf(stderr, " [!] %s publisher failed to connect\n", transport_.c_str());
+            return false;
+        }
+        published_ = 0;
+        publish_failed_ = 0;
+        stop_.store(false);
+        connected_.store(0);
+        connect_failed_.store(0);
+
+        size_t k = static_cast<size_t>(options_.subscribers);
+        tallies_.clear();
+        subscribers_.clear();
+        for (size_t i = 0; i < k; ++i) {
+            tallies_.push_back(std::make_unique<SubscriberTally>(corpus.size()));
+            subscribers_.push_back(make_subscriber(static_cast<int>(i)));
+        }
+        std::vector<std::thread> threads;
+        threads.reserve(k);
+        for (size_t i = 0; i < k; ++i) {
+            threads.emplace_back([this, i]() { subscriber_loop(*subscribers_[i], *tallies_[i]); });
+        }
+
+        join(publisher);
+        publisher.begin_run();
+
+        std::string body;
+        int64_t start_ns = message_helpers::get_steady_time_ns();
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            if (options_.publish_rate > 0) {
+                int64_t due_ns = start_ns + static_cast<int64_t>(i * 1e9 / options_.publish_rate);
+                int64_t wait_ns = due_ns - message_helpers::get_steady_time_ns();
+                if (wait_ns > 0) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+                }
+            }
+            corpus.encode_publication(i, message_helpers::get_current_time_us(), options_.topic, i + 1, body);
+            if (publisher.publish(body)) {
+                published_++;
+            } else {
+                publish_failed_++;
+            }
+        }
+        publisher.flush();
+        publish_ns_ = message_helpers::get_steady_time_ns() - start_ns;
+        publish_end_us_ = message_helpers::get_current_time_us();
+
+        drain();
+        stop_.store(true);
+        for (auto& subscriber : subscribers_) {
+            subscriber->interrupt();
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        publisher.disconnect();
+        transport_report_ = publisher.report();
+
+        // Every missed delivery is a failure, so the totals cover K x published
+        int64_t last_us = publish_end_us_;
+        for (const auto& tally : tallies_) {
+            tally->settle(published_);
+            stats.merge(tally->shard());
+            stats.record_bytes(static_cast<long long>(tally->bytes()));
+            last_us = std::max(last_us, tally->last_us());
+        }
+        // The run ends at the last delivery, not after the idle drain_ms that confirmed it was the last
+        run_ns_ = publish_ns_ + (last_us - publish_end_us_) * 1000;
+        stats.set_duration_ns(start_ns, start_ns + run_ns_);
+        return true;
+    }
+
+    // Delivery, drops and per-subscriber lag spread of the last run()
+    nlohmann::json report() const {
+        size_t k = tallies_.size();
+        uint64_t deliveries = 0;
+        uint64_t dropped = 0;
+        uint64_t max_dropped = 0;
+        uint64_t with_drops = 0;
+        uint64_t gaps = 0;
+        uint64_t reordered = 0;
+        uint64_t duplicates = 0;
+        uint64_t malformed = 0;
+        uint64_t transport_dropped = 0;
+        size_t joined = 0;
+        int64_t last_us = 0;
+        std::vector<double> p99s;
+        size_t slowest = 0;
+        for (size_t i = 0; i < k; ++i) {
+            const SubscriberTally& t = *tallies_[i];
+            uint64_t d = t.dropped(published_);
+            deliveries += t.received();
+            dropped += d;
+            max_dropped = std::max(max_dropped, d);
+            with_drops += d > 0;
+            gaps += t.gaps();
+            reordered += t.reordered();
+            duplicates += t.duplicates();
+            malformed += t.malformed();
+            transport_dropped += subscribers_[i]->transport_dropped();
+            joined += t.joined();
+            last_us = std::max(last_us, t.last_us());
+            p99s.push_back(t.lag().percentile_ms(99));
+            if (p99s.back() > p99s[slowest]) {
+                slowest = i;
+            }
+        }
+        uint64_t expected = published_ * k;
+        nlohmann::json report = {
+            {"transport", transport_},
+            {"topic", options_.topic},
+            {"subscribers", k},
+            {"connected", connected_.load()},
+            {"joined", joined},
+            {"join_ms", join_ns_ / 1e6},
+            {"hwm", options_.hwm},
+            {"publish_rate_limit", options_.publish_rate},
+            {"published", published_},
+            {"publish_failed", publish_failed_},
+            {"publish_ms", publish_ns_ / 1e6},
+            {"publish_rate", publish_ns_ > 0 ? published_ * 1e9 / publish_ns_ : 0.0},
+            {"expected_deliveries", expected},
+            {"deliveries", deliveries},
+            {"delivery_ratio", expected > 0 ? static_cast<double>(deliveries) / expected : 0.0},
+            {"delivery_rate", run_ns_ > 0 ? deliveries * 1e9 / run_ns_ : 0.0},
+            // How far the last delivery trailed the last publication
+            {"tail_ms", last_us > publish_end_us_ ? (last_us - publish_end_us_) / 1e3 : 0.0},
+            {"dropped", {
+                {"total", dropped},
+                {"subscribers_with_drops", with_drops},
+                {"max_per_subscriber", max_dropped},
+                {"gaps", gaps},
+                {"reported_by_transport", transport_dropped}
+            }},
+            {"reordered", reordered},
+            {"duplicates", duplicates},
+            {"malformed", malformed}
+        };
+        if (!p99s.empty()) {
+            std::vector<double> sorted = p99s;
+            std::sort(sorted.begin(), sorted.end());
+            report["per_subscriber_p99_lag_ms"] = {
+                {"min", sorted.front()},
+                {"p50", sorted[sorted.size() / 2]},
+                {"max", sorted.back()}
+            };
+            const SubscriberTally& t = *tallies_[slowest];
+            report["slowest_subscriber"] = {
+                {"index", slowest},
+                {"p99_lag_ms", p99s[slowest]},
+                {"received", t.received()},
+                {"dropped", t.dropped(published_)}
+            };
+        }
+        if (!transport_report_.empty()) {
+            report["transport_report"] = transport_report_;
+        }
+        return report;
+    }
+
+private:
+    void subscriber_loop(UnifiedSubscriber& subscriber, SubscriberTally& tally) {
+        if (!subscriber.connect()) {
+            connect_failed_.fetch_add(1);
+            return;
+        }
+        connected_.fetch_add(1);
+        while (!stop_.load(std::memory_order_relaxed)) {
+            auto body = subscriber.receive(kReceiveTimeoutMs);
+            if (body) {
+                tally.record(*body, message_helpers::get_current_time_us());
+            }
+        }
+        subscriber.disconnect();
+    }
+
+    // Hello until every connected subscriber has seen one, all have tried to connect, or the timeout passes
+    void join(UnifiedPublisher& publisher) {
+        int64_t start_ns = message_helpers::get_steady_time_ns();
+        int64_t deadline_ns = start_ns + static_cast<int64_t>(options_.join_timeout_ms) * 1000000;
+        size_t k = tallies_.size();
+        std::string body;
+        for (int hello = 0;; ++hello) {
+            ::messaging::MessageEnvelope envelope =
+                message_helpers::create_ping(0, "fanout_hello_" + std::to_string(hello), "fanout-publisher");
+            envelope.set_topic(options_.topic);
+            envelope.set_routing(publisher.routing());
+            envelope.SerializeToString(&body);
+            publisher.publish(body);
+            std::this_thread::sleep_for(std::chrono::milliseconds(kHelloIntervalMs));
+
+            size_t tried = connected_.load() + connect_failed_.load();
+            size_t joined = 0;
+            for (const auto& tally : tallies_) {
+                joined += tally->joined();
+            }
+            if ((tried == k && joined == connected_.load()) ||
+                message_helpers::get_steady_time_ns() >= deadline_ns) {
+                if (joined < k) {
+                    fprintf(stderr, " [!] %zu of %zu subscribers joined after %d ms; starting anyway\n",
+                            joined, k, options_.join_timeout_ms);
+                }
+                break;
+            }
+        }
+        join_ns_ = message_helpers::get_steady_time_ns() - start_ns;
+    }
+
+    // Wait for stragglers until all have arrived or drain_ms pass without progress
+    void drain() {
+        uint64_t expected = published_ * tallies_.size();
+        uint64_t last_total = 0;
+        int64_t last_progress_ns = message_helpers::get_steady_time_ns();
+        while (true) {
+            uint64_t total = 0;
+            for (const auto& tally : tallies_) {
+                total += tally->received();
+            }
+            int64_t now_ns = message_helpers::get_steady_time_ns();
+            if (total >= expected) {
+                return;
+            }
+            if (total != last_total) {
+                last_total = total;
+                last_progress_ns = now_ns;
+            } else if (now_ns - last_progress_ns >= static_cast<int64_t>(options_.drain_ms) * 1000000) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    FanoutOptions options_;
+    std::string transport_;
+    std::vector<std::unique_ptr<SubscriberTally>> tallies_;
+    std::vector<std::unique_ptr<UnifiedSubscriber>> subscribers_;
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> connected_{0};
+    std::atomic<size_t> connect_failed_{0};
+    uint64_t published_ = 0;
+    uint64_t publish_failed_ = 0;
+    int64_t join_ns_ = 0;
+    int64_t publish_ns_ = 0;
+    int64_t publish_end_us_ = 0;
+    int64_t run_ns_ = 0;
+    nlohmann::json transport_report_ = nlohmann::json::object();
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // FANOUT_BENCH_HPP
@@ -0,0 +1,109 @@
+#ifndef LATENCY_BREAKDOWN_HPP
+#define LATENCY_BREAKDOWN_HPP
+
+#include <cstdint>
+#include "json.hpp"
+#include "latency_histogram.hpp"
+#include "messaging.pb.h"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Receiver-side timing carried back in an ACK (received_at_us, processing_ns
+ * and latency_ms). measured is false for ACKs from peers that don't fill them
+ * in, such as the Python receivers before they report timing.
+ */
+struct AckTiming {
+    bool measured = false;
+    int64_t outbound_ns = 0;    // request timestamp_us to the receiver's received_at_us
+    int64_t processing_ns = 0;  // receiver arrival to ACK built
+    int64_t decompress_ns = 0;  // part of processing_ns; 0 for uncompressed requests
+
+    static AckTiming of(const ::messaging::Acknowledgment& ack) {
+        AckTiming timing;
+        if (ack.received_at_us() > 0) {
+            timing.measured = true;
+            timing.outbound_ns = static_cast<int64_t>(ack.latency_ms() * 1e6);
+            timing.processing_ns = ack.processing_ns();
+            timing.decompress_ns = ack.decompress_ns();
+        }
+        return timing;
+    }
+
+    static AckTiming of(const ::messaging::MessageEnvelope& reply) {
+        return reply.has_ack() ? of(reply.ack()) : AckTiming();
+    }
+};
+
+/**
+ * A round trip split into its outbound, processing and return legs.
+ *
+ * Outbound compares the sender's and receiver's wall clocks, so it is only as
+ * good as their sync; on one host it is exact. Return is what is left of the
+ * round trip measured on the sender's steady clock, so the three legs always
+ * add up to it: clock skew moves time between outbound and return, never in
+ * or out of the total. Samples from unmeasured ACKs are skipped.
+ * Decompression is part of processing, reported on its own for the requests
+ * that were compressed.
+ */
+class LatencyBreakdown {
+public:
+    void record(const AckTiming& timing, int64_t round_trip_ns) {
+        if (!timing.measured) {
+            return;
+        }
+        outbound_.record_ns(timing.outbound_ns);
+        processing_.record_ns(timing.processing_ns);
+        return_.record_ns(round_trip_ns - timing.outbound_ns - timing.processing_ns);
+        if (timing.decompress_ns > 0) {
+            decompress_.record_ns(timing.decompress_ns);
+        }
+    }
+
+    void merge(const LatencyBreakdown& other) {
+        outbound_.merge(other.outbound_);
+        processing_.merge(other.processing_);
+        return_.merge(other.return_);
+        decompress_.merge(other.decompress_);
+    }
+
+    bool empty() const { return processing_.empty(); }
+
+    // {"outbound": {...}, "processing": {...}, "return": {...}} with mean/p50/p99 per leg,
+    // plus "decompress" when requests were compressed
+    nlohmann::json to_json() const {
+        nlohmann::json legs = {
+            {"outbound", leg_json(outbound_)},
+            {"processing", leg_json(processing_)},
+            {"return", leg_json(return_)},
+            {"count", processing_.count()},
+        };
+        if (!decompress_.empty()) {
+            legs["decompress"] = leg_json(decompress_);
+            legs["decompress"]["count"] = decompress_.count();
+        }
+        return legs;
+    }
+
+private:
+    static nlohmann::json leg_json(const LatencyHistogram& leg) {
+        return {
+            {"mean_ms", leg.mean_ns() / 1e6},
+            {"p50_ms", leg.percentile_ms(50)},
+            {"p99_ms", leg.percentile_ms(99)},
+            {"max_ms", leg.max_ns() / 1e6},
+        };
+    }
+
+    // Negative legs (clock skew) are dropped by the histogram
+    LatencyHistogram outbound_;
+    LatencyHistogram processing_;
+    LatencyHistogram return_;
+    LatencyHistogram decompress_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // LATENCY_BREAKDOWN_HPP
@@ -0,0 +1,160 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Fixed-memory latency recorder with log-bucketed counters (HDR histogram layout).
+ *
+ * Values are nanoseconds. The first 2^kSubBucketBits values each get an exact
+ * bucket; above that every power of two is split into 2^(kSubBucketBits - 1)
+ * linear sub-buckets, so any recorded value is reported within 1/128 (~0.8%)
+ * of its true value. The whole int64 range fits in ~7.4k counters (~59 KB)
+ * regardless of how many samples are recorded, and histograms recorded on
+ * different threads can be combined with merge().
+ *
+ * Count, min, max, mean and standard deviation are tracked exactly; only
+ * percentiles are subject to bucket resolution.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 8;
+    static constexpr int64_t kSubBucketCount = int64_t(1) << kSubBucketBits;
+    static constexpr int64_t kHalfCount = kSubBucketCount / 2;
+    static constexpr size_t kBucketCount =
+        static_cast<size_t>((64 - kSubBucketBits) * kHalfCount + kSubBucketCount);
+
+    LatencyHistogram() : counts_(kBucketCount, 0) {}
+
+    void record_ns(int64_t value_ns) {
+        if (value_ns < 0) {
+            return;
+        }
+        counts_[index_of(value_ns)]++;
+        total_++;
+        min_ = std::min(min_, value_ns);
+        max_ = std::max(max_, value_ns);
+        double v = static_cast<double>(value_ns);
+        sum_ += v;
+        sum_sq_ += v * v;
+    }
+
+    void record_ms(double value_ms) {
+        if (value_ms >= 0) {
+            record_ns(static_cast<int64_t>(std::llround(value_ms * 1e6)));
+        }
+    }
+
+    // Add every sample of other into this histogram
+    void merge(const LatencyHistogram& other) {
+        if (other.total_ == 0) {
+            return;
+        }
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+        sum_sq_ += other.sum_sq_;
+    }
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        min_ = std::numeric_limits<int64_t>::max();
+        max_ = 0;
+        sum_ = 0;
+        sum_sq_ = 0;
+    }
+
+    uint64_t count() const { return total_; }
+    bool empty() const { return total_ == 0; }
+
+    int64_t min_ns() const { return total_ ? min_ : 0; }
+    int64_t max_ns() const { return max_; }
+
+    double mean_ns() const { return total_ ? sum_ / total_ : 0.0; }
+
+    // Population standard deviation, matching the previous vector-based stats
+    double stdev_ns() const {
+        if (total_ < 2) {
+            return 0.0;
+        }
+        double mean = mean_ns();
+        double variance = sum_sq_ / total_ - mean * mean;
+        return variance > 0 ? std::sqrt(variance) : 0.0;
+    }
+
+    /**
+     * Smallest recorded value v such that at least percentile% of samples are <= v,
+     * reported as the midpoint of its bucket and clamped to the observed min/max.
+     */
+    int64_t value_at_percentile(double percentile) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total_));
+        rank = std::max<uint64_t>(rank, 1);
+        if (rank >= total_) {
+            return max_;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(std::max(midpoint_of(i), min_), max_);
+            }
+        }
+        return max_;
+    }
+
+    double percentile_ms(double percentile) const {
+        return value_at_percentile(percentile) / 1e6;
+    }
+
+private:
+    static size_t index_of(int64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+        int shift = msb - kSubBucketBits + 1;
+        // value >> shift lands in [kHalfCount, kSubBucketCount)
+        return static_cast<size_t>(shift * kHalfCount + (value >> shift));
+    }
+
+    static int64_t midpoint_of(size_t index) {
+        int64_t idx = static_cast<int64_t>(index);
+        if (idx < kSubBucketCount) {
+            return idx;
+        }
+        int shift = static_cast<int>(idx / kHalfCount) - 1;
+        int64_t sub = idx - shift * kHalfCount;
+        int64_t lower = sub << shift;
+        return lower + ((int64_t(1) << shift) >> 1);
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    int64_t min_ = std::numeric_limits<int64_t>::max();
+    int64_t max_ = 0;
+    double sum_ = 0;
+    double sum_sq_ = 0;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // LATENCY_HISTOGRAM_HPP
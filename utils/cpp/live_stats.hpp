@@ -0,0 +1,329 @@
+#ifndef LIVE_STATS_HPP
+#define LIVE_STATS_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "json.hpp"
+#include "messaging.pb.h"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Where and how often a sender samples its live stats.
+ *
+ * path      - JSON-lines time series, one StatsMessage per window; empty disables sampling
+ * window_ms - sampling window
+ */
+struct LiveStatsOptions {
+    std::string path;
+    int window_ms = 1000;
+
+    bool enabled() const { return !path.empty(); }
+
+    // Parse --stats-file PATH and --stats-window-ms N from the command line
+    static LiveStatsOptions from_args(int argc, char* argv[]) {
+        LiveStatsOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--stats-file") == 0 && i + 1 < argc) {
+                options.path = argv[++i];
+            } else if (std::strcmp(argv[i], "--stats-window-ms") == 0 && i + 1 < argc) {
+                options.window_ms = std::max(1, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Run-to-date counters and a coarse latency histogram that a sampler thread
+ * can read while a sender records into them.
+ *
+ * Counts only ever grow, so a window is the difference between two reads and
+ * the recording side never waits for, or is reset by, the sampler. Results
+ * are recorded by one thread at a time (MessageStats' owner), so they use
+ * relaxed load/store like StatsShard; dispatch() may be called from any
+ * thread. Latency buckets split each power of two into 8, so window
+ * percentiles are within ~6%; the end-of-run report keeps the exact
+ * LatencyHistogram.
+ */
+class LiveRecorder {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int64_t kSubBucketCount = int64_t(1) << kSubBucketBits;
+    static constexpr int64_t kHalfCount = kSubBucketCount / 2;
+    static constexpr size_t kBucketCount =
+        static_cast<size_t>((64 - kSubBucketBits) * kHalfCount + kSubBucketCount);
+
+    LiveRecorder() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LiveRecorder(const LiveRecorder&) = delete;
+    LiveRecorder& operator=(const LiveRecorder&) = delete;
+
+    void record(bool success, int64_t latency_ns) {
+        if (!success) {
+            bump(failed_, 1);
+            return;
+        }
+        if (latency_ns >= 0) {
+            bump(buckets_[index_of(latency_ns)], 1);
+            bump(latency_sum_ns_, latency_ns);
+        }
+        bump(acked_, 1);
+    }
+
+    void record_bytes(int64_t bytes) { bump(bytes_, bytes); }
+
+    // A message handed to the broker; in flight until its result is recorded
+    void dispatch() { dispatched_.fetch_add(1, std::memory_order_relaxed); }
+
+    struct Snapshot {
+        int64_t dispatched = 0;
+        int64_t acked = 0;
+        int64_t failed = 0;
+        int64_t bytes = 0;
+        int64_t latency_sum_ns = 0;
+        std::vector<uint64_t> buckets;
+    };
+
+    // Read every counter into snapshot, reusing its bucket storage
+    void read(Snapshot& snapshot) const {
+        // Percentiles and the mean use the bucket total, so a result caught half-recorded is harmless
+        snapshot.buckets.resize(kBucketCount);
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.latency_sum_ns = latency_sum_ns_.load(std::memory_order_relaxed);
+        snapshot.acked = acked_.load(std::memory_order_relaxed);
+        snapshot.failed = failed_.load(std::memory_order_relaxed);
+        snapshot.bytes = bytes_.load(std::memory_order_relaxed);
+        snapshot.dispatched = dispatched_.load(std::memory_order_relaxed);
+    }
+
+    // Bucket midpoint in nanoseconds, for percentiles over snapshot differences
+    static int64_t midpoint_of(size_t index) {
+        int64_t idx = static_cast<int64_t>(index);
+        if (idx < kSubBucketCount) {
+            return idx;
+        }
+        int shift = static_cast<int>(idx / kHalfCount) - 1;
+        int64_t sub = idx - shift * kHalfCount;
+        return (sub << shift) + ((int64_t(1) << shift) >> 1);
+    }
+
+private:
+    // Same layout as LatencyHistogram, with fewer sub-buckets
+    static size_t index_of(int64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+        int shift = msb - kSubBucketBits + 1;
+        return static_cast<size_t>(shift * kHalfCount + (value >> shift));
+    }
+
+    template <typename T>
+    static void bump(std::atomic<T>& counter, typename std::atomic<T>::value_type by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::atomic<int64_t> dispatched_{0};
+    std::atomic<int64_t> acked_{0};
+    std::atomic<int64_t> failed_{0};
+    std::atomic<int64_t> bytes_{0};
+    std::atomic<int64_t> latency_sum_ns_{0};
+    std::atomic<uint64_t> buckets_[kBucketCount];
+};
+
+/**
+ * Background sampler that turns a LiveRecorder into a time series.
+ *
+ *   LiveStats live(LiveStatsOptions::from_args(argc, argv));
+ *   stats.attach_live(live.recorder());
+ *   live.start("Redis");
+ *   ... send ...
+ *   live.stop();
+ *
+ * Every window_ms the sampler thread reads the recorder, and writes one
+ * StatsMessage as a JSON line: run totals in messages_sent/received/dropped,
+ * and the window's throughput, MB/s, mean/p50/p99/max latency and the
+ * in-flight count at its end. in_flight is only meaningful for senders that
+ * call dispatch(); for the others it stays 0. stop() writes the last, partial
+ * window. Does nothing unless options.enabled().
+ */
+class LiveStats {
+public:
+    explicit LiveStats(const LiveStatsOptions& options) : options_(options) {}
+
+    ~LiveStats() { stop(); }
+
+    LiveStats(const LiveStats&) = delete;
+    LiveStats& operator=(const LiveStats&) = delete;
+
+    // The recorder to attach to MessageStats, or nullptr when sampling is off
+    LiveRecorder* recorder() { return options_.enabled() ? &recorder_ : nullptr; }
+
+    bool start(const std::string& service_name) {
+        if (!options_.enabled() || thread_.joinable()) {
+            return false;
+        }
+        out_.open(options_.path, std::ios::trunc);
+        if (!out_.good()) {
+            std::cerr << " [!] Cannot write live stats to " << options_.path << std::endl;
+            return false;
+        }
+        service_name_ = service_name;
+        stopping_ = false;
+        thread_ = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!thread_.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        out_.close();
+    }
+
+    /**
+     * The StatsMessage for the window between two snapshots of length window_ns,
+     * ending elapsed_ns after sampling began.
+     */
+    static messaging::StatsMessage window_message(const std::string& service_name,
+                                                  const LiveRecorder::Snapshot& before,
+                                                  const LiveRecorder::Snapshot& after,
+                                                  int64_t window_ns, int64_t elapsed_ns) {
+        messaging::StatsMessage message;
+        message.set_service_name(service_name);
+        message.set_messages_sent(after.acked + after.failed);
+        message.set_messages_received(after.acked);
+        message.set_messages_dropped(after.failed);
+        message.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        message.set_elapsed_ms(elapsed_ns / 1000000);
+        message.set_window_ms(window_ns / 1000000);
+        message.set_in_flight(after.dispatched > 0 ? std::max<int64_t>(0, after.dispatched - after.acked - after.failed) : 0);
+
+        int64_t acked = after.acked - before.acked;
+        double seconds = window_ns / 1e9;
+        message.set_throughput_msg_per_sec(seconds > 0 ? acked / seconds : 0.0);
+        message.set_megabytes_per_sec(seconds > 0 ? (after.bytes - before.bytes) / 1e6 / seconds : 0.0);
+
+        uint64_t samples = 0;
+        for (size_t i = 0; i < after.buckets.size(); ++i) {
+            samples += after.buckets[i] - before.buckets[i];
+        }
+        if (samples > 0) {
+            message.set_avg_latency_ms((after.latency_sum_ns - before.latency_sum_ns) / 1e6 / samples);
+            message.set_p50_latency_ms(percentile_ns(before, after, samples, 50) / 1e6);
+            message.set_p99_latency_ms(percentile_ns(before, after, samples, 99) / 1e6);
+            message.set_max_latency_ms(percentile_ns(before, after, samples, 100) / 1e6);
+        }
+        return message;
+    }
+
+    // One time-series line; keys are the StatsMessage field names
+    static nlohmann::json to_json(const messaging::StatsMessage& message) {
+        return {
+            {"service_name", message.service_name()},
+            {"timestamp", message.timestamp()},
+            {"elapsed_ms", message.elapsed_ms()},
+            {"window_ms", message.window_ms()},
+            {"messages_sent", message.messages_sent()},
+            {"messages_received", message.messages_received()},
+            {"messages_dropped", message.messages_dropped()},
+            {"in_flight", message.in_flight()},
+            {"throughput_msg_per_sec", message.throughput_msg_per_sec()},
+            {"megabytes_per_sec", message.megabytes_per_sec()},
+            {"avg_latency_ms", message.avg_latency_ms()},
+            {"p50_latency_ms", message.p50_latency_ms()},
+            {"p99_latency_ms", message.p99_latency_ms()},
+            {"max_latency_ms", message.max_latency_ms()},
+        };
+    }
+
+private:
+    static int64_t percentile_ns(const LiveRecorder::Snapshot& before, const LiveRecorder::Snapshot& after,
+                                 uint64_t samples, double percentile) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * samples + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < after.buckets.size(); ++i) {
+            seen += after.buckets[i] - before.buckets[i];
+            if (seen >= rank) {
+                return LiveRecorder::midpoint_of(i);
+            }
+        }
+        return 0;
+    }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void run() {
+        LiveRecorder::Snapshot before;
+        LiveRecorder::Snapshot after;
+        recorder_.read(before);
+        int64_t start_ns = now_ns();
+        int64_t window_start_ns = start_ns;
+        int64_t window_ns = static_cast<int64_t>(options_.window_ms) * 1000000;
+        bool stopping = false;
+        while (!stopping) {
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                // Each window reports its measured length, so a late wakeup can't skew its rates
+                int64_t deadline_ns = window_start_ns + window_ns;
+                cv_.wait_for(lock, std::chrono::nanoseconds(std::max<int64_t>(0, deadline_ns - now_ns())),
+                             [this]() { return stopping_; });
+                stopping = stopping_;
+            }
+            int64_t end_ns = now_ns();
+            if (!stopping && end_ns < window_start_ns + window_ns) {
+                continue;  // spurious wakeup
+            }
+            recorder_.read(after);
+            out_ << to_json(window_message(service_name_, before, after, end_ns - window_start_ns,
+                                           end_ns - start_ns)).dump()
+                 << '\n';
+            out_.flush();
+            std::swap(before, after);
+            window_start_ns = end_ns;
+        }
+    }
+
+    LiveStatsOptions options_;
+    LiveRecorder recorder_;
+    std::string service_name_;
+    std::ofstream out_;
+    std::thread thread_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // LIVE_STATS_HPP
@@ -2,9 +2,13 @@
 #define MESSAGE_HELPERS_HPP
 
 #include <string>
+#include <vector>
 #include <chrono>
+#include <google/protobuf/arena.h>
 #include "json.hpp"
 #include "messaging.pb.h"
+#include "message_ids.hpp"
+#include "trace.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
@@ -12,6 +16,9 @@ using messaging::Acknowledgment;
 using messaging::DataMessage;
 using messaging::MessageType;
 using messaging::RoutingMode;
+using messaging::AckStatus;
+using messaging::ControlMessage;
+using messaging::ControlType;
 
 namespace message_helpers {
 
@@ -22,73 +29,225 @@ inline long long get_current_time_ms() {
     return ms.time_since_epoch().count();
 }
 
-// Create a MessageEnvelope from JSON test data
-inline MessageEnvelope create_data_envelope(const json& item, RoutingMode routing = RoutingMode::REQUEST_REPLY) {
-    MessageEnvelope envelope;
+// Get current wall-clock time in microseconds (carried on the wire as timestamp_us)
+inline long long get_current_time_us() {
+    auto now = std::chrono::system_clock::now();
+    auto us = std::chrono::time_point_cast<std::chrono::microseconds>(now);
+    return us.time_since_epoch().count();
+}
+
+// Monotonic time in nanoseconds, for measuring latencies and run durations
+inline long long get_steady_time_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Milliseconds (with sub-ms precision) elapsed since a get_steady_time_ns() reading
+inline double elapsed_ms_since(long long start_ns) {
+    return (get_steady_time_ns() - start_ns) / 1e6;
+}
+
+/**
+ * When a request arrived at a receiver. Take it as soon as the transport hands
+ * over the bytes, before parsing, so the ACK's processing_ns covers everything
+ * the receiver does with the message.
+ */
+struct ReceiveTiming {
+    long long received_at_us = 0;   // wall clock, comparable with the sender's timestamp_us
+    long long received_ns = 0;      // steady clock, for processing_ns
+
+    static ReceiveTiming now() {
+        return ReceiveTiming{get_current_time_us(), get_steady_time_ns()};
+    }
+};
+
+/**
+ * Decoder for compressed payloads, installed by configure_compression()
+ * (payload_codec.hpp); programs that never install one pay a null check per
+ * parse. It rewrites a payload whose metadata names a content-encoding back
+ * to the raw bytes, returns false if it cannot, and adds the time it took to
+ * pending_decompress_ns(), which the next ACK built on the thread reports.
+ */
+using PayloadDecoder = bool (*)(MessageEnvelope& envelope);
+
+inline PayloadDecoder& payload_decoder() {
+    static PayloadDecoder decoder = nullptr;
+    return decoder;
+}
+
+inline long long& pending_decompress_ns() {
+    thread_local long long ns = 0;
+    return ns;
+}
+
+inline long long take_decompress_ns() {
+    long long ns = pending_decompress_ns();
+    pending_decompress_ns() = 0;
+    return ns;
+}
+
+// Undo the sender's payload compression, if any; true when there was none
+inline bool decode_payload(MessageEnvelope& envelope) {
+    PayloadDecoder decoder = payload_decoder();
+    return !decoder || decoder(envelope);
+}
+
+// Populate envelope (and its DataMessage payload, built in data_msg) from JSON test data.
+// Both are cleared first, so reusing them keeps their field capacity across messages.
+inline void fill_data_envelope(MessageEnvelope* envelope, DataMessage* data_msg, const json& item,
+                               RoutingMode routing = RoutingMode::REQUEST_REPLY) {
+    TRACE_SCOPE("create_data_envelope");
+    envelope->Clear();
+    data_msg->Clear();
     
     // Set message ID (handle both string and numeric)
-    std::string message_id;
-    if (item["message_id"].is_string()) {
-        message_id = item["message_id"].get<std::string>();
+    const json& id = item["message_id"];
+    if (id.is_string()) {
+        envelope->set_message_id(id.get_ref<const std::string&>());
     } else {
-        message_id = std::to_string(item["message_id"].get<long long>());
+        envelope->set_message_id(std::to_string(id.get<long long>()));
     }
-    envelope.set_message_id(message_id);
     
     // Set target
-    envelope.set_target(item.value("target", 0));
+    envelope->set_target(item.value("target", 0));
     
     // Set type and timestamp
-    envelope.set_type(MessageType::DATA_MESSAGE);
-    envelope.set_timestamp(get_current_time_ms());
-    envelope.set_routing(routing);
+    envelope->set_type(MessageType::DATA_MESSAGE);
+    long long now_us = get_current_time_us();
+    envelope->set_timestamp(now_us / 1000);
+    envelope->set_timestamp_us(now_us);
+    envelope->set_routing(routing);
     
     // Set metadata if present in item or for specific needs
-    if (item.contains("metadata") && item["metadata"].is_object()) {
-        auto& meta = *envelope.mutable_metadata();
-        for (auto it = item["metadata"].begin(); it != item["metadata"].end(); ++it) {
-            meta[it.key()] = it.value().get<std::string>();
+    auto meta_it = item.find("metadata");
+    if (meta_it != item.end() && meta_it->is_object()) {
+        auto& meta = *envelope->mutable_metadata();
+        for (auto it = meta_it->begin(); it != meta_it->end(); ++it) {
+            meta[it.key()] = it.value().get_ref<const std::string&>();
         }
     }
     
     // Create DataMessage payload
-    DataMessage data_msg;
-    data_msg.set_message_name(item.value("message_name", ""));
+    auto name_it = item.find("message_name");
+    if (name_it != item.end() && name_it->is_string()) {
+        data_msg->set_message_name(name_it->get_ref<const std::string&>());
+    }
     
-    if (item.contains("message_value") && item["message_value"].is_array()) {
-        for (const auto& val : item["message_value"]) {
-            data_msg.add_message_value(val.is_string() ? val.get<std::string>() : val.dump());
+    auto values_it = item.find("message_value");
+    if (values_it != item.end() && values_it->is_array()) {
+        for (const auto& val : *values_it) {
+            if (val.is_string()) {
+                data_msg->add_message_value(val.get_ref<const std::string&>());
+            } else {
+                data_msg->add_message_value(val.dump());
+            }
         }
     }
     
     // Serialize DataMessage into the envelope payload
-    data_msg.SerializeToString(envelope.mutable_payload());
-    
+    data_msg->SerializeToString(envelope->mutable_payload());
+}
+
+// Create a MessageEnvelope from JSON test data
+inline MessageEnvelope create_data_envelope(const json& item, RoutingMode routing = RoutingMode::REQUEST_REPLY) {
+    MessageEnvelope envelope;
+    DataMessage data_msg;
+    fill_data_envelope(&envelope, &data_msg, item, routing);
     return envelope;
 }
 
-// Create an ACK envelope in response to a received message
-inline MessageEnvelope create_ack_envelope(
+// Wire string for an ACK status, kept alongside status_code for peers that only read the string
+inline const char* ack_status_name(AckStatus status) {
+    switch (status) {
+        case AckStatus::ACK_STATUS_OK: return "OK";
+        case AckStatus::ACK_STATUS_TIMEOUT: return "TIMEOUT";
+        default: return "ERROR";
+    }
+}
+
+// status_code, falling back to the string for peers that don't set the enum
+inline bool is_ack_ok(const Acknowledgment& ack) {
+    if (ack.status_code() != AckStatus::ACK_STATUS_UNSPECIFIED) {
+        return ack.status_code() == AckStatus::ACK_STATUS_OK;
+    }
+    return ack.status() == "OK";
+}
+
+// Populate envelope as an ACK for original_message_id; clears it first so it can be reused.
+// original_message_seq echoes the request's message_seq, if it had one. latency_ms is left
+// 0 (unmeasured) unless given; fill_ack_for measures it from the request.
+inline void fill_ack_envelope(
+    MessageEnvelope* envelope,
     const std::string& original_message_id,
     int target,
     const std::string& receiver_id,
-    const std::string& status = "OK",
-    double latency_ms = 0.5
+    AckStatus status = AckStatus::ACK_STATUS_OK,
+    double latency_ms = 0.0,
+    uint64_t original_message_seq = 0
 ) {
-    MessageEnvelope envelope;
-    envelope.set_message_id("ack_" + original_message_id);
-    envelope.set_target(target);
-    envelope.set_type(MessageType::ACK);
-    envelope.set_timestamp(get_current_time_ms());
+    // Clear() frees a heap envelope's ack submessage; keep it so its strings are reused too
+    Acknowledgment* ack = envelope->has_ack() ? envelope->unsafe_arena_release_ack() : nullptr;
+    envelope->Clear();
+    if (ack) {
+        ack->Clear();
+        envelope->unsafe_arena_set_allocated_ack(ack);
+    }
+    envelope->mutable_message_id()->assign("ack_").append(original_message_id);
+    envelope->set_target(target);
+    envelope->set_type(MessageType::ACK);
+    long long now_us = get_current_time_us();
+    envelope->set_timestamp(now_us / 1000);
+    envelope->set_timestamp_us(now_us);
     
     // Create and populate Acknowledgment
-    Acknowledgment* ack = envelope.mutable_ack();
+    ack = envelope->mutable_ack();
     ack->set_original_message_id(original_message_id);
+    ack->set_original_message_seq(original_message_seq);
     ack->set_received(true);
     ack->set_latency_ms(latency_ms);
     ack->set_receiver_id(receiver_id);
-    ack->set_status(status);
-    
+    ack->set_status(ack_status_name(status));
+    ack->set_status_code(status);
+}
+
+// Sender wall-clock send time of request in microseconds, from timestamp_us or the ms timestamp
+inline long long sent_at_us(const MessageEnvelope& request) {
+    return request.timestamp_us() > 0 ? request.timestamp_us() : request.timestamp() * 1000;
+}
+
+// Record the receiver's side of request in ack: arrival time, processing time up to now,
+// ACK time, latency_ms as the one-way delay from the request's send timestamp, and the
+// decompression time of the requests parsed on this thread since the last ACK
+inline void stamp_ack_timing(Acknowledgment* ack, const MessageEnvelope& request, const ReceiveTiming& timing) {
+    long long sent_us = sent_at_us(request);
+    ack->set_received_at_us(timing.received_at_us);
+    ack->set_latency_ms(sent_us > 0 ? (timing.received_at_us - sent_us) / 1000.0 : 0.0);
+    long long now_ns = get_steady_time_ns();
+    ack->set_processing_ns(timing.received_ns > 0 ? now_ns - timing.received_ns : 0);
+    ack->set_acked_at_us(timing.received_at_us + (now_ns - timing.received_ns) / 1000);
+    ack->set_decompress_ns(take_decompress_ns());
+}
+
+// Populate envelope as the ACK for request, echoing its message id and message_seq and
+// carrying the receiver timing; timing defaults to now for callers that don't track arrival
+inline void fill_ack_for(MessageEnvelope* envelope, const MessageEnvelope& request, const std::string& receiver_id,
+                         const ReceiveTiming& timing = ReceiveTiming::now(),
+                         AckStatus status = AckStatus::ACK_STATUS_OK) {
+    fill_ack_envelope(envelope, request.message_id(), request.target(), receiver_id, status, 0.0,
+                      request.message_seq());
+    stamp_ack_timing(envelope->mutable_ack(), request, timing);
+}
+
+// Create an ACK envelope in response to a received message
+inline MessageEnvelope create_ack_envelope(
+    const std::string& original_message_id,
+    int target,
+    const std::string& receiver_id,
+    AckStatus status = AckStatus::ACK_STATUS_OK,
+    double latency_ms = 0.0
+) {
+    MessageEnvelope envelope;
+    fill_ack_envelope(&envelope, original_message_id, target, receiver_id, status, latency_ms);
     return envelope;
 }
 
@@ -96,25 +255,220 @@ inline MessageEnvelope create_ack_envelope(
 inline MessageEnvelope create_ack_from_envelope(
     const MessageEnvelope& received_envelope,
     const std::string& receiver_id,
-    const std::string& status = "OK",
-    double latency_ms = 0.5
+    const ReceiveTiming& timing = ReceiveTiming::now(),
+    AckStatus status = AckStatus::ACK_STATUS_OK
+) {
+    MessageEnvelope envelope;
+    fill_ack_for(&envelope, received_envelope, receiver_id, timing, status);
+    return envelope;
+}
+
+// True for a BATCH envelope, whose payload is a BatchMessage of envelopes
+inline bool is_batch(const MessageEnvelope& envelope) {
+    return envelope.type() == MessageType::BATCH;
+}
+
+// Populate one BatchResponse entry as the OK acknowledgment of message
+inline void fill_batch_ack(Acknowledgment* ack, const MessageEnvelope& message, const std::string& receiver_id,
+                           const ReceiveTiming& timing) {
+    ack->set_original_message_id(message.message_id());
+    ack->set_original_message_seq(message.message_seq());
+    ack->set_received(true);
+    stamp_ack_timing(ack, message, timing);
+    ack->set_receiver_id(receiver_id);
+    ack->set_status("OK");
+    ack->set_status_code(AckStatus::ACK_STATUS_OK);
+}
+
+// Answer a BATCH envelope with one BatchResponse carrying an Acknowledgment per message;
+// every message shares the batch's arrival time. Messages whose payload cannot be
+// decompressed get no Acknowledgment and count as failed.
+inline MessageEnvelope create_batch_response(
+    const MessageEnvelope& batch_envelope,
+    const std::string& receiver_id,
+    const ReceiveTiming& timing = ReceiveTiming::now()
+) {
+    messaging::BatchMessage batch;
+    messaging::BatchResponse batch_response;
+    if (batch.ParseFromString(batch_envelope.payload())) {
+        for (MessageEnvelope& message : *batch.mutable_messages()) {
+            if (!decode_payload(message)) {
+                batch_response.set_failed_count(batch_response.failed_count() + 1);
+                continue;
+            }
+            fill_batch_ack(batch_response.add_acknowledgments(), message, receiver_id, timing);
+        }
+    } else {
+        batch_response.set_error_message("Malformed batch payload");
+    }
+
+    MessageEnvelope envelope;
+    envelope.set_message_id("ack_" + batch_envelope.message_id());
+    envelope.set_target(batch_envelope.target());
+    envelope.set_type(MessageType::BATCH);
+    long long now_us = get_current_time_us();
+    envelope.set_timestamp(now_us / 1000);
+    envelope.set_timestamp_us(now_us);
+    batch_response.SerializeToString(envelope.mutable_payload());
+    return envelope;
+}
+
+// True for a CONTROL envelope, such as a readiness PING; receivers answer it but don't count it as a message
+inline bool is_control(const MessageEnvelope& envelope) {
+    return envelope.type() == MessageType::CONTROL;
+}
+
+// A readiness PING for target's receiver; source names the sender in the ControlMessage
+inline MessageEnvelope create_ping(int target, const std::string& ping_id, const std::string& source) {
+    MessageEnvelope envelope;
+    envelope.set_message_id(ping_id);
+    envelope.set_target(target);
+    envelope.set_type(MessageType::CONTROL);
+    envelope.set_routing(RoutingMode::REQUEST_REPLY);
+    long long now_us = get_current_time_us();
+    envelope.set_timestamp(now_us / 1000);
+    envelope.set_timestamp_us(now_us);
+
+    ControlMessage control;
+    control.set_type(ControlType::PING);
+    control.set_source(source);
+    control.set_destination(std::to_string(target));
+    control.SerializeToString(envelope.mutable_payload());
+    return envelope;
+}
+
+/**
+ * Answer a CONTROL request. PING and HEALTH_CHECK get a PONG; anything else
+ * gets an ERROR status. The reply also carries an ACK for the request's id,
+ * so reply paths that match on original_message_id route it like any other.
+ */
+inline MessageEnvelope create_control_response(
+    const MessageEnvelope& request,
+    const std::string& receiver_id,
+    const ReceiveTiming& timing = ReceiveTiming::now()
+) {
+    ControlMessage control;
+    bool answered = control.ParseFromString(request.payload()) &&
+                    (control.type() == ControlType::PING || control.type() == ControlType::HEALTH_CHECK);
+
+    MessageEnvelope envelope;
+    fill_ack_for(&envelope, request, receiver_id, timing,
+                 answered ? AckStatus::ACK_STATUS_OK : AckStatus::ACK_STATUS_ERROR);
+    envelope.set_message_id("pong_" + request.message_id());
+    envelope.set_type(MessageType::CONTROL);
+
+    ControlMessage pong;
+    pong.set_type(answered ? ControlType::PONG : ControlType::CONTROL_TYPE_UNSPECIFIED);
+    pong.set_source(receiver_id);
+    pong.set_destination(control.source());
+    pong.SerializeToString(envelope.mutable_payload());
+    return envelope;
+}
+
+// Reply to a received envelope: a BatchResponse for batches, a PONG for PINGs, a plain ACK otherwise
+inline MessageEnvelope create_response_for(
+    const MessageEnvelope& received_envelope,
+    const std::string& receiver_id,
+    const ReceiveTiming& timing = ReceiveTiming::now()
+) {
+    if (is_batch(received_envelope)) {
+        return create_batch_response(received_envelope, receiver_id, timing);
+    }
+    if (is_control(received_envelope)) {
+        return create_control_response(received_envelope, receiver_id, timing);
+    }
+    return create_ack_from_envelope(received_envelope, receiver_id, timing);
+}
+
+// ----------------------------------------------------------------------------
+// Arena-backed variants
+//
+// Envelopes are allocated on a caller-owned google::protobuf::Arena and
+// serialized into a caller-owned buffer, so a sender or receiver that resets
+// its MessageArena after each message and keeps one output string does almost
+// no heap allocation per message. String and bytes fields larger than the SSO
+// buffer still allocate; hot loops that need zero allocations refill one reused
+// envelope with fill_data_envelope / fill_ack_envelope instead.
+// ----------------------------------------------------------------------------
+
+/**
+ * Arena over a fixed initial block that Reset() keeps, so per-message
+ * envelopes are carved from the same memory every time.
+ */
+class MessageArena {
+public:
+    explicit MessageArena(size_t block_size = 16 * 1024)
+        : block_(block_size), arena_(make_options(block_)) {}
+    
+    MessageArena(const MessageArena&) = delete;
+    MessageArena& operator=(const MessageArena&) = delete;
+    
+    google::protobuf::Arena* get() { return &arena_; }
+    
+    // Destroy everything allocated since the last reset
+    void reset() { arena_.Reset(); }
+    
+private:
+    static google::protobuf::ArenaOptions make_options(std::vector<char>& block) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block.data();
+        options.initial_block_size = block.size();
+        return options;
+    }
+    
+    std::vector<char> block_;
+    google::protobuf::Arena arena_;
+};
+
+// Create a data envelope on arena; valid until the arena is reset
+inline MessageEnvelope* create_data_envelope(google::protobuf::Arena* arena, const json& item,
+                                             RoutingMode routing = RoutingMode::REQUEST_REPLY) {
+    auto* envelope = google::protobuf::Arena::CreateMessage<MessageEnvelope>(arena);
+    auto* data_msg = google::protobuf::Arena::CreateMessage<DataMessage>(arena);
+    fill_data_envelope(envelope, data_msg, item, routing);
+    return envelope;
+}
+
+// Create an ACK envelope on arena; valid until the arena is reset
+inline MessageEnvelope* create_ack_from_envelope(
+    google::protobuf::Arena* arena,
+    const MessageEnvelope& received_envelope,
+    const std::string& receiver_id,
+    const ReceiveTiming& timing = ReceiveTiming::now(),
+    AckStatus status = AckStatus::ACK_STATUS_OK
 ) {
-    return create_ack_envelope(
-        received_envelope.message_id(),
-        received_envelope.target(),
-        receiver_id,
-        status,
-        latency_ms
-    );
+    auto* envelope = google::protobuf::Arena::CreateMessage<MessageEnvelope>(arena);
+    fill_ack_for(envelope, received_envelope, receiver_id, timing, status);
+    return envelope;
+}
+
+// Serialize into a reused buffer; only grows it when a message is larger than any before
+inline const std::string& serialize_envelope(const MessageEnvelope& envelope, std::string& buffer) {
+    TRACE_SCOPE("serialize");
+    size_t size = envelope.ByteSizeLong();
+    buffer.resize(size);
+    if (size > 0) {
+        envelope.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(&buffer[0]));
+    }
+    return buffer;
+}
+
+// Parse from a transport buffer without copying it into a string first; a compressed
+// payload is decompressed when a decoder is installed
+inline bool parse_envelope(const void* data, size_t size, MessageEnvelope& envelope) {
+    TRACE_SCOPE("parse");
+    return envelope.ParseFromArray(data, static_cast<int>(size)) && decode_payload(envelope);
 }
 
 // Parse a MessageEnvelope from binary string
 inline bool parse_envelope(const std::string& data, MessageEnvelope& envelope) {
-    return envelope.ParseFromString(data);
+    TRACE_SCOPE("parse");
+    return envelope.ParseFromString(data) && decode_payload(envelope);
 }
 
 // Serialize a MessageEnvelope to binary string
 inline std::string serialize_envelope(const MessageEnvelope& envelope) {
+    TRACE_SCOPE("serialize");
     std::string output;
     envelope.SerializeToString(&output);
     return output;
@@ -122,6 +476,7 @@ inline std::string serialize_envelope(const MessageEnvelope& envelope) {
 
 // Check if an envelope is a valid ACK for the given message_id
 inline bool is_valid_ack(const MessageEnvelope& envelope, const std::string& expected_message_id) {
+    TRACE_SCOPE("validate");
     if (envelope.type() != MessageType::ACK || !envelope.has_ack()) {
         return false;
     }
@@ -129,7 +484,34 @@ inline bool is_valid_ack(const MessageEnvelope& envelope, const std::string& exp
     const Acknowledgment& ack = envelope.ack();
     return ack.received() && 
            ack.original_message_id() == expected_message_id &&
-           ack.status() == "OK";
+           is_ack_ok(ack);
+}
+
+// As above, matching on message_seq; ACKs that only echo the string id are matched through it
+inline bool is_valid_ack(const MessageEnvelope& envelope, uint64_t expected_message_seq) {
+    TRACE_SCOPE("validate");
+    if (envelope.type() != MessageType::ACK || !envelope.has_ack()) {
+        return false;
+    }
+    const Acknowledgment& ack = envelope.ack();
+    uint64_t seq = ack.original_message_seq();
+    if (seq == 0) {
+        seq = messaging::utils::parse_message_id(ack.original_message_id()).value_or(0);
+    }
+    return ack.received() && seq == expected_message_seq && is_ack_ok(ack);
+}
+
+/**
+ * True when reply shows that ping_id's receiver is up: its PONG, or the
+ * plain ACK of a receiver that treats the PING as data (the Python receivers).
+ */
+inline bool is_ready_reply(const MessageEnvelope& reply, const std::string& ping_id) {
+    if (reply.type() != MessageType::CONTROL) {
+        return is_valid_ack(reply, ping_id);
+    }
+    ControlMessage pong;
+    return reply.has_ack() && reply.ack().original_message_id() == ping_id &&
+           pong.ParseFromString(reply.payload()) && pong.type() == ControlType::PONG;
 }
 
 // Extract message_id from JSON (handles both string and numeric types)
@@ -0,0 +1,173 @@
+#ifndef MESSAGE_IDS_HPP
+#define MESSAGE_IDS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <optional>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <unistd.h>
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Compact message ids: a 32-bit sender id over a 32-bit per-sender sequence,
+ * carried as MessageEnvelope.message_seq (fixed64) and echoed as
+ * Acknowledgment.original_message_seq. Receivers key duplicate windows on
+ * the sender id, so it has to be wide enough that concurrent senders don't
+ * share one: with 32 random bits, 32 senders collide about once in 10^7 runs.
+ * A sender that passes 2^32 messages carries into the next sender id, which
+ * receivers simply see as a new sender.
+ *
+ * The string message_id is the same 64 bits as 13 base-32 characters, short
+ * enough for std::string's inline buffer, so neither form allocates. Peers
+ * that only echo the string (the Python receivers) can still be matched by
+ * parsing it back with parse_message_id().
+ */
+constexpr int kSenderIdBits = 32;
+constexpr int kSequenceBits = 64 - kSenderIdBits;
+constexpr size_t kMessageIdChars = 13;
+
+// Sequences past 2^kSequenceBits carry into the sender id rather than wrapping onto earlier ids
+inline uint64_t compose_message_seq(uint32_t sender_id, uint64_t sequence) {
+    return (static_cast<uint64_t>(sender_id) << kSequenceBits) + sequence;
+}
+
+inline uint32_t sender_of(uint64_t message_seq) {
+    return static_cast<uint32_t>(message_seq >> kSequenceBits);
+}
+
+inline uint64_t sequence_of(uint64_t message_seq) {
+    return message_seq & ((1ULL << kSequenceBits) - 1);
+}
+
+namespace detail {
+// Crockford base 32 (no i, l, o or u)
+constexpr char kIdAlphabet[] = "0123456789abcdefghjkmnpqrstvwxyz";
+
+inline int id_digit(char c) {
+    for (int d = 0; d < 32; ++d) {
+        if (kIdAlphabet[d] == c) {
+            return d;
+        }
+    }
+    return -1;
+}
+} // namespace detail
+
+// Write message_seq as exactly kMessageIdChars characters, most significant first
+inline void format_message_id(uint64_t message_seq, char* out) {
+    for (size_t i = kMessageIdChars; i-- > 0;) {
+        out[i] = detail::kIdAlphabet[message_seq & 31];
+        message_seq >>= 5;
+    }
+}
+
+inline std::string format_message_id(uint64_t message_seq) {
+    char buf[kMessageIdChars];
+    format_message_id(message_seq, buf);
+    return std::string(buf, kMessageIdChars);
+}
+
+// Inverse of format_message_id; nullopt for ids from other schemes (corpus ids, older senders)
+inline std::optional<uint64_t> parse_message_id(std::string_view id) {
+    if (id.size() != kMessageIdChars) {
+        return std::nullopt;
+    }
+    uint64_t value = 0;
+    for (char c : id) {
+        int d = detail::id_digit(c);
+        if (d < 0) {
+            return std::nullopt;
+        }
+        value = (value << 5) | static_cast<uint64_t>(d);
+    }
+    return value;
+}
+
+/**
+ * Hands out message_seq values for one sender: an atomic increment, with no
+ * clock read, random number or string formatting per message.
+ */
+class MessageIdGenerator {
+public:
+    explicit MessageIdGenerator(uint32_t sender_id = default_sender_id()) : sender_id_(sender_id) {}
+
+    uint64_t next() {
+        return compose_message_seq(sender_id_, sequence_.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+
+    uint32_t sender_id() const { return sender_id_; }
+
+    // Shared generator for code that has no sender of its own to hold one
+    static MessageIdGenerator& global() {
+        static MessageIdGenerator generator;
+        return generator;
+    }
+
+    /**
+     * Mixes pid, start time and the OS entropy source. The last matters for
+     * containers, where every sender may run as the same pid and start within
+     * the same steady-clock tick.
+     */
+    static uint32_t default_sender_id() {
+        std::random_device entropy;
+        uint64_t x = static_cast<uint64_t>(getpid()) ^
+                     static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                     (static_cast<uint64_t>(entropy()) << 32 | entropy());
+        // splitmix64 finalizer
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return static_cast<uint32_t>(x);
+    }
+
+private:
+    uint32_t sender_id_;
+    std::atomic<uint64_t> sequence_{0};
+};
+
+/**
+ * Per-target destination names ("test_channel_3", "test.subject.3", ...)
+ * built once, so the send path indexes a table instead of concatenating a
+ * prefix and std::to_string(target) per message. Read-only after
+ * construction, so one table can be shared by every sender thread.
+ */
+class TopicTable {
+public:
+    // Receiver ids run 0-31; leave headroom for larger harness runs
+    static constexpr int kDefaultTargets = 64;
+
+    explicit TopicTable(std::string prefix, int count = kDefaultTargets) : prefix_(std::move(prefix)) {
+        names_.reserve(count);
+        for (int target = 0; target < count; ++target) {
+            names_.push_back(prefix_ + std::to_string(target));
+        }
+    }
+
+    // Valid until the next lookup on this thread if target is outside the table
+    const std::string& operator[](int target) const {
+        if (target >= 0 && static_cast<size_t>(target) < names_.size()) {
+            return names_[target];
+        }
+        thread_local std::string overflow;
+        overflow.assign(prefix_).append(std::to_string(target));
+        return overflow;
+    }
+
+    const std::string& prefix() const { return prefix_; }
+    size_t size() const { return names_.size(); }
+
+private:
+    std::string prefix_;
+    std::vector<std::string> names_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // MESSAGE_IDS_HPP
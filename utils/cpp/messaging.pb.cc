@@ -44,6 +44,8 @@ PROTOBUF_CONSTEXPR MessageEnvelope::MessageEnvelope(
   , /*decltype(_impl_.timestamp_)*/int64_t{0}
   , /*decltype(_impl_.async_)*/false
   , /*decltype(_impl_.routing_)*/0
+  , /*decltype(_impl_.timestamp_us_)*/int64_t{0}
+  , /*decltype(_impl_.message_seq_)*/uint64_t{0u}
   , /*decltype(_impl_.qos_)*/0
   , /*decltype(_impl_._cached_size_)*/{}} {}
 struct MessageEnvelopeDefaultTypeInternal {
@@ -106,6 +108,12 @@ PROTOBUF_CONSTEXPR Acknowledgment::Acknowledgment(
   , /*decltype(_impl_.status_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
   , /*decltype(_impl_.latency_ms_)*/0
   , /*decltype(_impl_.received_)*/false
+  , /*decltype(_impl_.status_code_)*/0
+  , /*decltype(_impl_.original_message_seq_)*/uint64_t{0u}
+  , /*decltype(_impl_.received_at_us_)*/int64_t{0}
+  , /*decltype(_impl_.processing_ns_)*/int64_t{0}
+  , /*decltype(_impl_.acked_at_us_)*/int64_t{0}
+  , /*decltype(_impl_.decompress_ns_)*/int64_t{0}
   , /*decltype(_impl_._cached_size_)*/{}} {}
 struct AcknowledgmentDefaultTypeInternal {
   PROTOBUF_CONSTEXPR AcknowledgmentDefaultTypeInternal()
@@ -171,6 +179,13 @@ PROTOBUF_CONSTEXPR StatsMessage::StatsMessage(
   , /*decltype(_impl_.avg_latency_ms_)*/0
   , /*decltype(_impl_.throughput_msg_per_sec_)*/0
   , /*decltype(_impl_.timestamp_)*/int64_t{0}
+  , /*decltype(_impl_.elapsed_ms_)*/int64_t{0}
+  , /*decltype(_impl_.window_ms_)*/int64_t{0}
+  , /*decltype(_impl_.in_flight_)*/int64_t{0}
+  , /*decltype(_impl_.p50_latency_ms_)*/0
+  , /*decltype(_impl_.p99_latency_ms_)*/0
+  , /*decltype(_impl_.max_latency_ms_)*/0
+  , /*decltype(_impl_.megabytes_per_sec_)*/0
   , /*decltype(_impl_._cached_size_)*/{}} {}
 struct StatsMessageDefaultTypeInternal {
   PROTOBUF_CONSTEXPR StatsMessageDefaultTypeInternal()
@@ -183,7 +198,7 @@ struct StatsMessageDefaultTypeInternal {
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 StatsMessageDefaultTypeInternal _StatsMessage_default_instance_;
 }  // namespace messaging
 static ::_pb::Metadata file_level_metadata_messaging_2eproto[10];
-static const ::_pb::EnumDescriptor* file_level_enum_descriptors_messaging_2eproto[4];
+static const ::_pb::EnumDescriptor* file_level_enum_descriptors_messaging_2eproto[5];
 static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_messaging_2eproto = nullptr;
 
 const uint32_t TableStruct_messaging_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
@@ -214,6 +229,8 @@ const uint32_t TableStruct_messaging_2eproto::offsets[] PROTOBUF_SECTION_VARIABL
   PROTOBUF_FIELD_OFFSET(::messaging::MessageEnvelope, _impl_.qos_),
   PROTOBUF_FIELD_OFFSET(::messaging::MessageEnvelope, _impl_.metadata_),
   PROTOBUF_FIELD_OFFSET(::messaging::MessageEnvelope, _impl_.ack_),
+  PROTOBUF_FIELD_OFFSET(::messaging::MessageEnvelope, _impl_.timestamp_us_),
+  PROTOBUF_FIELD_OFFSET(::messaging::MessageEnvelope, _impl_.message_seq_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::messaging::DataMessage, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -251,6 +268,12 @@ const uint32_t TableStruct_messaging_2eproto::offsets[] PROTOBUF_SECTION_VARIABL
   PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.latency_ms_),
   PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.receiver_id_),
   PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.status_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.original_message_seq_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.status_code_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.received_at_us_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.processing_ns_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.acked_at_us_),
+  PROTOBUF_FIELD_OFFSET(::messaging::Acknowledgment, _impl_.decompress_ns_),
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::messaging::ControlMessage, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -292,18 +315,25 @@ const uint32_t TableStruct_messaging_2eproto::offsets[] PROTOBUF_SECTION_VARIABL
   PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.avg_latency_ms_),
   PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.throughput_msg_per_sec_),
   PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.timestamp_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.elapsed_ms_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.window_ms_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.in_flight_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.p50_latency_ms_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.p99_latency_ms_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.max_latency_ms_),
+  PROTOBUF_FIELD_OFFSET(::messaging::StatsMessage, _impl_.megabytes_per_sec_),
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, 8, -1, sizeof(::messaging::MessageEnvelope_MetadataEntry_DoNotUse)},
   { 10, -1, -1, sizeof(::messaging::MessageEnvelope)},
-  { 27, -1, -1, sizeof(::messaging::DataMessage)},
-  { 35, -1, -1, sizeof(::messaging::RPCRequest)},
-  { 44, -1, -1, sizeof(::messaging::RPCResponse)},
-  { 53, -1, -1, sizeof(::messaging::Acknowledgment)},
-  { 64, -1, -1, sizeof(::messaging::ControlMessage)},
-  { 74, -1, -1, sizeof(::messaging::BatchMessage)},
-  { 83, -1, -1, sizeof(::messaging::BatchResponse)},
-  { 92, -1, -1, sizeof(::messaging::StatsMessage)},
+  { 29, -1, -1, sizeof(::messaging::DataMessage)},
+  { 37, -1, -1, sizeof(::messaging::RPCRequest)},
+  { 46, -1, -1, sizeof(::messaging::RPCResponse)},
+  { 55, -1, -1, sizeof(::messaging::Acknowledgment)},
+  { 72, -1, -1, sizeof(::messaging::ControlMessage)},
+  { 82, -1, -1, sizeof(::messaging::BatchMessage)},
+  { 91, -1, -1, sizeof(::messaging::BatchResponse)},
+  { 100, -1, -1, sizeof(::messaging::StatsMessage)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -320,7 +350,7 @@ static const ::_pb::Message* const file_default_instances[] = {
 };
 
 const char descriptor_table_protodef_messaging_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
-  "\n\017messaging.proto\022\tmessaging\"\375\002\n\017Message"
+  "\n\017messaging.proto\022\tmessaging\"\250\003\n\017Message"
   "Envelope\022\022\n\nmessage_id\030\001 \001(\t\022\016\n\006target\030\002"
   " \001(\005\022\r\n\005topic\030\003 \001(\t\022$\n\004type\030\004 \001(\0162\026.mess"
   "aging.MessageType\022\017\n\007payload\030\005 \001(\014\022\r\n\005as"
@@ -329,50 +359,62 @@ const char descriptor_table_protodef_messaging_2eproto[] PROTOBUF_SECTION_VARIAB
   "(\0162\023.messaging.QoSLevel\022:\n\010metadata\030\n \003("
   "\0132(.messaging.MessageEnvelope.MetadataEn"
   "try\022&\n\003ack\030\013 \001(\0132\031.messaging.Acknowledgm"
-  "ent\032/\n\rMetadataEntry\022\013\n\003key\030\001 \001(\t\022\r\n\005val"
-  "ue\030\002 \001(\t:\0028\001\":\n\013DataMessage\022\024\n\014message_n"
-  "ame\030\001 \001(\t\022\025\n\rmessage_value\030\002 \003(\t\"C\n\nRPCR"
-  "equest\022\016\n\006method\030\001 \001(\t\022\021\n\targuments\030\002 \001("
-  "\014\022\022\n\ntimeout_ms\030\003 \001(\005\"E\n\013RPCResponse\022\017\n\007"
-  "success\030\001 \001(\010\022\016\n\006result\030\002 \001(\014\022\025\n\rerror_m"
-  "essage\030\003 \001(\t\"x\n\016Acknowledgment\022\033\n\023origin"
-  "al_message_id\030\001 \001(\t\022\020\n\010received\030\002 \001(\010\022\022\n"
-  "\nlatency_ms\030\003 \001(\001\022\023\n\013receiver_id\030\004 \001(\t\022\016"
-  "\n\006status\030\005 \001(\t\"i\n\016ControlMessage\022$\n\004type"
-  "\030\001 \001(\0162\026.messaging.ControlType\022\016\n\006source"
-  "\030\002 \001(\t\022\023\n\013destination\030\003 \001(\t\022\014\n\004data\030\004 \001("
-  "\014\"_\n\014BatchMessage\022,\n\010messages\030\001 \003(\0132\032.me"
-  "ssaging.MessageEnvelope\022\020\n\010batch_id\030\002 \001("
-  "\005\022\017\n\007is_last\030\003 \001(\010\"p\n\rBatchResponse\0222\n\017a"
-  "cknowledgments\030\001 \003(\0132\031.messaging.Acknowl"
-  "edgment\022\024\n\014failed_count\030\002 \001(\005\022\025\n\rerror_m"
-  "essage\030\003 \001(\t\"\273\001\n\014StatsMessage\022\024\n\014service"
-  "_name\030\001 \001(\t\022\025\n\rmessages_sent\030\002 \001(\003\022\031\n\021me"
-  "ssages_received\030\003 \001(\003\022\030\n\020messages_droppe"
-  "d\030\004 \001(\003\022\026\n\016avg_latency_ms\030\005 \001(\001\022\036\n\026throu"
-  "ghput_msg_per_sec\030\006 \001(\001\022\021\n\ttimestamp\030\007 \001"
-  "(\003*\201\001\n\013MessageType\022\034\n\030MESSAGE_TYPE_UNSPE"
-  "CIFIED\020\000\022\020\n\014DATA_MESSAGE\020\001\022\017\n\013RPC_REQUES"
-  "T\020\002\022\020\n\014RPC_RESPONSE\020\003\022\007\n\003ACK\020\004\022\013\n\007CONTRO"
-  "L\020\005\022\t\n\005EVENT\020\006*p\n\013RoutingMode\022\027\n\023ROUTING"
-  "_UNSPECIFIED\020\000\022\022\n\016POINT_TO_POINT\020\001\022\025\n\021PU"
-  "BLISH_SUBSCRIBE\020\002\022\021\n\rREQUEST_REPLY\020\003\022\n\n\006"
-  "FANOUT\020\004*V\n\010QoSLevel\022\023\n\017QOS_UNSPECIFIED\020"
-  "\000\022\020\n\014AT_MOST_ONCE\020\001\022\021\n\rAT_LEAST_ONCE\020\002\022\020"
-  "\n\014EXACTLY_ONCE\020\003*\177\n\013ControlType\022\034\n\030CONTR"
-  "OL_TYPE_UNSPECIFIED\020\000\022\010\n\004PING\020\001\022\010\n\004PONG\020"
-  "\002\022\014\n\010SHUTDOWN\020\003\022\020\n\014HEALTH_CHECK\020\004\022\r\n\tSUB"
-  "SCRIBE\020\005\022\017\n\013UNSUBSCRIBE\020\0062\356\001\n\020MessagingS"
-  "ervice\022L\n\016StreamMessages\022\032.messaging.Mes"
-  "sageEnvelope\032\032.messaging.MessageEnvelope"
-  "(\0010\001\022E\n\013SendMessage\022\032.messaging.MessageE"
-  "nvelope\032\032.messaging.MessageEnvelope\022E\n\tS"
-  "ubscribe\022\032.messaging.MessageEnvelope\032\032.m"
-  "essaging.MessageEnvelope0\001b\006proto3"
+  "ent\022\024\n\014timestamp_us\030\014 \001(\003\022\023\n\013message_seq"
+  "\030\r \001(\006\032/\n\rMetadataEntry\022\013\n\003key\030\001 \001(\t\022\r\n\005"
+  "value\030\002 \001(\t:\0028\001\":\n\013DataMessage\022\024\n\014messag"
+  "e_name\030\001 \001(\t\022\025\n\rmessage_value\030\002 \003(\t\"C\n\nR"
+  "PCRequest\022\016\n\006method\030\001 \001(\t\022\021\n\targuments\030\002"
+  " \001(\014\022\022\n\ntimeout_ms\030\003 \001(\005\"E\n\013RPCResponse\022"
+  "\017\n\007success\030\001 \001(\010\022\016\n\006result\030\002 \001(\014\022\025\n\rerro"
+  "r_message\030\003 \001(\t\"\234\002\n\016Acknowledgment\022\033\n\023or"
+  "iginal_message_id\030\001 \001(\t\022\020\n\010received\030\002 \001("
+  "\010\022\022\n\nlatency_ms\030\003 \001(\001\022\023\n\013receiver_id\030\004 \001"
+  "(\t\022\016\n\006status\030\005 \001(\t\022\034\n\024original_message_s"
+  "eq\030\006 \001(\006\022)\n\013status_code\030\007 \001(\0162\024.messagin"
+  "g.AckStatus\022\026\n\016received_at_us\030\010 \001(\003\022\025\n\rp"
+  "rocessing_ns\030\t \001(\003\022\023\n\013acked_at_us\030\n \001(\003\022"
+  "\025\n\rdecompress_ns\030\013 \001(\003\"i\n\016ControlMessage"
+  "\022$\n\004type\030\001 \001(\0162\026.messaging.ControlType\022\016"
+  "\n\006source\030\002 \001(\t\022\023\n\013destination\030\003 \001(\t\022\014\n\004d"
+  "ata\030\004 \001(\014\"_\n\014BatchMessage\022,\n\010messages\030\001 "
+  "\003(\0132\032.messaging.MessageEnvelope\022\020\n\010batch"
+  "_id\030\002 \001(\005\022\017\n\007is_last\030\003 \001(\010\"p\n\rBatchRespo"
+  "nse\0222\n\017acknowledgments\030\001 \003(\0132\031.messaging"
+  ".Acknowledgment\022\024\n\014failed_count\030\002 \001(\005\022\025\n"
+  "\rerror_message\030\003 \001(\t\"\330\002\n\014StatsMessage\022\024\n"
+  "\014service_name\030\001 \001(\t\022\025\n\rmessages_sent\030\002 \001"
+  "(\003\022\031\n\021messages_received\030\003 \001(\003\022\030\n\020message"
+  "s_dropped\030\004 \001(\003\022\026\n\016avg_latency_ms\030\005 \001(\001\022"
+  "\036\n\026throughput_msg_per_sec\030\006 \001(\001\022\021\n\ttimes"
+  "tamp\030\007 \001(\003\022\022\n\nelapsed_ms\030\010 \001(\003\022\021\n\twindow"
+  "_ms\030\t \001(\003\022\021\n\tin_flight\030\n \001(\003\022\026\n\016p50_late"
+  "ncy_ms\030\013 \001(\001\022\026\n\016p99_latency_ms\030\014 \001(\001\022\026\n\016"
+  "max_latency_ms\030\r \001(\001\022\031\n\021megabytes_per_se"
+  "c\030\016 \001(\001*\214\001\n\013MessageType\022\034\n\030MESSAGE_TYPE_"
+  "UNSPECIFIED\020\000\022\020\n\014DATA_MESSAGE\020\001\022\017\n\013RPC_R"
+  "EQUEST\020\002\022\020\n\014RPC_RESPONSE\020\003\022\007\n\003ACK\020\004\022\013\n\007C"
+  "ONTROL\020\005\022\t\n\005EVENT\020\006\022\t\n\005BATCH\020\007*p\n\013Routin"
+  "gMode\022\027\n\023ROUTING_UNSPECIFIED\020\000\022\022\n\016POINT_"
+  "TO_POINT\020\001\022\025\n\021PUBLISH_SUBSCRIBE\020\002\022\021\n\rREQ"
+  "UEST_REPLY\020\003\022\n\n\006FANOUT\020\004*V\n\010QoSLevel\022\023\n\017"
+  "QOS_UNSPECIFIED\020\000\022\020\n\014AT_MOST_ONCE\020\001\022\021\n\rA"
+  "T_LEAST_ONCE\020\002\022\020\n\014EXACTLY_ONCE\020\003*h\n\tAckS"
+  "tatus\022\032\n\026ACK_STATUS_UNSPECIFIED\020\000\022\021\n\rACK"
+  "_STATUS_OK\020\001\022\024\n\020ACK_STATUS_ERROR\020\002\022\026\n\022AC"
+  "K_STATUS_TIMEOUT\020\003*\177\n\013ControlType\022\034\n\030CON"
+  "TROL_TYPE_UNSPECIFIED\020\000\022\010\n\004PING\020\001\022\010\n\004PON"
+  "G\020\002\022\014\n\010SHUTDOWN\020\003\022\020\n\014HEALTH_CHECK\020\004\022\r\n\tS"
+  "UBSCRIBE\020\005\022\017\n\013UNSUBSCRIBE\020\0062\356\001\n\020Messagin"
+  "gService\022L\n\016StreamMessages\022\032.messaging.M"
+  "essageEnvelope\032\032.messaging.MessageEnvelo"
+  "pe(\0010\001\022E\n\013SendMessage\022\032.messaging.Messag"
+  "eEnvelope\032\032.messaging.MessageEnvelope\022E\n"
+  "\tSubscribe\022\032.messaging.MessageEnvelope\032\032"
+  ".messaging.MessageEnvelope0\001b\006proto3"
   ;
 static ::_pbi::once_flag descriptor_table_messaging_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_messaging_2eproto = {
-    false, false, 1954, descriptor_table_protodef_messaging_2eproto,
+    false, false, 2436, descriptor_table_protodef_messaging_2eproto,
     "messaging.proto",
     &descriptor_table_messaging_2eproto_once, nullptr, 0, 10,
     schemas, file_default_instances, TableStruct_messaging_2eproto::offsets,
@@ -399,6 +441,7 @@ bool MessageType_IsValid(int value) {
     case 4:
     case 5:
     case 6:
+    case 7:
       return true;
     default:
       return false;
@@ -438,10 +481,26 @@ bool QoSLevel_IsValid(int value) {
   }
 }
 
-const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* ControlType_descriptor() {
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* AckStatus_descriptor() {
   ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_messaging_2eproto);
   return file_level_enum_descriptors_messaging_2eproto[3];
 }
+bool AckStatus_IsValid(int value) {
+  switch (value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      return true;
+    default:
+      return false;
+  }
+}
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* ControlType_descriptor() {
+  ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_messaging_2eproto);
+  return file_level_enum_descriptors_messaging_2eproto[4];
+}
 bool ControlType_IsValid(int value) {
   switch (value) {
     case 0:
@@ -506,6 +565,8 @@ MessageEnvelope::MessageEnvelope(const MessageEnvelope& from)
     , decltype(_impl_.timestamp_){}
     , decltype(_impl_.async_){}
     , decltype(_impl_.routing_){}
+    , decltype(_impl_.timestamp_us_){}
+    , decltype(_impl_.message_seq_){}
     , decltype(_impl_.qos_){}
     , /*decltype(_impl_._cached_size_)*/{}};
 
@@ -559,6 +620,8 @@ inline void MessageEnvelope::SharedCtor(
     , decltype(_impl_.timestamp_){int64_t{0}}
     , decltype(_impl_.async_){false}
     , decltype(_impl_.routing_){0}
+    , decltype(_impl_.timestamp_us_){int64_t{0}}
+    , decltype(_impl_.message_seq_){uint64_t{0u}}
     , decltype(_impl_.qos_){0}
     , /*decltype(_impl_._cached_size_)*/{}
   };
@@ -731,6 +794,22 @@ const char* MessageEnvelope::_InternalParse(const char* ptr, ::_pbi::ParseContex
         } else
           goto handle_unusual;
         continue;
+      // int64 timestamp_us = 12;
+      case 12:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 96)) {
+          _impl_.timestamp_us_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // fixed64 message_seq = 13;
+      case 13:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 105)) {
+          _impl_.message_seq_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<uint64_t>(ptr);
+          ptr += sizeof(uint64_t);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -862,6 +941,18 @@ uint8_t* MessageEnvelope::_InternalSerialize(
         _Internal::ack(this).GetCachedSize(), target, stream);
   }
 
+  // int64 timestamp_us = 12;
+  if (this->_internal_timestamp_us() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(12, this->_internal_timestamp_us(), target);
+  }
+
+  // fixed64 message_seq = 13;
+  if (this->_internal_message_seq() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteFixed64ToArray(13, this->_internal_message_seq(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -942,6 +1033,16 @@ size_t MessageEnvelope::ByteSizeLong() const {
       ::_pbi::WireFormatLite::EnumSize(this->_internal_routing());
   }
 
+  // int64 timestamp_us = 12;
+  if (this->_internal_timestamp_us() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_timestamp_us());
+  }
+
+  // fixed64 message_seq = 13;
+  if (this->_internal_message_seq() != 0) {
+    total_size += 1 + 8;
+  }
+
   // .messaging.QoSLevel qos = 9;
   if (this->_internal_qos() != 0) {
     total_size += 1 +
@@ -995,6 +1096,12 @@ void MessageEnvelope::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const
   if (from._internal_routing() != 0) {
     _this->_internal_set_routing(from._internal_routing());
   }
+  if (from._internal_timestamp_us() != 0) {
+    _this->_internal_set_timestamp_us(from._internal_timestamp_us());
+  }
+  if (from._internal_message_seq() != 0) {
+    _this->_internal_set_message_seq(from._internal_message_seq());
+  }
   if (from._internal_qos() != 0) {
     _this->_internal_set_qos(from._internal_qos());
   }
@@ -1857,6 +1964,12 @@ Acknowledgment::Acknowledgment(const Acknowledgment& from)
     , decltype(_impl_.status_){}
     , decltype(_impl_.latency_ms_){}
     , decltype(_impl_.received_){}
+    , decltype(_impl_.status_code_){}
+    , decltype(_impl_.original_message_seq_){}
+    , decltype(_impl_.received_at_us_){}
+    , decltype(_impl_.processing_ns_){}
+    , decltype(_impl_.acked_at_us_){}
+    , decltype(_impl_.decompress_ns_){}
     , /*decltype(_impl_._cached_size_)*/{}};
 
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
@@ -1885,8 +1998,8 @@ Acknowledgment::Acknowledgment(const Acknowledgment& from)
       _this->GetArenaForAllocation());
   }
   ::memcpy(&_impl_.latency_ms_, &from._impl_.latency_ms_,
-    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.received_) -
-    reinterpret_cast<char*>(&_impl_.latency_ms_)) + sizeof(_impl_.received_));
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.decompress_ns_) -
+    reinterpret_cast<char*>(&_impl_.latency_ms_)) + sizeof(_impl_.decompress_ns_));
   // @@protoc_insertion_point(copy_constructor:messaging.Acknowledgment)
 }
 
@@ -1900,6 +2013,12 @@ inline void Acknowledgment::SharedCtor(
     , decltype(_impl_.status_){}
     , decltype(_impl_.latency_ms_){0}
     , decltype(_impl_.received_){false}
+    , decltype(_impl_.status_code_){0}
+    , decltype(_impl_.original_message_seq_){uint64_t{0u}}
+    , decltype(_impl_.received_at_us_){int64_t{0}}
+    , decltype(_impl_.processing_ns_){int64_t{0}}
+    , decltype(_impl_.acked_at_us_){int64_t{0}}
+    , decltype(_impl_.decompress_ns_){int64_t{0}}
     , /*decltype(_impl_._cached_size_)*/{}
   };
   _impl_.original_message_id_.InitDefault();
@@ -1946,8 +2065,8 @@ void Acknowledgment::Clear() {
   _impl_.receiver_id_.ClearToEmpty();
   _impl_.status_.ClearToEmpty();
   ::memset(&_impl_.latency_ms_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&_impl_.received_) -
-      reinterpret_cast<char*>(&_impl_.latency_ms_)) + sizeof(_impl_.received_));
+      reinterpret_cast<char*>(&_impl_.decompress_ns_) -
+      reinterpret_cast<char*>(&_impl_.latency_ms_)) + sizeof(_impl_.decompress_ns_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -2003,6 +2122,55 @@ const char* Acknowledgment::_InternalParse(const char* ptr, ::_pbi::ParseContext
         } else
           goto handle_unusual;
         continue;
+      // fixed64 original_message_seq = 6;
+      case 6:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 49)) {
+          _impl_.original_message_seq_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<uint64_t>(ptr);
+          ptr += sizeof(uint64_t);
+        } else
+          goto handle_unusual;
+        continue;
+      // .messaging.AckStatus status_code = 7;
+      case 7:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 56)) {
+          uint64_t val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+          _internal_set_status_code(static_cast<::messaging::AckStatus>(val));
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 received_at_us = 8;
+      case 8:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 64)) {
+          _impl_.received_at_us_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 processing_ns = 9;
+      case 9:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 72)) {
+          _impl_.processing_ns_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 acked_at_us = 10;
+      case 10:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 80)) {
+          _impl_.acked_at_us_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 decompress_ns = 11;
+      case 11:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 88)) {
+          _impl_.decompress_ns_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -2078,6 +2246,43 @@ uint8_t* Acknowledgment::_InternalSerialize(
         5, this->_internal_status(), target);
   }
 
+  // fixed64 original_message_seq = 6;
+  if (this->_internal_original_message_seq() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteFixed64ToArray(6, this->_internal_original_message_seq(), target);
+  }
+
+  // .messaging.AckStatus status_code = 7;
+  if (this->_internal_status_code() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteEnumToArray(
+      7, this->_internal_status_code(), target);
+  }
+
+  // int64 received_at_us = 8;
+  if (this->_internal_received_at_us() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(8, this->_internal_received_at_us(), target);
+  }
+
+  // int64 processing_ns = 9;
+  if (this->_internal_processing_ns() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(9, this->_internal_processing_ns(), target);
+  }
+
+  // int64 acked_at_us = 10;
+  if (this->_internal_acked_at_us() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(10, this->_internal_acked_at_us(), target);
+  }
+
+  // int64 decompress_ns = 11;
+  if (this->_internal_decompress_ns() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(11, this->_internal_decompress_ns(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -2129,6 +2334,37 @@ size_t Acknowledgment::ByteSizeLong() const {
     total_size += 1 + 1;
   }
 
+  // .messaging.AckStatus status_code = 7;
+  if (this->_internal_status_code() != 0) {
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_status_code());
+  }
+
+  // fixed64 original_message_seq = 6;
+  if (this->_internal_original_message_seq() != 0) {
+    total_size += 1 + 8;
+  }
+
+  // int64 received_at_us = 8;
+  if (this->_internal_received_at_us() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_received_at_us());
+  }
+
+  // int64 processing_ns = 9;
+  if (this->_internal_processing_ns() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_processing_ns());
+  }
+
+  // int64 acked_at_us = 10;
+  if (this->_internal_acked_at_us() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_acked_at_us());
+  }
+
+  // int64 decompress_ns = 11;
+  if (this->_internal_decompress_ns() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_decompress_ns());
+  }
+
   return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
@@ -2166,6 +2402,24 @@ void Acknowledgment::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const :
   if (from._internal_received() != 0) {
     _this->_internal_set_received(from._internal_received());
   }
+  if (from._internal_status_code() != 0) {
+    _this->_internal_set_status_code(from._internal_status_code());
+  }
+  if (from._internal_original_message_seq() != 0) {
+    _this->_internal_set_original_message_seq(from._internal_original_message_seq());
+  }
+  if (from._internal_received_at_us() != 0) {
+    _this->_internal_set_received_at_us(from._internal_received_at_us());
+  }
+  if (from._internal_processing_ns() != 0) {
+    _this->_internal_set_processing_ns(from._internal_processing_ns());
+  }
+  if (from._internal_acked_at_us() != 0) {
+    _this->_internal_set_acked_at_us(from._internal_acked_at_us());
+  }
+  if (from._internal_decompress_ns() != 0) {
+    _this->_internal_set_decompress_ns(from._internal_decompress_ns());
+  }
   _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
@@ -2198,8 +2452,8 @@ void Acknowledgment::InternalSwap(Acknowledgment* other) {
       &other->_impl_.status_, rhs_arena
   );
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(Acknowledgment, _impl_.received_)
-      + sizeof(Acknowledgment::_impl_.received_)
+      PROTOBUF_FIELD_OFFSET(Acknowledgment, _impl_.decompress_ns_)
+      + sizeof(Acknowledgment::_impl_.decompress_ns_)
       - PROTOBUF_FIELD_OFFSET(Acknowledgment, _impl_.latency_ms_)>(
           reinterpret_cast<char*>(&_impl_.latency_ms_),
           reinterpret_cast<char*>(&other->_impl_.latency_ms_));
@@ -3071,6 +3325,13 @@ StatsMessage::StatsMessage(const StatsMessage& from)
     , decltype(_impl_.avg_latency_ms_){}
     , decltype(_impl_.throughput_msg_per_sec_){}
     , decltype(_impl_.timestamp_){}
+    , decltype(_impl_.elapsed_ms_){}
+    , decltype(_impl_.window_ms_){}
+    , decltype(_impl_.in_flight_){}
+    , decltype(_impl_.p50_latency_ms_){}
+    , decltype(_impl_.p99_latency_ms_){}
+    , decltype(_impl_.max_latency_ms_){}
+    , decltype(_impl_.megabytes_per_sec_){}
     , /*decltype(_impl_._cached_size_)*/{}};
 
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
@@ -3083,8 +3344,8 @@ StatsMessage::StatsMessage(const StatsMessage& from)
       _this->GetArenaForAllocation());
   }
   ::memcpy(&_impl_.messages_sent_, &from._impl_.messages_sent_,
-    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.timestamp_) -
-    reinterpret_cast<char*>(&_impl_.messages_sent_)) + sizeof(_impl_.timestamp_));
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.megabytes_per_sec_) -
+    reinterpret_cast<char*>(&_impl_.messages_sent_)) + sizeof(_impl_.megabytes_per_sec_));
   // @@protoc_insertion_point(copy_constructor:messaging.StatsMessage)
 }
 
@@ -3100,6 +3361,13 @@ inline void StatsMessage::SharedCtor(
     , decltype(_impl_.avg_latency_ms_){0}
     , decltype(_impl_.throughput_msg_per_sec_){0}
     , decltype(_impl_.timestamp_){int64_t{0}}
+    , decltype(_impl_.elapsed_ms_){int64_t{0}}
+    , decltype(_impl_.window_ms_){int64_t{0}}
+    , decltype(_impl_.in_flight_){int64_t{0}}
+    , decltype(_impl_.p50_latency_ms_){0}
+    , decltype(_impl_.p99_latency_ms_){0}
+    , decltype(_impl_.max_latency_ms_){0}
+    , decltype(_impl_.megabytes_per_sec_){0}
     , /*decltype(_impl_._cached_size_)*/{}
   };
   _impl_.service_name_.InitDefault();
@@ -3134,8 +3402,8 @@ void StatsMessage::Clear() {
 
   _impl_.service_name_.ClearToEmpty();
   ::memset(&_impl_.messages_sent_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&_impl_.timestamp_) -
-      reinterpret_cast<char*>(&_impl_.messages_sent_)) + sizeof(_impl_.timestamp_));
+      reinterpret_cast<char*>(&_impl_.megabytes_per_sec_) -
+      reinterpret_cast<char*>(&_impl_.messages_sent_)) + sizeof(_impl_.megabytes_per_sec_));
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -3203,6 +3471,62 @@ const char* StatsMessage::_InternalParse(const char* ptr, ::_pbi::ParseContext*
         } else
           goto handle_unusual;
         continue;
+      // int64 elapsed_ms = 8;
+      case 8:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 64)) {
+          _impl_.elapsed_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 window_ms = 9;
+      case 9:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 72)) {
+          _impl_.window_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // int64 in_flight = 10;
+      case 10:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 80)) {
+          _impl_.in_flight_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // double p50_latency_ms = 11;
+      case 11:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 89)) {
+          _impl_.p50_latency_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<double>(ptr);
+          ptr += sizeof(double);
+        } else
+          goto handle_unusual;
+        continue;
+      // double p99_latency_ms = 12;
+      case 12:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 97)) {
+          _impl_.p99_latency_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<double>(ptr);
+          ptr += sizeof(double);
+        } else
+          goto handle_unusual;
+        continue;
+      // double max_latency_ms = 13;
+      case 13:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 105)) {
+          _impl_.max_latency_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<double>(ptr);
+          ptr += sizeof(double);
+        } else
+          goto handle_unusual;
+        continue;
+      // double megabytes_per_sec = 14;
+      case 14:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 113)) {
+          _impl_.megabytes_per_sec_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<double>(ptr);
+          ptr += sizeof(double);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -3286,6 +3610,64 @@ uint8_t* StatsMessage::_InternalSerialize(
     target = ::_pbi::WireFormatLite::WriteInt64ToArray(7, this->_internal_timestamp(), target);
   }
 
+  // int64 elapsed_ms = 8;
+  if (this->_internal_elapsed_ms() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(8, this->_internal_elapsed_ms(), target);
+  }
+
+  // int64 window_ms = 9;
+  if (this->_internal_window_ms() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(9, this->_internal_window_ms(), target);
+  }
+
+  // int64 in_flight = 10;
+  if (this->_internal_in_flight() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteInt64ToArray(10, this->_internal_in_flight(), target);
+  }
+
+  // double p50_latency_ms = 11;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p50_latency_ms = this->_internal_p50_latency_ms();
+  uint64_t raw_p50_latency_ms;
+  memcpy(&raw_p50_latency_ms, &tmp_p50_latency_ms, sizeof(tmp_p50_latency_ms));
+  if (raw_p50_latency_ms != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteDoubleToArray(11, this->_internal_p50_latency_ms(), target);
+  }
+
+  // double p99_latency_ms = 12;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p99_latency_ms = this->_internal_p99_latency_ms();
+  uint64_t raw_p99_latency_ms;
+  memcpy(&raw_p99_latency_ms, &tmp_p99_latency_ms, sizeof(tmp_p99_latency_ms));
+  if (raw_p99_latency_ms != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteDoubleToArray(12, this->_internal_p99_latency_ms(), target);
+  }
+
+  // double max_latency_ms = 13;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_max_latency_ms = this->_internal_max_latency_ms();
+  uint64_t raw_max_latency_ms;
+  memcpy(&raw_max_latency_ms, &tmp_max_latency_ms, sizeof(tmp_max_latency_ms));
+  if (raw_max_latency_ms != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteDoubleToArray(13, this->_internal_max_latency_ms(), target);
+  }
+
+  // double megabytes_per_sec = 14;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_megabytes_per_sec = this->_internal_megabytes_per_sec();
+  uint64_t raw_megabytes_per_sec;
+  memcpy(&raw_megabytes_per_sec, &tmp_megabytes_per_sec, sizeof(tmp_megabytes_per_sec));
+  if (raw_megabytes_per_sec != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteDoubleToArray(14, this->_internal_megabytes_per_sec(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -3347,6 +3729,57 @@ size_t StatsMessage::ByteSizeLong() const {
     total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_timestamp());
   }
 
+  // int64 elapsed_ms = 8;
+  if (this->_internal_elapsed_ms() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_elapsed_ms());
+  }
+
+  // int64 window_ms = 9;
+  if (this->_internal_window_ms() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_window_ms());
+  }
+
+  // int64 in_flight = 10;
+  if (this->_internal_in_flight() != 0) {
+    total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this->_internal_in_flight());
+  }
+
+  // double p50_latency_ms = 11;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p50_latency_ms = this->_internal_p50_latency_ms();
+  uint64_t raw_p50_latency_ms;
+  memcpy(&raw_p50_latency_ms, &tmp_p50_latency_ms, sizeof(tmp_p50_latency_ms));
+  if (raw_p50_latency_ms != 0) {
+    total_size += 1 + 8;
+  }
+
+  // double p99_latency_ms = 12;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p99_latency_ms = this->_internal_p99_latency_ms();
+  uint64_t raw_p99_latency_ms;
+  memcpy(&raw_p99_latency_ms, &tmp_p99_latency_ms, sizeof(tmp_p99_latency_ms));
+  if (raw_p99_latency_ms != 0) {
+    total_size += 1 + 8;
+  }
+
+  // double max_latency_ms = 13;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_max_latency_ms = this->_internal_max_latency_ms();
+  uint64_t raw_max_latency_ms;
+  memcpy(&raw_max_latency_ms, &tmp_max_latency_ms, sizeof(tmp_max_latency_ms));
+  if (raw_max_latency_ms != 0) {
+    total_size += 1 + 8;
+  }
+
+  // double megabytes_per_sec = 14;
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_megabytes_per_sec = this->_internal_megabytes_per_sec();
+  uint64_t raw_megabytes_per_sec;
+  memcpy(&raw_megabytes_per_sec, &tmp_megabytes_per_sec, sizeof(tmp_megabytes_per_sec));
+  if (raw_megabytes_per_sec != 0) {
+    total_size += 1 + 8;
+  }
+
   return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
@@ -3394,6 +3827,43 @@ void StatsMessage::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::P
   if (from._internal_timestamp() != 0) {
     _this->_internal_set_timestamp(from._internal_timestamp());
   }
+  if (from._internal_elapsed_ms() != 0) {
+    _this->_internal_set_elapsed_ms(from._internal_elapsed_ms());
+  }
+  if (from._internal_window_ms() != 0) {
+    _this->_internal_set_window_ms(from._internal_window_ms());
+  }
+  if (from._internal_in_flight() != 0) {
+    _this->_internal_set_in_flight(from._internal_in_flight());
+  }
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p50_latency_ms = from._internal_p50_latency_ms();
+  uint64_t raw_p50_latency_ms;
+  memcpy(&raw_p50_latency_ms, &tmp_p50_latency_ms, sizeof(tmp_p50_latency_ms));
+  if (raw_p50_latency_ms != 0) {
+    _this->_internal_set_p50_latency_ms(from._internal_p50_latency_ms());
+  }
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_p99_latency_ms = from._internal_p99_latency_ms();
+  uint64_t raw_p99_latency_ms;
+  memcpy(&raw_p99_latency_ms, &tmp_p99_latency_ms, sizeof(tmp_p99_latency_ms));
+  if (raw_p99_latency_ms != 0) {
+    _this->_internal_set_p99_latency_ms(from._internal_p99_latency_ms());
+  }
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_max_latency_ms = from._internal_max_latency_ms();
+  uint64_t raw_max_latency_ms;
+  memcpy(&raw_max_latency_ms, &tmp_max_latency_ms, sizeof(tmp_max_latency_ms));
+  if (raw_max_latency_ms != 0) {
+    _this->_internal_set_max_latency_ms(from._internal_max_latency_ms());
+  }
+  static_assert(sizeof(uint64_t) == sizeof(double), "Code assumes uint64_t and double are the same size.");
+  double tmp_megabytes_per_sec = from._internal_megabytes_per_sec();
+  uint64_t raw_megabytes_per_sec;
+  memcpy(&raw_megabytes_per_sec, &tmp_megabytes_per_sec, sizeof(tmp_megabytes_per_sec));
+  if (raw_megabytes_per_sec != 0) {
+    _this->_internal_set_megabytes_per_sec(from._internal_megabytes_per_sec());
+  }
   _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
@@ -3418,8 +3888,8 @@ void StatsMessage::InternalSwap(StatsMessage* other) {
       &other->_impl_.service_name_, rhs_arena
   );
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(StatsMessage, _impl_.timestamp_)
-      + sizeof(StatsMessage::_impl_.timestamp_)
+      PROTOBUF_FIELD_OFFSET(StatsMessage, _impl_.megabytes_per_sec_)
+      + sizeof(StatsMessage::_impl_.megabytes_per_sec_)
       - PROTOBUF_FIELD_OFFSET(StatsMessage, _impl_.messages_sent_)>(
           reinterpret_cast<char*>(&_impl_.messages_sent_),
           reinterpret_cast<char*>(&other->_impl_.messages_sent_));
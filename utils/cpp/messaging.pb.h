@@ -102,12 +102,13 @@ enum MessageType : int {
   ACK = 4,
   CONTROL = 5,
   EVENT = 6,
+  BATCH = 7,
   MessageType_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
   MessageType_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
 };
 bool MessageType_IsValid(int value);
 constexpr MessageType MessageType_MIN = MESSAGE_TYPE_UNSPECIFIED;
-constexpr MessageType MessageType_MAX = EVENT;
+constexpr MessageType MessageType_MAX = BATCH;
 constexpr int MessageType_ARRAYSIZE = MessageType_MAX + 1;
 
 const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* MessageType_descriptor();
@@ -179,6 +180,33 @@ inline bool QoSLevel_Parse(
   return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<QoSLevel>(
     QoSLevel_descriptor(), name, value);
 }
+enum AckStatus : int {
+  ACK_STATUS_UNSPECIFIED = 0,
+  ACK_STATUS_OK = 1,
+  ACK_STATUS_ERROR = 2,
+  ACK_STATUS_TIMEOUT = 3,
+  AckStatus_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  AckStatus_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
+};
+bool AckStatus_IsValid(int value);
+constexpr AckStatus AckStatus_MIN = ACK_STATUS_UNSPECIFIED;
+constexpr AckStatus AckStatus_MAX = ACK_STATUS_TIMEOUT;
+constexpr int AckStatus_ARRAYSIZE = AckStatus_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* AckStatus_descriptor();
+template<typename T>
+inline const std::string& AckStatus_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, AckStatus>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function AckStatus_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    AckStatus_descriptor(), enum_t_value);
+}
+inline bool AckStatus_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, AckStatus* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<AckStatus>(
+    AckStatus_descriptor(), name, value);
+}
 enum ControlType : int {
   CONTROL_TYPE_UNSPECIFIED = 0,
   PING = 1,
@@ -373,6 +401,8 @@ class MessageEnvelope final :
     kTimestampFieldNumber = 7,
     kAsyncFieldNumber = 6,
     kRoutingFieldNumber = 8,
+    kTimestampUsFieldNumber = 12,
+    kMessageSeqFieldNumber = 13,
     kQosFieldNumber = 9,
   };
   // map<string, string> metadata = 10;
@@ -497,6 +527,24 @@ class MessageEnvelope final :
   void _internal_set_routing(::messaging::RoutingMode value);
   public:
 
+  // int64 timestamp_us = 12;
+  void clear_timestamp_us();
+  int64_t timestamp_us() const;
+  void set_timestamp_us(int64_t value);
+  private:
+  int64_t _internal_timestamp_us() const;
+  void _internal_set_timestamp_us(int64_t value);
+  public:
+
+  // fixed64 message_seq = 13;
+  void clear_message_seq();
+  uint64_t message_seq() const;
+  void set_message_seq(uint64_t value);
+  private:
+  uint64_t _internal_message_seq() const;
+  void _internal_set_message_seq(uint64_t value);
+  public:
+
   // .messaging.QoSLevel qos = 9;
   void clear_qos();
   ::messaging::QoSLevel qos() const;
@@ -528,6 +576,8 @@ class MessageEnvelope final :
     int64_t timestamp_;
     bool async_;
     int routing_;
+    int64_t timestamp_us_;
+    uint64_t message_seq_;
     int qos_;
     mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   };
@@ -1201,6 +1251,12 @@ class Acknowledgment final :
     kStatusFieldNumber = 5,
     kLatencyMsFieldNumber = 3,
     kReceivedFieldNumber = 2,
+    kStatusCodeFieldNumber = 7,
+    kOriginalMessageSeqFieldNumber = 6,
+    kReceivedAtUsFieldNumber = 8,
+    kProcessingNsFieldNumber = 9,
+    kAckedAtUsFieldNumber = 10,
+    kDecompressNsFieldNumber = 11,
   };
   // string original_message_id = 1;
   void clear_original_message_id();
@@ -1262,6 +1318,60 @@ class Acknowledgment final :
   void _internal_set_received(bool value);
   public:
 
+  // .messaging.AckStatus status_code = 7;
+  void clear_status_code();
+  ::messaging::AckStatus status_code() const;
+  void set_status_code(::messaging::AckStatus value);
+  private:
+  ::messaging::AckStatus _internal_status_code() const;
+  void _internal_set_status_code(::messaging::AckStatus value);
+  public:
+
+  // fixed64 original_message_seq = 6;
+  void clear_original_message_seq();
+  uint64_t original_message_seq() const;
+  void set_original_message_seq(uint64_t value);
+  private:
+  uint64_t _internal_original_message_seq() const;
+  void _internal_set_original_message_seq(uint64_t value);
+  public:
+
+  // int64 received_at_us = 8;
+  void clear_received_at_us();
+  int64_t received_at_us() const;
+  void set_received_at_us(int64_t value);
+  private:
+  int64_t _internal_received_at_us() const;
+  void _internal_set_received_at_us(int64_t value);
+  public:
+
+  // int64 processing_ns = 9;
+  void clear_processing_ns();
+  int64_t processing_ns() const;
+  void set_processing_ns(int64_t value);
+  private:
+  int64_t _internal_processing_ns() const;
+  void _internal_set_processing_ns(int64_t value);
+  public:
+
+  // int64 acked_at_us = 10;
+  void clear_acked_at_us();
+  int64_t acked_at_us() const;
+  void set_acked_at_us(int64_t value);
+  private:
+  int64_t _internal_acked_at_us() const;
+  void _internal_set_acked_at_us(int64_t value);
+  public:
+
+  // int64 decompress_ns = 11;
+  void clear_decompress_ns();
+  int64_t decompress_ns() const;
+  void set_decompress_ns(int64_t value);
+  private:
+  int64_t _internal_decompress_ns() const;
+  void _internal_set_decompress_ns(int64_t value);
+  public:
+
   // @@protoc_insertion_point(class_scope:messaging.Acknowledgment)
  private:
   class _Internal;
@@ -1275,6 +1385,12 @@ class Acknowledgment final :
     ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr status_;
     double latency_ms_;
     bool received_;
+    int status_code_;
+    uint64_t original_message_seq_;
+    int64_t received_at_us_;
+    int64_t processing_ns_;
+    int64_t acked_at_us_;
+    int64_t decompress_ns_;
     mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   };
   union { Impl_ _impl_; };
@@ -1969,6 +2085,13 @@ class StatsMessage final :
     kAvgLatencyMsFieldNumber = 5,
     kThroughputMsgPerSecFieldNumber = 6,
     kTimestampFieldNumber = 7,
+    kElapsedMsFieldNumber = 8,
+    kWindowMsFieldNumber = 9,
+    kInFlightFieldNumber = 10,
+    kP50LatencyMsFieldNumber = 11,
+    kP99LatencyMsFieldNumber = 12,
+    kMaxLatencyMsFieldNumber = 13,
+    kMegabytesPerSecFieldNumber = 14,
   };
   // string service_name = 1;
   void clear_service_name();
@@ -2038,6 +2161,69 @@ class StatsMessage final :
   void _internal_set_timestamp(int64_t value);
   public:
 
+  // int64 elapsed_ms = 8;
+  void clear_elapsed_ms();
+  int64_t elapsed_ms() const;
+  void set_elapsed_ms(int64_t value);
+  private:
+  int64_t _internal_elapsed_ms() const;
+  void _internal_set_elapsed_ms(int64_t value);
+  public:
+
+  // int64 window_ms = 9;
+  void clear_window_ms();
+  int64_t window_ms() const;
+  void set_window_ms(int64_t value);
+  private:
+  int64_t _internal_window_ms() const;
+  void _internal_set_window_ms(int64_t value);
+  public:
+
+  // int64 in_flight = 10;
+  void clear_in_flight();
+  int64_t in_flight() const;
+  void set_in_flight(int64_t value);
+  private:
+  int64_t _internal_in_flight() const;
+  void _internal_set_in_flight(int64_t value);
+  public:
+
+  // double p50_latency_ms = 11;
+  void clear_p50_latency_ms();
+  double p50_latency_ms() const;
+  void set_p50_latency_ms(double value);
+  private:
+  double _internal_p50_latency_ms() const;
+  void _internal_set_p50_latency_ms(double value);
+  public:
+
+  // double p99_latency_ms = 12;
+  void clear_p99_latency_ms();
+  double p99_latency_ms() const;
+  void set_p99_latency_ms(double value);
+  private:
+  double _internal_p99_latency_ms() const;
+  void _internal_set_p99_latency_ms(double value);
+  public:
+
+  // double max_latency_ms = 13;
+  void clear_max_latency_ms();
+  double max_latency_ms() const;
+  void set_max_latency_ms(double value);
+  private:
+  double _internal_max_latency_ms() const;
+  void _internal_set_max_latency_ms(double value);
+  public:
+
+  // double megabytes_per_sec = 14;
+  void clear_megabytes_per_sec();
+  double megabytes_per_sec() const;
+  void set_megabytes_per_sec(double value);
+  private:
+  double _internal_megabytes_per_sec() const;
+  void _internal_set_megabytes_per_sec(double value);
+  public:
+
   // @@protoc_insertion_point(class_scope:messaging.StatsMessage)
  private:
   class _Internal;
@@ -2053,6 +2239,13 @@ class StatsMessage final :
     double avg_latency_ms_;
     double throughput_msg_per_sec_;
     int64_t timestamp_;
+    int64_t elapsed_ms_;
+    int64_t window_ms_;
+    int64_t in_flight_;
+    double p50_latency_ms_;
+    double p99_latency_ms_;
+    double max_latency_ms_;
+    double megabytes_per_sec_;
     mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   };
   union { Impl_ _impl_; };
@@ -2460,6 +2653,46 @@ inline void MessageEnvelope::set_allocated_ack(::messaging::Acknowledgment* ack)
   // @@protoc_insertion_point(field_set_allocated:messaging.MessageEnvelope.ack)
 }
 
+// int64 timestamp_us = 12;
+inline void MessageEnvelope::clear_timestamp_us() {
+  _impl_.timestamp_us_ = int64_t{0};
+}
+inline int64_t MessageEnvelope::_internal_timestamp_us() const {
+  return _impl_.timestamp_us_;
+}
+inline int64_t MessageEnvelope::timestamp_us() const {
+  // @@protoc_insertion_point(field_get:messaging.MessageEnvelope.timestamp_us)
+  return _internal_timestamp_us();
+}
+inline void MessageEnvelope::_internal_set_timestamp_us(int64_t value) {
+  
+  _impl_.timestamp_us_ = value;
+}
+inline void MessageEnvelope::set_timestamp_us(int64_t value) {
+  _internal_set_timestamp_us(value);
+  // @@protoc_insertion_point(field_set:messaging.MessageEnvelope.timestamp_us)
+}
+
+// fixed64 message_seq = 13;
+inline void MessageEnvelope::clear_message_seq() {
+  _impl_.message_seq_ = uint64_t{0u};
+}
+inline uint64_t MessageEnvelope::_internal_message_seq() const {
+  return _impl_.message_seq_;
+}
+inline uint64_t MessageEnvelope::message_seq() const {
+  // @@protoc_insertion_point(field_get:messaging.MessageEnvelope.message_seq)
+  return _internal_message_seq();
+}
+inline void MessageEnvelope::_internal_set_message_seq(uint64_t value) {
+  
+  _impl_.message_seq_ = value;
+}
+inline void MessageEnvelope::set_message_seq(uint64_t value) {
+  _internal_set_message_seq(value);
+  // @@protoc_insertion_point(field_set:messaging.MessageEnvelope.message_seq)
+}
+
 // -------------------------------------------------------------------
 
 // DataMessage
@@ -3031,6 +3264,126 @@ inline void Acknowledgment::set_allocated_status(std::string* status) {
   // @@protoc_insertion_point(field_set_allocated:messaging.Acknowledgment.status)
 }
 
+// fixed64 original_message_seq = 6;
+inline void Acknowledgment::clear_original_message_seq() {
+  _impl_.original_message_seq_ = uint64_t{0u};
+}
+inline uint64_t Acknowledgment::_internal_original_message_seq() const {
+  return _impl_.original_message_seq_;
+}
+inline uint64_t Acknowledgment::original_message_seq() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.original_message_seq)
+  return _internal_original_message_seq();
+}
+inline void Acknowledgment::_internal_set_original_message_seq(uint64_t value) {
+  
+  _impl_.original_message_seq_ = value;
+}
+inline void Acknowledgment::set_original_message_seq(uint64_t value) {
+  _internal_set_original_message_seq(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.original_message_seq)
+}
+
+// .messaging.AckStatus status_code = 7;
+inline void Acknowledgment::clear_status_code() {
+  _impl_.status_code_ = 0;
+}
+inline ::messaging::AckStatus Acknowledgment::_internal_status_code() const {
+  return static_cast< ::messaging::AckStatus >(_impl_.status_code_);
+}
+inline ::messaging::AckStatus Acknowledgment::status_code() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.status_code)
+  return _internal_status_code();
+}
+inline void Acknowledgment::_internal_set_status_code(::messaging::AckStatus value) {
+  
+  _impl_.status_code_ = value;
+}
+inline void Acknowledgment::set_status_code(::messaging::AckStatus value) {
+  _internal_set_status_code(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.status_code)
+}
+
+// int64 received_at_us = 8;
+inline void Acknowledgment::clear_received_at_us() {
+  _impl_.received_at_us_ = int64_t{0};
+}
+inline int64_t Acknowledgment::_internal_received_at_us() const {
+  return _impl_.received_at_us_;
+}
+inline int64_t Acknowledgment::received_at_us() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.received_at_us)
+  return _internal_received_at_us();
+}
+inline void Acknowledgment::_internal_set_received_at_us(int64_t value) {
+  
+  _impl_.received_at_us_ = value;
+}
+inline void Acknowledgment::set_received_at_us(int64_t value) {
+  _internal_set_received_at_us(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.received_at_us)
+}
+
+// int64 processing_ns = 9;
+inline void Acknowledgment::clear_processing_ns() {
+  _impl_.processing_ns_ = int64_t{0};
+}
+inline int64_t Acknowledgment::_internal_processing_ns() const {
+  return _impl_.processing_ns_;
+}
+inline int64_t Acknowledgment::processing_ns() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.processing_ns)
+  return _internal_processing_ns();
+}
+inline void Acknowledgment::_internal_set_processing_ns(int64_t value) {
+  
+  _impl_.processing_ns_ = value;
+}
+inline void Acknowledgment::set_processing_ns(int64_t value) {
+  _internal_set_processing_ns(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.processing_ns)
+}
+
+// int64 acked_at_us = 10;
+inline void Acknowledgment::clear_acked_at_us() {
+  _impl_.acked_at_us_ = int64_t{0};
+}
+inline int64_t Acknowledgment::_internal_acked_at_us() const {
+  return _impl_.acked_at_us_;
+}
+inline int64_t Acknowledgment::acked_at_us() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.acked_at_us)
+  return _internal_acked_at_us();
+}
+inline void Acknowledgment::_internal_set_acked_at_us(int64_t value) {
+  
+  _impl_.acked_at_us_ = value;
+}
+inline void Acknowledgment::set_acked_at_us(int64_t value) {
+  _internal_set_acked_at_us(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.acked_at_us)
+}
+
+// int64 decompress_ns = 11;
+inline void Acknowledgment::clear_decompress_ns() {
+  _impl_.decompress_ns_ = int64_t{0};
+}
+inline int64_t Acknowledgment::_internal_decompress_ns() const {
+  return _impl_.decompress_ns_;
+}
+inline int64_t Acknowledgment::decompress_ns() const {
+  // @@protoc_insertion_point(field_get:messaging.Acknowledgment.decompress_ns)
+  return _internal_decompress_ns();
+}
+inline void Acknowledgment::_internal_set_decompress_ns(int64_t value) {
+  
+  _impl_.decompress_ns_ = value;
+}
+inline void Acknowledgment::set_decompress_ns(int64_t value) {
+  _internal_set_decompress_ns(value);
+  // @@protoc_insertion_point(field_set:messaging.Acknowledgment.decompress_ns)
+}
+
 // -------------------------------------------------------------------
 
 // ControlMessage
@@ -3577,6 +3930,146 @@ inline void StatsMessage::set_timestamp(int64_t value) {
   // @@protoc_insertion_point(field_set:messaging.StatsMessage.timestamp)
 }
 
+// int64 elapsed_ms = 8;
+inline void StatsMessage::clear_elapsed_ms() {
+  _impl_.elapsed_ms_ = int64_t{0};
+}
+inline int64_t StatsMessage::_internal_elapsed_ms() const {
+  return _impl_.elapsed_ms_;
+}
+inline int64_t StatsMessage::elapsed_ms() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.elapsed_ms)
+  return _internal_elapsed_ms();
+}
+inline void StatsMessage::_internal_set_elapsed_ms(int64_t value) {
+  
+  _impl_.elapsed_ms_ = value;
+}
+inline void StatsMessage::set_elapsed_ms(int64_t value) {
+  _internal_set_elapsed_ms(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.elapsed_ms)
+}
+
+// int64 window_ms = 9;
+inline void StatsMessage::clear_window_ms() {
+  _impl_.window_ms_ = int64_t{0};
+}
+inline int64_t StatsMessage::_internal_window_ms() const {
+  return _impl_.window_ms_;
+}
+inline int64_t StatsMessage::window_ms() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.window_ms)
+  return _internal_window_ms();
+}
+inline void StatsMessage::_internal_set_window_ms(int64_t value) {
+  
+  _impl_.window_ms_ = value;
+}
+inline void StatsMessage::set_window_ms(int64_t value) {
+  _internal_set_window_ms(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.window_ms)
+}
+
+// int64 in_flight = 10;
+inline void StatsMessage::clear_in_flight() {
+  _impl_.in_flight_ = int64_t{0};
+}
+inline int64_t StatsMessage::_internal_in_flight() const {
+  return _impl_.in_flight_;
+}
+inline int64_t StatsMessage::in_flight() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.in_flight)
+  return _internal_in_flight();
+}
+inline void StatsMessage::_internal_set_in_flight(int64_t value) {
+  
+  _impl_.in_flight_ = value;
+}
+inline void StatsMessage::set_in_flight(int64_t value) {
+  _internal_set_in_flight(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.in_flight)
+}
+
+// double p50_latency_ms = 11;
+inline void StatsMessage::clear_p50_latency_ms() {
+  _impl_.p50_latency_ms_ = 0;
+}
+inline double StatsMessage::_internal_p50_latency_ms() const {
+  return _impl_.p50_latency_ms_;
+}
+inline double StatsMessage::p50_latency_ms() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.p50_latency_ms)
+  return _internal_p50_latency_ms();
+}
+inline void StatsMessage::_internal_set_p50_latency_ms(double value) {
+  
+  _impl_.p50_latency_ms_ = value;
+}
+inline void StatsMessage::set_p50_latency_ms(double value) {
+  _internal_set_p50_latency_ms(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.p50_latency_ms)
+}
+
+// double p99_latency_ms = 12;
+inline void StatsMessage::clear_p99_latency_ms() {
+  _impl_.p99_latency_ms_ = 0;
+}
+inline double StatsMessage::_internal_p99_latency_ms() const {
+  return _impl_.p99_latency_ms_;
+}
+inline double StatsMessage::p99_latency_ms() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.p99_latency_ms)
+  return _internal_p99_latency_ms();
+}
+inline void StatsMessage::_internal_set_p99_latency_ms(double value) {
+  
+  _impl_.p99_latency_ms_ = value;
+}
+inline void StatsMessage::set_p99_latency_ms(double value) {
+  _internal_set_p99_latency_ms(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.p99_latency_ms)
+}
+
+// double max_latency_ms = 13;
+inline void StatsMessage::clear_max_latency_ms() {
+  _impl_.max_latency_ms_ = 0;
+}
+inline double StatsMessage::_internal_max_latency_ms() const {
+  return _impl_.max_latency_ms_;
+}
+inline double StatsMessage::max_latency_ms() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.max_latency_ms)
+  return _internal_max_latency_ms();
+}
+inline void StatsMessage::_internal_set_max_latency_ms(double value) {
+  
+  _impl_.max_latency_ms_ = value;
+}
+inline void StatsMessage::set_max_latency_ms(double value) {
+  _internal_set_max_latency_ms(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.max_latency_ms)
+}
+
+// double megabytes_per_sec = 14;
+inline void StatsMessage::clear_megabytes_per_sec() {
+  _impl_.megabytes_per_sec_ = 0;
+}
+inline double StatsMessage::_internal_megabytes_per_sec() const {
+  return _impl_.megabytes_per_sec_;
+}
+inline double StatsMessage::megabytes_per_sec() const {
+  // @@protoc_insertion_point(field_get:messaging.StatsMessage.megabytes_per_sec)
+  return _internal_megabytes_per_sec();
+}
+inline void StatsMessage::_internal_set_megabytes_per_sec(double value) {
+  
+  _impl_.megabytes_per_sec_ = value;
+}
+inline void StatsMessage::set_megabytes_per_sec(double value) {
+  _internal_set_megabytes_per_sec(value);
+  // @@protoc_insertion_point(field_set:messaging.StatsMessage.megabytes_per_sec)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -3620,6 +4113,11 @@ template <>
 inline const EnumDescriptor* GetEnumDescriptor< ::messaging::QoSLevel>() {
   return ::messaging::QoSLevel_descriptor();
 }
+template <> struct is_proto_enum< ::messaging::AckStatus> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::messaging::AckStatus>() {
+  return ::messaging::AckStatus_descriptor();
+}
 template <> struct is_proto_enum< ::messaging::ControlType> : ::std::true_type {};
 template <>
 inline const EnumDescriptor* GetEnumDescriptor< ::messaging::ControlType>() {
@@ -12,9 +12,12 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
-#include <numeric>
 #include <google/protobuf/util/json_util.h>
 #include "messaging.pb.h"
+#include "message_ids.hpp"
+#include "envelope_view.hpp"
+#include "latency_histogram.hpp"
+#include "stats_shard.hpp"
 
 using namespace google::protobuf;
 
@@ -28,7 +31,8 @@ enum class MessageType {
     RPC_RESPONSE,
     ACK,
     CONTROL,
-    EVENT
+    EVENT,
+    BATCH
 };
 
 // Routing modes
@@ -55,6 +59,7 @@ inline messaging::MessageType to_proto_message_type(MessageType type) {
         case MessageType::ACK: return messaging::MessageType::ACK;
         case MessageType::CONTROL: return messaging::MessageType::CONTROL;
         case MessageType::EVENT: return messaging::MessageType::EVENT;
+        case MessageType::BATCH: return messaging::MessageType::BATCH;
         default: return messaging::MessageType::DATA_MESSAGE;
     }
 }
@@ -67,6 +72,7 @@ inline MessageType from_proto_message_type(messaging::MessageType type) {
         case messaging::MessageType::ACK: return MessageType::ACK;
         case messaging::MessageType::CONTROL: return MessageType::CONTROL;
         case messaging::MessageType::EVENT: return MessageType::EVENT;
+        case messaging::MessageType::BATCH: return MessageType::BATCH;
         default: return MessageType::DATA_MESSAGE;
     }
 }
@@ -113,28 +119,50 @@ inline QoSLevel from_proto_qos_level(messaging::QoSLevel level) {
 class Acknowledgment {
 public:
     std::string original_message_id;
+    uint64_t original_message_seq = 0;
     bool received = false;
     double latency_ms = 0.0;
     std::string receiver_id;
     std::string status = "OK";
+    ::messaging::AckStatus status_code = ::messaging::AckStatus::ACK_STATUS_OK;
+    int64_t received_at_us = 0;   // receiver wall clock at arrival, 0 if unmeasured
+    int64_t processing_ns = 0;
+    int64_t acked_at_us = 0;
+    int64_t decompress_ns = 0;    // part of processing_ns spent decompressing the request
 
     ::messaging::Acknowledgment to_proto() const {
         ::messaging::Acknowledgment ack;
-        ack.set_original_message_id(original_message_id);
-        ack.set_received(received);
-        ack.set_latency_ms(latency_ms);
-        ack.set_receiver_id(receiver_id);
-        ack.set_status(status);
+        fill_proto(&ack);
         return ack;
     }
 
+    void fill_proto(::messaging::Acknowledgment* ack) const {
+        ack->set_original_message_id(original_message_id);
+        ack->set_original_message_seq(original_message_seq);
+        ack->set_received(received);
+        ack->set_latency_ms(latency_ms);
+        ack->set_receiver_id(receiver_id);
+        ack->set_status(status);
+        ack->set_status_code(status_code);
+        ack->set_received_at_us(received_at_us);
+        ack->set_processing_ns(processing_ns);
+        ack->set_acked_at_us(acked_at_us);
+        ack->set_decompress_ns(decompress_ns);
+    }
+
     static Acknowledgment from_proto(const ::messaging::Acknowledgment& ack) {
         Acknowledgment a;
         a.original_message_id = ack.original_message_id();
+        a.original_message_seq = ack.original_message_seq();
         a.received = ack.received();
         a.latency_ms = ack.latency_ms();
         a.receiver_id = ack.receiver_id();
         a.status = ack.status();
+        a.status_code = ack.status_code();
+        a.received_at_us = ack.received_at_us();
+        a.processing_ns = ack.processing_ns();
+        a.acked_at_us = ack.acked_at_us();
+        a.decompress_ns = ack.decompress_ns();
         return a;
     }
 
@@ -157,12 +185,14 @@ public:
 class MessageEnvelope {
 public:
     std::string message_id;
+    uint64_t message_seq = 0;   // compact form of message_id, see message_ids.hpp
     int target = 0;
     std::string topic;
     MessageType type = MessageType::DATA_MESSAGE;
     std::vector<uint8_t> payload;
     bool async = false;
     int64_t timestamp = 0;
+    int64_t timestamp_us = 0;
     RoutingMode routing = RoutingMode::POINT_TO_POINT;
     QoSLevel qos = QoSLevel::AT_MOST_ONCE;
     std::map<std::string, std::string> metadata;
@@ -171,21 +201,24 @@ public:
     std::unique_ptr<Acknowledgment> ack;
 
     MessageEnvelope() {
-        timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
             std::chrono::system_clock::now().time_since_epoch()
         ).count();
-        message_id = generate_message_id();
+        timestamp = timestamp_us / 1000;
+        assign_new_id();
     }
 
     // Copy constructor required for deep copy of unique_ptr
     MessageEnvelope(const MessageEnvelope& other) 
         : message_id(other.message_id),
+          message_seq(other.message_seq),
           target(other.target),
           topic(other.topic),
           type(other.type),
           payload(other.payload),
           async(other.async),
           timestamp(other.timestamp),
+          timestamp_us(other.timestamp_us),
           routing(other.routing),
           qos(other.qos),
           metadata(other.metadata) {
@@ -199,12 +232,14 @@ public:
     MessageEnvelope& operator=(const MessageEnvelope& other) {
         if (this != &other) {
             message_id = other.message_id;
+            message_seq = other.message_seq;
             target = other.target;
             topic = other.topic;
             type = other.type;
             payload = other.payload;
             async = other.async;
             timestamp = other.timestamp;
+            timestamp_us = other.timestamp_us;
             routing = other.routing;
             qos = other.qos;
             metadata = other.metadata;
@@ -225,23 +260,100 @@ public:
     MessageEnvelope& operator=(MessageEnvelope&&) = default;
 
     static std::string generate_message_id() {
-        auto now = std::chrono::high_resolution_clock::now();
-        auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now).time_since_epoch().count();
-        std::stringstream ss;
-        ss << std::hex << nanos << std::hex << std::rand();
-        return ss.str();
+        return format_message_id(MessageIdGenerator::global().next());
+    }
+
+    // Give the envelope a fresh compact id (message_seq and its string form)
+    void assign_new_id(MessageIdGenerator& ids = MessageIdGenerator::global()) {
+        message_seq = ids.next();
+        message_id.resize(kMessageIdChars);
+        format_message_id(message_seq, &message_id[0]);
+    }
+
+    /**
+     * Flat view of this envelope's fields (see envelope_view.hpp), valid
+     * while the envelope is alive and unmodified. encode() on it serializes
+     * without building a ::messaging::MessageEnvelope first.
+     */
+    EnvelopeView view() const {
+        EnvelopeView v;
+        v.message_id = message_id;
+        v.message_seq = message_seq;
+        v.target = target;
+        v.topic = topic;
+        v.type = to_proto_message_type(type);
+        v.payload = std::string_view(reinterpret_cast<const char*>(payload.data()), payload.size());
+        v.async = async;
+        v.timestamp = timestamp;
+        v.timestamp_us = timestamp_us;
+        v.routing = to_proto_routing_mode(routing);
+        v.qos = to_proto_qos_level(qos);
+        for (const auto& pair : metadata) {
+            v.add_metadata(pair.first, pair.second);
+        }
+        if (ack) {
+            v.has_ack = true;
+            v.ack.original_message_id = ack->original_message_id;
+            v.ack.original_message_seq = ack->original_message_seq;
+            v.ack.received = ack->received;
+            v.ack.latency_ms = ack->latency_ms;
+            v.ack.receiver_id = ack->receiver_id;
+            v.ack.status = ack->status;
+            v.ack.status_code = ack->status_code;
+            v.ack.received_at_us = ack->received_at_us;
+            v.ack.processing_ns = ack->processing_ns;
+            v.ack.acked_at_us = ack->acked_at_us;
+            v.ack.decompress_ns = ack->decompress_ns;
+        }
+        return v;
+    }
+
+    // Copy a view's fields into an owning envelope; one copy of the payload
+    static MessageEnvelope from_view(const EnvelopeView& v) {
+        MessageEnvelope envelope;
+        envelope.message_id.assign(v.message_id.data(), v.message_id.size());
+        envelope.message_seq = v.message_seq;
+        envelope.target = v.target;
+        envelope.topic.assign(v.topic.data(), v.topic.size());
+        envelope.type = from_proto_message_type(v.type);
+        envelope.payload.assign(v.payload.begin(), v.payload.end());
+        envelope.async = v.async;
+        envelope.timestamp = v.timestamp;
+        envelope.timestamp_us = v.timestamp_us ? v.timestamp_us : v.timestamp * 1000;
+        envelope.routing = from_proto_routing_mode(v.routing);
+        envelope.qos = from_proto_qos_level(v.qos);
+        for (const auto& entry : v.metadata) {
+            envelope.metadata[std::string(entry.first)] = std::string(entry.second);
+        }
+        if (v.has_ack) {
+            envelope.ack = std::unique_ptr<Acknowledgment>(new Acknowledgment());
+            envelope.ack->original_message_id.assign(v.ack.original_message_id.data(), v.ack.original_message_id.size());
+            envelope.ack->original_message_seq = v.ack.original_message_seq;
+            envelope.ack->received = v.ack.received;
+            envelope.ack->latency_ms = v.ack.latency_ms;
+            envelope.ack->receiver_id.assign(v.ack.receiver_id.data(), v.ack.receiver_id.size());
+            envelope.ack->status.assign(v.ack.status.data(), v.ack.status.size());
+            envelope.ack->status_code = v.ack.status_code;
+            envelope.ack->received_at_us = v.ack.received_at_us;
+            envelope.ack->processing_ns = v.ack.processing_ns;
+            envelope.ack->acked_at_us = v.ack.acked_at_us;
+            envelope.ack->decompress_ns = v.ack.decompress_ns;
+        }
+        return envelope;
     }
 
     // Convert to protobuf
     ::messaging::MessageEnvelope to_proto() const {
         ::messaging::MessageEnvelope env;
         env.set_message_id(message_id);
+        env.set_message_seq(message_seq);
         env.set_target(target);
         env.set_topic(topic);
         env.set_type(to_proto_message_type(type));
         env.set_payload(payload.data(), payload.size());
         env.set_async(async);
         env.set_timestamp(timestamp);
+        env.set_timestamp_us(timestamp_us);
         env.set_routing(to_proto_routing_mode(routing));
         env.set_qos(to_proto_qos_level(qos));
         auto* proto_metadata = env.mutable_metadata();
@@ -251,12 +363,7 @@ public:
         
         // Populate ack field if present
         if (ack) {
-            auto* proto_ack = env.mutable_ack();
-            proto_ack->set_original_message_id(ack->original_message_id);
-            proto_ack->set_received(ack->received);
-            proto_ack->set_latency_ms(ack->latency_ms);
-            proto_ack->set_receiver_id(ack->receiver_id);
-            proto_ack->set_status(ack->status);
+            ack->fill_proto(env.mutable_ack());
         }
         
         return env;
@@ -266,12 +373,15 @@ public:
     static MessageEnvelope from_proto(const ::messaging::MessageEnvelope& env) {
         MessageEnvelope envelope;
         envelope.message_id = env.message_id();
+        envelope.message_seq = env.message_seq();
         envelope.target = env.target();
         envelope.topic = env.topic();
         envelope.type = from_proto_message_type(env.type());
         envelope.payload = std::vector<uint8_t>(env.payload().begin(), env.payload().end());
         envelope.async = env.async();
         envelope.timestamp = env.timestamp();
+        // Peers that only send ms timestamps leave timestamp_us unset
+        envelope.timestamp_us = env.timestamp_us() ? env.timestamp_us() : env.timestamp() * 1000;
         envelope.routing = from_proto_routing_mode(env.routing());
         envelope.qos = from_proto_qos_level(env.qos());
         for (const auto& kv : env.metadata()) {
@@ -280,31 +390,27 @@ public:
         
         // Parse ack field if present
         if (env.has_ack()) {
-            envelope.ack = std::unique_ptr<Acknowledgment>(new Acknowledgment());
-            envelope.ack->original_message_id = env.ack().original_message_id();
-            envelope.ack->received = env.ack().received();
-            envelope.ack->latency_ms = env.ack().latency_ms();
-            envelope.ack->receiver_id = env.ack().receiver_id();
-            envelope.ack->status = env.ack().status();
+            envelope.ack = std::unique_ptr<Acknowledgment>(new Acknowledgment(Acknowledgment::from_proto(env.ack())));
         }
         
         return envelope;
     }
 
-    // Serialize to binary (protobuf)
+    // Serialize to binary (protobuf wire format), written straight into the result
     std::vector<uint8_t> serialize() const {
-        ::messaging::MessageEnvelope env = to_proto();
-        std::string data;
-        env.SerializeToString(&data);
-        return std::vector<uint8_t>(data.begin(), data.end());
+        EnvelopeView v = view();
+        std::vector<uint8_t> data(v.encoded_size());
+        v.encode_to(data.data());
+        return data;
     }
 
-    // Deserialize from binary (protobuf)
+    // Deserialize from binary (protobuf wire format); an unparsable buffer gives a default envelope
     static MessageEnvelope deserialize(const std::vector<uint8_t>& data) {
-        ::messaging::MessageEnvelope env;
-        std::string str(data.begin(), data.end());
-        env.ParseFromString(str);
-        return from_proto(env);
+        EnvelopeView v;
+        if (!v.parse(data.data(), data.size())) {
+            return MessageEnvelope();
+        }
+        return from_view(v);
     }
 
     // JSON serialization (for debugging)
@@ -330,10 +436,10 @@ private:
 
 public:
     MessageBuilder() {
-        envelope_.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        envelope_.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
             std::chrono::system_clock::now().time_since_epoch()
         ).count();
-        envelope_.message_id = MessageEnvelope::generate_message_id();
+        envelope_.timestamp = envelope_.timestamp_us / 1000;
     }
 
     MessageBuilder& set_target(int target) {
@@ -391,30 +497,60 @@ struct MessagingStats {
     int64_t sent_count = 0;
     int64_t received_count = 0;
     int64_t failed_count = 0;
-    std::vector<double> message_timings;
-    int64_t start_time = 0;
-    int64_t end_time = 0;
+    int64_t duplicate_count = 0;   // receiver: EXACTLY_ONCE redeliveries dropped; sender: retransmissions
+    LatencyHistogram message_timings;
+    // Run boundaries on the monotonic clock (get_steady_ns)
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
 
     void record_send(bool success, double timing_ms = 0.0) {
         sent_count++;
         if (success) {
             received_count++;
             if (timing_ms > 0) {
-                message_timings.push_back(timing_ms);
+                message_timings.record_ms(timing_ms);
             }
         } else {
             failed_count++;
         }
     }
 
-    void set_duration(int64_t start, int64_t end) {
-        start_time = start;
-        end_time = end;
+    void record_send_ns(bool success, int64_t timing_ns) {
+        sent_count++;
+        if (success) {
+            received_count++;
+            message_timings.record_ns(timing_ns);
+        } else {
+            failed_count++;
+        }
+    }
+
+    void merge(const MessagingStats& other) {
+        sent_count += other.sent_count;
+        received_count += other.received_count;
+        failed_count += other.failed_count;
+        duplicate_count += other.duplicate_count;
+        message_timings.merge(other.message_timings);
+    }
+
+    // Fold in per-thread shards; call once the recording threads are done
+    void merge(const ShardedStats& shards) {
+        shards.for_each_shard([&](const StatsShard& shard) {
+            sent_count += shard.sent.load(std::memory_order_relaxed);
+            received_count += shard.acked.load(std::memory_order_relaxed);
+            failed_count += shard.failed.load(std::memory_order_relaxed);
+            message_timings.merge(shard.latencies);
+        });
+    }
+
+    void set_duration_ns(int64_t start, int64_t end) {
+        start_ns = start;
+        end_ns = end;
     }
 
     double get_duration_ms() const {
-        if (start_time && end_time) {
-            return static_cast<double>(end_time - start_time);
+        if (start_ns && end_ns) {
+            return (end_ns - start_ns) / 1e6;
         }
         return 0.0;
     }
@@ -428,16 +564,19 @@ struct MessagingStats {
         stats["total_failed"] = static_cast<double>(failed_count);
         stats["duration_ms"] = duration;
         stats["messages_per_sec"] = (duration > 0) ? (received_count / duration * 1000.0) : 0;
+        if (duplicate_count > 0) {
+            stats["total_duplicates"] = static_cast<double>(duplicate_count);
+        }
 
         if (!message_timings.empty()) {
-            double min_t = *std::min_element(message_timings.begin(), message_timings.end());
-            double max_t = *std::max_element(message_timings.begin(), message_timings.end());
-            double sum = std::accumulate(message_timings.begin(), message_timings.end(), 0.0);
-            double mean = sum / message_timings.size();
-            
-            stats["min_ms"] = min_t;
-            stats["max_ms"] = max_t;
-            stats["mean_ms"] = mean;
+            stats["min_ms"] = message_timings.min_ns() / 1e6;
+            stats["max_ms"] = message_timings.max_ns() / 1e6;
+            stats["mean_ms"] = message_timings.mean_ns() / 1e6;
+            stats["p50_ms"] = message_timings.percentile_ms(50);
+            stats["p90_ms"] = message_timings.percentile_ms(90);
+            stats["p99_ms"] = message_timings.percentile_ms(99);
+            stats["p99_9_ms"] = message_timings.percentile_ms(99.9);
+            stats["p99_99_ms"] = message_timings.percentile_ms(99.99);
         }
 
         return stats;
@@ -455,6 +594,19 @@ inline int64_t get_timestamp_ms() {
     ).count();
 }
 
+inline int64_t get_timestamp_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Monotonic clock for latencies; not comparable across processes
+inline int64_t get_steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
 inline void sleep_ms(int ms) {
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
@@ -0,0 +1,226 @@
+#ifndef PARTITIONED_SENDER_HPP
+#define PARTITIONED_SENDER_HPP
+
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <exception>
+#include <chrono>
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "async_send_engine.hpp"
+#include "qos_options.hpp"
+#include "cpu_affinity.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * How many threads a synchronous sender spreads its targets over.
+ *
+ * partitions - sender threads; each owns a disjoint set of targets and their
+ *              connections. 1 sends everything from the calling thread.
+ */
+struct PartitionOptions {
+    int partitions = 1;
+
+    bool enabled() const { return partitions > 1; }
+
+    // Parse --partitions N from the command line
+    static PartitionOptions from_args(int argc, char* argv[]) {
+        PartitionOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--partitions") == 0 && i + 1 < argc) {
+                options.partitions = std::max(1, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+
+    /**
+     * Warn that mode, which sends from a single thread, ignores --partitions.
+     * @return true if --partitions was given
+     */
+    bool warn_ignored_by(const char* mode) const {
+        if (!enabled()) {
+            return false;
+        }
+        std::cerr << " [!] " << mode << " sends from one thread; ignoring --partitions " << partitions << std::endl;
+        return true;
+    }
+};
+
+/**
+ * Synchronous request/reply sends, partitioned by target across threads.
+ *
+ * Targets are dealt round-robin to min(partitions, targets) threads. Each
+ * thread builds its own connection state with make_state (on that thread, so
+ * thread-affine clients such as ZeroMQ sockets stay with their owner), then
+ * sends its messages one at a time in corpus order, waiting for each reply.
+ * Every target therefore still sees its messages strictly in order, one in
+ * flight, exactly as with a single thread; only independent targets overlap.
+ * Results are delivered to on_result one at a time, like AsyncSendEngine, so
+ * callers can record into non-thread-safe stats. With --qos at_least_once or
+ * exactly_once, a failed exchange is resent at once, up to max_retransmits
+ * times, before the next message; its latency runs from the first send.
+ *
+ *   PartitionedSender sender(PartitionOptions::from_args(argc, argv), QoSOptions::from_args(argc, argv));
+ *   sender.run(corpus.size(),
+ *       [&](size_t i) { return corpus.target(i); },
+ *       [&](size_t partition) { return std::make_unique<Connections>(...); },
+ *       [&](std::unique_ptr<Connections>& conn, size_t i) { return send_one(*conn, i); },
+ *       on_result);
+ *   stats.add_metadata("partitioning", sender.report());
+ *
+ * With one partition everything runs on the calling thread.
+ */
+class PartitionedSender {
+public:
+    using ResultFn = std::function<void(const TaskResult& result)>;
+
+    explicit PartitionedSender(const PartitionOptions& options = PartitionOptions(),
+                               const QoSOptions& qos = QoSOptions())
+        : options_(options), qos_(qos) {}
+
+    const PartitionOptions& options() const { return options_; }
+
+    // --qos resends of failed exchanges during the last run(), over all partitions
+    int64_t retransmits() const {
+        int64_t total = 0;
+        for (const Partition& partition : partitions_) {
+            total += partition.retransmits;
+        }
+        return total;
+    }
+
+    /**
+     * Send messages [0, count): make_state(partition) returns a partition's
+     * connection state, send(state, index) performs one blocking exchange.
+     * Blocks until every partition has finished.
+     */
+    template <typename TargetOf, typename MakeState, typename Send>
+    void run(size_t count, TargetOf target_of, MakeState make_state, Send send, const ResultFn& on_result) {
+        assign(count, target_of);
+        auto drive = [&](Partition& partition) {
+            auto state = make_state(partition.id);
+            partition.start_ns = now_ns();
+            auto exchange = [&](size_t index) {
+                TaskResult result;
+                try {
+                    result = send(state, index);
+                } catch (const std::exception& e) {
+                    result.success = false;
+                    result.error = e.what();
+                }
+                return result;
+            };
+            for (size_t index : partition.indices) {
+                int64_t first_ns = now_ns();
+                int64_t attempt_start_ns = first_ns;
+                TaskResult result = exchange(index);
+                for (int n = 0; !result.success && n < qos_.retransmits(); ++n) {
+                    partition.retransmits++;
+                    attempt_start_ns = now_ns();
+                    result = exchange(index);
+                }
+                // Latency of the message, not of the attempt that completed it
+                result.duration_ns += attempt_start_ns - first_ns;
+                (result.success ? partition.acked : partition.failed)++;
+                std::lock_guard<std::mutex> lock(result_mu_);
+                on_result(result);
+            }
+            partition.end_ns = now_ns();
+        };
+
+        if (partitions_.size() == 1) {
+            drive(partitions_.front());
+            return;
+        }
+        std::vector<std::thread> threads;
+        threads.reserve(partitions_.size());
+        for (Partition& partition : partitions_) {
+            threads.emplace_back([&]() {
+                CpuAffinity::global().pin_this_thread();
+                drive(partition);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    // Assignment and per-partition results of the last run()
+    nlohmann::json report() const {
+        nlohmann::json partitions = nlohmann::json::array();
+        for (const Partition& partition : partitions_) {
+            double seconds = (partition.end_ns - partition.start_ns) / 1e9;
+            partitions.push_back({
+                {"targets", partition.targets},
+                {"messages", partition.indices.size()},
+                {"acked", partition.acked},
+                {"failed", partition.failed},
+                {"duration_ms", (partition.end_ns - partition.start_ns) / 1e6},
+                {"throughput_msg_per_sec", seconds > 0 ? partition.acked / seconds : 0.0}
+            });
+        }
+        return {
+            {"requested", options_.partitions},
+            {"threads", partitions_.size()},
+            {"per_partition", partitions}
+        };
+    }
+
+private:
+    struct Partition {
+        size_t id = 0;
+        std::vector<int> targets;
+        std::vector<size_t> indices;   // ascending, so each target's messages keep corpus order
+        int64_t acked = 0;
+        int64_t failed = 0;
+        int64_t retransmits = 0;
+        int64_t start_ns = 0;
+        int64_t end_ns = 0;
+    };
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    template <typename TargetOf>
+    void assign(size_t count, TargetOf target_of) {
+        std::map<int, size_t> owner;
+        for (size_t i = 0; i < count; ++i) {
+            owner.emplace(target_of(i), 0);
+        }
+        size_t threads = std::max<size_t>(1, std::min(static_cast<size_t>(options_.partitions), owner.size()));
+        partitions_.assign(threads, Partition());
+        size_t next = 0;
+        for (auto& [target, partition] : owner) {
+            partition = next++ % threads;
+            partitions_[partition].targets.push_back(target);
+        }
+        for (size_t p = 0; p < threads; ++p) {
+            partitions_[p].id = p;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            partitions_[owner[target_of(i)]].indices.push_back(i);
+        }
+    }
+
+    PartitionOptions options_;
+    QoSOptions qos_;
+    std::vector<Partition> partitions_;
+    std::mutex result_mu_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // PARTITIONED_SENDER_HPP
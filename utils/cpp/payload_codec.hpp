@@ -0,0 +1,457 @@
+#ifndef PAYLOAD_CODEC_HPP
+#define PAYLOAD_CODEC_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "json.hpp"
+#include "message_helpers.hpp"
+#include "latency_histogram.hpp"
+
+// Each codec is compiled in when the build finds its library and defines the
+// macro (see the redis and rabbitmq CMakeLists.txt); without it, asking for
+// the codec warns and sends payloads uncompressed
+#ifdef MESSAGING_LZ4
+#include <lz4.h>
+#endif
+#ifdef MESSAGING_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+namespace messaging {
+namespace utils {
+
+enum class PayloadCodecKind {
+    None,
+    Lz4,    // LZ4 block format: cheapest to run, no entropy coding
+    Zstd,   // zstd frames, optionally with a dictionary trained on the corpus
+};
+
+// Metadata a compressed envelope carries: the codec, and the payload's size before compression
+inline constexpr std::string_view kContentEncodingKey = "content-encoding";
+inline constexpr std::string_view kContentLengthKey = "content-length";
+
+inline const char* codec_name(PayloadCodecKind codec) {
+    switch (codec) {
+        case PayloadCodecKind::Lz4: return "lz4";
+        case PayloadCodecKind::Zstd: return "zstd";
+        default: return "none";
+    }
+}
+
+// Whether this build can compress and decompress with codec
+inline bool codec_available(PayloadCodecKind codec) {
+    switch (codec) {
+#ifdef MESSAGING_LZ4
+        case PayloadCodecKind::Lz4: return true;
+#endif
+#ifdef MESSAGING_ZSTD
+        case PayloadCodecKind::Zstd: return true;
+#endif
+        case PayloadCodecKind::None: return true;
+        default: return false;
+    }
+}
+
+/**
+ * Envelope-level payload compression, for the bandwidth-bound end of the
+ * payload sweep:
+ *
+ * codec      - --compress lz4|zstd; none by default
+ * threshold  - --compress-threshold N: payloads smaller than N bytes are sent
+ *              as they are, since below a few hundred bytes the metadata costs
+ *              more than compression saves
+ * level      - --compress-level N: the zstd level, or LZ4's acceleration;
+ *              0 keeps the codec's default
+ * dict_path  - --compress-dict PATH (zstd): the sender trains a dictionary on
+ *              the corpus before the clock and writes it to PATH; receivers
+ *              given the same PATH load it on the first frame that needs it.
+ *              Worth it for small messages, batched ones especially, which
+ *              have too little history of their own to compress well
+ * dict_bytes - --compress-dict-bytes N: the trained dictionary's size
+ */
+struct CompressionOptions {
+    PayloadCodecKind codec = PayloadCodecKind::None;
+    size_t threshold = 1024;
+    int level = 0;
+    std::string dict_path;
+    size_t dict_bytes = 16 * 1024;
+
+    bool enabled() const { return codec != PayloadCodecKind::None; }
+
+    // Parse the --compress* flags; a codec this build lacks leaves compression off
+    static CompressionOptions from_args(int argc, char* argv[]) {
+        CompressionOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--compress") == 0 && i + 1 < argc) {
+                const char* name = argv[++i];
+                if (std::strcmp(name, "lz4") == 0) {
+                    options.codec = PayloadCodecKind::Lz4;
+                } else if (std::strcmp(name, "zstd") == 0) {
+                    options.codec = PayloadCodecKind::Zstd;
+                } else if (std::strcmp(name, "none") != 0) {
+                    fprintf(stderr, " [!] Ignoring unknown --compress '%s'\n", name);
+                }
+            } else if (std::strcmp(argv[i], "--compress-threshold") == 0 && i + 1 < argc) {
+                options.threshold = std::strtoull(argv[++i], nullptr, 10);
+            } else if (std::strcmp(argv[i], "--compress-level") == 0 && i + 1 < argc) {
+                options.level = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--compress-dict") == 0 && i + 1 < argc) {
+                options.dict_path = argv[++i];
+            } else if (std::strcmp(argv[i], "--compress-dict-bytes") == 0 && i + 1 < argc) {
+                options.dict_bytes = std::max<size_t>(1024, std::strtoull(argv[++i], nullptr, 10));
+            }
+        }
+        if (!codec_available(options.codec)) {
+            fprintf(stderr, " [!] Built without %s; sending payloads uncompressed\n", codec_name(options.codec));
+            options.codec = PayloadCodecKind::None;
+        }
+        if (!options.dict_path.empty() && options.codec == PayloadCodecKind::Lz4) {
+            fprintf(stderr, " [!] --compress-dict needs zstd; compressing with lz4 without one\n");
+            options.dict_path.clear();
+        }
+        return options;
+    }
+};
+
+#ifdef MESSAGING_ZSTD
+// One compression and one decompression context per thread, shared by every codec instance
+struct ZstdContexts {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+
+    static ZstdContexts& local() {
+        thread_local ZstdContexts contexts;
+        return contexts;
+    }
+};
+#endif
+
+/**
+ * The sender's side: compresses payloads at or above the threshold into a
+ * caller buffer and keeps the run's counts, byte totals and compression
+ * times for report(). A payload that does not shrink is sent as it was.
+ * compress() may be called from any number of threads at once.
+ */
+class PayloadCompressor {
+public:
+    explicit PayloadCompressor(const CompressionOptions& options) : options_(options) {}
+
+    ~PayloadCompressor() {
+#ifdef MESSAGING_ZSTD
+        ZSTD_freeCDict(cdict_);
+#endif
+    }
+
+    PayloadCompressor(const PayloadCompressor&) = delete;
+    PayloadCompressor& operator=(const PayloadCompressor&) = delete;
+
+    const CompressionOptions& options() const { return options_; }
+    const char* codec_name() const { return utils::codec_name(options_.codec); }
+
+    /**
+     * @brief Train a zstd dictionary on sample payloads and write it to dict_path.
+     *
+     * samples holds the payloads back to back, sizes their lengths. Call
+     * before the clock starts. A failed training or write warns and leaves
+     * the codec dictionary-less, so receivers never wait for a missing file.
+     */
+    void train(const std::string& samples, const std::vector<size_t>& sizes) {
+#ifdef MESSAGING_ZSTD
+        if (options_.codec != PayloadCodecKind::Zstd || options_.dict_path.empty() || sizes.empty()) {
+            return;
+        }
+        std::string dictionary(options_.dict_bytes, '\0');
+        size_t size = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(), samples.data(), sizes.data(),
+                                            static_cast<unsigned>(sizes.size()));
+        if (ZDICT_isError(size)) {
+            fprintf(stderr, " [!] Compression dictionary training failed (%s); compressing without one\n",
+                    ZDICT_getErrorName(size));
+            return;
+        }
+        dictionary.resize(size);
+
+        // Receivers may look for the file as soon as messages arrive, so it appears complete or not at all
+        std::string partial = options_.dict_path + ".tmp";
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        out.write(dictionary.data(), static_cast<std::streamsize>(dictionary.size()));
+        out.close();
+        if (!out || std::rename(partial.c_str(), options_.dict_path.c_str()) != 0) {
+            fprintf(stderr, " [!] Cannot write compression dictionary %s; compressing without one\n",
+                    options_.dict_path.c_str());
+            return;
+        }
+        cdict_ = ZSTD_createCDict(dictionary.data(), dictionary.size(), zstd_level());
+        dict_id_ = ZDICT_getDictID(dictionary.data(), dictionary.size());
+        dict_size_ = dictionary.size();
+#else
+        (void)samples;
+        (void)sizes;
+#endif
+    }
+
+    // False, and counted as below the threshold, for payloads not worth compressing
+    bool wants(size_t raw_size) {
+        if (raw_size < options_.threshold) {
+            below_threshold_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compress raw into out, which keeps its capacity across calls.
+     * @return false if the payload did not shrink; send raw instead
+     */
+    bool compress(std::string_view raw, std::string& out) {
+        long long start_ns = message_helpers::get_steady_time_ns();
+        size_t packed = encode(raw, out);
+        long long elapsed_ns = message_helpers::get_steady_time_ns() - start_ns;
+        {
+            std::lock_guard<std::mutex> lock(times_mutex_);
+            times_.record_ns(elapsed_ns);
+        }
+        if (packed == 0 || packed >= raw.size()) {
+            incompressible_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        out.resize(packed);
+        compressed_.fetch_add(1, std::memory_order_relaxed);
+        raw_bytes_.fetch_add(static_cast<int64_t>(raw.size()), std::memory_order_relaxed);
+        packed_bytes_.fetch_add(static_cast<int64_t>(packed), std::memory_order_relaxed);
+        return true;
+    }
+
+    // For the run report; read once the senders have finished
+    nlohmann::json report() const {
+        int64_t raw = raw_bytes_.load(std::memory_order_relaxed);
+        int64_t packed = packed_bytes_.load(std::memory_order_relaxed);
+        nlohmann::json out = {
+            {"codec", codec_name()},
+            {"level", options_.level},
+            {"threshold_bytes", options_.threshold},
+            {"compressed", compressed_.load(std::memory_order_relaxed)},
+            {"below_threshold", below_threshold_.load(std::memory_order_relaxed)},
+            {"incompressible", incompressible_.load(std::memory_order_relaxed)},
+            {"raw_bytes", raw},
+            {"compressed_bytes", packed},
+            {"ratio", packed > 0 ? static_cast<double>(raw) / packed : 0.0},
+        };
+        std::lock_guard<std::mutex> lock(times_mutex_);
+        out["compress"] = {
+            {"count", times_.count()},
+            {"mean_ms", times_.mean_ns() / 1e6},
+            {"p50_ms", times_.percentile_ms(50)},
+            {"p99_ms", times_.percentile_ms(99)},
+            {"max_ms", times_.max_ns() / 1e6},
+        };
+        if (dict_id_ != 0) {
+            out["dictionary"] = {{"id", dict_id_}, {"bytes", dict_size_}, {"path", options_.dict_path}};
+        }
+        return out;
+    }
+
+private:
+    // Compressed size, or 0 on failure
+    size_t encode(std::string_view raw, std::string& out) {
+        switch (options_.codec) {
+#ifdef MESSAGING_LZ4
+            case PayloadCodecKind::Lz4: {
+                out.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(raw.size()))));
+                int n = LZ4_compress_fast(raw.data(), &out[0], static_cast<int>(raw.size()),
+                                          static_cast<int>(out.size()), options_.level > 0 ? options_.level : 1);
+                return n > 0 ? static_cast<size_t>(n) : 0;
+            }
+#endif
+#ifdef MESSAGING_ZSTD
+            case PayloadCodecKind::Zstd: {
+                out.resize(ZSTD_compressBound(raw.size()));
+                ZSTD_CCtx* cctx = ZstdContexts::local().cctx;
+                size_t n = cdict_
+                    ? ZSTD_compress_usingCDict(cctx, &out[0], out.size(), raw.data(), raw.size(), cdict_)
+                    : ZSTD_compressCCtx(cctx, &out[0], out.size(), raw.data(), raw.size(), zstd_level());
+                return ZSTD_isError(n) ? 0 : n;
+            }
+#endif
+            default:
+                return 0;
+        }
+    }
+
+#ifdef MESSAGING_ZSTD
+    int zstd_level() const { return options_.level != 0 ? options_.level : ZSTD_CLEVEL_DEFAULT; }
+    ZSTD_CDict* cdict_ = nullptr;
+#endif
+    CompressionOptions options_;
+    unsigned dict_id_ = 0;
+    size_t dict_size_ = 0;
+
+    std::atomic<int64_t> compressed_{0};
+    std::atomic<int64_t> below_threshold_{0};
+    std::atomic<int64_t> incompressible_{0};
+    std::atomic<int64_t> raw_bytes_{0};
+    std::atomic<int64_t> packed_bytes_{0};
+    mutable std::mutex times_mutex_;
+    LatencyHistogram times_;
+};
+
+/**
+ * The receiver's side, installed as message_helpers' payload decoder by
+ * configure_compression(). decode() leaves envelopes without a
+ * content-encoding alone; others get their raw payload back and lose the two
+ * compression metadata entries, so the rest of the receiver never sees the
+ * difference. Dictionaries are loaded from dict_path by id, on first use.
+ */
+class PayloadDecompressor {
+public:
+    static PayloadDecompressor& global() {
+        static PayloadDecompressor decompressor;
+        return decompressor;
+    }
+
+    ~PayloadDecompressor() {
+#ifdef MESSAGING_ZSTD
+        for (auto& entry : ddicts_) {
+            ZSTD_freeDDict(entry.second);
+        }
+#endif
+    }
+
+    void set_dictionary_path(const std::string& path) { dict_path_ = path; }
+
+    // A content-length above this is taken as corrupt rather than allocated
+    static constexpr size_t kMaxContentLength = size_t(256) << 20;
+
+    bool decode(::messaging::MessageEnvelope& envelope) {
+        // Keys outlive the call, so lookups don't build a std::string per message
+        static const std::string encoding_key(kContentEncodingKey);
+        static const std::string length_key(kContentLengthKey);
+        const auto& metadata = envelope.metadata();
+        auto encoding = metadata.find(encoding_key);
+        if (encoding == metadata.end()) {
+            return true;
+        }
+        TRACE_SCOPE("decompress");
+        long long start_ns = message_helpers::get_steady_time_ns();
+        auto length = metadata.find(length_key);
+        if (length == metadata.end()) {
+            return false;
+        }
+        size_t raw_size = std::strtoull(length->second.c_str(), nullptr, 10);
+        if (raw_size > kMaxContentLength) {
+            return false;
+        }
+        thread_local std::string raw;
+        raw.resize(raw_size);
+        if (!decompress(encoding->second, envelope.payload(), raw)) {
+            return false;
+        }
+        envelope.mutable_payload()->swap(raw);
+        auto* mutable_metadata = envelope.mutable_metadata();
+        mutable_metadata->erase(encoding_key);
+        mutable_metadata->erase(length_key);
+        message_helpers::pending_decompress_ns() += message_helpers::get_steady_time_ns() - start_ns;
+        return true;
+    }
+
+private:
+    // Fills raw, already sized to the expected length; false on any mismatch
+    bool decompress(const std::string& codec, const std::string& packed, std::string& raw) {
+#ifdef MESSAGING_LZ4
+        if (codec == "lz4") {
+            int n = LZ4_decompress_safe(packed.data(), &raw[0], static_cast<int>(packed.size()),
+                                        static_cast<int>(raw.size()));
+            return n >= 0 && static_cast<size_t>(n) == raw.size();
+        }
+#endif
+#ifdef MESSAGING_ZSTD
+        if (codec == "zstd") {
+            ZSTD_DCtx* dctx = ZstdContexts::local().dctx;
+            unsigned dict_id = ZSTD_getDictID_fromFrame(packed.data(), packed.size());
+            size_t n;
+            if (dict_id != 0) {
+                ZSTD_DDict* ddict = dictionary(dict_id);
+                if (!ddict) {
+                    return false;
+                }
+                n = ZSTD_decompress_usingDDict(dctx, &raw[0], raw.size(), packed.data(), packed.size(), ddict);
+            } else {
+                n = ZSTD_decompressDCtx(dctx, &raw[0], raw.size(), packed.data(), packed.size());
+            }
+            return !ZSTD_isError(n) && n == raw.size();
+        }
+#endif
+        (void)packed;
+        (void)raw;
+        fprintf(stderr, " [!] Cannot decode content-encoding '%s' in this build\n", codec.c_str());
+        return false;
+    }
+
+#ifdef MESSAGING_ZSTD
+    // The dictionary with dict_id, loaded from dict_path the first time a frame asks for it
+    ZSTD_DDict* dictionary(unsigned dict_id) {
+        {
+            std::shared_lock<std::shared_mutex> lock(ddicts_mutex_);
+            auto it = ddicts_.find(dict_id);
+            if (it != ddicts_.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(ddicts_mutex_);
+        auto it = ddicts_.find(dict_id);
+        if (it != ddicts_.end()) {
+            return it->second;
+        }
+        std::ifstream in(dict_path_, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (dict_path_.empty() || bytes.empty() || ZDICT_getDictID(bytes.data(), bytes.size()) != dict_id) {
+            fprintf(stderr, " [!] No compression dictionary %u at '%s' (--compress-dict)\n", dict_id,
+                    dict_path_.c_str());
+            return nullptr;
+        }
+        ZSTD_DDict* ddict = ZSTD_createDDict(bytes.data(), bytes.size());
+        ddicts_.emplace(dict_id, ddict);
+        return ddict;
+    }
+
+    std::shared_mutex ddicts_mutex_;
+    std::map<unsigned, ZSTD_DDict*> ddicts_;
+#endif
+    std::string dict_path_;
+};
+
+/**
+ * Let this program decode compressed payloads: every later
+ * message_helpers::parse_envelope() (and UnifiedReceiver) decompresses them,
+ * and the ACKs it builds report the time as decompress_ns. Reads
+ * --compress-dict for receivers of dictionary-compressed frames.
+ */
+inline void configure_compression(int argc, char* argv[]) {
+    PayloadDecompressor::global().set_dictionary_path(CompressionOptions::from_args(argc, argv).dict_path);
+    message_helpers::payload_decoder() = [](::messaging::MessageEnvelope& envelope) {
+        return PayloadDecompressor::global().decode(envelope);
+    };
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // PAYLOAD_CODEC_HPP
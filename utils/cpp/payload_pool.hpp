@@ -0,0 +1,321 @@
+#ifndef PAYLOAD_POOL_HPP
+#define PAYLOAD_POOL_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace messaging {
+namespace utils {
+
+enum class PayloadDistribution {
+    None,        // send the corpus items as they are
+    Fixed,       // every message gets size bytes
+    Lognormal,   // median size, shape sigma: the long tail of real traffic
+    Bimodal,     // size bytes, or large bytes for large_fraction of messages
+};
+
+/**
+ * Synthetic payload sizes for the payload-size dimension of the benchmark,
+ * given on the command line as --payload SPEC:
+ *
+ *   fixed:SIZE
+ *   lognormal:MEDIAN[:SIGMA]              (SIGMA defaults to 1.0)
+ *   bimodal:SMALL:LARGE[:LARGE_FRACTION]  (LARGE_FRACTION defaults to 0.1)
+ *
+ * Sizes take an optional k or m suffix (KiB, MiB). --payload-seed fixes the
+ * size sequence, so every broker in a sweep is sent the same messages.
+ */
+struct PayloadSpec {
+    PayloadDistribution distribution = PayloadDistribution::None;
+    size_t size = 0;
+    size_t large = 0;
+    double sigma = 1.0;
+    double large_fraction = 0.1;
+    uint64_t seed = 42;
+
+    bool enabled() const { return distribution != PayloadDistribution::None; }
+
+    // The spec as given on the command line, for the report
+    std::string describe() const {
+        switch (distribution) {
+            case PayloadDistribution::Fixed:
+                return "fixed:" + std::to_string(size);
+            case PayloadDistribution::Lognormal:
+                return "lognormal:" + std::to_string(size) + ":" + format_double(sigma);
+            case PayloadDistribution::Bimodal:
+                return "bimodal:" + std::to_string(size) + ":" + std::to_string(large) + ":" +
+                       format_double(large_fraction);
+            default:
+                return "none";
+        }
+    }
+
+    // false (spec unchanged) if text is not a valid spec
+    static bool parse(const char* text, PayloadSpec& spec) {
+        std::vector<std::string> parts;
+        std::string current;
+        for (const char* p = text; ; ++p) {
+            if (*p == ':' || *p == '\0') {
+                parts.push_back(current);
+                current.clear();
+                if (*p == '\0') {
+                    break;
+                }
+            } else {
+                current.push_back(*p);
+            }
+        }
+
+        PayloadSpec parsed = spec;
+        const std::string& kind = parts[0];
+        if (kind == "fixed" && parts.size() == 2) {
+            parsed.distribution = PayloadDistribution::Fixed;
+        } else if (kind == "lognormal" && (parts.size() == 2 || parts.size() == 3)) {
+            parsed.distribution = PayloadDistribution::Lognormal;
+            if (parts.size() == 3 && !parse_double(parts[2], parsed.sigma)) {
+                return false;
+            }
+        } else if (kind == "bimodal" && (parts.size() == 3 || parts.size() == 4)) {
+            parsed.distribution = PayloadDistribution::Bimodal;
+            if (!parse_size(parts[2], parsed.large) ||
+                (parts.size() == 4 && !parse_double(parts[3], parsed.large_fraction))) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        if (!parse_size(parts[1], parsed.size)) {
+            return false;
+        }
+        spec = parsed;
+        return true;
+    }
+
+    // Parse --payload SPEC and --payload-seed N; an invalid spec leaves payloads off
+    static PayloadSpec from_args(int argc, char* argv[]) {
+        PayloadSpec spec;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--payload") == 0 && i + 1 < argc) {
+                if (!parse(argv[++i], spec)) {
+                    fprintf(stderr, " [!] Ignoring invalid --payload '%s'\n", argv[i]);
+                }
+            } else if (std::strcmp(argv[i], "--payload-seed") == 0 && i + 1 < argc) {
+                spec.seed = std::strtoull(argv[++i], nullptr, 10);
+            }
+        }
+        return spec;
+    }
+
+private:
+    // "4096", "4k", "1m"
+    static bool parse_size(const std::string& text, size_t& out) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+        if (end == text.c_str()) {
+            return false;
+        }
+        if (*end == 'k' || *end == 'K') {
+            value <<= 10;
+            ++end;
+        } else if (*end == 'm' || *end == 'M') {
+            value <<= 20;
+            ++end;
+        }
+        if (*end != '\0') {
+            return false;
+        }
+        out = static_cast<size_t>(value);
+        return true;
+    }
+
+    static bool parse_double(const std::string& text, double& out) {
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0') {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    static std::string format_double(double value) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%g", value);
+        return buf;
+    }
+};
+
+/**
+ * Payload bytes for synthetic messages, allocated once before the clock starts.
+ *
+ * Every message's size is drawn up front; its bytes are a slice of one shared
+ * filler buffer, starting at an offset that varies by message, so sending a
+ * 1 MB message costs one copy and nothing is generated or allocated per send.
+ * The filler is printable ASCII, which keeps DataMessage's string fields valid
+ * UTF-8 for every parser. Read-only after construction and safe to share.
+ */
+class PayloadPool {
+public:
+    // Lognormal tails are clamped to this
+    static constexpr size_t kMaxPayloadBytes = size_t(64) << 20;
+    static constexpr size_t kOffsetSpread = 4096;
+
+    PayloadPool() = default;
+
+    // Sizes for messages [0, count); later indices reuse them cyclically
+    PayloadPool(const PayloadSpec& spec, size_t count) : spec_(spec) {
+        if (!spec.enabled() || count == 0) {
+            return;
+        }
+        std::mt19937_64 rng(spec.seed);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+        sizes_.reserve(count);
+        size_t largest = 0;
+        double total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            double size = static_cast<double>(spec.size);
+            if (spec.distribution == PayloadDistribution::Lognormal) {
+                size = spec.size * std::exp(spec.sigma * normal(rng));
+            } else if (spec.distribution == PayloadDistribution::Bimodal && unit(rng) < spec.large_fraction) {
+                size = static_cast<double>(spec.large);
+            }
+            auto bytes = static_cast<uint32_t>(std::clamp<double>(std::llround(size), 1.0,
+                                                                  static_cast<double>(kMaxPayloadBytes)));
+            sizes_.push_back(bytes);
+            largest = std::max<size_t>(largest, bytes);
+            total += bytes;
+        }
+        mean_size_ = total / count;
+
+        // Base-32 digits in a pseudo-random order; incompressible enough for the brokers that compress
+        static constexpr char kDigits[] = "0123456789abcdefghjkmnpqrstvwxyz";
+        filler_.resize(largest + kOffsetSpread);
+        uint64_t x = spec.seed | 1;
+        for (char& c : filler_) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            c = kDigits[x & 31];
+        }
+    }
+
+    bool enabled() const { return !sizes_.empty(); }
+    const PayloadSpec& spec() const { return spec_; }
+    double mean_size() const { return mean_size_; }
+
+    size_t size(size_t i) const { return sizes_[i % sizes_.size()]; }
+
+    std::string_view bytes(size_t i) const {
+        size_t offset = (i * 2654435761u) % kOffsetSpread;
+        return std::string_view(filler_.data() + offset, size(i));
+    }
+
+    // Encoded size of message i's filler as a DataMessage.message_value field
+    size_t value_field_size(size_t i) const {
+        size_t n = size(i);
+        return 1 + varint_size(n) + n;
+    }
+
+    // Append message i's filler to serialized DataMessage bytes as one more message_value
+    void append_value(std::string& data_message, size_t i) const {
+        std::string_view filler = bytes(i);
+        data_message.push_back(kMessageValueTag);
+        for (uint64_t n = filler.size(); ; n >>= 7) {
+            if (n < 0x80) {
+                data_message.push_back(static_cast<char>(n));
+                break;
+            }
+            data_message.push_back(static_cast<char>((n & 0x7F) | 0x80));
+        }
+        data_message.append(filler);
+    }
+
+private:
+    static constexpr char kMessageValueTag = (2 << 3) | 2;
+
+    static size_t varint_size(uint64_t value) {
+        size_t n = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            n++;
+        }
+        return n;
+    }
+
+    PayloadSpec spec_;
+    std::vector<uint32_t> sizes_;
+    std::string filler_;
+    double mean_size_ = 0;
+
+    template <typename Envelope>
+    friend class EnvelopePayloads;
+};
+
+/**
+ * Synthetic payloads for senders that keep protobuf MessageEnvelopes rather
+ * than an EncodedCorpus. apply(i) restores envelope i's serialized DataMessage
+ * to its original length and appends the filler, so each send copies the
+ * filler once and the envelopes never hold more than one payload's worth.
+ * Distinct indices may be applied from different threads.
+ */
+template <typename Envelope>
+class EnvelopePayloads {
+public:
+    EnvelopePayloads(const PayloadSpec& spec, std::vector<Envelope>& envelopes)
+        : pool_(spec, envelopes.size()), envelopes_(envelopes) {
+        base_sizes_.reserve(envelopes.size());
+        for (const auto& envelope : envelopes) {
+            base_sizes_.push_back(envelope.payload().size());
+        }
+    }
+
+    void apply(size_t i) {
+        if (pool_.enabled()) {
+            std::string* payload = envelopes_[i].mutable_payload();
+            payload->resize(base_sizes_[i]);
+            pool_.append_value(*payload, i);
+        }
+    }
+
+    const PayloadPool& pool() const { return pool_; }
+
+    // Mean serialized envelope size with payloads applied; call before the first apply()
+    double mean_wire_bytes() const {
+        if (envelopes_.empty()) {
+            return 0.0;
+        }
+        double total = 0;
+        for (size_t i = 0; i < envelopes_.size(); ++i) {
+            total += static_cast<double>(envelopes_[i].ByteSizeLong());
+            if (pool_.enabled()) {
+                size_t base = base_sizes_[i];
+                size_t grown = base + pool_.value_field_size(i);
+                // An empty bytes field is not serialized, so it gains its tag as well
+                total += static_cast<double>(grown + PayloadPool::varint_size(grown) + (base == 0 ? 1 : 0)) -
+                         static_cast<double>(base == 0 ? 0 : base + PayloadPool::varint_size(base));
+            }
+        }
+        return total / envelopes_.size();
+    }
+
+private:
+    PayloadPool pool_;
+    std::vector<Envelope>& envelopes_;
+    std::vector<size_t> base_sizes_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // PAYLOAD_POOL_HPP
@@ -0,0 +1,158 @@
+#ifndef PENDING_REPLIES_HPP
+#define PENDING_REPLIES_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <functional>
+#include <chrono>
+#include "message_helpers.hpp"
+#include "async_send_engine.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Requests sent and waiting for a reply, with their timeouts and completions.
+ *
+ * The transport-specific side (a reply subscription, listener or reader
+ * thread) calls complete() or take() as replies arrive, on any thread. poll()
+ * fails requests past their timeout and hands every completion (ACKs,
+ * failures and timeouts) back on the caller's thread, so results can be
+ * recorded without locking. Every request shares one timeout, so deadlines
+ * are kept in send order and expiring looks only at the front.
+ */
+class PendingReplies {
+public:
+    using ResultFn = std::function<void(const TaskResult& result)>;
+
+    explicit PendingReplies(int timeout_ms = 1000) : timeout_ns_(timeout_ms * 1000000LL) {}
+
+    PendingReplies(const PendingReplies&) = delete;
+    PendingReplies& operator=(const PendingReplies&) = delete;
+
+    // Track message_id from now; call before its request is sent, so the reply can't race ahead of it
+    void expect(const std::string& message_id) {
+        long long now_ns = message_helpers::get_steady_time_ns();
+        std::lock_guard<std::mutex> lock(mu_);
+        pending_[message_id] = now_ns;
+        deadlines_.push_back({now_ns + timeout_ns_, message_id});
+    }
+
+    // Report message_id as failed, e.g. because its send failed
+    void fail(const std::string& message_id, const std::string& error) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (pending_.erase(message_id)) {
+            TaskResult res;
+            res.message_id = message_id;
+            res.error = error;
+            done_.push_back(std::move(res));
+            cv_.notify_one();
+        }
+    }
+
+    /**
+     * @brief Report message_id as answered by a reply; valid is false for a rejected or malformed one.
+     * @return false for a late reply to a request that already timed out
+     */
+    bool complete(const std::string& message_id, bool valid, const AckTiming& ack_timing) {
+        std::lock_guard<std::mutex> lock(mu_);
+        std::optional<TaskResult> res = take_locked(message_id);
+        if (!res) {
+            return false;
+        }
+        res->success = valid;
+        if (!valid) {
+            res->error = "Invalid ACK";
+        }
+        res->ack_timing = ack_timing;
+        done_.push_back(std::move(*res));
+        cv_.notify_one();
+        return true;
+    }
+
+    // Stop tracking message_id and return its result with the round trip filled in, for callers
+    // that report a reply themselves; nullopt if it already timed out
+    std::optional<TaskResult> take(const std::string& message_id) {
+        std::lock_guard<std::mutex> lock(mu_);
+        return take_locked(message_id);
+    }
+
+    // Requests expected but not yet reported by poll()
+    size_t in_flight() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return pending_.size() + done_.size();
+    }
+
+    /**
+     * @brief Wait up to wait_ms for completions and report them on this thread.
+     * @return Number of requests completed (acked, failed or timed out)
+     */
+    size_t poll(int wait_ms, const ResultFn& on_result) {
+        std::vector<TaskResult> ready;
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            if (done_.empty() && wait_ms > 0) {
+                cv_.wait_for(lock, std::chrono::milliseconds(wait_ms), [this]() { return !done_.empty(); });
+            }
+            expire_locked();
+            ready.swap(done_);
+        }
+        for (const auto& res : ready) {
+            on_result(res);
+        }
+        return ready.size();
+    }
+
+    // Poll until every outstanding request has been acked or timed out
+    void drain_all(const ResultFn& on_result) {
+        while (in_flight() > 0) {
+            poll(10, on_result);
+        }
+    }
+
+private:
+    std::optional<TaskResult> take_locked(const std::string& message_id) {
+        auto it = pending_.find(message_id);
+        if (it == pending_.end()) {
+            return std::nullopt;
+        }
+        TaskResult res;
+        res.message_id = message_id;
+        res.duration_ns = message_helpers::get_steady_time_ns() - it->second;
+        pending_.erase(it);
+        return res;
+    }
+
+    void expire_locked() {
+        long long now_ns = message_helpers::get_steady_time_ns();
+        while (!deadlines_.empty() && deadlines_.front().first <= now_ns) {
+            auto it = pending_.find(deadlines_.front().second);
+            // Skip entries whose request was acked, or re-sent with a later deadline
+            if (it != pending_.end() && it->second + timeout_ns_ <= now_ns) {
+                TaskResult res;
+                res.message_id = it->first;
+                res.error = "Timeout";
+                pending_.erase(it);
+                done_.push_back(std::move(res));
+            }
+            deadlines_.pop_front();
+        }
+    }
+
+    long long timeout_ns_;
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::unordered_map<std::string, long long> pending_;   // message_id -> send time
+    std::deque<std::pair<long long, std::string>> deadlines_;
+    std::vector<TaskResult> done_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // PENDING_REPLIES_HPP
@@ -0,0 +1,226 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "json.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Whether a program measures hardware counters around its timed region.
+ *
+ * Parse --perf-counters from the command line.
+ */
+struct PerfCounterOptions {
+    bool enabled = false;
+
+    static PerfCounterOptions from_args(int argc, char* argv[]) {
+        PerfCounterOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--perf-counters") == 0) {
+                options.enabled = true;
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * CPU, cache and scheduler cost of a timed region, from perf_event_open.
+ *
+ * The counters are opened for the whole process when constructed and
+ * inherited by every thread created afterwards, so construct this before
+ * starting worker threads or connection pools; threads that already exist
+ * (the log writer, for one) are not counted. start() and stop() reset, enable
+ * and disable them around the timed region. Counts are scaled for
+ * multiplexing when the PMU had to share.
+ *
+ *   PerfCounters perf(PerfCounterOptions::from_args(argc, argv));
+ *   perf.start();
+ *   ... timed region ...
+ *   perf.stop();
+ *   perf.add_to(report, stats.processed_count);   // "hw_counters", totals and per message
+ *
+ * Where perf_event_paranoid forbids kernel counting the counters fall back to
+ * user space only (reported as user_only), and counters the host does not
+ * expose, such as hardware events in many VMs, are listed under unavailable. Voluntary and
+ * involuntary context switches come from getrusage and cover every thread.
+ */
+class PerfCounters {
+public:
+    explicit PerfCounters(const PerfCounterOptions& options) : enabled_(options.enabled) {
+        if (!enabled_) {
+            return;
+        }
+        open_counter("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open_counter("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open_counter("llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        open_counter("context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+        if (counters_.empty()) {
+            fprintf(stderr, " [!] perf_event_open unavailable (%s); reporting rusage only\n",
+                    std::strerror(open_errno_));
+        }
+    }
+
+    ~PerfCounters() {
+        for (const Counter& counter : counters_) {
+            close(counter.fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool enabled() const { return enabled_; }
+
+    void start() {
+        if (!enabled_) {
+            return;
+        }
+        getrusage(RUSAGE_SELF, &usage_before_);
+        for (const Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        running_ = true;
+    }
+
+    void stop() {
+        if (!running_) {
+            return;
+        }
+        for (Counter& counter : counters_) {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+            counter.value = read_scaled(counter.fd);
+        }
+        struct rusage after;
+        getrusage(RUSAGE_SELF, &after);
+        voluntary_switches_ = after.ru_nvcsw - usage_before_.ru_nvcsw;
+        involuntary_switches_ = after.ru_nivcsw - usage_before_.ru_nivcsw;
+        running_ = false;
+        measured_ = true;
+    }
+
+    /**
+     * Totals for the region, and each divided by messages under per_message;
+     * instructions_per_cycle when both were counted.
+     */
+    nlohmann::json to_json(long long messages) const {
+        nlohmann::json totals = nlohmann::json::object();
+        for (const Counter& counter : counters_) {
+            if (counter.value >= 0) {
+                totals[counter.name] = counter.value;
+            }
+        }
+        totals["voluntary_context_switches"] = voluntary_switches_;
+        totals["involuntary_context_switches"] = involuntary_switches_;
+
+        nlohmann::json result = totals;
+        if (messages > 0) {
+            nlohmann::json per_message = nlohmann::json::object();
+            for (const auto& [name, value] : totals.items()) {
+                per_message[name] = value.get<double>() / messages;
+            }
+            result["per_message"] = per_message;
+        }
+        if (totals.contains("cycles") && totals.contains("instructions") && totals["cycles"].get<int64_t>() > 0) {
+            result["instructions_per_cycle"] =
+                totals["instructions"].get<double>() / totals["cycles"].get<double>();
+        }
+        result["messages"] = messages;
+        result["user_only"] = user_only_;
+        if (!unavailable_.empty()) {
+            result["unavailable"] = unavailable_;
+        }
+        return result;
+    }
+
+    // Add "hw_counters" to report once a region has been measured
+    void add_to(nlohmann::json& report, long long messages) const {
+        if (measured_) {
+            report["hw_counters"] = to_json(messages);
+        }
+    }
+
+private:
+    struct Counter {
+        const char* name;
+        int fd;
+        int64_t value;
+    };
+
+    void open_counter(const char* name, uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_hv = 1;
+        attr.exclude_kernel = user_only_ ? 1 : 0;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = perf_event_open(attr);
+        if (fd < 0 && (errno == EACCES || errno == EPERM) && !user_only_) {
+            // perf_event_paranoid >= 2: count user space only, for this and later counters
+            attr.exclude_kernel = 1;
+            fd = perf_event_open(attr);
+            if (fd >= 0) {
+                user_only_ = true;
+            }
+        }
+        if (fd < 0) {
+            open_errno_ = errno;
+            unavailable_.push_back(name);
+            return;
+        }
+        counters_.push_back({name, fd, -1});
+    }
+
+    static int perf_event_open(struct perf_event_attr& attr) {
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    // The count, scaled up by enabled/running time if the counter was multiplexed; -1 if unreadable
+    static int64_t read_scaled(int fd) {
+        uint64_t values[3] = {0, 0, 0};   // value, time_enabled, time_running
+        if (read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+            return -1;
+        }
+        if (values[2] == 0) {
+            return values[1] == 0 ? static_cast<int64_t>(values[0]) : -1;
+        }
+        if (values[2] < values[1]) {
+            return static_cast<int64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+        }
+        return static_cast<int64_t>(values[0]);
+    }
+
+    bool enabled_;
+    bool running_ = false;
+    bool measured_ = false;
+    bool user_only_ = false;
+    int open_errno_ = 0;
+    std::vector<Counter> counters_;
+    std::vector<std::string> unavailable_;
+    struct rusage usage_before_ {};
+    long voluntary_switches_ = 0;
+    long involuntary_switches_ = 0;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // PERF_COUNTERS_HPP
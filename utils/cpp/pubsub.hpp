@@ -0,0 +1,640 @@
+#ifndef UNIFIED_PUBSUB_HPP
+#define UNIFIED_PUBSUB_HPP
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include "json.hpp"
+#include "messaging.pb.h"
+#include "unified_transports.hpp"
+
+namespace messaging {
+namespace utils {
+
+using json = nlohmann::json;
+
+/**
+ * Publishing end of a PUBLISH_SUBSCRIBE / FANOUT topic.
+ *
+ * Unlike UnifiedSender there is no target and no ACK: every subscriber of
+ * the topic gets its own copy, and the transport decides what happens when
+ * one of them falls behind (ZeroMQ and NATS drop past their high-water mark,
+ * RabbitMQ drops the oldest past x-max-length, Redis disconnects the
+ * subscriber past its output buffer limit). FanoutBench counts what arrives.
+ */
+class UnifiedPublisher {
+public:
+    std::string service_name;
+
+    explicit UnifiedPublisher(const std::string& service) : service_name(service) {}
+    virtual ~UnifiedPublisher() = default;
+
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+
+    // How the transport copies a publication: per topic subscription, or to every bound queue
+    virtual ::messaging::RoutingMode routing() const { return ::messaging::PUBLISH_SUBSCRIBE; }
+
+    // Hand body to the transport for every subscriber; false if it refused it
+    virtual bool publish(std::string_view body) = 0;
+
+    // Called once every subscriber has joined, before the timed publishes
+    virtual void begin_run() {}
+
+    // Push out anything the client library still buffers
+    virtual void flush() {}
+
+    // Transport-specific counters for the run report
+    virtual json report() const { return json::object(); }
+};
+
+/**
+ * One subscriber of a topic, driven by a single thread.
+ *
+ * receive() returns a view into the transport's buffer, valid until the next
+ * call; connect() must not return before the subscription is in place, but
+ * brokers may still take a moment to route to it, which is what FanoutBench's
+ * join phase waits out.
+ */
+class UnifiedSubscriber {
+public:
+    std::string service_name;
+
+    explicit UnifiedSubscriber(const std::string& service) : service_name(service) {}
+    virtual ~UnifiedSubscriber() = default;
+
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+
+    // Next message, or nullopt after timeout_ms
+    virtual std::optional<std::string_view> receive(int timeout_ms) = 0;
+
+    // Make a receive() blocked in another thread return; only needed where receive ignores its timeout
+    virtual void interrupt() {}
+
+    // Messages the client library itself dropped for this subscriber, where it counts them
+    virtual uint64_t transport_dropped() const { return 0; }
+};
+
+// ============================================================================
+// ZeroMQ PUB/SUB
+// ============================================================================
+
+#ifdef UNIFIED_HAVE_ZMQ
+/**
+ * PUB socket bound on port; each message is [topic, body]. ZMQ_SNDHWM bounds
+ * the queue kept per subscriber, past which PUB silently drops for that
+ * subscriber only; 0 keeps libzmq's default of 1000.
+ */
+class ZeroMQPublisher : public UnifiedPublisher {
+private:
+    std::string _topic;
+    int _port;
+    int _hwm;
+    std::unique_ptr<zmq::context_t> _context;
+    std::unique_ptr<zmq::socket_t> _socket;
+
+public:
+    ZeroMQPublisher(const std::string& topic, int port = 5590, int hwm = 0)
+        : UnifiedPublisher("ZeroMQ"), _topic(topic), _port(port), _hwm(hwm) {}
+    ~ZeroMQPublisher() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        try {
+            _context = std::make_unique<zmq::context_t>(1);
+            _socket = std::make_unique<zmq::socket_t>(*_context, ZMQ_PUB);
+            _socket->setsockopt(ZMQ_LINGER, 0);
+            if (_hwm > 0) {
+                _socket->setsockopt(ZMQ_SNDHWM, _hwm);
+            }
+            _socket->bind("tcp://*:" + std::to_string(_port));
+            return true;
+        } catch (const zmq::error_t& e) {
+            std::cerr << " [!] ZeroMQ PUB bind failed: " << e.what() << std::endl;
+            disconnect();
+            return false;
+        }
+    }
+
+    void disconnect() override {
+        _socket.reset();
+        _context.reset();
+    }
+
+    bool publish(std::string_view body) override {
+        return _socket &&
+               _socket->send(zmq::buffer(_topic.data(), _topic.size()), zmq::send_flags::sndmore) &&
+               _socket->send(zmq::buffer(body.data(), body.size()), zmq::send_flags::none);
+    }
+
+    int get_port() const { return _port; }
+};
+
+// SUB socket connected to a ZeroMQPublisher, filtering on its topic; ZMQ_RCVHWM bounds its own queue
+class ZeroMQSubscriber : public UnifiedSubscriber {
+private:
+    std::string _topic;
+    int _port;
+    int _hwm;
+    std::shared_ptr<zmq::context_t> _context;  // shared by every subscriber of a run
+    std::unique_ptr<zmq::socket_t> _socket;
+    zmq::message_t _frame;
+
+public:
+    ZeroMQSubscriber(std::shared_ptr<zmq::context_t> context, const std::string& topic, int port = 5590, int hwm = 0)
+        : UnifiedSubscriber("ZeroMQ"), _topic(topic), _port(port), _hwm(hwm), _context(std::move(context)) {}
+    ~ZeroMQSubscriber() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        try {
+            _socket = std::make_unique<zmq::socket_t>(*_context, ZMQ_SUB);
+            _socket->setsockopt(ZMQ_LINGER, 0);
+            if (_hwm > 0) {
+                _socket->setsockopt(ZMQ_RCVHWM, _hwm);
+            }
+            _socket->setsockopt(ZMQ_SUBSCRIBE, _topic.data(), _topic.size());
+            _socket->connect("tcp://localhost:" + std::to_string(_port));
+            return true;
+        } catch (const zmq::error_t& e) {
+            std::cerr << " [!] ZeroMQ SUB connect failed: " << e.what() << std::endl;
+            disconnect();
+            return false;
+        }
+    }
+
+    void disconnect() override { _socket.reset(); }
+
+    std::optional<std::string_view> receive(int timeout_ms) override {
+        if (!_socket) {
+            return std::nullopt;
+        }
+        zmq::pollitem_t item = {static_cast<void*>(*_socket), 0, ZMQ_POLLIN, 0};
+        if (zmq::poll(&item, 1, std::chrono::milliseconds(timeout_ms)) <= 0) {
+            return std::nullopt;
+        }
+        // Skip the topic frame; the body is the last one
+        do {
+            if (!_socket->recv(_frame, zmq::recv_flags::none)) {
+                return std::nullopt;
+            }
+        } while (_frame.more());
+        return std::string_view(static_cast<const char*>(_frame.data()), _frame.size());
+    }
+};
+#endif // UNIFIED_HAVE_ZMQ
+
+// ============================================================================
+// Redis channels
+// ============================================================================
+
+#ifdef UNIFIED_HAVE_REDIS
+/**
+ * PUBLISH to one channel. Redis has no per-subscriber queue limit to set: a
+ * subscriber whose output buffer passes client-output-buffer-limit pubsub is
+ * disconnected, which shows up as drops. PUBLISH's reply, the number of
+ * subscribers it reached, is kept for the report from begin_run() on.
+ */
+class RedisPublisher : public UnifiedPublisher {
+private:
+    std::string _channel;
+    std::string _host;
+    int _port;
+    redisContext* _pub = nullptr;
+    long long _min_reached = -1;
+    long long _max_reached = 0;
+
+public:
+    RedisPublisher(const std::string& channel, const std::string& host = "127.0.0.1", int port = 6379)
+        : UnifiedPublisher("Redis"), _channel(channel), _host(host), _port(port) {}
+    ~RedisPublisher() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _pub = redisConnect(_host.c_str(), _port);
+        if (!_pub || _pub->err) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        if (_pub) {
+            redisFree(_pub);
+            _pub = nullptr;
+        }
+    }
+
+    bool publish(std::string_view body) override {
+        if (!_pub) {
+            return false;
+        }
+        redisReply* reply = (redisReply*)redisCommand(_pub, "PUBLISH %b %b", _channel.data(), _channel.size(),
+                                                     body.data(), body.size());
+        if (!reply) {
+            return false;
+        }
+        bool ok = reply->type == REDIS_REPLY_INTEGER;
+        if (ok) {
+            _min_reached = _min_reached < 0 ? reply->integer : std::min(_min_reached, reply->integer);
+            _max_reached = std::max(_max_reached, reply->integer);
+        }
+        freeReplyObject(reply);
+        return ok;
+    }
+
+    void begin_run() override {
+        _min_reached = -1;
+        _max_reached = 0;
+    }
+
+    json report() const override {
+        return {{"min_subscribers_reached", std::max(0LL, _min_reached)},
+                {"max_subscribers_reached", _max_reached}};
+    }
+};
+
+// SUBSCRIBE on a connection of its own; the view points into the last redisReply
+class RedisSubscriber : public UnifiedSubscriber {
+private:
+    std::string _channel;
+    std::string _host;
+    int _port;
+    redisContext* _sub = nullptr;
+    redisReply* _message = nullptr;
+    int _timeout_ms = -1;  // read timeout currently set on _sub
+
+    void _release_message() {
+        if (_message) {
+            freeReplyObject(_message);
+            _message = nullptr;
+        }
+    }
+
+public:
+    RedisSubscriber(const std::string& channel, const std::string& host = "127.0.0.1", int port = 6379)
+        : UnifiedSubscriber("Redis"), _channel(channel), _host(host), _port(port) {}
+    ~RedisSubscriber() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _sub = redisConnect(_host.c_str(), _port);
+        if (!_sub || _sub->err) {
+            disconnect();
+            return false;
+        }
+        redisReply* reply = (redisReply*)redisCommand(_sub, "SUBSCRIBE %b", _channel.data(), _channel.size());
+        if (!reply) {
+            disconnect();
+            return false;
+        }
+        freeReplyObject(reply);
+        return true;
+    }
+
+    void disconnect() override {
+        _release_message();
+        if (_sub) {
+            redisFree(_sub);
+            _sub = nullptr;
+        }
+        _timeout_ms = -1;
+    }
+
+    std::optional<std::string_view> receive(int timeout_ms) override {
+        _release_message();
+        if (!_sub) {
+            return std::nullopt;
+        }
+        if (timeout_ms != _timeout_ms) {
+            struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+            redisSetTimeout(_sub, tv);
+            _timeout_ms = timeout_ms;
+        }
+        redisReply* reply = nullptr;
+        if (redisGetReply(_sub, (void**)&reply) != REDIS_OK || !reply) {
+            if (_sub->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
+                // Timed out; clear the error so the connection stays usable
+                _sub->err = 0;
+                memset(_sub->errstr, 0, sizeof(_sub->errstr));
+            }
+            return std::nullopt;
+        }
+        if (reply->type != REDIS_REPLY_ARRAY || reply->elements < 3 ||
+            reply->element[0]->type != REDIS_REPLY_STRING || strcmp(reply->element[0]->str, "message") != 0) {
+            freeReplyObject(reply);
+            return std::nullopt;
+        }
+        _message = reply;
+        return std::string_view(reply->element[2]->str, reply->element[2]->len);
+    }
+};
+#endif // UNIFIED_HAVE_REDIS
+
+// ============================================================================
+// NATS subjects
+// ============================================================================
+
+#ifdef UNIFIED_HAVE_NATS
+// Core NATS publish to one subject; flush() waits for the server to have taken everything
+class NatsPublisher : public UnifiedPublisher {
+private:
+    std::string _subject;
+    std::string _host;
+    int _port;
+    natsConnection* _conn = nullptr;
+
+public:
+    NatsPublisher(const std::string& subject, const std::string& host = "localhost", int port = 4222)
+        : UnifiedPublisher("NATS"), _subject(subject), _host(host), _port(port) {}
+    ~NatsPublisher() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        std::string url = "nats://" + _host + ":" + std::to_string(_port);
+        return natsConnection_ConnectTo(&_conn, url.c_str()) == NATS_OK;
+    }
+
+    void disconnect() override {
+        if (_conn) {
+            natsConnection_Destroy(_conn);
+            _conn = nullptr;
+        }
+    }
+
+    bool publish(std::string_view body) override {
+        return _conn && natsConnection_Publish(_conn, _subject.c_str(), body.data(),
+                                               static_cast<int>(body.size())) == NATS_OK;
+    }
+
+    void flush() override {
+        if (_conn) {
+            natsConnection_Flush(_conn);
+        }
+    }
+};
+
+/**
+ * Synchronous subscription on a connection of its own. hwm sets the
+ * subscription's pending-message limit (0 keeps the library's 65536); past
+ * it the client drops as a slow consumer and counts the drops itself.
+ */
+class NatsSubscriber : public UnifiedSubscriber {
+private:
+    std::string _subject;
+    std::string _host;
+    int _port;
+    int _hwm;
+    natsConnection* _conn = nullptr;
+    natsSubscription* _sub = nullptr;
+    natsMsg* _msg = nullptr;
+
+    void _release_message() {
+        if (_msg) {
+            natsMsg_Destroy(_msg);
+            _msg = nullptr;
+        }
+    }
+
+public:
+    NatsSubscriber(const std::string& subject, const std::string& host = "localhost", int port = 4222, int hwm = 0)
+        : UnifiedSubscriber("NATS"), _subject(subject), _host(host), _port(port), _hwm(hwm) {}
+    ~NatsSubscriber() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        std::string url = "nats://" + _host + ":" + std::to_string(_port);
+        natsStatus s = natsConnection_ConnectTo(&_conn, url.c_str());
+        if (s == NATS_OK) {
+            s = natsConnection_SubscribeSync(&_sub, _conn, _subject.c_str());
+        }
+        if (s == NATS_OK && _hwm > 0) {
+            s = natsSubscription_SetPendingLimits(_sub, _hwm, -1);
+        }
+        // The server routes to the subscription once it has processed the SUB
+        if (s == NATS_OK) {
+            s = natsConnection_Flush(_conn);
+        }
+        if (s != NATS_OK) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        _release_message();
+        if (_sub) {
+            natsSubscription_Destroy(_sub);
+            _sub = nullptr;
+        }
+        if (_conn) {
+            natsConnection_Destroy(_conn);
+            _conn = nullptr;
+        }
+    }
+
+    std::optional<std::string_view> receive(int timeout_ms) override {
+        _release_message();
+        if (!_sub || natsSubscription_NextMsg(&_msg, _sub, timeout_ms) != NATS_OK) {
+            _msg = nullptr;
+            return std::nullopt;
+        }
+        return std::string_view(natsMsg_GetData(_msg), static_cast<size_t>(natsMsg_GetDataLength(_msg)));
+    }
+
+    uint64_t transport_dropped() const override {
+        int64_t dropped = 0;
+        if (!_sub || natsSubscription_GetDropped(_sub, &dropped) != NATS_OK) {
+            return 0;
+        }
+        return static_cast<uint64_t>(dropped);
+    }
+};
+#endif // UNIFIED_HAVE_NATS
+
+// ============================================================================
+// RabbitMQ fanout exchanges
+// ============================================================================
+
+#ifdef UNIFIED_HAVE_RABBITMQ
+// Open a connection and channel 1 as guest; nullptr (with nothing left open) on failure
+inline amqp_connection_state_t open_amqp_channel(const std::string& host, int port) {
+    amqp_connection_state_t conn = amqp_new_connection();
+    amqp_socket_t* socket = amqp_tcp_socket_new(conn);
+    bool ok = socket && amqp_socket_open(socket, host.c_str(), port) == AMQP_STATUS_OK &&
+              amqp_login(conn, "/", 0, 131072, 0, AMQP_SASL_METHOD_PLAIN, "guest", "guest").reply_type ==
+                  AMQP_RESPONSE_NORMAL;
+    if (ok) {
+        amqp_channel_open(conn, 1);
+        ok = amqp_get_rpc_reply(conn).reply_type == AMQP_RESPONSE_NORMAL;
+        if (!ok) {
+            amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+        }
+    }
+    if (!ok) {
+        amqp_destroy_connection(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+inline void close_amqp_channel(amqp_connection_state_t conn) {
+    amqp_channel_close(conn, 1, AMQP_REPLY_SUCCESS);
+    amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+    amqp_destroy_connection(conn);
+}
+
+// Declare the non-durable fanout exchange both ends use; declaring it again is a no-op
+inline bool declare_fanout_exchange(amqp_connection_state_t conn, const std::string& exchange) {
+    amqp_exchange_declare(conn, 1, amqp_cstring_bytes(exchange.c_str()), amqp_cstring_bytes("fanout"),
+                          0, 0, 0, 0, amqp_empty_table);
+    return amqp_get_rpc_reply(conn).reply_type == AMQP_RESPONSE_NORMAL;
+}
+
+// Transient publishes to a fanout exchange, which copies each into every bound queue
+class RabbitMQPublisher : public UnifiedPublisher {
+private:
+    std::string _exchange;
+    std::string _host;
+    int _port;
+    amqp_connection_state_t _conn = nullptr;
+
+public:
+    RabbitMQPublisher(const std::string& exchange, const std::string& host = "localhost", int port = 5672)
+        : UnifiedPublisher("RabbitMQ"), _exchange(exchange), _host(host), _port(port) {}
+    ~RabbitMQPublisher() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _conn = open_amqp_channel(_host, _port);
+        if (!_conn || !declare_fanout_exchange(_conn, _exchange)) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        if (_conn) {
+            close_amqp_channel(_conn);
+            _conn = nullptr;
+        }
+    }
+
+    ::messaging::RoutingMode routing() const override { return ::messaging::FANOUT; }
+
+    bool publish(std::string_view body) override {
+        if (!_conn) {
+            return false;
+        }
+        amqp_basic_properties_t props;
+        props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG;
+        props.content_type = amqp_cstring_bytes("application/octet-stream");
+        amqp_bytes_t message_bytes;
+        message_bytes.len = body.size();
+        message_bytes.bytes = (void*)body.data();
+        return amqp_basic_publish(_conn, 1, amqp_cstring_bytes(_exchange.c_str()), amqp_empty_bytes,
+                                  0, 0, &props, message_bytes) == AMQP_STATUS_OK;
+    }
+};
+
+/**
+ * Exclusive, server-named queue bound to the exchange and consumed with
+ * auto-ack. hwm caps the queue with x-max-length, past which the broker
+ * drops its oldest messages; 0 leaves it unbounded.
+ */
+class RabbitMQSubscriber : public UnifiedSubscriber {
+private:
+    std::string _exchange;
+    std::string _host;
+    int _port;
+    int _hwm;
+    amqp_connection_state_t _conn = nullptr;
+    amqp_envelope_t _envelope;
+    bool _has_envelope = false;
+
+    void _release_envelope() {
+        if (_has_envelope) {
+            amqp_destroy_envelope(&_envelope);
+            _has_envelope = false;
+        }
+    }
+
+public:
+    RabbitMQSubscriber(const std::string& exchange, const std::string& host = "localhost", int port = 5672, int hwm = 0)
+        : UnifiedSubscriber("RabbitMQ"), _exchange(exchange), _host(host), _port(port), _hwm(hwm) {}
+    ~RabbitMQSubscriber() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _conn = open_amqp_channel(_host, _port);
+        if (!_conn || !declare_fanout_exchange(_conn, _exchange)) {
+            disconnect();
+            return false;
+        }
+        amqp_table_entry_t max_length;
+        max_length.key = amqp_cstring_bytes("x-max-length");
+        max_length.value.kind = AMQP_FIELD_KIND_I32;
+        max_length.value.value.i32 = _hwm;
+        amqp_table_t arguments = amqp_empty_table;
+        if (_hwm > 0) {
+            arguments.num_entries = 1;
+            arguments.entries = &max_length;
+        }
+        amqp_queue_declare_ok_t* declared = amqp_queue_declare(_conn, 1, amqp_empty_bytes, 0, 0, 1, 1, arguments);
+        if (!declared || amqp_get_rpc_reply(_conn).reply_type != AMQP_RESPONSE_NORMAL) {
+            disconnect();
+            return false;
+        }
+        amqp_bytes_t queue = amqp_bytes_malloc_dup(declared->queue);
+        amqp_queue_bind(_conn, 1, queue, amqp_cstring_bytes(_exchange.c_str()), amqp_empty_bytes, amqp_empty_table);
+        bool ok = amqp_get_rpc_reply(_conn).reply_type == AMQP_RESPONSE_NORMAL;
+        if (ok) {
+            amqp_basic_consume(_conn, 1, queue, amqp_empty_bytes, 0, 1, 1, amqp_empty_table);
+            ok = amqp_get_rpc_reply(_conn).reply_type == AMQP_RESPONSE_NORMAL;
+        }
+        amqp_bytes_free(queue);
+        if (!ok) {
+            disconnect();
+        }
+        return ok;
+    }
+
+    void disconnect() override {
+        _release_envelope();
+        if (_conn) {
+            close_amqp_channel(_conn);
+            _conn = nullptr;
+        }
+    }
+
+    std::optional<std::string_view> receive(int timeout_ms) override {
+        _release_envelope();
+        if (!_conn) {
+            return std::nullopt;
+        }
+        amqp_maybe_release_buffers(_conn);
+        struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        if (amqp_consume_message(_conn, &_envelope, &tv, 0).reply_type != AMQP_RESPONSE_NORMAL) {
+            return std::nullopt;
+        }
+        _has_envelope = true;
+        return std::string_view(static_cast<const char*>(_envelope.message.body.bytes), _envelope.message.body.len);
+    }
+};
+#endif // UNIFIED_HAVE_RABBITMQ
+
+} // namespace utils
+} // namespace messaging
+
+#endif // UNIFIED_PUBSUB_HPP
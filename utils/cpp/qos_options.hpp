@@ -0,0 +1,98 @@
+#ifndef QOS_OPTIONS_HPP
+#define QOS_OPTIONS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "json.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Delivery guarantee a C++ sender asks for, stamped into every envelope's qos.
+ *
+ * level           - --qos at_most_once|at_least_once|exactly_once. The
+ *                   default sends each message once. The other two resend a
+ *                   message whose ACK did not arrive in time, unchanged (same
+ *                   message id), up to max_retransmits times. Receivers that
+ *                   keep a DedupFilter (receiver_host, shm) ACK exactly_once
+ *                   redeliveries again without counting them as received
+ * max_retransmits - --max-retransmits N, default 3
+ *
+ * Unlike --retries, retransmits are part of the guarantee, so they go out at
+ * once, without backoff or a retry budget. Level values match messaging.proto's
+ * QoSLevel, so they can be written to the wire as they are.
+ */
+struct QoSOptions {
+    enum Level {
+        AtMostOnce = 1,
+        AtLeastOnce = 2,
+        ExactlyOnce = 3,
+    };
+
+    Level level = AtMostOnce;
+    int max_retransmits = 3;
+
+    bool enabled() const { return level != AtMostOnce; }
+
+    // Resends allowed per message: 0 at most once
+    int retransmits() const { return enabled() ? max_retransmits : 0; }
+
+    const char* name() const {
+        switch (level) {
+            case AtLeastOnce: return "at_least_once";
+            case ExactlyOnce: return "exactly_once";
+            default: return "at_most_once";
+        }
+    }
+
+    // Parse --qos LEVEL and --max-retransmits N from the command line
+    static QoSOptions from_args(int argc, char* argv[]) {
+        QoSOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--qos") == 0 && i + 1 < argc) {
+                const char* name = argv[++i];
+                if (std::strcmp(name, "at_least_once") == 0) {
+                    options.level = AtLeastOnce;
+                } else if (std::strcmp(name, "exactly_once") == 0) {
+                    options.level = ExactlyOnce;
+                } else if (std::strcmp(name, "at_most_once") != 0) {
+                    fprintf(stderr, " [!] Ignoring unknown --qos '%s'\n", name);
+                }
+            } else if (std::strcmp(argv[i], "--max-retransmits") == 0 && i + 1 < argc) {
+                options.max_retransmits = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+
+    /**
+     * Warn that mode, which never resends, ignores the retransmits; the qos
+     * field is still stamped.
+     * @return true if --qos asked for them
+     */
+    bool warn_ignored_by(const char* mode) const {
+        if (!enabled()) {
+            return false;
+        }
+        fprintf(stderr, " [!] %s does not resend; ignoring --qos %s retransmits\n", mode, name());
+        return true;
+    }
+
+    // The guarantee and how many resends it took, for the report
+    nlohmann::json report(int64_t retransmitted) const {
+        return {
+            {"level", name()},
+            {"max_retransmits", max_retransmits},
+            {"retransmits", retransmitted}
+        };
+    }
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // QOS_OPTIONS_HPP
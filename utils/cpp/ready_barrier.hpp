@@ -0,0 +1,159 @@
+#ifndef READY_BARRIER_HPP
+#define READY_BARRIER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "message_helpers.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Whether a sender waits for its receivers before the timed run.
+ *
+ * wait       - PING every target until it answers, instead of relying on the
+ *              harness's fixed startup sleep
+ * timeout_ms - give up on targets still silent after this long; the run then
+ *              starts anyway and their messages fail as before
+ * retry_ms   - pause between unanswered PINGs to one target
+ */
+struct ReadyOptions {
+    bool wait = false;
+    int timeout_ms = 10000;
+    int retry_ms = 20;
+
+    bool enabled() const { return wait; }
+
+    // Parse --wait-ready and --ready-timeout-ms N from the command line
+    static ReadyOptions from_args(int argc, char* argv[]) {
+        ReadyOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--wait-ready") == 0) {
+                options.wait = true;
+            } else if (std::strcmp(argv[i], "--ready-timeout-ms") == 0 && i + 1 < argc) {
+                options.timeout_ms = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Readiness barrier: CONTROL PING each target's receiver until it replies.
+ *
+ * The sender supplies one blocking exchange over its own transport, the same
+ * primitive it uses for data, so a reply proves the whole path (connection,
+ * subscription or queue, receiver loop, reply route) is up rather than just a
+ * listening port. C++ receivers answer with a PONG and leave PINGs out of
+ * their counts; receivers that only know data messages ACK the PING, which
+ * counts as ready too. Targets are pinged one after another against a shared
+ * deadline, and the sender's clock should start only after wait() returns.
+ *
+ *   ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "zmq-sender");
+ *   ready.wait(ReadyBarrier::targets_of(corpus),
+ *       [&](int target, const std::string& ping_id, std::string_view body) {
+ *           return exchange(conn, target, ping_id, body) ? &conn.resp_envelope : nullptr;
+ *       });
+ *   stats.add_metadata("ready", ready.report());
+ *
+ * Does nothing, and reports {"enabled": false}, unless --wait-ready is set.
+ */
+class ReadyBarrier {
+public:
+    ReadyBarrier(const ReadyOptions& options, const std::string& source)
+        : options_(options), source_(source) {}
+
+    const ReadyOptions& options() const { return options_; }
+
+    // Distinct targets of a corpus (anything with size() and target(i)), ascending
+    template <typename Corpus>
+    static std::vector<int> targets_of(const Corpus& corpus) {
+        std::set<int> targets;
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            targets.insert(corpus.target(i));
+        }
+        return std::vector<int>(targets.begin(), targets.end());
+    }
+
+    /**
+     * PING each target through ping(target, ping_id, body) until the reply
+     * shows it is ready or timeout_ms has passed. ping returns the parsed
+     * reply, or nullptr when none arrived. True when every target answered.
+     */
+    template <typename Ping>
+    bool wait(const std::vector<int>& targets, Ping ping) {
+        if (!options_.enabled()) {
+            return true;
+        }
+        targets_ = targets;
+        missing_.clear();
+        int64_t start_ns = message_helpers::get_steady_time_ns();
+        int64_t deadline_ns = start_ns + static_cast<int64_t>(options_.timeout_ms) * 1000000;
+        std::string body;
+        for (int target : targets) {
+            bool ready = false;
+            for (int attempt = 0; !ready; ++attempt) {
+                std::string ping_id = "ping_" + std::to_string(target) + "_" + std::to_string(attempt);
+                message_helpers::create_ping(target, ping_id, source_).SerializeToString(&body);
+                pings_++;
+                try {
+                    const MessageEnvelope* reply = ping(target, ping_id, std::string_view(body));
+                    ready = reply && message_helpers::is_ready_reply(*reply, ping_id);
+                } catch (const std::exception&) {
+                    ready = false;   // the receiver's endpoint may not exist yet
+                }
+                if (ready || message_helpers::get_steady_time_ns() >= deadline_ns) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(options_.retry_ms));
+            }
+            if (!ready) {
+                missing_.push_back(target);
+            }
+        }
+        elapsed_ns_ = message_helpers::get_steady_time_ns() - start_ns;
+        if (!missing_.empty()) {
+            fprintf(stderr, " [!] %zu of %zu receivers not ready after %d ms; starting anyway\n",
+                    missing_.size(), targets.size(), options_.timeout_ms);
+        }
+        return missing_.empty();
+    }
+
+    // What the last wait() found, for the report's metadata
+    nlohmann::json report() const {
+        if (!options_.enabled()) {
+            return {{"enabled", false}};
+        }
+        return {
+            {"enabled", true},
+            {"targets", targets_.size()},
+            {"ready", targets_.size() - missing_.size()},
+            {"pings", pings_},
+            {"elapsed_ms", elapsed_ns_ / 1e6},
+            {"missing", missing_}
+        };
+    }
+
+private:
+    ReadyOptions options_;
+    std::string source_;
+    std::vector<int> targets_;
+    std::vector<int> missing_;
+    int64_t pings_ = 0;
+    int64_t elapsed_ns_ = 0;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // READY_BARRIER_HPP
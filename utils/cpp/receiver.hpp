@@ -9,14 +9,32 @@
 #include <chrono>
 #include <iostream>
 #include <functional>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <google/protobuf/arena.h>
 #include "json.hpp"
 #include "messaging_utils.hpp"
+#include "message_helpers.hpp"
+#include "async_logger.hpp"
+#include "dedup_window.hpp"
+#include "unified_transports.hpp"
 
 namespace messaging {
 namespace utils {
 
 using json = nlohmann::json;
 
+/**
+ * Non-owning view of a received message. Backends point it straight at the
+ * transport's buffer (zmq::message_t::data(), redisReply::str,
+ * amqp_bytes_t::bytes), which must stay valid until the next receive.
+ */
+struct ByteView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
 /**
  * Abstract base class for all C++ receivers.
  * Mirrors the Python UnifiedReceiver architecture.
@@ -31,9 +49,28 @@ public:
 protected:
     std::atomic<bool> _running{false};
 
+private:
+    // Arena grows as reused messages reallocate fields; start over past this size
+    static constexpr size_t kArenaResetBytes = 1 << 20;
+
+    // Per-receiver request/ACK messages reused across receives
+    google::protobuf::Arena _arena;
+    ::messaging::MessageEnvelope* _request = nullptr;
+    ::messaging::MessageEnvelope* _ack = nullptr;
+    std::string _ack_buffer;
+    std::string _receiver_name;  // receiver_id as sent in ACKs, formatted once
+    DedupFilter _dedup;          // EXACTLY_ONCE redeliveries seen so far
+
+    // Backing storage for the default _receive_view/_send_view adapters
+    std::vector<uint8_t> _receive_buffer;
+    std::vector<uint8_t> _send_buffer;
+    std::string _json_buffer;
+
 public:
     UnifiedReceiver(int id, const std::string& service, const std::string& lang = "C++")
-        : receiver_id(id), service_name(service), language(lang) {}
+        : receiver_id(id), service_name(service), language(lang), _receiver_name(std::to_string(id)) {
+        _allocate_messages();
+    }
 
     virtual ~UnifiedReceiver() = default;
 
@@ -49,6 +86,52 @@ public:
     // Send raw message bytes (for ACKs)
     virtual bool _send_raw(const std::vector<uint8_t>& data) = 0;
 
+    /**
+     * Receive without copying: returns a view into the transport's own buffer,
+     * valid until the next call. The default adapts _receive_raw; backends
+     * override it to hand out zmq::message_t / redisReply / amqp_bytes_t data.
+     */
+    virtual std::optional<ByteView> _receive_view(int timeout_ms) {
+        auto raw = _receive_raw(timeout_ms);
+        if (!raw) {
+            return std::nullopt;
+        }
+        _receive_buffer = std::move(*raw);
+        return ByteView{_receive_buffer.data(), _receive_buffer.size()};
+    }
+
+    // Send ACK bytes from a caller-owned buffer; defaults to copying into _send_raw
+    virtual bool _send_view(const uint8_t* data, size_t size) {
+        _send_buffer.assign(data, data + size);
+        return _send_raw(_send_buffer);
+    }
+
+    // Sockets an event loop can wait on for incoming requests; empty if the backend has none to offer
+    virtual std::vector<int> poll_fds() const { return {}; }
+
+    // True if requests were already read off the socket, so poll_fds() will not signal for them
+    virtual bool _has_pending() const { return false; }
+
+    // True if _has_pending() sees every delivered request, so a backend without sockets need not wait in receive
+    virtual bool _pending_is_complete() const { return false; }
+
+    // _receive_raw for backends that override _receive_view: a copy of the view
+    std::optional<std::vector<uint8_t>> _copy_of_view(int timeout_ms) {
+        auto view = _receive_view(timeout_ms);
+        if (!view) {
+            return std::nullopt;
+        }
+        return std::vector<uint8_t>(view->data, view->data + view->size);
+    }
+
+    // Called with each parsed request before its ACK is sent, for backends that route by its metadata
+    virtual void _on_request(const ::messaging::MessageEnvelope& request) {}
+
+    // Size the EXACTLY_ONCE duplicate filter; call before the first receive
+    void configure_dedup(const DedupOptions& options) { _dedup = DedupFilter(options); }
+
+    const DedupFilter& dedup() const { return _dedup; }
+
     /**
      * Create a proper MessageEnvelope ACK response.
      * This is the unified ACK format using protobuf ack field.
@@ -59,14 +142,18 @@ public:
         ack_envelope.target = original.target;
         ack_envelope.type = MessageType::ACK;
         ack_envelope.routing = RoutingMode::REQUEST_REPLY;
-        ack_envelope.timestamp = get_timestamp_ms();
+        ack_envelope.timestamp_us = get_timestamp_us();
+        ack_envelope.timestamp = ack_envelope.timestamp_us / 1000;
         
         // Populate ack field directly (no JSON)
         ack_envelope.ack = std::make_unique<Acknowledgment>();
         ack_envelope.ack->original_message_id = original.message_id;
+        ack_envelope.ack->original_message_seq = original.message_seq;
         ack_envelope.ack->received = true;
-        ack_envelope.ack->latency_ms = static_cast<double>(ack_envelope.timestamp - original.timestamp);
-        ack_envelope.ack->receiver_id = std::to_string(receiver_id);
+        ack_envelope.ack->latency_ms = (ack_envelope.timestamp_us - original.timestamp_us) / 1000.0;
+        ack_envelope.ack->received_at_us = ack_envelope.timestamp_us;
+        ack_envelope.ack->acked_at_us = ack_envelope.timestamp_us;
+        ack_envelope.ack->receiver_id = _receiver_name;
         ack_envelope.ack->status = "OK";
         
         // Copy reply_to metadata if present
@@ -78,38 +165,99 @@ public:
     }
 
     /**
-     * Receive a message and send acknowledgment.
-     * Returns the received envelope, or nullopt on timeout.
+     * Receive a message and send acknowledgment on the binary path.
+     *
+     * The request is parsed straight from the transport buffer into an
+     * arena-owned envelope, and the ACK is serialized into a reused buffer, so
+     * a steady-state receive does no heap allocation. JSON-encoded requests
+     * (legacy Python senders) are still accepted and answered in JSON.
+     *
+     * EXACTLY_ONCE requests go through a bounded duplicate filter: a
+     * redelivery is ACKed again, so its sender stops retransmitting, but is
+     * counted in duplicate_count rather than received_count. AT_LEAST_ONCE
+     * and AT_MOST_ONCE requests are counted every time they arrive.
+     *
+     * Returns the received envelope, valid until the next receive, or nullptr
+     * on timeout or parse failure; duplicates are returned too.
      */
-    std::optional<MessageEnvelope> receive_and_ack(int timeout_ms = 1000) {
-        auto raw_data = _receive_raw(timeout_ms);
-        if (!raw_data) {
-            return std::nullopt;
+    const ::messaging::MessageEnvelope* receive_and_ack_proto(int timeout_ms = 1000) {
+        auto view = _receive_view(timeout_ms);
+        if (!view) {
+            return nullptr;
         }
+        message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
 
-        try {
-            // Try to parse as MessageEnvelope JSON
-            std::string json_str(raw_data->begin(), raw_data->end());
-            MessageEnvelope envelope = MessageEnvelope::from_json(json_str);
-            
-            stats.received_count++;
-            
-            // Create and send ACK
-            MessageEnvelope ack = _create_ack(envelope);
-            std::string ack_json = ack.to_json();
-            std::vector<uint8_t> ack_bytes(ack_json.begin(), ack_json.end());
-            _send_raw(ack_bytes);
-            
-            return envelope;
-        } catch (const std::exception& e) {
-            std::cerr << " [!] Error processing message: " << e.what() << std::endl;
+        if (_arena.SpaceUsed() > kArenaResetBytes) {
+            _arena.Reset();
+            _allocate_messages();
+        }
+
+        bool is_json = view->size > 0 && view->data[0] == '{';
+        bool parsed;
+        _request->Clear();
+        if (is_json) {
+            _json_buffer.assign(reinterpret_cast<const char*>(view->data), view->size);
+            parsed = util::JsonStringToMessage(_json_buffer, _request).ok();
+        } else {
+            parsed = _request->ParseFromArray(view->data, static_cast<int>(view->size));
+        }
+        parsed = parsed && message_helpers::decode_payload(*_request);
+        if (!parsed) {
+            std::cerr << " [!] Error processing message: failed to parse envelope" << std::endl;
             stats.failed_count++;
+            return nullptr;
+        }
+
+        // Readiness PINGs are answered but not counted as received traffic
+        bool control = message_helpers::is_control(*_request);
+        bool duplicate = !control && _request->qos() == ::messaging::EXACTLY_ONCE &&
+                         _dedup.check_and_mark(*_request) != Seen::New;
+        if (duplicate) {
+            stats.duplicate_count++;
+        } else if (!control) {
+            stats.received_count++;
+        }
+
+        _on_request(*_request);
+        if (_request->type() == ::messaging::BATCH) {
+            *_ack = message_helpers::create_batch_response(*_request, _receiver_name, timing);
+        } else if (control) {
+            *_ack = message_helpers::create_control_response(*_request, _receiver_name, timing);
+            auto reply_to = _request->metadata().find("reply_to");
+            if (reply_to != _request->metadata().end()) {
+                (*_ack->mutable_metadata())["reply_to"] = reply_to->second;
+            }
+        } else {
+            _fill_ack(*_request, timing);
+        }
+        if (is_json) {
+            _ack_buffer.clear();
+            util::MessageToJsonString(*_ack, &_ack_buffer);
+        } else {
+            size_t size = _ack->ByteSizeLong();
+            _ack_buffer.resize(size);
+            _ack->SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(&_ack_buffer[0]));
+        }
+        _send_view(reinterpret_cast<const uint8_t*>(_ack_buffer.data()), _ack_buffer.size());
+
+        return _request;
+    }
+
+    /**
+     * Receive a message and send acknowledgment.
+     * Returns a copy of the received envelope, or nullopt on timeout.
+     */
+    std::optional<MessageEnvelope> receive_and_ack(int timeout_ms = 1000) {
+        const ::messaging::MessageEnvelope* envelope = receive_and_ack_proto(timeout_ms);
+        if (!envelope) {
             return std::nullopt;
         }
+        return MessageEnvelope::from_proto(*envelope);
     }
 
     /**
-     * Run the receiver loop.
+     * Run the receiver loop. Progress is reported as a periodic summary line;
+     * verbose adds a line per message at debug level (--log-level debug).
      */
     void run(bool verbose = true) {
         if (!connect()) {
@@ -122,18 +270,24 @@ public:
                       << " ready and waiting for messages" << std::endl;
         }
 
+        LogSummary& progress = AsyncLogger::global().summary(
+            " [*] " + service_name + " Receiver " + _receiver_name, {"received"});
         _running = true;
-        stats.start_time = get_timestamp_ms();
+        stats.start_ns = get_steady_ns();
 
         while (_running) {
-            auto envelope = receive_and_ack(1000);
-            if (envelope && verbose) {
-                std::cout << " [Receiver " << receiver_id << "] Received message " 
-                          << envelope->message_id << std::endl;
+            auto envelope = receive_and_ack_proto(1000);
+            if (envelope) {
+                progress.add(0);
+                if (verbose) {
+                    log_debug() << " [Receiver " << receiver_id << "] Received message "
+                                << envelope->message_id();
+                }
             }
         }
 
-        stats.end_time = get_timestamp_ms();
+        stats.end_ns = get_steady_ns();
+        flush_log();
         
         if (verbose) {
             std::cout << " [x] Receiver " << receiver_id << " shutting down (received " 
@@ -153,151 +307,710 @@ public:
     bool is_running() const {
         return _running;
     }
+
+private:
+    void _allocate_messages() {
+        _request = google::protobuf::Arena::CreateMessage<::messaging::MessageEnvelope>(&_arena);
+        _ack = google::protobuf::Arena::CreateMessage<::messaging::MessageEnvelope>(&_arena);
+    }
+
+    // Same fields as _create_ack, written into the reused arena ACK, plus the receiver timing
+    void _fill_ack(const ::messaging::MessageEnvelope& original, const message_helpers::ReceiveTiming& timing) {
+        int64_t now_us = get_timestamp_us();
+
+        _ack->Clear();
+        _ack->mutable_message_id()->assign("ack_").append(original.message_id());
+        _ack->set_target(original.target());
+        _ack->set_type(::messaging::ACK);
+        _ack->set_routing(::messaging::REQUEST_REPLY);
+        _ack->set_timestamp(now_us / 1000);
+        _ack->set_timestamp_us(now_us);
+
+        ::messaging::Acknowledgment* ack = _ack->mutable_ack();
+        ack->set_original_message_id(original.message_id());
+        ack->set_original_message_seq(original.message_seq());
+        ack->set_received(true);
+        message_helpers::stamp_ack_timing(ack, original, timing);
+        ack->set_receiver_id(_receiver_name);
+        ack->set_status("OK");
+        ack->set_status_code(::messaging::ACK_STATUS_OK);
+
+        auto reply_to = original.metadata().find("reply_to");
+        if (reply_to != original.metadata().end()) {
+            (*_ack->mutable_metadata())["reply_to"] = reply_to->second;
+        }
+    }
 };
 
 // ============================================================================
 // ZeroMQ Receiver Implementation
 // ============================================================================
 
+#ifdef UNIFIED_HAVE_ZMQ
+/**
+ * ROUTER socket bound on 5556 + id, answering REQ and DEALER senders alike.
+ * The received body stays in a zmq::message_t that the view points into.
+ */
 class ZeroMQReceiver : public UnifiedReceiver {
 private:
-    void* _context = nullptr;
-    void* _socket = nullptr;
+    std::shared_ptr<zmq::context_t> _context;
+    std::shared_ptr<zmq::context_t> _shared_context;  // given by the owner, kept across reconnects
+    std::unique_ptr<zmq::socket_t> _socket;
     int _port;
-    std::vector<uint8_t> _pending_reply;
-    bool _has_pending_reply = false;
+    zmq::message_t _identity;  // peer of the last request
+    zmq::message_t _request;
 
 public:
     ZeroMQReceiver(int id) : UnifiedReceiver(id, "ZeroMQ"), _port(5556 + id) {}
+    // One context (and its I/O thread) shared by every receiver a ReceiverHost runs
+    ZeroMQReceiver(int id, std::shared_ptr<zmq::context_t> context)
+        : UnifiedReceiver(id, "ZeroMQ"), _shared_context(std::move(context)), _port(5556 + id) {}
+    ~ZeroMQReceiver() override { disconnect(); }
 
     bool connect() override {
-        // Note: ZMQ headers must be included by the user
-        // This is a placeholder - actual implementation requires zmq.hpp
-        return false; // Override in actual implementation
+        disconnect();
+        try {
+            _context = _shared_context ? _shared_context : std::make_shared<zmq::context_t>(1);
+            _socket = std::make_unique<zmq::socket_t>(*_context, ZMQ_ROUTER);
+            _socket->setsockopt(ZMQ_LINGER, 0);
+            _socket->bind("tcp://*:" + std::to_string(_port));
+            return true;
+        } catch (const zmq::error_t& e) {
+            std::cerr << " [!] ZeroMQ bind failed: " << e.what() << std::endl;
+            disconnect();
+            return false;
+        }
     }
 
     void disconnect() override {
-        // Cleanup ZMQ resources
+        _socket.reset();
+        _context.reset();
+    }
+
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        if (!_socket) {
+            return std::nullopt;
+        }
+        zmq::pollitem_t item = {static_cast<void*>(*_socket), 0, ZMQ_POLLIN, 0};
+        if (zmq::poll(&item, 1, std::chrono::milliseconds(timeout_ms)) <= 0 ||
+            !_socket->recv(_identity, zmq::recv_flags::none)) {
+            return std::nullopt;
+        }
+        // Frames are [peer identity, empty delimiter, body]; the body is the last one
+        bool more = _identity.more();
+        while (more) {
+            if (!_socket->recv(_request, zmq::recv_flags::none)) {
+                return std::nullopt;
+            }
+            more = _request.more();
+        }
+        if (_request.size() == 0) {
+            return std::nullopt;
+        }
+        return ByteView{static_cast<const uint8_t*>(_request.data()), _request.size()};
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        return _socket &&
+               _socket->send(_identity, zmq::send_flags::sndmore) &&
+               _socket->send(zmq::message_t(), zmq::send_flags::sndmore) &&
+               _socket->send(zmq::buffer(data, size), zmq::send_flags::none);
     }
 
     std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
-        return std::nullopt; // Override in actual implementation
+        return _copy_of_view(timeout_ms);
     }
 
     bool _send_raw(const std::vector<uint8_t>& data) override {
-        return false; // Override in actual implementation
+        return _send_view(data.data(), data.size());
+    }
+
+    std::vector<int> poll_fds() const override {
+        if (!_socket) {
+            return {};
+        }
+        return {_socket->getsockopt<int>(ZMQ_FD)};
+    }
+
+    // ZMQ_FD only signals state changes; queued frames show up in ZMQ_EVENTS
+    bool _has_pending() const override {
+        return _socket && (_socket->getsockopt<int>(ZMQ_EVENTS) & ZMQ_POLLIN);
     }
 
     int get_port() const { return _port; }
 };
+#endif // UNIFIED_HAVE_ZMQ
 
 // ============================================================================
 // Redis Receiver Implementation  
 // ============================================================================
 
+#ifdef UNIFIED_HAVE_REDIS
+/**
+ * Subscribed and publishing connections kept for the receiver's lifetime. The
+ * view points into the last redisReply, freed on the next receive; ACKs go to
+ * the request's reply_to metadata, or "reply_<message id>" without one.
+ */
 class RedisReceiver : public UnifiedReceiver {
 private:
     std::string _host;
     int _port;
     std::string _channel_name;
-    void* _redis_sub = nullptr;  // redisContext*
-    void* _redis_pub = nullptr;  // redisContext*
+    redisContext* _redis_sub = nullptr;
+    redisContext* _redis_pub = nullptr;
+    redisReply* _message = nullptr;  // last delivery, backing the current view
+    int _sub_timeout_ms = -1;        // read timeout currently set on _redis_sub
     std::string _pending_reply_to;
 
+    void _release_message() {
+        if (_message) {
+            freeReplyObject(_message);
+            _message = nullptr;
+        }
+    }
+
 public:
     RedisReceiver(int id, const std::string& host = "127.0.0.1", int port = 6379)
         : UnifiedReceiver(id, "Redis"), _host(host), _port(port) {
         _channel_name = "test_channel_" + std::to_string(id);
     }
+    ~RedisReceiver() override { disconnect(); }
 
     bool connect() override {
-        return false; // Override in actual implementation
+        disconnect();
+        _redis_sub = redisConnect(_host.c_str(), _port);
+        _redis_pub = redisConnect(_host.c_str(), _port);
+        if (!_redis_sub || _redis_sub->err || !_redis_pub || _redis_pub->err) {
+            disconnect();
+            return false;
+        }
+        redisReply* reply = (redisReply*)redisCommand(_redis_sub, "SUBSCRIBE %s", _channel_name.c_str());
+        if (!reply) {
+            disconnect();
+            return false;
+        }
+        freeReplyObject(reply);
+        return true;
     }
 
-    void disconnect() override {}
+    void disconnect() override {
+        _release_message();
+        if (_redis_sub) {
+            redisFree(_redis_sub);
+            _redis_sub = nullptr;
+        }
+        if (_redis_pub) {
+            redisFree(_redis_pub);
+            _redis_pub = nullptr;
+        }
+        _sub_timeout_ms = -1;
+    }
+
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        _release_message();
+        if (!_redis_sub) {
+            return std::nullopt;
+        }
+        if (timeout_ms != _sub_timeout_ms) {
+            struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+            redisSetTimeout(_redis_sub, tv);
+            _sub_timeout_ms = timeout_ms;
+        }
+        redisReply* reply = nullptr;
+        if (redisGetReply(_redis_sub, (void**)&reply) != REDIS_OK || !reply) {
+            if (_redis_sub->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EINTR || errno == 0)) {
+                // Timed out; clear the error so the connection stays usable
+                _redis_sub->err = 0;
+                memset(_redis_sub->errstr, 0, sizeof(_redis_sub->errstr));
+            }
+            return std::nullopt;
+        }
+        if (reply->type != REDIS_REPLY_ARRAY || reply->elements < 3 ||
+            reply->element[0]->type != REDIS_REPLY_STRING || strcmp(reply->element[0]->str, "message") != 0) {
+            freeReplyObject(reply);
+            return std::nullopt;
+        }
+        _message = reply;
+        return ByteView{reinterpret_cast<const uint8_t*>(reply->element[2]->str), reply->element[2]->len};
+    }
+
+    void _on_request(const ::messaging::MessageEnvelope& request) override {
+        auto reply_to = request.metadata().find("reply_to");
+        if (reply_to != request.metadata().end()) {
+            _pending_reply_to = reply_to->second;
+        } else {
+            _pending_reply_to.assign("reply_").append(request.message_id());
+        }
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        if (!_redis_pub || _pending_reply_to.empty()) {
+            return false;
+        }
+        redisReply* reply = (redisReply*)redisCommand(_redis_pub, "PUBLISH %s %b",
+                                                      _pending_reply_to.c_str(), data, size);
+        if (!reply) {
+            return false;
+        }
+        freeReplyObject(reply);
+        return true;
+    }
 
     std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
-        return std::nullopt;
+        return _copy_of_view(timeout_ms);
     }
 
     bool _send_raw(const std::vector<uint8_t>& data) override {
-        return false;
+        return _send_view(data.data(), data.size());
+    }
+
+    std::vector<int> poll_fds() const override {
+        if (!_redis_sub) {
+            return {};
+        }
+        return {_redis_sub->fd};
+    }
+
+    // Replies hiredis has read but not yet parsed
+    bool _has_pending() const override {
+        return _redis_sub && _redis_sub->reader && _redis_sub->reader->pos < _redis_sub->reader->len;
     }
 
     const std::string& get_channel_name() const { return _channel_name; }
 };
+#endif // UNIFIED_HAVE_REDIS
 
 // ============================================================================
 // NATS Receiver Implementation
 // ============================================================================
 
+#ifdef UNIFIED_HAVE_NATS
+// Synchronous subscription; the view points into the last natsMsg, destroyed on the next receive
 class NatsReceiver : public UnifiedReceiver {
 private:
     std::string _host;
     int _port;
     std::string _subject;
+    natsConnection* _conn = nullptr;
+    natsConnection* _shared_conn = nullptr;  // owned by the caller, outlives this receiver
+    natsSubscription* _sub = nullptr;
+    natsMsg* _msg = nullptr;
+
+    void _release_message() {
+        if (_msg) {
+            natsMsg_Destroy(_msg);
+            _msg = nullptr;
+        }
+    }
 
 public:
     NatsReceiver(int id, const std::string& host = "localhost", int port = 4222)
         : UnifiedReceiver(id, "NATS"), _host(host), _port(port) {
         _subject = "test.subject." + std::to_string(id);
     }
+    // Subscribe over a connection shared with other receivers; NATS connections are thread-safe
+    NatsReceiver(int id, natsConnection* shared_conn)
+        : UnifiedReceiver(id, "NATS"), _port(0), _shared_conn(shared_conn) {
+        _subject = "test.subject." + std::to_string(id);
+    }
+    ~NatsReceiver() override { disconnect(); }
 
-    bool connect() override { return false; }
-    void disconnect() override {}
-    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override { return std::nullopt; }
-    bool _send_raw(const std::vector<uint8_t>& data) override { return false; }
+    bool connect() override {
+        disconnect();
+        std::string url = "nats://" + _host + ":" + std::to_string(_port);
+        if (_shared_conn) {
+            _conn = _shared_conn;
+        } else if (natsConnection_ConnectTo(&_conn, url.c_str()) != NATS_OK) {
+            disconnect();
+            return false;
+        }
+        if (natsConnection_SubscribeSync(&_sub, _conn, _subject.c_str()) != NATS_OK) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        _release_message();
+        if (_sub) {
+            natsSubscription_Destroy(_sub);
+            _sub = nullptr;
+        }
+        if (_conn && _conn != _shared_conn) {
+            natsConnection_Destroy(_conn);
+        }
+        _conn = nullptr;
+    }
+
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        _release_message();
+        if (!_sub || natsSubscription_NextMsg(&_msg, _sub, timeout_ms) != NATS_OK) {
+            _msg = nullptr;
+            return std::nullopt;
+        }
+        return ByteView{reinterpret_cast<const uint8_t*>(natsMsg_GetData(_msg)),
+                        static_cast<size_t>(natsMsg_GetDataLength(_msg))};
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        const char* reply = _msg ? natsMsg_GetReply(_msg) : nullptr;
+        return reply && natsConnection_Publish(_conn, reply, data, static_cast<int>(size)) == NATS_OK;
+    }
+
+    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
+        return _copy_of_view(timeout_ms);
+    }
+
+    bool _send_raw(const std::vector<uint8_t>& data) override {
+        return _send_view(data.data(), data.size());
+    }
+
+    // Delivered messages wait in the subscription's queue, not on a socket this receiver owns
+    bool _has_pending() const override {
+        int msgs = 0;
+        int bytes = 0;
+        return _sub && natsSubscription_GetPending(_sub, &msgs, &bytes) == NATS_OK && msgs > 0;
+    }
+
+    bool _pending_is_complete() const override { return true; }
 
     const std::string& get_subject() const { return _subject; }
 };
+#endif // UNIFIED_HAVE_NATS
 
 // ============================================================================
 // RabbitMQ Receiver Implementation
 // ============================================================================
 
+#ifdef UNIFIED_HAVE_RABBITMQ
+/**
+ * Auto-ack consumer on test_queue_<id>. The view points into the last
+ * amqp_envelope_t, destroyed on the next receive; ACKs are published to its
+ * reply_to with its correlation_id.
+ */
 class RabbitMQReceiver : public UnifiedReceiver {
 private:
     std::string _host;
     int _port;
     std::string _queue_name;
+    amqp_connection_state_t _conn = nullptr;
+    bool _open = false;
+    amqp_envelope_t _envelope;
+    bool _has_envelope = false;
+
+    void _release_envelope() {
+        if (_has_envelope) {
+            amqp_destroy_envelope(&_envelope);
+            _has_envelope = false;
+        }
+    }
 
 public:
     RabbitMQReceiver(int id, const std::string& host = "localhost", int port = 5672)
         : UnifiedReceiver(id, "RabbitMQ"), _host(host), _port(port) {
         _queue_name = "test_queue_" + std::to_string(id);
     }
+    ~RabbitMQReceiver() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        _conn = amqp_new_connection();
+        amqp_socket_t* socket = amqp_tcp_socket_new(_conn);
+        if (!socket || amqp_socket_open(socket, _host.c_str(), _port) != AMQP_STATUS_OK ||
+            amqp_login(_conn, "/", 0, 131072, 0, AMQP_SASL_METHOD_PLAIN, "guest", "guest").reply_type !=
+                AMQP_RESPONSE_NORMAL) {
+            disconnect();
+            return false;
+        }
+        amqp_channel_open(_conn, 1);
+        _open = amqp_get_rpc_reply(_conn).reply_type == AMQP_RESPONSE_NORMAL;
+        if (_open) {
+            amqp_queue_declare(_conn, 1, amqp_cstring_bytes(_queue_name.c_str()), 0, 0, 0, 0, amqp_empty_table);
+            amqp_basic_consume(_conn, 1, amqp_cstring_bytes(_queue_name.c_str()), amqp_empty_bytes,
+                               0, 1, 0, amqp_empty_table);
+        }
+        if (!_open || amqp_get_rpc_reply(_conn).reply_type != AMQP_RESPONSE_NORMAL) {
+            disconnect();
+            return false;
+        }
+        return true;
+    }
 
-    bool connect() override { return false; }
-    void disconnect() override {}
-    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override { return std::nullopt; }
-    bool _send_raw(const std::vector<uint8_t>& data) override { return false; }
+    void disconnect() override {
+        _release_envelope();
+        if (!_conn) {
+            return;
+        }
+        if (_open) {
+            amqp_channel_close(_conn, 1, AMQP_REPLY_SUCCESS);
+            amqp_connection_close(_conn, AMQP_REPLY_SUCCESS);
+            _open = false;
+        }
+        amqp_destroy_connection(_conn);
+        _conn = nullptr;
+    }
+
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        _release_envelope();
+        if (!_open) {
+            return std::nullopt;
+        }
+        amqp_maybe_release_buffers(_conn);
+        struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        if (amqp_consume_message(_conn, &_envelope, &tv, 0).reply_type != AMQP_RESPONSE_NORMAL) {
+            return std::nullopt;
+        }
+        _has_envelope = true;
+        return ByteView{static_cast<const uint8_t*>(_envelope.message.body.bytes), _envelope.message.body.len};
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        if (!_has_envelope || _envelope.message.properties.reply_to.len == 0) {
+            return false;
+        }
+        amqp_basic_properties_t props;
+        props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG | AMQP_BASIC_CORRELATION_ID_FLAG;
+        props.content_type = amqp_cstring_bytes("application/octet-stream");
+        props.correlation_id = _envelope.message.properties.correlation_id;
+        amqp_bytes_t message_bytes;
+        message_bytes.len = size;
+        message_bytes.bytes = (void*)data;
+        return amqp_basic_publish(_conn, 1, amqp_empty_bytes, _envelope.message.properties.reply_to,
+                                  0, 0, &props, message_bytes) == AMQP_STATUS_OK;
+    }
+
+    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
+        return _copy_of_view(timeout_ms);
+    }
+
+    bool _send_raw(const std::vector<uint8_t>& data) override {
+        return _send_view(data.data(), data.size());
+    }
+
+    std::vector<int> poll_fds() const override {
+        if (!_open) {
+            return {};
+        }
+        return {amqp_get_sockfd(_conn)};
+    }
+
+    bool _has_pending() const override {
+        return _open && (amqp_data_in_buffer(_conn) || amqp_frames_enqueued(_conn));
+    }
 
     const std::string& get_queue_name() const { return _queue_name; }
 };
+#endif // UNIFIED_HAVE_RABBITMQ
 
 // ============================================================================
 // ActiveMQ Receiver Implementation
 // ============================================================================
 
+#ifdef UNIFIED_HAVE_ACTIVEMQ
+/**
+ * Consumer on test_queue_<id>; each body is read into one reused buffer and
+ * ACKs go to the request's JMSReplyTo with its correlation id. The program
+ * must have called activemq::library::ActiveMQCPP::initializeLibrary().
+ */
 class ActiveMQReceiver : public UnifiedReceiver {
 private:
     std::string _host;
     int _port;
     std::string _queue_name;
+    std::unique_ptr<cms::Connection> _connection;
+    std::unique_ptr<cms::Session> _session;
+    std::unique_ptr<cms::Destination> _queue;
+    std::unique_ptr<cms::MessageConsumer> _consumer;
+    std::unique_ptr<cms::MessageProducer> _producer;
+    std::unique_ptr<cms::Message> _message;  // last request, for its reply address
+    std::vector<unsigned char> _body;
 
 public:
     ActiveMQReceiver(int id, const std::string& host = "localhost", int port = 61616)
         : UnifiedReceiver(id, "ActiveMQ"), _host(host), _port(port) {
         _queue_name = "test_queue_" + std::to_string(id);
     }
+    ~ActiveMQReceiver() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        try {
+            activemq::core::ActiveMQConnectionFactory factory("tcp://" + _host + ":" + std::to_string(_port));
+            _connection.reset(factory.createConnection());
+            _connection->start();
+            _session.reset(_connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+            _queue.reset(_session->createQueue(_queue_name));
+            _consumer.reset(_session->createConsumer(_queue.get()));
+            _producer.reset(_session->createProducer(nullptr));
+            _producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+            return true;
+        } catch (cms::CMSException& e) {
+            std::cerr << " [!] ActiveMQ connect failed: " << e.getMessage() << std::endl;
+            disconnect();
+            return false;
+        }
+    }
+
+    void disconnect() override {
+        try {
+            _message.reset();
+            _producer.reset();
+            _consumer.reset();
+            _queue.reset();
+            _session.reset();
+            if (_connection) {
+                _connection->close();
+                _connection.reset();
+            }
+        } catch (cms::CMSException& e) {
+            _connection.reset();
+        }
+    }
 
-    bool connect() override { return false; }
-    void disconnect() override {}
-    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override { return std::nullopt; }
-    bool _send_raw(const std::vector<uint8_t>& data) override { return false; }
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        if (!_consumer) {
+            return std::nullopt;
+        }
+        try {
+            _message.reset(_consumer->receive(timeout_ms));
+            const cms::BytesMessage* bytes = dynamic_cast<const cms::BytesMessage*>(_message.get());
+            if (!bytes) {
+                return std::nullopt;
+            }
+            int len = bytes->getBodyLength();
+            if (_body.size() < static_cast<size_t>(len)) {
+                _body.resize(len);
+            }
+            bytes->readBytes(_body.data(), len);
+            return ByteView{_body.data(), static_cast<size_t>(len)};
+        } catch (cms::CMSException& e) {
+            std::cerr << " [!] ActiveMQ receive failed: " << e.getMessage() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        if (!_message || !_message->getCMSReplyTo()) {
+            return false;
+        }
+        try {
+            std::unique_ptr<cms::BytesMessage> reply(
+                _session->createBytesMessage(data, static_cast<int>(size)));
+            reply->setCMSCorrelationID(_message->getCMSCorrelationID());
+            _producer->send(_message->getCMSReplyTo(), reply.get());
+            return true;
+        } catch (cms::CMSException& e) {
+            std::cerr << " [!] ActiveMQ reply failed: " << e.getMessage() << std::endl;
+            return false;
+        }
+    }
+
+    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
+        return _copy_of_view(timeout_ms);
+    }
+
+    bool _send_raw(const std::vector<uint8_t>& data) override {
+        return _send_view(data.data(), data.size());
+    }
 
     const std::string& get_queue_name() const { return _queue_name; }
 };
+#endif // UNIFIED_HAVE_ACTIVEMQ
+
+// ============================================================================
+// Shared-Memory Receiver Implementation
+// ============================================================================
+
+#ifdef UNIFIED_HAVE_SHM
+/**
+ * Owns the request ring shm_request_ring_name(id); the view points straight
+ * into the ring's slot, held until the next receive. ACKs go into the ring
+ * named by the request's reply_to metadata, mapped on first use and kept,
+ * since a sender's reply ring lives as long as the sender.
+ */
+class ShmReceiver : public UnifiedReceiver {
+private:
+    // How long an ACK may wait for room in a full reply ring before it is dropped
+    static constexpr int kPushTimeoutMs = 100;
+
+    ShmRingOptions _options;
+    std::unique_ptr<ShmRing> _ring;
+    std::map<std::string, std::unique_ptr<ShmRing>> _reply_rings;
+    ShmRing* _reply = nullptr;  // ring of the request being answered
+
+public:
+    explicit ShmReceiver(int id, const ShmRingOptions& options = ShmRingOptions())
+        : UnifiedReceiver(id, "SharedMemory"), _options(options) {}
+    ~ShmReceiver() override { disconnect(); }
+
+    bool connect() override {
+        disconnect();
+        try {
+            _ring = ShmRing::create(shm_request_ring_name(receiver_id), _options);
+        } catch (const std::exception& e) {
+            std::cerr << " [!] " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        _reply = nullptr;
+        _reply_rings.clear();
+        _ring.reset();
+    }
+
+    std::optional<ByteView> _receive_view(int timeout_ms) override {
+        auto message = _ring ? _ring->read(timeout_ms) : std::nullopt;
+        if (!message) {
+            return std::nullopt;
+        }
+        return ByteView{reinterpret_cast<const uint8_t*>(message->data()), message->size()};
+    }
+
+    void _on_request(const ::messaging::MessageEnvelope& request) override {
+        auto reply_to = request.metadata().find("reply_to");
+        if (reply_to == request.metadata().end()) {
+            _reply = nullptr;
+            return;
+        }
+        if (_reply && _reply->name() == reply_to->second) {
+            return;
+        }
+        auto it = _reply_rings.find(reply_to->second);
+        if (it == _reply_rings.end()) {
+            try {
+                it = _reply_rings.emplace(reply_to->second, ShmRing::open(reply_to->second)).first;
+            } catch (const std::exception& e) {
+                std::cerr << " [!] " << e.what() << std::endl;
+                _reply = nullptr;
+                return;
+            }
+        }
+        _reply = it->second.get();
+    }
+
+    bool _send_view(const uint8_t* data, size_t size) override {
+        return _reply && _reply->push(data, size, kPushTimeoutMs);
+    }
+
+    std::optional<std::vector<uint8_t>> _receive_raw(int timeout_ms) override {
+        return _copy_of_view(timeout_ms);
+    }
+
+    bool _send_raw(const std::vector<uint8_t>& data) override {
+        return _send_view(data.data(), data.size());
+    }
+
+    // Requests are in the ring, not behind a socket, and readable() sees all of them
+    bool _has_pending() const override { return _ring && _ring->readable(); }
+
+    bool _pending_is_complete() const override { return true; }
+
+    const ShmRing* ring() const { return _ring.get(); }
+};
+#endif // UNIFIED_HAVE_SHM
 
 } // namespace utils
 } // namespace messaging
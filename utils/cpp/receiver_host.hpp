@@ -0,0 +1,264 @@
+#ifndef RECEIVER_HOST_HPP
+#define RECEIVER_HOST_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "json.hpp"
+#include "receiver.hpp"
+#include "perf_counters.hpp"
+#include "cpu_affinity.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Receiver ids from a list like "0-31" or "0,2,8-11"; empty if text is malformed.
+ */
+inline std::vector<int> parse_receiver_ids(const std::string& text) {
+    std::vector<int> ids;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        std::string part = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        char* rest = nullptr;
+        long first = std::strtol(part.c_str(), &rest, 10);
+        if (rest == part.c_str() || first < 0) {
+            return {};
+        }
+        long last = first;
+        if (*rest == '-') {
+            const char* second = rest + 1;
+            last = std::strtol(second, &rest, 10);
+            if (rest == second || last < first) {
+                return {};
+            }
+        }
+        if (*rest != '\0') {
+            return {};
+        }
+        for (long id = first; id <= last; ++id) {
+            ids.push_back(static_cast<int>(id));
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+/**
+ * Many logical receivers in one process, on a fixed pool of threads.
+ *
+ *   ReceiverHost host(ids, threads, [&](int id) { return std::make_unique<RedisReceiver>(id); });
+ *   host.set_perf_counters(&perf);    // optional, from --perf-counters
+ *   return host.run(running);
+ *
+ * Each receiver keeps its own id, channel and stats; the host only decides
+ * which thread drives it. A thread waits on its receivers' sockets
+ * (poll_fds) with epoll and receives only from the ready ones, continuing
+ * while a receiver has requests already buffered (_has_pending). Receivers
+ * without sockets are checked every millisecond: a cheap _has_pending() where
+ * that is exact (NATS), otherwise a 1 ms receive. The factory may hand out
+ * receivers that share a broker connection where the client library allows
+ * it; each receiver is still only ever used from one thread.
+ */
+class ReceiverHost {
+public:
+    using Factory = std::function<std::unique_ptr<UnifiedReceiver>(int id)>;
+
+    // Requests handled per receiver per wakeup, so one busy receiver can't starve the others
+    static constexpr int kReceiveBudget = 64;
+
+    ReceiverHost(std::vector<int> ids, int threads, Factory factory)
+        : ids_(std::move(ids)), factory_(std::move(factory)) {
+        int wanted = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+        threads_ = std::max(1, std::min(wanted, static_cast<int>(ids_.size())));
+    }
+
+    // Measure the receive threads' run with perf (constructed before run(), so they inherit it)
+    void set_perf_counters(PerfCounters* perf) { perf_ = perf; }
+
+    // Size every receiver's EXACTLY_ONCE duplicate filter (--dedup-window etc.)
+    void set_dedup_options(const DedupOptions& options) { dedup_ = options; }
+
+    // Default thread count for --threads: one per core, at most one per receiver
+    static int default_threads() {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    /**
+     * Connect every receiver and run them until running is cleared, then print
+     * each receiver's shutdown line and stats. Returns 1 if any failed to connect.
+     */
+    int run(const std::atomic<bool>& running) {
+        for (int id : ids_) {
+            std::unique_ptr<UnifiedReceiver> receiver = factory_(id);
+            if (!receiver || !receiver->connect()) {
+                std::cerr << " [!] Receiver " << id << " failed to connect" << std::endl;
+                return 1;
+            }
+            receiver->configure_dedup(dedup_);
+            receivers_.push_back(std::move(receiver));
+        }
+
+        std::cout << " [*] Hosting " << receivers_.size() << " receivers (" << ids_.front() << "-"
+                  << ids_.back() << ") on " << threads_ << " threads" << std::endl;
+
+        if (perf_) {
+            perf_->start();
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threads_; ++t) {
+            threads.emplace_back([this, t, &running]() {
+                CpuAffinity::global().pin_this_thread();
+                drive(t, running);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (perf_) {
+            perf_->stop();
+        }
+
+        flush_log();
+        long long received = 0;
+        for (auto& receiver : receivers_) {
+            nlohmann::json stats(receiver->stats.get_stats());
+            const DedupFilter& dedup = receiver->dedup();
+            if (dedup.duplicates() > 0 || dedup.expired() > 0) {
+                stats["dedup"] = dedup.report();
+            }
+            std::cout << " [x] Receiver " << receiver->receiver_id << " shutting down (received "
+                      << receiver->stats.received_count << " messages) stats=" << stats.dump() << std::endl;
+            received += receiver->stats.received_count;
+            receiver->disconnect();
+        }
+        if (perf_ && perf_->enabled()) {
+            std::cout << " [*] Host hw_counters=" << perf_->to_json(received).dump() << std::endl;
+        }
+        return 0;
+    }
+
+private:
+    // Thread t drives receivers t, t + threads_, t + 2 * threads_, ...
+    void drive(int t, const std::atomic<bool>& running) {
+        std::vector<UnifiedReceiver*> mine;
+        std::vector<LogSummary*> progress;
+        for (size_t i = t; i < receivers_.size(); i += threads_) {
+            mine.push_back(receivers_[i].get());
+            progress.push_back(&AsyncLogger::global().summary(
+                " [*] Receiver " + std::to_string(receivers_[i]->receiver_id), {"received"}));
+        }
+
+        int epoll_fd = epoll_create1(0);
+        std::vector<size_t> unwatched;  // receivers without sockets, polled on every pass
+        for (size_t i = 0; i < mine.size(); ++i) {
+            std::vector<int> fds = mine[i]->poll_fds();
+            if (fds.empty()) {
+                unwatched.push_back(i);
+            }
+            for (int fd : fds) {
+                epoll_event ev = {};
+                ev.events = EPOLLIN;
+                ev.data.u64 = i;
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            }
+        }
+
+        int64_t start_ns = get_steady_ns();
+        for (UnifiedReceiver* receiver : mine) {
+            receiver->stats.start_ns = start_ns;
+        }
+
+        std::vector<char> ready(mine.size(), 0);
+        std::vector<size_t> hot;  // receivers with requests still buffered after their turn
+        epoll_event events[64];
+        while (running) {
+            int wait_ms = !hot.empty() ? 0 : (unwatched.empty() ? 100 : 1);
+            int n = epoll_wait(epoll_fd, events, 64, wait_ms);
+            for (int e = 0; e < n; ++e) {
+                ready[events[e].data.u64] = 1;
+            }
+            for (size_t i : unwatched) {
+                ready[i] = !mine[i]->_pending_is_complete() || mine[i]->_has_pending();
+            }
+            for (size_t i : hot) {
+                ready[i] = 1;
+            }
+            hot.clear();
+
+            for (size_t i = 0; i < mine.size(); ++i) {
+                if (!ready[i]) {
+                    continue;
+                }
+                ready[i] = 0;
+                int handled = 0;
+                while (handled < kReceiveBudget && mine[i]->receive_and_ack_proto(1)) {
+                    ++handled;
+                    if (!mine[i]->_has_pending()) {
+                        break;
+                    }
+                }
+                if (handled > 0) {
+                    progress[i]->add(0, handled);
+                }
+                // The socket won't signal again for requests the client library already read
+                if (mine[i]->_has_pending()) {
+                    hot.push_back(i);
+                }
+            }
+        }
+
+        int64_t end_ns = get_steady_ns();
+        for (UnifiedReceiver* receiver : mine) {
+            receiver->stats.end_ns = end_ns;
+        }
+        close(epoll_fd);
+    }
+
+    std::vector<int> ids_;
+    Factory factory_;
+    int threads_ = 1;
+    PerfCounters* perf_ = nullptr;
+    DedupOptions dedup_;
+    std::vector<std::unique_ptr<UnifiedReceiver>> receivers_;
+};
+
+/**
+ * Parse the host's --ids LIST (required) and --threads N; false after printing
+ * usage if --ids is missing or malformed.
+ */
+inline bool parse_host_args(int argc, char* argv[], std::vector<int>& ids, int& threads) {
+    threads = ReceiverHost::default_threads();
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--ids") == 0 && i + 1 < argc) {
+            ids = parse_receiver_ids(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+    if (ids.empty()) {
+        std::cerr << "Usage: " << argv[0] << " --ids 0-31 [--threads N]" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace utils
+} // namespace messaging
+
+#endif // RECEIVER_HOST_HPP
@@ -0,0 +1,244 @@
+#ifndef REQUEST_POLICY_HPP
+#define REQUEST_POLICY_HPP
+
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "json.hpp"
+#include "latency_histogram.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * How the async send engine times out, retries and hedges requests.
+ *
+ * timeout_k       - with k > 0, reply timeouts become k x the observed p99
+ *                   round trip, clamped to [timeout_min_ms, timeout_max_ms];
+ *                   0 keeps each sender's fixed timeout
+ * retries         - extra attempts for a failed message (0 = fail at once)
+ * backoff_ms      - base of the exponential backoff between attempts; the
+ *                   wait before retry n is uniform in [0, min(cap, base * 2^n)]
+ * backoff_max_ms  - the cap
+ * retry_budget    - retries and hedges allowed per first attempt, averaged
+ *                   over the run (plus a small reserve), so a broker that is
+ *                   down isn't hit with retries+1 times the load
+ * hedge_percentile - with p > 0, a duplicate of a request still unanswered
+ *                   after the observed p-th percentile round trip is sent, and
+ *                   whichever reply comes first completes the message
+ */
+struct RequestPolicyOptions {
+    double timeout_k = 0;
+    int timeout_min_ms = 5;
+    int timeout_max_ms = 1000;
+    int retries = 0;
+    int backoff_ms = 1;
+    int backoff_max_ms = 50;
+    double retry_budget = 0.1;
+    double hedge_percentile = 0;
+    uint64_t seed = 1;        // backoff jitter; the engine passes its --seed
+
+    bool adaptive() const { return timeout_k > 0; }
+    bool hedging() const { return hedge_percentile > 0; }
+    bool enabled() const { return adaptive() || retries > 0 || hedging(); }
+
+    /**
+     * Parse --adaptive-timeout K, --timeout-min-ms N, --timeout-max-ms N,
+     * --retries N, --retry-backoff-ms N, --retry-backoff-max-ms N,
+     * --retry-budget F and --hedge-after P from the command line.
+     */
+    static RequestPolicyOptions from_args(int argc, char* argv[]) {
+        RequestPolicyOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--adaptive-timeout") == 0 && i + 1 < argc) {
+                options.timeout_k = std::max(0.0, std::stod(argv[++i]));
+            } else if (std::strcmp(argv[i], "--timeout-min-ms") == 0 && i + 1 < argc) {
+                options.timeout_min_ms = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--timeout-max-ms") == 0 && i + 1 < argc) {
+                options.timeout_max_ms = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--retries") == 0 && i + 1 < argc) {
+                options.retries = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--retry-backoff-ms") == 0 && i + 1 < argc) {
+                options.backoff_ms = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--retry-backoff-max-ms") == 0 && i + 1 < argc) {
+                options.backoff_max_ms = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--retry-budget") == 0 && i + 1 < argc) {
+                options.retry_budget = std::max(0.0, std::stod(argv[++i]));
+            } else if (std::strcmp(argv[i], "--hedge-after") == 0 && i + 1 < argc) {
+                options.hedge_percentile = std::min(99.9, std::max(0.0, std::stod(argv[++i])));
+            }
+        }
+        options.timeout_max_ms = std::max(options.timeout_max_ms, options.timeout_min_ms);
+        return options;
+    }
+};
+
+/**
+ * Timeouts, retry decisions and hedge delays derived from observed latency.
+ *
+ * Every attempt's round trip is fed to observe(); timeouts are observed at
+ * their full length, so a timeout that is too tight raises the p99 it is
+ * derived from instead of hiding the slow replies. Percentiles come from the
+ * last few thousand attempts, so the policy follows a broker that slows down
+ * or recovers during the run, and are recomputed every kRefreshEvery
+ * observations rather than on each call. Until kMinSamples have been seen the
+ * sender's own timeout applies and no hedges are sent.
+ *
+ * Thread-safe; shared by every engine worker.
+ */
+class RequestPolicy {
+public:
+    static constexpr uint64_t kMinSamples = 100;
+    static constexpr uint64_t kWindow = 4096;
+    static constexpr uint64_t kRefreshEvery = 64;
+    static constexpr double kBudgetReserve = 10;
+
+    explicit RequestPolicy(const RequestPolicyOptions& options = RequestPolicyOptions())
+        : options_(options), rng_(options.seed), tokens_(kBudgetReserve) {}
+
+    const RequestPolicyOptions& options() const { return options_; }
+
+    // Reply timeout to use now; default_ms unless adaptive timeouts are on and warmed up
+    int timeout_ms(int default_ms) const {
+        int64_t p99_ns = p99_ns_.load(std::memory_order_relaxed);
+        if (!options_.adaptive() || p99_ns <= 0) {
+            return default_ms;
+        }
+        double ms = options_.timeout_k * p99_ns / 1e6;
+        return static_cast<int>(std::min<double>(options_.timeout_max_ms, std::max<double>(options_.timeout_min_ms, ms)));
+    }
+
+    // How long an attempt may go unanswered before it is hedged; -1 when not hedging (yet)
+    int64_t hedge_delay_ns() const {
+        return options_.hedging() ? hedge_ns_.load(std::memory_order_relaxed) : -1;
+    }
+
+    // Record one attempt's round trip (its full wait if it timed out)
+    void observe(int64_t round_trip_ns) {
+        std::lock_guard<std::mutex> lock(mu_);
+        current_.record_ns(round_trip_ns);
+        if (current_.count() >= kWindow) {
+            std::swap(previous_, current_);
+            current_.reset();
+        }
+        if (++observed_ % kRefreshEvery == 0) {
+            const LatencyHistogram& recent = current_.count() >= kMinSamples ? current_ : previous_;
+            if (recent.count() >= kMinSamples) {
+                p99_ns_.store(recent.value_at_percentile(99), std::memory_order_relaxed);
+                if (options_.hedging()) {
+                    hedge_ns_.store(recent.value_at_percentile(options_.hedge_percentile), std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    // A first attempt was sent: it earns retry_budget tokens toward later retries and hedges
+    void on_first_attempt() {
+        std::lock_guard<std::mutex> lock(mu_);
+        tokens_ = std::min(tokens_ + options_.retry_budget, kBudgetReserve + options_.retry_budget * kWindow);
+    }
+
+    /**
+     * Whether a failed message may have attempt number next (1 for the first
+     * retry); spends a budget token when it may.
+     */
+    bool allow_retry(int next) {
+        if (next > options_.retries) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mu_);
+        if (tokens_ < 1) {
+            retries_denied_++;
+            return false;
+        }
+        tokens_ -= 1;
+        retries_++;
+        return true;
+    }
+
+    // Whether a due hedge may start now; spends a budget token when it may
+    bool allow_hedge() {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (tokens_ < 1) {
+            hedges_denied_++;
+            return false;
+        }
+        tokens_ -= 1;
+        hedges_++;
+        return true;
+    }
+
+    // Full-jitter exponential backoff before attempt number attempt (>= 1)
+    int64_t backoff_ns(int attempt) {
+        int shift = std::min(attempt - 1, 20);
+        double cap_ms = std::min<double>(options_.backoff_max_ms, static_cast<double>(options_.backoff_ms) * (1 << shift));
+        std::lock_guard<std::mutex> lock(mu_);
+        std::uniform_real_distribution<double> jitter(0.0, cap_ms * 1e6);
+        return static_cast<int64_t>(jitter(rng_));
+    }
+
+    void record_hedge_win() { hedge_wins_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * Settings and what the policy did, for the report. The observed p99,
+     * final timeout and final hedge delay are left out until kMinSamples
+     * round trips have set them; samples says how many were seen.
+     */
+    nlohmann::json report() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        nlohmann::json report = {
+            {"adaptive_timeout", options_.adaptive()},
+            {"retries", options_.retries},
+            {"retry_budget", options_.retry_budget},
+            {"retries_sent", retries_},
+            {"retries_denied", retries_denied_},
+            {"hedges_sent", hedges_},
+            {"hedges_denied", hedges_denied_},
+            {"hedge_wins", hedge_wins_.load(std::memory_order_relaxed)},
+            {"samples", observed_}
+        };
+        if (options_.adaptive()) {
+            report["timeout_k"] = options_.timeout_k;
+            int64_t p99_ns = p99_ns_.load(std::memory_order_relaxed);
+            if (p99_ns > 0) {
+                report["observed_p99_ms"] = p99_ns / 1e6;
+                report["final_timeout_ms"] = timeout_ms(0);
+            }
+        }
+        if (options_.hedging()) {
+            report["hedge_percentile"] = options_.hedge_percentile;
+            int64_t hedge_ns = hedge_ns_.load(std::memory_order_relaxed);
+            if (hedge_ns >= 0) {
+                report["final_hedge_delay_ms"] = hedge_ns / 1e6;
+            }
+        }
+        return report;
+    }
+
+private:
+    RequestPolicyOptions options_;
+
+    mutable std::mutex mu_;
+    LatencyHistogram current_;
+    LatencyHistogram previous_;
+    uint64_t observed_ = 0;
+    std::mt19937_64 rng_;
+    double tokens_;
+    int64_t retries_ = 0;
+    int64_t retries_denied_ = 0;
+    int64_t hedges_ = 0;
+    int64_t hedges_denied_ = 0;
+
+    std::atomic<int64_t> p99_ns_{0};
+    std::atomic<int64_t> hedge_ns_{-1};
+    std::atomic<int64_t> hedge_wins_{0};
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // REQUEST_POLICY_HPP
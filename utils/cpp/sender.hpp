@@ -7,8 +7,13 @@
 #include <optional>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <future>
+#include <functional>
+#include <atomic>
 #include "json.hpp"
 #include "messaging_utils.hpp"
+#include "correlation_table.hpp"
 
 namespace messaging {
 namespace utils {
@@ -34,7 +39,9 @@ class UnifiedSender {
 public:
     std::string service_name;
     std::string language;
+    // Run boundaries; per-message results are recorded into send_stats
     MessagingStats stats;
+    ShardedStats send_stats;
 
 public:
     UnifiedSender(const std::string& service, const std::string& lang = "C++")
@@ -55,6 +62,36 @@ public:
     virtual std::optional<MessageEnvelope> _send_with_ack(
         const MessageEnvelope& envelope, int timeout_ms) = 0;
 
+    // True if the backend implements _send_request/_poll_replies for send_async
+    virtual bool supports_async() const { return false; }
+
+    // Send envelope with a reply address that _poll_replies reads; must not wait for the ACK
+    virtual bool _send_request(const MessageEnvelope& envelope) { return false; }
+
+    // Read the replies that arrive within wait_ms, passing each to _deliver_reply
+    virtual void _poll_replies(int wait_ms) {}
+
+    // Sockets an event loop can wait on for replies; empty if the backend has none to offer
+    virtual std::vector<int> poll_fds() const { return {}; }
+
+    /**
+     * Delivery guarantee for messages sent from now on.
+     *
+     * AT_MOST_ONCE (the default) sends each message once. AT_LEAST_ONCE and
+     * EXACTLY_ONCE keep the request as a retransmit buffer until its ACK
+     * arrives, resending the same envelope (same message_seq) each time
+     * timeout_ms passes without one, up to max_retransmits times; receivers
+     * drop EXACTLY_ONCE redeliveries with a DedupFilter and ACK them again.
+     * Only messages sent with an ACK (send with wait_for_ack, send_async) are
+     * retransmitted. Resends are counted as duplicate_count in collect_stats().
+     */
+    void set_qos(QoSLevel level, int max_retransmits = 3) {
+        _qos = level;
+        _max_retransmits = std::max(0, max_retransmits);
+    }
+
+    QoSLevel qos() const { return _qos; }
+
     /**
      * Send a message to a target receiver.
      */
@@ -67,27 +104,24 @@ public:
         const std::map<std::string, std::string>& metadata = {}
     ) {
         SendResult result;
-        
-        // Build message envelope
-        MessageEnvelope envelope;
-        envelope.message_id = MessageEnvelope::generate_message_id();
-        envelope.target = target;
-        envelope.topic = topic;
-        envelope.type = MessageType::DATA_MESSAGE;
-        envelope.routing = RoutingMode::REQUEST_REPLY;
-        envelope.timestamp = get_timestamp_ms();
-        envelope.payload = std::vector<uint8_t>(payload.begin(), payload.end());
-        envelope.metadata = metadata;
+        MessageEnvelope envelope = _build_envelope(target, payload, topic, metadata);
         
         result.message_id = envelope.message_id;
-        int64_t start_time = get_timestamp_ms();
+        int retransmits = _qos == QoSLevel::AT_MOST_ONCE ? 0 : _max_retransmits;
+        int64_t start_ns = get_steady_ns();
+        int64_t latency_ns = 0;
 
         try {
             if (wait_for_ack) {
                 auto ack = _send_with_ack(envelope, timeout_ms);
+                for (int r = 0; !ack && r < retransmits; ++r) {
+                    _retransmits.fetch_add(1, std::memory_order_relaxed);
+                    ack = _send_with_ack(envelope, timeout_ms);
+                }
                 if (ack) {
                     result.success = true;
-                    result.latency_ms = static_cast<double>(get_timestamp_ms() - start_time);
+                    latency_ns = get_steady_ns() - start_ns;
+                    result.latency_ms = latency_ns / 1e6;
                     
                     // Read ACK from proto ack field (or fallback to JSON payload)
                     if (ack->ack) {
@@ -107,46 +141,164 @@ public:
                         } catch (...) {}
                     }
                     
-                    stats.record_send(result.success, result.latency_ms);
+                    send_stats.record(result.success, latency_ns);
                 } else {
                     result.success = false;
                     result.error = "Timeout or no response";
-                    stats.record_send(false);
+                    send_stats.record(false);
                 }
             } else {
                 result.success = _send_raw(envelope);
-                result.latency_ms = static_cast<double>(get_timestamp_ms() - start_time);
-                stats.record_send(result.success, result.latency_ms);
+                latency_ns = get_steady_ns() - start_ns;
+                result.latency_ms = latency_ns / 1e6;
+                send_stats.record(result.success, latency_ns);
             }
         } catch (const std::exception& e) {
             result.success = false;
             result.error = e.what();
-            stats.record_send(false);
+            send_stats.record(false);
         }
 
         return result;
     }
 
+    using SendCallback = std::function<void(const SendResult& result)>;
+
+    /**
+     * Send a message without waiting for its ACK.
+     *
+     * The request is tracked in a correlation table keyed by message_seq, with
+     * its timeout on a timer wheel. on_done runs on the thread calling
+     * poll_async() once the ACK arrives or timeout_ms passes, or right away if
+     * the request could not be sent. Use either this or send() with ACKs on a
+     * sender, not both: send() discards replies it is not waiting for.
+     */
+    void send_async(
+        int target,
+        const std::string& payload,
+        SendCallback on_done,
+        int timeout_ms = 5000,
+        const std::string& topic = "",
+        const std::map<std::string, std::string>& metadata = {}
+    ) {
+        MessageEnvelope envelope = _build_envelope(target, payload, topic, metadata);
+        if (!supports_async()) {
+            SendResult result;
+            result.message_id = envelope.message_id;
+            result.error = "Async send not supported";
+            _finish(result, on_done);
+            return;
+        }
+
+        int64_t now_ns = get_steady_ns();
+        PendingSend pending{now_ns, std::move(on_done)};
+        if (_qos != QoSLevel::AT_MOST_ONCE && _max_retransmits > 0) {
+            pending.retransmit = std::make_unique<MessageEnvelope>(envelope);
+            pending.retransmits_left = _max_retransmits;
+            pending.timeout_ms = timeout_ms;
+        }
+        _pending.insert(envelope.message_seq, std::move(pending));
+        _timers.schedule(now_ns + timeout_ms * 1000000LL, envelope.message_seq);
+
+        std::string error = "Send failed";
+        bool sent = false;
+        try {
+            sent = _send_request(envelope);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (!sent) {
+            _fail_pending(envelope.message_seq, error);
+        }
+    }
+
+    // As above, returning a future that becomes ready during a later poll_async()
+    std::future<SendResult> send_async(int target, const std::string& payload, int timeout_ms = 5000) {
+        auto promise = std::make_shared<std::promise<SendResult>>();
+        std::future<SendResult> future = promise->get_future();
+        send_async(target, payload, [promise](const SendResult& result) { promise->set_value(result); },
+                   timeout_ms);
+        return future;
+    }
+
+    /**
+     * Wait up to wait_ms for ACKs, then time out overdue requests.
+     * @return Number of async requests completed by this call
+     */
+    size_t poll_async(int wait_ms) {
+        size_t before = _completed;
+        try {
+            _poll_replies(wait_ms);
+        } catch (const std::exception& e) {
+            std::cerr << " [!] Error reading replies: " << e.what() << std::endl;
+        }
+        _timers.advance(get_steady_ns(), [this](const uint64_t& message_seq) {
+            _expire_pending(message_seq);
+        });
+        return _completed - before;
+    }
+
+    // Async requests sent and not yet completed
+    size_t pending_async() const { return _pending.size(); }
+
+    // Poll until every async request has completed or timed out
+    void drain_async() {
+        while (!_pending.empty()) {
+            poll_async(10);
+        }
+    }
+
+    /**
+     * Aggregate run boundaries and every thread's send_stats shard.
+     */
+    MessagingStats collect_stats() const {
+        MessagingStats total = stats;
+        total.merge(send_stats);
+        total.duplicate_count += _retransmits.load(std::memory_order_relaxed);
+        return total;
+    }
+
     /**
      * Run a performance test and return statistics.
      */
     std::map<std::string, double> run_performance_test(
         const json& test_data,
         bool wait_for_ack = true,
-        int timeout_ms = 40
+        int timeout_ms = 40,
+        int pipeline_depth = 1
     ) {
-        stats = MessagingStats();  // Reset stats
-        stats.start_time = get_timestamp_ms();
-
+        // Encode payloads before the clock starts so JSON work isn't timed
+        std::vector<std::pair<int, std::string>> messages;
+        messages.reserve(test_data.size());
         for (const auto& item : test_data) {
-            int target = item.value("target", 0);
-            std::string payload = item.dump();
-            
-            send(target, payload, "", wait_for_ack, timeout_ms);
+            messages.emplace_back(item.value("target", 0), item.dump());
         }
 
-        stats.end_time = get_timestamp_ms();
-        return stats.get_stats();
+        stats = MessagingStats();  // Reset stats
+        send_stats.reset();
+        _retransmits = 0;
+        stats.start_ns = get_steady_ns();
+
+        if (pipeline_depth > 1 && wait_for_ack && supports_async()) {
+            // Keep up to pipeline_depth requests outstanding over each target's one connection
+            size_t window = static_cast<size_t>(pipeline_depth);
+            SendCallback ignore = [](const SendResult&) {};
+            for (const auto& message : messages) {
+                while (pending_async() >= window) {
+                    poll_async(10);
+                }
+                send_async(message.first, message.second, ignore, timeout_ms);
+                poll_async(0);
+            }
+            drain_async();
+        } else {
+            for (const auto& message : messages) {
+                send(message.first, message.second, "", wait_for_ack, timeout_ms);
+            }
+        }
+
+        stats.end_ns = get_steady_ns();
+        return collect_stats().get_stats();
     }
 
     /**
@@ -200,129 +352,144 @@ public:
             return false;
         }
     }
-};
 
-// ============================================================================
-// ZeroMQ Sender Implementation
-// ============================================================================
-
-class ZeroMQSender : public UnifiedSender {
-private:
-    void* _context = nullptr;
-    std::map<int, void*> _sockets;  // target -> socket
-
-public:
-    ZeroMQSender() : UnifiedSender("ZeroMQ") {}
-
-    bool connect() override { return false; }
-    void disconnect() override {}
-    bool _send_raw(const MessageEnvelope& envelope) override { return false; }
-    std::optional<MessageEnvelope> _send_with_ack(const MessageEnvelope& envelope, int timeout_ms) override {
-        return std::nullopt;
+protected:
+    /**
+     * Serialize envelope into a reused buffer, valid until the next call.
+     * reply_to, if given, is added to the metadata for receivers that reply over Pub/Sub.
+     */
+    const std::string& _encode(const MessageEnvelope& envelope, const std::string& reply_to = "") {
+        // Encoded straight from the envelope's fields, with no proto copy of the payload
+        EnvelopeView view = envelope.view();
+        if (!reply_to.empty()) {
+            view.add_metadata("reply_to", reply_to);
+        }
+        return view.encode(_wire);
     }
 
-    int get_port(int target) const { return 5556 + target; }
-};
-
-// ============================================================================
-// Redis Sender Implementation
-// ============================================================================
-
-class RedisSender : public UnifiedSender {
-private:
-    std::string _host;
-    int _port;
-    void* _redis = nullptr;
-
-public:
-    RedisSender(const std::string& host = "127.0.0.1", int port = 6379)
-        : UnifiedSender("Redis"), _host(host), _port(port) {}
-
-    bool connect() override { return false; }
-    void disconnect() override {}
-    bool _send_raw(const MessageEnvelope& envelope) override { return false; }
-    std::optional<MessageEnvelope> _send_with_ack(const MessageEnvelope& envelope, int timeout_ms) override {
-        return std::nullopt;
+    // Parse a reply into a reused message; true if it is the ACK for message_seq
+    bool _decode_ack(const void* data, size_t size, uint64_t message_seq) {
+        return _in.ParseFromArray(data, static_cast<int>(size)) &&
+               _in.has_ack() && _acked_seq(_in.ack()) == message_seq;
     }
 
-    std::string get_channel_name(int target) const { 
-        return "test_channel_" + std::to_string(target); 
+    // message_seq an ACK answers; receivers that only echo the string id are matched by parsing it
+    static uint64_t _acked_seq(const ::messaging::Acknowledgment& ack) {
+        if (ack.original_message_seq()) {
+            return ack.original_message_seq();
+        }
+        return parse_message_id(ack.original_message_id()).value_or(0);
     }
-};
 
-// ============================================================================
-// NATS Sender Implementation
-// ============================================================================
-
-class NatsSender : public UnifiedSender {
-private:
-    std::string _host;
-    int _port;
-
-public:
-    NatsSender(const std::string& host = "localhost", int port = 4222)
-        : UnifiedSender("NATS"), _host(host), _port(port) {}
-
-    bool connect() override { return false; }
-    void disconnect() override {}
-    bool _send_raw(const MessageEnvelope& envelope) override { return false; }
-    std::optional<MessageEnvelope> _send_with_ack(const MessageEnvelope& envelope, int timeout_ms) override {
-        return std::nullopt;
+    // The reply accepted by the last successful _decode_ack
+    MessageEnvelope _last_ack() const {
+        return MessageEnvelope::from_proto(_in);
     }
 
-    std::string get_subject(int target) const { 
-        return "test.subject." + std::to_string(target); 
+    // Complete the async request a reply acknowledges; replies to unknown or timed-out requests are ignored
+    void _deliver_reply(const void* data, size_t size) {
+        if (!_in.ParseFromArray(data, static_cast<int>(size)) || !_in.has_ack()) {
+            return;
+        }
+        auto pending = _pending.take(_acked_seq(_in.ack()));
+        if (!pending) {
+            return;
+        }
+        SendResult result;
+        result.message_id = _in.ack().original_message_id();
+        result.receiver_id = _in.ack().receiver_id();
+        result.success = _in.ack().received();
+        if (!result.success) {
+            result.error = _in.ack().status();
+        }
+        int64_t latency_ns = get_steady_ns() - pending->start_ns;
+        result.latency_ms = latency_ns / 1e6;
+        _finish(result, pending->on_done, latency_ns);
     }
-};
 
-// ============================================================================
-// RabbitMQ Sender Implementation
-// ============================================================================
-
-class RabbitMQSender : public UnifiedSender {
 private:
-    std::string _host;
-    int _port;
+    struct PendingSend {
+        int64_t start_ns;
+        SendCallback on_done;
+        // Retransmit buffer: set for AT_LEAST_ONCE / EXACTLY_ONCE requests
+        std::unique_ptr<MessageEnvelope> retransmit;
+        int retransmits_left = 0;
+        int timeout_ms = 0;
+    };
+
+    MessageEnvelope _build_envelope(int target, const std::string& payload, const std::string& topic,
+                                    const std::map<std::string, std::string>& metadata) const {
+        MessageEnvelope envelope;  // constructed with a fresh message_seq and id
+        envelope.target = target;
+        envelope.topic = topic;
+        envelope.type = MessageType::DATA_MESSAGE;
+        envelope.routing = RoutingMode::REQUEST_REPLY;
+        envelope.qos = _qos;
+        envelope.timestamp_us = get_timestamp_us();
+        envelope.timestamp = envelope.timestamp_us / 1000;
+        envelope.payload = std::vector<uint8_t>(payload.begin(), payload.end());
+        envelope.metadata = metadata;
+        return envelope;
+    }
 
-public:
-    RabbitMQSender(const std::string& host = "localhost", int port = 5672)
-        : UnifiedSender("RabbitMQ"), _host(host), _port(port) {}
-
-    bool connect() override { return false; }
-    void disconnect() override {}
-    bool _send_raw(const MessageEnvelope& envelope) override { return false; }
-    std::optional<MessageEnvelope> _send_with_ack(const MessageEnvelope& envelope, int timeout_ms) override {
-        return std::nullopt;
+    void _fail_pending(uint64_t message_seq, const std::string& error) {
+        auto pending = _pending.take(message_seq);
+        if (!pending) {
+            return;  // already acknowledged
+        }
+        SendResult result;
+        result.message_id = format_message_id(message_seq);
+        result.error = error;
+        _finish(result, pending->on_done);
     }
 
-    std::string get_queue_name(int target) const { 
-        return "test_queue_" + std::to_string(target); 
+    // A request's timeout passed: resend it from its retransmit buffer if it has one left, else fail it
+    void _expire_pending(uint64_t message_seq) {
+        auto pending = _pending.take(message_seq);
+        if (!pending) {
+            return;  // already acknowledged
+        }
+        if (pending->retransmit && pending->retransmits_left > 0) {
+            pending->retransmits_left--;
+            _retransmits.fetch_add(1, std::memory_order_relaxed);
+            bool sent = false;
+            try {
+                sent = _send_request(*pending->retransmit);
+            } catch (const std::exception&) {
+                sent = false;
+            }
+            if (sent) {
+                // Latency still runs from the first send
+                int64_t deadline_ns = get_steady_ns() + pending->timeout_ms * 1000000LL;
+                _pending.insert(message_seq, std::move(*pending));
+                _timers.schedule(deadline_ns, message_seq);
+                return;
+            }
+        }
+        SendResult result;
+        result.message_id = format_message_id(message_seq);
+        result.error = "Timeout or no response";
+        _finish(result, pending->on_done);
     }
-};
 
-// ============================================================================
-// ActiveMQ Sender Implementation
-// ============================================================================
+    void _finish(const SendResult& result, const SendCallback& on_done, int64_t latency_ns = 0) {
+        send_stats.record(result.success, latency_ns);
+        _completed++;
+        if (on_done) {
+            on_done(result);
+        }
+    }
 
-class ActiveMQSender : public UnifiedSender {
-private:
-    std::string _host;
-    int _port;
+    CorrelationTable<PendingSend, uint64_t> _pending;
+    TimerWheel<uint64_t> _timers;
+    size_t _completed = 0;
 
-public:
-    ActiveMQSender(const std::string& host = "localhost", int port = 61616)
-        : UnifiedSender("ActiveMQ"), _host(host), _port(port) {}
-
-    bool connect() override { return false; }
-    void disconnect() override {}
-    bool _send_raw(const MessageEnvelope& envelope) override { return false; }
-    std::optional<MessageEnvelope> _send_with_ack(const MessageEnvelope& envelope, int timeout_ms) override {
-        return std::nullopt;
-    }
+    QoSLevel _qos = QoSLevel::AT_MOST_ONCE;
+    int _max_retransmits = 3;
+    std::atomic<int64_t> _retransmits{0};
 
-    std::string get_queue_name(int target) const { 
-        return "test_queue_" + std::to_string(target); 
-    }
+    ::messaging::MessageEnvelope _in;
+    std::string _wire;
 };
 
 } // namespace utils
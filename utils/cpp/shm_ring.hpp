@@ -0,0 +1,430 @@
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "json.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Geometry and wait strategy of a shared-memory ring.
+ *
+ * slots        - ring length, rounded up to a power of two
+ * slot_bytes   - bytes per slot, a multiple of 64 including its 16-byte
+ *                header; a message longer than one slot's payload spans
+ *                consecutive slots, up to the whole ring
+ * busy_poll_us - how long a reader spins on an empty ring before sleeping on
+ *                the futex; 0 sleeps at once, trading a wakeup syscall per
+ *                message for an idle core
+ */
+struct ShmRingOptions {
+    int slots = 4096;
+    int slot_bytes = 512;
+    int busy_poll_us = 0;
+
+    // A sender's reply ring: ACKs are small and a sender has few requests in flight
+    ShmRingOptions for_replies() const {
+        ShmRingOptions replies = *this;
+        replies.slots = 512;
+        replies.slot_bytes = 256;
+        return replies;
+    }
+
+    // Parse --ring-slots N, --slot-bytes N and --busy-poll-us N from the command line
+    static ShmRingOptions from_args(int argc, char* argv[]) {
+        ShmRingOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--ring-slots") == 0 && i + 1 < argc) {
+                options.slots = std::max(2, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--slot-bytes") == 0 && i + 1 < argc) {
+                options.slot_bytes = std::max(64, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--busy-poll-us") == 0 && i + 1 < argc) {
+                options.busy_poll_us = std::max(0, std::stoi(argv[++i]));
+            }
+        }
+        int slots = 2;
+        while (slots < options.slots) {
+            slots <<= 1;
+        }
+        options.slots = slots;
+        options.slot_bytes = (options.slot_bytes + 63) / 64 * 64;
+        return options;
+    }
+};
+
+// Shared-memory name of receiver id's request ring
+inline std::string shm_request_ring_name(int receiver_id) {
+    return "/messaging_shm_" + std::to_string(receiver_id);
+}
+
+// A fresh name for a sender's reply ring, unique among the processes and threads of the host
+inline std::string shm_reply_ring_name() {
+    static std::atomic<uint64_t> next{0};
+    return "/messaging_shm_reply_" + std::to_string(getpid()) + "_" + std::to_string(next.fetch_add(1));
+}
+
+/**
+ * Multi-producer, single-consumer ring of byte messages in POSIX shared memory.
+ *
+ * The segment holds a small header and a power-of-two array of fixed slots,
+ * each stamped with a sequence number as in Vyukov's bounded queue: slot i is
+ * free for position p when its sequence is p and holds a message when it is
+ * p + 1. A producer claims the slots it needs with one CAS on the shared tail,
+ * copies the message in and publishes the first slot last, so the reader
+ * never sees a partial message; no lock is taken and producers in any number
+ * of processes only contend on that CAS. Slots are recycled in order by the
+ * one reader, which keeps its head privately.
+ *
+ * An idle reader spins for busy_poll_us, then sleeps on a shared futex word
+ * (an eventcount: producers only bump it and call FUTEX_WAKE when the reader
+ * said it is about to sleep), so a busy ring costs no syscalls at all.
+ *
+ *   auto ring = ShmRing::create(shm_request_ring_name(id), options);   // reader
+ *   auto peer = ShmRing::open(shm_request_ring_name(id));              // writers
+ *   peer->push(body.data(), body.size(), 100);
+ *   std::optional<std::string_view> message = ring->read(1000);
+ *
+ * create() owns the segment and unlinks it on destruction; open() throws
+ * std::runtime_error while it does not exist yet. Messages returned by read()
+ * stay valid, in place, until the next read().
+ */
+class ShmRing {
+public:
+    static constexpr uint32_t kMagic = 0x6d736872;   // "mshr"
+    static constexpr size_t kSlotHeader = 16;
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    ~ShmRing() {
+        if (base_) {
+            munmap(base_, bytes_);
+        }
+        if (owner_) {
+            shm_unlink(name_.c_str());
+        }
+    }
+
+    // Create the ring as its reader, replacing a segment left behind by an earlier run
+    static std::unique_ptr<ShmRing> create(const std::string& name, const ShmRingOptions& options) {
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno));
+        }
+        size_t slots = static_cast<size_t>(options.slots);
+        size_t slot_bytes = static_cast<size_t>(options.slot_bytes);
+        size_t bytes = kHeaderBytes + slots * slot_bytes;
+        // Reserve the pages now, so a full /dev/shm fails here instead of with SIGBUS mid-run
+        int rc = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+        void* base = rc == 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            throw std::runtime_error("shm ring " + name + " (" + std::to_string(bytes) + " bytes): " +
+                                     std::strerror(rc ? rc : errno));
+        }
+        Header* header = new (base) Header();
+        header->slots = static_cast<uint32_t>(slots);
+        header->slot_bytes = static_cast<uint32_t>(slot_bytes);
+        std::unique_ptr<ShmRing> ring(new ShmRing(name, base, bytes, true, options.busy_poll_us));
+        for (size_t i = 0; i < slots; ++i) {
+            new (ring->slot(i)) Slot();
+            ring->slot(i)->seq.store(i, std::memory_order_relaxed);
+        }
+        header->magic.store(kMagic, std::memory_order_release);
+        return ring;
+    }
+
+    // Map a ring created by another process, to write into it (or to read it, with busy_poll_us)
+    static std::unique_ptr<ShmRing> open(const std::string& name, int busy_poll_us = 0) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open " + name + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        size_t bytes = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        void* base = bytes >= kHeaderBytes ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                                           : MAP_FAILED;
+        close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("shm ring " + name + " is not ready");
+        }
+        std::unique_ptr<ShmRing> ring(new ShmRing(name, base, bytes, false, busy_poll_us));
+        const Header* header = ring->header_;
+        if (header->magic.load(std::memory_order_acquire) != kMagic ||
+            kHeaderBytes + static_cast<size_t>(header->slots) * header->slot_bytes != bytes) {
+            throw std::runtime_error("shm ring " + name + " is not ready");
+        }
+        ring->mask_ = header->slots - 1;
+        ring->slot_bytes_ = header->slot_bytes;
+        return ring;
+    }
+
+    const std::string& name() const { return name_; }
+
+    // Largest message push() accepts: every slot's payload
+    size_t max_message_bytes() const { return (mask_ + 1) * payload_bytes(); }
+
+    /**
+     * Copy one message into the ring without waiting. False when the ring has
+     * no room for it right now, or never will (size > max_message_bytes()).
+     * Safe from any number of threads and processes.
+     */
+    bool try_push(const void* data, size_t size) {
+        size_t payload = payload_bytes();
+        uint64_t span = size == 0 ? 1 : (size + payload - 1) / payload;
+        if (span > mask_ + 1) {
+            return false;
+        }
+        uint64_t pos = header_->tail.load(std::memory_order_relaxed);
+        while (true) {
+            // Slots are recycled in order, so the last one being free means all of them are
+            uint64_t last = pos + span - 1;
+            auto diff = static_cast<int64_t>(slot(last)->seq.load(std::memory_order_acquire) - last);
+            if (diff < 0) {
+                return false;
+            }
+            if (diff == 0) {
+                if (header_->tail.compare_exchange_weak(pos, pos + span, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else {
+                pos = header_->tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        const char* src = static_cast<const char*>(data);
+        size_t left = size;
+        for (uint64_t i = 0; i < span; ++i) {
+            size_t n = std::min(left, payload);
+            std::memcpy(payload_of(slot(pos + i)), src, n);
+            src += n;
+            left -= n;
+        }
+        Slot* first = slot(pos);
+        first->size = static_cast<uint32_t>(size);
+        first->span = static_cast<uint32_t>(span);
+        for (uint64_t i = span - 1; i > 0; --i) {
+            slot(pos + i)->seq.store(pos + i + 1, std::memory_order_release);
+        }
+        first->seq.store(pos + 1, std::memory_order_release);
+
+        // Pairs with the fence in read(): either the reader sees the message or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->waiting.load(std::memory_order_relaxed)) {
+            header_->signal.fetch_add(1, std::memory_order_relaxed);
+            futex(&header_->signal, FUTEX_WAKE, 1, nullptr);
+            wakes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * try_push, retrying while the ring is full for up to timeout_ms. A full
+     * ring means the reader is behind or gone, so this backs off to short
+     * sleeps rather than spinning against it.
+     */
+    bool push(const void* data, size_t size, int timeout_ms) {
+        if (try_push(data, size)) {
+            return true;
+        }
+        if (size > max_message_bytes()) {
+            return false;
+        }
+        full_.fetch_add(1, std::memory_order_relaxed);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (int attempt = 0; std::chrono::steady_clock::now() < deadline; ++attempt) {
+            if (attempt < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            if (try_push(data, size)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Next message, waiting up to timeout_ms; nullopt on timeout. The view
+     * points into the ring (into a private copy for messages spanning
+     * several slots) and holds its slots until the next read(). One reader.
+     */
+    std::optional<std::string_view> read(int timeout_ms) {
+        release();
+        if (auto message = try_read()) {
+            return message;
+        }
+        if (busy_poll_us_ > 0) {
+            auto spin_until = std::chrono::steady_clock::now() + std::chrono::microseconds(busy_poll_us_);
+            do {
+                cpu_relax();
+                if (auto message = try_read()) {
+                    return message;
+                }
+            } while (std::chrono::steady_clock::now() < spin_until);
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (true) {
+            uint32_t key = header_->signal.load(std::memory_order_relaxed);
+            header_->waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (auto message = try_read()) {
+                header_->waiting.store(0, std::memory_order_relaxed);
+                return message;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                header_->waiting.store(0, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            struct timespec ts = {static_cast<time_t>(remaining / 1000000000),
+                                  static_cast<long>(remaining % 1000000000)};
+            sleeps_++;
+            futex(&header_->signal, FUTEX_WAIT, key, &ts);
+            header_->waiting.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // True if read() would return a message without waiting
+    bool readable() const {
+        uint64_t pos = head_ + held_;
+        return slot(pos)->seq.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    // Geometry and wait counters of this mapping, for the report
+    nlohmann::json report() const {
+        return {
+            {"slots", mask_ + 1},
+            {"slot_bytes", slot_bytes_},
+            {"max_message_bytes", max_message_bytes()},
+            {"busy_poll_us", busy_poll_us_},
+            {"reader_sleeps", sleeps_},
+            {"wakeups_sent", wakes_.load(std::memory_order_relaxed)},
+            {"full_waits", full_.load(std::memory_order_relaxed)}
+        };
+    }
+
+private:
+    struct Header {
+        std::atomic<uint32_t> magic{0};
+        uint32_t slots = 0;
+        uint32_t slot_bytes = 0;
+        alignas(64) std::atomic<uint64_t> tail{0};     // next position producers claim
+        alignas(64) std::atomic<uint32_t> signal{0};   // futex word, bumped to wake the reader
+        std::atomic<uint32_t> waiting{0};              // the reader is about to sleep on signal
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        uint32_t size = 0;   // message bytes, in a message's first slot
+        uint32_t span = 0;   // slots the message occupies
+    };
+    static_assert(sizeof(Slot) == kSlotHeader, "slot header layout");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring atomics must be address-free");
+
+    static constexpr size_t kHeaderBytes = (sizeof(Header) + 63) / 64 * 64;
+
+    ShmRing(const std::string& name, void* base, size_t bytes, bool owner, int busy_poll_us)
+        : name_(name), base_(static_cast<char*>(base)), bytes_(bytes), owner_(owner),
+          busy_poll_us_(busy_poll_us), header_(static_cast<Header*>(base)) {
+        if (owner) {
+            mask_ = header_->slots - 1;
+            slot_bytes_ = header_->slot_bytes;
+        }
+    }
+
+    static long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const struct timespec* timeout) {
+        // Not FUTEX_PRIVATE_FLAG: the word is shared with other processes
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+    }
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    size_t payload_bytes() const { return slot_bytes_ - kSlotHeader; }
+
+    Slot* slot(uint64_t pos) const {
+        return reinterpret_cast<Slot*>(base_ + kHeaderBytes + (pos & mask_) * slot_bytes_);
+    }
+
+    static char* payload_of(Slot* s) { return reinterpret_cast<char*>(s) + kSlotHeader; }
+
+    std::optional<std::string_view> try_read() {
+        Slot* first = slot(head_);
+        if (first->seq.load(std::memory_order_acquire) != head_ + 1) {
+            return std::nullopt;
+        }
+        size_t size = first->size;
+        held_ = first->span;
+        if (held_ == 1) {
+            return std::string_view(payload_of(first), size);
+        }
+        // Slot headers interleave the payload, so a spanning message is gathered into one buffer
+        copy_.resize(size);
+        size_t payload = payload_bytes();
+        for (uint64_t i = 0; i < held_; ++i) {
+            size_t offset = i * payload;
+            std::memcpy(&copy_[offset], payload_of(slot(head_ + i)), std::min(payload, size - offset));
+        }
+        return std::string_view(copy_);
+    }
+
+    // Hand the slots of the last message read back to producers
+    void release() {
+        for (uint64_t i = 0; i < held_; ++i) {
+            slot(head_ + i)->seq.store(head_ + i + mask_ + 1, std::memory_order_release);
+        }
+        head_ += held_;
+        held_ = 0;
+    }
+
+    std::string name_;
+    char* base_;
+    size_t bytes_;
+    bool owner_;
+    int busy_poll_us_;
+    Header* header_;
+    uint64_t mask_ = 0;
+    size_t slot_bytes_ = 0;
+
+    uint64_t head_ = 0;   // reader only
+    uint64_t held_ = 0;   // slots behind the view read() last returned
+    std::string copy_;
+    int64_t sleeps_ = 0;
+    std::atomic<int64_t> wakes_{0};
+    std::atomic<int64_t> full_{0};
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // SHM_RING_HPP
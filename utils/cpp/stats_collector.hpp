@@ -1,11 +1,12 @@
 #ifndef STATS_COLLECTOR_HPP
 #define STATS_COLLECTOR_HPP
 
-#include <vector>
-#include <algorithm>
-#include <cmath>
 #include <chrono>
 #include "json.hpp"
+#include "latency_histogram.hpp"
+#include "latency_breakdown.hpp"
+#include "stats_shard.hpp"
+#include "live_stats.hpp"
 
 using json = nlohmann::json;
 
@@ -14,21 +15,50 @@ public:
     MessageStats() : sent_count(0), received_count(0), processed_count(0), failed_count(0) {}
     
     void record_message(bool success, double timing_ms = 0) {
+        if (live) {
+            live->record(success, timing_ms >= 0 ? static_cast<int64_t>(timing_ms * 1e6) : -1);
+        }
         sent_count++;
         if (success) {
             received_count++;
             processed_count++;
             if (timing_ms >= 0) {
-                message_timings.push_back(timing_ms);
+                message_timings.record_ms(timing_ms);
             }
         } else {
             failed_count++;
         }
     }
     
+    // Record a sample measured on the steady clock in nanoseconds
+    void record_message_ns(bool success, long long timing_ns) {
+        if (live) {
+            live->record(success, timing_ns);
+        }
+        sent_count++;
+        if (success) {
+            received_count++;
+            processed_count++;
+            message_timings.record_ns(timing_ns);
+        } else {
+            failed_count++;
+        }
+    }
+    
+    // Split an acked round trip into legs using the receiver timing its ACK carried
+    void record_breakdown(const messaging::utils::AckTiming& timing, long long round_trip_ns) {
+        breakdown.record(timing, round_trip_ns);
+    }
+    
     void set_duration(long long start_ms, long long end_ms) {
-        start_time = start_ms;
-        end_time = end_ms;
+        start_ns = start_ms * 1000000;
+        end_ns = end_ms * 1000000;
+    }
+    
+    // Run boundaries from message_helpers::get_steady_time_ns()
+    void set_duration_ns(long long start, long long end) {
+        start_ns = start;
+        end_ns = end;
     }
     
     void set_metadata(const json& meta) {
@@ -40,12 +70,66 @@ public:
     }
     
     double get_duration_ms() const {
-        if (start_time > 0 && end_time > 0) {
-            return end_time - start_time;
+        if (start_ns > 0 && end_ns > 0) {
+            return (end_ns - start_ns) / 1e6;
         }
         return 0.0;
     }
     
+    // Combine stats recorded separately, e.g. by another sender thread
+    void merge(const MessageStats& other) {
+        sent_count += other.sent_count;
+        received_count += other.received_count;
+        processed_count += other.processed_count;
+        failed_count += other.failed_count;
+        bytes_count += other.bytes_count;
+        message_timings.merge(other.message_timings);
+        breakdown.merge(other.breakdown);
+    }
+    
+    // Fold in per-thread shards; call once the recording threads are done
+    void merge(const messaging::utils::ShardedStats& shards) {
+        shards.for_each_shard([&](const messaging::utils::StatsShard& shard) { merge(shard); });
+    }
+    
+    void merge(const messaging::utils::StatsShard& shard) {
+        int64_t acked = shard.acked.load(std::memory_order_relaxed);
+        sent_count += (int)shard.sent.load(std::memory_order_relaxed);
+        received_count += (int)acked;
+        processed_count += (int)acked;
+        failed_count += (int)shard.failed.load(std::memory_order_relaxed);
+        message_timings.merge(shard.latencies);
+    }
+    
+    // Wire bytes of a delivered message, for megabytes_per_sec
+    void record_bytes(long long bytes) {
+        if (live) {
+            live->record_bytes(bytes);
+        }
+        bytes_count += bytes;
+    }
+    
+    // Message size to estimate bytes from when the send path does not record them
+    void set_mean_message_bytes(double bytes) {
+        mean_message_bytes = bytes;
+    }
+    
+    // Mirror results into recorder (nullptr detaches) for a LiveStats time series
+    void attach_live(messaging::utils::LiveRecorder* recorder) {
+        live = recorder;
+    }
+    
+    // A message handed to the broker, for the live in-flight count; safe from any thread
+    void record_dispatch() {
+        if (live) {
+            live->dispatch();
+        }
+    }
+    
+    const messaging::utils::LatencyHistogram& latency_histogram() const {
+        return message_timings;
+    }
+    
     json get_stats() const {
         json stats = metadata;
         double duration = get_duration_ms();
@@ -58,42 +142,39 @@ public:
         stats["messages_per_ms"] = duration > 0 ? (double)processed_count / duration : 0.0;
         stats["failed_per_ms"] = duration > 0 ? (double)failed_count / duration : 0.0;
         
+        double bytes = (double)bytes_count;
+        if (bytes_count == 0 && mean_message_bytes > 0) {
+            bytes = processed_count * mean_message_bytes;
+            stats["bytes_estimated"] = true;
+        }
+        if (bytes > 0) {
+            stats["bytes_processed"] = (long long)bytes;
+            stats["megabytes_per_sec"] = duration > 0 ? bytes / 1e6 / (duration / 1000.0) : 0.0;
+        }
+        
         if (!message_timings.empty()) {
             json timing_stats;
-            auto min_val = *std::min_element(message_timings.begin(), message_timings.end());
-            auto max_val = *std::max_element(message_timings.begin(), message_timings.end());
-            
-            double mean = 0;
-            for (auto t : message_timings) mean += t;
-            mean /= message_timings.size();
-            
-            timing_stats["min_ms"] = min_val;
-            timing_stats["max_ms"] = max_val;
-            timing_stats["mean_ms"] = mean;
-            timing_stats["count"] = (int)message_timings.size();
-            
-            // Calculate median
-            std::vector<double> sorted_timings = message_timings;
-            std::sort(sorted_timings.begin(), sorted_timings.end());
-            if (sorted_timings.size() % 2 == 0) {
-                timing_stats["median_ms"] = (sorted_timings[sorted_timings.size()/2 - 1] + sorted_timings[sorted_timings.size()/2]) / 2.0;
-            } else {
-                timing_stats["median_ms"] = sorted_timings[sorted_timings.size()/2];
-            }
-            
-            // Calculate standard deviation
-            if (message_timings.size() > 1) {
-                double variance = 0;
-                for (auto t : message_timings) {
-                    variance += (t - mean) * (t - mean);
-                }
-                variance /= message_timings.size();
-                timing_stats["stdev_ms"] = std::sqrt(variance);
+            timing_stats["min_ms"] = message_timings.min_ns() / 1e6;
+            timing_stats["max_ms"] = message_timings.max_ns() / 1e6;
+            timing_stats["mean_ms"] = message_timings.mean_ns() / 1e6;
+            timing_stats["count"] = (int)message_timings.count();
+            timing_stats["median_ms"] = message_timings.percentile_ms(50);
+            timing_stats["p50_ms"] = message_timings.percentile_ms(50);
+            timing_stats["p90_ms"] = message_timings.percentile_ms(90);
+            timing_stats["p99_ms"] = message_timings.percentile_ms(99);
+            timing_stats["p99_9_ms"] = message_timings.percentile_ms(99.9);
+            timing_stats["p99_99_ms"] = message_timings.percentile_ms(99.99);
+            if (message_timings.count() > 1) {
+                timing_stats["stdev_ms"] = message_timings.stdev_ns() / 1e6;
             }
             
             stats["message_timing_stats"] = timing_stats;
         }
         
+        if (!breakdown.empty()) {
+            stats["latency_breakdown"] = breakdown.to_json();
+        }
+        
         return stats;
     }
     
@@ -103,10 +184,14 @@ public:
     int failed_count;
     
 private:
-    std::vector<double> message_timings;
-    long long start_time = 0;
-    long long end_time = 0;
+    messaging::utils::LatencyHistogram message_timings;
+    messaging::utils::LatencyBreakdown breakdown;
+    long long start_ns = 0;
+    long long end_ns = 0;
+    long long bytes_count = 0;
+    double mean_message_bytes = 0;
     json metadata = json::object();
+    messaging::utils::LiveRecorder* live = nullptr;
 };
 
 #endif // STATS_COLLECTOR_HPP
@@ -0,0 +1,184 @@
+#ifndef STATS_SHARD_HPP
+#define STATS_SHARD_HPP
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "latency_histogram.hpp"
+
+namespace messaging {
+namespace utils {
+
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * Send/ack counters and latencies recorded by a single thread.
+ *
+ * Shards are padded to a cache line so neighbouring threads never share one.
+ * Counters are only written by the owning thread, so they use relaxed
+ * load/store instead of read-modify-write and can be read from any thread at
+ * any time. The histogram is owner-only and should be read once the recording
+ * threads have finished (e.g. after AsyncSendEngine::run returns).
+ */
+struct alignas(kCacheLineSize) StatsShard {
+    std::atomic<int64_t> sent{0};
+    std::atomic<int64_t> acked{0};
+    std::atomic<int64_t> failed{0};
+    LatencyHistogram latencies;
+
+    // Set for the overflow shard, which threads beyond kMaxShards share under a mutex
+    bool shared = false;
+
+    void record(bool success, int64_t latency_ns) {
+        bump(sent);
+        if (success) {
+            bump(acked);
+            latencies.record_ns(latency_ns);
+        } else {
+            bump(failed);
+        }
+    }
+
+    void reset() {
+        sent.store(0, std::memory_order_relaxed);
+        acked.store(0, std::memory_order_relaxed);
+        failed.store(0, std::memory_order_relaxed);
+        latencies.reset();
+    }
+
+private:
+    static void bump(std::atomic<int64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Per-thread stats shards, aggregated on read.
+ *
+ * Each thread that calls record() claims its own shard on first use, so the
+ * hot path is lock-free and contention-free. Totals are combined across shards
+ * when read, either directly (sent()/acked()/failed()) or by merging into a
+ * MessagingStats/MessageStats.
+ */
+class ShardedStats {
+public:
+    static constexpr size_t kMaxShards = 256;
+
+    ShardedStats() : id_(next_instance_id()) {
+        overflow_.shared = true;
+        for (auto& slot : slots_) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ShardedStats() {
+        for (auto& slot : slots_) {
+            delete slot.load(std::memory_order_relaxed);
+        }
+    }
+
+    ShardedStats(const ShardedStats&) = delete;
+    ShardedStats& operator=(const ShardedStats&) = delete;
+
+    void record(bool success, int64_t latency_ns = 0) {
+        StatsShard& shard = local();
+        if (shard.shared) {
+            std::lock_guard<std::mutex> lock(overflow_mu_);
+            shard.record(success, latency_ns);
+        } else {
+            shard.record(success, latency_ns);
+        }
+    }
+
+    // Calls fn(const StatsShard&) for every claimed shard
+    template <typename Fn>
+    void for_each_shard(Fn fn) const {
+        size_t claimed = std::min(claimed_.load(std::memory_order_acquire), kMaxShards);
+        for (size_t i = 0; i < claimed; ++i) {
+            const StatsShard* shard = slots_[i].load(std::memory_order_acquire);
+            if (shard) {
+                fn(*shard);
+            }
+        }
+        if (claimed_.load(std::memory_order_acquire) > kMaxShards) {
+            std::lock_guard<std::mutex> lock(overflow_mu_);
+            fn(overflow_);
+        }
+    }
+
+    int64_t sent() const { return sum(&StatsShard::sent); }
+    int64_t acked() const { return sum(&StatsShard::acked); }
+    int64_t failed() const { return sum(&StatsShard::failed); }
+
+    // Merged latencies of every shard; call once recording threads are done
+    LatencyHistogram latencies() const {
+        LatencyHistogram merged;
+        for_each_shard([&](const StatsShard& shard) { merged.merge(shard.latencies); });
+        return merged;
+    }
+
+    // Zero every shard; not safe while other threads are recording
+    void reset() {
+        size_t claimed = std::min(claimed_.load(std::memory_order_acquire), kMaxShards);
+        for (size_t i = 0; i < claimed; ++i) {
+            StatsShard* shard = slots_[i].load(std::memory_order_acquire);
+            if (shard) {
+                shard->reset();
+            }
+        }
+        std::lock_guard<std::mutex> lock(overflow_mu_);
+        overflow_.reset();
+    }
+
+private:
+    StatsShard& local() {
+        // Instance ids are never reused, so stale entries for destroyed instances can't match
+        thread_local std::vector<std::pair<uint64_t, StatsShard*>> cache;
+        for (const auto& entry : cache) {
+            if (entry.first == id_) {
+                return *entry.second;
+            }
+        }
+        StatsShard* shard = claim();
+        cache.emplace_back(id_, shard);
+        return *shard;
+    }
+
+    StatsShard* claim() {
+        size_t index = claimed_.fetch_add(1, std::memory_order_acq_rel);
+        if (index >= kMaxShards) {
+            return &overflow_;
+        }
+        StatsShard* shard = new StatsShard();
+        slots_[index].store(shard, std::memory_order_release);
+        return shard;
+    }
+
+    int64_t sum(std::atomic<int64_t> StatsShard::*field) const {
+        int64_t total = 0;
+        for_each_shard([&](const StatsShard& shard) {
+            total += (shard.*field).load(std::memory_order_relaxed);
+        });
+        return total;
+    }
+
+    static uint64_t next_instance_id() {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const uint64_t id_;
+    std::atomic<size_t> claimed_{0};
+    std::atomic<StatsShard*> slots_[kMaxShards];
+    StatsShard overflow_;
+    mutable std::mutex overflow_mu_;
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // STATS_SHARD_HPP
@@ -10,11 +10,235 @@
 #include "json.hpp"
 #include <sstream>
 #include <stdexcept>
+#include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using json = nlohmann::json;
 
 namespace test_data_loader {
     
+    namespace {
+        
+        /**
+         * @brief Read-only memory mapping of a whole file.
+         */
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::filesystem::path& path) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error("Failed to open test data file: " + path.string());
+                }
+                struct stat st;
+                if (::fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Failed to stat test data file: " + path.string());
+                }
+                size_ = static_cast<size_t>(st.st_size);
+                if (size_ > 0) {
+                    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr == MAP_FAILED) {
+                        ::close(fd);
+                        throw std::runtime_error("Failed to map test data file: " + path.string());
+                    }
+                    data_ = static_cast<const char*>(addr);
+                    // Both readers walk the file front to back exactly once
+                    ::madvise(addr, size_, MADV_SEQUENTIAL);
+                }
+                ::close(fd);
+            }
+            
+            ~MappedFile() {
+                if (data_) {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+            }
+            
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            
+            const char* data() const { return data_; }
+            size_t size() const { return size_; }
+            
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+        };
+        
+        /*
+         * Binary corpus layout (little-endian), written by generate_data.py --binary:
+         *
+         *   header:  char magic[8] = "PSCORPUS", u32 version = 1, u32 reserved, u64 count
+         *   record:  u32 body_size, then body:
+         *              i32 target
+         *              u8  id_kind (0 = integer, 1 = string)
+         *              i64 id                     | u16 len, bytes
+         *              u16 len, message_name bytes
+         *              u16 value_count, value_count x (u16 len, bytes)
+         */
+        constexpr char kCorpusMagic[8] = {'P', 'S', 'C', 'O', 'R', 'P', 'U', 'S'};
+        constexpr uint32_t kCorpusVersion = 1;
+        constexpr size_t kCorpusHeaderSize = 24;
+        
+        bool isBinaryCorpus(const char* data, size_t size) {
+            return size >= sizeof(kCorpusMagic) && std::memcmp(data, kCorpusMagic, sizeof(kCorpusMagic)) == 0;
+        }
+        
+        /**
+         * @brief Bounds-checked little-endian cursor over a mapped buffer.
+         */
+        class BinaryCursor {
+        public:
+            BinaryCursor(const char* data, size_t size) : p_(data), end_(data + size) {}
+            
+            template <typename T>
+            T read() {
+                T value;
+                require(sizeof(T));
+                std::memcpy(&value, p_, sizeof(T));
+                p_ += sizeof(T);
+                return value;
+            }
+            
+            std::string readString() {
+                uint16_t len = read<uint16_t>();
+                require(len);
+                std::string value(p_, len);
+                p_ += len;
+                return value;
+            }
+            
+            void skip(size_t n) {
+                require(n);
+                p_ += n;
+            }
+            
+            const char* position() const { return p_; }
+            size_t remaining() const { return static_cast<size_t>(end_ - p_); }
+            
+        private:
+            void require(size_t n) const {
+                if (remaining() < n) {
+                    throw std::runtime_error("Truncated binary corpus");
+                }
+            }
+            
+            const char* p_;
+            const char* end_;
+        };
+        
+        uint64_t readCorpusCount(const char* data, size_t size) {
+            BinaryCursor header(data, size);
+            if (size < kCorpusHeaderSize) {
+                throw std::runtime_error("Truncated binary corpus header");
+            }
+            header.read<uint64_t>();  // magic
+            uint32_t version = header.read<uint32_t>();
+            if (version != kCorpusVersion) {
+                throw std::runtime_error("Unsupported binary corpus version " + std::to_string(version));
+            }
+            header.read<uint32_t>();  // reserved
+            return header.read<uint64_t>();
+        }
+        
+        size_t forEachBinaryItem(const char* data, size_t size,
+                                 const std::function<void(const json&)>& fn) {
+            uint64_t count = readCorpusCount(data, size);
+            BinaryCursor cursor(data + kCorpusHeaderSize, size - kCorpusHeaderSize);
+            
+            // Reused across records so values keep their allocations
+            json item = json::object();
+            item["message_value"] = json::array();
+            for (uint64_t i = 0; i < count; ++i) {
+                uint32_t body_size = cursor.read<uint32_t>();
+                if (cursor.remaining() < body_size) {
+                    throw std::runtime_error("Truncated binary corpus record " + std::to_string(i));
+                }
+                BinaryCursor body(cursor.position(), body_size);
+                cursor.skip(body_size);
+                
+                item["target"] = body.read<int32_t>();
+                if (body.read<uint8_t>() == 0) {
+                    item["message_id"] = body.read<int64_t>();
+                } else {
+                    item["message_id"] = body.readString();
+                }
+                item["message_name"] = body.readString();
+                
+                json& values = item["message_value"];
+                uint16_t value_count = body.read<uint16_t>();
+                values.get_ref<json::array_t&>().resize(value_count);
+                for (uint16_t v = 0; v < value_count; ++v) {
+                    values[v] = body.readString();
+                }
+                
+                fn(item);
+            }
+            return static_cast<size_t>(count);
+        }
+        
+        size_t forEachJsonItem(const char* data, size_t size,
+                               const std::function<void(const json&)>& fn) {
+            const char* first = data;
+            const char* last = data + size;
+            while (first != last && std::isspace(static_cast<unsigned char>(*first))) {
+                ++first;
+            }
+            if (first == last || *first != '[') {
+                throw std::runtime_error("Test data must be a JSON array of messages");
+            }
+            
+            // Hand each top-level element to fn, then discard it so the DOM never grows
+            size_t count = 0;
+            json::parser_callback_t callback = [&](int depth, json::parse_event_t event, json& parsed) {
+                if (depth == 1 && (event == json::parse_event_t::object_end ||
+                                   event == json::parse_event_t::array_end ||
+                                   event == json::parse_event_t::value)) {
+                    fn(parsed);
+                    count++;
+                    return false;
+                }
+                return true;
+            };
+            // Only the emptied top-level array is left in the result
+            json remainder = json::parse(first, last, callback);
+            return count;
+        }
+        
+        /**
+         * @brief SAX handler that counts top-level array elements without building values.
+         */
+        struct ElementCounter : json::json_sax_t {
+            size_t depth = 0;
+            size_t count = 0;
+            
+            void element() { if (depth == 1) count++; }
+            bool open() { element(); depth++; return true; }
+            bool close() { depth--; return true; }
+            
+            bool null() override { element(); return true; }
+            bool boolean(bool) override { element(); return true; }
+            bool number_integer(number_integer_t) override { element(); return true; }
+            bool number_unsigned(number_unsigned_t) override { element(); return true; }
+            bool number_float(number_float_t, const string_t&) override { element(); return true; }
+            bool string(string_t&) override { element(); return true; }
+            bool binary(binary_t&) override { element(); return true; }
+            bool start_object(std::size_t) override { return open(); }
+            bool key(string_t&) override { return true; }
+            bool end_object() override { return close(); }
+            bool start_array(std::size_t) override { return open(); }
+            bool end_array() override { return close(); }
+            bool parse_error(std::size_t, const std::string&, const json::exception& e) override {
+                throw std::runtime_error(std::string("Invalid JSON in test data file: ") + e.what());
+            }
+        };
+        
+    } // namespace
+    
     std::filesystem::path getDefaultTestDataPath() {
         // List of potential locations to search
         std::filesystem::path search_paths[] = {
@@ -66,22 +290,36 @@ namespace test_data_loader {
         return path;
     }
     
-    std::vector<json> loadTestData(const std::string& data_path) {
+    std::filesystem::path resolveCorpusPath(const std::string& data_path) {
+        if (data_path.empty()) {
+            std::filesystem::path binary_path = getDefaultTestDataPath().replace_extension(".bin");
+            if (std::filesystem::is_regular_file(binary_path)) {
+                return binary_path;
+            }
+        }
+        return resolveTestDataPath(data_path);
+    }
+    
+    size_t forEachTestItem(const std::string& data_path, const std::function<void(const json&)>& fn) {
+        std::filesystem::path resolved_path = resolveCorpusPath(data_path);
         try {
-            std::filesystem::path resolved_path = resolveTestDataPath(data_path);
-            
-            std::ifstream file(resolved_path);
-            if (!file.is_open()) {
-                std::ostringstream oss;
-                oss << "Failed to open test data file: " << resolved_path.string();
-                throw std::runtime_error(oss.str());
+            MappedFile file(resolved_path);
+            if (isBinaryCorpus(file.data(), file.size())) {
+                return forEachBinaryItem(file.data(), file.size(), fn);
             }
-            
-            json test_data;
-            file >> test_data;
-            file.close();
-            
-            return test_data.get<std::vector<json>>();
+            return forEachJsonItem(file.data(), file.size(), fn);
+        } catch (const json::parse_error& e) {
+            std::ostringstream oss;
+            oss << "Invalid JSON in test data file: " << e.what();
+            throw std::runtime_error(oss.str());
+        }
+    }
+    
+    std::vector<json> loadTestData(const std::string& data_path) {
+        try {
+            std::vector<json> test_data;
+            forEachTestItem(data_path, [&](const json& item) { test_data.push_back(item); });
+            return test_data;
             
         } catch (const json::parse_error& e) {
             std::ostringstream oss;
@@ -98,20 +336,16 @@ namespace test_data_loader {
     }
     
     size_t getTestDataCount(const std::string& data_path) {
-        std::filesystem::path resolved_path = resolveTestDataPath(data_path);
+        std::filesystem::path resolved_path = resolveCorpusPath(data_path);
+        MappedFile file(resolved_path);
         
-        std::ifstream file(resolved_path);
-        if (!file.is_open()) {
-            std::ostringstream oss;
-            oss << "Failed to open test data file: " << resolved_path.string();
-            throw std::runtime_error(oss.str());
+        if (isBinaryCorpus(file.data(), file.size())) {
+            return static_cast<size_t>(readCorpusCount(file.data(), file.size()));
         }
         
-        json test_data;
-        file >> test_data;
-        file.close();
-        
-        return test_data.size();
+        ElementCounter counter;
+        json::sax_parse(file.data(), file.data() + file.size(), &counter);
+        return counter.count;
     }
     
     std::pair<bool, std::vector<std::string>> validateTestData(const std::vector<json>& test_data) {
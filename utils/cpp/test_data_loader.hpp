@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <stdexcept>
 #include <sstream>
+#include <functional>
 
 // Include json.hpp to get the proper nlohmann::json type
 #include "json.hpp"
@@ -21,9 +22,17 @@
  * C++ sender implementations, eliminating code duplication and providing consistent
  * path resolution.
  * 
+ * Two on-disk formats are supported:
+ *   - test_data.json: a JSON array of message objects (generate_data.py default)
+ *   - test_data.bin:  the compact binary corpus written by generate_data.py --binary,
+ *                     whose header carries the message count
+ * Both are memory-mapped and read one message at a time, so large corpora never
+ * materialize as a full JSON DOM.
+ * 
  * Usage:
  *   #include "test_data_loader.hpp"
  *   auto test_data = test_data_loader::loadTestData("/path/to/data.json");
+ *   test_data_loader::forEachTestItem("", [](const nlohmann::json& item) { ... });
  */
 namespace test_data_loader {
     
@@ -49,6 +58,33 @@ namespace test_data_loader {
      */
     std::filesystem::path resolveTestDataPath(const std::string& data_path = "");
     
+    /**
+     * @brief Resolve the corpus to stream from, preferring the binary format.
+     * 
+     * With an explicit data_path this is resolveTestDataPath(data_path). Otherwise
+     * test_data.bin is used if it exists next to the default test_data.json.
+     * 
+     * @param data_path Optional custom path (.json or .bin).
+     * @return std::filesystem::path The resolved corpus path.
+     * @throws std::runtime_error If no corpus can be found.
+     */
+    std::filesystem::path resolveCorpusPath(const std::string& data_path = "");
+    
+    /**
+     * @brief Stream every message in a test data file through fn, one at a time.
+     * 
+     * The file is memory-mapped. JSON arrays are parsed incrementally and each
+     * element is discarded after fn returns; binary corpora are decoded record by
+     * record into a reused object. Memory use is independent of corpus size.
+     * 
+     * @param data_path Optional path (.json or binary corpus); see resolveCorpusPath.
+     * @param fn Called with each message object; the reference is only valid during the call.
+     * @return size_t Number of messages visited.
+     * @throws std::runtime_error If the file cannot be read or is malformed.
+     */
+    size_t forEachTestItem(const std::string& data_path,
+                           const std::function<void(const nlohmann::json& item)>& fn);
+    
     /**
      * @brief Load test data from a JSON file.
      * 
@@ -65,8 +101,8 @@ namespace test_data_loader {
     /**
      * @brief Get the number of messages in the test data file without loading all data.
      * 
-     * This is a lightweight function that just counts items in the JSON array
-     * without fully parsing the data structure.
+     * Binary corpora answer from the index header; JSON files are scanned with a
+     * SAX counter that never builds DOM nodes.
      * 
      * @param data_path Optional path to the test data file.
      * @return size_t Number of messages in the test data.
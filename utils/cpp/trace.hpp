@@ -0,0 +1,234 @@
+#ifndef MESSAGING_TRACE_HPP
+#define MESSAGING_TRACE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+namespace messaging {
+namespace utils {
+namespace trace {
+
+/**
+ * Scoped trace points for flame-charting one run in chrome://tracing or
+ * Perfetto, without perf privileges.
+ *
+ * Compiled in only with -DMESSAGING_TRACE (e.g. CXXFLAGS=-DMESSAGING_TRACE
+ * make clean build); otherwise TRACE_SCOPE expands to nothing and the hot
+ * paths are unchanged. A scope stamps steady_clock on entry and exit into the
+ * calling thread's ring buffer, which keeps the last kRingEvents spans, so a
+ * trace point costs two clock reads and a store, with no lock or allocation
+ * once the thread's buffer exists. configure_tracing() writes every thread's
+ * spans as Chrome trace JSON when the program exits.
+ *
+ *   configure_tracing(argc, argv);        // --trace-file PATH ("%p" becomes the pid)
+ *   {
+ *       TRACE_SCOPE("send");
+ *       ... publish ...
+ *   }
+ *   int status = TRACED("wait", wait_for_reply(socket));   // one expression
+ *
+ * Span names must be string literals; only the pointer is stored. Stamps are
+ * CLOCK_MONOTONIC nanoseconds, which every process on the host shares, so a
+ * sender's and its receivers' traces line up when merged.
+ */
+struct Span {
+    const char* name;
+    int64_t begin_ns;
+    int64_t end_ns;
+};
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// One thread's most recent spans; written by that thread only
+class ThreadRing {
+public:
+    static constexpr size_t kRingEvents = size_t(1) << 16;
+
+    explicit ThreadRing(uint32_t tid) : tid_(tid), spans_(kRingEvents) {}
+
+    void push(const char* name, int64_t begin_ns, int64_t end_ns) {
+        uint64_t n = recorded_.load(std::memory_order_relaxed);
+        spans_[n & (kRingEvents - 1)] = {name, begin_ns, end_ns};
+        recorded_.store(n + 1, std::memory_order_release);
+    }
+
+    uint32_t tid() const { return tid_; }
+    uint64_t recorded() const { return recorded_.load(std::memory_order_acquire); }
+    const Span& at(uint64_t n) const { return spans_[n & (kRingEvents - 1)]; }
+
+private:
+    uint32_t tid_;
+    std::vector<Span> spans_;
+    std::atomic<uint64_t> recorded_{0};
+};
+
+/**
+ * Every thread's ring, kept until exit so spans from threads that finished
+ * early still make it into the file.
+ */
+class TraceRegistry {
+public:
+    static TraceRegistry& global() {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    ThreadRing& local() {
+        thread_local ThreadRing* ring = nullptr;
+        if (!ring) {
+            std::lock_guard<std::mutex> lock(mu_);
+            rings_.push_back(std::make_unique<ThreadRing>(static_cast<uint32_t>(rings_.size() + 1)));
+            ring = rings_.back().get();
+        }
+        return *ring;
+    }
+
+    void set_output(const std::string& path, const std::string& process_name) {
+        std::lock_guard<std::mutex> lock(mu_);
+        path_ = path;
+        process_name_ = process_name;
+    }
+
+    /**
+     * Write the Chrome trace file ("X" complete events, microsecond times).
+     * Call once the traced threads are done; a thread still recording may
+     * lose its last few spans. Returns false if there is no output path or
+     * it can't be written.
+     */
+    bool write() {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (path_.empty()) {
+            return false;
+        }
+        std::ofstream out(path_, std::ios::trunc);
+        if (!out.good()) {
+            fprintf(stderr, " [!] Cannot write trace to %s\n", path_.c_str());
+            return false;
+        }
+        int pid = static_cast<int>(getpid());
+        char line[256];
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        snprintf(line, sizeof(line),
+                 "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"%s\"}}",
+                 pid, process_name_.c_str());
+        out << line;
+        uint64_t written = 0;
+        uint64_t overwritten = 0;
+        for (const auto& ring : rings_) {
+            uint64_t recorded = ring->recorded();
+            uint64_t first = recorded > ThreadRing::kRingEvents ? recorded - ThreadRing::kRingEvents : 0;
+            overwritten += first;
+            for (uint64_t n = first; n < recorded; ++n) {
+                const Span& span = ring->at(n);
+                snprintf(line, sizeof(line),
+                         ",\n{\"name\":\"%s\",\"cat\":\"messaging\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,"
+                         "\"ts\":%.3f,\"dur\":%.3f}",
+                         span.name, pid, ring->tid(), span.begin_ns / 1e3, (span.end_ns - span.begin_ns) / 1e3);
+                out << line;
+                written++;
+            }
+        }
+        out << "\n]}\n";
+        fprintf(stderr, " [*] Trace: %llu spans from %zu threads to %s", static_cast<unsigned long long>(written),
+                rings_.size(), path_.c_str());
+        if (overwritten > 0) {
+            fprintf(stderr, " (%llu older spans overwritten)", static_cast<unsigned long long>(overwritten));
+        }
+        fprintf(stderr, "\n");
+        return out.good();
+    }
+
+private:
+    std::mutex mu_;
+    std::vector<std::unique_ptr<ThreadRing>> rings_;
+    std::string path_;
+    std::string process_name_;
+};
+
+// RAII trace point; use through TRACE_SCOPE so it compiles away without MESSAGING_TRACE
+class Scope {
+public:
+    // The ring is looked up first, so a thread's first span doesn't time its allocation
+    explicit Scope(const char* name) : ring_(TraceRegistry::global().local()), name_(name), begin_ns_(now_ns()) {}
+    ~Scope() { ring_.push(name_, begin_ns_, now_ns()); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    ThreadRing& ring_;
+    const char* name_;
+    int64_t begin_ns_;
+};
+
+inline bool enabled() {
+#ifdef MESSAGING_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace trace
+
+/**
+ * Apply --trace-file PATH: write this process's spans there at exit. "%p" in
+ * PATH is replaced by the pid, so several receivers can share one flag. Warns
+ * and does nothing in a build without MESSAGING_TRACE.
+ */
+inline void configure_tracing(int argc, char* argv[]) {
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace-file") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        }
+    }
+    if (path.empty()) {
+        return;
+    }
+    if (!trace::enabled()) {
+        fprintf(stderr, " [!] --trace-file ignored: built without -DMESSAGING_TRACE\n");
+        return;
+    }
+    size_t pid_at = path.find("%p");
+    if (pid_at != std::string::npos) {
+        path.replace(pid_at, 2, std::to_string(getpid()));
+    }
+    std::string process_name = argc > 0 ? argv[0] : "messaging";
+    size_t slash = process_name.rfind('/');
+    if (slash != std::string::npos) {
+        process_name.erase(0, slash + 1);
+    }
+    // Constructed before the handler is registered, so it is still alive when the handler runs
+    trace::TraceRegistry::global().set_output(path, process_name);
+    std::atexit([]() { trace::TraceRegistry::global().write(); });
+}
+
+} // namespace utils
+} // namespace messaging
+
+#define MESSAGING_TRACE_CAT_(a, b) a##b
+#define MESSAGING_TRACE_CAT(a, b) MESSAGING_TRACE_CAT_(a, b)
+
+#ifdef MESSAGING_TRACE
+#define TRACE_SCOPE(name) ::messaging::utils::trace::Scope MESSAGING_TRACE_CAT(trace_scope_, __LINE__)(name)
+#define TRACED(name, expr) ([&]() -> decltype(auto) { TRACE_SCOPE(name); return expr; }())
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACED(name, expr) (expr)
+#endif
+
+#endif // MESSAGING_TRACE_HPP
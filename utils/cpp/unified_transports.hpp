@@ -0,0 +1,44 @@
+#ifndef UNIFIED_TRANSPORTS_HPP
+#define UNIFIED_TRANSPORTS_HPP
+
+/**
+ * Client library headers for the UnifiedReceiver backends.
+ *
+ * Each backend in receiver.hpp is compiled in only when its library's
+ * headers are on the include path, so a program that uses one broker
+ * neither needs the others' headers nor links their libraries. The
+ * shared-memory backend needs no library, only Linux futexes.
+ */
+
+#include <sys/time.h>
+
+#if __has_include(<zmq.hpp>)
+#include <zmq.hpp>
+#define UNIFIED_HAVE_ZMQ 1
+#endif
+#if __has_include(<hiredis/hiredis.h>)
+#include <hiredis/hiredis.h>
+#define UNIFIED_HAVE_REDIS 1
+#endif
+#if __has_include(<nats/nats.h>)
+#include <nats/nats.h>
+#define UNIFIED_HAVE_NATS 1
+#endif
+#if __has_include(<rabbitmq-c/amqp.h>)
+#include <rabbitmq-c/amqp.h>
+#include <rabbitmq-c/tcp_socket.h>
+#define UNIFIED_HAVE_RABBITMQ 1
+#endif
+#if __has_include(<activemq/core/ActiveMQConnectionFactory.h>)
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <cms/Connection.h>
+#include <cms/Session.h>
+#include <cms/BytesMessage.h>
+#define UNIFIED_HAVE_ACTIVEMQ 1
+#endif
+#if __has_include(<linux/futex.h>) && __has_include(<sys/mman.h>)
+#include "shm_ring.hpp"
+#define UNIFIED_HAVE_SHM 1
+#endif
+
+#endif // UNIFIED_TRANSPORTS_HPP
@@ -0,0 +1,395 @@
+#ifndef WORK_QUEUE_HPP
+#define WORK_QUEUE_HPP
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "json.hpp"
+#include "cpu_affinity.hpp"
+
+namespace messaging {
+namespace utils {
+
+/**
+ * Receiver work queue between the I/O thread and processing workers.
+ *
+ * capacity - requests queued for the workers; 0 (the default) processes
+ *            inline on the I/O thread, as before
+ * workers  - processing threads
+ * shed     - when the queue is full, drop the request (counted) instead of
+ *            blocking the I/O thread until a worker frees a slot
+ */
+struct WorkQueueOptions {
+    int capacity = 0;
+    int workers = 2;
+    bool shed = false;
+
+    bool enabled() const { return capacity > 0; }
+    const char* policy() const { return shed ? "shed" : "block"; }
+
+    // Parse --work-queue N, --work-threads N and --overload shed|block
+    static WorkQueueOptions from_args(int argc, char* argv[]) {
+        WorkQueueOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (std::strcmp(argv[i], "--work-queue") == 0 && i + 1 < argc) {
+                options.capacity = std::max(0, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--work-threads") == 0 && i + 1 < argc) {
+                options.workers = std::max(1, std::stoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--overload") == 0 && i + 1 < argc) {
+                options.shed = std::strcmp(argv[++i], "shed") == 0;
+            }
+        }
+        return options;
+    }
+};
+
+/**
+ * Bounded lock-free MPMC queue (Vyukov's scheme, as in AsyncLogger's ring)
+ * of movable values. The capacity is rounded up to a power of two; push and
+ * pop never block and never allocate after construction.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : slots_(round_up(capacity)), mask_(slots_.size() - 1) {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    // Approximate under concurrent pushes and pops
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    // false (value untouched) if the queue is full
+    bool try_push(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // false if the queue is empty
+    bool try_pop(T& out) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(slot->value);
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    static size_t round_up(size_t n) {
+        size_t size = 2;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+/**
+ * Results handed back from workers to the one thread that may write them
+ * (the socket or connection owner). fd() is an eventfd that becomes readable
+ * when results are waiting, so that thread can poll it next to its socket;
+ * drain() clears it and takes everything queued. One eventfd write per wakeup,
+ * not per result.
+ */
+template <typename T>
+class ReplyQueue {
+public:
+    explicit ReplyQueue(size_t capacity) : queue_(capacity), fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+    ~ReplyQueue() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    ReplyQueue(const ReplyQueue&) = delete;
+    ReplyQueue& operator=(const ReplyQueue&) = delete;
+
+    int fd() const { return fd_; }
+
+    // True once results are waiting; lets the owner skip drain()'s read() when there are none
+    bool pending() const { return signalled_.load(std::memory_order_acquire); }
+
+    // Any thread; spins while the queue is full, until the owner drains it
+    void push(T& value) {
+        while (!queue_.try_push(value)) {
+            std::this_thread::yield();
+        }
+        if (!signalled_.exchange(true)) {
+            uint64_t one = 1;
+            ssize_t n = write(fd_, &one, sizeof(one));
+            (void)n;
+        }
+    }
+
+    // Owner thread only; returns the number of results handed to fn
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        uint64_t count = 0;
+        ssize_t n = read(fd_, &count, sizeof(count));
+        (void)n;
+        signalled_.store(false);
+        size_t taken = 0;
+        while (queue_.try_pop(item_)) {
+            fn(item_);
+            ++taken;
+        }
+        return taken;
+    }
+
+private:
+    BoundedQueue<T> queue_;
+    int fd_;
+    std::atomic<bool> signalled_{false};
+    T item_;
+};
+
+/**
+ * Bounded stage between a receiver's I/O thread and its processing workers.
+ *
+ *   WorkQueue<Job> queue(options, [&](Job& job, int worker) { ... });
+ *   if (!queue.submit(job, drain)) { ... shed ... }    // I/O thread
+ *   queue.close();                              // drains what is queued, joins
+ *
+ * The I/O thread only reads requests and submits them; workers parse, build
+ * ACKs and hand them to whatever writes them (usually a ReplyQueue). When
+ * the workers fall behind the queue fills, and the policy decides what the
+ * I/O thread does: block (stop reading, so the transport pushes back on
+ * senders) or shed (drop and count). Either way the overload is visible in
+ * report() rather than only as sender timeouts: queue depth, time the I/O
+ * thread spent blocked, and requests shed.
+ *
+ * When the I/O thread also writes the replies, it must keep draining them
+ * while it reads: pass that drain as submit()'s idle callback and call it
+ * after each submit. Otherwise workers stall on a full ReplyQueue, the work
+ * queue fills behind them and a blocked submit never returns.
+ */
+template <typename Job>
+class WorkQueue {
+public:
+    using ProcessFn = std::function<void(Job& job, int worker)>;
+
+    WorkQueue(const WorkQueueOptions& options, ProcessFn process)
+        : options_(options), queue_(static_cast<size_t>(std::max(1, options.capacity))),
+          process_(std::move(process)) {
+        for (int w = 0; w < options_.workers; ++w) {
+            threads_.emplace_back([this, w]() {
+                CpuAffinity::global().pin_this_thread();
+                work(w);
+            });
+        }
+    }
+
+    ~WorkQueue() { close(); }
+
+    WorkQueue(const WorkQueue&) = delete;
+    WorkQueue& operator=(const WorkQueue&) = delete;
+
+    size_t capacity() const { return queue_.capacity(); }
+    size_t depth() const { return queue_.size(); }
+
+    // Requests that can be waiting or being processed at once; size a ReplyQueue to this
+    size_t max_outstanding() const { return queue_.capacity() + threads_.size(); }
+
+    uint64_t shed() const { return shed_.load(std::memory_order_relaxed); }
+
+    // True at most once a second, so callers can warn about shedding without flooding stderr
+    bool warn_due() {
+        int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t last = last_warning_.load(std::memory_order_relaxed);
+        return last != second && last_warning_.compare_exchange_strong(last, second, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queue job for a worker (any thread; job is moved from on success).
+     * @param idle Called while blocked on a full queue, e.g. to write replies the workers are waiting to hand back
+     * @return false if the queue was full and the shed policy dropped it
+     */
+    template <typename Idle>
+    bool submit(Job& job, Idle&& idle) {
+        size_t depth = queue_.size();
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        sum_depth_.fetch_add(depth, std::memory_order_relaxed);
+        size_t seen = max_depth_.load(std::memory_order_relaxed);
+        while (depth + 1 > seen && !max_depth_.compare_exchange_weak(seen, depth + 1, std::memory_order_relaxed)) {
+        }
+        if (!queue_.try_push(job)) {
+            if (options_.shed) {
+                shed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // Full means every worker is busy, so there is no one to wake; just wait for a slot
+            auto start = std::chrono::steady_clock::now();
+            while (!queue_.try_push(job)) {
+                idle();
+                std::this_thread::yield();
+            }
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+            blocked_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+        }
+        // Order the push before the check, against a worker incrementing sleepers_ before its last look
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            wake_one();
+        }
+        return true;
+    }
+
+    // For callers whose replies are written by another thread
+    bool submit(Job& job) {
+        return submit(job, []() {});
+    }
+
+    // Stop once every queued job is processed, then join the workers
+    void close() {
+        if (closing_.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            cv_.notify_all();
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    // Queue settings and overload counters; depths are sampled as each job is submitted
+    nlohmann::json report() const {
+        uint64_t submitted = submitted_.load();
+        return {
+            {"capacity", queue_.capacity()},
+            {"workers", options_.workers},
+            {"policy", options_.policy()},
+            {"submitted", submitted},
+            {"processed", processed_.load()},
+            {"shed", shed_.load()},
+            {"blocked", blocked_.load()},
+            {"blocked_ms", blocked_ns_.load() / 1e6},
+            {"max_depth", std::min(max_depth_.load(), queue_.capacity())},
+            {"mean_depth", submitted > 0 ? static_cast<double>(sum_depth_.load()) / submitted : 0.0}
+        };
+    }
+
+private:
+    static constexpr int kSpins = 64;
+
+    void wake_one() {
+        std::lock_guard<std::mutex> lock(mu_);
+        cv_.notify_one();
+    }
+
+    // Spin briefly on an empty queue, then sleep until submit() wakes us
+    void work(int worker) {
+        Job job;
+        int idle = 0;
+        while (true) {
+            if (queue_.try_pop(job)) {
+                idle = 0;
+                process_(job, worker);
+                processed_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (closing_.load()) {
+                return;
+            }
+            if (++idle < kSpins) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mu_);
+            sleepers_++;
+            // The timeout only backs up the wakeup; submit() checks sleepers_ after each push
+            cv_.wait_for(lock, std::chrono::milliseconds(10),
+                         [this]() { return queue_.size() > 0 || closing_.load(); });
+            sleepers_--;
+            idle = 0;
+        }
+    }
+
+    WorkQueueOptions options_;
+    BoundedQueue<Job> queue_;
+    ProcessFn process_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> closing_{false};
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::atomic<int> sleepers_{0};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> blocked_ns_{0};
+    std::atomic<uint64_t> sum_depth_{0};
+    std::atomic<size_t> max_depth_{0};
+    std::atomic<uint64_t> processed_{0};
+    std::atomic<uint64_t> shed_{0};
+    std::atomic<int64_t> last_warning_{-1};
+};
+
+} // namespace utils
+} // namespace messaging
+
+#endif // WORK_QUEUE_HPP
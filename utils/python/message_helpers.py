@@ -75,7 +75,8 @@ def create_ack_envelope(
     target: int,
     receiver_id: str,
     status: str = "OK",
-    latency_ms: float = 0.5
+    latency_ms: float = 0.0,
+    original_message_seq: int = 0
 ) -> MessageEnvelope:
     """Create an ACK MessageEnvelope."""
     envelope = MessageEnvelope()
@@ -88,6 +89,7 @@ def create_ack_envelope(
     
     # Populate direct Acknowledgment field
     envelope.ack.original_message_id = original_message_id
+    envelope.ack.original_message_seq = original_message_seq
     envelope.ack.received = (status == "OK")
     envelope.ack.latency_ms = latency_ms
     envelope.ack.receiver_id = receiver_id
@@ -97,15 +99,31 @@ def create_ack_envelope(
     return envelope
 
 
-def create_ack_from_envelope(msg_envelope: MessageEnvelope, receiver_id: str) -> MessageEnvelope:
-    """Create an ACK MessageEnvelope from a received message envelope."""
-    return create_ack_envelope(
+def create_ack_from_envelope(msg_envelope: MessageEnvelope, receiver_id: str,
+                             received_at_us: int = 0, received_ns: int = 0) -> MessageEnvelope:
+    """
+    Create an ACK MessageEnvelope from a received message envelope, carrying the
+    receiver timing: received_at_us (wall clock) and received_ns (perf_counter_ns)
+    of the request's arrival, defaulting to now.
+    """
+    now_ns = time.perf_counter_ns()
+    if not received_at_us:
+        received_at_us = time.time_ns() // 1000
+        received_ns = now_ns
+    sent_us = msg_envelope.timestamp_us or msg_envelope.timestamp * 1000
+    envelope = create_ack_envelope(
         original_message_id=msg_envelope.message_id,
         target=msg_envelope.target,
         receiver_id=receiver_id,
         status="OK",
-        latency_ms=0.5
+        latency_ms=(received_at_us - sent_us) / 1000.0 if sent_us else 0.0,
+        original_message_seq=msg_envelope.message_seq
     )
+    processing_ns = now_ns - received_ns if received_ns else 0
+    envelope.ack.received_at_us = received_at_us
+    envelope.ack.processing_ns = processing_ns
+    envelope.ack.acked_at_us = received_at_us + processing_ns // 1000
+    return envelope
 
 
 def parse_envelope(data: bytes) -> MessageEnvelope:
@@ -19,6 +19,7 @@ class MessageType(IntEnum):
     ACK = 4
     CONTROL = 5
     EVENT = 6
+    BATCH = 7
 
 
 class RoutingMode(IntEnum):
@@ -24,7 +24,7 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0fmessaging.proto\x12\tmessaging\"\xfd\x02\n\x0fMessageEnvelope\x12\x12\n\nmessage_id\x18\x01 \x01(\t\x12\x0e\n\x06target\x18\x02 \x01(\x05\x12\r\n\x05topic\x18\x03 \x01(\t\x12$\n\x04type\x18\x04 \x01(\x0e\x32\x16.messaging.MessageType\x12\x0f\n\x07payload\x18\x05 \x01(\x0c\x12\r\n\x05\x61sync\x18\x06 \x01(\x08\x12\x11\n\ttimestamp\x18\x07 \x01(\x03\x12\'\n\x07routing\x18\x08 \x01(\x0e\x32\x16.messaging.RoutingMode\x12 \n\x03qos\x18\t \x01(\x0e\x32\x13.messaging.QoSLevel\x12:\n\x08metadata\x18\n \x03(\x0b\x32(.messaging.MessageEnvelope.MetadataEntry\x12&\n\x03\x61\x63k\x18\x0b \x01(\x0b\x32\x19.messaging.Acknowledgment\x1a/\n\rMetadataEntry\x12\x0b\n\x03key\x18\x01 \x01(\t\x12\r\n\x05value\x18\x02 \x01(\t:\x02\x38\x01\":\n\x0b\x44\x61taMessage\x12\x14\n\x0cmessage_name\x18\x01 \x01(\t\x12\x15\n\rmessage_value\x18\x02 \x03(\t\"C\n\nRPCRequest\x12\x0e\n\x06method\x18\x01 \x01(\t\x12\x11\n\targuments\x18\x02 \x01(\x0c\x12\x12\n\ntimeout_ms\x18\x03 \x01(\x05\"E\n\x0bRPCResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0e\n\x06result\x18\x02 \x01(\x0c\x12\x15\n\rerror_message\x18\x03 \x01(\t\"x\n\x0e\x41\x63knowledgment\x12\x1b\n\x13original_message_id\x18\x01 \x01(\t\x12\x10\n\x08received\x18\x02 \x01(\x08\x12\x12\n\nlatency_ms\x18\x03 \x01(\x01\x12\x13\n\x0breceiver_id\x18\x04 \x01(\t\x12\x0e\n\x06status\x18\x05 \x01(\t\"i\n\x0e\x43ontrolMessage\x12$\n\x04type\x18\x01 \x01(\x0e\x32\x16.messaging.ControlType\x12\x0e\n\x06source\x18\x02 \x01(\t\x12\x13\n\x0b\x64\x65stination\x18\x03 \x01(\t\x12\x0c\n\x04\x64\x61ta\x18\x04 \x01(\x0c\"_\n\x0c\x42\x61tchMessage\x12,\n\x08messages\x18\x01 \x03(\x0b\x32\x1a.messaging.MessageEnvelope\x12\x10\n\x08\x62\x61tch_id\x18\x02 \x01(\x05\x12\x0f\n\x07is_last\x18\x03 \x01(\x08\"p\n\rBatchResponse\x12\x32\n\x0f\x61\x63knowledgments\x18\x01 \x03(\x0b\x32\x19.messaging.Acknowledgment\x12\x14\n\x0c\x66\x61iled_count\x18\x02 \x01(\x05\x12\x15\n\rerror_message\x18\x03 \x01(\t\"\xbb\x01\n\x0cStatsMessage\x12\x14\n\x0cservice_name\x18\x01 \x01(\t\x12\x15\n\rmessages_sent\x18\x02 \x01(\x03\x12\x19\n\x11messages_received\x18\x03 \x01(\x03\x12\x18\n\x10messages_dropped\x18\x04 \x01(\x03\x12\x16\n\x0e\x61vg_latency_ms\x18\x05 \x01(\x01\x12\x1e\n\x16throughput_msg_per_sec\x18\x06 \x01(\x01\x12\x11\n\ttimestamp\x18\x07 \x01(\x03*\x81\x01\n\x0bMessageType\x12\x1c\n\x18MESSAGE_TYPE_UNSPECIFIED\x10\x00\x12\x10\n\x0c\x44\x41TA_MESSAGE\x10\x01\x12\x0f\n\x0bRPC_REQUEST\x10\x02\x12\x10\n\x0cRPC_RESPONSE\x10\x03\x12\x07\n\x03\x41\x43K\x10\x04\x12\x0b\n\x07\x43ONTROL\x10\x05\x12\t\n\x05\x45VENT\x10\x06*p\n\x0bRoutingMode\x12\x17\n\x13ROUTING_UNSPECIFIED\x10\x00\x12\x12\n\x0ePOINT_TO_POINT\x10\x01\x12\x15\n\x11PUBLISH_SUBSCRIBE\x10\x02\x12\x11\n\rREQUEST_REPLY\x10\x03\x12\n\n\x06\x46\x41NOUT\x10\x04*V\n\x08QoSLevel\x12\x13\n\x0fQOS_UNSPECIFIED\x10\x00\x12\x10\n\x0c\x41T_MOST_ONCE\x10\x01\x12\x11\n\rAT_LEAST_ONCE\x10\x02\x12\x10\n\x0c\x45XACTLY_ONCE\x10\x03*\x7f\n\x0b\x43ontrolType\x12\x1c\n\x18\x43ONTROL_TYPE_UNSPECIFIED\x10\x00\x12\x08\n\x04PING\x10\x01\x12\x08\n\x04PONG\x10\x02\x12\x0c\n\x08SHUTDOWN\x10\x03\x12\x10\n\x0cHEALTH_CHECK\x10\x04\x12\r\n\tSUBSCRIBE\x10\x05\x12\x0f\n\x0bUNSUBSCRIBE\x10\x06\x32\xee\x01\n\x10MessagingService\x12L\n\x0eStreamMessages\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope(\x01\x30\x01\x12\x45\n\x0bSendMessage\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope\x12\x45\n\tSubscribe\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope0\x01\x62\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0fmessaging.proto\x12\tmessaging\"\xa8\x03\n\x0fMessageEnvelope\x12\x12\n\nmessage_id\x18\x01 \x01(\t\x12\x0e\n\x06target\x18\x02 \x01(\x05\x12\r\n\x05topic\x18\x03 \x01(\t\x12$\n\x04type\x18\x04 \x01(\x0e\x32\x16.messaging.MessageType\x12\x0f\n\x07payload\x18\x05 \x01(\x0c\x12\r\n\x05\x61sync\x18\x06 \x01(\x08\x12\x11\n\ttimestamp\x18\x07 \x01(\x03\x12\'\n\x07routing\x18\x08 \x01(\x0e\x32\x16.messaging.RoutingMode\x12 \n\x03qos\x18\t \x01(\x0e\x32\x13.messaging.QoSLevel\x12:\n\x08metadata\x18\n \x03(\x0b\x32(.messaging.MessageEnvelope.MetadataEntry\x12&\n\x03\x61\x63k\x18\x0b \x01(\x0b\x32\x19.messaging.Acknowledgment\x12\x14\n\x0ctimestamp_us\x18\x0c \x01(\x03\x12\x13\n\x0bmessage_seq\x18\r \x01(\x06\x1a/\n\rMetadataEntry\x12\x0b\n\x03key\x18\x01 \x01(\t\x12\r\n\x05value\x18\x02 \x01(\t:\x02\x38\x01\":\n\x0b\x44\x61taMessage\x12\x14\n\x0cmessage_name\x18\x01 \x01(\t\x12\x15\n\rmessage_value\x18\x02 \x03(\t\"C\n\nRPCRequest\x12\x0e\n\x06method\x18\x01 \x01(\t\x12\x11\n\targuments\x18\x02 \x01(\x0c\x12\x12\n\ntimeout_ms\x18\x03 \x01(\x05\"E\n\x0bRPCResponse\x12\x0f\n\x07success\x18\x01 \x01(\x08\x12\x0e\n\x06result\x18\x02 \x01(\x0c\x12\x15\n\rerror_message\x18\x03 \x01(\t\"\x9c\x02\n\x0e\x41\x63knowledgment\x12\x1b\n\x13original_message_id\x18\x01 \x01(\t\x12\x10\n\x08received\x18\x02 \x01(\x08\x12\x12\n\nlatency_ms\x18\x03 \x01(\x01\x12\x13\n\x0breceiver_id\x18\x04 \x01(\t\x12\x0e\n\x06status\x18\x05 \x01(\t\x12\x1c\n\x14original_message_seq\x18\x06 \x01(\x06\x12)\n\x0bstatus_code\x18\x07 \x01(\x0e\x32\x14.messaging.AckStatus\x12\x16\n\x0ereceived_at_us\x18\x08 \x01(\x03\x12\x15\n\rprocessing_ns\x18\t \x01(\x03\x12\x13\n\x0b\x61\x63ked_at_us\x18\n \x01(\x03\x12\x15\n\rdecompress_ns\x18\x0b \x01(\x03\"i\n\x0e\x43ontrolMessage\x12$\n\x04type\x18\x01 \x01(\x0e\x32\x16.messaging.ControlType\x12\x0e\n\x06source\x18\x02 \x01(\t\x12\x13\n\x0b\x64\x65stination\x18\x03 \x01(\t\x12\x0c\n\x04\x64\x61ta\x18\x04 \x01(\x0c\"_\n\x0c\x42\x61tchMessage\x12,\n\x08messages\x18\x01 \x03(\x0b\x32\x1a.messaging.MessageEnvelope\x12\x10\n\x08\x62\x61tch_id\x18\x02 \x01(\x05\x12\x0f\n\x07is_last\x18\x03 \x01(\x08\"p\n\rBatchResponse\x12\x32\n\x0f\x61\x63knowledgments\x18\x01 \x03(\x0b\x32\x19.messaging.Acknowledgment\x12\x14\n\x0c\x66\x61iled_count\x18\x02 \x01(\x05\x12\x15\n\rerror_message\x18\x03 \x01(\t\"\xd8\x02\n\x0cStatsMessage\x12\x14\n\x0cservice_name\x18\x01 \x01(\t\x12\x15\n\rmessages_sent\x18\x02 \x01(\x03\x12\x19\n\x11messages_received\x18\x03 \x01(\x03\x12\x18\n\x10messages_dropped\x18\x04 \x01(\x03\x12\x16\n\x0e\x61vg_latency_ms\x18\x05 \x01(\x01\x12\x1e\n\x16throughput_msg_per_sec\x18\x06 \x01(\x01\x12\x11\n\ttimestamp\x18\x07 \x01(\x03\x12\x12\n\nelapsed_ms\x18\x08 \x01(\x03\x12\x11\n\twindow_ms\x18\t \x01(\x03\x12\x11\n\tin_flight\x18\n \x01(\x03\x12\x16\n\x0ep50_latency_ms\x18\x0b \x01(\x01\x12\x16\n\x0ep99_latency_ms\x18\x0c \x01(\x01\x12\x16\n\x0emax_latency_ms\x18\r \x01(\x01\x12\x19\n\x11megabytes_per_sec\x18\x0e \x01(\x01*\x8c\x01\n\x0bMessageType\x12\x1c\n\x18MESSAGE_TYPE_UNSPECIFIED\x10\x00\x12\x10\n\x0c\x44\x41TA_MESSAGE\x10\x01\x12\x0f\n\x0bRPC_REQUEST\x10\x02\x12\x10\n\x0cRPC_RESPONSE\x10\x03\x12\x07\n\x03\x41\x43K\x10\x04\x12\x0b\n\x07\x43ONTROL\x10\x05\x12\t\n\x05\x45VENT\x10\x06\x12\t\n\x05\x42\x41TCH\x10\x07*p\n\x0bRoutingMode\x12\x17\n\x13ROUTING_UNSPECIFIED\x10\x00\x12\x12\n\x0ePOINT_TO_POINT\x10\x01\x12\x15\n\x11PUBLISH_SUBSCRIBE\x10\x02\x12\x11\n\rREQUEST_REPLY\x10\x03\x12\n\n\x06\x46\x41NOUT\x10\x04*V\n\x08QoSLevel\x12\x13\n\x0fQOS_UNSPECIFIED\x10\x00\x12\x10\n\x0c\x41T_MOST_ONCE\x10\x01\x12\x11\n\rAT_LEAST_ONCE\x10\x02\x12\x10\n\x0c\x45XACTLY_ONCE\x10\x03*h\n\tAckStatus\x12\x1a\n\x16\x41\x43K_STATUS_UNSPECIFIED\x10\x00\x12\x11\n\rACK_STATUS_OK\x10\x01\x12\x14\n\x10\x41\x43K_STATUS_ERROR\x10\x02\x12\x16\n\x12\x41\x43K_STATUS_TIMEOUT\x10\x03*\x7f\n\x0b\x43ontrolType\x12\x1c\n\x18\x43ONTROL_TYPE_UNSPECIFIED\x10\x00\x12\x08\n\x04PING\x10\x01\x12\x08\n\x04PONG\x10\x02\x12\x0c\n\x08SHUTDOWN\x10\x03\x12\x10\n\x0cHEALTH_CHECK\x10\x04\x12\r\n\tSUBSCRIBE\x10\x05\x12\x0f\n\x0bUNSUBSCRIBE\x10\x06\x32\xee\x01\n\x10MessagingService\x12L\n\x0eStreamMessages\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope(\x01\x30\x01\x12\x45\n\x0bSendMessage\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope\x12\x45\n\tSubscribe\x12\x1a.messaging.MessageEnvelope\x1a\x1a.messaging.MessageEnvelope0\x01\x62\x06proto3')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
@@ -33,34 +33,36 @@ if not _descriptor._USE_C_DESCRIPTORS:
   DESCRIPTOR._loaded_options = None
   _globals['_MESSAGEENVELOPE_METADATAENTRY']._loaded_options = None
   _globals['_MESSAGEENVELOPE_METADATAENTRY']._serialized_options = b'8\001'
-  _globals['_MESSAGETYPE']._serialized_start=1245
-  _globals['_MESSAGETYPE']._serialized_end=1374
-  _globals['_ROUTINGMODE']._serialized_start=1376
-  _globals['_ROUTINGMODE']._serialized_end=1488
-  _globals['_QOSLEVEL']._serialized_start=1490
-  _globals['_QOSLEVEL']._serialized_end=1576
-  _globals['_CONTROLTYPE']._serialized_start=1578
-  _globals['_CONTROLTYPE']._serialized_end=1705
+  _globals['_MESSAGETYPE']._serialized_start=1610
+  _globals['_MESSAGETYPE']._serialized_end=1750
+  _globals['_ROUTINGMODE']._serialized_start=1752
+  _globals['_ROUTINGMODE']._serialized_end=1864
+  _globals['_QOSLEVEL']._serialized_start=1866
+  _globals['_QOSLEVEL']._serialized_end=1952
+  _globals['_ACKSTATUS']._serialized_start=1954
+  _globals['_ACKSTATUS']._serialized_end=2058
+  _globals['_CONTROLTYPE']._serialized_start=2060
+  _globals['_CONTROLTYPE']._serialized_end=2187
   _globals['_MESSAGEENVELOPE']._serialized_start=31
-  _globals['_MESSAGEENVELOPE']._serialized_end=412
-  _globals['_MESSAGEENVELOPE_METADATAENTRY']._serialized_start=365
-  _globals['_MESSAGEENVELOPE_METADATAENTRY']._serialized_end=412
-  _globals['_DATAMESSAGE']._serialized_start=414
-  _globals['_DATAMESSAGE']._serialized_end=472
-  _globals['_RPCREQUEST']._serialized_start=474
-  _globals['_RPCREQUEST']._serialized_end=541
-  _globals['_RPCRESPONSE']._serialized_start=543
-  _globals['_RPCRESPONSE']._serialized_end=612
-  _globals['_ACKNOWLEDGMENT']._serialized_start=614
-  _globals['_ACKNOWLEDGMENT']._serialized_end=734
-  _globals['_CONTROLMESSAGE']._serialized_start=736
-  _globals['_CONTROLMESSAGE']._serialized_end=841
-  _globals['_BATCHMESSAGE']._serialized_start=843
-  _globals['_BATCHMESSAGE']._serialized_end=938
-  _globals['_BATCHRESPONSE']._serialized_start=940
-  _globals['_BATCHRESPONSE']._serialized_end=1052
-  _globals['_STATSMESSAGE']._serialized_start=1055
-  _globals['_STATSMESSAGE']._serialized_end=1242
-  _globals['_MESSAGINGSERVICE']._serialized_start=1708
-  _globals['_MESSAGINGSERVICE']._serialized_end=1946
+  _globals['_MESSAGEENVELOPE']._serialized_end=455
+  _globals['_MESSAGEENVELOPE_METADATAENTRY']._serialized_start=408
+  _globals['_MESSAGEENVELOPE_METADATAENTRY']._serialized_end=455
+  _globals['_DATAMESSAGE']._serialized_start=457
+  _globals['_DATAMESSAGE']._serialized_end=515
+  _globals['_RPCREQUEST']._serialized_start=517
+  _globals['_RPCREQUEST']._serialized_end=584
+  _globals['_RPCRESPONSE']._serialized_start=586
+  _globals['_RPCRESPONSE']._serialized_end=655
+  _globals['_ACKNOWLEDGMENT']._serialized_start=658
+  _globals['_ACKNOWLEDGMENT']._serialized_end=942
+  _globals['_CONTROLMESSAGE']._serialized_start=944
+  _globals['_CONTROLMESSAGE']._serialized_end=1049
+  _globals['_BATCHMESSAGE']._serialized_start=1051
+  _globals['_BATCHMESSAGE']._serialized_end=1146
+  _globals['_BATCHRESPONSE']._serialized_start=1148
+  _globals['_BATCHRESPONSE']._serialized_end=1260
+  _globals['_STATSMESSAGE']._serialized_start=1263
+  _globals['_STATSMESSAGE']._serialized_end=1607
+  _globals['_MESSAGINGSERVICE']._serialized_start=2190
+  _globals['_MESSAGINGSERVICE']._serialized_end=2428
 # @@protoc_insertion_point(module_scope)
@@ -0,0 +1,136 @@
+#ifndef ZMQ_DEALER_PIPELINE_HPP
+#define ZMQ_DEALER_PIPELINE_HPP
+
+#include <zmq.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <chrono>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/pending_replies.hpp"
+
+/**
+ * Pipelined request/reply over one DEALER socket per receiver.
+ *
+ * Unlike REQ, a DEALER socket has no send/recv lock-step: any number of
+ * requests can be outstanding on one connection and replies may come back in
+ * any order. Replies are matched to requests by message_id in PendingReplies,
+ * and a request that times out is failed without touching the connection; a
+ * late reply for it is dropped. Requests are framed as [empty delimiter, body], so both ROUTER and
+ * plain REP receivers accept them.
+ *
+ * Single-threaded: send() and poll() must be called from the same thread.
+ */
+class DealerPipeline {
+public:
+    // reply is the parsed reply envelope, or nullptr when the request timed out
+    using ResultFn = std::function<void(const messaging::utils::TaskResult& result, const MessageEnvelope* reply)>;
+
+    DealerPipeline(zmq::context_t& context, int timeout_ms = 100)
+        : context_(context), replies_(timeout_ms) {}
+
+    DealerPipeline(const DealerPipeline&) = delete;
+    DealerPipeline& operator=(const DealerPipeline&) = delete;
+
+    // Queue body for target's receiver; the reply is reported by a later poll()
+    void send(int target, const std::string& message_id, std::string_view body) {
+        zmq::socket_t& socket = socket_for(target);
+        socket.send(zmq::message_t(), zmq::send_flags::sndmore);
+        socket.send(zmq::buffer(body.data(), body.size()), zmq::send_flags::none);
+        replies_.expect(message_id);
+    }
+
+    size_t in_flight() const { return replies_.in_flight(); }
+    size_t connection_count() const { return sockets_.size(); }
+
+    /**
+     * @brief Wait up to wait_ms for replies, then fail requests past their timeout.
+     * @return Number of requests completed (acked, rejected or timed out)
+     */
+    size_t poll(int wait_ms, const ResultFn& on_result) {
+        size_t completed = 0;
+        if (!items_.empty() && replies_.in_flight() > 0) {
+            zmq::poll(items_.data(), items_.size(), std::chrono::milliseconds(wait_ms));
+            for (size_t k = 0; k < items_.size(); ++k) {
+                if (items_[k].revents & ZMQ_POLLIN) {
+                    completed += drain(*sockets_[k], on_result);
+                }
+            }
+        }
+        // Only timeouts are queued; replies were reported as they were read
+        return completed + replies_.poll(0, [&](const messaging::utils::TaskResult& res) { on_result(res, nullptr); });
+    }
+
+    // Poll until nothing is in flight
+    void drain_all(const ResultFn& on_result) {
+        while (replies_.in_flight() > 0) {
+            poll(10, on_result);
+        }
+    }
+
+private:
+    zmq::socket_t& socket_for(int target) {
+        auto it = by_target_.find(target);
+        if (it != by_target_.end()) {
+            return *sockets_[it->second];
+        }
+        auto socket = std::make_unique<zmq::socket_t>(context_, ZMQ_DEALER);
+        socket->setsockopt(ZMQ_LINGER, 0);
+        // Queued sends wait for the connection instead of the REQ-era connect sleep
+        socket->connect("tcp://localhost:" + std::to_string(5556 + target));
+        by_target_[target] = sockets_.size();
+        items_.push_back({socket->handle(), 0, ZMQ_POLLIN, 0});
+        sockets_.push_back(std::move(socket));
+        return *sockets_.back();
+    }
+
+    // Read every reply waiting on socket without blocking
+    size_t drain(zmq::socket_t& socket, const ResultFn& on_result) {
+        size_t completed = 0;
+        zmq::message_t frame;
+        while (socket.recv(frame, zmq::recv_flags::dontwait)) {
+            // Skip the delimiter; the body is the last frame
+            while (frame.more()) {
+                socket.recv(frame, zmq::recv_flags::none);
+            }
+            if (!reply_.ParseFromArray(frame.data(), static_cast<int>(frame.size()))) {
+                continue;
+            }
+
+            std::optional<messaging::utils::TaskResult> res = replies_.take(correlation_id(reply_));
+            if (!res) {
+                continue;  // late reply for a request that already timed out
+            }
+            res->success = message_helpers::is_batch(reply_) || message_helpers::is_valid_ack(reply_, res->message_id);
+            if (!res->success) {
+                res->error = "Invalid ACK";
+            }
+            res->ack_timing = messaging::utils::AckTiming::of(reply_);
+            on_result(*res, &reply_);
+            completed++;
+        }
+        return completed;
+    }
+
+    // ACKs name the original message; batch responses are "ack_<batch id>"
+    static std::string correlation_id(const MessageEnvelope& reply) {
+        if (reply.has_ack()) {
+            return reply.ack().original_message_id();
+        }
+        const std::string& id = reply.message_id();
+        return id.compare(0, 4, "ack_") == 0 ? id.substr(4) : id;
+    }
+
+    zmq::context_t& context_;
+    std::vector<std::unique_ptr<zmq::socket_t>> sockets_;
+    std::vector<zmq::pollitem_t> items_;
+    std::map<int, size_t> by_target_;
+    messaging::utils::PendingReplies replies_;
+    MessageEnvelope reply_;
+};
+
+#endif // ZMQ_DEALER_PIPELINE_HPP
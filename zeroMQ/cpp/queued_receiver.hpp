@@ -0,0 +1,143 @@
+#ifndef ZMQ_QUEUED_RECEIVER_HPP
+#define ZMQ_QUEUED_RECEIVER_HPP
+
+#include <zmq.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/work_queue.hpp"
+
+/**
+ * ROUTER receiver with a bounded work queue (--work-queue N).
+ *
+ * The calling thread owns the socket: it reads [identity, delimiter, body]
+ * requests and submits them to a WorkQueue, whose workers parse each body and
+ * encode its ACK. ACKs come back through a ReplyQueue whose eventfd is polled
+ * next to the socket, so the same thread writes them; the socket is never
+ * touched by two threads. Replies are written after every submit, and while
+ * a submit waits, so workers never stall on them. With --overload block a
+ * full queue stops reads, and senders see the ROUTER's buffers fill; with
+ * shed the request is dropped and its sender times out. Shutdown prints "work_queue={...}".
+ */
+class QueuedReceiver {
+public:
+    QueuedReceiver(int receiver_id, const messaging::utils::WorkQueueOptions& options, bool async,
+                   std::atomic<bool>& running)
+        : receiver_id_(std::to_string(receiver_id)), options_(options), async_(async), running_(running),
+          progress_(messaging::utils::AsyncLogger::global().summary(
+              std::string(async ? " [*] [ASYNC] " : " [*] ") + "Receiver " + receiver_id_, {"received"})) {
+        for (int w = 0; w < options_.workers; ++w) {
+            workers_.push_back(std::make_unique<Worker>(receiver_id_, async_));
+        }
+    }
+
+    // Serve socket until running turns false; blocks the calling thread
+    void run(zmq::socket_t& socket) {
+        messaging::utils::WorkQueue<Job> queue(options_, [this](Job& job, int worker) { process(job, worker); });
+        replies_ = std::make_unique<messaging::utils::ReplyQueue<Reply>>(queue.max_outstanding());
+
+        zmq::pollitem_t items[] = {
+            {socket.handle(), 0, ZMQ_POLLIN, 0},
+            {nullptr, replies_->fd(), ZMQ_POLLIN, 0}
+        };
+        Job job;
+        auto flush = [&]() {
+            if (replies_->pending()) {
+                write_replies(socket);
+            }
+        };
+        while (running_) {
+            zmq::poll(items, 2, std::chrono::milliseconds(1000));
+            if (items[1].revents & ZMQ_POLLIN) {
+                write_replies(socket);
+            }
+            // Take everything already buffered before polling again
+            while ((items[0].revents & ZMQ_POLLIN) && read_request(socket, job)) {
+                if (!queue.submit(job, flush) && queue.warn_due()) {
+                    std::cerr << " [!] Receiver " << receiver_id_ << ": work queue full, " << queue.shed()
+                              << " requests shed so far" << std::endl;
+                }
+                flush();
+            }
+        }
+        queue.close();
+        write_replies(socket);
+
+        messaging::utils::flush_log();
+        std::cout << " [x] Receiver " << receiver_id_ << " work_queue=" << queue.report().dump() << std::endl;
+    }
+
+private:
+    struct Job {
+        zmq::message_t identity;
+        zmq::message_t body;
+        message_helpers::ReceiveTiming timing;
+    };
+
+    struct Reply {
+        zmq::message_t identity;
+        zmq::message_t response;
+    };
+
+    // Each worker reuses its own request envelope and ACK encoder
+    struct Worker {
+        MessageEnvelope request;
+        messaging::utils::AckEncoder acks;
+
+        Worker(const std::string& receiver_id, bool async) : acks(receiver_id, async) {}
+    };
+
+    // One buffered request, without waiting; the body is the last frame
+    static bool read_request(zmq::socket_t& socket, Job& job) {
+        if (!socket.recv(job.identity, zmq::recv_flags::dontwait)) {
+            return false;
+        }
+        bool more = job.identity.more();
+        while (more) {
+            socket.recv(job.body);
+            more = job.body.more();
+        }
+        job.timing = message_helpers::ReceiveTiming::now();
+        return true;
+    }
+
+    void process(Job& job, int worker_id) {
+        Worker& worker = *workers_[worker_id];
+        if (job.body.size() == 0 ||
+            !message_helpers::parse_envelope(job.body.data(), job.body.size(), worker.request)) {
+            return;
+        }
+        messaging::utils::log_debug() << (async_ ? " [x] [ASYNC] " : " [x] ") << "Worker " << worker_id
+                                      << " received message " << worker.request.message_id();
+        progress_.add(0);
+
+        std::string_view response = worker.acks.encode_response(worker.request, job.timing);
+        Reply reply{std::move(job.identity), zmq::message_t(response.data(), response.size())};
+        replies_->push(reply);
+    }
+
+    void write_replies(zmq::socket_t& socket) {
+        replies_->drain([&](Reply& reply) {
+            TRACE_SCOPE("reply");
+            socket.send(reply.identity, zmq::send_flags::sndmore);
+            socket.send(zmq::message_t(), zmq::send_flags::sndmore);
+            socket.send(reply.response, zmq::send_flags::none);
+        });
+    }
+
+    std::string receiver_id_;
+    messaging::utils::WorkQueueOptions options_;
+    bool async_;
+    std::atomic<bool>& running_;
+    messaging::utils::LogSummary& progress_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<messaging::utils::ReplyQueue<Reply>> replies_;
+};
+
+#endif // ZMQ_QUEUED_RECEIVER_HPP
@@ -1,10 +1,16 @@
 #include <zmq.hpp>
 #include <iostream>
 #include <string>
+#include <algorithm>
 #include <signal.h>
 #include <atomic>
 #include <thread>
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "receiver_workers.hpp"
+#include "queued_receiver.hpp"
 
 using messaging::MessageEnvelope;
 using message_helpers::get_current_time_ms;
@@ -16,20 +22,27 @@ void signal_handler(int sig) {
 }
 
 int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     int receiver_id = 0;
+    int workers = 1;
     
     for (int i = 1; i < argc; i++) {
         if (std::string(argv[i]) == "--id" && i + 1 < argc) {
-            receiver_id = std::stoi(argv[i + 1]);
-            break;
+            receiver_id = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--workers" && i + 1 < argc) {
+            workers = std::max(1, std::stoi(argv[++i]));
         }
     }
     
+    messaging::utils::WorkQueueOptions work = messaging::utils::WorkQueueOptions::from_args(argc, argv);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     zmq::context_t context(1);
-    zmq::socket_t socket(context, ZMQ_REP);
+    // ROUTER serves REQ senders and pipelined DEALER senders alike, replying in any order
+    zmq::socket_t socket(context, ZMQ_ROUTER);
     
     int port = 5556 + receiver_id;
     socket.bind("tcp://*:" + std::to_string(port));
@@ -37,35 +50,52 @@ int main(int argc, char* argv[]) {
 
     std::cout << " [*] [ASYNC] Receiver " << receiver_id << " listening on port " << port << std::endl;
 
-    while (running) {
-        zmq::message_t request;
-        auto recv_res = socket.recv(request);
+    if (work.enabled()) {
+        std::cout << " [*] [ASYNC] Queueing up to " << work.capacity << " requests for " << work.workers
+                  << " worker threads (" << work.policy() << " when full)" << std::endl;
+        QueuedReceiver(receiver_id, work, true, running).run(socket);
+    } else if (workers > 1) {
+        std::cout << " [*] [ASYNC] Fanning out to " << workers << " worker threads" << std::endl;
+        ReceiverWorkers(context, receiver_id, workers, true, running).run(socket);
+    }
+
+    messaging::utils::LogSummary& progress = messaging::utils::AsyncLogger::global().summary(
+        " [*] [ASYNC] Receiver " + std::to_string(receiver_id), {"received"});
+    messaging::utils::AckEncoder acks(std::to_string(receiver_id), true);
+    while (running && workers == 1 && !work.enabled()) {
+        zmq::message_t identity;
+        auto recv_res = socket.recv(identity);
         
         if (recv_res.has_value()) {
-            std::string request_str(static_cast<char*>(request.data()), request.size());
+            // Frames are [peer identity, empty delimiter, body]; the body is the last one
+            zmq::message_t request;
+            bool more = identity.more();
+            while (more) {
+                socket.recv(request);
+                more = request.more();
+            }
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
             
             // Parse message
             MessageEnvelope msg_envelope;
-            if (message_helpers::parse_envelope(request_str, msg_envelope)) {
+            if (request.size() > 0 && message_helpers::parse_envelope(request.data(), request.size(), msg_envelope)) {
                 std::string message_id = msg_envelope.message_id();
-                std::cout << " [x] [ASYNC] Received message " << message_id << std::endl;
+                messaging::utils::log_debug() << " [x] [ASYNC] Received message " << message_id;
+                progress.add(0);
                 
-                // Create ACK
-                MessageEnvelope response = message_helpers::create_ack_from_envelope(
-                    msg_envelope,
-                    std::to_string(receiver_id)
-                );
-                response.set_async(true);
-                std::string response_str = message_helpers::serialize_envelope(response);
+                // ACK from the pre-encoded template (a BatchResponse for batches)
+                std::string_view response = acks.encode_response(msg_envelope, timing);
                 
-                // Send ACK
-                zmq::message_t reply(response_str.size());
-                memcpy(reply.data(), response_str.c_str(), response_str.size());
-                socket.send(reply, zmq::send_flags::none);
+                // Send ACK back to the requesting peer
+                TRACE_SCOPE("reply");
+                socket.send(identity, zmq::send_flags::sndmore);
+                socket.send(zmq::message_t(), zmq::send_flags::sndmore);
+                socket.send(zmq::buffer(response.data(), response.size()), zmq::send_flags::none);
             }
         }
     }
 
+    messaging::utils::flush_log();
     std::cout << " [x] [ASYNC] Receiver " << receiver_id << " shutting down" << std::endl;
     socket.close();
     return 0;
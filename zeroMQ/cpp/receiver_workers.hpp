@@ -0,0 +1,127 @@
+#ifndef ZMQ_RECEIVER_WORKERS_HPP
+#define ZMQ_RECEIVER_WORKERS_HPP
+
+#include <zmq.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/ack_encoder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+
+/**
+ * Multi-threaded receiver: a ROUTER front end fanned out to worker threads.
+ *
+ * The front end (already bound by the caller) is proxied over inproc:// to a
+ * DEALER, which load-balances requests across workers' REP sockets. REP keeps
+ * the [peer identity, delimiter] routing frames for the reply, so workers only
+ * see message bodies and may finish in any order. Each worker reuses its own
+ * request envelope and ACK encoder; workers share one summary line.
+ */
+class ReceiverWorkers {
+public:
+    ReceiverWorkers(zmq::context_t& context, int receiver_id, int workers, bool async, std::atomic<bool>& running)
+        : context_(context), receiver_id_(std::to_string(receiver_id)), workers_(workers),
+          async_(async), running_(running),
+          endpoint_("inproc://receiver_workers_" + receiver_id_),
+          progress_(messaging::utils::AsyncLogger::global().summary(
+              std::string(async ? " [*] [ASYNC] " : " [*] ") + "Receiver " + receiver_id_, {"received"})) {}
+
+    // Serve frontend until running turns false; blocks the calling thread
+    void run(zmq::socket_t& frontend) {
+        zmq::socket_t backend(context_, ZMQ_DEALER);
+        backend.setsockopt(ZMQ_LINGER, 0);
+        backend.bind(endpoint_);
+
+        std::vector<std::thread> threads;
+        for (int w = 0; w < workers_; ++w) {
+            threads.emplace_back([this, w]() {
+                messaging::utils::CpuAffinity::global().pin_this_thread();
+                work(w);
+            });
+        }
+
+        proxy(frontend, backend);
+
+        for (auto& t : threads) {
+            t.join();
+        }
+        backend.close();
+    }
+
+private:
+    // zmq::proxy never returns, so forward by hand and check running_ between polls
+    void proxy(zmq::socket_t& frontend, zmq::socket_t& backend) {
+        zmq::pollitem_t items[] = {
+            {frontend.handle(), 0, ZMQ_POLLIN, 0},
+            {backend.handle(), 0, ZMQ_POLLIN, 0}
+        };
+        zmq::message_t frame;
+        while (running_) {
+            zmq::poll(items, 2, std::chrono::milliseconds(1000));
+            if (items[0].revents & ZMQ_POLLIN) {
+                forward(frontend, backend, frame);
+            }
+            if (items[1].revents & ZMQ_POLLIN) {
+                forward(backend, frontend, frame);
+            }
+        }
+    }
+
+    // Move one multipart message, frame by frame
+    static void forward(zmq::socket_t& from, zmq::socket_t& to, zmq::message_t& frame) {
+        bool more = true;
+        while (more) {
+            from.recv(frame);
+            more = frame.more();
+            to.send(frame, more ? zmq::send_flags::sndmore : zmq::send_flags::none);
+        }
+    }
+
+    void work(int worker_id) {
+        zmq::socket_t socket(context_, ZMQ_REP);
+        socket.setsockopt(ZMQ_LINGER, 0);
+        socket.setsockopt(ZMQ_RCVTIMEO, 1000);  // 1s timeout for graceful shutdown
+        socket.connect(endpoint_);
+
+        const char* tag = async_ ? " [x] [ASYNC] " : " [x] ";
+        std::string worker = std::to_string(worker_id);
+        MessageEnvelope request;
+        messaging::utils::AckEncoder acks(receiver_id_, async_);
+        zmq::message_t body;
+
+        while (running_) {
+            if (!socket.recv(body)) {
+                continue;
+            }
+            message_helpers::ReceiveTiming timing = message_helpers::ReceiveTiming::now();
+            if (!message_helpers::parse_envelope(body.data(), body.size(), request)) {
+                // REP must answer before its next recv; an empty reply fails the sender's parse
+                socket.send(zmq::message_t(), zmq::send_flags::none);
+                continue;
+            }
+
+            messaging::utils::log_debug() << tag << "Worker " << worker << " received message "
+                                          << request.message_id();
+            progress_.add(0);
+
+            std::string_view response = acks.encode_response(request, timing);
+            socket.send(zmq::buffer(response.data(), response.size()), zmq::send_flags::none);
+        }
+        socket.close();
+    }
+
+    zmq::context_t& context_;
+    std::string receiver_id_;
+    int workers_;
+    bool async_;
+    std::atomic<bool>& running_;
+    std::string endpoint_;
+    messaging::utils::LogSummary& progress_;
+};
+
+#endif // ZMQ_RECEIVER_WORKERS_HPP
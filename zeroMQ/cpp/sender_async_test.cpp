@@ -2,52 +2,80 @@
 #include <string>
 #include <iostream>
 #include <fstream>
-#include <future>
 #include <vector>
 #include <map>
+#include <cstring>
+#include <algorithm>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/async_send_engine.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/connection_pool.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "dealer_pipeline.hpp"
 
 using json = nlohmann::json;
 using messaging::MessageEnvelope;
-using message_helpers::get_current_time_ms;
+using messaging::utils::TaskResult;
+using messaging::utils::Attempt;
+using messaging::utils::EngineOptions;
+using messaging::utils::AsyncSendEngine;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::ConnectionPool;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+using message_helpers::get_steady_time_ns;
 
-struct TaskResult {
-    bool success;
-    std::string message_id;
-    long long duration;
-    std::string error;
+// Pooled REQ socket connected to one receiver port
+struct ZmqRequester {
+    zmq::socket_t socket;
+
+    ZmqRequester(zmq::context_t& context, int port) : socket(context, ZMQ_REQ) {
+        socket.connect("tcp://localhost:" + std::to_string(port));
+        socket.setsockopt(ZMQ_RCVTIMEO, 100);  // 100ms timeout
+        socket.setsockopt(ZMQ_LINGER, 0);
+    }
 };
 
-TaskResult send_message_task(const json& item) {
+// First attempts stamp the corpus in place, others encode a copy (see Attempt)
+TaskResult send_message_task(ConnectionPool<ZmqRequester>& pool, test_data_loader::EncodedCorpus& corpus, size_t i,
+                             const Attempt& attempt) {
     TaskResult res;
     res.success = false;
-    res.message_id = message_helpers::extract_message_id(item);
-    res.duration = 0;
+    res.message_id = std::string(corpus.message_id(i));
+    res.duration_ns = 0;
     
-    int target = item.value("target", 0);
+    int target = corpus.target(i);
     int port = 5556 + target;
     
+    auto conn = pool.checkout(port);
+    if (!conn) {
+        res.error = "Connection failed";
+        return res;
+    }
+    
     try {
-        zmq::context_t context(1);
-        zmq::socket_t socket(context, ZMQ_REQ);
-        socket.connect("tcp://localhost:" + std::to_string(port));
-        socket.setsockopt(ZMQ_RCVTIMEO, 100);  // 100ms timeout
-        
-        long long msg_start = get_current_time_ms();
+        long long msg_start = get_steady_time_ns();
         
-        // Create and send message
-        MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-        std::string body = message_helpers::serialize_envelope(envelope);
+        // Stamp the pre-encoded envelope and send it
+        thread_local std::string copy;
+        int64_t now_us = message_helpers::get_current_time_us();
+        std::string_view body = attempt.number == 0 ? corpus.stamp(i, now_us) : corpus.encode(i, now_us, {}, copy);
+        res.bytes = body.size();
+        conn->socket.setsockopt(ZMQ_RCVTIMEO, attempt.timeout_ms(100));
         
         zmq::message_t request(body.size());
-        memcpy(request.data(), body.c_str(), body.size());
-        socket.send(request, zmq::send_flags::none);
+        memcpy(request.data(), body.data(), body.size());
+        TRACED("send", conn->socket.send(request, zmq::send_flags::none));
         
         // Receive ACK
         zmq::message_t reply;
-        auto recv_res = socket.recv(reply);
+        auto recv_res = conn->socket.recv(reply);
         
         if (recv_res.has_value()) {
             std::string reply_str(static_cast<char*>(reply.data()), reply.size());
@@ -55,57 +83,169 @@ TaskResult send_message_task(const json& item) {
             MessageEnvelope resp_envelope;
             if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
                 message_helpers::is_valid_ack(resp_envelope, res.message_id)) {
-                res.duration = get_current_time_ms() - msg_start;
+                res.duration_ns = get_steady_time_ns() - msg_start;
+                res.ack_timing = messaging::utils::AckTiming::of(resp_envelope);
                 res.success = true;
             } else {
                 res.error = "Invalid ACK";
             }
         } else {
             res.error = "Timeout";
+            // REQ socket is stuck waiting for a reply; don't hand it out again
+            conn.discard();
         }
-        
-        socket.close();
     } catch (const std::exception& e) {
         res.error = e.what();
+        conn.discard();
     }
     
     return res;
 }
 
-int main() {
-    auto test_data = test_data_loader::loadTestData();
+/**
+ * Pipeline every message over one DEALER socket per receiver from this thread,
+ * keeping up to max_in_flight outstanding; returns the peak in flight.
+ */
+int run_dealer_pipeline(DealerPipeline& pipeline, test_data_loader::EncodedCorpus& corpus, int max_in_flight,
+                        const AsyncSendEngine::ResultFn& on_result, MessageStats& stats) {
+    auto report = [&](const TaskResult& res, const MessageEnvelope*) { on_result(res); };
+    size_t window = static_cast<size_t>(max_in_flight);
+    size_t peak = 0;
+    std::string message_id;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        // Wait for room in the window, picking up whatever ACKs have arrived meanwhile
+        while (pipeline.in_flight() >= window) {
+            pipeline.poll(10, report);
+        }
+        message_id.assign(corpus.message_id(i));
+        TRACED("send", pipeline.send(corpus.target(i), message_id, corpus.stamp(i, message_helpers::get_current_time_us())));
+        stats.record_dispatch();
+        peak = std::max(peak, pipeline.in_flight());
+        pipeline.poll(0, report);
+    }
+    pipeline.drain_all(report);
+    return static_cast<int>(peak);
+}
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    EngineOptions options = EngineOptions::from_args(argc, argv);
+    corpus.attach_qos(options.qos);
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
+
+    bool use_dealer = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dealer") == 0) {
+            use_dealer = true;
+        }
+    }
+    if (use_dealer) {
+        options.warn_ignored_by("--dealer");
+    }
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "ZeroMQ"},
         {"language", "C++"},
-        {"async", true}
+        {"async", true},
+        {"transport", use_dealer ? "dealer" : "req"},
+        {"workers", use_dealer ? 1 : options.workers},
+        {"max_in_flight", options.max_in_flight}
     });
-    long long start_time = get_current_time_ms();
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
 
-    std::cout << " [x] Starting ASYNC transfer of " << test_data.size() << " messages..." << std::endl;
+    zmq::context_t context(1);
 
-    std::vector<std::future<TaskResult>> futures;
-    for (auto& item : test_data) {
-        futures.push_back(std::async(std::launch::async, send_message_task, item));
+    // --wait-ready: PING every receiver before the clock starts, lock-step over a DEALER per receiver
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "zeromq-async-sender");
+    if (ready.options().enabled()) {
+        DealerPipeline pipeline(context, 100);
+        MessageEnvelope pong;
+        ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view body) {
+            const MessageEnvelope* reply = nullptr;
+            pipeline.send(target, ping_id, body);
+            pipeline.drain_all([&](const TaskResult&, const MessageEnvelope* received) {
+                if (received) {
+                    pong = *received;
+                    reply = &pong;
+                }
+            });
+            return reply;
+        });
     }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("ZeroMQ");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
 
-    for (auto& fut : futures) {
-        TaskResult res = fut.get();
+    std::cout << " [x] Starting ASYNC transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] [ASYNC] Sender", {"acked", "failed"});
+
+    auto on_result = [&](const TaskResult& res) {
         if (res.success) {
-            stats.record_message(true, res.duration);
-            std::cout << " [OK] Message " << res.message_id << " acknowledged" << std::endl;
+            stats.record_message_ns(true, res.duration_ns);
+            stats.record_breakdown(res.ack_timing, res.duration_ns);
+            stats.record_bytes(res.bytes);
+            progress.add(0);
+            log_debug() << " [OK] Message " << res.message_id << " acknowledged";
         } else {
             stats.record_message(false);
-            std::cout << " [FAILED] Message " << res.message_id << ": " << res.error << std::endl;
+            progress.add(1);
+            log_info() << " [FAILED] Message " << res.message_id << ": " << res.error;
+        }
+    };
+
+    if (use_dealer) {
+        // One thread and one connection per receiver; the window is the only concurrency
+        DealerPipeline pipeline(context, 100);  // 100ms timeout, as for REQ
+        int peak = run_dealer_pipeline(pipeline, corpus, options.max_in_flight, on_result, stats);
+        stats.add_metadata("peak_in_flight", peak);
+        stats.add_metadata("connections_created", pipeline.connection_count());
+    } else {
+        ConnectionPool<ZmqRequester> pool([&](int port) {
+            return std::make_unique<ZmqRequester>(context, port);
+        });
+
+        AsyncSendEngine engine(options);
+        engine.run(corpus.size(),
+            [&](size_t i, const Attempt& attempt) {
+                if (attempt.number == 0) {
+                    stats.record_dispatch();
+                }
+                return send_message_task(pool, corpus, i, attempt);
+            },
+            on_result);
+        stats.add_metadata("peak_in_flight", engine.peak_in_flight());
+        if (options.open_loop()) {
+            stats.add_metadata("open_loop", engine.open_loop_report());
+        }
+        if (options.policy.enabled()) {
+            stats.add_metadata("request_policy", engine.policy_report());
+        }
+        if (options.qos.enabled()) {
+            stats.add_metadata("qos", options.qos.report(engine.retransmits()));
         }
+        stats.add_metadata("connections_created", pool.created_count());
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results (ASYNC):" << std::endl;
     std::cout << "total_sent: " << stats.sent_count << std::endl;
     std::cout << "total_received: " << stats.received_count << std::endl;
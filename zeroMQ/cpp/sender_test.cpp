@@ -5,101 +5,261 @@
 #include <chrono>
 #include <thread>
 #include <map>
+#include <memory>
+#include <cstring>
 #include "../../utils/cpp/stats_collector.hpp"
+#include "../../utils/cpp/perf_counters.hpp"
 #include "../../utils/cpp/test_data_loader.hpp"
+#include "../../utils/cpp/encoded_corpus.hpp"
 #include "../../utils/cpp/message_helpers.hpp"
+#include "../../utils/cpp/batch_builder.hpp"
+#include "../../utils/cpp/async_logger.hpp"
+#include "../../utils/cpp/cpu_affinity.hpp"
+#include "../../utils/cpp/partitioned_sender.hpp"
+#include "../../utils/cpp/ready_barrier.hpp"
+#include "dealer_pipeline.hpp"
 
 using json = nlohmann::json;
-using message_helpers::get_current_time_ms;
+using message_helpers::get_steady_time_ns;
 
-int main() {
+using messaging::utils::BatchOptions;
+using messaging::utils::BatchAccumulator;
+using messaging::utils::BatchBuilder;
+using messaging::utils::log_debug;
+using messaging::utils::log_info;
+using messaging::utils::TaskResult;
+using messaging::utils::PartitionOptions;
+using messaging::utils::PartitionedSender;
+using messaging::utils::QoSOptions;
+using messaging::utils::ReadyOptions;
+using messaging::utils::ReadyBarrier;
+
+using SocketMap = std::map<int, zmq::socket_t*>;
+
+// Send body to target's REQ socket and wait for the reply; a timed-out socket is closed and dropped
+bool request_reply(zmq::context_t& context, SocketMap& sockets, int target,
+                   std::string_view body, MessageEnvelope& resp_envelope, std::string& error) {
+    // Get or create socket for this target
+    if (sockets.find(target) == sockets.end()) {
+        zmq::socket_t* sock = new zmq::socket_t(context, ZMQ_REQ);
+        sock->connect("tcp://localhost:" + std::to_string(5556 + target));
+        sock->setsockopt(ZMQ_RCVTIMEO, 40);  // 40ms timeout
+        sockets[target] = sock;
+        
+        // Small delay to allow ZeroMQ connection to establish
+        // (connect() is async and returns immediately)
+        // Async receivers need slightly more time
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    zmq::socket_t* socket = sockets[target];
+    try {
+        zmq::message_t request(body.size());
+        memcpy(request.data(), body.data(), body.size());
+        TRACED("send", socket->send(request, zmq::send_flags::none));
+
+        // Receive ACK
+        zmq::message_t reply;
+        auto recv_res = TRACED("wait", socket->recv(reply));
+        
+        if (recv_res.has_value()) {
+            if (message_helpers::parse_envelope(reply.data(), reply.size(), resp_envelope)) {
+                return true;
+            }
+            error = "Invalid ACK";
+            return false;
+        }
+        error = "Timeout";
+    } catch (const std::exception& e) {
+        error = std::string("Error: ") + e.what();
+    }
+    // Close poisoned REQ socket
+    socket->close();
+    delete socket;
+    sockets.erase(target);
+    return false;
+}
+
+// Lock-step exchange over a DEALER pipeline; a timeout fails this request but keeps the connection
+bool dealer_request_reply(DealerPipeline& pipeline, int target, const std::string& correlation_id,
+                          std::string_view body, MessageEnvelope& resp_envelope, std::string& error) {
+    bool replied = false;
+    pipeline.send(target, correlation_id, body);
+    pipeline.drain_all([&](const TaskResult& res, const MessageEnvelope* reply) {
+        if (reply) {
+            resp_envelope = *reply;
+            replied = true;
+        } else {
+            error = res.error;
+        }
+    });
+    return replied;
+}
+
+// One sending thread's sockets; ZeroMQ sockets must stay on the thread that uses them
+struct Connections {
+    explicit Connections(zmq::context_t& context) : context(context), pipeline(context, 40) {}  // 40ms timeout, as for REQ
+
+    ~Connections() {
+        for (auto& pair : sockets) {
+            pair.second->close();
+            delete pair.second;
+        }
+    }
+
+    zmq::context_t& context;
+    SocketMap sockets;
+    DealerPipeline pipeline;
+    MessageEnvelope resp_envelope;
+    std::string error;
+};
+
+int main(int argc, char* argv[]) {
+    messaging::utils::configure_affinity(argc, argv);
     zmq::context_t context(1);
-    std::map<int, zmq::socket_t*> sockets;
 
-    auto test_data = test_data_loader::loadTestData();
+    bool use_dealer = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dealer") == 0) {
+            use_dealer = true;
+        }
+    }
+    auto exchange = [&](Connections& conn, int target, const std::string& correlation_id, std::string_view body) {
+        if (use_dealer) {
+            return dealer_request_reply(conn.pipeline, target, correlation_id, body, conn.resp_envelope, conn.error);
+        }
+        return request_reply(conn.context, conn.sockets, target, body, conn.resp_envelope, conn.error);
+    };
+
+    auto corpus = test_data_loader::preEncodeTestFile();
+    corpus.attach_payloads(messaging::utils::PayloadSpec::from_args(argc, argv));
+    QoSOptions qos = QoSOptions::from_args(argc, argv);
+    corpus.attach_qos(qos);
+    BatchOptions batch_options = BatchOptions::from_args(argc, argv);
+    PartitionOptions partition_options = PartitionOptions::from_args(argc, argv);
+    if (batch_options.enabled()) {
+        partition_options.warn_ignored_by("--batch");
+        qos.warn_ignored_by("--batch");
+    }
+    messaging::utils::configure_logging(argc, argv);
+    messaging::utils::configure_tracing(argc, argv);
+    messaging::utils::PerfCounters perf(messaging::utils::PerfCounterOptions::from_args(argc, argv));
 
     MessageStats stats;
     stats.set_metadata({
         {"service", "ZeroMQ"},
         {"language", "C++"},
-        {"async", false}
+        {"async", false},
+        {"transport", use_dealer ? "dealer" : "req"},
+        {"batch_size", batch_options.max_messages},
+        {"batch_linger_ms", batch_options.linger_ms},
+        {"partitions", batch_options.enabled() ? 1 : partition_options.partitions}
     });
-    long long start_time = get_current_time_ms();
-
-    std::cout << " [x] Starting transfer of " << test_data.size() << " messages..." << std::endl;
-
-    for (auto& item : test_data) {
-        std::string message_id = message_helpers::extract_message_id(item);
-        int target = item.value("target", 0);
-        int port = 5556 + target;
-
-        // Get or create socket for this target
-        if (sockets.find(target) == sockets.end()) {
-            zmq::socket_t* sock = new zmq::socket_t(context, ZMQ_REQ);
-            sock->connect("tcp://localhost:" + std::to_string(port));
-            sock->setsockopt(ZMQ_RCVTIMEO, 40);  // 40ms timeout
-            sockets[target] = sock;
-            
-            // Small delay to allow ZeroMQ connection to establish
-            // (connect() is async and returns immediately)
-            // Async receivers need slightly more time
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stats.add_metadata("payload", corpus.payloads().spec().describe());
+    stats.add_metadata("placement", messaging::utils::CpuAffinity::global().describe());
+    stats.set_mean_message_bytes(corpus.mean_wire_bytes());
+
+    // --wait-ready: PING every receiver before the clock starts
+    ReadyBarrier ready(ReadyOptions::from_args(argc, argv), "zeromq-sender");
+    if (ready.options().enabled()) {
+        Connections conn(context);
+        ready.wait(ReadyBarrier::targets_of(corpus), [&](int target, const std::string& ping_id, std::string_view body) {
+            return exchange(conn, target, ping_id, body) ? &conn.resp_envelope : nullptr;
+        });
+    }
+    stats.add_metadata("ready", ready.report());
+    messaging::utils::LiveStats live(messaging::utils::LiveStatsOptions::from_args(argc, argv));
+    stats.attach_live(live.recorder());
+    live.start("ZeroMQ");
+    perf.start();
+    long long start_ns = get_steady_time_ns();
+
+    std::cout << " [x] Starting transfer of " << corpus.size() << " messages..." << std::endl;
+    messaging::utils::LogSummary& progress =
+        messaging::utils::AsyncLogger::global().summary(" [*] Sender", {"acked", "failed"});
+
+    if (batch_options.enabled()) {
+        Connections conn(context);
+        std::string body;  // reused batch encode buffer
+        BatchAccumulator batches(batch_options);
+        auto flush = [&](BatchBuilder& batch) {
+            std::string correlation_id = "batch_" + std::to_string(batch.batch_id());
+            bool replied = exchange(conn, batch.target(), correlation_id, batch.finish({}, body));
+            size_t acked = messaging::utils::record_batch(stats, batch, replied ? &conn.resp_envelope : nullptr,
+                                                          get_steady_time_ns());
+            if (replied) {
+                log_debug() << " [x] Batch " << batch.batch_id() << " (" << batch.size() << " messages) to port "
+                            << 5556 + batch.target() << " [OK] " << acked << "/" << batch.size() << " acknowledged";
+            } else {
+                log_info() << " [x] Batch " << batch.batch_id() << " to port " << 5556 + batch.target()
+                           << " [FAILED] " << conn.error;
+            }
+            progress.add(0, acked);
+            progress.add(1, batch.size() - acked);
+        };
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            std::string_view envelope = corpus.stamp(i, message_helpers::get_current_time_us());
+            batches.add(corpus.target(i), envelope, corpus.message_id(i), get_steady_time_ns(), flush);
+            batches.flush_expired(get_steady_time_ns(), flush);
         }
-        
-        zmq::socket_t* socket = sockets[target];
-        std::cout << " [x] Sending message " << message_id << " to port " << port << "..." << std::flush;
-        
-        long long msg_start = get_current_time_ms();
-        try {
-            // Create and send protobuf message
-            MessageEnvelope envelope = message_helpers::create_data_envelope(item);
-            std::string body = message_helpers::serialize_envelope(envelope);
-            
-            zmq::message_t request(body.size());
-            memcpy(request.data(), body.c_str(), body.size());
-            socket->send(request, zmq::send_flags::none);
-
-            // Receive ACK
-            zmq::message_t reply;
-            auto recv_res = socket->recv(reply);
-            
-            if (recv_res.has_value()) {
-                std::string reply_str(static_cast<char*>(reply.data()), reply.size());
-                
-                // Parse and validate ACK
-                MessageEnvelope resp_envelope;
-                if (message_helpers::parse_envelope(reply_str, resp_envelope) && 
-                    message_helpers::is_valid_ack(resp_envelope, message_id)) {
-                    long long msg_duration = get_current_time_ms() - msg_start;
-                    stats.record_message(true, msg_duration);
-                    std::cout << " [OK]" << std::endl;
+        batches.flush_all(flush);
+    } else {
+        // Each target's messages go out in corpus order from the one thread that owns it
+        auto send_one = [&](Connections& conn, size_t i) {
+            TaskResult res;
+            res.message_id.assign(corpus.message_id(i));
+            int target = corpus.target(i);
+            long long msg_start = get_steady_time_ns();
+            // Stamp the pre-encoded envelope and send it
+            std::string_view body = corpus.stamp(i, message_helpers::get_current_time_us());
+            if (!exchange(conn, target, res.message_id, body)) {
+                res.error = conn.error;
+                log_info() << " [x] Message " << res.message_id << " to port " << 5556 + target << " [FAILED] " << res.error;
+            } else if (message_helpers::is_valid_ack(conn.resp_envelope, res.message_id)) {
+                res.success = true;
+                res.duration_ns = get_steady_time_ns() - msg_start;
+                res.ack_timing = messaging::utils::AckTiming::of(conn.resp_envelope);
+                res.bytes = body.size();
+                log_debug() << " [x] Message " << res.message_id << " to port " << 5556 + target << " [OK]";
+            } else {
+                res.error = "Invalid ACK";
+                log_info() << " [x] Message " << res.message_id << " to port " << 5556 + target << " [FAILED] Invalid ACK";
+            }
+            return res;
+        };
+        PartitionedSender sender(partition_options, qos);
+        sender.run(corpus.size(),
+            [&](size_t i) { return corpus.target(i); },
+            [&](size_t) { return std::make_unique<Connections>(context); },
+            [&](std::unique_ptr<Connections>& conn, size_t i) { return send_one(*conn, i); },
+            [&](const TaskResult& res) {
+                if (res.success) {
+                    stats.record_message_ns(true, res.duration_ns);
+                    stats.record_breakdown(res.ack_timing, res.duration_ns);
+                    stats.record_bytes(res.bytes);
+                    progress.add(0);
                 } else {
                     stats.record_message(false);
-                    std::cout << " [FAILED] Invalid ACK" << std::endl;
+                    progress.add(1);
                 }
-            } else {
-                stats.record_message(false);
-                std::cout << " [FAILED] Timeout" << std::endl;
-                // Close poisoned REQ socket
-                socket->close();
-                delete socket;
-                sockets.erase(target);
-            }
-
-        } catch (const std::exception& e) {
-            stats.record_message(false);
-            std::cout << " [FAILED] Error: " << e.what() << std::endl;
-            socket->close();
-            delete socket;
-            sockets.erase(target);
+            });
+        if (partition_options.enabled()) {
+            stats.add_metadata("partitioning", sender.report());
+        }
+        if (qos.enabled()) {
+            stats.add_metadata("qos", qos.report(sender.retransmits()));
         }
     }
 
-    long long end_time = get_current_time_ms();
-    stats.set_duration(start_time, end_time);
+    long long end_ns = get_steady_time_ns();
+    stats.set_duration_ns(start_ns, end_ns);
+    live.stop();
+    perf.stop();
     
     json report = stats.get_stats();
+    perf.add_to(report, stats.processed_count);
 
+    messaging::utils::flush_log();
     std::cout << "\nTest Results:" << std::endl;
     std::cout << "service: ZeroMQ" << std::endl;
     std::cout << "language: C++" << std::endl;
@@ -113,11 +273,5 @@ int main() {
         rf.close();
     }
 
-    // Cleanup
-    for (auto& pair : sockets) {
-        pair.second->close();
-        delete pair.second;
-    }
-
     return 0;
 }